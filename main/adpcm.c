@@ -0,0 +1,167 @@
+#include "adpcm.h"
+#include <string.h>
+
+static const int16_t s_step_table[89] = {
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+    50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190, 209, 230,
+    253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963,
+    1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024, 3327,
+    3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487,
+    12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767,
+};
+
+static const int8_t s_index_table[16] = {
+    -1, -1, -1, -1, 2, 4, 6, 8, -1, -1, -1, -1, 2, 4, 6, 8,
+};
+
+void adpcm_init(adpcm_state_t *state)
+{
+    state->predictor = 0;
+    state->index = 0;
+}
+
+// Apply one nibble to the state; shared by encoder and decoder so both
+// track the same predictor.
+static void step(adpcm_state_t *state, uint8_t nibble)
+{
+    int32_t stepsize = s_step_table[state->index];
+    int32_t diff = stepsize >> 3;
+    int32_t predictor = state->predictor;
+    int index = state->index + s_index_table[nibble];
+
+    if (nibble & 4) {
+        diff += stepsize;
+    }
+    if (nibble & 2) {
+        diff += stepsize >> 1;
+    }
+    if (nibble & 1) {
+        diff += stepsize >> 2;
+    }
+    predictor += (nibble & 8) ? -diff : diff;
+    state->predictor = (int16_t)(predictor > 32767 ? 32767 : predictor < -32768 ? -32768 : predictor);
+    state->index = (uint8_t)(index < 0 ? 0 : index > 88 ? 88 : index);
+}
+
+static uint8_t encode_sample(adpcm_state_t *state, int16_t sample)
+{
+    int32_t stepsize = s_step_table[state->index];
+    int32_t diff = (int32_t)sample - state->predictor;
+    uint8_t nibble = 0;
+
+    if (diff < 0) {
+        nibble = 8;
+        diff = -diff;
+    }
+    if (diff >= stepsize) {
+        nibble |= 4;
+        diff -= stepsize;
+    }
+    if (diff >= stepsize >> 1) {
+        nibble |= 2;
+        diff -= stepsize >> 1;
+    }
+    if (diff >= stepsize >> 2) {
+        nibble |= 1;
+    }
+    step(state, nibble);
+    return nibble;
+}
+
+void adpcm_encode_block(adpcm_state_t *state, const int16_t *pcm, size_t n, uint8_t *out)
+{
+    int16_t last = n > 0 ? pcm[n - 1] : 0;
+
+    // The header carries the first sample exactly, resyncing the decoder.
+    state->predictor = n > 0 ? pcm[0] : 0;
+    out[0] = (uint8_t)state->predictor;
+    out[1] = (uint8_t)((uint16_t)state->predictor >> 8);
+    out[2] = state->index;
+    out[3] = 0;
+
+    for (size_t i = 1; i < ADPCM_BLOCK_SAMPLES; i += 2) {
+        int16_t a = i < n ? pcm[i] : last;
+        int16_t b = i + 1 < n ? pcm[i + 1] : last;
+        uint8_t lo = encode_sample(state, a);
+        uint8_t hi = encode_sample(state, b);
+        out[4 + (i - 1) / 2] = (uint8_t)(lo | (hi << 4));
+    }
+}
+
+void adpcm_decode_block(const uint8_t *block, int16_t *pcm)
+{
+    adpcm_state_t state;
+
+    state.predictor = (int16_t)(block[0] | (block[1] << 8));
+    state.index = block[2] > 88 ? 88 : block[2];
+    pcm[0] = state.predictor;
+    for (size_t i = 1; i < ADPCM_BLOCK_SAMPLES; i += 2) {
+        uint8_t byte = block[4 + (i - 1) / 2];
+        step(&state, byte & 0x0F);
+        pcm[i] = state.predictor;
+        step(&state, byte >> 4);
+        pcm[i + 1] = state.predictor;
+    }
+}
+
+size_t adpcm_block_count(uint32_t samples)
+{
+    return ((size_t)samples + ADPCM_BLOCK_SAMPLES - 1) / ADPCM_BLOCK_SAMPLES;
+}
+
+size_t adpcm_wav_len(uint32_t samples)
+{
+    return ADPCM_WAV_HEADER_BYTES + adpcm_block_count(samples) * ADPCM_BLOCK_BYTES;
+}
+
+static uint8_t *put_u32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+    return p + 4;
+}
+
+static uint8_t *put_u16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    return p + 2;
+}
+
+static uint8_t *put_tag(uint8_t *p, const char *tag)
+{
+    memcpy(p, tag, 4);
+    return p + 4;
+}
+
+size_t adpcm_wav_header(uint8_t *out, uint32_t sample_rate, uint32_t samples)
+{
+    bool unknown = samples == ADPCM_WAV_UNKNOWN_SAMPLES;
+    uint32_t data_len = unknown ? UINT32_MAX : (uint32_t)(adpcm_block_count(samples) * ADPCM_BLOCK_BYTES);
+    uint8_t *p = out;
+
+    p = put_tag(p, "RIFF");
+    p = put_u32(p, unknown ? UINT32_MAX : ADPCM_WAV_HEADER_BYTES - 8 + data_len);
+    p = put_tag(p, "WAVE");
+
+    p = put_tag(p, "fmt ");
+    p = put_u32(p, 20);
+    p = put_u16(p, 0x0011);                                 // IMA ADPCM
+    p = put_u16(p, 1);                                      // Mono
+    p = put_u32(p, sample_rate);
+    p = put_u32(p, sample_rate * ADPCM_BLOCK_BYTES / ADPCM_BLOCK_SAMPLES);
+    p = put_u16(p, ADPCM_BLOCK_BYTES);
+    p = put_u16(p, 4);                                      // Bits per sample
+    p = put_u16(p, 2);                                      // Extra bytes
+    p = put_u16(p, ADPCM_BLOCK_SAMPLES);
+
+    p = put_tag(p, "fact");
+    p = put_u32(p, 4);
+    p = put_u32(p, samples);
+
+    p = put_tag(p, "data");
+    p = put_u32(p, data_len);
+    return (size_t)(p - out);
+}
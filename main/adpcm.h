@@ -0,0 +1,44 @@
+#ifndef ADPCM_H
+#define ADPCM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// IMA-ADPCM in the WAV (format 0x11) block layout: 4 bits per sample, so a
+// recording uploads at a quarter of its 16-bit PCM size, and each block can
+// be encoded and sent as soon as its samples arrive.
+
+#define ADPCM_BLOCK_BYTES       256
+#define ADPCM_BLOCK_SAMPLES     ((ADPCM_BLOCK_BYTES - 4) * 2 + 1)  // 505, mono
+#define ADPCM_WAV_HEADER_BYTES  60
+
+// Sample count for a header written before the length is known. Its sizes
+// are then 0xFFFFFFFF, which WAV readers take as "until the end of the file".
+#define ADPCM_WAV_UNKNOWN_SAMPLES   UINT32_MAX
+
+typedef struct {
+    int16_t predictor;
+    uint8_t index;                  // Step table position, 0-88
+} adpcm_state_t;
+
+void adpcm_init(adpcm_state_t *state);
+
+// Encode up to ADPCM_BLOCK_SAMPLES samples into one ADPCM_BLOCK_BYTES block.
+// A short final block (n < ADPCM_BLOCK_SAMPLES) is padded with its last sample.
+void adpcm_encode_block(adpcm_state_t *state, const int16_t *pcm, size_t n, uint8_t *out);
+
+// Decode one block back to ADPCM_BLOCK_SAMPLES samples.
+void adpcm_decode_block(const uint8_t *block, int16_t *pcm);
+
+// Blocks needed for samples (the last one may be padded).
+size_t adpcm_block_count(uint32_t samples);
+
+// Size of a complete mono WAV file: header plus blocks.
+size_t adpcm_wav_len(uint32_t samples);
+
+// Write the RIFF/fmt/fact/data header for a mono file of samples samples
+// (or ADPCM_WAV_UNKNOWN_SAMPLES). Returns ADPCM_WAV_HEADER_BYTES.
+size_t adpcm_wav_header(uint8_t *out, uint32_t sample_rate, uint32_t samples);
+
+#endif // ADPCM_H
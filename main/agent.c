@@ -1,5 +1,7 @@
 #include "agent.h"
 #include "config.h"
+#include "chat_context.h"
+#include "chat_queue.h"
 #include "llm.h"
 #include "tools.h"
 #include "tools_media.h"
@@ -7,12 +9,16 @@
 #include "json_util.h"
 #include "messages.h"
 #include "ratelimit.h"
+#include "recall.h"
+#include "zc_store.h"
 #include "cJSON.h"
+#include "esp_heap_caps.h"
 #include "esp_timer.h"
 #include "esp_log.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/queue.h"
+#include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
 #include <inttypes.h>
@@ -24,6 +30,8 @@ static const char *TAG = "agent";
 #define LLM_RETRY_BASE_MS   2000
 #define LLM_RETRY_MAX_MS    10000
 
+#define CHAT_RECORD_PREFIX  "~c"            // zc_store keys for spilled chat histories
+
 // Queues
 static QueueHandle_t s_input_queue;
 static QueueHandle_t s_channel_output_queue;
@@ -31,16 +39,21 @@ static QueueHandle_t s_telegram_output_queue;
 static int64_t s_last_start_response_us = 0;
 static bool s_messages_paused = false;
 
-// Conversation history (rolling message buffer)
-static conversation_msg_t s_history[MAX_HISTORY_TURNS * 2];
-static int s_history_len = 0;
+// Conversation history of the chat being served (rolling message buffer)
+static chat_context_t *s_ctx = NULL;
+static int64_t s_reply_chat_id = CHAT_ID_LOCAL;
+static chat_queue_t s_pending;
 
 // Buffers (static to avoid stack overflow)
 static char s_response_buf[LLM_RESPONSE_BUF_SIZE];
 static char s_tool_result_buf[TOOL_RESULT_BUF_SIZE];
+static char s_system_prompt[sizeof(SYSTEM_PROMPT) + RECALL_PROMPT_MAX];
 
 typedef struct {
     int64_t started_us;
+    int64_t chat_id;
+    uint64_t queue_us;
+    size_t depth;                   // Messages still pending from the same chat
     uint64_t llm_us_total;
     uint64_t tool_us_total;
     int llm_calls;
@@ -73,9 +86,13 @@ static void metrics_log_request(const request_metrics_t *metrics, const char *ou
     }
 
     ESP_LOGI(TAG,
-             "METRIC request outcome=%s total_ms=%" PRIu32 " llm_ms=%" PRIu32
+             "METRIC request outcome=%s chat=%" PRId64 " queue_ms=%" PRIu32
+             " depth=%u total_ms=%" PRIu32 " llm_ms=%" PRIu32
              " tool_ms=%" PRIu32 " rounds=%d llm_calls=%d tool_calls=%d",
              outcome ? outcome : "unknown",
+             metrics->chat_id,
+             us_to_ms_u32(metrics->queue_us),
+             (unsigned)metrics->depth,
              us_to_ms_u32(elapsed_us_since(metrics->started_us)),
              us_to_ms_u32(metrics->llm_us_total),
              us_to_ms_u32(metrics->tool_us_total),
@@ -86,14 +103,14 @@ static void metrics_log_request(const request_metrics_t *metrics, const char *ou
 
 static void history_rollback_to(int marker, const char *reason)
 {
-    if (marker < 0 || marker > s_history_len || marker == s_history_len) {
+    if (marker < 0 || marker > s_ctx->len || marker == s_ctx->len) {
         return;
     }
 
     ESP_LOGW(TAG, "Rolling back conversation history (%d -> %d): %s",
-             s_history_len, marker, reason ? reason : "unknown");
-    memset(&s_history[marker], 0, (s_history_len - marker) * sizeof(conversation_msg_t));
-    s_history_len = marker;
+             s_ctx->len, marker, reason ? reason : "unknown");
+    memset(&s_ctx->history[marker], 0, (s_ctx->len - marker) * sizeof(conversation_msg_t));
+    s_ctx->len = marker;
 }
 
 // Add a message to history
@@ -103,12 +120,13 @@ static void history_add(const char *role, const char *content,
 {
     // Drop one oldest message when full.
     // Tool interactions can span more than 2 messages, so pair-based trimming is unsafe.
-    if (s_history_len >= MAX_HISTORY_TURNS * 2) {
-        memmove(&s_history[0], &s_history[1], (MAX_HISTORY_TURNS * 2 - 1) * sizeof(conversation_msg_t));
-        s_history_len -= 1;
+    if (s_ctx->len >= CHAT_CONTEXT_HISTORY_LEN) {
+        memmove(&s_ctx->history[0], &s_ctx->history[1],
+                (CHAT_CONTEXT_HISTORY_LEN - 1) * sizeof(conversation_msg_t));
+        s_ctx->len -= 1;
     }
 
-    conversation_msg_t *msg = &s_history[s_history_len++];
+    conversation_msg_t *msg = &s_ctx->history[s_ctx->len++];
     strncpy(msg->role, role, sizeof(msg->role) - 1);
     msg->role[sizeof(msg->role) - 1] = '\0';
     strncpy(msg->content, content, sizeof(msg->content) - 1);
@@ -153,6 +171,8 @@ static void queue_telegram_response(const char *text)
     }
 
     telegram_msg_t msg;
+    msg.chat_id = s_reply_chat_id;
+    msg.quick_actions = false;
     strncpy(msg.text, text, TELEGRAM_MAX_MSG_LEN - 1);
     msg.text[TELEGRAM_MAX_MSG_LEN - 1] = '\0';
 
@@ -161,9 +181,13 @@ static void queue_telegram_response(const char *text)
     }
 }
 
+// Replies go back to the chat the message came from. Local input (serial,
+// web relay, cron, the primary Telegram chat) keeps mirroring to both.
 static void send_response(const char *text)
 {
-    queue_channel_response(text);
+    if (s_reply_chat_id == CHAT_ID_LOCAL) {
+        queue_channel_response(text);
+    }
     queue_telegram_response(text);
 }
 
@@ -228,6 +252,7 @@ static void handle_start_command(void)
         "Control Telegram command intake:\n"
         "- /help (show help)\n"
         "- /settings (show status)\n"
+        "- /actions (quick action buttons)\n"
         "- /stop (pause)\n"
         "- /resume (resume)";
     send_response(START_HELP_TEXT);
@@ -239,19 +264,37 @@ static void handle_settings_command(void)
     snprintf(settings_text, sizeof(settings_text),
              "zclaw settings:\n"
              "- Message intake: %s\n"
-             "- Telegram commands: /start, /help, /settings, /stop, /resume\n"
+             "- Telegram commands: /start, /help, /settings, /actions, /stop, /resume\n"
              "- Device settings are global (e.g., timezone <name>)",
              s_messages_paused ? "paused" : "active");
     send_response(settings_text);
 }
 
+// Backends normally report usage; without it, estimate ~4 bytes per token.
+static void record_usage(ratelimit_class_t rate_class, size_t request_len)
+{
+    uint32_t input_tokens;
+    uint32_t output_tokens;
+
+    if (!json_get_parsed_usage(&input_tokens, &output_tokens)) {
+        input_tokens = (uint32_t)(request_len / 4);
+        output_tokens = (uint32_t)(strlen(s_response_buf) / 4);
+    }
+    ratelimit_record_usage(rate_class, input_tokens, output_tokens);
+}
+
 // Process a single user message
-static void process_message(const char *user_message)
+static void process_message(const channel_msg_t *in, uint64_t queue_us, size_t depth)
 {
-    ESP_LOGI(TAG, "Processing: %s", user_message);
-    int history_turn_start = s_history_len;
+    const char *user_message = in->text;
+
+    ESP_LOGI(TAG, "Processing (chat %" PRId64 "): %s", in->chat_id, user_message);
+    s_reply_chat_id = in->chat_id;
     request_metrics_t metrics = {
         .started_us = esp_timer_get_time(),
+        .chat_id = in->chat_id,
+        .queue_us = queue_us,
+        .depth = depth,
         .llm_us_total = 0,
         .tool_us_total = 0,
         .llm_calls = 0,
@@ -316,6 +359,18 @@ static void process_message(const char *user_message)
         return;
     }
 
+    bool motion_event = in->source == MSG_SOURCE_MOTION;
+    bool background = motion_event || in->source == MSG_SOURCE_CRON;
+    ratelimit_class_t rate_class = background ? RATELIMIT_CLASS_CRON : RATELIMIT_CLASS_INTERACTIVE;
+
+    s_ctx = chat_context_acquire(in->chat_id);
+    if (!s_ctx) {
+        send_response("Error: Out of memory for conversation history");
+        metrics_log_request(&metrics, "context_error");
+        return;
+    }
+    int history_turn_start = s_ctx->len;
+
     // Get tools
     int tool_count;
     const tool_def_t *tools = tools_get_all(&tool_count);
@@ -323,6 +378,13 @@ static void process_message(const char *user_message)
     // Add user message to history
     history_add("user", user_message, false, false, NULL, NULL);
 
+    // A photo left by an aborted turn must not ride along with this one; a
+    // motion event's photo goes out with its message in the first request.
+    media_release_pending();
+    if (motion_event) {
+        media_claim_event_image();
+    }
+
     int rounds = 0;
     bool done = false;
 
@@ -330,11 +392,29 @@ static void process_message(const char *user_message)
         rounds++;
         metrics.rounds = rounds;
 
+        // Check rate limit before any paid request, the recall embedding included
+        char rate_reason[128];
+        if (!ratelimit_check(rate_class, rate_reason, sizeof(rate_reason))) {
+            history_rollback_to(history_turn_start, "rate limited");
+            send_response(rate_reason);
+            metrics_log_request(&metrics, "rate_limited");
+            return;
+        }
+
+        // Relevant user memories ride along in the system prompt for every round,
+        // saving the memory_list/memory_get tool rounds.
+        if (rounds == 1) {
+            memcpy(s_system_prompt, SYSTEM_PROMPT, sizeof(SYSTEM_PROMPT));
+            recall_build_context(user_message, rate_class,
+                                 s_system_prompt + sizeof(SYSTEM_PROMPT) - 1,
+                                 RECALL_PROMPT_MAX + 1);
+        }
+
         // Build request JSON (user message already in history)
         char *request = json_build_request(
-            SYSTEM_PROMPT,
-            s_history,
-            s_history_len,
+            s_system_prompt,
+            s_ctx->history,
+            s_ctx->len,
             NULL,  // User message already in history
             tools,
             tool_count
@@ -350,16 +430,6 @@ static void process_message(const char *user_message)
 
         ESP_LOGI(TAG, "Request: %d bytes", (int)strlen(request));
 
-        // Check rate limit before making request
-        char rate_reason[128];
-        if (!ratelimit_check(rate_reason, sizeof(rate_reason))) {
-            free(request);
-            history_rollback_to(history_turn_start, "rate limited");
-            send_response(rate_reason);
-            metrics_log_request(&metrics, "rate_limited");
-            return;
-        }
-
         // Send to LLM with retry
         esp_err_t err = ESP_FAIL;
         int retry_delay_ms = LLM_RETRY_BASE_MS;
@@ -388,6 +458,7 @@ static void process_message(const char *user_message)
             }
         }
 
+        size_t request_len = strlen(request);
         free(request);
 
         // Release pending media now that the request has been sent
@@ -401,19 +472,20 @@ static void process_message(const char *user_message)
             return;
         }
 
-        // Record successful request for rate limiting
-        ratelimit_record_request();
-
         // Parse response
         char text_out[MAX_MESSAGE_LEN] = {0};
         char tool_name[32] = {0};
         char tool_id[64] = {0};
         cJSON *tool_input = NULL;
 
-        if (!json_parse_response(s_response_buf, text_out, sizeof(text_out),
-                                  tool_name, sizeof(tool_name),
-                                  tool_id, sizeof(tool_id),
-                                  &tool_input)) {
+        bool parsed = json_parse_response(s_response_buf, text_out, sizeof(text_out),
+                                          tool_name, sizeof(tool_name),
+                                          tool_id, sizeof(tool_id),
+                                          &tool_input);
+        // Charge the tokens the request actually used against the rate limit
+        record_usage(rate_class, request_len);
+
+        if (!parsed) {
             ESP_LOGE(TAG, "Failed to parse response");
             history_rollback_to(history_turn_start, "llm response parse failed");
             send_response("Error: Failed to parse LLM response");
@@ -449,8 +521,10 @@ static void process_message(const char *user_message)
                 metrics.tool_us_total += elapsed_us_since(tool_started_us);
                 ESP_LOGI(TAG, "Tool result: %s", s_tool_result_buf);
 
-                // If capture_photo produced a pending image, tag it with this tool_id
-                if (strcmp(tool_name, "capture_photo") == 0 && media_has_pending_image()) {
+                // If the tool produced a pending image (capture_photo,
+                // timelapse_sheet), tag it with this tool_id
+                const char *pending_id = NULL;
+                if (media_get_pending_image(NULL, NULL, &pending_id) && pending_id[0] == '\0') {
                     media_set_pending_tool_id(tool_id);
                 }
             }
@@ -485,11 +559,73 @@ static void process_message(const char *user_message)
     metrics_log_request(&metrics, "success");
 }
 
+static void *context_alloc(size_t size)
+{
+#if ZCLAW_HAS_PSRAM
+    void *ptr = heap_caps_malloc(size, MALLOC_CAP_SPIRAM);
+    if (ptr) {
+        return ptr;
+    }
+#endif
+    return malloc(size);
+}
+
+static void context_free(void *ptr)
+{
+    free(ptr);
+}
+
+static void context_record_key(int64_t chat_id, char *out, size_t out_len)
+{
+    snprintf(out, out_len, CHAT_RECORD_PREFIX "%016llx", (unsigned long long)chat_id);
+}
+
+// Evicted chats spill to zc_store; without it they simply start over.
+static bool context_save(int64_t chat_id, const char *record, void *ctx)
+{
+    char store_key[24];
+
+    (void)ctx;
+    if (!zc_store_is_mounted()) {
+        return false;
+    }
+    context_record_key(chat_id, store_key, sizeof(store_key));
+    esp_err_t err = zc_store_set(store_key, record);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to save history for chat %" PRId64 ": %s",
+                 chat_id, esp_err_to_name(err));
+        return false;
+    }
+    return true;
+}
+
+static bool context_load(int64_t chat_id, char *record, size_t record_len, void *ctx)
+{
+    char store_key[24];
+
+    (void)ctx;
+    if (!zc_store_is_mounted()) {
+        return false;
+    }
+    context_record_key(chat_id, store_key, sizeof(store_key));
+    return zc_store_get(store_key, record, &record_len) == ESP_OK;
+}
+
+static const chat_context_backend_t s_context_backend = {
+    .alloc = context_alloc,
+    .free = context_free,
+    .save = context_save,
+    .load = context_load,
+    .ctx = NULL,
+};
+
 #ifdef TEST_BUILD
 void agent_test_reset(void)
 {
-    memset(s_history, 0, sizeof(s_history));
-    s_history_len = 0;
+    chat_context_init(&s_context_backend);
+    s_ctx = NULL;
+    s_reply_chat_id = CHAT_ID_LOCAL;
+    chat_queue_init(&s_pending);
     memset(s_response_buf, 0, sizeof(s_response_buf));
     memset(s_tool_result_buf, 0, sizeof(s_tool_result_buf));
     s_channel_output_queue = NULL;
@@ -507,7 +643,24 @@ void agent_test_set_queues(QueueHandle_t channel_output_queue,
 
 void agent_test_process_message(const char *user_message)
 {
-    process_message(user_message);
+    agent_test_process_chat_message(CHAT_ID_LOCAL, user_message);
+}
+
+void agent_test_process_chat_message(int64_t chat_id, const char *user_message)
+{
+    agent_test_process_source_message(chat_id, MSG_SOURCE_USER, user_message);
+}
+
+void agent_test_process_source_message(int64_t chat_id, msg_source_t source,
+                                       const char *user_message)
+{
+    channel_msg_t msg;
+
+    msg.chat_id = chat_id;
+    msg.source = source;
+    strncpy(msg.text, user_message, sizeof(msg.text) - 1);
+    msg.text[sizeof(msg.text) - 1] = '\0';
+    process_message(&msg, 0, 0);
 }
 #endif
 
@@ -516,12 +669,22 @@ static void agent_task(void *arg)
 {
     (void)arg;
     channel_msg_t msg;
+    int64_t wait_us;
 
     ESP_LOGI(TAG, "Agent task started");
 
     while (1) {
-        if (xQueueReceive(s_input_queue, &msg, portMAX_DELAY) == pdTRUE) {
-            process_message(msg.text);
+        // Take everything already waiting so the next message is picked
+        // round-robin across chats rather than in arrival order.
+        TickType_t wait = chat_queue_count(&s_pending) == 0 ? portMAX_DELAY : 0;
+        while (!chat_queue_is_full(&s_pending) &&
+               xQueueReceive(s_input_queue, &msg, wait) == pdTRUE) {
+            chat_queue_push(&s_pending, &msg, esp_timer_get_time());
+            wait = 0;
+        }
+
+        if (chat_queue_pop(&s_pending, esp_timer_get_time(), &msg, &wait_us)) {
+            process_message(&msg, (uint64_t)wait_us, chat_queue_depth(&s_pending, msg.chat_id));
         }
     }
 }
@@ -538,6 +701,12 @@ esp_err_t agent_start(QueueHandle_t input_queue,
     s_input_queue = input_queue;
     s_channel_output_queue = channel_output_queue;
     s_telegram_output_queue = telegram_output_queue;
+    chat_queue_init(&s_pending);
+
+    if (!chat_context_init(&s_context_backend)) {
+        ESP_LOGE(TAG, "Failed to allocate conversation history");
+        return ESP_ERR_NO_MEM;
+    }
 
     if (xTaskCreate(agent_task, "agent", AGENT_TASK_STACK_SIZE, NULL,
                     AGENT_TASK_PRIORITY, NULL) != pdPASS) {
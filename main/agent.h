@@ -2,8 +2,10 @@
 #define AGENT_H
 
 #include "esp_err.h"
+#include "messages.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/queue.h"
+#include <stdint.h>
 
 // Start the agent task
 esp_err_t agent_start(QueueHandle_t input_queue,
@@ -16,6 +18,9 @@ void agent_test_reset(void);
 void agent_test_set_queues(QueueHandle_t channel_output_queue,
                            QueueHandle_t telegram_output_queue);
 void agent_test_process_message(const char *user_message);
+void agent_test_process_chat_message(int64_t chat_id, const char *user_message);
+void agent_test_process_source_message(int64_t chat_id, msg_source_t source,
+                                       const char *user_message);
 #endif
 
 #endif // AGENT_H
@@ -0,0 +1,354 @@
+#include "audio_stats.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+// Firmware builds with the microphone use the ESP-DSP radix-2 FFT, which
+// has assembly kernels for the ESP32 and ESP32-S3. Host tests, and builds
+// without it, use the plain C one below; both leave the same result.
+#if ZCLAW_HAS_MICROPHONE && !defined(TEST_BUILD)
+#define AUDIO_USE_ESP_DSP   1
+#include "esp_dsp.h"
+#else
+#define AUDIO_USE_ESP_DSP   0
+#endif
+
+#define SILENT_DBFS     (-100.0f)
+#define PI_F            3.14159265358979f
+#define BINS            (AUDIO_FFT_SIZE / 2 + 1)
+#define HOP             (AUDIO_FFT_SIZE / 2)
+
+// How far either side of a peak to look for the valley it rises from.
+#define PEAK_NEAR_BINS  12
+
+// Upper edge of each band but the last, in Hz.
+static const float s_band_edges_hz[AUDIO_BANDS - 1] = { 250.0f, 1000.0f, 4000.0f };
+static const char s_band_labels[] = "<250/250-1k/1-4k/>4k Hz";
+
+// Shared by every analysis: only the agent task runs one.
+static float s_window[AUDIO_FFT_SIZE];
+static float s_window_power;       // Sum of the squared window
+static bool s_tables_ready = false;
+
+#if !AUDIO_USE_ESP_DSP
+static float s_twiddle[AUDIO_FFT_SIZE];    // e^(-2 pi i k / N), k < N/2, interleaved
+
+static void fft(float *data, int n)
+{
+    for (int i = 1, j = 0; i < n; i++) {
+        int bit = n >> 1;
+        for (; j & bit; bit >>= 1) {
+            j ^= bit;
+        }
+        j ^= bit;
+        if (i < j) {
+            float re = data[2 * i];
+            float im = data[2 * i + 1];
+            data[2 * i] = data[2 * j];
+            data[2 * i + 1] = data[2 * j + 1];
+            data[2 * j] = re;
+            data[2 * j + 1] = im;
+        }
+    }
+
+    for (int len = 2; len <= n; len <<= 1) {
+        int stride = n / len;
+        for (int start = 0; start < n; start += len) {
+            for (int k = 0; k < len / 2; k++) {
+                float wr = s_twiddle[2 * k * stride];
+                float wi = s_twiddle[2 * k * stride + 1];
+                float *a = &data[2 * (start + k)];
+                float *b = &data[2 * (start + k + len / 2)];
+                float tr = b[0] * wr - b[1] * wi;
+                float ti = b[0] * wi + b[1] * wr;
+                b[0] = a[0] - tr;
+                b[1] = a[1] - ti;
+                a[0] += tr;
+                a[1] += ti;
+            }
+        }
+    }
+}
+#endif
+
+static bool init_tables(void)
+{
+    if (s_tables_ready) {
+        return true;
+    }
+    // Periodic Hann, which overlaps by half into a flat sum.
+    s_window_power = 0.0f;
+    for (int i = 0; i < AUDIO_FFT_SIZE; i++) {
+        s_window[i] = 0.5f - 0.5f * cosf(2.0f * PI_F * (float)i / (float)AUDIO_FFT_SIZE);
+        s_window_power += s_window[i] * s_window[i];
+    }
+#if AUDIO_USE_ESP_DSP
+    // With NULL, ESP-DSP allocates the twiddle table itself, which can fail.
+    esp_err_t err = dsps_fft2r_init_fc32(NULL, AUDIO_FFT_SIZE);
+    if (err != ESP_OK && err != ESP_ERR_DSP_REINITIALIZED) {
+        return false;
+    }
+#else
+    for (int k = 0; k < AUDIO_FFT_SIZE / 2; k++) {
+        s_twiddle[2 * k] = cosf(2.0f * PI_F * (float)k / (float)AUDIO_FFT_SIZE);
+        s_twiddle[2 * k + 1] = -sinf(2.0f * PI_F * (float)k / (float)AUDIO_FFT_SIZE);
+    }
+#endif
+    s_tables_ready = true;
+    return true;
+}
+
+bool audio_stats_init(audio_stats_t *stats, uint32_t sample_rate)
+{
+    if (!init_tables()) {
+        return false;
+    }
+    memset(stats, 0, sizeof(*stats));
+    stats->sample_rate = sample_rate;
+    return true;
+}
+
+// Add the full pending window to the averaged spectrum.
+static void analyze_window(audio_stats_t *stats)
+{
+    float mean = 0.0f;
+
+    for (int i = 0; i < AUDIO_FFT_SIZE; i++) {
+        mean += (float)stats->pending[i];
+    }
+    mean /= (float)AUDIO_FFT_SIZE;
+    for (int i = 0; i < AUDIO_FFT_SIZE; i++) {
+        stats->fft[2 * i] = ((float)stats->pending[i] - mean) * s_window[i];
+        stats->fft[2 * i + 1] = 0.0f;
+    }
+
+#if AUDIO_USE_ESP_DSP
+    dsps_fft2r_fc32(stats->fft, AUDIO_FFT_SIZE);
+    dsps_bit_rev_fc32(stats->fft, AUDIO_FFT_SIZE);
+#else
+    fft(stats->fft, AUDIO_FFT_SIZE);
+#endif
+
+    // Scaled so the bins sum to the window's mean square (Parseval), with
+    // the negative frequencies folded onto the positive ones.
+    float scale = 1.0f / ((float)AUDIO_FFT_SIZE * s_window_power);
+    for (int k = 0; k < BINS; k++) {
+        float re = stats->fft[2 * k];
+        float im = stats->fft[2 * k + 1];
+        float fold = (k == 0 || k == BINS - 1) ? 1.0f : 2.0f;
+        stats->power[k] += (re * re + im * im) * scale * fold;
+    }
+    stats->windows++;
+
+    memmove(stats->pending, stats->pending + HOP, (AUDIO_FFT_SIZE - HOP) * sizeof(int16_t));
+    stats->pending_len = AUDIO_FFT_SIZE - HOP;
+}
+
+void audio_stats_push(audio_stats_t *stats, const int16_t *samples, size_t n)
+{
+    for (size_t i = 0; i < n; i++) {
+        int32_t x = samples[i];
+        int32_t mag = x < 0 ? -x : x;
+
+        stats->sum += x;
+        stats->sum_sq += (uint64_t)((int64_t)x * x);
+        if (mag > stats->peak) {
+            stats->peak = mag;
+        }
+        if (mag >= AUDIO_CLIP_LEVEL) {
+            stats->clipped++;
+        }
+
+        stats->pending[stats->pending_len++] = samples[i];
+        if (stats->pending_len == AUDIO_FFT_SIZE) {
+            analyze_window(stats);
+        }
+    }
+    stats->count += (uint32_t)n;
+}
+
+static float to_dbfs(float mean_square)
+{
+    if (mean_square <= 0.0f) {
+        return SILENT_DBFS;
+    }
+    float dbfs = 10.0f * log10f(mean_square / (32768.0f * 32768.0f));
+    return dbfs < SILENT_DBFS ? SILENT_DBFS : dbfs;
+}
+
+// A local maximum that rises AUDIO_PEAK_PROMINENCE_DB from the valleys on
+// both sides, walking out until a higher bin or PEAK_NEAR_BINS. A tone next
+// to a louder one (50 and 100 Hz hum, three bins apart) still counts, while
+// broadband noise has no such bins once a few windows are averaged.
+static bool is_tone(const float *power, int k)
+{
+    float left = power[k];
+    float right = power[k];
+
+    if (power[k - 1] >= power[k] || power[k + 1] > power[k]) {
+        return false;
+    }
+    for (int j = k - 1; j >= 1 && j >= k - PEAK_NEAR_BINS && power[j] <= power[k]; j--) {
+        if (power[j] < left) {
+            left = power[j];
+        }
+    }
+    for (int j = k + 1; j < BINS && j <= k + PEAK_NEAR_BINS && power[j] <= power[k]; j++) {
+        if (power[j] < right) {
+            right = power[j];
+        }
+    }
+    float valley = left > right ? left : right;
+    return power[k] > valley * powf(10.0f, (float)AUDIO_PEAK_PROMINENCE_DB / 10.0f);
+}
+
+// Share of a tone's power landing in a bin offset bins from it: the Hann
+// window's response, which is 2/3 for a tone centred on the bin.
+static float hann_bin_share(float offset)
+{
+    float x = PI_F * offset;
+    float gain = fabsf(offset) < 1e-4f ? 1.0f : sinf(x) / x / (1.0f - offset * offset);
+    return gain * gain * (2.0f / 3.0f);
+}
+
+static void find_peaks(const audio_stats_t *stats, audio_summary_t *out)
+{
+    const float *power = stats->power;
+    float bin_hz = (float)stats->sample_rate / (float)AUDIO_FFT_SIZE;
+    float total = 0.0f;
+
+    for (int k = 1; k < BINS; k++) {
+        total += power[k];
+    }
+    // Much quieter "tones" are rounding and sidelobe artifacts of louder ones.
+    float min_tone = total * powf(10.0f, -(float)AUDIO_PEAK_RANGE_DB / 10.0f);
+
+    out->peak_count = 0;
+    for (int k = 2; k < BINS - 1; k++) {
+        if (!is_tone(power, k)) {
+            continue;
+        }
+
+        // Parabola through the log power of the peak and its neighbours
+        // finds the tone between bins; the peak bin's power, scaled by the
+        // window's response there, gives its level without the neighbours'
+        // leakage.
+        float a = logf(power[k - 1] + 1e-12f);
+        float b = logf(power[k] + 1e-12f);
+        float c = logf(power[k + 1] + 1e-12f);
+        float denom = a - 2.0f * b + c;
+        float offset = denom < 0.0f ? 0.5f * (a - c) / denom : 0.0f;
+        float tone = power[k] / hann_bin_share(offset);
+        if (tone < min_tone) {
+            continue;
+        }
+
+        audio_peak_t peak = {
+            .freq_hz = ((float)k + offset) * bin_hz,
+            .level_dbfs = to_dbfs(tone / (float)stats->windows),
+        };
+
+        // Insert loudest first, dropping the quietest when full.
+        int pos = out->peak_count;
+        while (pos > 0 && out->peaks[pos - 1].level_dbfs < peak.level_dbfs) {
+            if (pos < AUDIO_PEAKS_MAX) {
+                out->peaks[pos] = out->peaks[pos - 1];
+            }
+            pos--;
+        }
+        if (pos < AUDIO_PEAKS_MAX) {
+            out->peaks[pos] = peak;
+            if (out->peak_count < AUDIO_PEAKS_MAX) {
+                out->peak_count++;
+            }
+        }
+    }
+}
+
+static void find_bands(const audio_stats_t *stats, audio_summary_t *out)
+{
+    float bin_hz = (float)stats->sample_rate / (float)AUDIO_FFT_SIZE;
+    float band[AUDIO_BANDS] = {0};
+    float total = 0.0f;
+
+    for (int k = 1; k < BINS; k++) {
+        float freq = (float)k * bin_hz;
+        int b = 0;
+        while (b < AUDIO_BANDS - 1 && freq >= s_band_edges_hz[b]) {
+            b++;
+        }
+        band[b] += stats->power[k];
+        total += stats->power[k];
+    }
+    for (int b = 0; b < AUDIO_BANDS; b++) {
+        out->band_pct[b] = total > 0.0f ? (uint8_t)(band[b] * 100.0f / total + 0.5f) : 0;
+    }
+}
+
+void audio_stats_finish(const audio_stats_t *stats, audio_summary_t *out)
+{
+    memset(out, 0, sizeof(*out));
+    out->duration_ms = stats->sample_rate > 0
+        ? (uint32_t)((uint64_t)stats->count * 1000 / stats->sample_rate) : 0;
+    out->rms_dbfs = SILENT_DBFS;
+    out->peak_dbfs = SILENT_DBFS;
+    if (stats->count == 0) {
+        return;
+    }
+
+    double mean = (double)stats->sum / (double)stats->count;
+    double mean_square = (double)stats->sum_sq / (double)stats->count - mean * mean;
+    out->rms_dbfs = to_dbfs((float)mean_square);
+    out->peak_dbfs = to_dbfs((float)stats->peak * (float)stats->peak);
+    out->clip_pct = (float)stats->clipped * 100.0f / (float)stats->count;
+
+    if (stats->windows == 0) {
+        return;
+    }
+    out->has_spectrum = true;
+    find_peaks(stats, out);
+    find_bands(stats, out);
+}
+
+size_t audio_stats_format(const audio_summary_t *summary, char *buf, size_t buf_len)
+{
+    size_t len = 0;
+    int n;
+
+    if (buf_len == 0) {
+        return 0;
+    }
+    buf[0] = '\0';
+
+#define APPEND(...) do { \
+        n = snprintf(buf + len, buf_len - len, __VA_ARGS__); \
+        if (n < 0 || (size_t)n >= buf_len - len) { \
+            return strlen(buf); \
+        } \
+        len += (size_t)n; \
+    } while (0)
+
+    APPEND("Audio %u.%u s: RMS %.1f dBFS, peak %.1f dBFS, clipped %.2f%%.",
+           (unsigned)(summary->duration_ms / 1000), (unsigned)(summary->duration_ms % 1000 / 100),
+           (double)summary->rms_dbfs, (double)summary->peak_dbfs, (double)summary->clip_pct);
+    if (!summary->has_spectrum) {
+        APPEND(" Too short for a spectrum.");
+        return len;
+    }
+
+    if (summary->peak_count == 0) {
+        APPEND(" No tones.");
+    }
+    for (int i = 0; i < summary->peak_count; i++) {
+        APPEND(i == 0 ? " Tones: %.0f Hz %.0f dBFS" : ", %.0f Hz %.0f",
+               (double)summary->peaks[i].freq_hz, (double)summary->peaks[i].level_dbfs);
+    }
+    if (summary->peak_count > 0) {
+        APPEND(".");
+    }
+    APPEND(" Bands %s: %u/%u/%u/%u%%", s_band_labels,
+           summary->band_pct[0], summary->band_pct[1], summary->band_pct[2], summary->band_pct[3]);
+
+#undef APPEND
+    return len;
+}
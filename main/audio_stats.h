@@ -0,0 +1,57 @@
+#ifndef AUDIO_STATS_H
+#define AUDIO_STATS_H
+
+#include "config.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Levels and a spectrum summary of microphone audio, for questions like "is
+// the pump running?" that need no transcript. Samples stream in any chunk
+// size; memory stays one FFT window whatever the duration. The spectrum is
+// the average of Hann-windowed AUDIO_FFT_SIZE FFTs overlapping by half
+// (Welch), with DC removed, so a steady tone stands well clear of noise.
+
+#define AUDIO_BANDS     4           // <250 Hz, 250 Hz-1 kHz, 1-4 kHz, >4 kHz
+
+typedef struct {
+    float freq_hz;                  // Interpolated between bins
+    float level_dbfs;               // Power of the tone alone
+} audio_peak_t;
+
+typedef struct {
+    uint32_t duration_ms;
+    float rms_dbfs;                 // DC removed
+    float peak_dbfs;                // Largest sample, DC included
+    float clip_pct;                 // Samples at AUDIO_CLIP_LEVEL or beyond
+    int peak_count;
+    audio_peak_t peaks[AUDIO_PEAKS_MAX];    // Loudest first
+    bool has_spectrum;              // At least one full window was heard
+    uint8_t band_pct[AUDIO_BANDS];  // Share of the spectrum's power
+} audio_summary_t;
+
+typedef struct {
+    uint32_t sample_rate;
+    int16_t pending[AUDIO_FFT_SIZE];        // Samples for the next window
+    int pending_len;
+    float fft[AUDIO_FFT_SIZE * 2];          // Interleaved complex work buffer
+    float power[AUDIO_FFT_SIZE / 2 + 1];    // Summed mean square per bin
+    uint32_t windows;
+    uint32_t count;
+    int64_t sum;
+    uint64_t sum_sq;
+    int32_t peak;
+    uint32_t clipped;
+} audio_stats_t;
+
+// False if the FFT tables could not be set up.
+bool audio_stats_init(audio_stats_t *stats, uint32_t sample_rate);
+
+void audio_stats_push(audio_stats_t *stats, const int16_t *samples, size_t n);
+
+void audio_stats_finish(const audio_stats_t *stats, audio_summary_t *out);
+
+// One line under AUDIO_SUMMARY_MAX bytes. Returns the length written.
+size_t audio_stats_format(const audio_summary_t *summary, char *buf, size_t buf_len);
+
+#endif // AUDIO_STATS_H
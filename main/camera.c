@@ -4,10 +4,36 @@
 
 #include "esp_log.h"
 #include "esp_camera.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include <string.h>
 
 static const char *TAG = "camera";
 
 static bool s_initialized = false;
+static SemaphoreHandle_t s_mutex = NULL;
+static cam_setting_t s_setting = { CAM_SIZE_VGA, CAM_JPEG_QUALITY };
+static int s_frames_held = 0;       // Driver buffers handed out (under s_mutex)
+
+// The frame buffer is allocated for the init framesize, so start at the
+// largest one we will ask for and step down to VGA afterwards.
+#if ZCLAW_HAS_PSRAM
+#define CAM_MAX_SIZE    CAM_SIZE_UXGA
+#else
+#define CAM_MAX_SIZE    CAM_SIZE_VGA
+#endif
+
+static const framesize_t s_framesizes[CAM_SIZE_COUNT] = {
+    [CAM_SIZE_QQVGA] = FRAMESIZE_QQVGA,
+    [CAM_SIZE_QVGA]  = FRAMESIZE_QVGA,
+    [CAM_SIZE_CIF]   = FRAMESIZE_CIF,
+    [CAM_SIZE_VGA]   = FRAMESIZE_VGA,
+    [CAM_SIZE_SVGA]  = FRAMESIZE_SVGA,
+    [CAM_SIZE_XGA]   = FRAMESIZE_XGA,
+    [CAM_SIZE_SXGA]  = FRAMESIZE_SXGA,
+    [CAM_SIZE_UXGA]  = FRAMESIZE_UXGA,
+};
 
 esp_err_t camera_init(void)
 {
@@ -16,6 +42,13 @@ esp_err_t camera_init(void)
         return ESP_OK;
     }
 
+    if (!s_mutex) {
+        s_mutex = xSemaphoreCreateRecursiveMutex();
+        if (!s_mutex) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
     camera_config_t config = {
         .pin_pwdn     = CAM_PIN_PWDN,
         .pin_reset    = CAM_PIN_RESET,
@@ -39,10 +72,14 @@ esp_err_t camera_init(void)
         .ledc_channel = LEDC_CHANNEL_0,
 
         .pixel_format = PIXFORMAT_JPEG,
-        .frame_size   = FRAMESIZE_VGA,      // 640x480
+        .frame_size   = s_framesizes[CAM_MAX_SIZE],
         .jpeg_quality = CAM_JPEG_QUALITY,
         .fb_count     = CAM_FB_COUNT,
-        .grab_mode    = CAMERA_GRAB_LATEST,
+#if CAM_FB_COUNT > 1
+        .grab_mode    = CAMERA_GRAB_LATEST,     // Keep filling the free buffers
+#else
+        .grab_mode    = CAMERA_GRAB_WHEN_EMPTY,
+#endif
 #if ZCLAW_HAS_PSRAM
         .fb_location  = CAMERA_FB_IN_PSRAM,
 #else
@@ -56,36 +93,159 @@ esp_err_t camera_init(void)
         return err;
     }
 
+    sensor_t *sensor = esp_camera_sensor_get();
+    if (!sensor || sensor->set_framesize(sensor, s_framesizes[s_setting.size]) != 0) {
+        ESP_LOGE(TAG, "camera framesize setup failed");
+        esp_camera_deinit();
+        return ESP_FAIL;
+    }
+
     s_initialized = true;
-    ESP_LOGI(TAG, "camera initialized (VGA JPEG, quality %d)", CAM_JPEG_QUALITY);
+    ESP_LOGI(TAG, "camera initialized (VGA JPEG, quality %d, up to %s)",
+             CAM_JPEG_QUALITY, cam_size_name(CAM_MAX_SIZE));
     return ESP_OK;
 }
 
-bool camera_capture_jpeg(const uint8_t **buf, size_t *len)
+bool camera_lock(uint32_t timeout_ms)
+{
+    if (!s_mutex) {
+        return false;
+    }
+    return xSemaphoreTakeRecursive(s_mutex, pdMS_TO_TICKS(timeout_ms)) == pdTRUE;
+}
+
+void camera_unlock(void)
 {
+    if (s_mutex) {
+        xSemaphoreGiveRecursive(s_mutex);
+    }
+}
+
+// For the short driver sections below, which wait as long as it takes.
+// portMAX_DELAY is in ticks, so it can't go through camera_lock()'s ms.
+static bool lock_forever(void)
+{
+    return s_mutex && xSemaphoreTakeRecursive(s_mutex, portMAX_DELAY) == pdTRUE;
+}
+
+static bool apply_setting_locked(cam_setting_t setting)
+{
+    if (setting.size > CAM_MAX_SIZE) {
+        setting.size = CAM_MAX_SIZE;
+    }
+    if (setting.size == s_setting.size && setting.quality == s_setting.quality) {
+        return true;
+    }
+
+    sensor_t *sensor = esp_camera_sensor_get();
+    if (!sensor) {
+        return false;
+    }
+    if (setting.size != s_setting.size &&
+        sensor->set_framesize(sensor, s_framesizes[setting.size]) != 0) {
+        ESP_LOGE(TAG, "set framesize %s failed", cam_size_name(setting.size));
+        return false;
+    }
+    if (setting.quality != s_setting.quality && sensor->set_quality(sensor, setting.quality) != 0) {
+        ESP_LOGE(TAG, "set quality %d failed", setting.quality);
+        return false;
+    }
+    s_setting = setting;
+
+    // Frames already in the free buffers were taken with the old setting.
+    for (int i = s_frames_held; i < CAM_FB_COUNT; i++) {
+        camera_fb_t *stale = esp_camera_fb_get();
+        if (!stale) {
+            break;
+        }
+        esp_camera_fb_return(stale);
+    }
+    return true;
+}
+
+bool camera_apply_setting(cam_setting_t setting)
+{
+    if (!s_initialized) {
+        ESP_LOGE(TAG, "camera not initialized");
+        return false;
+    }
+    if (!lock_forever()) {
+        return false;
+    }
+    bool ok = apply_setting_locked(setting);
+    camera_unlock();
+    return ok;
+}
+
+cam_size_t camera_max_size(void)
+{
+    return CAM_MAX_SIZE;
+}
+
+// The driver stamps frames with esp_timer time.
+static int64_t fb_time_us(const camera_fb_t *fb)
+{
+    return (int64_t)fb->timestamp.tv_sec * 1000000 + fb->timestamp.tv_usec;
+}
+
+bool camera_frame_get(cam_frame_t *frame)
+{
+    camera_fb_t *fb = NULL;
+
+    memset(frame, 0, sizeof(*frame));
     if (!s_initialized) {
         ESP_LOGE(TAG, "camera not initialized");
         return false;
     }
 
-    camera_fb_t *fb = esp_camera_fb_get();
+    if (!lock_forever()) {
+        return false;
+    }
+    if (s_frames_held >= CAM_FB_COUNT) {
+        // esp_camera_fb_get() would only block until its own timeout.
+        ESP_LOGW(TAG, "all %d frame buffers held", CAM_FB_COUNT);
+    } else {
+        fb = esp_camera_fb_get();
+        if (fb && esp_timer_get_time() - fb_time_us(fb) > CAM_FRAME_MAX_AGE_MS * 1000LL) {
+            // Filled when the buffer was last returned, maybe minutes ago.
+            esp_camera_fb_return(fb);
+            fb = esp_camera_fb_get();
+        }
+        if (fb) {
+            s_frames_held++;
+        }
+    }
+    camera_unlock();
     if (!fb) {
         ESP_LOGE(TAG, "frame capture failed");
         return false;
     }
 
-    *buf = fb->buf;
-    *len = fb->len;
-    ESP_LOGI(TAG, "captured %u bytes JPEG (%ux%u)", (unsigned)fb->len, fb->width, fb->height);
+    frame->buf = fb->buf;
+    frame->len = fb->len;
+    frame->width = (uint16_t)fb->width;
+    frame->height = (uint16_t)fb->height;
+    frame->captured_us = fb_time_us(fb);
+    frame->fb = fb;
+    ESP_LOGI(TAG, "captured %u bytes JPEG (%ux%u)", (unsigned)frame->len,
+             (unsigned)frame->width, (unsigned)frame->height);
     return true;
 }
 
-void camera_release_frame(void)
+void camera_frame_release(cam_frame_t *frame)
 {
-    camera_fb_t *fb = esp_camera_fb_get();
-    if (fb) {
-        esp_camera_fb_return(fb);
+    if (!frame || !frame->fb) {
+        return;
     }
+    if (!lock_forever()) {
+        return;
+    }
+    esp_camera_fb_return((camera_fb_t *)frame->fb);
+    s_frames_held--;
+    camera_unlock();
+    frame->fb = NULL;
+    frame->buf = NULL;
+    frame->len = 0;
 }
 
 void camera_deinit(void)
@@ -93,7 +253,11 @@ void camera_deinit(void)
     if (!s_initialized) {
         return;
     }
+    if (s_frames_held > 0) {
+        ESP_LOGW(TAG, "deinit with %d frame buffer(s) still held", s_frames_held);
+    }
     esp_camera_deinit();
+    s_frames_held = 0;
     s_initialized = false;
     ESP_LOGI(TAG, "camera deinitialized");
 }
@@ -7,20 +7,47 @@
 
 #include <stddef.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include "esp_err.h"
+#include "camera_budget.h"
 
 // Initialize the OV2640 camera sensor.
 // Returns ESP_OK on success, error code on failure.
 esp_err_t camera_init(void);
 
-// Capture a single JPEG frame.
-// On success, sets *buf to the JPEG data and *len to its size.
-// The caller must call camera_release_frame() when done with the buffer.
-// Returns true on success, false on failure.
-bool camera_capture_jpeg(const uint8_t **buf, size_t *len);
-
-// Release a previously captured frame buffer.
-void camera_release_frame(void);
+// A captured JPEG frame. It holds one of the driver's CAM_FB_COUNT frame
+// buffers until camera_frame_release(); the buffer is not copied.
+typedef struct {
+    const uint8_t *buf;
+    size_t len;
+    uint16_t width;
+    uint16_t height;
+    int64_t captured_us;            // esp_timer time the sensor finished it
+    void *fb;                       // Driver handle, NULL when not held
+} cam_frame_t;
+
+// Take the newest frame. With CAM_FB_COUNT > 1 the driver keeps grabbing,
+// so this usually returns a buffer that is already filled; a frame older
+// than CAM_FRAME_MAX_AGE_MS is handed back and a fresh one taken instead.
+// Fails without waiting when every frame buffer is already held.
+bool camera_frame_get(cam_frame_t *frame);
+
+// Switch framesize and JPEG quality for the next capture. A change drops
+// one frame so the next capture reflects it. Returns false on sensor error.
+bool camera_apply_setting(cam_setting_t setting);
+
+// Largest framesize the frame buffer was sized for.
+cam_size_t camera_max_size(void);
+
+// Hold the camera across several calls (setting, capture, release) so the
+// motion sampler and capture_photo don't interleave. Recursive; the calls
+// above also take it on their own. Returns false on timeout.
+bool camera_lock(uint32_t timeout_ms);
+void camera_unlock(void);
+
+// Return the frame's buffer to the driver. Safe to call on a frame that
+// was never taken or is already released.
+void camera_frame_release(cam_frame_t *frame);
 
 // Deinitialize the camera and free resources.
 void camera_deinit(void);
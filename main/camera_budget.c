@@ -0,0 +1,162 @@
+#include "camera_budget.h"
+#include <string.h>
+
+// Plain-scene JPEG bytes per pixel at quality q: BPP_SCALE / (q + BPP_Q0).
+// Fitted to OV2640 frames of an indoor view (VGA, quality 12 ~ 25 KB).
+#define BPP_SCALE   1.3f
+#define BPP_Q0      4.0f
+
+static const struct {
+    uint16_t width;
+    uint16_t height;
+    const char *name;
+} s_sizes[CAM_SIZE_COUNT] = {
+    [CAM_SIZE_QQVGA] = { 160, 120, "QQVGA" },
+    [CAM_SIZE_QVGA]  = { 320, 240, "QVGA" },
+    [CAM_SIZE_CIF]   = { 400, 296, "CIF" },
+    [CAM_SIZE_VGA]   = { 640, 480, "VGA" },
+    [CAM_SIZE_SVGA]  = { 800, 600, "SVGA" },
+    [CAM_SIZE_XGA]   = { 1024, 768, "XGA" },
+    [CAM_SIZE_SXGA]  = { 1280, 1024, "SXGA" },
+    [CAM_SIZE_UXGA]  = { 1600, 1200, "UXGA" },
+};
+
+static const struct {
+    const char *purpose;
+    cam_budget_goal_t goal;
+} s_purposes[] = {
+    // Is anyone there, is the light on: small and quick to send.
+    { "glance",    { 12 * 1024, CAM_SIZE_CIF, 10, 40 } },
+    // General look at the room; the old fixed VGA / quality 12 when it fits.
+    { "scene",     { 40 * 1024, CAM_SIZE_VGA, 12, 30 } },
+    // Labels, screens, documents: resolution first, quality kept legible.
+    { "read_text", { 96 * 1024, CAM_SIZE_UXGA, 6, 20 } },
+};
+
+uint16_t cam_size_width(cam_size_t size)
+{
+    return size < CAM_SIZE_COUNT ? s_sizes[size].width : 0;
+}
+
+uint16_t cam_size_height(cam_size_t size)
+{
+    return size < CAM_SIZE_COUNT ? s_sizes[size].height : 0;
+}
+
+const char *cam_size_name(cam_size_t size)
+{
+    return size < CAM_SIZE_COUNT ? s_sizes[size].name : "?";
+}
+
+bool cam_budget_goal_for_purpose(const char *purpose, cam_budget_goal_t *goal)
+{
+    if (!purpose) {
+        purpose = "scene";
+    }
+    for (size_t i = 0; i < sizeof(s_purposes) / sizeof(s_purposes[0]); i++) {
+        if (strcmp(s_purposes[i].purpose, purpose) == 0) {
+            *goal = s_purposes[i].goal;
+            return true;
+        }
+    }
+    return false;
+}
+
+void cam_scene_model_init(cam_scene_model_t *model)
+{
+    model->complexity = 1.0f;
+    model->learned = false;
+}
+
+static float plain_bytes(cam_setting_t setting)
+{
+    float pixels = (float)cam_size_width(setting.size) * (float)cam_size_height(setting.size);
+    return pixels * BPP_SCALE / ((float)setting.quality + BPP_Q0);
+}
+
+size_t cam_budget_predict(const cam_scene_model_t *model, cam_setting_t setting)
+{
+    return (size_t)(plain_bytes(setting) * model->complexity);
+}
+
+bool cam_budget_plan(const cam_scene_model_t *model, const cam_budget_goal_t *goal,
+                     const cam_setting_t *after, cam_setting_t *out)
+{
+    size_t target = goal->budget / 100 * CAM_BUDGET_MARGIN_PCT;
+    size_t ceiling = after ? cam_budget_predict(model, *after) : (size_t)-1;
+    bool found_cheaper = false;
+
+    for (int size = (int)goal->max_size; size >= 0; size--) {
+        for (int q = goal->best_quality; q <= goal->worst_quality; q++) {
+            cam_setting_t setting = { (cam_size_t)size, q };
+            size_t predicted = cam_budget_predict(model, setting);
+            if (predicted >= ceiling) {
+                continue;
+            }
+            if (predicted <= target) {
+                *out = setting;
+                return true;
+            }
+            found_cheaper = true;
+        }
+    }
+
+    // Nothing is predicted to fit: take the cheapest setting left.
+    if (after && !found_cheaper) {
+        return false;
+    }
+    out->size = CAM_SIZE_QQVGA;
+    out->quality = goal->worst_quality;
+    return true;
+}
+
+void cam_budget_learn(cam_scene_model_t *model, cam_setting_t setting, size_t jpeg_len)
+{
+    float observed = (float)jpeg_len / plain_bytes(setting);
+
+    if (!model->learned || observed > model->complexity) {
+        model->complexity = observed;
+        model->learned = true;
+        return;
+    }
+    model->complexity += (observed - model->complexity) * (CAM_BUDGET_LEARN_PCT / 100.0f);
+}
+
+bool cam_budget_capture(cam_scene_model_t *model, const cam_budget_goal_t *goal,
+                        cam_budget_capture_fn capture, void *ctx, cam_budget_result_t *result)
+{
+    cam_setting_t setting;
+
+    memset(result, 0, sizeof(*result));
+    cam_budget_plan(model, goal, NULL, &setting);
+
+    while (true) {
+        size_t jpeg_len = 0;
+        if (!capture(setting, &jpeg_len, ctx)) {
+            return false;
+        }
+        result->attempts++;
+        result->setting = setting;
+        result->jpeg_len = jpeg_len;
+        result->within_budget = jpeg_len <= goal->budget;
+        cam_budget_learn(model, setting, jpeg_len);
+
+        if (result->within_budget || result->attempts >= CAM_BUDGET_MAX_ATTEMPTS) {
+            return true;
+        }
+        cam_setting_t previous = setting;
+        if (!cam_budget_plan(model, goal, &previous, &setting)) {
+            return true;
+        }
+    }
+}
+
+uint32_t cam_budget_upload_ms(size_t jpeg_len, uint32_t bytes_per_s)
+{
+    uint64_t encoded = 4 * (((uint64_t)jpeg_len + 2) / 3);
+
+    if (bytes_per_s == 0) {
+        return 0;
+    }
+    return (uint32_t)(encoded * 1000 / bytes_per_s);
+}
@@ -0,0 +1,90 @@
+#ifndef CAMERA_BUDGET_H
+#define CAMERA_BUDGET_H
+
+#include "config.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Picks a JPEG framesize and quality so a photo lands under a byte budget,
+// using a one-number model of how much the current scene compresses. The
+// model is corrected after every capture, so a repeat photo of the same
+// view usually fits on the first try.
+
+// Sensor framesizes we choose between, smallest first.
+typedef enum {
+    CAM_SIZE_QQVGA = 0,     // 160x120
+    CAM_SIZE_QVGA,          // 320x240
+    CAM_SIZE_CIF,           // 400x296
+    CAM_SIZE_VGA,           // 640x480
+    CAM_SIZE_SVGA,          // 800x600
+    CAM_SIZE_XGA,           // 1024x768
+    CAM_SIZE_SXGA,          // 1280x1024
+    CAM_SIZE_UXGA,          // 1600x1200
+    CAM_SIZE_COUNT
+} cam_size_t;
+
+typedef struct {
+    cam_size_t size;
+    int quality;            // 0-63, lower = better quality
+} cam_setting_t;
+
+// What a capture is for: byte budget, largest framesize worth using, and the
+// range of JPEG quality the purpose tolerates.
+typedef struct {
+    size_t budget;
+    cam_size_t max_size;
+    int best_quality;
+    int worst_quality;
+} cam_budget_goal_t;
+
+typedef struct {
+    float complexity;       // Observed bytes / predicted bytes for a plain scene
+    bool learned;
+} cam_scene_model_t;
+
+typedef struct {
+    cam_setting_t setting;  // Setting of the frame that was kept
+    size_t jpeg_len;
+    int attempts;
+    bool within_budget;
+} cam_budget_result_t;
+
+// Apply setting, capture a frame and report its JPEG size. Called again for
+// a retry, in which case it must drop the previous frame first.
+typedef bool (*cam_budget_capture_fn)(cam_setting_t setting, size_t *jpeg_len, void *ctx);
+
+uint16_t cam_size_width(cam_size_t size);
+uint16_t cam_size_height(cam_size_t size);
+const char *cam_size_name(cam_size_t size);
+
+// Goal for "glance", "scene" or "read_text"; NULL means "scene". Returns
+// false for an unknown purpose.
+bool cam_budget_goal_for_purpose(const char *purpose, cam_budget_goal_t *goal);
+
+void cam_scene_model_init(cam_scene_model_t *model);
+
+// Predicted JPEG bytes for setting under the model.
+size_t cam_budget_predict(const cam_scene_model_t *model, cam_setting_t setting);
+
+// Largest framesize, then best quality, predicted to fit the goal's budget
+// with CAM_BUDGET_MARGIN_PCT headroom. With after set, only settings
+// predicted smaller than after are considered; returns false when there is
+// none. Without after, falls back to the cheapest setting and returns true.
+bool cam_budget_plan(const cam_scene_model_t *model, const cam_budget_goal_t *goal,
+                     const cam_setting_t *after, cam_setting_t *out);
+
+// Fold a captured frame's size into the model. Raises the estimate at once
+// when the frame came out bigger than expected, lowers it gradually.
+void cam_budget_learn(cam_scene_model_t *model, cam_setting_t setting, size_t jpeg_len);
+
+// Capture until a frame fits the budget, at most CAM_BUDGET_MAX_ATTEMPTS
+// times. The last frame is kept even when it is still over budget. Returns
+// false only if capture() failed.
+bool cam_budget_capture(cam_scene_model_t *model, const cam_budget_goal_t *goal,
+                        cam_budget_capture_fn capture, void *ctx, cam_budget_result_t *result);
+
+// Milliseconds to upload jpeg_len bytes base64-encoded at bytes_per_s.
+uint32_t cam_budget_upload_ms(size_t jpeg_len, uint32_t bytes_per_s);
+
+#endif // CAMERA_BUDGET_H
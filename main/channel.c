@@ -192,6 +192,8 @@ static void channel_read_task(void *arg)
 
                     // Push to input queue
                     channel_msg_t msg;
+                    msg.chat_id = CHAT_ID_LOCAL;
+                    msg.source = MSG_SOURCE_USER;
                     strncpy(msg.text, line_buf, CHANNEL_RX_BUF_SIZE - 1);
                     msg.text[CHANNEL_RX_BUF_SIZE - 1] = '\0';
 
@@ -0,0 +1,266 @@
+#include "chat_context.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define RECORD_MAGIC    "c1\n"
+#define FIELD_SEP       '\x1f'
+#define MESSAGE_END     '\x1e'
+
+static chat_context_backend_t s_backend = { malloc, free, NULL, NULL, NULL };
+static chat_context_t s_slots[CHAT_CONTEXT_SLOTS];
+static char *s_record = NULL;       // CHAT_CONTEXT_RECORD_MAX scratch for spills
+static uint32_t s_clock = 0;
+
+// Message kinds in a record: plain user/assistant, tool call, tool result.
+static char message_kind(const conversation_msg_t *msg)
+{
+    if (msg->is_tool_use) {
+        return 'T';
+    }
+    if (msg->is_tool_result) {
+        return 'R';
+    }
+    return strcmp(msg->role, "assistant") == 0 ? 'A' : 'U';
+}
+
+static size_t encoded_len(const conversation_msg_t *msg)
+{
+    // Kind, three separated fields, terminator.
+    return 1 + strlen(msg->tool_id) + 1 + strlen(msg->tool_name) + 1 + strlen(msg->content) + 1;
+}
+
+// Copy text with the record delimiters blanked out.
+static char *put_field(char *out, const char *text)
+{
+    for (; *text; text++) {
+        *out++ = (*text == FIELD_SEP || *text == MESSAGE_END) ? ' ' : *text;
+    }
+    return out;
+}
+
+// Read up to sep into dst (truncating to dst_len). Returns the position after
+// sep, or NULL when the record ends first.
+static const char *get_field(const char *in, char sep, char *dst, size_t dst_len)
+{
+    size_t len = 0;
+    while (*in && *in != sep) {
+        if (len + 1 < dst_len) {
+            dst[len++] = *in;
+        }
+        in++;
+    }
+    dst[len] = '\0';
+    return *in == sep ? in + 1 : NULL;
+}
+
+size_t chat_context_encode(const conversation_msg_t *history, int len,
+                           char *out, size_t out_len)
+{
+    size_t budget;
+    size_t used = 0;
+    int start = len;
+
+    if (!history || !out || out_len <= sizeof(RECORD_MAGIC)) {
+        return 0;
+    }
+    budget = out_len - sizeof(RECORD_MAGIC);
+
+    // Walk back from the newest message; remember the oldest plain user turn
+    // whose suffix still fits.
+    for (int i = len - 1; i >= 0; i--) {
+        used += encoded_len(&history[i]);
+        if (used > budget) {
+            break;
+        }
+        if (message_kind(&history[i]) == 'U') {
+            start = i;
+        }
+    }
+    if (start == len) {
+        return 0;
+    }
+
+    char *p = out;
+    memcpy(p, RECORD_MAGIC, sizeof(RECORD_MAGIC) - 1);
+    p += sizeof(RECORD_MAGIC) - 1;
+    for (int i = start; i < len; i++) {
+        *p++ = message_kind(&history[i]);
+        p = put_field(p, history[i].tool_id);
+        *p++ = FIELD_SEP;
+        p = put_field(p, history[i].tool_name);
+        *p++ = FIELD_SEP;
+        p = put_field(p, history[i].content);
+        *p++ = MESSAGE_END;
+    }
+    *p = '\0';
+    return (size_t)(p - out);
+}
+
+int chat_context_decode(const char *record, conversation_msg_t *history, int max_len)
+{
+    const char *p;
+    int count = 0;
+
+    if (!record || !history || strncmp(record, RECORD_MAGIC, sizeof(RECORD_MAGIC) - 1) != 0) {
+        return -1;
+    }
+    p = record + sizeof(RECORD_MAGIC) - 1;
+
+    while (*p) {
+        if (count >= max_len) {
+            return -1;
+        }
+        conversation_msg_t *msg = &history[count];
+        char kind = *p++;
+
+        memset(msg, 0, sizeof(*msg));
+        switch (kind) {
+            case 'U':
+                strcpy(msg->role, "user");
+                break;
+            case 'A':
+                strcpy(msg->role, "assistant");
+                break;
+            case 'T':
+                strcpy(msg->role, "assistant");
+                msg->is_tool_use = true;
+                break;
+            case 'R':
+                strcpy(msg->role, "user");
+                msg->is_tool_result = true;
+                break;
+            default:
+                return -1;
+        }
+
+        p = get_field(p, FIELD_SEP, msg->tool_id, sizeof(msg->tool_id));
+        if (p) {
+            p = get_field(p, FIELD_SEP, msg->tool_name, sizeof(msg->tool_name));
+        }
+        if (p) {
+            p = get_field(p, MESSAGE_END, msg->content, sizeof(msg->content));
+        }
+        if (!p) {
+            return -1;
+        }
+        count++;
+    }
+    return count;
+}
+
+static void spill(chat_context_t *slot)
+{
+    if (!s_backend.save || slot->len == 0) {
+        return;
+    }
+    if (chat_context_encode(slot->history, slot->len, s_record, CHAT_CONTEXT_RECORD_MAX) > 0) {
+        s_backend.save(slot->chat_id, s_record, s_backend.ctx);
+    }
+}
+
+static void restore(chat_context_t *slot)
+{
+    slot->len = 0;
+    if (!s_backend.load ||
+        !s_backend.load(slot->chat_id, s_record, CHAT_CONTEXT_RECORD_MAX, s_backend.ctx)) {
+        return;
+    }
+    int len = chat_context_decode(s_record, slot->history, CHAT_CONTEXT_HISTORY_LEN);
+    if (len < 0) {
+        memset(slot->history, 0, sizeof(conversation_msg_t) * CHAT_CONTEXT_HISTORY_LEN);
+        return;
+    }
+    slot->len = len;
+}
+
+bool chat_context_init(const chat_context_backend_t *backend)
+{
+    chat_context_deinit();
+    if (backend) {
+        s_backend = *backend;
+    } else {
+        memset(&s_backend, 0, sizeof(s_backend));
+    }
+    if (!s_backend.alloc || !s_backend.free) {
+        s_backend.alloc = malloc;
+        s_backend.free = free;
+    }
+
+    s_record = s_backend.alloc(CHAT_CONTEXT_RECORD_MAX);
+    if (!s_record) {
+        chat_context_deinit();
+        return false;
+    }
+    for (int i = 0; i < CHAT_CONTEXT_SLOTS; i++) {
+        s_slots[i].history = s_backend.alloc(sizeof(conversation_msg_t) * CHAT_CONTEXT_HISTORY_LEN);
+        if (!s_slots[i].history) {
+            chat_context_deinit();
+            return false;
+        }
+        memset(s_slots[i].history, 0, sizeof(conversation_msg_t) * CHAT_CONTEXT_HISTORY_LEN);
+    }
+    return true;
+}
+
+void chat_context_deinit(void)
+{
+    for (int i = 0; i < CHAT_CONTEXT_SLOTS; i++) {
+        if (s_slots[i].history) {
+            s_backend.free(s_slots[i].history);
+        }
+    }
+    memset(s_slots, 0, sizeof(s_slots));
+    if (s_record) {
+        s_backend.free(s_record);
+        s_record = NULL;
+    }
+    s_clock = 0;
+}
+
+chat_context_t *chat_context_acquire(int64_t chat_id)
+{
+    chat_context_t *slot = NULL;
+
+    if (!s_record) {
+        return NULL;
+    }
+
+    for (int i = 0; i < CHAT_CONTEXT_SLOTS; i++) {
+        if (s_slots[i].used && s_slots[i].chat_id == chat_id) {
+            s_slots[i].last_used = ++s_clock;
+            return &s_slots[i];
+        }
+    }
+
+    // Free slot first, otherwise evict the least recently used chat.
+    for (int i = 0; i < CHAT_CONTEXT_SLOTS; i++) {
+        if (!s_slots[i].used) {
+            slot = &s_slots[i];
+            break;
+        }
+        if (!slot || (int32_t)(s_slots[i].last_used - slot->last_used) < 0) {
+            slot = &s_slots[i];
+        }
+    }
+    if (slot->used) {
+        spill(slot);
+    }
+
+    memset(slot->history, 0, sizeof(conversation_msg_t) * CHAT_CONTEXT_HISTORY_LEN);
+    slot->chat_id = chat_id;
+    slot->used = true;
+    slot->last_used = ++s_clock;
+    restore(slot);
+    return slot;
+}
+
+size_t chat_context_resident(void)
+{
+    size_t count = 0;
+    for (int i = 0; i < CHAT_CONTEXT_SLOTS; i++) {
+        if (s_slots[i].used) {
+            count++;
+        }
+    }
+    return count;
+}
@@ -0,0 +1,58 @@
+#ifndef CHAT_CONTEXT_H
+#define CHAT_CONTEXT_H
+
+#include "config.h"
+#include "json_util.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Per-chat conversation history for the agent.
+//
+// CHAT_CONTEXT_SLOTS histories stay resident (in PSRAM when available). When
+// a message arrives for another chat, the least recently used context is
+// written to flash through the backend and its slot reused; coming back
+// restores the newest part of that history that fit in one record.
+//
+// Not thread-safe: only the agent task uses it.
+
+#define CHAT_CONTEXT_HISTORY_LEN (MAX_HISTORY_TURNS * 2)
+
+typedef struct {
+    int64_t chat_id;
+    conversation_msg_t *history;    // CHAT_CONTEXT_HISTORY_LEN entries
+    int len;
+    uint32_t last_used;
+    bool used;
+} chat_context_t;
+
+typedef struct {
+    void *(*alloc)(size_t size);    // Slot storage; NULL for malloc/free
+    void (*free)(void *ptr);
+    // Optional flash spill. save returns false when the record was not kept;
+    // load returns false when the chat has nothing saved.
+    bool (*save)(int64_t chat_id, const char *record, void *ctx);
+    bool (*load)(int64_t chat_id, char *record, size_t record_len, void *ctx);
+    void *ctx;
+} chat_context_backend_t;
+
+// Allocate the resident slots. Returns false when out of memory.
+bool chat_context_init(const chat_context_backend_t *backend);
+void chat_context_deinit(void);
+
+// Context for chat_id, made resident (and most recently used) if needed.
+// NULL only before init.
+chat_context_t *chat_context_acquire(int64_t chat_id);
+
+// Number of resident contexts.
+size_t chat_context_resident(void);
+
+// Record codec: the newest messages that fit in out_len, starting at a plain
+// user turn so a restored history never opens with a tool exchange.
+// Returns bytes written (0 when nothing fits).
+size_t chat_context_encode(const conversation_msg_t *history, int len,
+                           char *out, size_t out_len);
+// Returns messages decoded, or -1 on a malformed record.
+int chat_context_decode(const char *record, conversation_msg_t *history, int max_len);
+
+#endif // CHAT_CONTEXT_H
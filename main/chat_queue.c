@@ -0,0 +1,97 @@
+#include "chat_queue.h"
+#include <string.h>
+
+void chat_queue_init(chat_queue_t *queue)
+{
+    memset(queue, 0, sizeof(*queue));
+}
+
+bool chat_queue_is_full(const chat_queue_t *queue)
+{
+    return queue->count >= CHAT_QUEUE_LEN;
+}
+
+size_t chat_queue_count(const chat_queue_t *queue)
+{
+    return queue->count;
+}
+
+size_t chat_queue_depth(const chat_queue_t *queue, int64_t chat_id)
+{
+    size_t depth = 0;
+    for (size_t i = 0; i < CHAT_QUEUE_LEN; i++) {
+        if (queue->entries[i].used && queue->entries[i].msg.chat_id == chat_id) {
+            depth++;
+        }
+    }
+    return depth;
+}
+
+bool chat_queue_push(chat_queue_t *queue, const channel_msg_t *msg, int64_t now_us)
+{
+    chat_queue_entry_t *slot = NULL;
+    uint32_t turn = 0;
+
+    for (size_t i = 0; i < CHAT_QUEUE_LEN; i++) {
+        chat_queue_entry_t *entry = &queue->entries[i];
+        if (!entry->used) {
+            if (!slot) {
+                slot = entry;
+            }
+        } else if (entry->msg.chat_id == msg->chat_id) {
+            // All pending messages of a chat share its turn.
+            turn = entry->turn;
+        }
+    }
+    if (!slot) {
+        return false;
+    }
+
+    slot->msg = *msg;
+    slot->enqueued_us = now_us;
+    slot->seq = queue->next_seq++;
+    slot->turn = turn;
+    slot->used = true;
+    queue->count++;
+    return true;
+}
+
+bool chat_queue_pop(chat_queue_t *queue, int64_t now_us, channel_msg_t *out, int64_t *wait_us)
+{
+    chat_queue_entry_t *best = NULL;
+
+    // Least recently served chat first, then its oldest message. Sequence
+    // numbers are compared by difference so wraparound is harmless.
+    for (size_t i = 0; i < CHAT_QUEUE_LEN; i++) {
+        chat_queue_entry_t *entry = &queue->entries[i];
+        if (!entry->used) {
+            continue;
+        }
+        if (!best || entry->turn < best->turn ||
+            (entry->turn == best->turn && (int32_t)(entry->seq - best->seq) < 0)) {
+            best = entry;
+        }
+    }
+    if (!best) {
+        return false;
+    }
+
+    int64_t chat_id = best->msg.chat_id;
+    if (out) {
+        *out = best->msg;
+    }
+    if (wait_us) {
+        *wait_us = now_us > best->enqueued_us ? now_us - best->enqueued_us : 0;
+    }
+    best->used = false;
+    queue->count--;
+
+    // The chat's remaining messages go to the back of the rotation.
+    queue->turn++;
+    for (size_t i = 0; i < CHAT_QUEUE_LEN; i++) {
+        if (queue->entries[i].used && queue->entries[i].msg.chat_id == chat_id) {
+            queue->entries[i].turn = queue->turn;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,48 @@
+#ifndef CHAT_QUEUE_H
+#define CHAT_QUEUE_H
+
+#include "config.h"
+#include "messages.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Agent-side pending messages, served round-robin across chats.
+//
+// The agent drains its FreeRTOS input queue into this table and pops one
+// message at a time. Every chat with pending messages gets one message per
+// round, in the order it was last served, so a busy chat cannot starve the
+// others; within a chat, messages stay in arrival order.
+//
+// Pure and caller-locked (the agent task owns it), so it runs on the host.
+
+typedef struct {
+    channel_msg_t msg;
+    int64_t enqueued_us;
+    uint32_t seq;                   // Arrival order
+    uint32_t turn;                  // Round the chat was last served in (0 = not yet)
+    bool used;
+} chat_queue_entry_t;
+
+typedef struct {
+    chat_queue_entry_t entries[CHAT_QUEUE_LEN];
+    size_t count;
+    uint32_t next_seq;
+    uint32_t turn;
+} chat_queue_t;
+
+void chat_queue_init(chat_queue_t *queue);
+bool chat_queue_is_full(const chat_queue_t *queue);
+size_t chat_queue_count(const chat_queue_t *queue);
+
+// Pending messages from one chat.
+size_t chat_queue_depth(const chat_queue_t *queue, int64_t chat_id);
+
+// Returns false when full.
+bool chat_queue_push(chat_queue_t *queue, const channel_msg_t *msg, int64_t now_us);
+
+// Pop the next message by round-robin. wait_us (optional) receives how long
+// it was queued. Returns false when empty.
+bool chat_queue_pop(chat_queue_t *queue, int64_t now_us, channel_msg_t *out, int64_t *wait_us);
+
+#endif // CHAT_QUEUE_H
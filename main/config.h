@@ -27,9 +27,17 @@
 #define AGENT_TASK_STACK_SIZE   8192
 #define CHANNEL_TASK_STACK_SIZE 4096
 #define CRON_TASK_STACK_SIZE    4096
+#define NVS_WB_TASK_STACK_SIZE  3072
+#define MOTION_TASK_STACK_SIZE  4096
+#define TIMELAPSE_TASK_STACK_SIZE 4096
+#define MIC_TASK_STACK_SIZE     3072
 #define AGENT_TASK_PRIORITY     5
 #define CHANNEL_TASK_PRIORITY   5
 #define CRON_TASK_PRIORITY      4
+#define NVS_WB_TASK_PRIORITY    3
+#define MOTION_TASK_PRIORITY    2
+#define TIMELAPSE_TASK_PRIORITY 1
+#define MIC_TASK_PRIORITY       6       // Above the agent: capture never waits on a request
 
 // -----------------------------------------------------------------------------
 // Queues
@@ -37,6 +45,7 @@
 #define INPUT_QUEUE_LENGTH      8
 #define OUTPUT_QUEUE_LENGTH     8
 #define TELEGRAM_OUTPUT_QUEUE_LENGTH 4
+#define CHAT_QUEUE_LEN          INPUT_QUEUE_LENGTH  // Agent-side round-robin table
 
 // -----------------------------------------------------------------------------
 // LLM Backend Configuration
@@ -59,6 +68,19 @@ typedef enum {
 #define LLM_API_KEY_BUF_SIZE      (LLM_API_KEY_MAX_LEN + 1)
 #define LLM_AUTH_HEADER_BUF_SIZE  (sizeof("Bearer ") - 1 + LLM_API_KEY_MAX_LEN + 1)
 
+#define LLM_EMBED_URL_OPENAI      "https://api.openai.com/v1/embeddings"
+#define LLM_EMBED_URL_OPENROUTER  "https://openrouter.ai/api/v1/embeddings"
+#define LLM_EMBED_MODEL_OPENAI    "text-embedding-3-small"
+#define LLM_EMBED_MODEL_OPENROUTER "openai/text-embedding-3-small"
+
+#define LLM_TRANSCRIBE_URL_OPENAI "https://api.openai.com/v1/audio/transcriptions"
+#ifdef CONFIG_ZCLAW_TRANSCRIBE_URL
+#define LLM_TRANSCRIBE_URL      CONFIG_ZCLAW_TRANSCRIBE_URL
+#else
+#define LLM_TRANSCRIBE_URL      LLM_TRANSCRIBE_URL_OPENAI
+#endif
+#define LLM_TRANSCRIBE_MODEL    "whisper-1"
+
 #define LLM_MAX_TOKENS          1024
 #define HTTP_TIMEOUT_MS         30000   // 30 seconds for API calls
 
@@ -96,18 +118,26 @@ typedef enum {
 #define ZCLAW_HAS_PSRAM         0
 #endif
 
+#if defined(CONFIG_ZCLAW_TIMELAPSE) && ZCLAW_HAS_CAMERA && ZCLAW_HAS_PSRAM
+#define ZCLAW_HAS_TIMELAPSE     1
+#else
+#define ZCLAW_HAS_TIMELAPSE     0
+#endif
+
 // System prompt with media capability suffix
 #if ZCLAW_HAS_CAMERA && ZCLAW_HAS_MICROPHONE
 #define SYSTEM_PROMPT SYSTEM_PROMPT_BASE \
     " You have a camera and microphone. Use capture_photo to take photos and " \
-    "visually analyze the environment. Use record_audio to capture sound."
+    "visually analyze the environment. Use record_audio to hear and transcribe speech, " \
+    "and analyze_audio to measure sound levels and tones."
 #elif ZCLAW_HAS_CAMERA
 #define SYSTEM_PROMPT SYSTEM_PROMPT_BASE \
     " You have a camera. Use capture_photo to take photos and visually analyze " \
     "the environment."
 #elif ZCLAW_HAS_MICROPHONE
 #define SYSTEM_PROMPT SYSTEM_PROMPT_BASE \
-    " You have a microphone. Use record_audio to capture sound."
+    " You have a microphone. Use record_audio to hear and transcribe speech, and " \
+    "analyze_audio to measure sound levels and tones."
 #else
 #define SYSTEM_PROMPT SYSTEM_PROMPT_BASE
 #endif
@@ -116,6 +146,64 @@ typedef enum {
 // Media Capture Defaults
 // -----------------------------------------------------------------------------
 #define MEDIA_AUDIO_DEFAULT_MS  3000    // Default recording duration
+#define MEDIA_AUDIO_UNTIL_SILENCE_MS 60000  // Default limit when listening until silence
+#define MEDIA_B64_CHUNK_BYTES   768     // Image bytes base64-encoded per body write (multiple of 3)
+
+// record_audio transcription upload (see transcribe_util.h)
+#define TRANSCRIBE_FORM_BUF_SIZE    384     // Multipart head/tail around the WAV
+#define TRANSCRIBE_RESPONSE_BUF_SIZE 2048   // JSON reply holding the transcript
+
+// record_audio voice activity detection (see vad.h)
+#define VAD_FRAME_MS            20
+#define VAD_FRAME_SAMPLES       320     // VAD_FRAME_MS at the 16 kHz microphone rate
+#define VAD_ONSET_FRAMES        3       // Voiced frames in a row that start speech
+#define VAD_PREROLL_FRAMES      10      // Frames kept from before speech starts (200 ms)
+#define VAD_SNR_DB              10      // Speech is this far above the noise floor...
+#define VAD_MIN_DBFS            (-55)   // ...and at least this loud
+#define VAD_ZCR_VOICED_PCT      25      // Voiced frames cross zero less often (per 100 samples)
+#define VAD_FLOOR_SPANS         8       // Noise floor: quietest frame in 8 spans...
+#define VAD_FLOOR_SPAN_FRAMES   16      // ...of 16 frames (the last 2.56 s)
+#define VAD_HANGOVER_MS_DEFAULT 800     // Silence that ends an utterance
+#define VAD_HANGOVER_MS_MIN     200
+#define VAD_HANGOVER_MS_MAX     3000
+#define VAD_START_TIMEOUT_MS    8000    // until_silence gives up if nobody starts talking
+
+// analyze_audio levels and spectrum (see audio_stats.h)
+#define AUDIO_ANALYZE_DEFAULT_MS 2000   // Default listening time
+#define AUDIO_FFT_SIZE          1024    // Samples per window: 15.6 Hz bins at 16 kHz
+#define AUDIO_PEAKS_MAX         3       // Tones reported, loudest first
+#define AUDIO_PEAK_PROMINENCE_DB 10     // A tone stands this far above the spectrum around it...
+#define AUDIO_PEAK_RANGE_DB     40      // ...and is no further than this below the overall level
+#define AUDIO_CLIP_LEVEL        32700   // Samples this close to full scale count as clipped
+#define AUDIO_SUMMARY_MAX       200     // Summary text handed to the model
+
+// capture_photo byte budget (see camera_budget.h)
+#define CAM_BUDGET_MAX_ATTEMPTS 3       // Captures per photo before keeping an over-budget frame
+#define CAM_BUDGET_MARGIN_PCT   90      // Plan for this share of the budget
+#define CAM_BUDGET_LEARN_PCT    50      // Weight of a new frame when the scene estimate drops
+#define CAM_BUDGET_MIN_BYTES    4096    // Smallest budget_bytes accepted
+#define CAM_BUDGET_MAX_BYTES    262144  // Largest budget_bytes accepted
+#define CAM_UPLINK_DEFAULT_BPS  50000   // Upload rate assumed until an image upload is timed
+
+// Motion watch (see motion_detect.h)
+#define MOTION_FRAME_W          80      // Grayscale sample: QQVGA JPEG decoded at 1/2 scale
+#define MOTION_FRAME_H          60
+#define MOTION_BLOCK_SIZE       10      // Compared in 10x10 pixel blocks (8x6 grid)
+#define MOTION_SAMPLE_MS        1000    // Time between samples
+#define MOTION_COOLDOWN_MS      60000   // Minimum time between events
+#define MOTION_JPEG_QUALITY     20      // Quality of the QQVGA sample frames
+#define MOTION_NOTE_MAX_LEN     160     // What to do on an event, sent with it
+
+// Time-lapse ring and contact sheets (see thumb_ring.h)
+#define THUMB_RING_BYTES        (512 * 1024)    // PSRAM arena for the thumbnails
+#define THUMB_RING_MAX_FRAMES   360     // One hour at the default interval
+#define THUMB_INTERVAL_MS       10000   // Time between thumbnails
+#define THUMB_JPEG_QUALITY      20      // Quality of the QQVGA thumbnails
+#define THUMB_TILE_W            160     // Tiles are the QQVGA thumbnails at full scale
+#define THUMB_TILE_H            120
+#define THUMB_SHEET_GUTTER      4       // Pixels between tiles
+#define THUMB_SHEET_MAX_TILES   16      // 4x4 grid, 652x492
+#define THUMB_SHEET_JPEG_QUALITY 80     // Contact sheet encoder quality (0-100, higher is better)
 
 // -----------------------------------------------------------------------------
 // Camera Configuration (OV2640 DVP)
@@ -205,7 +293,12 @@ typedef enum {
 
 #define CAM_XCLK_FREQ_HZ   20000000    // 20 MHz XCLK for OV2640
 #define CAM_JPEG_QUALITY    12          // 0-63, lower = better quality
+#if ZCLAW_HAS_PSRAM
+#define CAM_FB_COUNT        2           // Frame buffers: the driver grabs continuously
+#else
 #define CAM_FB_COUNT        1           // Frame buffers (1 = single capture)
+#endif
+#define CAM_FRAME_MAX_AGE_MS 250        // Older buffered frames are replaced with a fresh one
 
 #endif // ZCLAW_HAS_CAMERA
 
@@ -228,7 +321,17 @@ typedef enum {
 #define MIC_SAMPLE_RATE     16000       // 16 kHz for speech
 #define MIC_SAMPLE_BITS     16          // 16-bit samples
 #define MIC_CHANNEL_NUM     1           // Mono
-#define MIC_RECORD_SECS_MAX 10          // Max recording length
+#define MIC_RECORD_SECS_MAX 300         // Max listening per tool call (streamed, memory does not grow)
+#define MIC_DMA_DESC_NUM    4           // I2S DMA buffers...
+#define MIC_DMA_FRAME_NUM   256         // ...of 256 samples; the capture ring takes the stalls
+#define MIC_CAPTURE_CHUNK   256         // Samples the capture task reads per commit
+#if ZCLAW_HAS_PSRAM
+#define MIC_RING_SAMPLES    65536       // Capture ring in PSRAM: 4 s of pre-roll and reader slack
+#else
+#define MIC_RING_SAMPLES    16384       // Capture ring: 1 s of pre-roll and reader slack
+#endif
+#define MIC_PREROLL_MS      1000        // record_audio starts this far back (as far as the ring holds)
+#define MIC_POLL_MS         10          // A reader that has caught up checks this often
 
 #endif // ZCLAW_HAS_MICROPHONE
 
@@ -275,6 +378,39 @@ typedef enum {
 #define NVS_NAMESPACE_CONFIG    "zc_config"
 #define NVS_MAX_KEY_LEN         15      // NVS limit
 #define NVS_MAX_VALUE_LEN       512     // Increased for tool/cron definitions
+#define NVS_WB_MAX_ITEMS        16      // Pending write-behind keys held in RAM
+#define NVS_WB_FLUSH_INTERVAL_MS 30000  // Max time a deferred write stays in RAM
+#define NVS_WB_FLUSH_THRESHOLD  8       // Dirty keys that trigger an early flush
+#define NVS_WB_MAX_FAILURES     3       // Failed flushes before a key is dropped
+#define MEM_CACHE_MAX_ENTRIES   32      // String values held by the memory read cache
+#if ZCLAW_HAS_PSRAM
+#define MEM_CACHE_MAX_BYTES     16384   // Cache values live in PSRAM
+#else
+#define MEM_CACHE_MAX_BYTES     4096
+#endif
+#define MEM_CACHE_INDEX_MAX     64      // Key names tracked for memory_list
+#define ZC_STORE_PARTITION_LABEL "zc_store" // Log-structured user memory (partitions.csv)
+#define ZC_STORE_SEGMENT_SIZE   16384   // Log segment; multiple of the 4 KB sector
+#define ZC_STORE_MAX_SEGMENTS   64
+#define ZC_STORE_INDEX_SLOTS    512     // RAM hash index slots (12 B each)
+#define ZC_STORE_MAX_KEYS       384     // Keeps the index at most 75% full
+#define ZC_STORE_COMPACT_FREE_SEGMENTS 2 // Compact in the background below this
+
+// -----------------------------------------------------------------------------
+// Memory Recall (user memories matched into the system prompt per message)
+// -----------------------------------------------------------------------------
+#define RECALL_ENABLED          1
+#define EMBED_DIM               256     // Requested embedding width (int8 on device)
+#if ZCLAW_HAS_PSRAM
+#define EMBED_INDEX_MAX_ENTRIES 128     // Vectors live in PSRAM
+#else
+#define EMBED_INDEX_MAX_ENTRIES 32
+#endif
+#define RECALL_TOP_K            3
+#define RECALL_MIN_SCORE        0.30f   // Cosine similarity floor
+#define RECALL_EMBED_BATCH      8       // Stale memories embedded per message
+#define RECALL_VALUE_PREVIEW    200     // Chars of each memory put in the prompt
+#define RECALL_PROMPT_MAX       768     // Bytes appended to the system prompt
 
 // -----------------------------------------------------------------------------
 // WiFi
@@ -285,18 +421,51 @@ typedef enum {
 // -----------------------------------------------------------------------------
 // Telegram
 // -----------------------------------------------------------------------------
+#ifdef CONFIG_ZCLAW_TELEGRAM_API_URL
+#define TELEGRAM_API_URL        CONFIG_ZCLAW_TELEGRAM_API_URL
+#else
 #define TELEGRAM_API_URL        "https://api.telegram.org/bot"
+#endif
+#define TELEGRAM_API_URL_MAX_LEN 127    // Base URL override (Kconfig or NVS tg_api_url)
 #define TELEGRAM_POLL_TIMEOUT   30      // Long polling timeout (seconds)
 #define TELEGRAM_POLL_INTERVAL  100     // ms between poll attempts on error
+#define TELEGRAM_POLL_LIMIT     INPUT_QUEUE_LENGTH  // Updates per getUpdates (1-100)
+#define TELEGRAM_UPDATE_MAX_LEN 32768   // Largest single update buffered while streaming
+#define TELEGRAM_INPUT_WAIT_MS  500     // Recheck interval while the agent queue is full
 #define TELEGRAM_MAX_MSG_LEN    4096    // Max message length
+#define TELEGRAM_CHAT_INTERVAL_MS  1000 // Per-chat send spacing (~1 msg/s)
+#define TELEGRAM_GROUP_INTERVAL_MS 3000 // Group chats: 20 msgs/min
+#define TELEGRAM_GLOBAL_INTERVAL_MS 34  // Whole bot: 30 msgs/s
+#define TELEGRAM_RETRY_AFTER_MAX_S 300  // Longest 429 retry_after honoured
+#define TELEGRAM_SEND_MAX_ATTEMPTS 5    // Per chunk, including 429 retries
 #define START_COMMAND_COOLDOWN_MS 30000 // Debounce repeated Telegram /start bursts
+#define TELEGRAM_MAX_CHATS      8       // Allowlisted chat IDs (tg_chat_id, comma-separated)
+#ifdef CONFIG_ZCLAW_TELEGRAM_WEBHOOK_PORT
+#define TELEGRAM_WEBHOOK_PORT   CONFIG_ZCLAW_TELEGRAM_WEBHOOK_PORT
+#else
+#define TELEGRAM_WEBHOOK_PORT   8080
+#endif
+#define TELEGRAM_WEBHOOK_PATH   "/telegram/webhook" // POST target for the reverse proxy
+#define TELEGRAM_WEBHOOK_SECRET_MAX_LEN 256     // Telegram's secret_token limit
+#define TELEGRAM_WEBHOOK_SECRET_HEADER "X-Telegram-Bot-Api-Secret-Token"
+
+// -----------------------------------------------------------------------------
+// Chat Contexts (one conversation history per Telegram chat)
+// -----------------------------------------------------------------------------
+#if ZCLAW_HAS_PSRAM
+#define CHAT_CONTEXT_SLOTS      6       // Resident histories (~27 KB each, PSRAM)
+#else
+#define CHAT_CONTEXT_SLOTS      1       // Other chats are restored from flash
+#endif
+#define CHAT_CONTEXT_RECORD_MAX 4096    // Spilled history per chat; fits a zc_store value
 
 // -----------------------------------------------------------------------------
 // Cron / Scheduler
 // -----------------------------------------------------------------------------
-#define CRON_CHECK_INTERVAL_MS  60000   // Check schedules every minute
+#define CRON_MAX_SLEEP_MS       3600000 // Longest cron task sleep; bounds drift after clock jumps
 #define CRON_MAX_ENTRIES        16      // Max scheduled tasks
 #define CRON_MAX_ACTION_LEN     256     // Max action string length
+#define CRON_COND_DEFAULT_CHECK_S 10    // Default condition evaluation period (seconds)
 
 // -----------------------------------------------------------------------------
 // Factory Reset
@@ -319,6 +488,16 @@ typedef enum {
 #define TOOL_NAME_MAX_LEN       24
 #define TOOL_DESC_MAX_LEN       128
 
+// -----------------------------------------------------------------------------
+// Telegram Quick Actions
+// -----------------------------------------------------------------------------
+#define QUICK_ACTION_MAX            8   // Pinned buttons on the /actions keyboard
+#define QUICK_ACTION_LABEL_MAX_LEN  32  // Button text; also the callback key
+#define QUICK_ACTION_ARGS_MAX_LEN   128 // Fixed tool input, as a JSON object
+#define QUICK_ACTION_COLUMNS        2   // Buttons per keyboard row
+#define QUICK_ACTION_RESULT_MAX_LEN 1024 // Tool output posted back to the chat
+#define QUICK_ACTION_CALLBACK_PREFIX "qa:"
+
 // -----------------------------------------------------------------------------
 // Boot Loop Protection
 // -----------------------------------------------------------------------------
@@ -328,8 +507,13 @@ typedef enum {
 // -----------------------------------------------------------------------------
 // Rate Limiting
 // -----------------------------------------------------------------------------
-#define RATELIMIT_MAX_PER_HOUR      30      // Max LLM requests per hour
-#define RATELIMIT_MAX_PER_DAY       200     // Max LLM requests per day
-#define RATELIMIT_ENABLED           1       // Set to 0 to disable
+// Token buckets (input + output tokens) that refill continuously over a
+// rolling hour and day. Scheduled (cron) requests have their own budget.
+#define RATELIMIT_TOKENS_PER_HOUR       150000
+#define RATELIMIT_TOKENS_PER_DAY        1000000
+#define RATELIMIT_CRON_TOKENS_PER_HOUR  60000
+#define RATELIMIT_CRON_TOKENS_PER_DAY   400000
+#define RATELIMIT_STATE_MAX_LEN         96      // Persisted bucket levels
+#define RATELIMIT_ENABLED               1       // Set to 0 to disable
 
 #endif // CONFIG_H
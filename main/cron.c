@@ -1,9 +1,13 @@
 #include "cron.h"
 #include "config.h"
+#include "cron_cond.h"
+#include "cron_sched.h"
 #include "cron_utils.h"
 #include "memory.h"
 #include "messages.h"
 #include "nvs_keys.h"
+#include "nvs_wb.h"
+#include "driver/gpio.h"
 #include "esp_log.h"
 #include "esp_netif_sntp.h"
 #include "freertos/FreeRTOS.h"
@@ -23,8 +27,21 @@ static const char *TAG = "cron";
 
 static QueueHandle_t s_agent_queue;
 static cron_entry_t s_entries[CRON_MAX_ENTRIES];
+// Compiled masks for CRON_TYPE_EXPR entries, parallel to s_entries. Persisted
+// under a separate key so existing cron_%d blobs keep their layout.
+static cron_expr_t s_exprs[CRON_MAX_ENTRIES];
+// Compiled predicates for CRON_TYPE_CONDITION entries (cronc_%d), plus the
+// RAM-only edge state and next evaluation time for each.
+static cron_cond_t s_conds[CRON_MAX_ENTRIES];
+static cron_cond_state_t s_cond_states[CRON_MAX_ENTRIES];
+static int64_t s_cond_next_check[CRON_MAX_ENTRIES];
 static bool s_time_synced = false;
 static SemaphoreHandle_t s_entries_mutex = NULL;
+static TaskHandle_t s_cron_task_handle = NULL;
+// Min-heap of next fire times, guarded by s_entries_mutex and rebuilt by the
+// cron task whenever s_sched_dirty is set.
+static cron_sched_t s_sched;
+static volatile bool s_sched_dirty = true;
 static char s_timezone[TIMEZONE_MAX_LEN] = DEFAULT_TIMEZONE_POSIX;
 typedef struct {
     uint8_t id;
@@ -49,6 +66,15 @@ static void entries_unlock(void)
     }
 }
 
+// Ask the cron task to recompute next-fire times and re-arm its sleep.
+static void request_reschedule(void)
+{
+    s_sched_dirty = true;
+    if (s_cron_task_handle) {
+        xTaskNotifyGive(s_cron_task_handle);
+    }
+}
+
 static bool timezone_string_is_valid(const char *tz)
 {
     if (!tz) {
@@ -85,6 +111,7 @@ static esp_err_t apply_timezone(const char *timezone_posix, bool persist_to_nvs)
     strncpy(s_timezone, timezone_posix, sizeof(s_timezone) - 1);
     s_timezone[sizeof(s_timezone) - 1] = '\0';
     ESP_LOGI(TAG, "Timezone applied: %s", s_timezone);
+    request_reschedule();
 
     if (persist_to_nvs) {
         esp_err_t err = memory_set(NVS_KEY_TIMEZONE, s_timezone);
@@ -120,6 +147,7 @@ static void time_sync_notification_cb(struct timeval *tv)
     (void)tv;
     ESP_LOGI(TAG, "NTP time synchronized");
     s_time_synced = true;
+    request_reschedule();
 }
 
 // Initialize NTP
@@ -147,6 +175,25 @@ static void load_entries(void)
         size_t size = sizeof(cron_entry_t);
         if (nvs_get_blob(handle, key, &s_entries[i], &size) != ESP_OK) {
             s_entries[i].id = 0;  // Mark as empty
+            continue;
+        }
+
+        if (s_entries[i].type == CRON_TYPE_EXPR) {
+            snprintf(key, sizeof(key), "cronx_%d", i);
+            size = sizeof(cron_expr_t);
+            if (nvs_get_blob(handle, key, &s_exprs[i], &size) != ESP_OK ||
+                size != sizeof(cron_expr_t) || !cron_expr_is_valid(&s_exprs[i])) {
+                ESP_LOGW(TAG, "Cron entry %d has no valid expression, disabling", s_entries[i].id);
+                s_entries[i].enabled = false;
+            }
+        } else if (s_entries[i].type == CRON_TYPE_CONDITION) {
+            snprintf(key, sizeof(key), "cronc_%d", i);
+            size = sizeof(cron_cond_t);
+            if (nvs_get_blob(handle, key, &s_conds[i], &size) != ESP_OK ||
+                size != sizeof(cron_cond_t) || !cron_cond_is_valid(&s_conds[i])) {
+                ESP_LOGW(TAG, "Cron entry %d has no valid condition, disabling", s_entries[i].id);
+                s_entries[i].enabled = false;
+            }
         }
     }
 
@@ -154,34 +201,44 @@ static void load_entries(void)
     ESP_LOGI(TAG, "Loaded cron entries from NVS");
 }
 
-// Save a single entry to NVS
-static esp_err_t save_entry(int index)
+// Save a single entry through the NVS write-behind cache. Durable saves
+// (create, delete, one-shot clear) are committed before returning; run-time
+// bookkeeping such as last_run is coalesced and flushed later. The compiled
+// expression/condition never changes after creation, so only durable saves
+// rewrite it.
+static esp_err_t save_entry(int index, bool durable)
 {
-    nvs_handle_t handle;
-    esp_err_t err = nvs_open(NVS_NAMESPACE_CRON, NVS_READWRITE, &handle);
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to open cron NVS: %s", esp_err_to_name(err));
-        return err;
-    }
-
     char key[16];
+    char expr_key[16];
+    char cond_key[16];
+    esp_err_t err = ESP_OK;
+
     snprintf(key, sizeof(key), "cron_%d", index);
+    snprintf(expr_key, sizeof(expr_key), "cronx_%d", index);
+    snprintf(cond_key, sizeof(cond_key), "cronc_%d", index);
 
     if (s_entries[index].id == 0) {
-        err = nvs_erase_key(handle, key);
-        if (err == ESP_ERR_NVS_NOT_FOUND) {
-            err = ESP_OK;
+        err = nvs_wb_erase(NVS_NAMESPACE_CRON, expr_key, NVS_WB_DEFERRED);
+        if (err == ESP_OK) {
+            err = nvs_wb_erase(NVS_NAMESPACE_CRON, cond_key, NVS_WB_DEFERRED);
+        }
+        if (err == ESP_OK) {
+            err = nvs_wb_erase(NVS_NAMESPACE_CRON, key, durable ? NVS_WB_DURABLE : NVS_WB_DEFERRED);
         }
     } else {
-        err = nvs_set_blob(handle, key, &s_entries[index], sizeof(cron_entry_t));
-    }
-
-    if (err == ESP_OK) {
-        err = nvs_commit(handle);
+        if (durable && s_entries[index].type == CRON_TYPE_EXPR) {
+            err = nvs_wb_set_blob(NVS_NAMESPACE_CRON, expr_key, &s_exprs[index],
+                                  sizeof(cron_expr_t), NVS_WB_DEFERRED);
+        } else if (durable && s_entries[index].type == CRON_TYPE_CONDITION) {
+            err = nvs_wb_set_blob(NVS_NAMESPACE_CRON, cond_key, &s_conds[index],
+                                  sizeof(cron_cond_t), NVS_WB_DEFERRED);
+        }
+        if (err == ESP_OK) {
+            err = nvs_wb_set_blob(NVS_NAMESPACE_CRON, key, &s_entries[index], sizeof(cron_entry_t),
+                                  durable ? NVS_WB_DURABLE : NVS_WB_DEFERRED);
+        }
     }
 
-    nvs_close(handle);
-
     if (err != ESP_OK) {
         ESP_LOGE(TAG, "Failed to persist cron entry slot %d: %s", index, esp_err_to_name(err));
     }
@@ -192,6 +249,10 @@ static esp_err_t save_entry(int index)
 esp_err_t cron_init(void)
 {
     memset(s_entries, 0, sizeof(s_entries));
+    memset(s_exprs, 0, sizeof(s_exprs));
+    memset(s_conds, 0, sizeof(s_conds));
+    memset(s_cond_states, 0, sizeof(s_cond_states));
+    memset(s_cond_next_check, 0, sizeof(s_cond_next_check));
 
     if (!s_entries_mutex) {
         s_entries_mutex = xSemaphoreCreateMutex();
@@ -268,14 +329,19 @@ void cron_get_time_str(char *buf, size_t buf_len)
     strftime(buf, buf_len, "%Y-%m-%d %H:%M:%S", &timeinfo);
 }
 
+static uint8_t create_entry(cron_type_t type, uint16_t interval_or_hour, uint8_t minute,
+                            const void *program, const char *action);
+
 uint8_t cron_set(cron_type_t type, uint16_t interval_or_hour, uint8_t minute, const char *action)
 {
-    uint8_t created_id = 0;
-
     if (!action || action[0] == '\0') {
         ESP_LOGE(TAG, "Cannot create cron entry: empty action");
         return 0;
     }
+    if (type == CRON_TYPE_EXPR || type == CRON_TYPE_CONDITION) {
+        ESP_LOGE(TAG, "Cron type %d needs a compiled program; use cron_set_expr/cron_set_condition", type);
+        return 0;
+    }
 
     if (type == CRON_TYPE_PERIODIC && !cron_validate_periodic_interval((int)interval_or_hour)) {
         ESP_LOGE(TAG, "Invalid periodic interval: %u", interval_or_hour);
@@ -290,6 +356,43 @@ uint8_t cron_set(cron_type_t type, uint16_t interval_or_hour, uint8_t minute, co
         return 0;
     }
 
+    return create_entry(type, interval_or_hour, minute, NULL, action);
+}
+
+uint8_t cron_set_expr(const cron_expr_t *expr, const char *action)
+{
+    if (!action || action[0] == '\0') {
+        ESP_LOGE(TAG, "Cannot create cron entry: empty action");
+        return 0;
+    }
+    if (!expr || !cron_expr_is_valid(expr)) {
+        ESP_LOGE(TAG, "Invalid cron expression");
+        return 0;
+    }
+
+    return create_entry(CRON_TYPE_EXPR, 0, 0, expr, action);
+}
+
+uint8_t cron_set_condition(const cron_cond_t *cond, const char *action)
+{
+    if (!action || action[0] == '\0') {
+        ESP_LOGE(TAG, "Cannot create cron entry: empty action");
+        return 0;
+    }
+    if (!cond || !cron_cond_is_valid(cond)) {
+        ESP_LOGE(TAG, "Invalid cron condition");
+        return 0;
+    }
+
+    return create_entry(CRON_TYPE_CONDITION, 0, 0, cond, action);
+}
+
+// `program` is the compiled cron_expr_t or cron_cond_t for those types, else NULL.
+static uint8_t create_entry(cron_type_t type, uint16_t interval_or_hour, uint8_t minute,
+                            const void *program, const char *action)
+{
+    uint8_t created_id = 0;
+
     if (!entries_lock(pdMS_TO_TICKS(1000))) {
         ESP_LOGE(TAG, "Failed to lock cron entries");
         return 0;
@@ -330,6 +433,17 @@ uint8_t cron_set(cron_type_t type, uint16_t interval_or_hour, uint8_t minute, co
         entry->interval_minutes = interval_or_hour;
         entry->hour = 0;
         entry->minute = 0;
+    } else if (type == CRON_TYPE_EXPR || type == CRON_TYPE_CONDITION) {
+        entry->interval_minutes = 0;
+        entry->hour = 0;
+        entry->minute = 0;
+        if (type == CRON_TYPE_EXPR) {
+            s_exprs[slot] = *(const cron_expr_t *)program;
+        } else {
+            s_conds[slot] = *(const cron_cond_t *)program;
+            s_cond_states[slot] = CRON_COND_STATE_UNKNOWN;
+            s_cond_next_check[slot] = 0;
+        }
     } else {
         entry->interval_minutes = 0;
         entry->hour = interval_or_hour;
@@ -347,12 +461,14 @@ uint8_t cron_set(cron_type_t type, uint16_t interval_or_hour, uint8_t minute, co
     strncpy(entry->action, action, CRON_MAX_ACTION_LEN - 1);
     entry->action[CRON_MAX_ACTION_LEN - 1] = '\0';
 
-    if (save_entry(slot) != ESP_OK) {
+    if (save_entry(slot, true) != ESP_OK) {
         memset(entry, 0, sizeof(*entry));
+        save_entry(slot, false);  // Supersede the failed writes still queued for retry
         goto out;
     }
 
     created_id = entry->id;
+    request_reschedule();
     ESP_LOGI(TAG, "Created cron entry %d: type=%d action=%s", entry->id, type, action);
 
 out:
@@ -404,6 +520,7 @@ void cron_list(char *buf, size_t buf_len)
             case CRON_TYPE_DAILY: type_str = "daily"; break;
             case CRON_TYPE_CONDITION: type_str = "condition"; break;
             case CRON_TYPE_ONCE: type_str = "once"; break;
+            case CRON_TYPE_EXPR: type_str = "cron"; break;
         }
         ok &= cJSON_AddStringToObject(obj, "type", type_str) != NULL;
 
@@ -411,6 +528,22 @@ void cron_list(char *buf, size_t buf_len)
             ok &= cJSON_AddNumberToObject(obj, "interval_minutes", s_entries[i].interval_minutes) != NULL;
         } else if (s_entries[i].type == CRON_TYPE_ONCE) {
             ok &= cJSON_AddNumberToObject(obj, "delay_minutes", s_entries[i].interval_minutes) != NULL;
+        } else if (s_entries[i].type == CRON_TYPE_EXPR) {
+            char expr_str[CRON_EXPR_MAX_LEN];
+            if (!cron_expr_format(&s_exprs[i], expr_str, sizeof(expr_str))) {
+                snprintf(expr_str, sizeof(expr_str), "?");
+            }
+            ok &= cJSON_AddStringToObject(obj, "expression", expr_str) != NULL;
+        } else if (s_entries[i].type == CRON_TYPE_CONDITION) {
+            const char *state_str = "unknown";
+            if (s_cond_states[i] == CRON_COND_STATE_TRUE) {
+                state_str = "true";
+            } else if (s_cond_states[i] == CRON_COND_STATE_FALSE) {
+                state_str = "false";
+            }
+            ok &= cJSON_AddStringToObject(obj, "condition", s_conds[i].source) != NULL;
+            ok &= cJSON_AddNumberToObject(obj, "check_seconds", s_conds[i].check_seconds) != NULL;
+            ok &= cJSON_AddStringToObject(obj, "state", state_str) != NULL;
         } else {
             char time_str[8];
             snprintf(time_str, sizeof(time_str), "%02d:%02d", s_entries[i].hour, s_entries[i].minute);
@@ -458,12 +591,14 @@ esp_err_t cron_delete(uint8_t id)
         if (s_entries[i].id == id) {
             cron_entry_t previous_entry = s_entries[i];
             s_entries[i].id = 0;
-            esp_err_t err = save_entry(i);
+            esp_err_t err = save_entry(i, true);
             if (err != ESP_OK) {
                 s_entries[i] = previous_entry;
+                save_entry(i, true);  // Re-queue the entry over the failed erase
                 entries_unlock();
                 return err;
             }
+            request_reschedule();
             ESP_LOGI(TAG, "Deleted cron entry %d", id);
             entries_unlock();
             return ESP_OK;
@@ -473,73 +608,142 @@ esp_err_t cron_delete(uint8_t id)
     return ESP_ERR_NOT_FOUND;
 }
 
-// Check and fire due entries
-static void check_entries(void)
+static bool cond_gpio_read(int pin, int32_t *level, void *ctx)
 {
-    time_t now;
-    struct tm timeinfo;
-    time(&now);
-    localtime_r(&now, &timeinfo);
+    (void)ctx;
+    if (!GPIO_IS_VALID_GPIO(pin)) {
+        return false;
+    }
+    // Enable the input buffer without resetting the pin, so a pin driven by
+    // gpio_write keeps its level and can still be sampled.
+    gpio_input_enable((gpio_num_t)pin);
+    *level = gpio_get_level((gpio_num_t)pin);
+    return true;
+}
+
+static bool cond_mem_read(const char *key, int32_t *value, void *ctx)
+{
+    char buf[24];
+    char *endptr = NULL;
+
+    (void)ctx;
+    if (!memory_get(key, buf, sizeof(buf))) {
+        return false;
+    }
+    long parsed = strtol(buf, &endptr, 10);
+    if (endptr == buf) {
+        return false;
+    }
+    *value = (int32_t)parsed;
+    return true;
+}
+
+static void queue_pending_fire(const cron_entry_t *entry, int *pending_count)
+{
+    if (*pending_count >= CRON_MAX_ENTRIES) {
+        return;
+    }
+    pending_cron_fire_t *pending = &s_pending_fires[*pending_count];
+    pending->id = entry->id;
+    strncpy(pending->action, entry->action, sizeof(pending->action) - 1);
+    pending->action[sizeof(pending->action) - 1] = '\0';
+    (*pending_count)++;
+}
+
+// Sample a condition entry and queue it only on a false -> true edge.
+static void check_condition(int slot, time_t now, const cron_cond_env_t *env, int *pending_count)
+{
+    cron_entry_t *entry = &s_entries[slot];
+    bool value = false;
 
+    s_cond_next_check[slot] = (int64_t)now + s_conds[slot].check_seconds;
+    if (!cron_cond_eval(&s_conds[slot], env, &value)) {
+        return;  // Input unavailable: keep the previous state
+    }
+    if (cron_cond_update_edge(&s_cond_states[slot], value)) {
+        ESP_LOGI(TAG, "Condition for cron %d became true: %s", entry->id, s_conds[slot].source);
+        // RAM only: a flapping input must not turn into flash writes.
+        entry->last_run = now;
+        queue_pending_fire(entry, pending_count);
+    }
+}
+
+// Fire every entry whose deadline has passed and return how long to sleep.
+static uint32_t fire_due_entries(void)
+{
     int pending_count = 0;
+    uint32_t wait_ms;
 
     if (!entries_lock(pdMS_TO_TICKS(1000))) {
         ESP_LOGW(TAG, "Skipping cron check: lock timeout");
-        return;
+        return 1000;
     }
 
-    for (int i = 0; i < CRON_MAX_ENTRIES; i++) {
-        cron_entry_t *entry = &s_entries[i];
-        if (entry->id == 0 || !entry->enabled) continue;
-
-        bool should_fire = false;
+    time_t now;
+    time(&now);
 
-        if (entry->type == CRON_TYPE_PERIODIC) {
-            uint32_t interval_seconds = entry->interval_minutes * 60;
-            if (now - entry->last_run >= interval_seconds) {
-                should_fire = true;
-            }
-        } else if (entry->type == CRON_TYPE_ONCE) {
-            uint32_t delay_seconds = entry->interval_minutes * 60;
-            time_t created_at = (time_t)entry->last_run;
-            if (now >= created_at && (uint32_t)(now - created_at) >= delay_seconds) {
-                should_fire = true;
-            }
-        } else if (entry->type == CRON_TYPE_DAILY && s_time_synced) {
-            // Check if current time matches
-            if (timeinfo.tm_hour == entry->hour && timeinfo.tm_min == entry->minute) {
-                // Only fire once per minute
-                uint32_t minute_start = now - timeinfo.tm_sec;
-                if (entry->last_run < minute_start) {
-                    should_fire = true;
-                }
+    if (s_sched_dirty) {
+        s_sched_dirty = false;
+        cron_sched_rebuild(&s_sched, s_entries, s_exprs, CRON_MAX_ENTRIES, (int64_t)now, s_time_synced);
+        for (int i = 0; i < CRON_MAX_ENTRIES; i++) {
+            if (s_entries[i].id != 0 && s_entries[i].enabled &&
+                s_entries[i].type == CRON_TYPE_CONDITION) {
+                int64_t due = s_cond_next_check[i] > (int64_t)now ? s_cond_next_check[i] : (int64_t)now;
+                cron_sched_push(&s_sched, (uint8_t)i, due);
             }
         }
+    }
 
-        if (should_fire) {
-            if (pending_count < CRON_MAX_ENTRIES) {
-                s_pending_fires[pending_count].id = entry->id;
-                strncpy(s_pending_fires[pending_count].action, entry->action, sizeof(s_pending_fires[pending_count].action) - 1);
-                s_pending_fires[pending_count].action[sizeof(s_pending_fires[pending_count].action) - 1] = '\0';
-                pending_count++;
-            }
+    struct tm local;
+    cron_cond_env_t env = {
+        .gpio_read = cond_gpio_read,
+        .mem_read = cond_mem_read,
+        .ctx = NULL,
+        .time_valid = s_time_synced && localtime_r(&now, &local) != NULL,
+    };
+    if (env.time_valid) {
+        env.hour = local.tm_hour;
+        env.minute = local.tm_min;
+        env.weekday = local.tm_wday;
+    }
+
+    cron_sched_node_t node;
+    while (cron_sched_peek(&s_sched, &node) && node.due <= (int64_t)now) {
+        cron_sched_pop(&s_sched, NULL);
+
+        int i = node.slot;
+        cron_entry_t *entry = &s_entries[i];
+        if (entry->id == 0 || !entry->enabled) {
+            continue;
+        }
 
-            if (entry->type == CRON_TYPE_ONCE) {
-                uint8_t fired_id = entry->id;
-                entry->id = 0;
-                if (save_entry(i) != ESP_OK) {
-                    entry->id = fired_id;
-                    ESP_LOGW(TAG, "Failed to clear one-shot cron %d after firing", fired_id);
-                }
-            } else {
-                entry->last_run = now;
-                if (save_entry(i) != ESP_OK) {
-                    ESP_LOGW(TAG, "Failed to persist run timestamp for cron %d", entry->id);
-                }
+        if (entry->type == CRON_TYPE_CONDITION) {
+            check_condition(i, now, &env, &pending_count);
+            cron_sched_push(&s_sched, (uint8_t)i, s_cond_next_check[i]);
+            continue;
+        }
+
+        queue_pending_fire(entry, &pending_count);
+
+        if (entry->type == CRON_TYPE_ONCE) {
+            uint8_t fired_id = entry->id;
+            entry->id = 0;
+            if (save_entry(i, true) != ESP_OK) {
+                entry->id = fired_id;
+                ESP_LOGW(TAG, "Failed to clear one-shot cron %d after firing", fired_id);
             }
+            continue;
         }
+
+        entry->last_run = now;
+        if (save_entry(i, false) != ESP_OK) {
+            ESP_LOGW(TAG, "Failed to queue run timestamp for cron %d", entry->id);
+        }
+        cron_sched_push(&s_sched, (uint8_t)i,
+                        cron_sched_next_fire(entry, &s_exprs[i], (int64_t)now, s_time_synced));
     }
 
+    wait_ms = cron_sched_wait_ms(&s_sched, (int64_t)now, CRON_MAX_SLEEP_MS);
     entries_unlock();
 
     for (int i = 0; i < pending_count; i++) {
@@ -547,22 +751,26 @@ static void check_entries(void)
 
         // Push action to agent queue
         channel_msg_t msg;
-        snprintf(msg.text, sizeof(msg.text), "[CRON %d] %s", s_pending_fires[i].id, s_pending_fires[i].action);
+        msg.chat_id = CHAT_ID_LOCAL;
+        msg.source = MSG_SOURCE_CRON;
+        snprintf(msg.text, sizeof(msg.text), CRON_MESSAGE_PREFIX "%d] %s", s_pending_fires[i].id, s_pending_fires[i].action);
 
         if (xQueueSend(s_agent_queue, &msg, pdMS_TO_TICKS(100)) != pdTRUE) {
             ESP_LOGW(TAG, "Agent queue full, cron action dropped");
         }
     }
+
+    return wait_ms;
 }
 
-// Cron task
+// Cron task: sleep until the earliest deadline or until the schedule changes.
 static void cron_task(void *arg)
 {
     (void)arg;
 
     while (1) {
-        check_entries();
-        vTaskDelay(pdMS_TO_TICKS(CRON_CHECK_INTERVAL_MS));
+        uint32_t wait_ms = fire_due_entries();
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(wait_ms));
     }
 }
 
@@ -576,7 +784,7 @@ esp_err_t cron_start(QueueHandle_t agent_input_queue)
     s_agent_queue = agent_input_queue;
 
     if (xTaskCreate(cron_task, "cron", CRON_TASK_STACK_SIZE, NULL,
-                    CRON_TASK_PRIORITY, NULL) != pdPASS) {
+                    CRON_TASK_PRIORITY, &s_cron_task_handle) != pdPASS) {
         ESP_LOGE(TAG, "Failed to create cron task");
         return ESP_ERR_NO_MEM;
     }
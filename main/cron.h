@@ -2,6 +2,8 @@
 #define CRON_H
 
 #include "config.h"
+#include "cron_cond.h"
+#include "cron_expr.h"
 #include "esp_err.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/queue.h"
@@ -12,8 +14,9 @@
 typedef enum {
     CRON_TYPE_PERIODIC,     // Every N minutes
     CRON_TYPE_DAILY,        // At specific hour:minute
-    CRON_TYPE_CONDITION,    // When condition is met (checked periodically)
+    CRON_TYPE_CONDITION,    // When condition becomes true (evaluated locally every few seconds)
     CRON_TYPE_ONCE,         // Run once after N minutes
+    CRON_TYPE_EXPR,         // Five-field cron expression (masks stored beside the entry)
 } cron_type_t;
 
 // Cron entry structure
@@ -37,6 +40,12 @@ esp_err_t cron_start(QueueHandle_t agent_input_queue);
 // Add/update a cron entry (returns entry ID, or 0 on error)
 uint8_t cron_set(cron_type_t type, uint16_t interval_or_hour, uint8_t minute, const char *action);
 
+// Add a cron-expression entry (returns entry ID, or 0 on error)
+uint8_t cron_set_expr(const cron_expr_t *expr, const char *action);
+
+// Add a condition entry that fires on each false -> true edge (returns entry ID, or 0 on error)
+uint8_t cron_set_condition(const cron_cond_t *cond, const char *action);
+
 // List all cron entries (fills buffer with JSON array string)
 void cron_list(char *buf, size_t buf_len);
 
@@ -0,0 +1,498 @@
+#include "cron_cond.h"
+#include "memory_keys.h"
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    const char *p;
+    cron_cond_t *cond;
+    int depth;              // Stack depth the emitted code reaches at runtime
+    bool (*pin_allowed)(int pin);
+    char *error;
+    size_t error_len;
+    bool failed;
+} compiler_t;
+
+static bool parse_or(compiler_t *c);
+
+static void fail(compiler_t *c, const char *reason, const char *near)
+{
+    if (c->failed) {
+        return;
+    }
+    c->failed = true;
+    if (c->error && c->error_len > 0) {
+        if (near && *near != '\0') {
+            snprintf(c->error, c->error_len, "%s near '%.12s'", reason, near);
+        } else {
+            snprintf(c->error, c->error_len, "%s", reason);
+        }
+    }
+}
+
+static void skip_space(compiler_t *c)
+{
+    while (*c->p == ' ' || *c->p == '\t') {
+        c->p++;
+    }
+}
+
+static bool accept(compiler_t *c, const char *token)
+{
+    size_t len = strlen(token);
+    skip_space(c);
+    if (strncmp(c->p, token, len) != 0) {
+        return false;
+    }
+    c->p += len;
+    return true;
+}
+
+static bool accept_word(compiler_t *c, const char *word)
+{
+    size_t len = strlen(word);
+    skip_space(c);
+    if (strncmp(c->p, word, len) != 0 ||
+        isalnum((unsigned char)c->p[len]) || c->p[len] == '_') {
+        return false;
+    }
+    c->p += len;
+    return true;
+}
+
+// Emit one op and track the runtime stack depth it leaves behind.
+static bool emit(compiler_t *c, cron_cond_opcode_t op, int32_t arg, int stack_delta)
+{
+    if (c->cond->op_count >= CRON_COND_MAX_OPS) {
+        fail(c, "condition too complex", NULL);
+        return false;
+    }
+    c->depth += stack_delta;
+    if (c->depth > CRON_COND_MAX_STACK) {
+        fail(c, "condition nested too deeply", NULL);
+        return false;
+    }
+    c->cond->ops[c->cond->op_count].op = (uint8_t)op;
+    c->cond->ops[c->cond->op_count].arg = arg;
+    c->cond->op_count++;
+    return true;
+}
+
+static bool parse_int(compiler_t *c, int32_t *out)
+{
+    skip_space(c);
+    if (!isdigit((unsigned char)*c->p)) {
+        fail(c, "expected number", c->p);
+        return false;
+    }
+    long value = 0;
+    while (isdigit((unsigned char)*c->p)) {
+        value = value * 10 + (*c->p - '0');
+        if (value > 1000000000L) {
+            fail(c, "number too large", NULL);
+            return false;
+        }
+        c->p++;
+    }
+    *out = (int32_t)value;
+    return true;
+}
+
+static bool parse_mem_key(compiler_t *c)
+{
+    char key[CRON_COND_KEY_LEN];
+    size_t len = 0;
+    bool quoted;
+
+    skip_space(c);
+    quoted = (*c->p == '"' || *c->p == '\'');
+    char quote = quoted ? *c->p++ : '\0';
+    while (isalnum((unsigned char)*c->p) || *c->p == '_') {
+        if (len + 1 >= sizeof(key)) {
+            fail(c, "memory key too long", NULL);
+            return false;
+        }
+        key[len++] = *c->p++;
+    }
+    key[len] = '\0';
+    if (quoted) {
+        if (*c->p != quote) {
+            fail(c, "unterminated memory key", NULL);
+            return false;
+        }
+        c->p++;
+    }
+    if (!memory_keys_is_user_key(key)) {
+        fail(c, "mem() key must start with u_", key);
+        return false;
+    }
+
+    int index = -1;
+    for (int i = 0; i < c->cond->key_count; i++) {
+        if (strcmp(c->cond->keys[i], key) == 0) {
+            index = i;
+            break;
+        }
+    }
+    if (index < 0) {
+        if (c->cond->key_count >= CRON_COND_MAX_KEYS) {
+            fail(c, "too many memory keys", key);
+            return false;
+        }
+        index = c->cond->key_count++;
+        memcpy(c->cond->keys[index], key, len + 1);
+    }
+    c->cond->uses |= CRON_COND_USES_MEMORY;
+    return emit(c, CRON_COND_OP_MEM, index, 1);
+}
+
+static bool parse_term(compiler_t *c)
+{
+    int32_t value;
+
+    skip_space(c);
+    if (accept(c, "-")) {
+        return parse_term(c) && emit(c, CRON_COND_OP_NEG, 0, 0);
+    }
+    if (isdigit((unsigned char)*c->p)) {
+        return parse_int(c, &value) && emit(c, CRON_COND_OP_CONST, value, 1);
+    }
+    if (accept(c, "(")) {
+        if (!parse_or(c)) {
+            return false;
+        }
+        if (!accept(c, ")")) {
+            fail(c, "expected ')'", c->p);
+            return false;
+        }
+        return true;
+    }
+    if (accept_word(c, "true")) {
+        return emit(c, CRON_COND_OP_CONST, 1, 1);
+    }
+    if (accept_word(c, "false")) {
+        return emit(c, CRON_COND_OP_CONST, 0, 1);
+    }
+    if (accept_word(c, "hour")) {
+        c->cond->uses |= CRON_COND_USES_TIME;
+        return emit(c, CRON_COND_OP_HOUR, 0, 1);
+    }
+    if (accept_word(c, "minute")) {
+        c->cond->uses |= CRON_COND_USES_TIME;
+        return emit(c, CRON_COND_OP_MINUTE, 0, 1);
+    }
+    if (accept_word(c, "weekday")) {
+        c->cond->uses |= CRON_COND_USES_TIME;
+        return emit(c, CRON_COND_OP_WEEKDAY, 0, 1);
+    }
+    if (accept_word(c, "gpio")) {
+        if (!accept(c, "(") || !parse_int(c, &value)) {
+            fail(c, "expected gpio(<pin>)", c->p);
+            return false;
+        }
+        if (!accept(c, ")")) {
+            fail(c, "expected ')'", c->p);
+            return false;
+        }
+        if (c->pin_allowed && !c->pin_allowed((int)value)) {
+            fail(c, "gpio pin not allowed", NULL);
+            return false;
+        }
+        c->cond->uses |= CRON_COND_USES_GPIO;
+        return emit(c, CRON_COND_OP_GPIO, value, 1);
+    }
+    if (accept_word(c, "mem")) {
+        if (!accept(c, "(")) {
+            fail(c, "expected mem(<key>)", c->p);
+            return false;
+        }
+        if (!parse_mem_key(c)) {
+            return false;
+        }
+        if (!accept(c, ")")) {
+            fail(c, "expected ')'", c->p);
+            return false;
+        }
+        return true;
+    }
+
+    fail(c, "unexpected token", c->p);
+    return false;
+}
+
+static bool parse_sum(compiler_t *c)
+{
+    if (!parse_term(c)) {
+        return false;
+    }
+    for (;;) {
+        cron_cond_opcode_t op;
+        skip_space(c);
+        if (c->p[0] == '+') {
+            op = CRON_COND_OP_ADD;
+        } else if (c->p[0] == '-') {
+            op = CRON_COND_OP_SUB;
+        } else {
+            return true;
+        }
+        c->p++;
+        if (!parse_term(c) || !emit(c, op, 0, -1)) {
+            return false;
+        }
+    }
+}
+
+static bool parse_cmp(compiler_t *c)
+{
+    static const struct {
+        const char *token;
+        cron_cond_opcode_t op;
+    } RELOPS[] = {
+        {"==", CRON_COND_OP_EQ}, {"!=", CRON_COND_OP_NE},
+        {"<=", CRON_COND_OP_LE}, {">=", CRON_COND_OP_GE},
+        {"<", CRON_COND_OP_LT}, {">", CRON_COND_OP_GT},
+    };
+
+    if (!parse_sum(c)) {
+        return false;
+    }
+    for (size_t i = 0; i < sizeof(RELOPS) / sizeof(RELOPS[0]); i++) {
+        if (accept(c, RELOPS[i].token)) {
+            return parse_sum(c) && emit(c, RELOPS[i].op, 0, -1);
+        }
+    }
+    return true;
+}
+
+static bool parse_unary(compiler_t *c)
+{
+    skip_space(c);
+    if (c->p[0] == '!' && c->p[1] != '=') {
+        c->p++;
+        return parse_unary(c) && emit(c, CRON_COND_OP_NOT, 0, 0);
+    }
+    return parse_cmp(c);
+}
+
+static bool parse_and(compiler_t *c)
+{
+    if (!parse_unary(c)) {
+        return false;
+    }
+    while (accept(c, "&&")) {
+        if (!parse_unary(c) || !emit(c, CRON_COND_OP_AND, 0, -1)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool parse_or(compiler_t *c)
+{
+    if (!parse_and(c)) {
+        return false;
+    }
+    while (accept(c, "||")) {
+        if (!parse_and(c) || !emit(c, CRON_COND_OP_OR, 0, -1)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool cron_cond_compile(const char *text, uint16_t check_seconds, bool (*pin_allowed)(int pin),
+                       cron_cond_t *cond, char *error, size_t error_len)
+{
+    compiler_t c;
+
+    if (error && error_len > 0) {
+        error[0] = '\0';
+    }
+    if (!cond) {
+        return false;
+    }
+    memset(cond, 0, sizeof(*cond));
+    memset(&c, 0, sizeof(c));
+    c.cond = cond;
+    c.pin_allowed = pin_allowed;
+    c.error = error;
+    c.error_len = error_len;
+
+    if (!text || text[0] == '\0') {
+        fail(&c, "condition required", NULL);
+        return false;
+    }
+    if (strlen(text) >= CRON_COND_MAX_LEN) {
+        fail(&c, "condition too long", NULL);
+        return false;
+    }
+    if (check_seconds < CRON_COND_MIN_CHECK_S || check_seconds > CRON_COND_MAX_CHECK_S) {
+        fail(&c, "check interval out of range", NULL);
+        return false;
+    }
+
+    c.p = text;
+    if (!parse_or(&c)) {
+        memset(cond, 0, sizeof(*cond));
+        return false;
+    }
+    skip_space(&c);
+    if (*c.p != '\0') {
+        fail(&c, "unexpected trailing input", c.p);
+        memset(cond, 0, sizeof(*cond));
+        return false;
+    }
+
+    memcpy(cond->source, text, strlen(text) + 1);
+    cond->check_seconds = check_seconds;
+    return true;
+}
+
+static int op_stack_delta(uint8_t op)
+{
+    switch (op) {
+        case CRON_COND_OP_CONST:
+        case CRON_COND_OP_GPIO:
+        case CRON_COND_OP_MEM:
+        case CRON_COND_OP_HOUR:
+        case CRON_COND_OP_MINUTE:
+        case CRON_COND_OP_WEEKDAY:
+            return 1;
+        case CRON_COND_OP_NOT:
+        case CRON_COND_OP_NEG:
+            return 0;
+        case CRON_COND_OP_AND:
+        case CRON_COND_OP_OR:
+        case CRON_COND_OP_EQ:
+        case CRON_COND_OP_NE:
+        case CRON_COND_OP_LT:
+        case CRON_COND_OP_LE:
+        case CRON_COND_OP_GT:
+        case CRON_COND_OP_GE:
+        case CRON_COND_OP_ADD:
+        case CRON_COND_OP_SUB:
+            return -1;
+        default:
+            return -100;
+    }
+}
+
+bool cron_cond_is_valid(const cron_cond_t *cond)
+{
+    int depth = 0;
+
+    if (!cond || cond->op_count == 0 || cond->op_count > CRON_COND_MAX_OPS ||
+        cond->key_count > CRON_COND_MAX_KEYS ||
+        cond->check_seconds < CRON_COND_MIN_CHECK_S ||
+        cond->check_seconds > CRON_COND_MAX_CHECK_S ||
+        memchr(cond->source, '\0', sizeof(cond->source)) == NULL) {
+        return false;
+    }
+
+    for (int i = 0; i < cond->op_count; i++) {
+        const cron_cond_op_t *op = &cond->ops[i];
+        int delta = op_stack_delta(op->op);
+        if (delta == -100) {
+            return false;
+        }
+        // Unary and binary ops need operands already on the stack.
+        if ((delta == 0 && depth < 1) || (delta == -1 && depth < 2)) {
+            return false;
+        }
+        if (op->op == CRON_COND_OP_MEM && (op->arg < 0 || op->arg >= cond->key_count)) {
+            return false;
+        }
+        depth += delta;
+        if (depth > CRON_COND_MAX_STACK) {
+            return false;
+        }
+    }
+    return depth == 1;
+}
+
+bool cron_cond_eval(const cron_cond_t *cond, const cron_cond_env_t *env, bool *result)
+{
+    int64_t stack[CRON_COND_MAX_STACK];
+    int sp = 0;
+
+    if (!cron_cond_is_valid(cond) || !env || !result) {
+        return false;
+    }
+    if ((cond->uses & CRON_COND_USES_TIME) && !env->time_valid) {
+        return false;
+    }
+
+    for (int i = 0; i < cond->op_count; i++) {
+        const cron_cond_op_t *op = &cond->ops[i];
+        int32_t value = 0;
+
+        switch (op->op) {
+            case CRON_COND_OP_CONST:
+                stack[sp++] = op->arg;
+                continue;
+            case CRON_COND_OP_GPIO:
+                if (!env->gpio_read || !env->gpio_read((int)op->arg, &value, env->ctx)) {
+                    return false;
+                }
+                stack[sp++] = value;
+                continue;
+            case CRON_COND_OP_MEM:
+                if (!env->mem_read || !env->mem_read(cond->keys[op->arg], &value, env->ctx)) {
+                    return false;
+                }
+                stack[sp++] = value;
+                continue;
+            case CRON_COND_OP_HOUR:
+                stack[sp++] = env->hour;
+                continue;
+            case CRON_COND_OP_MINUTE:
+                stack[sp++] = env->minute;
+                continue;
+            case CRON_COND_OP_WEEKDAY:
+                stack[sp++] = env->weekday;
+                continue;
+            case CRON_COND_OP_NOT:
+                stack[sp - 1] = !stack[sp - 1];
+                continue;
+            case CRON_COND_OP_NEG:
+                stack[sp - 1] = -stack[sp - 1];
+                continue;
+            default:
+                break;
+        }
+
+        int64_t rhs = stack[--sp];
+        int64_t lhs = stack[sp - 1];
+        int64_t out;
+        switch (op->op) {
+            case CRON_COND_OP_AND: out = lhs && rhs; break;
+            case CRON_COND_OP_OR: out = lhs || rhs; break;
+            case CRON_COND_OP_EQ: out = lhs == rhs; break;
+            case CRON_COND_OP_NE: out = lhs != rhs; break;
+            case CRON_COND_OP_LT: out = lhs < rhs; break;
+            case CRON_COND_OP_LE: out = lhs <= rhs; break;
+            case CRON_COND_OP_GT: out = lhs > rhs; break;
+            case CRON_COND_OP_GE: out = lhs >= rhs; break;
+            case CRON_COND_OP_ADD: out = lhs + rhs; break;
+            case CRON_COND_OP_SUB: out = lhs - rhs; break;
+            default: return false;
+        }
+        stack[sp - 1] = out;
+    }
+
+    *result = stack[0] != 0;
+    return true;
+}
+
+bool cron_cond_update_edge(cron_cond_state_t *state, bool value)
+{
+    if (!state) {
+        return false;
+    }
+
+    cron_cond_state_t previous = *state;
+    *state = value ? CRON_COND_STATE_TRUE : CRON_COND_STATE_FALSE;
+    return previous == CRON_COND_STATE_FALSE && value;
+}
@@ -0,0 +1,102 @@
+#ifndef CRON_COND_H
+#define CRON_COND_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// On-device predicates for CRON_TYPE_CONDITION entries, e.g.
+//   gpio(4)==1 && hour>=18
+//   mem(u_temp) > 30 || !(weekday==0 || weekday==6)
+// Compiled once into a small postfix program so the cron task can evaluate it
+// every few seconds without involving the LLM.
+//
+// Grammar (C precedence):  or := and ('||' and)*   and := unary ('&&' unary)*
+//   unary := '!' unary | cmp       cmp := sum (('=='|'!='|'<'|'<='|'>'|'>=') sum)?
+//   sum := term (('+'|'-') term)*  term := '-' term | INT | 'true' | 'false'
+//        | 'gpio(' INT ')' | 'mem(' KEY ')' | 'hour' | 'minute' | 'weekday' | '(' or ')'
+// mem() keys must be user keys (u_*); values are parsed as integers.
+
+#define CRON_COND_MAX_LEN       80      // Source text, including terminator
+#define CRON_COND_MAX_OPS       24
+#define CRON_COND_MAX_KEYS      2
+#define CRON_COND_KEY_LEN       16      // NVS key limit (15 chars) + terminator
+#define CRON_COND_MAX_STACK     8
+#define CRON_COND_MIN_CHECK_S   1
+#define CRON_COND_MAX_CHECK_S   3600
+
+#define CRON_COND_USES_TIME     0x01
+#define CRON_COND_USES_GPIO     0x02
+#define CRON_COND_USES_MEMORY   0x04
+
+typedef enum {
+    CRON_COND_OP_CONST = 1,
+    CRON_COND_OP_GPIO,
+    CRON_COND_OP_MEM,
+    CRON_COND_OP_HOUR,
+    CRON_COND_OP_MINUTE,
+    CRON_COND_OP_WEEKDAY,
+    CRON_COND_OP_NOT,
+    CRON_COND_OP_NEG,
+    CRON_COND_OP_AND,
+    CRON_COND_OP_OR,
+    CRON_COND_OP_EQ,
+    CRON_COND_OP_NE,
+    CRON_COND_OP_LT,
+    CRON_COND_OP_LE,
+    CRON_COND_OP_GT,
+    CRON_COND_OP_GE,
+    CRON_COND_OP_ADD,
+    CRON_COND_OP_SUB,
+} cron_cond_opcode_t;
+
+typedef struct {
+    uint8_t op;         // cron_cond_opcode_t
+    int32_t arg;        // Constant, GPIO pin, or key index
+} cron_cond_op_t;
+
+// Persisted as-is in the zc_cron namespace; keep the layout stable.
+typedef struct {
+    char source[CRON_COND_MAX_LEN];
+    char keys[CRON_COND_MAX_KEYS][CRON_COND_KEY_LEN];
+    cron_cond_op_t ops[CRON_COND_MAX_OPS];
+    uint16_t check_seconds;     // Evaluation period
+    uint8_t op_count;
+    uint8_t key_count;
+    uint8_t uses;               // CRON_COND_USES_*
+} cron_cond_t;
+
+// Inputs for one evaluation. Reader callbacks return false when a value is
+// unavailable, which makes the whole sample unknown rather than false.
+typedef struct {
+    bool (*gpio_read)(int pin, int32_t *level, void *ctx);
+    bool (*mem_read)(const char *key, int32_t *value, void *ctx);
+    void *ctx;
+    bool time_valid;
+    int hour;           // 0-23, local
+    int minute;         // 0-59
+    int weekday;        // 0-6, Sunday = 0
+} cron_cond_env_t;
+
+// Edge detector state: the first known sample only establishes a baseline.
+typedef enum {
+    CRON_COND_STATE_UNKNOWN = 0,
+    CRON_COND_STATE_FALSE,
+    CRON_COND_STATE_TRUE,
+} cron_cond_state_t;
+
+// Compile text into cond. pin_allowed (optional) vets gpio() pins against the
+// device policy. On failure returns false and writes a short reason to error.
+bool cron_cond_compile(const char *text, uint16_t check_seconds, bool (*pin_allowed)(int pin),
+                       cron_cond_t *cond, char *error, size_t error_len);
+
+// True when the program is well-formed (used to reject corrupt NVS blobs).
+bool cron_cond_is_valid(const cron_cond_t *cond);
+
+// Evaluate once. Returns false if any input was unavailable.
+bool cron_cond_eval(const cron_cond_t *cond, const cron_cond_env_t *env, bool *result);
+
+// Feed one sample into the edge detector. Returns true on a false -> true edge.
+bool cron_cond_update_edge(cron_cond_state_t *state, bool value);
+
+#endif // CRON_COND_H
@@ -0,0 +1,528 @@
+#define _POSIX_C_SOURCE 200809L  // localtime_r on strict C99 host builds
+
+#include "cron_expr.h"
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define CRON_EXPR_FIELDS        5
+#define CRON_EXPR_SEARCH_YEARS  8   // Long enough to reach the next Feb 29
+
+typedef struct {
+    const char *name;
+    int min;
+    int max;
+    const char *const *names;   // Optional 3-letter aliases, index 0 == min
+} field_spec_t;
+
+static const char *const MONTH_NAMES[] = {
+    "JAN", "FEB", "MAR", "APR", "MAY", "JUN", "JUL", "AUG", "SEP", "OCT", "NOV", "DEC", NULL
+};
+static const char *const WEEKDAY_NAMES[] = {
+    "SUN", "MON", "TUE", "WED", "THU", "FRI", "SAT", NULL
+};
+
+static const field_spec_t FIELD_SPECS[CRON_EXPR_FIELDS] = {
+    {"minute", 0, 59, NULL},
+    {"hour", 0, 23, NULL},
+    {"day-of-month", 1, 31, NULL},
+    {"month", 1, 12, MONTH_NAMES},
+    {"day-of-week", 0, 7, WEEKDAY_NAMES},   // 7 folds onto Sunday
+};
+
+typedef struct {
+    const char *alias;
+    const char *expansion;
+} expr_alias_t;
+
+static const expr_alias_t EXPR_ALIASES[] = {
+    {"@hourly", "0 * * * *"},
+    {"@daily", "0 0 * * *"},
+    {"@midnight", "0 0 * * *"},
+    {"@weekly", "0 0 * * 0"},
+    {"@monthly", "0 0 1 * *"},
+    {"@yearly", "0 0 1 1 *"},
+    {"@annually", "0 0 1 1 *"},
+};
+
+static void set_error(char *error, size_t error_len, const char *prefix, const char *field,
+                      const char *suffix)
+{
+    if (error && error_len > 0) {
+        snprintf(error, error_len, "%s%s%s", prefix, field, suffix);
+    }
+}
+
+static bool parse_value(const char **cursor, const field_spec_t *spec, int *value_out)
+{
+    const char *p = *cursor;
+
+    if (isdigit((unsigned char)*p)) {
+        int value = 0;
+        while (isdigit((unsigned char)*p)) {
+            value = value * 10 + (*p - '0');
+            if (value > 1000) {
+                return false;
+            }
+            p++;
+        }
+        *value_out = value;
+        *cursor = p;
+        return true;
+    }
+
+    if (spec->names && isalpha((unsigned char)p[0]) && isalpha((unsigned char)p[1]) &&
+        isalpha((unsigned char)p[2])) {
+        for (int i = 0; spec->names[i] != NULL; i++) {
+            const char *name = spec->names[i];
+            if (toupper((unsigned char)p[0]) == name[0] &&
+                toupper((unsigned char)p[1]) == name[1] &&
+                toupper((unsigned char)p[2]) == name[2]) {
+                *value_out = spec->min + i;
+                *cursor = p + 3;
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+// Parse one comma-separated field into a bitmask (bit N == value N).
+static bool parse_field(const char *text, const field_spec_t *spec, uint64_t *mask_out,
+                        bool *star_out, char *error, size_t error_len)
+{
+    const char *p = text;
+    uint64_t mask = 0;
+
+    *star_out = strcmp(text, "*") == 0;
+
+    while (*p != '\0') {
+        int lo;
+        int hi;
+        int step = 1;
+
+        if (*p == '*') {
+            lo = spec->min;
+            hi = spec->max;
+            p++;
+        } else {
+            if (!parse_value(&p, spec, &lo)) {
+                set_error(error, error_len, "invalid ", spec->name, " value");
+                return false;
+            }
+            hi = lo;
+            if (*p == '-') {
+                p++;
+                if (!parse_value(&p, spec, &hi)) {
+                    set_error(error, error_len, "invalid ", spec->name, " range");
+                    return false;
+                }
+            } else if (*p == '/') {
+                hi = spec->max;   // "5/15" means 5-max/15
+            }
+        }
+
+        if (*p == '/') {
+            p++;
+            if (!isdigit((unsigned char)*p)) {
+                set_error(error, error_len, "invalid ", spec->name, " step");
+                return false;
+            }
+            step = 0;
+            while (isdigit((unsigned char)*p)) {
+                step = step * 10 + (*p - '0');
+                if (step > spec->max + 1) {
+                    break;
+                }
+                p++;
+            }
+            if (step < 1 || step > spec->max + 1 || isdigit((unsigned char)*p)) {
+                set_error(error, error_len, "", spec->name, " step out of range");
+                return false;
+            }
+        }
+
+        if (lo < spec->min || hi > spec->max || lo > hi) {
+            set_error(error, error_len, "", spec->name, " out of range");
+            return false;
+        }
+
+        for (int v = lo; v <= hi; v += step) {
+            mask |= (uint64_t)1 << v;
+        }
+
+        if (*p == ',') {
+            p++;
+            if (*p == '\0') {
+                set_error(error, error_len, "trailing comma in ", spec->name, "");
+                return false;
+            }
+        } else if (*p != '\0') {
+            set_error(error, error_len, "unexpected character in ", spec->name, "");
+            return false;
+        }
+    }
+
+    if (mask == 0) {
+        set_error(error, error_len, "empty ", spec->name, " field");
+        return false;
+    }
+
+    *mask_out = mask;
+    return true;
+}
+
+bool cron_expr_parse(const char *text, cron_expr_t *expr, char *error, size_t error_len)
+{
+    char buf[CRON_EXPR_MAX_LEN + 1];
+    char *fields[CRON_EXPR_FIELDS];
+    int field_count = 0;
+
+    if (error && error_len > 0) {
+        error[0] = '\0';
+    }
+    if (!text || !expr) {
+        set_error(error, error_len, "expression required", "", "");
+        return false;
+    }
+
+    while (*text == ' ' || *text == '\t') {
+        text++;
+    }
+    for (size_t i = 0; i < sizeof(EXPR_ALIASES) / sizeof(EXPR_ALIASES[0]); i++) {
+        size_t alias_len = strlen(EXPR_ALIASES[i].alias);
+        if (strncmp(text, EXPR_ALIASES[i].alias, alias_len) == 0 &&
+            (text[alias_len] == '\0' || isspace((unsigned char)text[alias_len]))) {
+            text = EXPR_ALIASES[i].expansion;
+            break;
+        }
+    }
+
+    if (strlen(text) > CRON_EXPR_MAX_LEN) {
+        set_error(error, error_len, "expression too long", "", "");
+        return false;
+    }
+    strcpy(buf, text);
+
+    char *p = buf;
+    while (*p != '\0') {
+        while (*p == ' ' || *p == '\t') {
+            *p++ = '\0';
+        }
+        if (*p == '\0') {
+            break;
+        }
+        if (field_count == CRON_EXPR_FIELDS) {
+            set_error(error, error_len, "expected 5 fields (min hour dom month dow)", "", "");
+            return false;
+        }
+        fields[field_count++] = p;
+        while (*p != '\0' && *p != ' ' && *p != '\t') {
+            p++;
+        }
+    }
+
+    if (field_count != CRON_EXPR_FIELDS) {
+        set_error(error, error_len, "expected 5 fields (min hour dom month dow)", "", "");
+        return false;
+    }
+
+    uint64_t masks[CRON_EXPR_FIELDS];
+    bool stars[CRON_EXPR_FIELDS];
+    for (int i = 0; i < CRON_EXPR_FIELDS; i++) {
+        if (!parse_field(fields[i], &FIELD_SPECS[i], &masks[i], &stars[i], error, error_len)) {
+            return false;
+        }
+    }
+
+    // Fold weekday 7 onto Sunday.
+    if (masks[4] & ((uint64_t)1 << 7)) {
+        masks[4] = (masks[4] & 0x7f) | 0x01;
+    }
+
+    memset(expr, 0, sizeof(*expr));
+    expr->minutes = masks[0];
+    expr->hours = (uint32_t)masks[1];
+    expr->days = (uint32_t)masks[2];
+    expr->months = (uint16_t)masks[3];
+    expr->weekdays = (uint8_t)masks[4];
+    expr->flags = (uint8_t)((stars[2] ? CRON_EXPR_FLAG_DOM_STAR : 0) |
+                            (stars[4] ? CRON_EXPR_FLAG_DOW_STAR : 0));
+    return true;
+}
+
+bool cron_expr_is_valid(const cron_expr_t *expr)
+{
+    if (!expr) {
+        return false;
+    }
+    return expr->minutes != 0 && (expr->minutes >> 60) == 0 &&
+           expr->hours != 0 && (expr->hours >> 24) == 0 &&
+           (expr->days & ~0xfffffffeu) == 0 && expr->days != 0 &&
+           (expr->months & ~0x1ffeu) == 0 && expr->months != 0 &&
+           (expr->weekdays & 0x80) == 0 && expr->weekdays != 0 &&
+           (expr->flags & ~(CRON_EXPR_FLAG_DOM_STAR | CRON_EXPR_FLAG_DOW_STAR)) == 0;
+}
+
+static bool append_text(char *buf, size_t buf_len, size_t *len, const char *text)
+{
+    size_t add = strlen(text);
+    if (*len + add >= buf_len) {
+        return false;
+    }
+    memcpy(buf + *len, text, add + 1);
+    *len += add;
+    return true;
+}
+
+// Day fields pass star_flag explicitly: a spelled-out full range still counts as
+// "restricted" for the DOM/DOW OR rule, so it must not collapse to '*'.
+static bool format_field(uint64_t mask, int min, int max, int star_flag,
+                         char *buf, size_t buf_len, size_t *len)
+{
+    char part[32];
+    uint64_t full = 0;
+
+    for (int v = min; v <= max; v++) {
+        full |= (uint64_t)1 << v;
+    }
+    if (star_flag > 0 || (star_flag < 0 && mask == full)) {
+        return append_text(buf, buf_len, len, "*");
+    }
+
+    // "*/N" when the set is exactly every Nth value from min.
+    int first = -1;
+    int second = -1;
+    for (int v = min; v <= max; v++) {
+        if (mask & ((uint64_t)1 << v)) {
+            if (first < 0) {
+                first = v;
+            } else {
+                second = v;
+                break;
+            }
+        }
+    }
+    if (first == min && second > first) {
+        int step = second - first;
+        uint64_t stepped = 0;
+        for (int v = min; v <= max; v += step) {
+            stepped |= (uint64_t)1 << v;
+        }
+        if (stepped == mask && step > 1) {
+            snprintf(part, sizeof(part), "*/%d", step);
+            return append_text(buf, buf_len, len, part);
+        }
+    }
+
+    bool first_item = true;
+    int v = min;
+    while (v <= max) {
+        if (!(mask & ((uint64_t)1 << v))) {
+            v++;
+            continue;
+        }
+        int run_end = v;
+        while (run_end + 1 <= max && (mask & ((uint64_t)1 << (run_end + 1)))) {
+            run_end++;
+        }
+        if (run_end > v) {
+            snprintf(part, sizeof(part), "%s%d-%d", first_item ? "" : ",", v, run_end);
+        } else {
+            snprintf(part, sizeof(part), "%s%d", first_item ? "" : ",", v);
+        }
+        if (!append_text(buf, buf_len, len, part)) {
+            return false;
+        }
+        first_item = false;
+        v = run_end + 1;
+    }
+    return true;
+}
+
+bool cron_expr_format(const cron_expr_t *expr, char *buf, size_t buf_len)
+{
+    size_t len = 0;
+
+    if (!buf || buf_len == 0) {
+        return false;
+    }
+    buf[0] = '\0';
+    if (!cron_expr_is_valid(expr)) {
+        return false;
+    }
+
+    return format_field(expr->minutes, 0, 59, -1, buf, buf_len, &len) &&
+           append_text(buf, buf_len, &len, " ") &&
+           format_field(expr->hours, 0, 23, -1, buf, buf_len, &len) &&
+           append_text(buf, buf_len, &len, " ") &&
+           format_field(expr->days, 1, 31, (expr->flags & CRON_EXPR_FLAG_DOM_STAR) ? 1 : 0,
+                        buf, buf_len, &len) &&
+           append_text(buf, buf_len, &len, " ") &&
+           format_field(expr->months, 1, 12, -1, buf, buf_len, &len) &&
+           append_text(buf, buf_len, &len, " ") &&
+           format_field(expr->weekdays, 0, 6, (expr->flags & CRON_EXPR_FLAG_DOW_STAR) ? 1 : 0,
+                        buf, buf_len, &len);
+}
+
+// Local wall-clock position used while searching; DST only matters when the
+// final candidate is converted back with mktime().
+typedef struct {
+    int year;
+    int month;  // 1-12
+    int day;    // 1-31
+    int hour;
+    int minute;
+} wall_time_t;
+
+static bool is_leap_year(int year)
+{
+    return (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+}
+
+static int days_in_month(int year, int month)
+{
+    static const int DAYS[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    if (month == 2 && is_leap_year(year)) {
+        return 29;
+    }
+    return DAYS[month - 1];
+}
+
+// Sakamoto's algorithm; 0 = Sunday.
+static int day_of_week(int year, int month, int day)
+{
+    static const int OFFSETS[12] = {0, 3, 2, 5, 0, 3, 5, 1, 4, 6, 2, 4};
+    if (month < 3) {
+        year -= 1;
+    }
+    return (year + year / 4 - year / 100 + year / 400 + OFFSETS[month - 1] + day) % 7;
+}
+
+static void advance_month(wall_time_t *w)
+{
+    w->month++;
+    if (w->month > 12) {
+        w->month = 1;
+        w->year++;
+    }
+    w->day = 1;
+    w->hour = 0;
+    w->minute = 0;
+}
+
+static void advance_day(wall_time_t *w)
+{
+    w->day++;
+    w->hour = 0;
+    w->minute = 0;
+    if (w->day > days_in_month(w->year, w->month)) {
+        advance_month(w);
+    }
+}
+
+static void advance_minute(wall_time_t *w)
+{
+    w->minute++;
+    if (w->minute > 59) {
+        w->minute = 0;
+        w->hour++;
+        if (w->hour > 23) {
+            advance_day(w);
+        }
+    }
+}
+
+static bool day_matches(const cron_expr_t *expr, const wall_time_t *w)
+{
+    bool dom = (expr->days & ((uint32_t)1 << w->day)) != 0;
+    bool dow = (expr->weekdays & (1u << day_of_week(w->year, w->month, w->day))) != 0;
+    bool dom_star = (expr->flags & CRON_EXPR_FLAG_DOM_STAR) != 0;
+    bool dow_star = (expr->flags & CRON_EXPR_FLAG_DOW_STAR) != 0;
+
+    if (!dom_star && !dow_star) {
+        return dom || dow;
+    }
+    return dom && dow;
+}
+
+static int next_set_bit(uint64_t mask, int from, int max)
+{
+    for (int v = from; v <= max; v++) {
+        if (mask & ((uint64_t)1 << v)) {
+            return v;
+        }
+    }
+    return -1;
+}
+
+int64_t cron_expr_next(const cron_expr_t *expr, int64_t after)
+{
+    time_t after_t = (time_t)after;
+    struct tm local;
+
+    if (!cron_expr_is_valid(expr) || !localtime_r(&after_t, &local)) {
+        return CRON_EXPR_NEVER;
+    }
+
+    wall_time_t w = {
+        .year = local.tm_year + 1900,
+        .month = local.tm_mon + 1,
+        .day = local.tm_mday,
+        .hour = local.tm_hour,
+        .minute = local.tm_min,
+    };
+    int last_year = w.year + CRON_EXPR_SEARCH_YEARS;
+    advance_minute(&w);
+
+    while (w.year <= last_year) {
+        if (!(expr->months & (1u << w.month))) {
+            advance_month(&w);
+            continue;
+        }
+        if (!day_matches(expr, &w)) {
+            advance_day(&w);
+            continue;
+        }
+
+        int hour = next_set_bit(expr->hours, w.hour, 23);
+        if (hour < 0) {
+            advance_day(&w);
+            continue;
+        }
+        if (hour != w.hour) {
+            w.hour = hour;
+            w.minute = 0;
+        }
+
+        int minute = next_set_bit(expr->minutes, w.minute, 59);
+        if (minute < 0) {
+            w.minute = 59;
+            advance_minute(&w);
+            continue;
+        }
+        w.minute = minute;
+
+        struct tm candidate;
+        memset(&candidate, 0, sizeof(candidate));
+        candidate.tm_year = w.year - 1900;
+        candidate.tm_mon = w.month - 1;
+        candidate.tm_mday = w.day;
+        candidate.tm_hour = w.hour;
+        candidate.tm_min = w.minute;
+        candidate.tm_isdst = -1;
+
+        // Wall times skipped by spring-forward resolve to the shifted instant;
+        // a repeated fall-back time that lands before `after` is passed over.
+        time_t fire = mktime(&candidate);
+        if (fire != (time_t)-1 && (int64_t)fire > after) {
+            return (int64_t)fire;
+        }
+        advance_minute(&w);
+    }
+
+    return CRON_EXPR_NEVER;
+}
@@ -0,0 +1,43 @@
+#ifndef CRON_EXPR_H
+#define CRON_EXPR_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Standard five-field cron expressions ("min hour dom month dow") compiled to
+// bitmasks. Supports '*', numbers, ranges, lists, '/step', JAN-DEC and SUN-SAT
+// names (7 also means Sunday) and the @hourly/@daily/@weekly/@monthly/@yearly
+// shorthands. When both day-of-month and day-of-week are restricted, a day
+// matches if either does (classic Vixie cron semantics).
+
+#define CRON_EXPR_MAX_LEN       64
+#define CRON_EXPR_NEVER         INT64_MAX
+
+#define CRON_EXPR_FLAG_DOM_STAR 0x01
+#define CRON_EXPR_FLAG_DOW_STAR 0x02
+
+// Persisted as-is in the zc_cron namespace; keep the layout stable.
+typedef struct {
+    uint64_t minutes;   // bits 0-59
+    uint32_t hours;     // bits 0-23
+    uint32_t days;      // bits 1-31
+    uint16_t months;    // bits 1-12
+    uint8_t weekdays;   // bits 0-6, Sunday = 0
+    uint8_t flags;      // CRON_EXPR_FLAG_*
+} cron_expr_t;
+
+// Parse text into expr. On failure returns false and writes a short reason to error.
+bool cron_expr_parse(const char *text, cron_expr_t *expr, char *error, size_t error_len);
+
+// True when every field has at least one bit set and the flags are known.
+bool cron_expr_is_valid(const cron_expr_t *expr);
+
+// Render expr back to canonical five-field text (ranges and steps collapsed to lists/ranges).
+bool cron_expr_format(const cron_expr_t *expr, char *buf, size_t buf_len);
+
+// First matching local minute strictly after `after` (Unix seconds), resolved in
+// the active TZ. Returns CRON_EXPR_NEVER if nothing matches within eight years.
+int64_t cron_expr_next(const cron_expr_t *expr, int64_t after);
+
+#endif // CRON_EXPR_H
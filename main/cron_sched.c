@@ -0,0 +1,236 @@
+#define _POSIX_C_SOURCE 200809L  // localtime_r on strict C99 host builds
+
+#include "cron_sched.h"
+#include <string.h>
+#include <time.h>
+
+#define SECONDS_PER_MINUTE 60
+
+static int64_t clamp_not_before(int64_t due, int64_t now)
+{
+    return due < now ? now : due;
+}
+
+static int64_t next_daily_fire(const cron_entry_t *entry, int64_t now)
+{
+    time_t now_t = (time_t)now;
+    struct tm today;
+
+    if (!localtime_r(&now_t, &today)) {
+        return CRON_SCHED_NEVER;
+    }
+
+    // Today's slot if it has not run yet and its minute is not over, otherwise
+    // the following day. mktime() normalizes tm_mday overflow and, with
+    // tm_isdst = -1, resolves the wall-clock time in whatever offset applies.
+    for (int day = 0; day < 3; day++) {
+        struct tm candidate = today;
+        candidate.tm_mday += day;
+        candidate.tm_hour = entry->hour;
+        candidate.tm_min = entry->minute;
+        candidate.tm_sec = 0;
+        candidate.tm_isdst = -1;
+
+        time_t fire = mktime(&candidate);
+        if (fire == (time_t)-1) {
+            continue;
+        }
+        if ((int64_t)fire > (int64_t)entry->last_run &&
+            (int64_t)fire + SECONDS_PER_MINUTE > now) {
+            return clamp_not_before((int64_t)fire, now);
+        }
+    }
+
+    return CRON_SCHED_NEVER;
+}
+
+int64_t cron_sched_next_fire(const cron_entry_t *entry, const cron_expr_t *expr,
+                             int64_t now, bool time_synced)
+{
+    if (!entry || entry->id == 0 || !entry->enabled) {
+        return CRON_SCHED_NEVER;
+    }
+
+    switch (entry->type) {
+        case CRON_TYPE_PERIODIC:
+            if (entry->last_run == 0) {
+                return now;
+            }
+            return clamp_not_before((int64_t)entry->last_run +
+                                    (int64_t)entry->interval_minutes * SECONDS_PER_MINUTE, now);
+        case CRON_TYPE_ONCE:
+            // last_run holds the creation time for one-shot entries.
+            return clamp_not_before((int64_t)entry->last_run +
+                                    (int64_t)entry->interval_minutes * SECONDS_PER_MINUTE, now);
+        case CRON_TYPE_DAILY:
+            if (!time_synced) {
+                return CRON_SCHED_NEVER;
+            }
+            return next_daily_fire(entry, now);
+        case CRON_TYPE_EXPR: {
+            if (!time_synced || !expr) {
+                return CRON_SCHED_NEVER;
+            }
+            // Next matching minute after the later of the last run and the
+            // start of the current minute, so a match in progress still fires.
+            int64_t after = now - (now % SECONDS_PER_MINUTE) - 1;
+            if ((int64_t)entry->last_run > after) {
+                after = (int64_t)entry->last_run;
+            }
+            int64_t due = cron_expr_next(expr, after);
+            return due == CRON_EXPR_NEVER ? CRON_SCHED_NEVER : clamp_not_before(due, now);
+        }
+        case CRON_TYPE_CONDITION:
+        default:
+            return CRON_SCHED_NEVER;
+    }
+}
+
+static bool node_before(const cron_sched_node_t *a, const cron_sched_node_t *b)
+{
+    if (a->due != b->due) {
+        return a->due < b->due;
+    }
+    return a->slot < b->slot;
+}
+
+static void swap_nodes(cron_sched_t *sched, size_t a, size_t b)
+{
+    cron_sched_node_t tmp = sched->nodes[a];
+    sched->nodes[a] = sched->nodes[b];
+    sched->nodes[b] = tmp;
+}
+
+static void sift_up(cron_sched_t *sched, size_t index)
+{
+    while (index > 0) {
+        size_t parent = (index - 1) / 2;
+        if (!node_before(&sched->nodes[index], &sched->nodes[parent])) {
+            break;
+        }
+        swap_nodes(sched, index, parent);
+        index = parent;
+    }
+}
+
+static void sift_down(cron_sched_t *sched, size_t index)
+{
+    for (;;) {
+        size_t left = index * 2 + 1;
+        size_t right = left + 1;
+        size_t smallest = index;
+
+        if (left < sched->count && node_before(&sched->nodes[left], &sched->nodes[smallest])) {
+            smallest = left;
+        }
+        if (right < sched->count && node_before(&sched->nodes[right], &sched->nodes[smallest])) {
+            smallest = right;
+        }
+        if (smallest == index) {
+            return;
+        }
+        swap_nodes(sched, index, smallest);
+        index = smallest;
+    }
+}
+
+void cron_sched_clear(cron_sched_t *sched)
+{
+    if (sched) {
+        memset(sched, 0, sizeof(*sched));
+    }
+}
+
+bool cron_sched_push(cron_sched_t *sched, uint8_t slot, int64_t due)
+{
+    if (!sched || sched->count >= CRON_MAX_ENTRIES || due == CRON_SCHED_NEVER) {
+        return false;
+    }
+
+    sched->nodes[sched->count].due = due;
+    sched->nodes[sched->count].slot = slot;
+    sched->count++;
+    sift_up(sched, sched->count - 1);
+    return true;
+}
+
+bool cron_sched_peek(const cron_sched_t *sched, cron_sched_node_t *out)
+{
+    if (!sched || sched->count == 0) {
+        return false;
+    }
+    if (out) {
+        *out = sched->nodes[0];
+    }
+    return true;
+}
+
+static void remove_at(cron_sched_t *sched, size_t index)
+{
+    sched->count--;
+    if (index == sched->count) {
+        return;
+    }
+    sched->nodes[index] = sched->nodes[sched->count];
+    sift_down(sched, index);
+    sift_up(sched, index);
+}
+
+bool cron_sched_pop(cron_sched_t *sched, cron_sched_node_t *out)
+{
+    if (!cron_sched_peek(sched, out)) {
+        return false;
+    }
+    remove_at(sched, 0);
+    return true;
+}
+
+bool cron_sched_remove(cron_sched_t *sched, uint8_t slot)
+{
+    if (!sched) {
+        return false;
+    }
+
+    for (size_t i = 0; i < sched->count; i++) {
+        if (sched->nodes[i].slot == slot) {
+            remove_at(sched, i);
+            return true;
+        }
+    }
+    return false;
+}
+
+void cron_sched_rebuild(cron_sched_t *sched, const cron_entry_t *entries,
+                        const cron_expr_t *exprs, size_t entry_count,
+                        int64_t now, bool time_synced)
+{
+    cron_sched_clear(sched);
+    if (!sched || !entries) {
+        return;
+    }
+
+    for (size_t i = 0; i < entry_count && i < CRON_MAX_ENTRIES; i++) {
+        int64_t due = cron_sched_next_fire(&entries[i], exprs ? &exprs[i] : NULL, now, time_synced);
+        if (due != CRON_SCHED_NEVER) {
+            cron_sched_push(sched, (uint8_t)i, due);
+        }
+    }
+}
+
+uint32_t cron_sched_wait_ms(const cron_sched_t *sched, int64_t now, uint32_t max_wait_ms)
+{
+    cron_sched_node_t next;
+
+    if (!cron_sched_peek(sched, &next)) {
+        return max_wait_ms;
+    }
+    if (next.due <= now) {
+        return 0;
+    }
+
+    int64_t wait_s = next.due - now;
+    if (wait_s >= (int64_t)(max_wait_ms / 1000)) {
+        return max_wait_ms;
+    }
+    return (uint32_t)(wait_s * 1000);
+}
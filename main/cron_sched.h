@@ -0,0 +1,47 @@
+#ifndef CRON_SCHED_H
+#define CRON_SCHED_H
+
+#include "cron.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Pure scheduling core for cron.c: next-fire computation plus a min-heap of
+// (due time, slot) pairs. No FreeRTOS or NVS dependencies so it can be
+// exercised on the host against a virtual clock.
+
+#define CRON_SCHED_NEVER INT64_MAX
+
+typedef struct {
+    int64_t due;    // Unix seconds
+    uint8_t slot;   // Index into the cron entry table
+} cron_sched_node_t;
+
+typedef struct {
+    cron_sched_node_t nodes[CRON_MAX_ENTRIES];
+    size_t count;
+} cron_sched_t;
+
+// Next fire time for entry at or after `now`, or CRON_SCHED_NEVER when the entry
+// is empty, disabled, event-driven, or wall-clock based without synced time.
+// Daily times are resolved with mktime() in the active TZ, so DST shifts apply.
+// `expr` holds the compiled masks for CRON_TYPE_EXPR entries and may be NULL otherwise.
+int64_t cron_sched_next_fire(const cron_entry_t *entry, const cron_expr_t *expr,
+                             int64_t now, bool time_synced);
+
+void cron_sched_clear(cron_sched_t *sched);
+bool cron_sched_push(cron_sched_t *sched, uint8_t slot, int64_t due);
+bool cron_sched_peek(const cron_sched_t *sched, cron_sched_node_t *out);
+bool cron_sched_pop(cron_sched_t *sched, cron_sched_node_t *out);
+bool cron_sched_remove(cron_sched_t *sched, uint8_t slot);
+
+// Clear and refill the heap from an entry table (entries that never fire are skipped).
+// `exprs` is parallel to `entries` and may be NULL when no expression entries exist.
+void cron_sched_rebuild(cron_sched_t *sched, const cron_entry_t *entries,
+                        const cron_expr_t *exprs, size_t entry_count,
+                        int64_t now, bool time_synced);
+
+// Milliseconds to sleep until the earliest deadline, clamped to max_wait_ms.
+uint32_t cron_sched_wait_ms(const cron_sched_t *sched, int64_t now, uint32_t max_wait_ms);
+
+#endif // CRON_SCHED_H
@@ -0,0 +1,333 @@
+#include "embed_index.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    char key[EMBED_KEY_LEN];
+    uint32_t value_hash;
+    float scale;
+    bool used;
+    bool marked;                    // Pending removal in a sweep
+} embed_entry_t;
+
+static embed_index_alloc_t s_alloc = { malloc, free };
+static embed_entry_t *s_entries = NULL;
+static int8_t *s_vectors = NULL;    // EMBED_INDEX_MAX_ENTRIES x EMBED_DIM, entry order
+static size_t s_count = 0;
+
+static bool key_fits(const char *key)
+{
+    return key && key[0] != '\0' && strlen(key) < EMBED_KEY_LEN;
+}
+
+static int find_entry(const char *key)
+{
+    if (!s_entries) {
+        return -1;
+    }
+    for (int i = 0; i < EMBED_INDEX_MAX_ENTRIES; i++) {
+        if (s_entries[i].used && strcmp(s_entries[i].key, key) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+bool embed_index_init(const embed_index_alloc_t *alloc)
+{
+    embed_index_deinit();
+    if (alloc && alloc->alloc && alloc->free) {
+        s_alloc = *alloc;
+    } else {
+        s_alloc.alloc = malloc;
+        s_alloc.free = free;
+    }
+
+    s_entries = s_alloc.alloc(sizeof(embed_entry_t) * EMBED_INDEX_MAX_ENTRIES);
+    s_vectors = s_alloc.alloc((size_t)EMBED_INDEX_MAX_ENTRIES * EMBED_DIM);
+    if (!s_entries || !s_vectors) {
+        embed_index_deinit();
+        return false;
+    }
+    memset(s_entries, 0, sizeof(embed_entry_t) * EMBED_INDEX_MAX_ENTRIES);
+    return true;
+}
+
+void embed_index_deinit(void)
+{
+    if (s_entries) {
+        s_alloc.free(s_entries);
+        s_entries = NULL;
+    }
+    if (s_vectors) {
+        s_alloc.free(s_vectors);
+        s_vectors = NULL;
+    }
+    s_count = 0;
+}
+
+size_t embed_index_count(void)
+{
+    return s_count;
+}
+
+void embed_quantize(const float *in, int8_t *out, float *scale)
+{
+    float norm_sq = 0.0f;
+    float max_abs = 0.0f;
+
+    for (size_t i = 0; i < EMBED_DIM; i++) {
+        norm_sq += in[i] * in[i];
+        float mag = in[i] < 0.0f ? -in[i] : in[i];
+        if (mag > max_abs) {
+            max_abs = mag;
+        }
+    }
+    if (norm_sq <= 0.0f || max_abs <= 0.0f) {
+        memset(out, 0, EMBED_DIM);
+        *scale = 0.0f;
+        return;
+    }
+
+    // q = x * 127 / max|x|; the unit vector is q * max|x| / (127 * |x|).
+    float to_int = 127.0f / max_abs;
+    for (size_t i = 0; i < EMBED_DIM; i++) {
+        float q = in[i] * to_int;
+        int v = (int)(q >= 0.0f ? q + 0.5f : q - 0.5f);
+        out[i] = (int8_t)(v > 127 ? 127 : (v < -127 ? -127 : v));
+    }
+    *scale = max_abs / (127.0f * sqrtf(norm_sq));
+}
+
+int32_t embed_dot_s8(const int8_t *a, const int8_t *b, size_t len)
+{
+    // Plain widening multiply-accumulate; simple enough for the compiler to
+    // vectorize where the target allows it.
+    int32_t acc = 0;
+    for (size_t i = 0; i < len; i++) {
+        acc += (int32_t)a[i] * b[i];
+    }
+    return acc;
+}
+
+uint32_t embed_hash(const char *text)
+{
+    uint32_t hash = 2166136261u;
+    for (const unsigned char *p = (const unsigned char *)text; p && *p; p++) {
+        hash ^= *p;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+bool embed_index_lookup(const char *key, uint32_t *value_hash)
+{
+    int slot = key_fits(key) ? find_entry(key) : -1;
+    if (slot < 0) {
+        return false;
+    }
+    if (value_hash) {
+        *value_hash = s_entries[slot].value_hash;
+    }
+    return true;
+}
+
+bool embed_index_put(const char *key, uint32_t value_hash, const int8_t *vec, float scale)
+{
+    if (!s_entries || !key_fits(key) || !vec) {
+        return false;
+    }
+
+    int slot = find_entry(key);
+    for (int i = 0; i < EMBED_INDEX_MAX_ENTRIES && slot < 0; i++) {
+        if (!s_entries[i].used) {
+            slot = i;
+            s_count++;
+        }
+    }
+    if (slot < 0) {
+        return false;
+    }
+
+    embed_entry_t *entry = &s_entries[slot];
+    snprintf(entry->key, sizeof(entry->key), "%s", key);
+    entry->value_hash = value_hash;
+    entry->scale = scale;
+    entry->used = true;
+    entry->marked = false;
+    memcpy(&s_vectors[(size_t)slot * EMBED_DIM], vec, EMBED_DIM);
+    return true;
+}
+
+bool embed_index_remove(const char *key)
+{
+    int slot = key_fits(key) ? find_entry(key) : -1;
+    if (slot < 0) {
+        return false;
+    }
+    memset(&s_entries[slot], 0, sizeof(embed_entry_t));
+    s_count--;
+    return true;
+}
+
+void embed_index_mark_all(void)
+{
+    for (int i = 0; s_entries && i < EMBED_INDEX_MAX_ENTRIES; i++) {
+        s_entries[i].marked = s_entries[i].used;
+    }
+}
+
+void embed_index_touch(const char *key)
+{
+    int slot = key_fits(key) ? find_entry(key) : -1;
+    if (slot >= 0) {
+        s_entries[slot].marked = false;
+    }
+}
+
+size_t embed_index_sweep(void (*removed)(const char *key, void *ctx), void *ctx)
+{
+    size_t dropped = 0;
+
+    for (int i = 0; s_entries && i < EMBED_INDEX_MAX_ENTRIES; i++) {
+        if (!s_entries[i].used || !s_entries[i].marked) {
+            continue;
+        }
+        if (removed) {
+            removed(s_entries[i].key, ctx);
+        }
+        memset(&s_entries[i], 0, sizeof(embed_entry_t));
+        s_count--;
+        dropped++;
+    }
+    return dropped;
+}
+
+size_t embed_index_search(const int8_t *query, float query_scale, float min_score,
+                          embed_match_t *out, size_t k)
+{
+    size_t found = 0;
+
+    if (!s_entries || !query || !out || k == 0 || query_scale <= 0.0f) {
+        return 0;
+    }
+
+    for (int i = 0; i < EMBED_INDEX_MAX_ENTRIES; i++) {
+        if (!s_entries[i].used) {
+            continue;
+        }
+        int32_t dot = embed_dot_s8(query, &s_vectors[(size_t)i * EMBED_DIM], EMBED_DIM);
+        float score = (float)dot * query_scale * s_entries[i].scale;
+        if (score < min_score || (found == k && score <= out[k - 1].score)) {
+            continue;
+        }
+
+        // Insertion into the sorted top-k list.
+        size_t pos = found < k ? found++ : k - 1;
+        while (pos > 0 && out[pos - 1].score < score) {
+            out[pos] = out[pos - 1];
+            pos--;
+        }
+        out[pos].key = s_entries[i].key;
+        out[pos].score = score;
+    }
+    return found;
+}
+
+static int hex_value(char c)
+{
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+static bool parse_hex_u32(const char **cursor, uint32_t *out)
+{
+    uint32_t value = 0;
+    const char *p = *cursor;
+
+    for (int i = 0; i < 8; i++) {
+        int nibble = hex_value(p[i]);
+        if (nibble < 0) {
+            return false;
+        }
+        value = (value << 4) | (uint32_t)nibble;
+    }
+    if (p[8] != ' ') {
+        return false;
+    }
+    *cursor = p + 9;
+    *out = value;
+    return true;
+}
+
+size_t embed_record_encode(const char *key, uint32_t value_hash, const int8_t *vec,
+                           float scale, char *out, size_t out_len)
+{
+    static const char digits[] = "0123456789abcdef";
+    uint32_t scale_bits;
+
+    if (!key_fits(key) || !vec || !out || out_len < EMBED_RECORD_MAX_LEN) {
+        return 0;
+    }
+
+    memcpy(&scale_bits, &scale, sizeof(scale_bits));
+    int len = snprintf(out, out_len, "v1 %08lx %08lx ", (unsigned long)value_hash,
+                       (unsigned long)scale_bits);
+    char *p = out + len;
+    for (size_t i = 0; i < EMBED_DIM; i++) {
+        uint8_t byte = (uint8_t)vec[i];
+        *p++ = digits[byte >> 4];
+        *p++ = digits[byte & 0x0F];
+    }
+    *p++ = ' ';
+    size_t key_len = strlen(key);
+    memcpy(p, key, key_len + 1);
+    return (size_t)(p - out) + key_len;
+}
+
+bool embed_record_decode(const char *record, char *key, size_t key_len,
+                         uint32_t *value_hash, int8_t *vec, float *scale)
+{
+    uint32_t hash;
+    uint32_t scale_bits;
+    const char *p = record;
+
+    if (!record || !key || !vec || strncmp(p, "v1 ", 3) != 0) {
+        return false;
+    }
+    p += 3;
+    if (!parse_hex_u32(&p, &hash) || !parse_hex_u32(&p, &scale_bits)) {
+        return false;
+    }
+    for (size_t i = 0; i < EMBED_DIM; i++) {
+        int hi = hex_value(p[0]);
+        int lo = hi < 0 ? -1 : hex_value(p[1]);
+        if (lo < 0) {
+            return false;
+        }
+        vec[i] = (int8_t)(uint8_t)((hi << 4) | lo);
+        p += 2;
+    }
+    if (*p++ != ' ' || !key_fits(p) || strlen(p) >= key_len) {
+        return false;
+    }
+
+    memcpy(key, p, strlen(p) + 1);
+    if (value_hash) {
+        *value_hash = hash;
+    }
+    if (scale) {
+        memcpy(scale, &scale_bits, sizeof(*scale));
+    }
+    return true;
+}
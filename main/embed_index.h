@@ -0,0 +1,68 @@
+#ifndef EMBED_INDEX_H
+#define EMBED_INDEX_H
+
+#include "config.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// In-RAM vector index over user memories for prompt-time recall.
+//
+// Embeddings are L2-normalized and quantized to int8 with one scale per
+// vector, so cosine similarity is an integer dot product times two scales.
+// Each entry remembers a hash of the value it was embedded from; recall.c
+// compares it against the current value to find stale vectors.
+//
+// Entries also round-trip through a compact text record so recall.c can keep
+// them on flash and skip re-embedding after a reboot.
+//
+// Not thread-safe: recall.c only touches it from the agent task.
+
+#define EMBED_KEY_LEN           65      // zc_store user key (64 chars) + terminator
+#define EMBED_RECORD_MAX_LEN    (3 + 9 + 9 + EMBED_DIM * 2 + 1 + EMBED_KEY_LEN)
+
+typedef struct {
+    void *(*alloc)(size_t size);        // Vector storage (PSRAM when available)
+    void (*free)(void *ptr);
+} embed_index_alloc_t;
+
+typedef struct {
+    const char *key;                    // Valid until the index is next modified
+    float score;                        // Approximate cosine similarity
+} embed_match_t;
+
+// Allocate storage for EMBED_INDEX_MAX_ENTRIES vectors. alloc may be NULL
+// for malloc/free. Returns false when out of memory.
+bool embed_index_init(const embed_index_alloc_t *alloc);
+void embed_index_deinit(void);
+size_t embed_index_count(void);
+
+// Normalize in (EMBED_DIM floats) and quantize it to out. scale maps int8
+// back to the unit vector. A zero vector yields scale 0.
+void embed_quantize(const float *in, int8_t *out, float *scale);
+int32_t embed_dot_s8(const int8_t *a, const int8_t *b, size_t len);
+uint32_t embed_hash(const char *text);
+
+// Returns true and the stored value hash when key is indexed.
+bool embed_index_lookup(const char *key, uint32_t *value_hash);
+// Insert or replace key's vector. Fails when the index is full.
+bool embed_index_put(const char *key, uint32_t value_hash, const int8_t *vec, float scale);
+bool embed_index_remove(const char *key);
+
+// Sweep keys that no longer exist: mark all, touch the live ones (put also
+// touches), then sweep calls removed (may be NULL) for each dropped key.
+void embed_index_mark_all(void);
+void embed_index_touch(const char *key);
+size_t embed_index_sweep(void (*removed)(const char *key, void *ctx), void *ctx);
+
+// Top-k entries by similarity to query, best first, at or above min_score.
+size_t embed_index_search(const int8_t *query, float query_scale, float min_score,
+                          embed_match_t *out, size_t k);
+
+// Flash record: "v1 <hash> <scale bits> <hex vector> <key>".
+size_t embed_record_encode(const char *key, uint32_t value_hash, const int8_t *vec,
+                           float scale, char *out, size_t out_len);
+bool embed_record_decode(const char *record, char *key, size_t key_len,
+                         uint32_t *value_hash, int8_t *vec, float *scale);
+
+#endif // EMBED_INDEX_H
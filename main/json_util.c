@@ -41,6 +41,60 @@ static bool history_has_prior_tool_use(
     return false;
 }
 
+// Whether history[index] is the newest entry, a plain user message, and a
+// photo taken for it (MEDIA_USER_IMAGE_ID) is waiting to be sent.
+static bool user_message_has_image(const conversation_msg_t *history, int index, int history_len)
+{
+    const char *img_tool_id = NULL;
+
+    return index == history_len - 1 &&
+           !history[index].is_tool_use && !history[index].is_tool_result &&
+           strcmp(history[index].role, "user") == 0 &&
+           media_get_pending_image(NULL, NULL, &img_tool_id) &&
+           strcmp(img_tool_id, MEDIA_USER_IMAGE_ID) == 0;
+}
+
+// Content array holding the pending image, then text. The image data is a
+// slot that is base64-encoded while the body is sent.
+static cJSON *create_image_content(bool openai, const char *text)
+{
+    cJSON *content = cJSON_CreateArray();
+    cJSON *img_block = cJSON_CreateObject();
+    cJSON *text_block = cJSON_CreateObject();
+    cJSON *source = cJSON_CreateObject();
+
+    if (!content || !img_block || !text_block || !source ||
+        !cJSON_AddStringToObject(text_block, "type", "text") ||
+        !cJSON_AddStringToObject(text_block, "text", text)) {
+        goto fail;
+    }
+    if (openai) {
+        if (!cJSON_AddStringToObject(img_block, "type", "image_url") ||
+            !cJSON_AddRawToObject(source, "url", "\"data:image/jpeg;base64," MEDIA_IMAGE_SLOT "\"")) {
+            goto fail;
+        }
+        cJSON_AddItemToObject(img_block, "image_url", source);
+    } else {
+        if (!cJSON_AddStringToObject(img_block, "type", "image") ||
+            !cJSON_AddStringToObject(source, "type", "base64") ||
+            !cJSON_AddStringToObject(source, "media_type", "image/jpeg") ||
+            !cJSON_AddRawToObject(source, "data", "\"" MEDIA_IMAGE_SLOT "\"")) {
+            goto fail;
+        }
+        cJSON_AddItemToObject(img_block, "source", source);
+    }
+    cJSON_AddItemToArray(content, img_block);
+    cJSON_AddItemToArray(content, text_block);
+    return content;
+
+fail:
+    cJSON_Delete(source);
+    cJSON_Delete(text_block);
+    cJSON_Delete(img_block);
+    cJSON_Delete(content);
+    return NULL;
+}
+
 // -----------------------------------------------------------------------------
 // Anthropic Format (Claude API)
 // -----------------------------------------------------------------------------
@@ -119,54 +173,18 @@ static char *build_anthropic_request(
             }
 
             // Check for pending image attached to this tool result
-            const char *img_b64 = NULL;
             const char *img_tool_id = NULL;
             if (media_has_pending_image() &&
-                media_get_pending_image(&img_b64, NULL, &img_tool_id) &&
+                media_get_pending_image(NULL, NULL, &img_tool_id) &&
                 strcmp(history[i].tool_id, img_tool_id) == 0) {
                 // Multi-content tool_result: image + text
-                cJSON *tr_content = cJSON_AddArrayToObject(tool_result, "content");
+                cJSON *tr_content = create_image_content(false, history[i].content);
                 if (!tr_content) {
                     cJSON_Delete(tool_result);
                     cJSON_Delete(msg);
                     goto fail;
                 }
-                // Image block
-                cJSON *img_block = cJSON_CreateObject();
-                cJSON *source = cJSON_CreateObject();
-                if (!img_block || !source ||
-                    !cJSON_AddStringToObject(img_block, "type", "image") ||
-                    !cJSON_AddStringToObject(source, "type", "base64") ||
-                    !cJSON_AddStringToObject(source, "media_type", "image/jpeg")) {
-                    cJSON_Delete(source);
-                    cJSON_Delete(img_block);
-                    cJSON_Delete(tool_result);
-                    cJSON_Delete(msg);
-                    goto fail;
-                }
-                // Use string reference to avoid copying large base64 data
-                cJSON *data_ref = cJSON_CreateStringReference(img_b64);
-                if (!data_ref) {
-                    cJSON_Delete(source);
-                    cJSON_Delete(img_block);
-                    cJSON_Delete(tool_result);
-                    cJSON_Delete(msg);
-                    goto fail;
-                }
-                cJSON_AddItemToObject(source, "data", data_ref);
-                cJSON_AddItemToObject(img_block, "source", source);
-                cJSON_AddItemToArray(tr_content, img_block);
-                // Text block
-                cJSON *text_block = cJSON_CreateObject();
-                if (!text_block ||
-                    !cJSON_AddStringToObject(text_block, "type", "text") ||
-                    !cJSON_AddStringToObject(text_block, "text", history[i].content)) {
-                    cJSON_Delete(text_block);
-                    cJSON_Delete(tool_result);
-                    cJSON_Delete(msg);
-                    goto fail;
-                }
-                cJSON_AddItemToArray(tr_content, text_block);
+                cJSON_AddItemToObject(tool_result, "content", tr_content);
             } else {
                 // Normal text-only tool_result
                 if (!cJSON_AddStringToObject(tool_result, "content", history[i].content)) {
@@ -177,6 +195,13 @@ static char *build_anthropic_request(
             }
 
             cJSON_AddItemToArray(content, tool_result);
+        } else if (user_message_has_image(history, i, history_len)) {
+            cJSON *content = create_image_content(false, history[i].content);
+            if (!content) {
+                cJSON_Delete(msg);
+                goto fail;
+            }
+            cJSON_AddItemToObject(msg, "content", content);
         } else if (!cJSON_AddStringToObject(msg, "content", history[i].content)) {
             cJSON_Delete(msg);
             goto fail;
@@ -404,10 +429,9 @@ static char *build_openai_request(
             cJSON_AddItemToArray(messages, msg);
 
             // If there's a pending image for this tool, add a vision user message
-            const char *img_b64 = NULL;
             const char *img_tool_id = NULL;
             if (media_has_pending_image() &&
-                media_get_pending_image(&img_b64, NULL, &img_tool_id) &&
+                media_get_pending_image(NULL, NULL, &img_tool_id) &&
                 strcmp(history[i].tool_id, img_tool_id) == 0) {
                 cJSON *vision_msg = cJSON_CreateObject();
                 if (!vision_msg ||
@@ -415,49 +439,26 @@ static char *build_openai_request(
                     cJSON_Delete(vision_msg);
                     goto fail;
                 }
-                cJSON *v_content = cJSON_AddArrayToObject(vision_msg, "content");
+                cJSON *v_content = create_image_content(true,
+                    "This is the photo from the capture_photo tool. Describe what you see.");
                 if (!v_content) {
                     cJSON_Delete(vision_msg);
                     goto fail;
                 }
-                // Build data URL with string reference for base64 payload
-                size_t url_len = strlen("data:image/jpeg;base64,") + strlen(img_b64) + 1;
-                char *data_url = malloc(url_len);
-                if (!data_url) {
-                    cJSON_Delete(vision_msg);
-                    goto fail;
-                }
-                snprintf(data_url, url_len, "data:image/jpeg;base64,%s", img_b64);
-
-                cJSON *img_block = cJSON_CreateObject();
-                cJSON *img_url_obj = cJSON_CreateObject();
-                if (!img_block || !img_url_obj ||
-                    !cJSON_AddStringToObject(img_block, "type", "image_url") ||
-                    !cJSON_AddStringToObject(img_url_obj, "url", data_url)) {
-                    free(data_url);
-                    cJSON_Delete(img_url_obj);
-                    cJSON_Delete(img_block);
-                    cJSON_Delete(vision_msg);
-                    goto fail;
-                }
-                free(data_url);
-                cJSON_AddItemToObject(img_block, "image_url", img_url_obj);
-                cJSON_AddItemToArray(v_content, img_block);
-
-                cJSON *text_block = cJSON_CreateObject();
-                if (!text_block ||
-                    !cJSON_AddStringToObject(text_block, "type", "text") ||
-                    !cJSON_AddStringToObject(text_block, "text",
-                        "This is the photo from the capture_photo tool. Describe what you see.")) {
-                    cJSON_Delete(text_block);
-                    cJSON_Delete(vision_msg);
-                    goto fail;
-                }
-                cJSON_AddItemToArray(v_content, text_block);
+                cJSON_AddItemToObject(vision_msg, "content", v_content);
                 cJSON_AddItemToArray(messages, vision_msg);
             }
             // Skip the normal cJSON_AddItemToArray below since we already added msg
             continue;
+        } else if (user_message_has_image(history, i, history_len)) {
+            // User message with the photo taken for it
+            cJSON *content = create_image_content(true, history[i].content);
+            if (!content || !cJSON_AddStringToObject(msg, "role", history[i].role)) {
+                cJSON_Delete(content);
+                cJSON_Delete(msg);
+                goto fail;
+            }
+            cJSON_AddItemToObject(msg, "content", content);
         } else {
             // Regular message
             if (!cJSON_AddStringToObject(msg, "role", history[i].role) ||
@@ -699,6 +700,47 @@ bool json_parse_response(
     }
 }
 
+static uint32_t usage_field(const cJSON *usage, const char *name)
+{
+    const cJSON *item = cJSON_GetObjectItem(usage, name);
+    if (!item || !cJSON_IsNumber(item) || item->valuedouble <= 0) {
+        return 0;
+    }
+    return item->valuedouble >= 4294967295.0 ? UINT32_MAX : (uint32_t)item->valuedouble;
+}
+
+bool json_get_parsed_usage(uint32_t *input_tokens, uint32_t *output_tokens)
+{
+    cJSON *usage = s_parsed_response ? cJSON_GetObjectItem(s_parsed_response, "usage") : NULL;
+    if (!usage || !cJSON_IsObject(usage)) {
+        return false;
+    }
+
+    uint32_t in;
+    uint32_t out;
+    if (cJSON_GetObjectItem(usage, "input_tokens")) {
+        // Anthropic reports prompt-cache traffic separately from input_tokens.
+        uint64_t total = (uint64_t)usage_field(usage, "input_tokens") +
+                         usage_field(usage, "cache_creation_input_tokens") +
+                         usage_field(usage, "cache_read_input_tokens");
+        in = total > UINT32_MAX ? UINT32_MAX : (uint32_t)total;
+        out = usage_field(usage, "output_tokens");
+    } else if (cJSON_GetObjectItem(usage, "prompt_tokens")) {
+        in = usage_field(usage, "prompt_tokens");
+        out = usage_field(usage, "completion_tokens");
+    } else {
+        return false;
+    }
+
+    if (input_tokens) {
+        *input_tokens = in;
+    }
+    if (output_tokens) {
+        *output_tokens = out;
+    }
+    return true;
+}
+
 void json_free_parsed_response(void)
 {
     if (s_parsed_response) {
@@ -706,3 +748,160 @@ void json_free_parsed_response(void)
         s_parsed_response = NULL;
     }
 }
+
+// -----------------------------------------------------------------------------
+// Embeddings
+// -----------------------------------------------------------------------------
+
+char *json_build_embeddings_request(const char *model, const char *const *inputs, int count)
+{
+    if (!model || !inputs || count <= 0) {
+        return NULL;
+    }
+
+    cJSON *root = cJSON_CreateObject();
+    if (!root) {
+        return NULL;
+    }
+    cJSON *input = cJSON_AddArrayToObject(root, "input");
+    bool ok = cJSON_AddStringToObject(root, "model", model) &&
+              cJSON_AddNumberToObject(root, "dimensions", EMBED_DIM) &&
+              cJSON_AddStringToObject(root, "encoding_format", "base64") &&
+              input;
+    for (int i = 0; ok && i < count; i++) {
+        cJSON *item = cJSON_CreateString(inputs[i] ? inputs[i] : "");
+        ok = item != NULL;
+        if (ok) {
+            cJSON_AddItemToArray(input, item);
+        }
+    }
+
+    char *json_str = ok ? cJSON_PrintUnformatted(root) : NULL;
+    cJSON_Delete(root);
+    return json_str;
+}
+
+static int base64_value(char c)
+{
+    if (c >= 'A' && c <= 'Z') {
+        return c - 'A';
+    }
+    if (c >= 'a' && c <= 'z') {
+        return c - 'a' + 26;
+    }
+    if (c >= '0' && c <= '9') {
+        return c - '0' + 52;
+    }
+    if (c == '+') {
+        return 62;
+    }
+    if (c == '/') {
+        return 63;
+    }
+    return -1;
+}
+
+// Little-endian float32 vector from base64; must hold exactly EMBED_DIM floats.
+static bool decode_base64_floats(const char *b64, float *out)
+{
+    uint8_t bytes[4];
+    size_t byte_count = 0;
+    size_t index = 0;
+    uint32_t bits = 0;
+    int bit_count = 0;
+
+    for (const char *p = b64; *p && *p != '='; p++) {
+        int v = base64_value(*p);
+        if (v < 0) {
+            return false;
+        }
+        bits = (bits << 6) | (uint32_t)v;
+        bit_count += 6;
+        if (bit_count < 8) {
+            continue;
+        }
+        bit_count -= 8;
+        bytes[byte_count++] = (uint8_t)(bits >> bit_count);
+        if (byte_count == sizeof(bytes)) {
+            if (index >= EMBED_DIM) {
+                return false;
+            }
+            uint32_t word = (uint32_t)bytes[0] | ((uint32_t)bytes[1] << 8) |
+                            ((uint32_t)bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+            memcpy(&out[index++], &word, sizeof(word));
+            byte_count = 0;
+        }
+    }
+    return index == EMBED_DIM && byte_count == 0;
+}
+
+static bool decode_number_floats(const cJSON *array, float *out)
+{
+    if (cJSON_GetArraySize(array) != EMBED_DIM) {
+        return false;
+    }
+    int i = 0;
+    const cJSON *item = NULL;
+    cJSON_ArrayForEach(item, array) {
+        if (!cJSON_IsNumber(item)) {
+            return false;
+        }
+        out[i++] = (float)item->valuedouble;
+    }
+    return true;
+}
+
+int json_parse_embeddings(const char *response_json, float *out, int max_count,
+                          uint32_t *prompt_tokens)
+{
+    if (prompt_tokens) {
+        *prompt_tokens = 0;
+    }
+    if (!response_json || !out || max_count <= 0) {
+        return -1;
+    }
+
+    cJSON *root = cJSON_Parse(response_json);
+    if (!root) {
+        ESP_LOGE(TAG, "Failed to parse embeddings JSON");
+        return -1;
+    }
+
+    cJSON *usage = cJSON_GetObjectItem(root, "usage");
+    if (prompt_tokens && usage && cJSON_IsObject(usage)) {
+        *prompt_tokens = usage_field(usage, "prompt_tokens");
+    }
+
+    int decoded = -1;
+    cJSON *data = cJSON_GetObjectItem(root, "data");
+    if (cJSON_GetObjectItem(root, "error")) {
+        ESP_LOGW(TAG, "Embeddings API returned an error");
+    } else if (data && cJSON_IsArray(data)) {
+        decoded = 0;
+        int position = 0;
+        const cJSON *entry = NULL;
+        cJSON_ArrayForEach(entry, data) {
+            cJSON *index = cJSON_GetObjectItem(entry, "index");
+            cJSON *embedding = cJSON_GetObjectItem(entry, "embedding");
+            int slot = cJSON_IsNumber(index) ? index->valueint : position;
+            position++;
+            if (slot < 0 || slot >= max_count || !embedding) {
+                decoded = -1;
+                break;
+            }
+            float *vec = &out[(size_t)slot * EMBED_DIM];
+            bool ok = cJSON_IsString(embedding) ? decode_base64_floats(embedding->valuestring, vec)
+                      : cJSON_IsArray(embedding) ? decode_number_floats(embedding, vec)
+                      : false;
+            if (!ok) {
+                ESP_LOGW(TAG, "Embedding %d has unexpected shape", slot);
+                decoded = -1;
+                break;
+            }
+            decoded++;
+        }
+    }
+
+    cJSON_Delete(root);
+    return decoded;
+}
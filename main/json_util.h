@@ -4,6 +4,7 @@
 #include "config.h"
 #include "cJSON.h"
 #include <stdbool.h>
+#include <stdint.h>
 
 // Forward declaration
 struct tool_def;
@@ -44,7 +45,24 @@ bool json_parse_response(
     cJSON **tool_input_out  // Caller must NOT free - points into parsed tree
 );
 
+// Token usage reported by the last parsed response (Anthropic input/output
+// tokens including prompt-cache reads and writes, or OpenAI prompt/completion
+// tokens). Returns false when the response carried no usage.
+bool json_get_parsed_usage(uint32_t *input_tokens, uint32_t *output_tokens);
+
 // Free the parsed response (call after done with tool_input)
 void json_free_parsed_response(void);
 
+// Build an OpenAI-style embeddings request for count inputs at EMBED_DIM
+// dimensions, asking for base64 float32 vectors to keep the response small.
+// Returns allocated string (caller must free) or NULL on error
+char *json_build_embeddings_request(const char *model, const char *const *inputs, int count);
+
+// Decode an embeddings response into out (max_count x EMBED_DIM floats, in
+// input order). Accepts base64 or numeric-array vectors. prompt_tokens, if
+// not NULL, gets the reported usage.prompt_tokens (0 when absent).
+// Returns the number of vectors decoded, or -1 on malformed/error responses
+int json_parse_embeddings(const char *response_json, float *out, int max_count,
+                          uint32_t *prompt_tokens);
+
 #endif // JSON_UTIL_H
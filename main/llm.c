@@ -5,6 +5,8 @@
 #include "memory.h"
 #include "nvs_keys.h"
 #include "text_buffer.h"
+#include "tools_media.h"
+#include "transcribe_util.h"
 #include "esp_http_client.h"
 #include "esp_log.h"
 #include "esp_tls.h"
@@ -54,6 +56,162 @@ static esp_err_t http_event_handler(esp_http_client_event_t *evt)
     }
     return ESP_OK;
 }
+
+static bool write_body(const char *data, size_t len, void *ctx)
+{
+    esp_http_client_handle_t client = (esp_http_client_handle_t)ctx;
+
+    while (len > 0) {
+        int written = esp_http_client_write(client, data, (int)len);
+        if (written <= 0) {
+            return false;
+        }
+        data += written;
+        len -= (size_t)written;
+    }
+    return true;
+}
+
+// Wraps each piece of a chunked body in its chunk framing.
+static bool write_chunk(const char *data, size_t len, void *ctx)
+{
+    char size_line[16];
+
+    if (len == 0) {
+        return true;    // An empty chunk would end the body
+    }
+    snprintf(size_line, sizeof(size_line), "%x\r\n", (unsigned)len);
+    return write_body(size_line, strlen(size_line), ctx) && write_body(data, len, ctx) &&
+           write_body("\r\n", 2, ctx);
+}
+
+// POST body_len bytes (or LLM_BODY_CHUNKED) produced by body() to url with
+// the backend's auth headers. The body is written straight to the
+// connection as it is produced.
+static esp_err_t http_post(const char *url, const char *content_type, size_t body_len,
+                           llm_body_fn body, void *body_ctx,
+                           char *response_buf, size_t response_buf_size)
+{
+    if (s_api_key[0] == '\0') {
+        ESP_LOGE(TAG, "No API key configured");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    // Thread-safe response context
+    http_response_ctx_t ctx = {
+        .buf = response_buf,
+        .len = 0,
+        .max = response_buf_size,
+        .truncated = false
+    };
+    response_buf[0] = '\0';
+
+    esp_http_client_config_t config = {
+        .url = url,
+        .event_handler = http_event_handler,
+        .user_data = &ctx,
+        .timeout_ms = HTTP_TIMEOUT_MS,
+        .crt_bundle_attach = esp_crt_bundle_attach,
+    };
+
+    esp_http_client_handle_t client = esp_http_client_init(&config);
+    if (!client) {
+        ESP_LOGE(TAG, "Failed to init HTTP client");
+        return ESP_FAIL;
+    }
+
+    // Set common headers
+    esp_http_client_set_method(client, HTTP_METHOD_POST);
+    esp_http_client_set_header(client, "Content-Type", content_type);
+
+    // Set backend-specific headers
+    if (s_backend == LLM_BACKEND_ANTHROPIC) {
+        esp_http_client_set_header(client, "x-api-key", s_api_key);
+        esp_http_client_set_header(client, "anthropic-version", "2023-06-01");
+    } else {
+        // OpenAI and OpenRouter use Bearer token
+        char auth_header[LLM_AUTH_HEADER_BUF_SIZE];
+        if (!llm_build_bearer_auth_header(s_api_key, auth_header, sizeof(auth_header))) {
+            ESP_LOGE(TAG, "API key length exceeds supported authorization header capacity");
+            esp_http_client_cleanup(client);
+            return ESP_ERR_INVALID_SIZE;
+        }
+        esp_http_client_set_header(client, "Authorization", auth_header);
+
+        // OpenRouter needs additional headers
+        if (s_backend == LLM_BACKEND_OPENROUTER) {
+            esp_http_client_set_header(client, "HTTP-Referer", "https://github.com/tnm/zclaw");
+            esp_http_client_set_header(client, "X-Title", "zclaw");
+        }
+    }
+
+    const char *backend_names[] = {"Anthropic", "OpenAI", "OpenRouter"};
+    bool chunked = body_len == LLM_BODY_CHUNKED;
+    if (chunked) {
+        ESP_LOGI(TAG, "Sending request to %s (chunked)...", backend_names[s_backend]);
+    } else {
+        ESP_LOGI(TAG, "Sending request to %s (%u bytes)...", backend_names[s_backend],
+                 (unsigned)body_len);
+    }
+
+    // A negative length makes the client send Transfer-Encoding: chunked;
+    // the chunk framing is ours to write.
+    esp_err_t err = esp_http_client_open(client, chunked ? -1 : (int)body_len);
+    if (err == ESP_OK && !body(chunked ? write_chunk : write_body, client, body_ctx)) {
+        ESP_LOGE(TAG, "Failed to write request body");
+        err = ESP_FAIL;
+    }
+    if (err == ESP_OK && chunked && !write_body("0\r\n\r\n", 5, client)) {
+        err = ESP_FAIL;
+    }
+    if (err == ESP_OK && esp_http_client_fetch_headers(client) < 0) {
+        err = ESP_FAIL;
+    }
+    if (err == ESP_OK) {
+        // The event handler collects the body as it is read; drain it here.
+        char discard[256];
+        int read_len;
+        while ((read_len = esp_http_client_read(client, discard, sizeof(discard))) > 0) {
+        }
+        if (read_len < 0) {
+            err = ESP_FAIL;
+        }
+    }
+
+    if (err == ESP_OK) {
+        int status = esp_http_client_get_status_code(client);
+        ESP_LOGI(TAG, "Response: %d, %d bytes", status, (int)ctx.len);
+
+        if (status != 200) {
+            ESP_LOGE(TAG, "API error: %s", response_buf);
+            err = ESP_FAIL;
+        } else if (ctx.truncated) {
+            ESP_LOGE(TAG, "LLM response truncated");
+            err = ESP_ERR_NO_MEM;
+        }
+    } else {
+        ESP_LOGE(TAG, "HTTP request failed: %s", esp_err_to_name(err));
+    }
+
+    esp_http_client_close(client);
+    esp_http_client_cleanup(client);
+
+    return err;
+}
+
+static bool json_body(media_body_write_fn write, void *write_ctx, void *ctx)
+{
+    return media_write_request_body((const char *)ctx, write, write_ctx);
+}
+
+// JSON requests carry the pending camera image (if any) base64-encoded into
+// its slot on the fly, so a photo request never holds an encoded copy.
+static esp_err_t http_post_json(const char *url, const char *request_json,
+                                char *response_buf, size_t response_buf_size)
+{
+    return http_post(url, "application/json", media_request_body_len(request_json),
+                     json_body, (void *)request_json, response_buf, response_buf_size);
+}
 #endif
 
 esp_err_t llm_init(void)
@@ -218,84 +376,68 @@ esp_err_t llm_request(const char *request_json, char *response_buf, size_t respo
     ESP_LOGI(TAG, "Stub response: %d bytes", (int)strlen(response_buf));
     return ESP_OK;
 #else
-    if (s_api_key[0] == '\0') {
-        ESP_LOGE(TAG, "No API key configured");
-        return ESP_ERR_INVALID_STATE;
-    }
-
-    // Thread-safe response context
-    http_response_ctx_t ctx = {
-        .buf = response_buf,
-        .len = 0,
-        .max = response_buf_size,
-        .truncated = false
-    };
-    response_buf[0] = '\0';
-
-    esp_http_client_config_t config = {
-        .url = llm_get_api_url(),
-        .event_handler = http_event_handler,
-        .user_data = &ctx,
-        .timeout_ms = HTTP_TIMEOUT_MS,
-        .crt_bundle_attach = esp_crt_bundle_attach,
-    };
+    return http_post_json(llm_get_api_url(), request_json, response_buf, response_buf_size);
+#endif
+}
 
-    esp_http_client_handle_t client = esp_http_client_init(&config);
-    if (!client) {
-        ESP_LOGE(TAG, "Failed to init HTTP client");
-        return ESP_FAIL;
-    }
 
-    // Set common headers
-    esp_http_client_set_method(client, HTTP_METHOD_POST);
-    esp_http_client_set_header(client, "Content-Type", "application/json");
+bool llm_has_embeddings(void)
+{
+#if CONFIG_ZCLAW_EMULATOR_LIVE_LLM || defined(CONFIG_ZCLAW_STUB_LLM)
+    return false;
+#else
+    return llm_is_openai_format();
+#endif
+}
 
-    // Set backend-specific headers
-    if (s_backend == LLM_BACKEND_ANTHROPIC) {
-        esp_http_client_set_header(client, "x-api-key", s_api_key);
-        esp_http_client_set_header(client, "anthropic-version", "2023-06-01");
-    } else {
-        // OpenAI and OpenRouter use Bearer token
-        char auth_header[LLM_AUTH_HEADER_BUF_SIZE];
-        if (!llm_build_bearer_auth_header(s_api_key, auth_header, sizeof(auth_header))) {
-            ESP_LOGE(TAG, "API key length exceeds supported authorization header capacity");
-            esp_http_client_cleanup(client);
-            return ESP_ERR_INVALID_SIZE;
-        }
-        esp_http_client_set_header(client, "Authorization", auth_header);
+const char *llm_get_embed_model(void)
+{
+    return s_backend == LLM_BACKEND_OPENROUTER ? LLM_EMBED_MODEL_OPENROUTER
+                                               : LLM_EMBED_MODEL_OPENAI;
+}
 
-        // OpenRouter needs additional headers
-        if (s_backend == LLM_BACKEND_OPENROUTER) {
-            esp_http_client_set_header(client, "HTTP-Referer", "https://github.com/tnm/zclaw");
-            esp_http_client_set_header(client, "X-Title", "zclaw");
-        }
+esp_err_t llm_embed_request(const char *request_json, char *response_buf, size_t response_buf_size)
+{
+#if CONFIG_ZCLAW_EMULATOR_LIVE_LLM || defined(CONFIG_ZCLAW_STUB_LLM)
+    (void)request_json;
+    (void)response_buf;
+    (void)response_buf_size;
+    return ESP_ERR_NOT_SUPPORTED;
+#else
+    if (!llm_has_embeddings()) {
+        return ESP_ERR_NOT_SUPPORTED;
     }
+    const char *url = s_backend == LLM_BACKEND_OPENROUTER ? LLM_EMBED_URL_OPENROUTER
+                                                          : LLM_EMBED_URL_OPENAI;
+    return http_post_json(url, request_json, response_buf, response_buf_size);
+#endif
+}
 
-    // Set body
-    esp_http_client_set_post_field(client, request_json, strlen(request_json));
-
-    const char *backend_names[] = {"Anthropic", "OpenAI", "OpenRouter"};
-    ESP_LOGI(TAG, "Sending request to %s...", backend_names[s_backend]);
-
-    esp_err_t err = esp_http_client_perform(client);
-
-    if (err == ESP_OK) {
-        int status = esp_http_client_get_status_code(client);
-        ESP_LOGI(TAG, "Response: %d, %d bytes", status, (int)ctx.len);
+bool llm_has_transcription(void)
+{
+#if CONFIG_ZCLAW_EMULATOR_LIVE_LLM || defined(CONFIG_ZCLAW_STUB_LLM)
+    return false;
+#else
+    return s_backend == LLM_BACKEND_OPENAI ||
+           strcmp(LLM_TRANSCRIBE_URL, LLM_TRANSCRIBE_URL_OPENAI) != 0;
+#endif
+}
 
-        if (status != 200) {
-            ESP_LOGE(TAG, "API error: %s", response_buf);
-            err = ESP_FAIL;
-        } else if (ctx.truncated) {
-            ESP_LOGE(TAG, "LLM response truncated");
-            err = ESP_ERR_NO_MEM;
-        }
-    } else {
-        ESP_LOGE(TAG, "HTTP request failed: %s", esp_err_to_name(err));
+esp_err_t llm_transcribe_request(size_t body_len, llm_body_fn body, void *body_ctx,
+                                 char *response_buf, size_t response_buf_size)
+{
+#if CONFIG_ZCLAW_EMULATOR_LIVE_LLM || defined(CONFIG_ZCLAW_STUB_LLM)
+    (void)body_len;
+    (void)body;
+    (void)body_ctx;
+    (void)response_buf;
+    (void)response_buf_size;
+    return ESP_ERR_NOT_SUPPORTED;
+#else
+    if (!llm_has_transcription()) {
+        return ESP_ERR_NOT_SUPPORTED;
     }
-
-    esp_http_client_cleanup(client);
-
-    return err;
+    return http_post(LLM_TRANSCRIBE_URL, TRANSCRIBE_CONTENT_TYPE, body_len, body, body_ctx,
+                     response_buf, response_buf_size);
 #endif
 }
@@ -3,7 +3,10 @@
 
 #include "config.h"
 #include "esp_err.h"
+#include "tools_media.h"
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 
 // Initialize the LLM HTTP client
 esp_err_t llm_init(void);
@@ -33,4 +36,33 @@ const char *llm_get_model(void);
 // Check if backend uses OpenAI-compatible format (OpenAI, OpenRouter)
 bool llm_is_openai_format(void);
 
+// Whether the current backend serves an embeddings endpoint (OpenAI,
+// OpenRouter). Anthropic has none; stub and emulator bridge builds neither.
+bool llm_has_embeddings(void);
+
+// Embedding model for the current backend
+const char *llm_get_embed_model(void);
+
+// Send an embeddings request body (see json_build_embeddings_request).
+// Same buffer contract as llm_request.
+esp_err_t llm_embed_request(const char *request_json, char *response_buf, size_t response_buf_size);
+
+// Produces a request body by calling write(data, len, write_ctx) as many
+// times as needed. Returns false to abort the request.
+typedef bool (*llm_body_fn)(media_body_write_fn write, void *write_ctx, void *ctx);
+
+// Body length for a body whose size is not known up front; it is sent with
+// chunked transfer encoding.
+#define LLM_BODY_CHUNKED    SIZE_MAX
+
+// Whether record_audio can be transcribed: the OpenAI backend, or any
+// backend when LLM_TRANSCRIBE_URL points somewhere else (a local stand-in).
+bool llm_has_transcription(void);
+
+// POST a multipart body (see transcribe_util.h) of body_len bytes, or
+// LLM_BODY_CHUNKED, to the transcription endpoint. Same buffer contract as llm_request; on an HTTP
+// error the endpoint's reply is left in response_buf.
+esp_err_t llm_transcribe_request(size_t body_len, llm_body_fn body, void *body_ctx,
+                                 char *response_buf, size_t response_buf_size);
+
 #endif // LLM_H
@@ -5,12 +5,15 @@
 #include "llm.h"
 #include "tools.h"
 #include "tools_media.h"
+#include "motion.h"
+#include "timelapse.h"
 #include "telegram.h"
 #include "cron.h"
 #include "ratelimit.h"
 #include "ota.h"
 #include "boot_guard.h"
 #include "nvs_keys.h"
+#include "nvs_wb.h"
 #include "messages.h"
 
 #include "freertos/FreeRTOS.h"
@@ -270,8 +273,17 @@ static bool check_factory_reset(void)
 
         if (held_ms >= FACTORY_RESET_HOLD_MS) {
             ESP_LOGW(TAG, "Factory reset triggered!");
+            // Pending write-behind entries would be replayed into the erased
+            // partition by the restart-time flush.
+            nvs_wb_discard();
             nvs_flash_erase();
-            ESP_LOGI(TAG, "NVS erased, restarting...");
+            // User memories, chat histories and embeddings live outside NVS.
+            esp_err_t err = memory_erase_store();
+            if (err != ESP_OK) {
+                ESP_LOGE(TAG, "Failed to erase %s: %s", ZC_STORE_PARTITION_LABEL,
+                         esp_err_to_name(err));
+            }
+            ESP_LOGI(TAG, "NVS and %s erased, restarting...", ZC_STORE_PARTITION_LABEL);
             vTaskDelay(pdMS_TO_TICKS(1000));
             esp_restart();
             return true;
@@ -555,6 +567,20 @@ void app_main(void)
         fail_fast_startup("cron_start", startup_err);
     }
 
+#if ZCLAW_HAS_CAMERA
+    // Motion watch (idle until enabled with the motion_watch tool)
+    startup_err = motion_start(input_queue);
+    if (startup_err != ESP_OK) {
+        ESP_LOGE(TAG, "Motion watch unavailable: %s", esp_err_to_name(startup_err));
+    }
+#endif
+#if ZCLAW_HAS_TIMELAPSE
+    startup_err = timelapse_start();
+    if (startup_err != ESP_OK) {
+        ESP_LOGE(TAG, "Time-lapse unavailable: %s", esp_err_to_name(startup_err));
+    }
+#endif
+
     // 18. Print ready message
     ESP_LOGI(TAG, "");
     ESP_LOGI(TAG, "========================================");
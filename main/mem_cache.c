@@ -0,0 +1,270 @@
+#include "mem_cache.h"
+#include "config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    char key[MEM_CACHE_KEY_LEN];
+    char *value;                    // NULL when the key is known absent
+    size_t len;                     // Includes the terminator
+    uint32_t last_used;
+    bool used;
+} mem_cache_entry_t;
+
+typedef enum {
+    INDEX_UNKNOWN,
+    INDEX_BUILDING,
+    INDEX_COMPLETE,
+} index_state_t;
+
+static mem_cache_entry_t s_entries[MEM_CACHE_MAX_ENTRIES];
+static mem_cache_alloc_t s_alloc = { malloc, free };
+static size_t s_max_bytes = MEM_CACHE_MAX_BYTES;
+static uint32_t s_clock = 0;
+static mem_cache_stats_t s_stats;
+
+static char s_index[MEM_CACHE_INDEX_MAX][MEM_CACHE_KEY_LEN];
+static size_t s_index_count = 0;
+static index_state_t s_index_state = INDEX_UNKNOWN;
+
+static bool key_fits(const char *key)
+{
+    return key && key[0] != '\0' && strlen(key) < MEM_CACHE_KEY_LEN;
+}
+
+static void release_entry(mem_cache_entry_t *entry)
+{
+    if (entry->value) {
+        s_alloc.free(entry->value);
+        s_stats.bytes -= entry->len;
+    }
+    memset(entry, 0, sizeof(*entry));
+    s_stats.entries--;
+}
+
+static mem_cache_entry_t *find_entry(const char *key)
+{
+    for (size_t i = 0; i < MEM_CACHE_MAX_ENTRIES; i++) {
+        if (s_entries[i].used && strcmp(s_entries[i].key, key) == 0) {
+            return &s_entries[i];
+        }
+    }
+    return NULL;
+}
+
+static mem_cache_entry_t *least_recent_entry(void)
+{
+    mem_cache_entry_t *oldest = NULL;
+    for (size_t i = 0; i < MEM_CACHE_MAX_ENTRIES; i++) {
+        if (!s_entries[i].used) {
+            continue;
+        }
+        // Wrap-safe: larger age means used longer ago.
+        if (!oldest || (uint32_t)(s_clock - s_entries[i].last_used) >
+                       (uint32_t)(s_clock - oldest->last_used)) {
+            oldest = &s_entries[i];
+        }
+    }
+    return oldest;
+}
+
+static mem_cache_entry_t *free_entry(void)
+{
+    for (size_t i = 0; i < MEM_CACHE_MAX_ENTRIES; i++) {
+        if (!s_entries[i].used) {
+            return &s_entries[i];
+        }
+    }
+    return NULL;
+}
+
+static void evict_one(void)
+{
+    mem_cache_entry_t *victim = least_recent_entry();
+    if (victim) {
+        release_entry(victim);
+        s_stats.evictions++;
+    }
+}
+
+void mem_cache_init(const mem_cache_alloc_t *alloc, size_t max_bytes)
+{
+    mem_cache_clear();
+    if (alloc && alloc->alloc && alloc->free) {
+        s_alloc = *alloc;
+    } else {
+        s_alloc.alloc = malloc;
+        s_alloc.free = free;
+    }
+    s_max_bytes = max_bytes;
+    memset(&s_stats, 0, sizeof(s_stats));
+    s_clock = 0;
+}
+
+void mem_cache_clear(void)
+{
+    for (size_t i = 0; i < MEM_CACHE_MAX_ENTRIES; i++) {
+        if (s_entries[i].used) {
+            release_entry(&s_entries[i]);
+        }
+    }
+    mem_cache_index_invalidate();
+}
+
+mem_cache_result_t mem_cache_get(const char *key, char *buf, size_t len)
+{
+    if (!key_fits(key)) {
+        return MEM_CACHE_MISS;
+    }
+
+    mem_cache_entry_t *entry = find_entry(key);
+    if (!entry) {
+        s_stats.misses++;
+        return MEM_CACHE_MISS;
+    }
+    entry->last_used = ++s_clock;
+
+    if (!entry->value) {
+        s_stats.absent_hits++;
+        return MEM_CACHE_ABSENT;
+    }
+    if (!buf || entry->len > len) {
+        return MEM_CACHE_TOO_SMALL;
+    }
+    memcpy(buf, entry->value, entry->len);
+    s_stats.hits++;
+    return MEM_CACHE_HIT;
+}
+
+void mem_cache_put(const char *key, const char *value)
+{
+    if (!key_fits(key)) {
+        return;
+    }
+
+    size_t len = value ? strlen(value) + 1 : 0;
+    mem_cache_entry_t *entry = find_entry(key);
+    if (entry) {
+        release_entry(entry);
+    }
+    if (len > s_max_bytes) {
+        return;                     // Never cacheable; leave it to NVS
+    }
+
+    while (s_stats.bytes + len > s_max_bytes) {
+        evict_one();
+    }
+    entry = free_entry();
+    if (!entry) {
+        evict_one();
+        entry = free_entry();
+    }
+
+    char *copy = NULL;
+    if (value) {
+        copy = s_alloc.alloc(len);
+        if (!copy) {
+            return;
+        }
+        memcpy(copy, value, len);
+    }
+
+    snprintf(entry->key, sizeof(entry->key), "%s", key);
+    entry->value = copy;
+    entry->len = len;
+    entry->last_used = ++s_clock;
+    entry->used = true;
+    s_stats.entries++;
+    s_stats.bytes += len;
+}
+
+void mem_cache_invalidate(const char *key)
+{
+    if (!key_fits(key)) {
+        return;
+    }
+    mem_cache_entry_t *entry = find_entry(key);
+    if (entry) {
+        release_entry(entry);
+    }
+}
+
+void mem_cache_index_begin(void)
+{
+    s_index_count = 0;
+    s_index_state = INDEX_BUILDING;
+}
+
+void mem_cache_index_complete(void)
+{
+    if (s_index_state == INDEX_BUILDING) {
+        s_index_state = INDEX_COMPLETE;
+    }
+}
+
+void mem_cache_index_invalidate(void)
+{
+    s_index_count = 0;
+    s_index_state = INDEX_UNKNOWN;
+}
+
+bool mem_cache_index_is_complete(void)
+{
+    return s_index_state == INDEX_COMPLETE;
+}
+
+void mem_cache_index_add(const char *key)
+{
+    if (s_index_state == INDEX_UNKNOWN || !key_fits(key)) {
+        return;
+    }
+    for (size_t i = 0; i < s_index_count; i++) {
+        if (strcmp(s_index[i], key) == 0) {
+            return;
+        }
+    }
+    if (s_index_count >= MEM_CACHE_INDEX_MAX) {
+        mem_cache_index_invalidate();
+        return;
+    }
+    snprintf(s_index[s_index_count], MEM_CACHE_KEY_LEN, "%s", key);
+    s_index_count++;
+}
+
+void mem_cache_index_remove(const char *key)
+{
+    if (!key) {
+        return;
+    }
+    for (size_t i = 0; i < s_index_count; i++) {
+        if (strcmp(s_index[i], key) == 0) {
+            memmove(&s_index[i], &s_index[i + 1],
+                    (s_index_count - i - 1) * sizeof(s_index[0]));
+            s_index_count--;
+            return;
+        }
+    }
+}
+
+size_t mem_cache_index_visit(bool (*visit)(const char *key, void *ctx), void *ctx)
+{
+    size_t visited = 0;
+    if (!visit) {
+        return 0;
+    }
+    for (size_t i = 0; i < s_index_count; i++) {
+        visited++;
+        if (!visit(s_index[i], ctx)) {
+            break;
+        }
+    }
+    return visited;
+}
+
+void mem_cache_get_stats(mem_cache_stats_t *stats)
+{
+    if (stats) {
+        *stats = s_stats;
+    }
+}
@@ -0,0 +1,64 @@
+#ifndef MEM_CACHE_H
+#define MEM_CACHE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Bounded RAM cache of string values for the memory layer. Entries are
+// evicted least-recently-used once MEM_CACHE_MAX_ENTRIES or the byte budget
+// is reached. A key can also be cached as known-absent, so repeated lookups of
+// unset config keys skip NVS too.
+//
+// A separate key index mirrors the set of stored keys once it has been built
+// from one NVS scan, letting memory_list skip the iterator. Adding a key to a
+// full index drops it back to unknown and the next listing rescans NVS.
+//
+// Not thread-safe: memory.c serializes access.
+
+#define MEM_CACHE_KEY_LEN   16      // NVS key limit (15 chars) + terminator
+
+typedef struct {
+    void *(*alloc)(size_t size);    // Value storage (PSRAM when available)
+    void (*free)(void *ptr);
+} mem_cache_alloc_t;
+
+typedef enum {
+    MEM_CACHE_MISS,                 // Unknown; read NVS
+    MEM_CACHE_HIT,                  // Value copied out
+    MEM_CACHE_ABSENT,               // Known not to exist
+    MEM_CACHE_TOO_SMALL,            // Cached value does not fit the buffer
+} mem_cache_result_t;
+
+typedef struct {
+    uint32_t hits;
+    uint32_t absent_hits;
+    uint32_t misses;
+    uint32_t evictions;
+    size_t entries;
+    size_t bytes;                   // Value bytes currently held
+} mem_cache_stats_t;
+
+// Reset the cache and key index. alloc may be NULL for malloc/free.
+void mem_cache_init(const mem_cache_alloc_t *alloc, size_t max_bytes);
+void mem_cache_clear(void);
+
+mem_cache_result_t mem_cache_get(const char *key, char *buf, size_t len);
+
+// Cache value for key; value NULL records the key as absent.
+void mem_cache_put(const char *key, const char *value);
+void mem_cache_invalidate(const char *key);
+
+// Key index
+void mem_cache_index_begin(void);           // Start a rebuild from an NVS scan
+void mem_cache_index_complete(void);        // Scan finished; index is authoritative
+void mem_cache_index_invalidate(void);
+bool mem_cache_index_is_complete(void);
+void mem_cache_index_add(const char *key);  // No-op while the index is unknown
+void mem_cache_index_remove(const char *key);
+// Visit indexed keys in insertion order; stops when visit returns false.
+size_t mem_cache_index_visit(bool (*visit)(const char *key, void *ctx), void *ctx);
+
+void mem_cache_get_stats(mem_cache_stats_t *stats);
+
+#endif // MEM_CACHE_H
@@ -1,14 +1,56 @@
 #include "memory.h"
 #include "config.h"
+#include "mem_cache.h"
+#include "memory_keys.h"
+#include "nvs_wb.h"
+#include "zc_store.h"
 #include "security.h"
 #include "nvs_flash.h"
 #include "nvs.h"
 #include "esp_log.h"
 #include "esp_flash_encrypt.h"
 #include "esp_partition.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include <stdlib.h>
+#include <string.h>
 
 static const char *TAG = "memory";
 
+static SemaphoreHandle_t s_wb_mutex = NULL;
+static TaskHandle_t s_wb_task_handle = NULL;
+
+// Handles stay open for the life of the firmware: nvs_open/nvs_close per
+// access is slow, and slower again with encrypted NVS.
+typedef struct {
+    const char *ns;
+    nvs_handle_t handle;
+    bool open;
+} ns_handle_t;
+
+static ns_handle_t s_handles[] = {
+    { NVS_NAMESPACE, 0, false },
+    { NVS_NAMESPACE_CRON, 0, false },
+    { NVS_NAMESPACE_TOOLS, 0, false },
+};
+
+// Serializes the RAM cache and keeps it ordered with write-behind updates.
+// Lock order: s_cache_mutex, then s_wb_mutex.
+static SemaphoreHandle_t s_cache_mutex = NULL;
+
+// User keys (u_*) live in the zc_store partition when it is available.
+static SemaphoreHandle_t s_store_mutex = NULL;
+static const esp_partition_t *s_store_partition = NULL;
+static bool s_store_ready = false;
+static uint32_t s_user_generation = 0;
+
+#define ZC_STORE_PARTITION_SUBTYPE  0x40
+#define MIGRATE_BATCH               8
+
 static const char *log_value_for_key(const char *key, const char *value)
 {
     if (security_key_is_sensitive(key)) {
@@ -52,7 +94,266 @@ static esp_err_t init_encrypted_nvs(void)
     return err;
 }
 
-esp_err_t memory_init(void)
+// --- Persistent namespace handles ---
+
+static esp_err_t open_persistent_handles(void)
+{
+    for (size_t i = 0; i < sizeof(s_handles) / sizeof(s_handles[0]); i++) {
+        if (s_handles[i].open) {
+            continue;
+        }
+        esp_err_t err = nvs_open(s_handles[i].ns, NVS_READWRITE, &s_handles[i].handle);
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to open namespace %s: %s", s_handles[i].ns,
+                     esp_err_to_name(err));
+            return err;
+        }
+        s_handles[i].open = true;
+    }
+    return ESP_OK;
+}
+
+static bool persistent_handle(const char *ns, nvs_handle_t *handle)
+{
+    for (size_t i = 0; i < sizeof(s_handles) / sizeof(s_handles[0]); i++) {
+        if (s_handles[i].open && strcmp(s_handles[i].ns, ns) == 0) {
+            *handle = s_handles[i].handle;
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool is_persistent_handle(nvs_handle_t handle)
+{
+    for (size_t i = 0; i < sizeof(s_handles) / sizeof(s_handles[0]); i++) {
+        if (s_handles[i].open && s_handles[i].handle == handle) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// --- RAM read cache ---
+
+static void *cache_alloc(size_t size)
+{
+#if ZCLAW_HAS_PSRAM
+    void *ptr = heap_caps_malloc(size, MALLOC_CAP_SPIRAM);
+    if (ptr) {
+        return ptr;
+    }
+#endif
+    return malloc(size);
+}
+
+static void cache_free(void *ptr)
+{
+    free(ptr);
+}
+
+static void cache_lock(void)
+{
+    xSemaphoreTake(s_cache_mutex, portMAX_DELAY);
+}
+
+static void cache_unlock(void)
+{
+    xSemaphoreGive(s_cache_mutex);
+}
+
+// Credentials are read once at boot; keep them out of long-lived copies.
+static bool key_is_cacheable(const char *key)
+{
+    return !security_key_is_sensitive(key);
+}
+
+static void cache_store(const char *key, const char *value)
+{
+    if (key_is_cacheable(key)) {
+        mem_cache_put(key, value);
+    } else {
+        mem_cache_invalidate(key);
+    }
+    if (value) {
+        mem_cache_index_add(key);
+    } else {
+        mem_cache_index_remove(key);
+    }
+}
+
+// --- Write-behind backend (nvs_wb core -> nvs_* calls) ---
+
+static esp_err_t wb_open(const char *ns, uint32_t *handle, void *ctx)
+{
+    (void)ctx;
+    nvs_handle_t nvs;
+    if (persistent_handle(ns, &nvs)) {
+        *handle = (uint32_t)nvs;
+        return ESP_OK;
+    }
+    esp_err_t err = nvs_open(ns, NVS_READWRITE, &nvs);
+    if (err == ESP_OK) {
+        *handle = (uint32_t)nvs;
+    }
+    return err;
+}
+
+static esp_err_t wb_write(uint32_t handle, const nvs_wb_item_t *item, void *ctx)
+{
+    (void)ctx;
+    esp_err_t err;
+
+    switch (item->kind) {
+        case NVS_WB_KIND_STR:
+            return nvs_set_str((nvs_handle_t)handle, item->key, (const char *)item->data);
+        case NVS_WB_KIND_BLOB:
+            return nvs_set_blob((nvs_handle_t)handle, item->key, item->data, item->len);
+        case NVS_WB_KIND_U8:
+            return nvs_set_u8((nvs_handle_t)handle, item->key, item->data[0]);
+        case NVS_WB_KIND_ERASE:
+            err = nvs_erase_key((nvs_handle_t)handle, item->key);
+            return err == ESP_ERR_NVS_NOT_FOUND ? ESP_OK : err;
+        default:
+            return ESP_ERR_INVALID_ARG;
+    }
+}
+
+static esp_err_t wb_commit(uint32_t handle, void *ctx)
+{
+    (void)ctx;
+    esp_err_t err = nvs_commit((nvs_handle_t)handle);
+    if (!is_persistent_handle((nvs_handle_t)handle)) {
+        nvs_close((nvs_handle_t)handle);
+    }
+    return err;
+}
+
+static uint32_t wb_now_ms(void *ctx)
+{
+    (void)ctx;
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+static void wb_lock(void *ctx)
+{
+    (void)ctx;
+    xSemaphoreTake(s_wb_mutex, portMAX_DELAY);
+}
+
+static void wb_unlock(void *ctx)
+{
+    (void)ctx;
+    xSemaphoreGive(s_wb_mutex);
+}
+
+static void wb_kick(void *ctx)
+{
+    (void)ctx;
+    if (s_wb_task_handle) {
+        xTaskNotifyGive(s_wb_task_handle);
+    }
+}
+
+// Runs from esp_restart(), which also covers OTA reboots and rollbacks.
+static void wb_shutdown_handler(void)
+{
+    size_t pending = nvs_wb_dirty_count();
+    if (pending > 0) {
+        ESP_LOGI(TAG, "Flushing %u deferred NVS writes before restart", (unsigned)pending);
+        nvs_wb_flush();
+    }
+}
+
+// --- zc_store backend (log store core -> esp_partition calls) ---
+
+static esp_err_t store_read(uint32_t offset, void *buf, size_t len, void *ctx)
+{
+    (void)ctx;
+    return esp_partition_read(s_store_partition, offset, buf, len);
+}
+
+static esp_err_t store_write(uint32_t offset, const void *buf, size_t len, void *ctx)
+{
+    (void)ctx;
+    return esp_partition_write(s_store_partition, offset, buf, len);
+}
+
+static esp_err_t store_erase(uint32_t offset, size_t len, void *ctx)
+{
+    (void)ctx;
+    return esp_partition_erase_range(s_store_partition, offset, len);
+}
+
+static void store_lock(void *ctx)
+{
+    (void)ctx;
+    xSemaphoreTake(s_store_mutex, portMAX_DELAY);
+}
+
+static void store_unlock(void *ctx)
+{
+    (void)ctx;
+    xSemaphoreGive(s_store_mutex);
+}
+
+// The flush task also runs store compaction.
+static void wb_task(void *arg)
+{
+    (void)arg;
+
+    while (1) {
+        uint32_t wait_ms = nvs_wb_tick();
+        if (wait_ms == UINT32_MAX) {
+            wait_ms = NVS_WB_FLUSH_INTERVAL_MS;
+        }
+        if (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(wait_ms)) > 0) {
+            nvs_wb_flush();  // Dirty-key threshold reached
+        }
+        while (s_store_ready && zc_store_needs_compaction()) {
+            if (zc_store_compact_step() != ESP_OK) {
+                break;
+            }
+        }
+    }
+}
+
+static esp_err_t start_write_behind(void)
+{
+    static const nvs_wb_backend_t backend = {
+        .open = wb_open,
+        .write = wb_write,
+        .commit = wb_commit,
+        .now_ms = wb_now_ms,
+        .lock = wb_lock,
+        .unlock = wb_unlock,
+        .kick = wb_kick,
+        .ctx = NULL,
+    };
+
+    if (!s_wb_mutex) {
+        s_wb_mutex = xSemaphoreCreateMutex();
+        if (!s_wb_mutex) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    nvs_wb_init(&backend, NVS_WB_FLUSH_INTERVAL_MS, NVS_WB_FLUSH_THRESHOLD);
+
+    if (!s_wb_task_handle &&
+        xTaskCreate(wb_task, "nvs_wb", NVS_WB_TASK_STACK_SIZE, NULL,
+                    NVS_WB_TASK_PRIORITY, &s_wb_task_handle) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create NVS write-behind task");
+        return ESP_ERR_NO_MEM;
+    }
+
+    esp_err_t err = esp_register_shutdown_handler(wb_shutdown_handler);
+    if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) {
+        ESP_LOGW(TAG, "Failed to register NVS flush on restart: %s", esp_err_to_name(err));
+    }
+    return ESP_OK;
+}
+
+static esp_err_t init_nvs_flash(void)
 {
     esp_err_t err;
 
@@ -81,77 +382,474 @@ esp_err_t memory_init(void)
     return err;
 }
 
-esp_err_t memory_set(const char *key, const char *value)
+// Move u_* keys left in NVS by older firmware into the store, a batch at a
+// time so the NVS iterator is never live across an erase.
+static void migrate_user_keys(void)
 {
+    char keys[MIGRATE_BATCH][NVS_KEY_NAME_MAX_SIZE];
+    char *value = malloc(NVS_MAX_VALUE_LEN + 1);
     nvs_handle_t handle;
-    esp_err_t err;
+    int migrated = 0;
+
+    if (!value || !persistent_handle(NVS_NAMESPACE, &handle)) {
+        free(value);
+        return;
+    }
+
+    while (1) {
+        size_t count = 0;
+        nvs_iterator_t it = NULL;
+        esp_err_t err = nvs_entry_find_in_handle(handle, NVS_TYPE_STR, &it);
+        while (err == ESP_OK && it != NULL && count < MIGRATE_BATCH) {
+            nvs_entry_info_t info;
+            nvs_entry_info(it, &info);
+            if (memory_keys_is_user_key(info.key)) {
+                snprintf(keys[count++], sizeof(keys[0]), "%s", info.key);
+            }
+            err = nvs_entry_next(&it);
+        }
+        if (it) {
+            nvs_release_iterator(it);
+        }
+        if (count == 0) {
+            break;
+        }
+
+        for (size_t i = 0; i < count; i++) {
+            size_t len = NVS_MAX_VALUE_LEN + 1;
+            if (nvs_get_str(handle, keys[i], value, &len) != ESP_OK ||
+                zc_store_set(keys[i], value) != ESP_OK) {
+                // Reads fall back to NVS, so the key stays reachable.
+                ESP_LOGE(TAG, "Failed to migrate %s; leaving it in NVS", keys[i]);
+                free(value);
+                return;
+            }
+            nvs_wb_erase(NVS_NAMESPACE, keys[i], NVS_WB_DEFERRED);
+            migrated++;
+        }
+        if (nvs_wb_flush() != ESP_OK) {
+            break;
+        }
+    }
+    free(value);
+    if (migrated > 0) {
+        ESP_LOGI(TAG, "Migrated %d user keys from NVS to %s", migrated,
+                 ZC_STORE_PARTITION_LABEL);
+    }
+}
+
+static void start_store(void)
+{
+    static zc_store_backend_t backend = {
+        .read = store_read,
+        .write = store_write,
+        .erase = store_erase,
+        .lock = store_lock,
+        .unlock = store_unlock,
+        .kick = wb_kick,
+        .ctx = NULL,
+        .segment_size = ZC_STORE_SEGMENT_SIZE,
+    };
+
+    // The store writes raw flash; keep user memory in encrypted NVS instead.
+    if (esp_flash_encryption_enabled()) {
+        ESP_LOGI(TAG, "Flash encryption enabled; user memory stays in NVS");
+        return;
+    }
+    s_store_partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                                 ZC_STORE_PARTITION_SUBTYPE,
+                                                 ZC_STORE_PARTITION_LABEL);
+    if (!s_store_partition) {
+        ESP_LOGW(TAG, "No %s partition; user memory stays in NVS", ZC_STORE_PARTITION_LABEL);
+        return;
+    }
+
+    if (!s_store_mutex) {
+        s_store_mutex = xSemaphoreCreateMutex();
+        if (!s_store_mutex) {
+            return;
+        }
+    }
+    backend.size = s_store_partition->size;
+    esp_err_t err = zc_store_mount(&backend);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to mount %s: %s", ZC_STORE_PARTITION_LABEL, esp_err_to_name(err));
+        return;
+    }
+    s_store_ready = true;
+    migrate_user_keys();
+}
+
+esp_err_t memory_erase_store(void)
+{
+    const esp_partition_t *part = s_store_partition;
+
+    if (!part) {
+        part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ZC_STORE_PARTITION_SUBTYPE,
+                                        ZC_STORE_PARTITION_LABEL);
+    }
+    if (!part) {
+        return ESP_OK;
+    }
+
+    // Held so compaction in the flush task cannot write into the erase.
+    if (s_store_mutex) {
+        xSemaphoreTake(s_store_mutex, portMAX_DELAY);
+    }
+    s_store_ready = false;
+    zc_store_unmount();
+    esp_err_t err = esp_partition_erase_range(part, 0, part->size);
+    if (s_store_mutex) {
+        xSemaphoreGive(s_store_mutex);
+    }
+    return err;
+}
 
-    err = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &handle);
+static bool use_store(const char *key)
+{
+    return s_store_ready && memory_keys_is_user_key(key);
+}
+
+size_t memory_key_max_len(const char *key)
+{
+    return use_store(key) ? ZC_STORE_MAX_KEY_LEN : NVS_MAX_KEY_LEN;
+}
+
+size_t memory_value_max_len(const char *key)
+{
+    return use_store(key) ? ZC_STORE_MAX_VALUE_LEN : NVS_MAX_VALUE_LEN;
+}
+
+esp_err_t memory_init(void)
+{
+    static const mem_cache_alloc_t cache_allocator = {
+        .alloc = cache_alloc,
+        .free = cache_free,
+    };
+
+    esp_err_t err = init_nvs_flash();
+    if (err != ESP_OK) {
+        return err;
+    }
+    err = open_persistent_handles();
     if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to open NVS: %s", esp_err_to_name(err));
         return err;
     }
 
-    err = nvs_set_str(handle, key, value);
+    if (!s_cache_mutex) {
+        s_cache_mutex = xSemaphoreCreateMutex();
+        if (!s_cache_mutex) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    mem_cache_init(&cache_allocator, MEM_CACHE_MAX_BYTES);
+    err = start_write_behind();
     if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to set '%s': %s", key, esp_err_to_name(err));
-        nvs_close(handle);
         return err;
     }
+    start_store();
+    return ESP_OK;
+}
 
-    err = nvs_commit(handle);
+static esp_err_t set_string(const char *key, const char *value, uint8_t flags)
+{
+    cache_lock();
+    esp_err_t err;
+    if (use_store(key)) {
+        // Appends are cheap and already durable; no write-behind needed.
+        err = zc_store_set(key, value);
+        if (err == ESP_OK && key_is_cacheable(key)) {
+            mem_cache_put(key, value);
+        } else {
+            mem_cache_invalidate(key);
+        }
+    } else {
+        err = nvs_wb_set_str(NVS_NAMESPACE, key, value, flags);
+        if (err == ESP_OK) {
+            cache_store(key, value);
+        } else {
+            mem_cache_invalidate(key);
+        }
+    }
+    if (err == ESP_OK && memory_keys_is_user_key(key)) {
+        s_user_generation++;
+    }
+    cache_unlock();
+    return err;
+}
+
+esp_err_t memory_set(const char *key, const char *value)
+{
+    esp_err_t err = set_string(key, value, NVS_WB_DURABLE);
     if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to commit: %s", esp_err_to_name(err));
+        ESP_LOGE(TAG, "Failed to store '%s': %s", key, esp_err_to_name(err));
     } else {
         ESP_LOGI(TAG, "Stored: %s = %s", key, log_value_for_key(key, value));
     }
+    return err;
+}
 
-    nvs_close(handle);
+esp_err_t memory_set_deferred(const char *key, const char *value)
+{
+    esp_err_t err = set_string(key, value, NVS_WB_DEFERRED);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to queue '%s': %s", key, esp_err_to_name(err));
+    }
     return err;
 }
 
-bool memory_get(const char *key, char *value, size_t max_len)
+esp_err_t memory_flush(void)
+{
+    return nvs_wb_flush();
+}
+
+static bool get_locked(const char *key, char *value, size_t max_len)
 {
     nvs_handle_t handle;
-    esp_err_t err;
+    bool cacheable = key_is_cacheable(key);
+    bool store = use_store(key);
 
-    err = nvs_open(NVS_NAMESPACE, NVS_READONLY, &handle);
-    if (err != ESP_OK) {
+    if (cacheable) {
+        switch (mem_cache_get(key, value, max_len)) {
+            case MEM_CACHE_HIT:
+                return true;
+            case MEM_CACHE_ABSENT:
+            case MEM_CACHE_TOO_SMALL:
+                return false;
+            case MEM_CACHE_MISS:
+            default:
+                break;
+        }
+    }
+
+    if (store) {
+        size_t len = max_len;
+        esp_err_t err = zc_store_get(key, value, &len);
+        if (err == ESP_OK) {
+            if (cacheable) {
+                mem_cache_put(key, value);
+            }
+            return true;
+        }
+        if (err != ESP_ERR_NOT_FOUND) {
+            return false;
+        }
+        // Not migrated yet: fall back to NVS below.
+    }
+
+    // Pending write-behind values are newer than flash.
+    size_t pending_len = max_len;
+    switch (nvs_wb_lookup(NVS_NAMESPACE, key, NULL, value, &pending_len)) {
+        case NVS_WB_LOOKUP_HIT:
+            return true;
+        case NVS_WB_LOOKUP_ERASED:
+        case NVS_WB_LOOKUP_TOO_SMALL:
+            return false;
+        case NVS_WB_LOOKUP_MISS:
+        default:
+            break;
+    }
+
+    if (!persistent_handle(NVS_NAMESPACE, &handle)) {
         return false;
     }
 
     size_t required_size = max_len;
-    err = nvs_get_str(handle, key, value, &required_size);
-    nvs_close(handle);
-
+    esp_err_t err = nvs_get_str(handle, key, value, &required_size);
     if (err == ESP_OK) {
+        if (cacheable) {
+            mem_cache_put(key, value);
+        }
         ESP_LOGI(TAG, "Retrieved: %s = %s", key, log_value_for_key(key, value));
         return true;
     }
+    if (err == ESP_ERR_NVS_NOT_FOUND && cacheable) {
+        mem_cache_put(key, NULL);
+    }
     return false;
 }
 
-esp_err_t memory_delete(const char *key)
+bool memory_get(const char *key, char *value, size_t max_len)
+{
+    if (!key || !value || max_len == 0 || !s_cache_mutex) {
+        return false;
+    }
+    cache_lock();
+    bool found = get_locked(key, value, max_len);
+    cache_unlock();
+    return found;
+}
+
+static bool nvs_key_exists_locked(const char *key, bool use_cache)
 {
     nvs_handle_t handle;
-    esp_err_t err;
 
-    err = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &handle);
-    if (err != ESP_OK) {
-        return err;
+    size_t pending_len = 0;
+    switch (nvs_wb_lookup(NVS_NAMESPACE, key, NULL, NULL, &pending_len)) {
+        case NVS_WB_LOOKUP_ERASED:
+            return false;
+        case NVS_WB_LOOKUP_HIT:
+        case NVS_WB_LOOKUP_TOO_SMALL:
+            return true;
+        case NVS_WB_LOOKUP_MISS:
+        default:
+            break;
     }
 
-    err = nvs_erase_key(handle, key);
+    switch (use_cache ? mem_cache_get(key, NULL, 0) : MEM_CACHE_MISS) {
+        case MEM_CACHE_ABSENT:
+            return false;
+        case MEM_CACHE_HIT:
+        case MEM_CACHE_TOO_SMALL:
+            return true;
+        case MEM_CACHE_MISS:
+        default:
+            break;
+    }
+    if (!persistent_handle(NVS_NAMESPACE, &handle)) {
+        return false;
+    }
+    size_t len = 0;
+    return nvs_get_str(handle, key, NULL, &len) == ESP_OK;
+}
+
+esp_err_t memory_delete(const char *key)
+{
+    if (!key || !s_cache_mutex) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    cache_lock();
+    bool store = use_store(key);
+    bool in_store = store && zc_store_exists(key);
+    // The cache mirrors the store for store keys, so only trust it for NVS keys.
+    bool in_nvs = nvs_key_exists_locked(key, !store);
+    if (!in_store && !in_nvs) {
+        cache_unlock();
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+
+    esp_err_t err = in_store ? zc_store_delete(key) : ESP_OK;
+    if (err == ESP_OK && in_nvs) {
+        err = nvs_wb_erase(NVS_NAMESPACE, key, NVS_WB_DURABLE);
+    }
     if (err == ESP_OK) {
-        esp_err_t commit_err = nvs_commit(handle);
-        if (commit_err == ESP_OK) {
-            ESP_LOGI(TAG, "Deleted: %s", key);
-        } else {
-            ESP_LOGE(TAG, "Failed to commit delete '%s': %s", key, esp_err_to_name(commit_err));
-            err = commit_err;
+        cache_store(key, NULL);
+        if (memory_keys_is_user_key(key)) {
+            s_user_generation++;
         }
+    } else {
+        mem_cache_invalidate(key);
     }
+    cache_unlock();
 
-    nvs_close(handle);
+    if (err == ESP_OK) {
+        ESP_LOGI(TAG, "Deleted: %s", key);
+    } else {
+        ESP_LOGE(TAG, "Failed to delete '%s': %s", key, esp_err_to_name(err));
+    }
     return err;
 }
+
+// Rebuild the key index from one NVS scan. Deferred writes are flushed first
+// so keys that only exist in the write-behind cache are not missed.
+static void rebuild_index_locked(void)
+{
+    nvs_handle_t handle;
+
+    mem_cache_index_invalidate();
+    if (nvs_wb_flush() != ESP_OK || !persistent_handle(NVS_NAMESPACE, &handle)) {
+        return;
+    }
+
+    nvs_iterator_t it = NULL;
+    esp_err_t err = nvs_entry_find_in_handle(handle, NVS_TYPE_STR, &it);
+    mem_cache_index_begin();
+    while (err == ESP_OK && it != NULL) {
+        nvs_entry_info_t info;
+        nvs_entry_info(it, &info);
+        mem_cache_index_add(info.key);
+        err = nvs_entry_next(&it);
+    }
+    if (it) {
+        nvs_release_iterator(it);
+    }
+    if (err == ESP_OK || err == ESP_ERR_NVS_NOT_FOUND) {
+        mem_cache_index_complete();
+    } else {
+        mem_cache_index_invalidate();
+    }
+}
+
+// Fallback when the namespace holds more keys than the index can track.
+static size_t scan_keys_locked(bool (*visit)(const char *key, void *ctx), void *ctx)
+{
+    nvs_handle_t handle;
+    size_t visited = 0;
+
+    if (!persistent_handle(NVS_NAMESPACE, &handle)) {
+        return 0;
+    }
+
+    nvs_iterator_t it = NULL;
+    esp_err_t err = nvs_entry_find_in_handle(handle, NVS_TYPE_STR, &it);
+    while (err == ESP_OK && it != NULL) {
+        nvs_entry_info_t info;
+        nvs_entry_info(it, &info);
+        visited++;
+        if (!visit(info.key, ctx)) {
+            break;
+        }
+        err = nvs_entry_next(&it);
+    }
+    if (it) {
+        nvs_release_iterator(it);
+    }
+    return visited;
+}
+
+typedef struct {
+    bool (*visit)(const char *key, void *ctx);
+    void *ctx;
+    bool stopped;
+} list_ctx_t;
+
+static bool list_visit(const char *key, void *ctx)
+{
+    list_ctx_t *list = (list_ctx_t *)ctx;
+    if (!list->visit(key, list->ctx)) {
+        list->stopped = true;
+    }
+    return !list->stopped;
+}
+
+// The store also holds recall's embedding records; only user keys are listed.
+static bool list_store_visit(const char *key, void *ctx)
+{
+    return !memory_keys_is_user_key(key) || list_visit(key, ctx);
+}
+
+size_t memory_list_keys(bool (*visit)(const char *key, void *ctx), void *ctx)
+{
+    if (!visit || !s_cache_mutex) {
+        return 0;
+    }
+
+    cache_lock();
+    if (!mem_cache_index_is_complete()) {
+        rebuild_index_locked();
+    }
+    list_ctx_t list = { visit, ctx, false };
+    size_t visited = mem_cache_index_is_complete() ? mem_cache_index_visit(list_visit, &list)
+                                                   : scan_keys_locked(list_visit, &list);
+    if (s_store_ready && !list.stopped) {
+        visited += zc_store_list(list_store_visit, &list);
+    }
+    cache_unlock();
+    return visited;
+}
+
+uint32_t memory_user_generation(void)
+{
+    return s_user_generation;
+}
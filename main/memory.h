@@ -3,17 +3,44 @@
 
 #include "esp_err.h"
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 
-// Initialize NVS flash storage
+// Initialize NVS flash storage, persistent handles and the RAM read cache
 esp_err_t memory_init(void);
 
-// Store a string value (persists across reboots)
+// Store a string value (persists across reboots; committed before returning)
 esp_err_t memory_set(const char *key, const char *value);
 
+// Store a string value through the write-behind cache. Cheap to call often;
+// the value reaches flash within NVS_WB_FLUSH_INTERVAL_MS or before a restart.
+esp_err_t memory_set_deferred(const char *key, const char *value);
+
+// Commit every deferred NVS write now (any namespace)
+esp_err_t memory_flush(void);
+
 // Retrieve a string value (returns false if key not found)
 bool memory_get(const char *key, char *value, size_t max_len);
 
 // Delete a key
 esp_err_t memory_delete(const char *key);
 
+// Longest key/value accepted for key. User keys (u_*) get larger limits when
+// the zc_store partition is mounted; everything else is bound by NVS.
+size_t memory_key_max_len(const char *key);
+size_t memory_value_max_len(const char *key);
+
+// Visit every stored string key. Served from a RAM key index after the first
+// NVS scan; visit returns false to stop early. Returns keys visited.
+size_t memory_list_keys(bool (*visit)(const char *key, void *ctx), void *ctx);
+
+// Erase the zc_store partition (user memories, spilled chat histories and
+// embedding records) for a factory reset. Later store calls fall back to NVS
+// until the next boot. ESP_OK when there is no partition.
+esp_err_t memory_erase_store(void);
+
+// Counter bumped whenever a user key (u_*) is set or deleted, so callers
+// that derive state from user memories can tell when to refresh it.
+uint32_t memory_user_generation(void);
+
 #endif // MEMORY_H
@@ -17,6 +17,8 @@ bool memory_keys_is_sensitive(const char *key)
         NVS_KEY_API_KEY,
         NVS_KEY_TG_TOKEN,
         NVS_KEY_TG_CHAT_ID,
+        NVS_KEY_TG_API_URL,
+        NVS_KEY_TG_WH_SECRET,
         NVS_KEY_WIFI_PASS,
         NVS_KEY_LLM_BACKEND,
         NVS_KEY_LLM_MODEL,
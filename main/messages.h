@@ -2,9 +2,31 @@
 #define MESSAGES_H
 
 #include "config.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// Messages injected by the scheduler start with this tag ("[CRON <id>] ...").
+#define CRON_MESSAGE_PREFIX "[CRON "
+
+// Messages queued by the motion watch when the camera sees a change.
+#define MOTION_MESSAGE_PREFIX "[MOTION] "
+
+// Chat ID used for the local channel (serial/web relay) and the scheduler.
+#define CHAT_ID_LOCAL 0
+
+// Who queued a message. Only the device itself sets anything but
+// MSG_SOURCE_USER; the text prefixes above are for the model and can be typed
+// by anyone, so nothing is decided on them.
+typedef enum {
+    MSG_SOURCE_USER = 0,            // Serial, web relay or Telegram
+    MSG_SOURCE_CRON,                // A scheduled action firing
+    MSG_SOURCE_MOTION,              // The motion watch; may own the pending event photo
+} msg_source_t;
 
 // Shared queue payload for local channel and inbound agent messages.
 typedef struct {
+    int64_t chat_id;                // Originating Telegram chat, or CHAT_ID_LOCAL
+    msg_source_t source;
     char text[CHANNEL_RX_BUF_SIZE];
 } channel_msg_t;
 
@@ -15,6 +37,8 @@ typedef struct {
 
 // Shared queue payload for outbound Telegram messages.
 typedef struct {
+    int64_t chat_id;                // Destination; CHAT_ID_LOCAL means the primary chat
+    bool quick_actions;             // Send the /actions keyboard instead of text
     char text[TELEGRAM_MAX_MSG_LEN];
 } telegram_msg_t;
 
@@ -5,13 +5,57 @@
 #include <stdlib.h>
 #include <string.h>
 #include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
 #include "driver/i2s_pdm.h"
+#include "pcm_ring.h"
 
 static const char *TAG = "mic";
 
+#define CAPTURE_READ_TIMEOUT_MS 100
+#define CAPTURE_STOP_WAIT_MS    500
+
 static i2s_chan_handle_t s_rx_chan = NULL;
 static bool s_initialized = false;
 
+// The capture task is the ring's only writer; readers never block it.
+static pcm_ring_t s_ring;
+static int16_t *s_ring_buf = NULL;
+static TaskHandle_t s_capture_task = NULL;
+static volatile bool s_capture_stop = false;
+
+static void capture_task(void *arg)
+{
+    (void)arg;
+
+    while (!s_capture_stop) {
+        size_t room;
+        size_t bytes_read = 0;
+        int16_t *dst = pcm_ring_write_ptr(&s_ring, &room);
+
+        // Straight from the DMA buffers into the ring, no staging copy.
+        esp_err_t err = i2s_channel_read(s_rx_chan, dst, room * sizeof(int16_t), &bytes_read,
+                                         pdMS_TO_TICKS(CAPTURE_READ_TIMEOUT_MS));
+        if (err != ESP_OK && err != ESP_ERR_TIMEOUT) {
+            ESP_LOGE(TAG, "i2s read failed: %s", esp_err_to_name(err));
+            vTaskDelay(pdMS_TO_TICKS(CAPTURE_READ_TIMEOUT_MS));
+            continue;
+        }
+        pcm_ring_commit(&s_ring, bytes_read / sizeof(int16_t));
+    }
+
+    s_capture_task = NULL;
+    vTaskDelete(NULL);
+}
+
+static void release_channel(void)
+{
+    i2s_channel_disable(s_rx_chan);
+    i2s_del_channel(s_rx_chan);
+    s_rx_chan = NULL;
+}
+
 esp_err_t mic_init(void)
 {
     if (s_initialized) {
@@ -20,6 +64,9 @@ esp_err_t mic_init(void)
     }
 
     i2s_chan_config_t chan_cfg = I2S_CHANNEL_DEFAULT_CONFIG(I2S_NUM_0, I2S_ROLE_MASTER);
+    // The capture task drains these promptly; slow readers are the ring's problem.
+    chan_cfg.dma_desc_num = MIC_DMA_DESC_NUM;
+    chan_cfg.dma_frame_num = MIC_DMA_FRAME_NUM;
     esp_err_t err = i2s_new_channel(&chan_cfg, NULL, &s_rx_chan);
     if (err != ESP_OK) {
         ESP_LOGE(TAG, "i2s channel create failed: %s", esp_err_to_name(err));
@@ -52,59 +99,75 @@ esp_err_t mic_init(void)
         return err;
     }
 
+#if ZCLAW_HAS_PSRAM
+    s_ring_buf = heap_caps_malloc(MIC_RING_SAMPLES * sizeof(int16_t), MALLOC_CAP_SPIRAM);
+#else
+    s_ring_buf = malloc(MIC_RING_SAMPLES * sizeof(int16_t));
+#endif
+    if (!s_ring_buf) {
+        ESP_LOGE(TAG, "no memory for the capture ring");
+        release_channel();
+        return ESP_ERR_NO_MEM;
+    }
+    pcm_ring_init(&s_ring, s_ring_buf, MIC_RING_SAMPLES, MIC_CAPTURE_CHUNK);
+
+    s_capture_stop = false;
+    if (xTaskCreate(capture_task, "mic", MIC_TASK_STACK_SIZE, NULL,
+                    MIC_TASK_PRIORITY, &s_capture_task) != pdPASS) {
+        ESP_LOGE(TAG, "capture task create failed");
+        free(s_ring_buf);
+        s_ring_buf = NULL;
+        release_channel();
+        return ESP_ERR_NO_MEM;
+    }
+
     s_initialized = true;
-    ESP_LOGI(TAG, "mic initialized (%d Hz, %d-bit mono)", MIC_SAMPLE_RATE, MIC_SAMPLE_BITS);
+    ESP_LOGI(TAG, "mic initialized (%d Hz, %d-bit mono, %u ms capture ring)",
+             MIC_SAMPLE_RATE, MIC_SAMPLE_BITS,
+             (unsigned)((MIC_RING_SAMPLES - MIC_CAPTURE_CHUNK) * 1000ULL / MIC_SAMPLE_RATE));
     return ESP_OK;
 }
 
-bool mic_record(uint32_t duration_ms, int16_t **buf, size_t *len)
+bool mic_open(mic_reader_t *reader, uint32_t preroll_ms)
 {
     if (!s_initialized) {
         ESP_LOGE(TAG, "mic not initialized");
         return false;
     }
+    pcm_ring_open(&s_ring, reader, (uint32_t)((uint64_t)preroll_ms * MIC_SAMPLE_RATE / 1000));
+    return true;
+}
 
-    if (duration_ms > (uint32_t)(MIC_RECORD_SECS_MAX * 1000)) {
-        duration_ms = MIC_RECORD_SECS_MAX * 1000;
-        ESP_LOGW(TAG, "clamped recording to %d ms", (int)duration_ms);
-    }
-
-    size_t total_samples = (MIC_SAMPLE_RATE * duration_ms) / 1000;
-    size_t total_bytes = total_samples * sizeof(int16_t);
-
-#if ZCLAW_HAS_PSRAM
-    int16_t *audio_buf = heap_caps_malloc(total_bytes, MALLOC_CAP_SPIRAM);
-#else
-    int16_t *audio_buf = malloc(total_bytes);
-#endif
+bool mic_read(mic_reader_t *reader, int16_t *samples, size_t count, uint32_t timeout_ms)
+{
+    uint32_t dropped = reader->dropped;
+    uint32_t idle_ms = 0;
 
-    if (!audio_buf) {
-        ESP_LOGE(TAG, "failed to allocate %u bytes for audio", (unsigned)total_bytes);
+    if (!s_initialized) {
+        ESP_LOGE(TAG, "mic not initialized");
         return false;
     }
 
-    size_t bytes_read = 0;
-    size_t offset = 0;
-    size_t chunk = 1024;
-
-    while (offset < total_bytes) {
-        size_t to_read = total_bytes - offset;
-        if (to_read > chunk) {
-            to_read = chunk;
+    while (count > 0) {
+        size_t n = pcm_ring_read(&s_ring, reader, samples, count);
+        if (n > 0) {
+            samples += n;
+            count -= n;
+            idle_ms = 0;
+            continue;
         }
-        esp_err_t err = i2s_channel_read(s_rx_chan, (uint8_t *)audio_buf + offset,
-                                          to_read, &bytes_read, pdMS_TO_TICKS(1000));
-        if (err != ESP_OK) {
-            ESP_LOGE(TAG, "i2s read failed: %s", esp_err_to_name(err));
-            free(audio_buf);
+        if (idle_ms >= timeout_ms) {
+            ESP_LOGE(TAG, "no samples captured in %u ms", (unsigned)idle_ms);
             return false;
         }
-        offset += bytes_read;
+        vTaskDelay(pdMS_TO_TICKS(MIC_POLL_MS));
+        idle_ms += MIC_POLL_MS;
     }
 
-    *buf = audio_buf;
-    *len = offset;
-    ESP_LOGI(TAG, "recorded %u bytes (%u ms)", (unsigned)offset, (unsigned)duration_ms);
+    if (reader->dropped != dropped) {
+        ESP_LOGW(TAG, "reader fell behind the capture ring: %u samples skipped",
+                 (unsigned)(reader->dropped - dropped));
+    }
     return true;
 }
 
@@ -113,9 +176,13 @@ void mic_deinit(void)
     if (!s_initialized) {
         return;
     }
-    i2s_channel_disable(s_rx_chan);
-    i2s_del_channel(s_rx_chan);
-    s_rx_chan = NULL;
+    s_capture_stop = true;
+    for (int waited = 0; s_capture_task && waited < CAPTURE_STOP_WAIT_MS; waited += MIC_POLL_MS) {
+        vTaskDelay(pdMS_TO_TICKS(MIC_POLL_MS));
+    }
+    release_channel();
+    free(s_ring_buf);
+    s_ring_buf = NULL;
     s_initialized = false;
     ESP_LOGI(TAG, "mic deinitialized");
 }
@@ -9,16 +9,26 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include "esp_err.h"
+#include "pcm_ring.h"
 
-// Initialize the I2S PDM microphone.
+// A consumer's place in the capture ring. Any number can read at once.
+typedef pcm_ring_reader_t mic_reader_t;
+
+// Initialize the I2S PDM microphone and start the capture task, which
+// keeps the last MIC_RING_SAMPLES samples in a ring from then on.
 // Returns ESP_OK on success, error code on failure.
 esp_err_t mic_init(void);
 
-// Record audio for up to duration_ms milliseconds.
-// Allocates a buffer and sets *buf to the raw PCM data, *len to byte count.
-// Caller must free *buf with free() when done.
-// Returns true on success, false on failure.
-bool mic_record(uint32_t duration_ms, int16_t **buf, size_t *len);
+// Start reading preroll_ms before now, or as far back as the ring holds,
+// so a request can hear what was said just before it arrived.
+// Returns false if the microphone is not running.
+bool mic_open(mic_reader_t *reader, uint32_t preroll_ms);
+
+// Read exactly count 16-bit samples from where the reader is, waiting for
+// the capture task as needed. A reader that falls the whole ring behind
+// skips ahead (counted in reader->dropped) rather than holding capture up.
+// Returns false if no samples arrive for timeout_ms.
+bool mic_read(mic_reader_t *reader, int16_t *samples, size_t count, uint32_t timeout_ms);
 
 // Deinitialize the microphone and free resources.
 void mic_deinit(void);
@@ -0,0 +1,302 @@
+#include "motion.h"
+
+#if ZCLAW_HAS_CAMERA
+
+#include "camera.h"
+#include "messages.h"
+#include "nvs_wb.h"
+#include "tools_media.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "img_converters.h"
+#include "nvs.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *TAG = "motion";
+
+#define MOTION_NVS_KEY "motion_watch"
+
+// Saved as one blob.
+typedef struct {
+    uint8_t enabled;
+    uint8_t sensitivity;
+    char note[MOTION_NOTE_MAX_LEN];
+} motion_watch_t;
+
+static motion_watch_t s_watch;
+static bool s_watch_changed = false;
+static SemaphoreHandle_t s_mutex = NULL;
+static QueueHandle_t s_agent_queue = NULL;
+
+// Owned by the sampler task.
+static motion_detector_t s_detector;
+static uint8_t s_rgb565[MOTION_FRAME_W * MOTION_FRAME_H * 2];
+static uint8_t s_gray[MOTION_FRAME_W * MOTION_FRAME_H];
+
+// Photo of the last event until the agent claims it (under s_mutex).
+static uint8_t *s_event_jpeg = NULL;
+static size_t s_event_jpeg_len = 0;
+
+static const char *const s_sensitivity_names[] = { "low", "medium", "high" };
+
+static void lock(void)
+{
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+}
+
+static void unlock(void)
+{
+    xSemaphoreGive(s_mutex);
+}
+
+static void load_from_nvs(void)
+{
+    nvs_handle_t handle;
+    size_t len = sizeof(s_watch);
+
+    memset(&s_watch, 0, sizeof(s_watch));
+    s_watch.sensitivity = MOTION_SENSITIVITY_MEDIUM;
+    if (nvs_open(NVS_NAMESPACE_TOOLS, NVS_READONLY, &handle) != ESP_OK) {
+        return;
+    }
+    if (nvs_get_blob(handle, MOTION_NVS_KEY, &s_watch, &len) != ESP_OK ||
+        len != sizeof(s_watch) || s_watch.sensitivity > MOTION_SENSITIVITY_HIGH) {
+        memset(&s_watch, 0, sizeof(s_watch));
+        s_watch.sensitivity = MOTION_SENSITIVITY_MEDIUM;
+    }
+    s_watch.note[MOTION_NOTE_MAX_LEN - 1] = '\0';
+    nvs_close(handle);
+}
+
+static esp_err_t save_to_nvs(void)
+{
+    esp_err_t err;
+
+    if (!s_watch.enabled) {
+        err = nvs_wb_erase(NVS_NAMESPACE_TOOLS, MOTION_NVS_KEY, NVS_WB_DEFERRED);
+    } else {
+        err = nvs_wb_set_blob(NVS_NAMESPACE_TOOLS, MOTION_NVS_KEY, &s_watch, sizeof(s_watch),
+                              NVS_WB_DEFERRED);
+    }
+    if (err == ESP_OK) {
+        err = nvs_wb_flush();
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to save motion watch: %s", esp_err_to_name(err));
+    }
+    return err;
+}
+
+bool motion_watch_set(bool enabled, motion_sensitivity_t sensitivity, const char *note)
+{
+    if (!s_mutex) {
+        return false;
+    }
+
+    lock();
+    motion_watch_t previous = s_watch;
+    memset(&s_watch, 0, sizeof(s_watch));
+    s_watch.enabled = enabled ? 1 : 0;
+    s_watch.sensitivity = (uint8_t)sensitivity;
+    if (note) {
+        strncpy(s_watch.note, note, sizeof(s_watch.note) - 1);
+    }
+    if (save_to_nvs() != ESP_OK) {
+        s_watch = previous;
+        unlock();
+        return false;
+    }
+    s_watch_changed = true;
+    unlock();
+    return true;
+}
+
+void motion_watch_describe(char *buf, size_t buf_len)
+{
+    if (!s_mutex) {
+        snprintf(buf, buf_len, "Motion watch unavailable");
+        return;
+    }
+
+    lock();
+    if (!s_watch.enabled) {
+        snprintf(buf, buf_len, "Motion watch is off");
+    } else {
+        snprintf(buf, buf_len, "Motion watch is on (%s sensitivity)%s%s",
+                 s_sensitivity_names[s_watch.sensitivity],
+                 s_watch.note[0] ? ": " : "", s_watch.note);
+    }
+    unlock();
+}
+
+bool motion_take_event_image(uint8_t **jpeg, size_t *jpeg_len)
+{
+    bool taken = false;
+
+    if (!s_mutex) {
+        return false;
+    }
+    lock();
+    if (s_event_jpeg) {
+        *jpeg = s_event_jpeg;
+        *jpeg_len = s_event_jpeg_len;
+        s_event_jpeg = NULL;
+        s_event_jpeg_len = 0;
+        taken = true;
+    }
+    unlock();
+    return taken;
+}
+
+// QQVGA JPEG decoded at half scale into s_gray. Skipped while a photo is
+// waiting to be sent or capture_photo holds the camera.
+static bool sample_gray(void)
+{
+    const cam_setting_t setting = { CAM_SIZE_QQVGA, MOTION_JPEG_QUALITY };
+    cam_frame_t frame;
+    bool ok = false;
+
+    if (!camera_lock(0)) {
+        return false;
+    }
+    if (!media_has_pending_image() && camera_apply_setting(setting) &&
+        camera_frame_get(&frame)) {
+        // s_rgb565 holds exactly one half-scale QQVGA frame; skip any other size.
+        if (frame.width == MOTION_FRAME_W * 2 && frame.height == MOTION_FRAME_H * 2) {
+            ok = jpg2rgb565(frame.buf, frame.len, s_rgb565, JPG_SCALE_2X);
+        }
+        camera_frame_release(&frame);
+    }
+    camera_unlock();
+
+    if (ok) {
+        motion_rgb565_to_gray(s_rgb565, MOTION_FRAME_W * MOTION_FRAME_H, s_gray);
+    }
+    return ok;
+}
+
+// One VGA photo of the event, copied out of the frame buffer so the camera
+// is free again while the message waits in the agent queue.
+static bool take_event_photo(void)
+{
+    const cam_setting_t setting = { CAM_SIZE_VGA, CAM_JPEG_QUALITY };
+    cam_frame_t frame;
+    size_t jpeg_len = 0;
+    uint8_t *copy = NULL;
+
+    lock();
+    bool busy = s_event_jpeg != NULL;
+    unlock();
+    if (busy || !camera_lock(1000)) {
+        return false;
+    }
+    if (camera_apply_setting(setting) && camera_frame_get(&frame)) {
+        jpeg_len = frame.len;
+#if ZCLAW_HAS_PSRAM
+        copy = heap_caps_malloc(jpeg_len, MALLOC_CAP_SPIRAM);
+#else
+        copy = malloc(jpeg_len);
+#endif
+        if (copy) {
+            memcpy(copy, frame.buf, jpeg_len);
+        }
+        camera_frame_release(&frame);
+    }
+    camera_unlock();
+    if (!copy) {
+        return false;
+    }
+
+    lock();
+    s_event_jpeg = copy;
+    s_event_jpeg_len = jpeg_len;
+    unlock();
+    return true;
+}
+
+static void report_event(const motion_result_t *result, const char *note)
+{
+    channel_msg_t msg;
+    char where[64];
+
+    motion_describe(result, where, sizeof(where));
+    bool photo = take_event_photo();
+    ESP_LOGI(TAG, "Motion: %s%s", where, photo ? "" : " (no photo)");
+
+    msg.chat_id = CHAT_ID_LOCAL;
+    msg.source = MSG_SOURCE_MOTION;
+    snprintf(msg.text, sizeof(msg.text), MOTION_MESSAGE_PREFIX "%s.%s %s", where,
+             photo ? " Photo attached." : "",
+             note[0] ? note : "Say briefly what changed.");
+
+    if (xQueueSend(s_agent_queue, &msg, pdMS_TO_TICKS(100)) != pdTRUE) {
+        ESP_LOGW(TAG, "Agent queue full, motion event dropped");
+        uint8_t *jpeg = NULL;
+        size_t jpeg_len = 0;
+        if (photo && motion_take_event_image(&jpeg, &jpeg_len)) {
+            free(jpeg);
+        }
+    }
+}
+
+static void motion_task(void *arg)
+{
+    char note[MOTION_NOTE_MAX_LEN];
+    bool enabled = false;
+
+    (void)arg;
+    while (1) {
+        vTaskDelay(pdMS_TO_TICKS(MOTION_SAMPLE_MS));
+
+        lock();
+        if (s_watch_changed) {
+            // New setting: start over with a fresh background.
+            motion_detector_init(&s_detector, (motion_sensitivity_t)s_watch.sensitivity);
+            s_watch_changed = false;
+        }
+        enabled = s_watch.enabled;
+        memcpy(note, s_watch.note, sizeof(note));
+        unlock();
+
+        if (!enabled || !sample_gray()) {
+            continue;
+        }
+
+        motion_result_t result;
+        motion_detector_feed(&s_detector, s_gray, esp_timer_get_time() / 1000, &result);
+        if (result.event) {
+            report_event(&result, note);
+        }
+    }
+}
+
+esp_err_t motion_start(QueueHandle_t agent_input_queue)
+{
+    if (!agent_input_queue) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    s_agent_queue = agent_input_queue;
+
+    s_mutex = xSemaphoreCreateMutex();
+    if (!s_mutex) {
+        return ESP_ERR_NO_MEM;
+    }
+    load_from_nvs();
+    s_watch_changed = true;
+
+    if (xTaskCreate(motion_task, "motion", MOTION_TASK_STACK_SIZE, NULL,
+                    MOTION_TASK_PRIORITY, NULL) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create motion task");
+        return ESP_ERR_NO_MEM;
+    }
+
+    ESP_LOGI(TAG, "Motion watch %s", s_watch.enabled ? "on" : "off");
+    return ESP_OK;
+}
+
+#endif // ZCLAW_HAS_CAMERA
@@ -0,0 +1,35 @@
+#ifndef MOTION_H
+#define MOTION_H
+
+#include "config.h"
+
+#if ZCLAW_HAS_CAMERA
+
+#include "motion_detect.h"
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Motion watch: a low-priority task samples small grayscale frames every
+// MOTION_SAMPLE_MS and, on a change, takes one photo and queues a
+// MOTION_MESSAGE_PREFIX message for the agent. Nothing reaches the LLM
+// while the scene is still.
+
+// Load the saved watch setting and start the sampler task.
+esp_err_t motion_start(QueueHandle_t agent_input_queue);
+
+// Turn watching on or off. note (may be NULL) is sent with each event, e.g.
+// "tell me if someone enters the room". Saved across reboots.
+bool motion_watch_set(bool enabled, motion_sensitivity_t sensitivity, const char *note);
+
+// One-line description of the current setting.
+void motion_watch_describe(char *buf, size_t buf_len);
+
+// Hand over the photo of the last event (caller frees). False if none.
+bool motion_take_event_image(uint8_t **jpeg, size_t *jpeg_len);
+
+#endif // ZCLAW_HAS_CAMERA
+#endif // MOTION_H
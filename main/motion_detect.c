@@ -0,0 +1,200 @@
+#include "motion_detect.h"
+#include <stdio.h>
+#include <string.h>
+
+// The SAD kernel splits each 32-bit word into two pairs of 16-bit lanes
+// (even and odd bytes), so four pixel differences are taken per step with
+// no lane borrowing into its neighbour.
+#define LANE_LO     0x00FF00FFu
+#define LANE_ONE    0x00010001u
+#define LANE_BIAS   0x01000100u
+
+// Lanes accumulate at most 2 * 255 per word; 128 words stay under 65536.
+#define SAD_WORDS_PER_FLUSH 128
+
+static const struct {
+    uint8_t pixel_threshold;
+    uint8_t min_blocks;
+} s_sensitivity[] = {
+    [MOTION_SENSITIVITY_LOW]    = { 24, 4 },
+    [MOTION_SENSITIVITY_MEDIUM] = { 16, 2 },
+    [MOTION_SENSITIVITY_HIGH]   = { 10, 1 },
+};
+
+// |a - b| in each 16-bit lane; a and b hold one byte per lane.
+static inline uint32_t lane_absdiff(uint32_t a, uint32_t b)
+{
+    uint32_t d = (a + LANE_BIAS) - b;               // 256 + a - b, never negative
+    uint32_t neg = (((d >> 8) & LANE_ONE) ^ LANE_ONE) * 0xFFu;
+
+    return ((d & LANE_LO) ^ neg) + (neg & LANE_ONE);
+}
+
+uint32_t motion_sad(const uint8_t *a, const uint8_t *b, size_t n)
+{
+    uint32_t total = 0;
+    size_t i = 0;
+
+    while (n - i >= 4) {
+        size_t words = (n - i) / 4;
+        uint32_t acc = 0;
+
+        if (words > SAD_WORDS_PER_FLUSH) {
+            words = SAD_WORDS_PER_FLUSH;
+        }
+        for (size_t w = 0; w < words; w++, i += 4) {
+            uint32_t wa;
+            uint32_t wb;
+            memcpy(&wa, a + i, sizeof(wa));
+            memcpy(&wb, b + i, sizeof(wb));
+            acc += lane_absdiff(wa & LANE_LO, wb & LANE_LO);
+            acc += lane_absdiff((wa >> 8) & LANE_LO, (wb >> 8) & LANE_LO);
+        }
+        total += (acc & 0xFFFFu) + (acc >> 16);
+    }
+    for (; i < n; i++) {
+        total += a[i] > b[i] ? (uint32_t)(a[i] - b[i]) : (uint32_t)(b[i] - a[i]);
+    }
+    return total;
+}
+
+void motion_block_sad(const uint8_t *a, const uint8_t *b, uint32_t *sads)
+{
+    memset(sads, 0, sizeof(uint32_t) * MOTION_BLOCK_COUNT);
+
+    for (int y = 0; y < MOTION_BLOCK_ROWS * MOTION_BLOCK_SIZE; y++) {
+        uint32_t *row = sads + (y / MOTION_BLOCK_SIZE) * MOTION_BLOCK_COLS;
+        const uint8_t *pa = a + (size_t)y * MOTION_FRAME_W;
+        const uint8_t *pb = b + (size_t)y * MOTION_FRAME_W;
+
+        for (int col = 0; col < MOTION_BLOCK_COLS; col++) {
+            row[col] += motion_sad(pa + col * MOTION_BLOCK_SIZE, pb + col * MOTION_BLOCK_SIZE,
+                                   MOTION_BLOCK_SIZE);
+        }
+    }
+}
+
+void motion_rgb565_to_gray(const uint8_t *rgb565, size_t pixels, uint8_t *gray)
+{
+    for (size_t i = 0; i < pixels; i++) {
+        uint32_t c = ((uint32_t)rgb565[2 * i] << 8) | rgb565[2 * i + 1];
+        uint32_t r = (c >> 11) & 0x1F;
+        uint32_t g = (c >> 5) & 0x3F;
+        uint32_t b = c & 0x1F;
+
+        r = (r << 3) | (r >> 2);
+        g = (g << 2) | (g >> 4);
+        b = (b << 3) | (b >> 2);
+        gray[i] = (uint8_t)((77 * r + 150 * g + 29 * b) >> 8);
+    }
+}
+
+bool motion_sensitivity_parse(const char *text, motion_sensitivity_t *out)
+{
+    static const char *const names[] = { "low", "medium", "high" };
+
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+        if (text && strcmp(text, names[i]) == 0) {
+            *out = (motion_sensitivity_t)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+void motion_detector_init(motion_detector_t *det, motion_sensitivity_t sensitivity)
+{
+    memset(det, 0, sizeof(*det));
+    if (sensitivity > MOTION_SENSITIVITY_HIGH) {
+        sensitivity = MOTION_SENSITIVITY_MEDIUM;
+    }
+    det->pixel_threshold = s_sensitivity[sensitivity].pixel_threshold;
+    det->min_blocks = s_sensitivity[sensitivity].min_blocks;
+}
+
+void motion_detector_feed(motion_detector_t *det, const uint8_t *gray, int64_t now_ms,
+                          motion_result_t *out)
+{
+    uint32_t sads[MOTION_BLOCK_COUNT];
+    uint32_t limit = (uint32_t)det->pixel_threshold * MOTION_BLOCK_SIZE * MOTION_BLOCK_SIZE;
+
+    memset(out, 0, sizeof(*out));
+    if (!det->primed) {
+        memcpy(det->background, gray, sizeof(det->background));
+        det->primed = true;
+        return;
+    }
+
+    motion_block_sad(det->background, gray, sads);
+    out->min_col = MOTION_BLOCK_COLS;
+    out->min_row = MOTION_BLOCK_ROWS;
+    out->max_col = -1;
+    out->max_row = -1;
+    for (int i = 0; i < MOTION_BLOCK_COUNT; i++) {
+        if (sads[i] <= limit) {
+            continue;
+        }
+        int col = i % MOTION_BLOCK_COLS;
+        int row = i / MOTION_BLOCK_COLS;
+        out->changed_blocks++;
+        out->min_col = col < out->min_col ? col : out->min_col;
+        out->max_col = col > out->max_col ? col : out->max_col;
+        out->min_row = row < out->min_row ? row : out->min_row;
+        out->max_row = row > out->max_row ? row : out->max_row;
+    }
+    if (out->changed_blocks == 0) {
+        out->min_col = out->max_col = out->min_row = out->max_row = 0;
+    }
+
+    if (out->changed_blocks >= det->min_blocks && now_ms >= det->quiet_until_ms) {
+        out->event = true;
+        det->quiet_until_ms = now_ms + MOTION_COOLDOWN_MS;
+    }
+
+    // The background takes a quarter of each frame, so slow light changes
+    // fade in within a few samples while a person walking in still stands out.
+    for (size_t i = 0; i < sizeof(det->background); i++) {
+        det->background[i] = (uint8_t)((det->background[i] * 3u + gray[i] + 2u) >> 2);
+    }
+}
+
+static const char *third_name(int center2, int count, const char *low, const char *mid,
+                              const char *high)
+{
+    // center2 is twice the bounding box centre, in blocks.
+    if (center2 * 3 < count * 2) {
+        return low;
+    }
+    return center2 * 3 >= count * 4 ? high : mid;
+}
+
+void motion_describe(const motion_result_t *result, char *buf, size_t buf_len)
+{
+    const char *where;
+    char place[32];
+
+    if (result->changed_blocks == 0) {
+        snprintf(buf, buf_len, "no change");
+        return;
+    }
+
+    int width = result->max_col - result->min_col + 1;
+    int height = result->max_row - result->min_row + 1;
+    if (width * 3 >= MOTION_BLOCK_COLS * 2 && height * 3 >= MOTION_BLOCK_ROWS * 2) {
+        where = "across the frame";
+    } else {
+        const char *vertical = third_name(result->min_row + result->max_row + 1,
+                                          MOTION_BLOCK_ROWS, "upper", "middle", "lower");
+        const char *horizontal = third_name(result->min_col + result->max_col + 1,
+                                            MOTION_BLOCK_COLS, "left", "center", "right");
+        if (strcmp(vertical, "middle") == 0) {
+            snprintf(place, sizeof(place), "%s", horizontal);
+        } else {
+            snprintf(place, sizeof(place), "%s %s", vertical, horizontal);
+        }
+        where = place;
+    }
+
+    snprintf(buf, buf_len, "%d of %d areas changed, %s", result->changed_blocks,
+             MOTION_BLOCK_COUNT, where);
+}
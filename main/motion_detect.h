@@ -0,0 +1,61 @@
+#ifndef MOTION_DETECT_H
+#define MOTION_DETECT_H
+
+#include "config.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Change detection on small grayscale frames (MOTION_FRAME_W x
+// MOTION_FRAME_H). Each frame is compared block by block against a slowly
+// adapting background; enough changed blocks make an event.
+
+#define MOTION_BLOCK_COLS   (MOTION_FRAME_W / MOTION_BLOCK_SIZE)
+#define MOTION_BLOCK_ROWS   (MOTION_FRAME_H / MOTION_BLOCK_SIZE)
+#define MOTION_BLOCK_COUNT  (MOTION_BLOCK_COLS * MOTION_BLOCK_ROWS)
+
+typedef enum {
+    MOTION_SENSITIVITY_LOW = 0,
+    MOTION_SENSITIVITY_MEDIUM,
+    MOTION_SENSITIVITY_HIGH,
+} motion_sensitivity_t;
+
+typedef struct {
+    uint8_t background[MOTION_FRAME_W * MOTION_FRAME_H];
+    bool primed;
+    uint8_t pixel_threshold;        // Mean per-pixel difference for a block to count
+    uint8_t min_blocks;             // Changed blocks that make an event
+    int64_t quiet_until_ms;         // No events before this (cooldown)
+} motion_detector_t;
+
+typedef struct {
+    bool event;
+    int changed_blocks;
+    int min_col, max_col;           // Bounding box of changed blocks
+    int min_row, max_row;
+} motion_result_t;
+
+// Sum of absolute differences of n bytes, four at a time in 32-bit words.
+uint32_t motion_sad(const uint8_t *a, const uint8_t *b, size_t n);
+
+// Per-block SADs of two frames, row-major, MOTION_BLOCK_COUNT entries.
+void motion_block_sad(const uint8_t *a, const uint8_t *b, uint32_t *sads);
+
+// Luma from big-endian RGB565 pixels, as the JPEG decoder writes them.
+void motion_rgb565_to_gray(const uint8_t *rgb565, size_t pixels, uint8_t *gray);
+
+// Parse "low", "medium" or "high".
+bool motion_sensitivity_parse(const char *text, motion_sensitivity_t *out);
+
+void motion_detector_init(motion_detector_t *det, motion_sensitivity_t sensitivity);
+
+// Compare gray against the background, then fold it in. The first frame
+// only primes the background. Events within MOTION_COOLDOWN_MS of the last
+// one are reported as changes but not as events.
+void motion_detector_feed(motion_detector_t *det, const uint8_t *gray, int64_t now_ms,
+                          motion_result_t *out);
+
+// "9 of 48 areas changed, upper left" style summary.
+void motion_describe(const motion_result_t *result, char *buf, size_t buf_len);
+
+#endif // MOTION_DETECT_H
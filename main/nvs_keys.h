@@ -10,10 +10,14 @@
 #define NVS_KEY_LLM_MODEL    "llm_model"
 #define NVS_KEY_TG_TOKEN     "tg_token"
 #define NVS_KEY_TG_CHAT_ID   "tg_chat_id"
+#define NVS_KEY_TG_API_URL   "tg_api_url"
+#define NVS_KEY_TG_WH_SECRET "tg_wh_secret"
 #define NVS_KEY_TIMEZONE     "timezone"
 
 // Rate-limit bookkeeping keys.
-#define NVS_KEY_RL_DAILY     "rl_daily"
-#define NVS_KEY_RL_DAY       "rl_day"
+#define NVS_KEY_RL_STATE     "rl_state"
+// Old request counters, deleted on boot.
+#define NVS_KEY_RL_DAILY_LEGACY "rl_daily"
+#define NVS_KEY_RL_DAY_LEGACY   "rl_day"
 
 #endif // NVS_KEYS_H
@@ -0,0 +1,428 @@
+#include "nvs_wb.h"
+#include "config.h"
+#include "esp_log.h"
+#include <stdlib.h>
+#include <string.h>
+
+static const char *TAG = "nvs_wb";
+
+static nvs_wb_backend_t s_backend;
+static bool s_have_backend = false;
+static uint32_t s_flush_interval_ms = NVS_WB_FLUSH_INTERVAL_MS;
+static size_t s_flush_threshold = NVS_WB_FLUSH_THRESHOLD;
+static nvs_wb_item_t s_items[NVS_WB_MAX_ITEMS];
+static nvs_wb_stats_t s_stats;
+
+static void wb_lock(void)
+{
+    if (s_backend.lock) {
+        s_backend.lock(s_backend.ctx);
+    }
+}
+
+static void wb_unlock(void)
+{
+    if (s_backend.unlock) {
+        s_backend.unlock(s_backend.ctx);
+    }
+}
+
+static uint32_t wb_now_ms(void)
+{
+    return s_backend.now_ms ? s_backend.now_ms(s_backend.ctx) : 0;
+}
+
+static void release_item(nvs_wb_item_t *item)
+{
+    free(item->data);
+    memset(item, 0, sizeof(*item));
+}
+
+static size_t dirty_count_locked(void)
+{
+    size_t count = 0;
+    for (size_t i = 0; i < NVS_WB_MAX_ITEMS; i++) {
+        if (s_items[i].used) {
+            count++;
+        }
+    }
+    return count;
+}
+
+static nvs_wb_item_t *find_item(const char *ns, const char *key)
+{
+    for (size_t i = 0; i < NVS_WB_MAX_ITEMS; i++) {
+        if (s_items[i].used && strcmp(s_items[i].ns, ns) == 0 &&
+            strcmp(s_items[i].key, key) == 0) {
+            return &s_items[i];
+        }
+    }
+    return NULL;
+}
+
+static nvs_wb_item_t *find_free_item(void)
+{
+    for (size_t i = 0; i < NVS_WB_MAX_ITEMS; i++) {
+        if (!s_items[i].used) {
+            return &s_items[i];
+        }
+    }
+    return NULL;
+}
+
+// Write every pending item of one namespace in a single open/commit.
+static esp_err_t flush_namespace_locked(const char *ns, bool *done)
+{
+    bool written[NVS_WB_MAX_ITEMS] = {false};
+    size_t written_count = 0;
+    uint32_t handle = 0;
+    esp_err_t result = ESP_OK;
+
+    esp_err_t err = s_backend.open(ns, &handle, s_backend.ctx);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to open namespace %s: %s", ns, esp_err_to_name(err));
+        for (size_t i = 0; i < NVS_WB_MAX_ITEMS; i++) {
+            if (s_items[i].used && strcmp(s_items[i].ns, ns) == 0) {
+                s_items[i].failures++;
+                s_items[i].dirty_since_ms = wb_now_ms();
+                done[i] = true;
+            }
+        }
+        s_stats.write_errors++;
+        return err;
+    }
+
+    for (size_t i = 0; i < NVS_WB_MAX_ITEMS; i++) {
+        nvs_wb_item_t *item = &s_items[i];
+        if (!item->used || strcmp(item->ns, ns) != 0) {
+            continue;
+        }
+        done[i] = true;
+        err = s_backend.write(handle, item, s_backend.ctx);
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to write %s/%s: %s", ns, item->key, esp_err_to_name(err));
+            item->failures++;
+            item->dirty_since_ms = wb_now_ms();
+            s_stats.write_errors++;
+            result = err;
+            continue;
+        }
+        written[i] = true;
+        written_count++;
+    }
+
+    err = s_backend.commit(handle, s_backend.ctx);
+    s_stats.commits++;
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to commit namespace %s: %s", ns, esp_err_to_name(err));
+        s_stats.write_errors++;
+        for (size_t i = 0; i < NVS_WB_MAX_ITEMS; i++) {
+            if (written[i]) {
+                s_items[i].failures++;
+                s_items[i].dirty_since_ms = wb_now_ms();
+            }
+        }
+        return err;
+    }
+
+    for (size_t i = 0; i < NVS_WB_MAX_ITEMS; i++) {
+        if (written[i]) {
+            release_item(&s_items[i]);
+        }
+    }
+    s_stats.items_written += (uint32_t)written_count;
+    return result;
+}
+
+static esp_err_t flush_locked(void)
+{
+    bool done[NVS_WB_MAX_ITEMS] = {false};
+    esp_err_t result = ESP_OK;
+    bool any = false;
+
+    if (!s_have_backend) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    for (size_t i = 0; i < NVS_WB_MAX_ITEMS; i++) {
+        if (!s_items[i].used || done[i]) {
+            continue;
+        }
+        any = true;
+        esp_err_t err = flush_namespace_locked(s_items[i].ns, done);
+        if (err != ESP_OK) {
+            result = err;
+        }
+    }
+
+    // A key that keeps failing (e.g. namespace full) must not pin a slot forever.
+    for (size_t i = 0; i < NVS_WB_MAX_ITEMS; i++) {
+        if (s_items[i].used && s_items[i].failures >= NVS_WB_MAX_FAILURES) {
+            ESP_LOGE(TAG, "Dropping %s/%s after %d failed flushes",
+                     s_items[i].ns, s_items[i].key, s_items[i].failures);
+            release_item(&s_items[i]);
+            s_stats.dropped++;
+        }
+    }
+
+    if (any) {
+        s_stats.flushes++;
+    }
+    return result;
+}
+
+// Used when the cache cannot take the value (table full or out of memory).
+static esp_err_t write_through_locked(const char *ns, const char *key, nvs_wb_kind_t kind,
+                                      const void *data, size_t len)
+{
+    nvs_wb_item_t item;
+    uint32_t handle = 0;
+
+    memset(&item, 0, sizeof(item));
+    item.ns = ns;
+    strncpy(item.key, key, sizeof(item.key) - 1);
+    item.kind = kind;
+    item.data = (uint8_t *)data;
+    item.len = len;
+    item.used = true;
+
+    esp_err_t err = s_backend.open(ns, &handle, s_backend.ctx);
+    if (err != ESP_OK) {
+        s_stats.write_errors++;
+        return err;
+    }
+    err = s_backend.write(handle, &item, s_backend.ctx);
+    esp_err_t commit_err = s_backend.commit(handle, s_backend.ctx);
+    s_stats.commits++;
+    if (err == ESP_OK) {
+        err = commit_err;
+    }
+    if (err != ESP_OK) {
+        s_stats.write_errors++;
+    } else {
+        s_stats.items_written++;
+    }
+    return err;
+}
+
+static esp_err_t enqueue(const char *ns, const char *key, nvs_wb_kind_t kind,
+                         const void *data, size_t len, uint8_t flags)
+{
+    uint8_t *copy = NULL;
+    bool over_threshold;
+    esp_err_t err = ESP_OK;
+
+    if (!s_have_backend) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (!ns || !key || key[0] == '\0' || strlen(key) >= NVS_WB_KEY_LEN ||
+        (kind != NVS_WB_KIND_ERASE && !data)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (kind != NVS_WB_KIND_ERASE) {
+        copy = malloc(len > 0 ? len : 1);
+        if (copy) {
+            memcpy(copy, data, len);
+        }
+    }
+
+    wb_lock();
+    s_stats.queued++;
+
+    nvs_wb_item_t *item = find_item(ns, key);
+    if (item) {
+        s_stats.coalesced++;
+    } else {
+        item = find_free_item();
+        if (!item) {
+            flush_locked();
+            item = find_free_item();
+        }
+    }
+
+    if (!item || (kind != NVS_WB_KIND_ERASE && !copy)) {
+        // No room to defer: keep the value durable by writing it now. A stale
+        // pending copy of the same key must not be flushed over it later.
+        if (item && item->used) {
+            release_item(item);
+        }
+        err = write_through_locked(ns, key, kind, data, len);
+        wb_unlock();
+        free(copy);
+        return err;
+    }
+
+    if (!item->used) {
+        item->used = true;
+        item->ns = ns;
+        strncpy(item->key, key, sizeof(item->key) - 1);
+        item->key[sizeof(item->key) - 1] = '\0';
+        item->dirty_since_ms = wb_now_ms();
+    } else {
+        free(item->data);
+    }
+    item->kind = kind;
+    item->data = copy;
+    item->len = copy ? len : 0;
+    item->failures = 0;
+
+    over_threshold = dirty_count_locked() >= s_flush_threshold;
+    if (flags & NVS_WB_DURABLE) {
+        err = flush_locked();
+    } else if (over_threshold && !s_backend.kick) {
+        flush_locked();
+    }
+    wb_unlock();
+
+    if (!(flags & NVS_WB_DURABLE) && over_threshold && s_backend.kick) {
+        s_backend.kick(s_backend.ctx);
+    }
+    return err;
+}
+
+void nvs_wb_init(const nvs_wb_backend_t *backend, uint32_t flush_interval_ms,
+                 size_t flush_threshold)
+{
+    for (size_t i = 0; i < NVS_WB_MAX_ITEMS; i++) {
+        if (s_items[i].used) {
+            release_item(&s_items[i]);
+        }
+    }
+    memset(&s_stats, 0, sizeof(s_stats));
+
+    if (backend && backend->open && backend->write && backend->commit) {
+        s_backend = *backend;
+        s_have_backend = true;
+    } else {
+        memset(&s_backend, 0, sizeof(s_backend));
+        s_have_backend = false;
+    }
+    s_flush_interval_ms = flush_interval_ms;
+    s_flush_threshold = flush_threshold > 0 ? flush_threshold : 1;
+}
+
+void nvs_wb_discard(void)
+{
+    wb_lock();
+    for (size_t i = 0; i < NVS_WB_MAX_ITEMS; i++) {
+        if (s_items[i].used) {
+            release_item(&s_items[i]);
+        }
+    }
+    wb_unlock();
+}
+
+esp_err_t nvs_wb_set_str(const char *ns, const char *key, const char *value, uint8_t flags)
+{
+    if (!value) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return enqueue(ns, key, NVS_WB_KIND_STR, value, strlen(value) + 1, flags);
+}
+
+esp_err_t nvs_wb_set_blob(const char *ns, const char *key, const void *data, size_t len,
+                          uint8_t flags)
+{
+    return enqueue(ns, key, NVS_WB_KIND_BLOB, data, len, flags);
+}
+
+esp_err_t nvs_wb_set_u8(const char *ns, const char *key, uint8_t value, uint8_t flags)
+{
+    return enqueue(ns, key, NVS_WB_KIND_U8, &value, sizeof(value), flags);
+}
+
+esp_err_t nvs_wb_erase(const char *ns, const char *key, uint8_t flags)
+{
+    return enqueue(ns, key, NVS_WB_KIND_ERASE, NULL, 0, flags);
+}
+
+nvs_wb_lookup_t nvs_wb_lookup(const char *ns, const char *key, nvs_wb_kind_t *kind,
+                              void *buf, size_t *len)
+{
+    nvs_wb_lookup_t result = NVS_WB_LOOKUP_MISS;
+
+    if (!ns || !key) {
+        return NVS_WB_LOOKUP_MISS;
+    }
+
+    wb_lock();
+    const nvs_wb_item_t *item = find_item(ns, key);
+    if (item) {
+        if (kind) {
+            *kind = item->kind;
+        }
+        if (item->kind == NVS_WB_KIND_ERASE) {
+            result = NVS_WB_LOOKUP_ERASED;
+        } else if (!buf || !len || *len < item->len) {
+            result = NVS_WB_LOOKUP_TOO_SMALL;
+            if (len) {
+                *len = item->len;
+            }
+        } else {
+            memcpy(buf, item->data, item->len);
+            *len = item->len;
+            result = NVS_WB_LOOKUP_HIT;
+        }
+    }
+    wb_unlock();
+    return result;
+}
+
+esp_err_t nvs_wb_flush(void)
+{
+    wb_lock();
+    esp_err_t err = flush_locked();
+    wb_unlock();
+    return err;
+}
+
+uint32_t nvs_wb_tick(void)
+{
+    uint32_t wait_ms = UINT32_MAX;
+
+    wb_lock();
+    uint32_t now = wb_now_ms();
+    bool due = false;
+    for (size_t i = 0; i < NVS_WB_MAX_ITEMS; i++) {
+        if (s_items[i].used && now - s_items[i].dirty_since_ms >= s_flush_interval_ms) {
+            due = true;
+            break;
+        }
+    }
+    if (due) {
+        flush_locked();
+    }
+
+    // Failed items were re-stamped, so they retry one interval later.
+    for (size_t i = 0; i < NVS_WB_MAX_ITEMS; i++) {
+        if (!s_items[i].used) {
+            continue;
+        }
+        uint32_t age = now - s_items[i].dirty_since_ms;
+        uint32_t remaining = age >= s_flush_interval_ms ? 0 : s_flush_interval_ms - age;
+        if (remaining < wait_ms) {
+            wait_ms = remaining;
+        }
+    }
+    wb_unlock();
+    return wait_ms;
+}
+
+size_t nvs_wb_dirty_count(void)
+{
+    wb_lock();
+    size_t count = dirty_count_locked();
+    wb_unlock();
+    return count;
+}
+
+void nvs_wb_get_stats(nvs_wb_stats_t *stats)
+{
+    if (!stats) {
+        return;
+    }
+    wb_lock();
+    *stats = s_stats;
+    wb_unlock();
+}
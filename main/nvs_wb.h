@@ -0,0 +1,98 @@
+#ifndef NVS_WB_H
+#define NVS_WB_H
+
+#include "esp_err.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Write-behind cache for NVS. Setters only record the value in RAM; dirty
+// keys are coalesced (the last write per namespace/key wins) and written in
+// one open/commit per namespace when the flush interval expires, when the
+// dirty count reaches a threshold, when a caller asks for durability, or
+// before a restart. Reads through nvs_wb_lookup() see pending values.
+//
+// The core holds no NVS, FreeRTOS or timer dependencies: memory.c supplies a
+// backend that maps onto nvs_* calls and runs the periodic flush.
+
+#define NVS_WB_KEY_LEN      16      // NVS key limit (15 chars) + terminator
+
+// Setter flags
+#define NVS_WB_DEFERRED     0x00    // Coalesce and flush later
+#define NVS_WB_DURABLE      0x01    // Flush everything pending before returning
+
+typedef enum {
+    NVS_WB_KIND_STR,
+    NVS_WB_KIND_BLOB,
+    NVS_WB_KIND_U8,
+    NVS_WB_KIND_ERASE,
+} nvs_wb_kind_t;
+
+typedef struct {
+    const char *ns;                 // Namespace; must outlive the entry (string literal)
+    char key[NVS_WB_KEY_LEN];
+    nvs_wb_kind_t kind;
+    uint8_t *data;                  // STR includes the terminator
+    size_t len;
+    uint32_t dirty_since_ms;        // When the key first became dirty
+    uint8_t failures;               // Consecutive failed flush attempts
+    bool used;
+} nvs_wb_item_t;
+
+typedef struct {
+    // One namespace batch: open, write each item, commit+close.
+    esp_err_t (*open)(const char *ns, uint32_t *handle, void *ctx);
+    esp_err_t (*write)(uint32_t handle, const nvs_wb_item_t *item, void *ctx);
+    esp_err_t (*commit)(uint32_t handle, void *ctx);   // Also closes the handle
+    uint32_t (*now_ms)(void *ctx);
+    void (*lock)(void *ctx);                           // Optional
+    void (*unlock)(void *ctx);                         // Optional
+    void (*kick)(void *ctx);    // Optional: wake the flusher (threshold hit); else flush inline
+    void *ctx;
+} nvs_wb_backend_t;
+
+typedef struct {
+    uint32_t queued;            // Setter calls accepted
+    uint32_t coalesced;         // Setter calls that replaced a pending value
+    uint32_t flushes;           // Flush passes that wrote at least one item
+    uint32_t items_written;     // Items committed to flash
+    uint32_t commits;           // Namespace commits issued
+    uint32_t write_errors;
+    uint32_t dropped;           // Items abandoned after repeated failures
+} nvs_wb_stats_t;
+
+typedef enum {
+    NVS_WB_LOOKUP_MISS,         // Not pending; read NVS
+    NVS_WB_LOOKUP_HIT,          // Pending value copied out
+    NVS_WB_LOOKUP_ERASED,       // Pending erase; treat as not found
+    NVS_WB_LOOKUP_TOO_SMALL,    // Pending value does not fit the buffer
+} nvs_wb_lookup_t;
+
+// Install a backend and flush policy. Discards anything pending.
+void nvs_wb_init(const nvs_wb_backend_t *backend, uint32_t flush_interval_ms,
+                 size_t flush_threshold);
+
+esp_err_t nvs_wb_set_str(const char *ns, const char *key, const char *value, uint8_t flags);
+esp_err_t nvs_wb_set_blob(const char *ns, const char *key, const void *data, size_t len,
+                          uint8_t flags);
+esp_err_t nvs_wb_set_u8(const char *ns, const char *key, uint8_t value, uint8_t flags);
+esp_err_t nvs_wb_erase(const char *ns, const char *key, uint8_t flags);
+
+// Copy a pending value for (ns, key). *len is the buffer size in, value size out.
+nvs_wb_lookup_t nvs_wb_lookup(const char *ns, const char *key, nvs_wb_kind_t *kind,
+                              void *buf, size_t *len);
+
+// Write and commit everything pending. Failed items stay queued for a retry.
+esp_err_t nvs_wb_flush(void);
+
+// Drop everything pending without writing it (e.g. before erasing NVS).
+void nvs_wb_discard(void);
+
+// Flush if the oldest dirty key has waited flush_interval_ms. Returns ms until
+// the next timed flush is due (UINT32_MAX when nothing is pending).
+uint32_t nvs_wb_tick(void);
+
+size_t nvs_wb_dirty_count(void);
+void nvs_wb_get_stats(nvs_wb_stats_t *stats);
+
+#endif // NVS_WB_H
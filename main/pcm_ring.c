@@ -0,0 +1,121 @@
+#include "pcm_ring.h"
+#include <string.h>
+
+// How far back readers can reach without meeting slots the writer may be
+// filling.
+static uint32_t reach(const pcm_ring_t *ring)
+{
+    return ring->capacity - ring->guard;
+}
+
+static uint32_t load_written(const pcm_ring_t *ring)
+{
+    return __atomic_load_n(&ring->written, __ATOMIC_ACQUIRE);
+}
+
+// Samples behind written that still hold audio.
+static uint32_t history(const pcm_ring_t *ring, uint32_t written)
+{
+    if (__atomic_load_n(&ring->full, __ATOMIC_RELAXED) || written >= reach(ring)) {
+        return reach(ring);
+    }
+    return written;
+}
+
+void pcm_ring_init(pcm_ring_t *ring, int16_t *buf, uint32_t capacity, uint32_t guard)
+{
+    ring->buf = buf;
+    ring->capacity = capacity;
+    ring->guard = guard;
+    ring->written = 0;
+    ring->full = false;
+}
+
+int16_t *pcm_ring_write_ptr(pcm_ring_t *ring, size_t *room)
+{
+    uint32_t index = ring->written & (ring->capacity - 1);
+    uint32_t contiguous = ring->capacity - index;
+
+    *room = contiguous < ring->guard ? contiguous : ring->guard;
+    return ring->buf + index;
+}
+
+void pcm_ring_commit(pcm_ring_t *ring, size_t n)
+{
+    uint32_t written = ring->written + (uint32_t)n;
+
+    // Set before publishing the position that makes it true, so a reader
+    // seeing a wrapped position also sees the flag.
+    if (!ring->full && written >= reach(ring)) {
+        __atomic_store_n(&ring->full, true, __ATOMIC_RELAXED);
+    }
+    __atomic_store_n(&ring->written, written, __ATOMIC_RELEASE);
+}
+
+void pcm_ring_write(pcm_ring_t *ring, const int16_t *samples, size_t n)
+{
+    while (n > 0) {
+        size_t room;
+        int16_t *dst = pcm_ring_write_ptr(ring, &room);
+        size_t take = n < room ? n : room;
+
+        memcpy(dst, samples, take * sizeof(int16_t));
+        pcm_ring_commit(ring, take);
+        samples += take;
+        n -= take;
+    }
+}
+
+void pcm_ring_open(const pcm_ring_t *ring, pcm_ring_reader_t *reader, uint32_t preroll)
+{
+    uint32_t written = load_written(ring);
+    uint32_t held = history(ring, written);
+
+    reader->pos = written - (preroll < held ? preroll : held);
+    reader->dropped = 0;
+}
+
+size_t pcm_ring_available(const pcm_ring_t *ring, const pcm_ring_reader_t *reader)
+{
+    uint32_t written = load_written(ring);
+    uint32_t behind = written - reader->pos;
+    uint32_t held = history(ring, written);
+
+    return behind < held ? behind : held;
+}
+
+size_t pcm_ring_read(const pcm_ring_t *ring, pcm_ring_reader_t *reader, int16_t *out, size_t max)
+{
+    for (;;) {
+        uint32_t written = load_written(ring);
+        uint32_t behind = written - reader->pos;
+        uint32_t held = history(ring, written);
+
+        if (behind > held) {
+            reader->dropped += behind - held;
+            reader->pos = written - held;
+            behind = held;
+        }
+        size_t n = behind < max ? behind : max;
+        if (n == 0) {
+            return 0;
+        }
+
+        uint32_t index = reader->pos & (ring->capacity - 1);
+        size_t first = ring->capacity - index;
+        if (first > n) {
+            first = n;
+        }
+        memcpy(out, ring->buf + index, first * sizeof(int16_t));
+        memcpy(out + first, ring->buf, (n - first) * sizeof(int16_t));
+
+        // If the writer got within guard of what was copied meanwhile, the
+        // copy may mix old and new audio: drop it and catch up instead.
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        written = __atomic_load_n(&ring->written, __ATOMIC_RELAXED);
+        if (written - reader->pos <= reach(ring)) {
+            reader->pos += (uint32_t)n;
+            return n;
+        }
+    }
+}
@@ -0,0 +1,54 @@
+#ifndef PCM_RING_H
+#define PCM_RING_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Lock-free ring of 16-bit samples with one writer and any number of
+// readers. The writer (the microphone capture task) never waits: it keeps
+// overwriting the oldest audio. Each reader holds its own position, pulls at
+// its own pace, and skips ahead (counting the loss) if it falls more than
+// the ring behind. Positions count samples since the ring started and wrap
+// with uint32_t, which the power-of-two capacity divides.
+//
+// The writer fills slots in place before publishing them, so up to guard
+// samples past the published end may be half written. Readers keep clear
+// of those and recheck after copying, like a seqlock, so a read raced by
+// the writer is dropped rather than returned torn.
+
+typedef struct {
+    int16_t *buf;
+    uint32_t capacity;              // Samples, a power of two
+    uint32_t guard;                 // Most the writer fills before one commit
+    uint32_t written;               // Samples published; read and written atomically
+    bool full;                      // Has held capacity - guard samples (written may since wrap)
+} pcm_ring_t;
+
+typedef struct {
+    uint32_t pos;                   // Next sample to read
+    uint32_t dropped;               // Samples skipped after falling behind
+} pcm_ring_reader_t;
+
+// guard must be below capacity; readers can reach back capacity - guard.
+void pcm_ring_init(pcm_ring_t *ring, int16_t *buf, uint32_t capacity, uint32_t guard);
+
+// Writer: contiguous room at the write position, up to guard samples, for
+// a DMA or driver read to fill directly. Then commit what was filled.
+int16_t *pcm_ring_write_ptr(pcm_ring_t *ring, size_t *room);
+void pcm_ring_commit(pcm_ring_t *ring, size_t n);
+
+// Copy in and commit, in guard-sized pieces.
+void pcm_ring_write(pcm_ring_t *ring, const int16_t *samples, size_t n);
+
+// Start a reader preroll samples back from now, or as far back as the ring
+// still holds.
+void pcm_ring_open(const pcm_ring_t *ring, pcm_ring_reader_t *reader, uint32_t preroll);
+
+// Samples the reader can read now.
+size_t pcm_ring_available(const pcm_ring_t *ring, const pcm_ring_reader_t *reader);
+
+// Copy up to max samples. Returns how many; 0 when the reader has caught up.
+size_t pcm_ring_read(const pcm_ring_t *ring, pcm_ring_reader_t *reader, int16_t *out, size_t max);
+
+#endif // PCM_RING_H
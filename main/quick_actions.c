@@ -0,0 +1,187 @@
+#include "quick_actions.h"
+#include "nvs_wb.h"
+#include "esp_log.h"
+#include "nvs.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include <string.h>
+
+static const char *TAG = "quick_actions";
+
+// The whole list is one blob; it changes rarely and is small.
+#define QUICK_ACTIONS_NVS_KEY "qa_list"
+
+static quick_action_t s_actions[QUICK_ACTION_MAX];
+static int s_action_count = 0;
+static SemaphoreHandle_t s_mutex = NULL;
+
+static void lock(void)
+{
+    if (s_mutex) {
+        xSemaphoreTake(s_mutex, portMAX_DELAY);
+    }
+}
+
+static void unlock(void)
+{
+    if (s_mutex) {
+        xSemaphoreGive(s_mutex);
+    }
+}
+
+static esp_err_t save_to_nvs(void)
+{
+    esp_err_t err;
+
+    if (s_action_count == 0) {
+        err = nvs_wb_erase(NVS_NAMESPACE_TOOLS, QUICK_ACTIONS_NVS_KEY, NVS_WB_DEFERRED);
+    } else {
+        err = nvs_wb_set_blob(NVS_NAMESPACE_TOOLS, QUICK_ACTIONS_NVS_KEY, s_actions,
+                              sizeof(quick_action_t) * (size_t)s_action_count,
+                              NVS_WB_DEFERRED);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to queue quick actions: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    err = nvs_wb_flush();
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to commit quick actions: %s", esp_err_to_name(err));
+    }
+    return err;
+}
+
+static void load_from_nvs(void)
+{
+    nvs_handle_t handle;
+    if (nvs_open(NVS_NAMESPACE_TOOLS, NVS_READONLY, &handle) != ESP_OK) {
+        return;
+    }
+
+    size_t len = sizeof(s_actions);
+    if (nvs_get_blob(handle, QUICK_ACTIONS_NVS_KEY, s_actions, &len) == ESP_OK &&
+        len % sizeof(quick_action_t) == 0) {
+        s_action_count = (int)(len / sizeof(quick_action_t));
+    }
+    nvs_close(handle);
+
+    // Drop anything a newer allowlist no longer accepts.
+    int kept = 0;
+    for (int i = 0; i < s_action_count; i++) {
+        s_actions[i].label[QUICK_ACTION_LABEL_MAX_LEN - 1] = '\0';
+        s_actions[i].tool[TOOL_NAME_MAX_LEN - 1] = '\0';
+        s_actions[i].args[QUICK_ACTION_ARGS_MAX_LEN - 1] = '\0';
+        if (quick_action_tool_allowed(s_actions[i].tool)) {
+            s_actions[kept++] = s_actions[i];
+        } else {
+            ESP_LOGW(TAG, "Dropping quick action '%s' (%s)", s_actions[i].label,
+                     s_actions[i].tool);
+        }
+    }
+    s_action_count = kept;
+    ESP_LOGI(TAG, "Loaded %d quick actions", s_action_count);
+}
+
+void quick_actions_init(void)
+{
+    if (!s_mutex) {
+        s_mutex = xSemaphoreCreateMutex();
+    }
+    lock();
+    s_action_count = 0;
+    memset(s_actions, 0, sizeof(s_actions));
+    load_from_nvs();
+    unlock();
+}
+
+static int find_index(const char *label)
+{
+    for (int i = 0; i < s_action_count; i++) {
+        if (strcmp(s_actions[i].label, label) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+bool quick_actions_pin(const quick_action_t *action)
+{
+    quick_action_t previous_actions[QUICK_ACTION_MAX];
+    bool ok = false;
+
+    lock();
+    memcpy(previous_actions, s_actions, sizeof(previous_actions));
+    int previous_count = s_action_count;
+    int index = find_index(action->label);
+
+    if (index < 0 && s_action_count >= QUICK_ACTION_MAX) {
+        ESP_LOGW(TAG, "Max quick actions reached (%d)", QUICK_ACTION_MAX);
+    } else {
+        if (index < 0) {
+            index = s_action_count++;
+        }
+        s_actions[index] = *action;
+        ok = save_to_nvs() == ESP_OK;
+        if (!ok) {
+            memcpy(s_actions, previous_actions, sizeof(s_actions));
+            s_action_count = previous_count;
+            save_to_nvs();  // Supersede writes still queued for retry
+        }
+    }
+    unlock();
+
+    if (ok) {
+        ESP_LOGI(TAG, "Pinned quick action '%s' -> %s", action->label, action->tool);
+    }
+    return ok;
+}
+
+bool quick_actions_unpin(const char *label)
+{
+    quick_action_t previous_actions[QUICK_ACTION_MAX];
+    bool ok = false;
+
+    lock();
+    int index = find_index(label);
+    if (index >= 0) {
+        memcpy(previous_actions, s_actions, sizeof(previous_actions));
+        int previous_count = s_action_count;
+
+        for (int i = index; i < s_action_count - 1; i++) {
+            s_actions[i] = s_actions[i + 1];
+        }
+        s_action_count--;
+        memset(&s_actions[s_action_count], 0, sizeof(quick_action_t));
+        ok = save_to_nvs() == ESP_OK;
+        if (!ok) {
+            memcpy(s_actions, previous_actions, sizeof(s_actions));
+            s_action_count = previous_count;
+            save_to_nvs();
+        }
+    }
+    unlock();
+    return ok;
+}
+
+bool quick_actions_find(const char *label, quick_action_t *out)
+{
+    lock();
+    int index = find_index(label);
+    if (index >= 0) {
+        *out = s_actions[index];
+    }
+    unlock();
+    return index >= 0;
+}
+
+int quick_actions_get_all(quick_action_t *out, int max_count)
+{
+    lock();
+    int count = s_action_count < max_count ? s_action_count : max_count;
+    if (count > 0) {
+        memcpy(out, s_actions, sizeof(quick_action_t) * (size_t)count);
+    }
+    unlock();
+    return count;
+}
@@ -0,0 +1,26 @@
+#ifndef QUICK_ACTIONS_H
+#define QUICK_ACTIONS_H
+
+#include "quick_actions_util.h"
+#include <stdbool.h>
+
+// Pinned Telegram quick actions (stored in NVS). Safe to read from the
+// Telegram task while the agent pins or unpins.
+
+// Load pinned actions from NVS
+void quick_actions_init(void);
+
+// Pin an action, replacing one with the same label. False when the list is
+// full or the change could not be persisted.
+bool quick_actions_pin(const quick_action_t *action);
+
+// Remove an action by label. False when not found or not persisted.
+bool quick_actions_unpin(const char *label);
+
+// Copy the action with this label into out
+bool quick_actions_find(const char *label, quick_action_t *out);
+
+// Copy up to max_count actions into out; returns how many were copied
+int quick_actions_get_all(quick_action_t *out, int max_count);
+
+#endif // QUICK_ACTIONS_H
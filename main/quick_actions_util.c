@@ -0,0 +1,201 @@
+#include "quick_actions_util.h"
+#include "tools.h"
+#include <stdio.h>
+#include <string.h>
+
+#define MENU_COMMAND "/actions"
+
+static const char *const s_allowed_tools[] = {
+    "gpio_write",
+    "gpio_read",
+    "memory_get",
+    "memory_list",
+    "cron_list",
+    "get_time",
+    "get_timezone",
+    "get_version",
+    "get_health",
+};
+
+bool quick_action_tool_allowed(const char *tool)
+{
+    if (!tool) {
+        return false;
+    }
+    for (size_t i = 0; i < sizeof(s_allowed_tools) / sizeof(s_allowed_tools[0]); i++) {
+        if (strcmp(s_allowed_tools[i], tool) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool label_is_valid(const char *label)
+{
+    size_t len = label ? strlen(label) : 0;
+
+    if (len == 0 || len >= QUICK_ACTION_LABEL_MAX_LEN) {
+        return false;
+    }
+    for (size_t i = 0; i < len; i++) {
+        if ((unsigned char)label[i] < 0x20) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool quick_action_build(const char *label, const char *tool, const cJSON *args,
+                        quick_action_t *out, char *err, size_t err_len)
+{
+    if (!label_is_valid(label)) {
+        snprintf(err, err_len, "Error: label must be 1-%d characters on one line",
+                 QUICK_ACTION_LABEL_MAX_LEN - 1);
+        return false;
+    }
+    if (!quick_action_tool_allowed(tool)) {
+        snprintf(err, err_len, "Error: '%s' can't be a quick action", tool ? tool : "");
+        return false;
+    }
+    if (args && !cJSON_IsNull(args) && !cJSON_IsObject(args)) {
+        snprintf(err, err_len, "Error: args must be an object");
+        return false;
+    }
+
+    memset(out, 0, sizeof(*out));
+    snprintf(out->label, sizeof(out->label), "%s", label);
+    snprintf(out->tool, sizeof(out->tool), "%s", tool);
+    if (args && cJSON_IsObject(args)) {
+        char *printed = cJSON_PrintUnformatted(args);
+        if (!printed) {
+            snprintf(err, err_len, "Error: out of memory");
+            return false;
+        }
+        size_t printed_len = strlen(printed);
+        if (printed_len < sizeof(out->args)) {
+            memcpy(out->args, printed, printed_len + 1);
+        }
+        cJSON_free(printed);
+        if (printed_len >= sizeof(out->args)) {
+            snprintf(err, err_len, "Error: args too long (max %d chars)",
+                     QUICK_ACTION_ARGS_MAX_LEN - 1);
+            return false;
+        }
+    } else {
+        snprintf(out->args, sizeof(out->args), "{}");
+    }
+    return true;
+}
+
+bool quick_action_run(const quick_action_t *action, char *result, size_t result_len)
+{
+    if (!quick_action_tool_allowed(action->tool)) {
+        snprintf(result, result_len, "Error: '%s' can't be a quick action", action->tool);
+        return false;
+    }
+
+    cJSON *input = cJSON_Parse(action->args[0] ? action->args : "{}");
+    if (!input) {
+        snprintf(result, result_len, "Error: stored args are not valid JSON");
+        return false;
+    }
+    bool ok = tools_execute(action->tool, input, result, result_len);
+    cJSON_Delete(input);
+    return ok;
+}
+
+cJSON *quick_action_keyboard(const quick_action_t *actions, int count)
+{
+    if (count <= 0) {
+        return NULL;
+    }
+
+    cJSON *markup = cJSON_CreateObject();
+    cJSON *rows = markup ? cJSON_AddArrayToObject(markup, "inline_keyboard") : NULL;
+    cJSON *row = NULL;
+    if (!rows) {
+        cJSON_Delete(markup);
+        return NULL;
+    }
+
+    for (int i = 0; i < count; i++) {
+        char data[sizeof(QUICK_ACTION_CALLBACK_PREFIX) + QUICK_ACTION_LABEL_MAX_LEN];
+
+        if (i % QUICK_ACTION_COLUMNS == 0) {
+            row = cJSON_CreateArray();
+            if (!row || !cJSON_AddItemToArray(rows, row)) {
+                cJSON_Delete(row);
+                cJSON_Delete(markup);
+                return NULL;
+            }
+        }
+        snprintf(data, sizeof(data), "%s%s", QUICK_ACTION_CALLBACK_PREFIX, actions[i].label);
+        cJSON *button = cJSON_CreateObject();
+        if (!button || !cJSON_AddItemToArray(row, button) ||
+            !cJSON_AddStringToObject(button, "text", actions[i].label) ||
+            !cJSON_AddStringToObject(button, "callback_data", data)) {
+            cJSON_Delete(markup);
+            return NULL;
+        }
+    }
+    return markup;
+}
+
+bool quick_action_callback_label(const char *data, char *label, size_t label_len)
+{
+    size_t prefix_len = strlen(QUICK_ACTION_CALLBACK_PREFIX);
+
+    if (!data || strncmp(data, QUICK_ACTION_CALLBACK_PREFIX, prefix_len) != 0) {
+        return false;
+    }
+    data += prefix_len;
+    if (data[0] == '\0' || strlen(data) >= label_len) {
+        return false;
+    }
+    memcpy(label, data, strlen(data) + 1);
+    return true;
+}
+
+bool quick_action_is_menu_command(const char *text)
+{
+    size_t len = strlen(MENU_COMMAND);
+
+    if (!text) {
+        return false;
+    }
+    while (*text == ' ' || *text == '\t' || *text == '\r' || *text == '\n') {
+        text++;
+    }
+    if (strncmp(text, MENU_COMMAND, len) != 0) {
+        return false;
+    }
+    text += len;
+    while (*text == ' ' || *text == '\t' || *text == '\r' || *text == '\n') {
+        text++;
+    }
+    return *text == '\0' || *text == '@';
+}
+
+void quick_action_list(const quick_action_t *actions, int count, char *buf, size_t buf_len)
+{
+    size_t used = 0;
+
+    if (buf_len == 0) {
+        return;
+    }
+    if (count <= 0) {
+        snprintf(buf, buf_len, "No quick actions pinned");
+        return;
+    }
+
+    buf[0] = '\0';
+    for (int i = 0; i < count && used < buf_len; i++) {
+        int written = snprintf(buf + used, buf_len - used, "%s%s -> %s %s",
+                               i > 0 ? "\n" : "", actions[i].label, actions[i].tool,
+                               actions[i].args);
+        if (written < 0) {
+            break;
+        }
+        used += (size_t)written;
+    }
+}
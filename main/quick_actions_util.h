@@ -0,0 +1,42 @@
+#ifndef QUICK_ACTIONS_UTIL_H
+#define QUICK_ACTIONS_UTIL_H
+
+#include "config.h"
+#include "cJSON.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+// A pinned Telegram button that runs one built-in tool with fixed input,
+// without an LLM round trip.
+typedef struct {
+    char label[QUICK_ACTION_LABEL_MAX_LEN];
+    char tool[TOOL_NAME_MAX_LEN];
+    char args[QUICK_ACTION_ARGS_MAX_LEN];   // JSON object passed to the tool
+} quick_action_t;
+
+// Tools a button may run: quick, non-blocking, and safe to call from the
+// Telegram task while the agent is busy.
+bool quick_action_tool_allowed(const char *tool);
+
+// Check and fill a quick action. args may be NULL (no input) or an object.
+// On failure, err receives a message for the caller.
+bool quick_action_build(const char *label, const char *tool, const cJSON *args,
+                        quick_action_t *out, char *err, size_t err_len);
+
+// Run the action's tool. Returns the tool's status; result is always written.
+bool quick_action_run(const quick_action_t *action, char *result, size_t result_len);
+
+// reply_markup object with one button per action, QUICK_ACTION_COLUMNS per row.
+// Caller owns the result. Returns NULL when count is 0 or on allocation failure.
+cJSON *quick_action_keyboard(const quick_action_t *actions, int count);
+
+// Label named by a button's callback_data, or false when data is not ours.
+bool quick_action_callback_label(const char *data, char *label, size_t label_len);
+
+// True for "/actions" and "/actions@bot".
+bool quick_action_is_menu_command(const char *text);
+
+// Human-readable list ("label -> tool {args}" per line).
+void quick_action_list(const quick_action_t *actions, int count, char *buf, size_t buf_len);
+
+#endif // QUICK_ACTIONS_UTIL_H
@@ -1,124 +1,237 @@
 #include "ratelimit.h"
 #include "config.h"
+#include "cron.h"
 #include "memory.h"
 #include "nvs_keys.h"
+#include "token_bucket.h"
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
 #include <string.h>
 #include <stdio.h>
 #include <time.h>
 
 static const char *TAG = "ratelimit";
 
-// Simple sliding window using hour/day counters
-static int s_requests_this_hour = 0;
-static int s_requests_today = 0;
-static int s_last_hour = -1;
-static int s_last_day = -1;
-
-void ratelimit_init(void)
+#define HOUR_S      3600
+#define DAY_S       86400
+
+// Bucket order in s_buckets and in the persisted record.
+enum {
+    BUCKET_HOUR = 0,
+    BUCKET_DAY,
+    BUCKETS_PER_CLASS,
+};
+#define BUCKET_COUNT (RATELIMIT_CLASS_COUNT * BUCKETS_PER_CLASS)
+
+static const uint32_t CAPACITY[RATELIMIT_CLASS_COUNT][BUCKETS_PER_CLASS] = {
+    [RATELIMIT_CLASS_INTERACTIVE] = { RATELIMIT_TOKENS_PER_HOUR, RATELIMIT_TOKENS_PER_DAY },
+    [RATELIMIT_CLASS_CRON] = { RATELIMIT_CRON_TOKENS_PER_HOUR, RATELIMIT_CRON_TOKENS_PER_DAY },
+};
+
+static const char *CLASS_NAMES[RATELIMIT_CLASS_COUNT] = {
+    [RATELIMIT_CLASS_INTERACTIVE] = "interactive",
+    [RATELIMIT_CLASS_CRON] = "scheduled",
+};
+
+static token_bucket_t s_buckets[BUCKET_COUNT];
+// Wall clock of the persisted state; the downtime since then is credited
+// once SNTP has set the clock. 0 when there is nothing to credit.
+static int64_t s_saved_wall_s = 0;
+// Guards the buckets and s_saved_wall_s: the agent task charges them while
+// quick actions read them from the Telegram task.
+static SemaphoreHandle_t s_mutex = NULL;
+
+static void lock(void)
 {
-    // Load persisted daily count
-    char buf[16];
-    if (memory_get(NVS_KEY_RL_DAILY, buf, sizeof(buf))) {
-        s_requests_today = atoi(buf);
+    if (s_mutex) {
+        xSemaphoreTake(s_mutex, portMAX_DELAY);
     }
-    if (memory_get(NVS_KEY_RL_DAY, buf, sizeof(buf))) {
-        s_last_day = atoi(buf);
+}
+
+static void unlock(void)
+{
+    if (s_mutex) {
+        xSemaphoreGive(s_mutex);
     }
+}
+
+static int64_t now_ms(void)
+{
+    return esp_timer_get_time() / 1000;
+}
+
+static token_bucket_t *bucket_for(ratelimit_class_t cls, int which)
+{
+    return &s_buckets[(size_t)cls * BUCKETS_PER_CLASS + (size_t)which];
+}
 
-    ESP_LOGI(TAG, "Rate limiter initialized: %d requests today", s_requests_today);
+static bool valid_class(ratelimit_class_t cls)
+{
+    return (int)cls >= 0 && cls < RATELIMIT_CLASS_COUNT;
 }
 
-static void update_time_window(void)
+void ratelimit_init(void)
 {
-    time_t now;
-    struct tm timeinfo;
-    time(&now);
-    localtime_r(&now, &timeinfo);
+    if (!s_mutex) {
+        s_mutex = xSemaphoreCreateMutex();
+        if (!s_mutex) {
+            ESP_LOGE(TAG, "Failed to create rate limit mutex");
+        }
+    }
 
-    int current_hour = timeinfo.tm_hour;
-    int current_day = timeinfo.tm_yday;
+    int64_t now = now_ms();
+    for (int cls = 0; cls < RATELIMIT_CLASS_COUNT; cls++) {
+        token_bucket_init(bucket_for(cls, BUCKET_HOUR), CAPACITY[cls][BUCKET_HOUR], HOUR_S, now);
+        token_bucket_init(bucket_for(cls, BUCKET_DAY), CAPACITY[cls][BUCKET_DAY], DAY_S, now);
+    }
 
-    // Reset hourly counter if hour changed
-    if (current_hour != s_last_hour) {
-        s_requests_this_hour = 0;
-        s_last_hour = current_hour;
+    // Restore levels so a reboot does not hand out a fresh budget.
+    char buf[RATELIMIT_STATE_MAX_LEN];
+    int64_t levels[BUCKET_COUNT];
+    int64_t wall_s;
+    if (memory_get(NVS_KEY_RL_STATE, buf, sizeof(buf)) &&
+        token_bucket_decode(buf, levels, BUCKET_COUNT, &wall_s)) {
+        for (int i = 0; i < BUCKET_COUNT; i++) {
+            int64_t full = (int64_t)s_buckets[i].capacity * 1000;
+            int64_t level = levels[i] * 1000;
+            s_buckets[i].level = level > full ? full : (level < -full ? -full : level);
+        }
+        s_saved_wall_s = wall_s;
     }
 
-    // Reset daily counter if day changed
-    if (current_day != s_last_day) {
-        s_requests_today = 0;
-        s_last_day = current_day;
+    // Request counters from the old calendar-window limiter.
+    memory_delete(NVS_KEY_RL_DAILY_LEGACY);
+    memory_delete(NVS_KEY_RL_DAY_LEGACY);
 
-        // Persist the new day
-        char buf[16];
-        snprintf(buf, sizeof(buf), "%d", current_day);
-        memory_set(NVS_KEY_RL_DAY, buf);
-        memory_set(NVS_KEY_RL_DAILY, "0");
+    ESP_LOGI(TAG, "Rate limiter initialized: %lu/%lu tokens left this hour",
+             (unsigned long)token_bucket_available(bucket_for(RATELIMIT_CLASS_INTERACTIVE,
+                                                              BUCKET_HOUR)),
+             (unsigned long)RATELIMIT_TOKENS_PER_HOUR);
+}
 
-        ESP_LOGI(TAG, "Daily rate limit reset");
+static void refill_all(void)
+{
+    int64_t now = now_ms();
+
+    if (s_saved_wall_s > 0 && cron_is_time_synced()) {
+        int64_t downtime_ms = ((int64_t)time(NULL) - s_saved_wall_s) * 1000 - now;
+        for (int i = 0; i < BUCKET_COUNT; i++) {
+            token_bucket_credit(&s_buckets[i], downtime_ms);
+        }
+        s_saved_wall_s = 0;
+    }
+    for (int i = 0; i < BUCKET_COUNT; i++) {
+        token_bucket_refill(&s_buckets[i], now);
     }
 }
 
-bool ratelimit_check(char *reason, size_t reason_len)
+static void persist(void)
+{
+    char buf[RATELIMIT_STATE_MAX_LEN];
+    // Without a wall clock the downtime can't be credited later; a zero
+    // timestamp restores the levels as they are.
+    int64_t wall_s = cron_is_time_synced() ? (int64_t)time(NULL) : 0;
+
+    if (token_bucket_encode(s_buckets, BUCKET_COUNT, wall_s, buf, sizeof(buf)) > 0) {
+        // Coalesced in RAM; a burst of requests costs one flash commit.
+        memory_set_deferred(NVS_KEY_RL_STATE, buf);
+    }
+}
+
+bool ratelimit_check(ratelimit_class_t cls, char *reason, size_t reason_len)
 {
 #if !RATELIMIT_ENABLED
+    (void)cls;
+    (void)reason;
+    (void)reason_len;
     return true;
-#endif
-
-    update_time_window();
-
-    // Check hourly limit
-    if (s_requests_this_hour >= RATELIMIT_MAX_PER_HOUR) {
-        snprintf(reason, reason_len,
-                 "Rate limited: %d/%d requests this hour. Try again later.",
-                 s_requests_this_hour, RATELIMIT_MAX_PER_HOUR);
-        ESP_LOGW(TAG, "Hourly rate limit exceeded");
-        return false;
+#else
+    if (!valid_class(cls)) {
+        cls = RATELIMIT_CLASS_INTERACTIVE;
+    }
+    lock();
+    refill_all();
+    uint32_t hour_wait_s = token_bucket_retry_s(bucket_for(cls, BUCKET_HOUR));
+    uint32_t day_wait_s = token_bucket_retry_s(bucket_for(cls, BUCKET_DAY));
+    unlock();
+    if (hour_wait_s == 0 && day_wait_s == 0) {
+        return true;
     }
 
-    // Check daily limit
-    if (s_requests_today >= RATELIMIT_MAX_PER_DAY) {
+    bool daily = day_wait_s >= hour_wait_s;
+    uint32_t wait_s = daily ? day_wait_s : hour_wait_s;
+    if (wait_s >= 2 * 60 * 60) {
         snprintf(reason, reason_len,
-                 "Daily limit reached: %d/%d requests today. Resets at midnight.",
-                 s_requests_today, RATELIMIT_MAX_PER_DAY);
-        ESP_LOGW(TAG, "Daily rate limit exceeded");
-        return false;
+                 "Rate limited: %s token budget for the %s is used up. Retry in %lu h %lu min.",
+                 CLASS_NAMES[cls], daily ? "day" : "hour",
+                 (unsigned long)(wait_s / 3600), (unsigned long)((wait_s % 3600) / 60));
+    } else if (wait_s >= 2 * 60) {
+        snprintf(reason, reason_len,
+                 "Rate limited: %s token budget for the %s is used up. Retry in %lu min.",
+                 CLASS_NAMES[cls], daily ? "day" : "hour", (unsigned long)((wait_s + 59) / 60));
+    } else {
+        snprintf(reason, reason_len,
+                 "Rate limited: %s token budget for the %s is used up. Retry in %lu s.",
+                 CLASS_NAMES[cls], daily ? "day" : "hour", (unsigned long)wait_s);
     }
-
-    return true;
+    ESP_LOGW(TAG, "%s %s budget exhausted; retry in %lus", CLASS_NAMES[cls],
+             daily ? "daily" : "hourly", (unsigned long)wait_s);
+    return false;
+#endif
 }
 
-void ratelimit_record_request(void)
+void ratelimit_record_usage(ratelimit_class_t cls, uint32_t input_tokens,
+                            uint32_t output_tokens)
 {
-    update_time_window();
-
-    s_requests_this_hour++;
-    s_requests_today++;
-
-    // Persist daily count periodically
-    char buf[16];
-    snprintf(buf, sizeof(buf), "%d", s_requests_today);
-    memory_set(NVS_KEY_RL_DAILY, buf);
-
-    ESP_LOGD(TAG, "Request recorded: %d/hour, %d/day",
-             s_requests_this_hour, s_requests_today);
-}
+    if (!valid_class(cls)) {
+        cls = RATELIMIT_CLASS_INTERACTIVE;
+    }
+    uint32_t tokens = input_tokens + output_tokens;
+    if (tokens < input_tokens) {
+        tokens = UINT32_MAX;
+    }
 
-int ratelimit_get_requests_today(void)
-{
-    return s_requests_today;
+    lock();
+    refill_all();
+    int64_t now = now_ms();
+    token_bucket_charge(bucket_for(cls, BUCKET_HOUR), tokens, now);
+    token_bucket_charge(bucket_for(cls, BUCKET_DAY), tokens, now);
+    persist();
+
+    ESP_LOGD(TAG, "%s request: %lu in + %lu out tokens, %lu left this hour",
+             CLASS_NAMES[cls], (unsigned long)input_tokens, (unsigned long)output_tokens,
+             (unsigned long)token_bucket_available(bucket_for(cls, BUCKET_HOUR)));
+    unlock();
 }
 
-int ratelimit_get_requests_this_hour(void)
+void ratelimit_get_status(ratelimit_class_t cls, ratelimit_status_t *status)
 {
-    return s_requests_this_hour;
+    if (!status) {
+        return;
+    }
+    if (!valid_class(cls)) {
+        cls = RATELIMIT_CLASS_INTERACTIVE;
+    }
+    lock();
+    refill_all();
+    status->hour_available = token_bucket_available(bucket_for(cls, BUCKET_HOUR));
+    status->day_available = token_bucket_available(bucket_for(cls, BUCKET_DAY));
+    unlock();
+    status->hour_capacity = CAPACITY[cls][BUCKET_HOUR];
+    status->day_capacity = CAPACITY[cls][BUCKET_DAY];
 }
 
-void ratelimit_reset_daily(void)
+void ratelimit_reset(void)
 {
-    s_requests_today = 0;
-    s_requests_this_hour = 0;
-    memory_set(NVS_KEY_RL_DAILY, "0");
+    lock();
+    int64_t now = now_ms();
+    for (int i = 0; i < BUCKET_COUNT; i++) {
+        token_bucket_init(&s_buckets[i], s_buckets[i].capacity, s_buckets[i].window_s, now);
+    }
+    s_saved_wall_s = 0;
+    persist();
+    unlock();
     ESP_LOGI(TAG, "Rate limits manually reset");
 }
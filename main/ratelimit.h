@@ -3,22 +3,40 @@
 
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
+
+// Traffic classes with separate token budgets, so a chatty schedule cannot
+// starve interactive use (or the other way round).
+typedef enum {
+    RATELIMIT_CLASS_INTERACTIVE = 0,
+    RATELIMIT_CLASS_CRON,
+    RATELIMIT_CLASS_COUNT,
+} ratelimit_class_t;
+
+typedef struct {
+    uint32_t hour_available;    // Tokens left in the rolling hour budget
+    uint32_t hour_capacity;
+    uint32_t day_available;     // Tokens left in the rolling day budget
+    uint32_t day_capacity;
+} ratelimit_status_t;
 
 // Initialize rate limiter (loads state from NVS)
 void ratelimit_init(void);
 
-// Check if a request is allowed. Returns true if allowed, false if rate limited.
-// If denied, writes reason to `reason` buffer.
-bool ratelimit_check(char *reason, size_t reason_len);
+// Check if a request in this class is allowed. Returns true if allowed, false
+// if rate limited. If denied, writes the reason, including when to retry, to
+// `reason`.
+bool ratelimit_check(ratelimit_class_t cls, char *reason, size_t reason_len);
 
-// Record that a request was made (call after successful LLM response)
-void ratelimit_record_request(void);
+// Charge the tokens a completed LLM request actually used (from the response
+// `usage`, or an estimate when the backend did not report it).
+void ratelimit_record_usage(ratelimit_class_t cls, uint32_t input_tokens,
+                            uint32_t output_tokens);
 
-// Get current usage stats
-int ratelimit_get_requests_today(void);
-int ratelimit_get_requests_this_hour(void);
+// Get current budget for a class
+void ratelimit_get_status(ratelimit_class_t cls, ratelimit_status_t *status);
 
-// Reset daily counter (called at midnight by cron or manually)
-void ratelimit_reset_daily(void);
+// Refill every budget (manual reset)
+void ratelimit_reset(void);
 
 #endif // RATELIMIT_H
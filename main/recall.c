@@ -0,0 +1,353 @@
+#include "recall.h"
+#include "config.h"
+#include "embed_index.h"
+#include "json_util.h"
+#include "llm.h"
+#include "memory.h"
+#include "memory_keys.h"
+#include "zc_store.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *TAG = "recall";
+
+#define RECALL_EMBED_TEXT_MAX   1024            // Chars of "key: value" sent to embed
+#define RECALL_RETRY_AFTER_US   (10LL * 60 * 1000000)  // Back off after API failures
+#define RECALL_RECORD_PREFIX    "~e"            // zc_store keys for cached vectors
+
+typedef struct {
+    char (*keys)[EMBED_KEY_LEN];                // Current user keys
+    size_t key_count;
+    bool keys_truncated;
+    char *value;                                // One memory value
+    char (*texts)[RECALL_EMBED_TEXT_MAX + 1];   // Pending "key: value" inputs
+    size_t pending[RECALL_EMBED_BATCH];         // Index into keys
+    uint32_t pending_hash[RECALL_EMBED_BATCH];
+    size_t pending_count;
+    char *record;
+    float *floats;                              // Query + pending vectors
+    char *response;
+} recall_buffers_t;
+
+static recall_buffers_t s_buf;
+static bool s_ready = false;
+static bool s_failed = false;
+static uint32_t s_synced_generation = 0;
+static bool s_synced = false;
+static int64_t s_retry_at_us = 0;
+
+static void *recall_alloc(size_t size)
+{
+#if ZCLAW_HAS_PSRAM
+    void *ptr = heap_caps_malloc(size, MALLOC_CAP_SPIRAM);
+    if (ptr) {
+        return ptr;
+    }
+#endif
+    return malloc(size);
+}
+
+static void recall_free(void *ptr)
+{
+    free(ptr);
+}
+
+static bool ensure_ready(void)
+{
+    static const embed_index_alloc_t allocator = {
+        .alloc = recall_alloc,
+        .free = recall_free,
+    };
+
+    if (s_ready || s_failed) {
+        return s_ready;
+    }
+
+    s_buf.keys = recall_alloc(sizeof(*s_buf.keys) * EMBED_INDEX_MAX_ENTRIES);
+    s_buf.value = recall_alloc(ZC_STORE_MAX_VALUE_LEN + 1);
+    s_buf.texts = recall_alloc(sizeof(*s_buf.texts) * RECALL_EMBED_BATCH);
+    s_buf.record = recall_alloc(EMBED_RECORD_MAX_LEN + 1);
+    s_buf.floats = recall_alloc(sizeof(float) * EMBED_DIM * (RECALL_EMBED_BATCH + 1));
+    s_buf.response = recall_alloc(LLM_RESPONSE_BUF_SIZE);
+    if (!s_buf.keys || !s_buf.value || !s_buf.texts || !s_buf.record || !s_buf.floats ||
+        !s_buf.response || !embed_index_init(&allocator)) {
+        ESP_LOGE(TAG, "Out of memory; memory recall disabled");
+        s_failed = true;
+        return false;
+    }
+    s_ready = true;
+    return true;
+}
+
+static void record_key(const char *key, char *out, size_t out_len)
+{
+    snprintf(out, out_len, RECALL_RECORD_PREFIX "%08lx", (unsigned long)embed_hash(key));
+}
+
+// Vectors survive reboots as zc_store records; a hash collision just misses.
+static bool load_record(const char *key, uint32_t value_hash)
+{
+    char store_key[16];
+    char stored_key[EMBED_KEY_LEN];
+    int8_t vec[EMBED_DIM];
+    uint32_t stored_hash;
+    float scale;
+
+    if (!zc_store_is_mounted()) {
+        return false;
+    }
+    record_key(key, store_key, sizeof(store_key));
+    size_t len = EMBED_RECORD_MAX_LEN + 1;
+    if (zc_store_get(store_key, s_buf.record, &len) != ESP_OK ||
+        !embed_record_decode(s_buf.record, stored_key, sizeof(stored_key), &stored_hash, vec,
+                             &scale) ||
+        strcmp(stored_key, key) != 0 || stored_hash != value_hash) {
+        return false;
+    }
+    return embed_index_put(key, value_hash, vec, scale);
+}
+
+static void save_record(const char *key, uint32_t value_hash, const int8_t *vec, float scale)
+{
+    char store_key[16];
+
+    if (!zc_store_is_mounted() ||
+        embed_record_encode(key, value_hash, vec, scale, s_buf.record,
+                            EMBED_RECORD_MAX_LEN + 1) == 0) {
+        return;
+    }
+    record_key(key, store_key, sizeof(store_key));
+    esp_err_t err = zc_store_set(store_key, s_buf.record);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to cache vector for %s: %s", key, esp_err_to_name(err));
+    }
+}
+
+static void drop_record(const char *key, void *ctx)
+{
+    char store_key[16];
+
+    (void)ctx;
+    if (zc_store_is_mounted()) {
+        record_key(key, store_key, sizeof(store_key));
+        zc_store_delete(store_key);
+    }
+}
+
+static bool collect_key(const char *key, void *ctx)
+{
+    (void)ctx;
+    if (!memory_keys_is_user_key(key) || strlen(key) >= EMBED_KEY_LEN) {
+        return true;
+    }
+    if (s_buf.key_count >= EMBED_INDEX_MAX_ENTRIES) {
+        s_buf.keys_truncated = true;
+        return false;
+    }
+    memcpy(s_buf.keys[s_buf.key_count++], key, strlen(key) + 1);
+    return true;
+}
+
+// Reconcile the index with current user memories. Fresh vectors are kept,
+// cached ones reloaded from flash; the rest are queued for embedding.
+// Returns true once every memory has a current vector or is queued.
+static bool sync_index(void)
+{
+    s_buf.key_count = 0;
+    s_buf.keys_truncated = false;
+    s_buf.pending_count = 0;
+    memory_list_keys(collect_key, NULL);
+    if (s_buf.keys_truncated) {
+        ESP_LOGW(TAG, "More than %d user memories; recall covers the first ones",
+                 EMBED_INDEX_MAX_ENTRIES);
+    }
+
+    bool complete = true;
+    embed_index_mark_all();
+    for (size_t i = 0; i < s_buf.key_count; i++) {
+        const char *key = s_buf.keys[i];
+        uint32_t stored_hash;
+
+        if (!memory_get(key, s_buf.value, ZC_STORE_MAX_VALUE_LEN + 1)) {
+            continue;
+        }
+        uint32_t value_hash = embed_hash(s_buf.value);
+        if (embed_index_lookup(key, &stored_hash) && stored_hash == value_hash) {
+            embed_index_touch(key);
+            continue;
+        }
+        if (load_record(key, value_hash)) {
+            continue;
+        }
+        if (s_buf.pending_count >= RECALL_EMBED_BATCH) {
+            complete = false;
+            continue;
+        }
+
+        size_t slot = s_buf.pending_count++;
+        s_buf.pending[slot] = i;
+        s_buf.pending_hash[slot] = value_hash;
+        snprintf(s_buf.texts[slot], sizeof(s_buf.texts[slot]), "%s: %s",
+                 key + strlen(USER_MEMORY_KEY_PREFIX), s_buf.value);
+    }
+    // Changed memories stay marked until re-embedded, so stale vectors never match.
+    embed_index_sweep(drop_record, NULL);
+    return complete;
+}
+
+// Embeddings cost tokens like chat requests; without reported usage,
+// estimate ~4 bytes per token as the agent does.
+static void record_usage(ratelimit_class_t cls, const char *const *inputs, int count,
+                         uint32_t prompt_tokens)
+{
+    if (prompt_tokens == 0) {
+        size_t len = 0;
+        for (int i = 0; i < count; i++) {
+            len += strlen(inputs[i]);
+        }
+        prompt_tokens = (uint32_t)(len / 4);
+    }
+    ratelimit_record_usage(cls, prompt_tokens, 0);
+}
+
+static bool embed_batch(const char *message, ratelimit_class_t cls)
+{
+    const char *inputs[RECALL_EMBED_BATCH + 1];
+    int count = 1 + (int)s_buf.pending_count;
+    uint32_t prompt_tokens;
+
+    inputs[0] = message;
+    for (size_t i = 0; i < s_buf.pending_count; i++) {
+        inputs[i + 1] = s_buf.texts[i];
+    }
+
+    char *request = json_build_embeddings_request(llm_get_embed_model(), inputs, count);
+    if (!request) {
+        return false;
+    }
+    esp_err_t err = llm_embed_request(request, s_buf.response, LLM_RESPONSE_BUF_SIZE);
+    free(request);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Embeddings request failed: %s", esp_err_to_name(err));
+        return false;
+    }
+    int decoded = json_parse_embeddings(s_buf.response, s_buf.floats, count, &prompt_tokens);
+    record_usage(cls, inputs, count, prompt_tokens);
+    if (decoded != count) {
+        ESP_LOGW(TAG, "Embeddings response did not cover %d inputs", count);
+        return false;
+    }
+
+    for (size_t i = 0; i < s_buf.pending_count; i++) {
+        const char *key = s_buf.keys[s_buf.pending[i]];
+        int8_t vec[EMBED_DIM];
+        float scale;
+
+        embed_quantize(&s_buf.floats[(i + 1) * EMBED_DIM], vec, &scale);
+        if (embed_index_put(key, s_buf.pending_hash[i], vec, scale)) {
+            save_record(key, s_buf.pending_hash[i], vec, scale);
+        }
+    }
+    return true;
+}
+
+static size_t append_match(char *out, size_t out_len, size_t used, const char *key)
+{
+    if (!memory_get(key, s_buf.value, ZC_STORE_MAX_VALUE_LEN + 1)) {
+        return used;
+    }
+
+    size_t len = strlen(s_buf.value);
+    const char *ellipsis = "";
+    if (len > RECALL_VALUE_PREVIEW) {
+        len = RECALL_VALUE_PREVIEW;
+        // Don't split a UTF-8 sequence.
+        while (len > 0 && ((unsigned char)s_buf.value[len] & 0xC0) == 0x80) {
+            len--;
+        }
+        ellipsis = "...";
+    }
+
+    int written = snprintf(out + used, out_len - used, "- %s: %.*s%s\n", key, (int)len,
+                           s_buf.value, ellipsis);
+    if (written < 0 || (size_t)written >= out_len - used) {
+        out[used] = '\0';
+        return used;
+    }
+    return used + (size_t)written;
+}
+
+size_t recall_build_context(const char *message, ratelimit_class_t cls, char *out,
+                            size_t out_len)
+{
+    static const char *HEADER =
+        "\n\nRelevant user memories (already looked up; call memory_get only for others):\n";
+    embed_match_t matches[RECALL_TOP_K];
+
+    if (!out || out_len == 0) {
+        return 0;
+    }
+    out[0] = '\0';
+    if (!RECALL_ENABLED || !message || message[0] == '\0' || !llm_has_embeddings()) {
+        return 0;
+    }
+    if (s_retry_at_us != 0 && esp_timer_get_time() < s_retry_at_us) {
+        return 0;
+    }
+    if (!ensure_ready()) {
+        return 0;
+    }
+
+    uint32_t generation = memory_user_generation();
+    bool complete = true;
+    if (!s_synced || generation != s_synced_generation) {
+        complete = sync_index();
+    } else {
+        s_buf.pending_count = 0;
+    }
+    if (embed_index_count() == 0 && s_buf.pending_count == 0) {
+        s_synced = complete;
+        s_synced_generation = generation;
+        return 0;
+    }
+
+    int64_t started_us = esp_timer_get_time();
+    if (!embed_batch(message, cls)) {
+        s_retry_at_us = esp_timer_get_time() + RECALL_RETRY_AFTER_US;
+        s_synced = false;
+        return 0;
+    }
+    s_retry_at_us = 0;
+    s_synced = complete;
+    s_synced_generation = generation;
+
+    int8_t query[EMBED_DIM];
+    float query_scale;
+    embed_quantize(s_buf.floats, query, &query_scale);
+    size_t found = embed_index_search(query, query_scale, RECALL_MIN_SCORE, matches, RECALL_TOP_K);
+    ESP_LOGI(TAG, "%u matches from %u memories (%u embedded) in %lld ms", (unsigned)found,
+             (unsigned)embed_index_count(), (unsigned)s_buf.pending_count,
+             (long long)((esp_timer_get_time() - started_us) / 1000));
+    if (found == 0) {
+        return 0;
+    }
+
+    int header_len = snprintf(out, out_len, "%s", HEADER);
+    if (header_len < 0 || (size_t)header_len >= out_len) {
+        out[0] = '\0';
+        return 0;
+    }
+    size_t used = (size_t)header_len;
+    for (size_t i = 0; i < found; i++) {
+        used = append_match(out, out_len, used, matches[i].key);
+    }
+    if (used == (size_t)header_len) {
+        out[0] = '\0';
+        return 0;
+    }
+    return used;
+}
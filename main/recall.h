@@ -0,0 +1,17 @@
+#ifndef RECALL_H
+#define RECALL_H
+
+#include <stddef.h>
+#include "ratelimit.h"
+
+// Write a system prompt suffix listing the user memories (u_*) most relevant
+// to message, or an empty string when nothing matches, the backend has no
+// embeddings endpoint, or retrieval fails. Memories changed since the last
+// call are re-embedded in the same request as the message, at most
+// RECALL_EMBED_BATCH per call. The embeddings request is charged to cls's
+// token budget. Runs on the agent task only.
+// Returns the number of bytes written (excluding the terminator).
+size_t recall_build_context(const char *message, ratelimit_class_t cls, char *out,
+                            size_t out_len);
+
+#endif // RECALL_H
@@ -3,15 +3,20 @@
 #include "messages.h"
 #include "memory.h"
 #include "nvs_keys.h"
+#include "quick_actions.h"
+#include "telegram_outbox.h"
 #include "telegram_update.h"
 #include "text_buffer.h"
 #include "esp_http_client.h"
+#include "esp_http_server.h"
 #include "esp_log.h"
 #include "esp_crt_bundle.h"
 #include "cJSON.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "esp_timer.h"
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -23,9 +28,17 @@ static const char *TAG = "telegram";
 static QueueHandle_t s_input_queue;
 static QueueHandle_t s_output_queue;
 static char s_bot_token[64] = {0};
-static int64_t s_chat_id = 0;
+static char s_api_url[TELEGRAM_API_URL_MAX_LEN + 1] = TELEGRAM_API_URL;
+static int64_t s_chat_ids[TELEGRAM_MAX_CHATS];  // Allowlist; the first is the primary chat
+static size_t s_chat_count = 0;
 static int64_t s_last_update_id = 0;
-static telegram_msg_t s_send_msg;
+static char s_webhook_secret[TELEGRAM_WEBHOOK_SECRET_MAX_LEN + 1] = {0};
+static telegram_msg_t s_send_msg;          // Next queued reply, read ahead while merging
+static bool s_send_msg_pending = false;
+static char s_send_batch[TELEGRAM_MAX_MSG_LEN];
+static char s_send_chunk[TELEGRAM_MAX_MSG_LEN];
+static telegram_pacer_t s_pacer;
+static SemaphoreHandle_t s_send_mutex = NULL; // Pacer and chunk buffer
 
 // Exponential backoff state
 static int s_consecutive_failures = 0;
@@ -73,6 +86,44 @@ static bool parse_chat_id_string(const char *input, int64_t *chat_id_out)
     return true;
 }
 
+// "id[,id...]" into s_chat_ids. Any invalid entry rejects the whole list.
+static bool parse_chat_id_list(const char *input)
+{
+    char item[24];
+    int64_t ids[TELEGRAM_MAX_CHATS];
+    size_t count = 0;
+    const char *cursor = input;
+
+    while (cursor) {
+        const char *comma = strchr(cursor, ',');
+        size_t len = comma ? (size_t)(comma - cursor) : strlen(cursor);
+        if (len >= sizeof(item) || count >= TELEGRAM_MAX_CHATS) {
+            return false;
+        }
+        memcpy(item, cursor, len);
+        item[len] = '\0';
+        if (!parse_chat_id_string(item, &ids[count])) {
+            return false;
+        }
+        count++;
+        cursor = comma ? comma + 1 : NULL;
+    }
+
+    memcpy(s_chat_ids, ids, count * sizeof(ids[0]));
+    s_chat_count = count;
+    return true;
+}
+
+static bool is_allowed_chat(int64_t chat_id)
+{
+    for (size_t i = 0; i < s_chat_count; i++) {
+        if (s_chat_ids[i] == chat_id) {
+            return true;
+        }
+    }
+    return false;
+}
+
 static esp_err_t http_event_handler(esp_http_client_event_t *evt)
 {
     telegram_http_ctx_t *ctx = (telegram_http_ctx_t *)evt->user_data;
@@ -94,27 +145,55 @@ static esp_err_t http_event_handler(esp_http_client_event_t *evt)
     return ESP_OK;
 }
 
+static bool is_http_url(const char *url)
+{
+    return strncmp(url, "http://", 7) == 0 || strncmp(url, "https://", 8) == 0;
+}
+
 esp_err_t telegram_init(void)
 {
+    // Optional base URL override (e.g. a local Bot API simulator)
+    char api_url[sizeof(s_api_url)];
+    if (memory_get(NVS_KEY_TG_API_URL, api_url, sizeof(api_url))) {
+        if (is_http_url(api_url)) {
+            strncpy(s_api_url, api_url, sizeof(s_api_url) - 1);
+            s_api_url[sizeof(s_api_url) - 1] = '\0';
+            ESP_LOGW(TAG, "Using Telegram API override: %s", s_api_url);
+        } else {
+            ESP_LOGW(TAG, "Ignoring invalid Telegram API URL in NVS: '%s'", api_url);
+        }
+    }
+
+    if (!s_send_mutex) {
+        s_send_mutex = xSemaphoreCreateMutex();
+        telegram_pacer_init(&s_pacer);
+    }
+
     // Load bot token from NVS
     if (!memory_get(NVS_KEY_TG_TOKEN, s_bot_token, sizeof(s_bot_token))) {
         ESP_LOGW(TAG, "No Telegram token configured");
         return ESP_ERR_NOT_FOUND;
     }
 
-    // Load last known chat ID (optional)
-    char chat_id_str[24];
+    // Load allowed chat IDs (optional)
+    char chat_id_str[TELEGRAM_MAX_CHATS * 24];
     if (memory_get(NVS_KEY_TG_CHAT_ID, chat_id_str, sizeof(chat_id_str))) {
-        int64_t parsed_chat_id = 0;
-        if (parse_chat_id_string(chat_id_str, &parsed_chat_id)) {
-            s_chat_id = parsed_chat_id;
-            ESP_LOGI(TAG, "Loaded chat ID: %" PRId64, s_chat_id);
+        if (parse_chat_id_list(chat_id_str)) {
+            ESP_LOGI(TAG, "Loaded chat ID: %" PRId64 " (+%u more allowed)",
+                     s_chat_ids[0], (unsigned)(s_chat_count - 1));
         } else {
-            s_chat_id = 0;
+            s_chat_count = 0;
             ESP_LOGW(TAG, "Invalid Telegram chat ID in NVS: '%s'", chat_id_str);
         }
     }
 
+    // Webhook mode (optional): a reverse proxy pushes updates instead of polling
+    if (memory_get(NVS_KEY_TG_WH_SECRET, s_webhook_secret, sizeof(s_webhook_secret)) &&
+        !telegram_webhook_secret_is_valid(s_webhook_secret)) {
+        ESP_LOGW(TAG, "Invalid Telegram webhook secret in NVS; using long polling");
+        s_webhook_secret[0] = '\0';
+    }
+
     ESP_LOGI(TAG, "Telegram initialized");
     return ESP_OK;
 }
@@ -126,36 +205,64 @@ bool telegram_is_configured(void)
 
 int64_t telegram_get_chat_id(void)
 {
-    return s_chat_id;
+    return s_chat_count > 0 ? s_chat_ids[0] : 0;
 }
 
 // Build URL for Telegram API
 static void build_url(char *buf, size_t buf_size, const char *method)
 {
-    snprintf(buf, buf_size, "%s%s/%s", TELEGRAM_API_URL, s_bot_token, method);
+    snprintf(buf, buf_size, "%s%s/%s", s_api_url, s_bot_token, method);
 }
 
-esp_err_t telegram_send(const char *text)
+// POST a JSON body to a Bot API method. The response body lands in ctx->buf.
+static esp_err_t post_method(const char *method, const char *body, telegram_http_ctx_t *ctx,
+                             int *status_out)
 {
-    telegram_http_ctx_t *ctx = NULL;
-    esp_http_client_handle_t client = NULL;
-    esp_err_t err;
+    char url[256];
+    build_url(url, sizeof(url), method);
 
-    if (!telegram_is_configured() || s_chat_id == 0) {
-        ESP_LOGW(TAG, "Cannot send - not configured or no chat ID");
-        return ESP_ERR_INVALID_STATE;
+    esp_http_client_config_t config = {
+        .url = url,
+        .event_handler = http_event_handler,
+        .user_data = ctx,
+        .timeout_ms = HTTP_TIMEOUT_MS,
+        .crt_bundle_attach = esp_crt_bundle_attach,
+    };
+
+    esp_http_client_handle_t client = esp_http_client_init(&config);
+    if (!client) {
+        ESP_LOGE(TAG, "Failed to init HTTP client");
+        return ESP_FAIL;
     }
 
-    char url[256];
-    build_url(url, sizeof(url), "sendMessage");
+    esp_http_client_set_method(client, HTTP_METHOD_POST);
+    esp_http_client_set_header(client, "Content-Type", "application/json");
+    esp_http_client_set_post_field(client, body, strlen(body));
+
+    esp_err_t err = esp_http_client_perform(client);
+    *status_out = err == ESP_OK ? esp_http_client_get_status_code(client) : 0;
+    esp_http_client_cleanup(client);
+    return err;
+}
+
+// One sendMessage call, with an optional reply_markup JSON object. On 429,
+// *retry_after_s receives Telegram's hold time; other 4xx answers return
+// ESP_ERR_INVALID_RESPONSE since resending won't help.
+static esp_err_t send_message_once(int64_t chat_id, const char *text, const char *reply_markup,
+                                   int *retry_after_s)
+{
+    telegram_http_ctx_t *ctx = NULL;
+    esp_err_t err;
+    int status = 0;
 
     // Build JSON body
     cJSON *root = cJSON_CreateObject();
     if (!root) {
         return ESP_ERR_NO_MEM;
     }
-    if (!cJSON_AddNumberToObject(root, "chat_id", (double)s_chat_id) ||
-        !cJSON_AddStringToObject(root, "text", text)) {
+    if (!cJSON_AddNumberToObject(root, "chat_id", (double)chat_id) ||
+        !cJSON_AddStringToObject(root, "text", text) ||
+        (reply_markup && !cJSON_AddRawToObject(root, "reply_markup", reply_markup))) {
         cJSON_Delete(root);
         return ESP_ERR_NO_MEM;
     }
@@ -172,70 +279,373 @@ esp_err_t telegram_send(const char *text)
         return ESP_ERR_NO_MEM;
     }
 
-    esp_http_client_config_t config = {
-        .url = url,
-        .event_handler = http_event_handler,
-        .user_data = ctx,
-        .timeout_ms = HTTP_TIMEOUT_MS,
-        .crt_bundle_attach = esp_crt_bundle_attach,
-    };
-
-    client = esp_http_client_init(&config);
-    if (!client) {
-        ESP_LOGE(TAG, "Failed to init HTTP client");
-        free(body);
-        free(ctx);
-        return ESP_FAIL;
-    }
-
-    esp_http_client_set_method(client, HTTP_METHOD_POST);
-    esp_http_client_set_header(client, "Content-Type", "application/json");
-    esp_http_client_set_post_field(client, body, strlen(body));
-
-    err = esp_http_client_perform(client);
+    err = post_method("sendMessage", body, ctx, &status);
 
     if (err == ESP_OK) {
-        int status = esp_http_client_get_status_code(client);
-        if (status != 200) {
+        if (status == 429) {
+            int retry_after = telegram_outbox_retry_after(ctx->buf);
+            *retry_after_s = retry_after > 0 ? retry_after : 1;
+            ESP_LOGW(TAG, "sendMessage flood wait: retry after %ds", *retry_after_s);
+            err = ESP_FAIL;
+        } else if (status != 200) {
             ESP_LOGE(TAG, "sendMessage failed: %d", status);
             if (ctx->buf[0] != '\0') {
                 ESP_LOGE(TAG, "sendMessage response: %s", ctx->buf);
             }
-            err = ESP_FAIL;
+            err = (status >= 400 && status < 500) ? ESP_ERR_INVALID_RESPONSE : ESP_FAIL;
         }
     }
 
-    esp_http_client_cleanup(client);
     free(body);
     free(ctx);
     return err;
 }
 
+// Acknowledge a button press so the client stops its spinner; text shows as
+// a brief toast. Not paced: it is not a chat message.
+static void answer_callback_query(const char *callback_id, const char *text)
+{
+    telegram_http_ctx_t *ctx = NULL;
+    int status = 0;
+
+    cJSON *root = cJSON_CreateObject();
+    if (!root) {
+        return;
+    }
+    if (!cJSON_AddStringToObject(root, "callback_query_id", callback_id) ||
+        (text && !cJSON_AddStringToObject(root, "text", text))) {
+        cJSON_Delete(root);
+        return;
+    }
+    char *body = cJSON_PrintUnformatted(root);
+    cJSON_Delete(root);
+    if (!body) {
+        return;
+    }
+
+    ctx = calloc(1, sizeof(*ctx));
+    if (ctx) {
+        esp_err_t err = post_method("answerCallbackQuery", body, ctx, &status);
+        if (err != ESP_OK || status != 200) {
+            ESP_LOGW(TAG, "answerCallbackQuery failed: err=%d status=%d", err, status);
+        }
+        free(ctx);
+    }
+    free(body);
+}
+
+static int64_t now_ms(void)
+{
+    return esp_timer_get_time() / 1000;
+}
+
+// Send text in chunks Telegram accepts, spaced by the pacer. A chunk is
+// retried after 429 retry_after or a transport/server error; after
+// TELEGRAM_SEND_MAX_ATTEMPTS it is dropped and the rest still goes out.
+// reply_markup, if any, rides on the last chunk.
+static esp_err_t send_paced(int64_t chat_id, const char *text, const char *reply_markup)
+{
+    size_t len = strlen(text);
+    size_t offset = 0;
+    esp_err_t result = ESP_OK;
+
+    if (!telegram_is_configured() || chat_id == 0) {
+        ESP_LOGW(TAG, "Cannot send - not configured or no chat ID");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if (s_send_mutex) {
+        xSemaphoreTake(s_send_mutex, portMAX_DELAY);
+    }
+    while (offset < len) {
+        size_t next = 0;
+        size_t chunk_len = telegram_outbox_split(text + offset, len - offset,
+                                                 sizeof(s_send_chunk) - 1, &next);
+        memcpy(s_send_chunk, text + offset, chunk_len);
+        s_send_chunk[chunk_len] = '\0';
+        offset += next;
+
+        esp_err_t err = ESP_FAIL;
+        for (int attempt = 1; attempt <= TELEGRAM_SEND_MAX_ATTEMPTS; attempt++) {
+            int64_t wait_ms = telegram_pacer_wait_ms(&s_pacer, chat_id, now_ms());
+            if (wait_ms > 0) {
+                vTaskDelay(pdMS_TO_TICKS(wait_ms));
+            }
+
+            int retry_after_s = 0;
+            err = send_message_once(chat_id, s_send_chunk,
+                                    offset >= len ? reply_markup : NULL, &retry_after_s);
+            telegram_pacer_sent(&s_pacer, chat_id, now_ms());
+            if (err == ESP_OK || err == ESP_ERR_INVALID_RESPONSE) {
+                break;
+            }
+            if (retry_after_s > 0) {
+                telegram_pacer_retry_after(&s_pacer, chat_id, now_ms(), retry_after_s);
+            } else {
+                vTaskDelay(pdMS_TO_TICKS(TELEGRAM_CHAT_INTERVAL_MS * attempt));
+            }
+        }
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "Dropping %u-byte message to chat %" PRId64 ": %s",
+                     (unsigned)chunk_len, chat_id, esp_err_to_name(err));
+            result = err;
+        }
+    }
+    if (s_send_mutex) {
+        xSemaphoreGive(s_send_mutex);
+    }
+    return result;
+}
+
+// Time until chat_id may be sent to again. Read under s_send_mutex, since
+// send_paced() also runs on other tasks (startup message).
+static int64_t pacer_wait_ms(int64_t chat_id)
+{
+    if (s_send_mutex) {
+        xSemaphoreTake(s_send_mutex, portMAX_DELAY);
+    }
+    int64_t wait_ms = telegram_pacer_wait_ms(&s_pacer, chat_id, now_ms());
+    if (s_send_mutex) {
+        xSemaphoreGive(s_send_mutex);
+    }
+    return wait_ms;
+}
+
+esp_err_t telegram_send(const char *text)
+{
+    return telegram_send_to(telegram_get_chat_id(), text);
+}
+
+esp_err_t telegram_send_to(int64_t chat_id, const char *text)
+{
+    return send_paced(chat_id, text, NULL);
+}
+
 esp_err_t telegram_send_startup(void)
 {
     return telegram_send("I'm back online. What can I help you with?");
 }
 
+typedef struct {
+    telegram_update_stream_t stream;
+    char error[256];            // Start of a non-200 body, for the log
+    size_t error_len;
+    int accepted;               // Updates confirmed in this poll
+    bool input_full;            // Stopped early: the agent queue had no room
+} telegram_poll_ctx_t;
+
+static esp_err_t poll_event_handler(esp_http_client_event_t *evt)
+{
+    telegram_poll_ctx_t *ctx = (telegram_poll_ctx_t *)evt->user_data;
+
+    if (evt->event_id != HTTP_EVENT_ON_DATA || !ctx) {
+        return ESP_OK;
+    }
+    if (esp_http_client_get_status_code(evt->client) == 200) {
+        // Updates are parsed and queued while the rest of the body is still arriving.
+        telegram_update_stream_feed(&ctx->stream, (const char *)evt->data, evt->data_len);
+    } else {
+        text_buffer_append(ctx->error, &ctx->error_len, sizeof(ctx->error),
+                           (const char *)evt->data, evt->data_len);
+    }
+    return ESP_OK;
+}
+
+// Read a message's chat ID and check it against the allowlist.
+static bool read_allowed_chat(const cJSON *message, int64_t *chat_id_out)
+{
+    cJSON *chat = message ? cJSON_GetObjectItem(message, "chat") : NULL;
+    cJSON *chat_id = chat ? cJSON_GetObjectItem(chat, "id") : NULL;
+    if (!chat_id || !cJSON_IsNumber(chat_id)) {
+        return false;
+    }
+
+    // Note: cJSON stores numbers as double (53-bit precision)
+    // Telegram chat IDs fit within this range
+    int64_t incoming_chat_id = (int64_t)chat_id->valuedouble;
+
+    // Sanity check for precision loss (chat IDs > 2^53)
+    if (chat_id->valuedouble > 9007199254740992.0) {
+        ESP_LOGW(TAG, "Chat ID may have precision loss");
+    }
+
+    // If no chat ID configured, reject all (must be set during provisioning)
+    if (s_chat_count == 0) {
+        ESP_LOGW(TAG, "No chat ID configured - ignoring message from %" PRId64, incoming_chat_id);
+        return false;
+    }
+
+    // Authentication: reject messages from chats not on the allowlist
+    if (!is_allowed_chat(incoming_chat_id)) {
+        ESP_LOGW(TAG, "Rejected message from unauthorized chat: %" PRId64, incoming_chat_id);
+        return false;
+    }
+
+    *chat_id_out = incoming_chat_id;
+    return true;
+}
+
+// Hand text to the Telegram send task (chat-specific, never mirrored locally).
+// Only the receive path (poll task or webhook handler) calls this.
+static void queue_output(int64_t chat_id, bool quick_actions, const char *text)
+{
+    static telegram_msg_t msg;
+
+    msg.chat_id = chat_id;
+    msg.quick_actions = quick_actions;
+    snprintf(msg.text, sizeof(msg.text), "%s", text);
+    if (xQueueSend(s_output_queue, &msg, pdMS_TO_TICKS(100)) != pdTRUE) {
+        ESP_LOGW(TAG, "Output queue full; dropping reply to chat %" PRId64, chat_id);
+    }
+}
+
+// A quick-action button press: run the pinned tool here, without the agent
+// or the LLM, and post the result to the chat.
+static void handle_callback_query(const cJSON *callback)
+{
+    cJSON *id = cJSON_GetObjectItem(callback, "id");
+    cJSON *data = cJSON_GetObjectItem(callback, "data");
+    int64_t chat_id = 0;
+    char label[QUICK_ACTION_LABEL_MAX_LEN];
+    quick_action_t action;
+    static char result[QUICK_ACTION_RESULT_MAX_LEN];
+    static char reply[QUICK_ACTION_LABEL_MAX_LEN + QUICK_ACTION_RESULT_MAX_LEN + 2];
+
+    if (!id || !cJSON_IsString(id)) {
+        return;
+    }
+    if (!read_allowed_chat(cJSON_GetObjectItem(callback, "message"), &chat_id)) {
+        answer_callback_query(id->valuestring, NULL);
+        return;
+    }
+    if (!data || !cJSON_IsString(data) ||
+        !quick_action_callback_label(data->valuestring, label, sizeof(label))) {
+        answer_callback_query(id->valuestring, NULL);
+        return;
+    }
+    if (!quick_actions_find(label, &action)) {
+        answer_callback_query(id->valuestring, "That button is no longer pinned");
+        return;
+    }
+
+    int64_t started_us = esp_timer_get_time();
+    bool ok = quick_action_run(&action, result, sizeof(result));
+    answer_callback_query(id->valuestring, ok ? NULL : "Action failed");
+    snprintf(reply, sizeof(reply), "%s: %s", action.label, result);
+    queue_output(chat_id, false, reply);
+    ESP_LOGI(TAG, "Quick action '%s' (%s) %s in %lld ms", action.label, action.tool,
+             ok ? "ran" : "failed", (long long)((esp_timer_get_time() - started_us) / 1000));
+}
+
+// Queue one update's message for the agent. Returns false only when the
+// queue is full, so the update stays unconfirmed and is fetched again.
+static bool queue_update_message(const cJSON *update)
+{
+    cJSON *callback = cJSON_GetObjectItem(update, "callback_query");
+    if (callback) {
+        handle_callback_query(callback);
+        return true;
+    }
+
+    cJSON *message = cJSON_GetObjectItem(update, "message");
+    if (!message) {
+        return true;
+    }
+
+    cJSON *text = cJSON_GetObjectItem(message, "text");
+    int64_t incoming_chat_id = 0;
+    if (!text || !cJSON_IsString(text) || !read_allowed_chat(message, &incoming_chat_id)) {
+        return true;
+    }
+
+    // The keyboard needs Telegram markup, so /actions is answered here.
+    if (quick_action_is_menu_command(text->valuestring)) {
+        queue_output(incoming_chat_id, true, "");
+        return true;
+    }
+
+    // Push message to input queue. The primary chat shares the local
+    // conversation; every other chat gets its own.
+    channel_msg_t msg;
+    msg.chat_id = incoming_chat_id == s_chat_ids[0] ? CHAT_ID_LOCAL : incoming_chat_id;
+    msg.source = MSG_SOURCE_USER;
+    strncpy(msg.text, text->valuestring, CHANNEL_RX_BUF_SIZE - 1);
+    msg.text[CHANNEL_RX_BUF_SIZE - 1] = '\0';
+
+    if (xQueueSend(s_input_queue, &msg, pdMS_TO_TICKS(100)) != pdTRUE) {
+        ESP_LOGW(TAG, "Input queue full; leaving the rest for the next poll");
+        return false;
+    }
+    ESP_LOGI(TAG, "Received: %s", msg.text);
+    return true;
+}
+
+// Shared by polling and the webhook. Returns false only when the agent queue
+// is full and the update must be delivered again.
+static bool accept_update(const telegram_update_t *update)
+{
+    if (update->update_id >= 0 && update->update_id <= s_last_update_id) {
+        ESP_LOGD(TAG, "Skipping duplicate update %" PRId64, update->update_id);
+        return true;
+    }
+
+    if (!update->json) {
+        ESP_LOGW(TAG, "Skipping oversized update %" PRId64, update->update_id);
+    } else {
+        cJSON *root = cJSON_Parse(update->json);
+        if (!root) {
+            ESP_LOGW(TAG, "Skipping unparseable update %" PRId64, update->update_id);
+        } else {
+            bool queued = queue_update_message(root);
+            cJSON_Delete(root);
+            if (!queued) {
+                return false;
+            }
+        }
+    }
+
+    // Confirm as we go: an update handled here is never fetched twice, even
+    // if the connection drops before the response ends.
+    if (update->update_id > s_last_update_id) {
+        s_last_update_id = update->update_id;
+    }
+    return true;
+}
+
+static bool handle_update(const telegram_update_t *update, void *arg)
+{
+    telegram_poll_ctx_t *ctx = (telegram_poll_ctx_t *)arg;
+
+    if (!accept_update(update)) {
+        ctx->input_full = true;
+        return false;
+    }
+    ctx->accepted++;
+    return true;
+}
+
 // Poll for updates using long polling
 static esp_err_t telegram_poll(void)
 {
     char url[384];
-    telegram_http_ctx_t *ctx = NULL;
+    telegram_poll_ctx_t *ctx = NULL;
     esp_http_client_handle_t client = NULL;
     esp_err_t err;
     int status;
 
-    snprintf(url, sizeof(url), "%s%s/getUpdates?timeout=%d&limit=1&offset=%" PRId64,
-             TELEGRAM_API_URL, s_bot_token, TELEGRAM_POLL_TIMEOUT, s_last_update_id + 1);
+    snprintf(url, sizeof(url), "%s%s/getUpdates?timeout=%d&limit=%d&offset=%" PRId64,
+             s_api_url, s_bot_token, TELEGRAM_POLL_TIMEOUT, TELEGRAM_POLL_LIMIT,
+             s_last_update_id + 1);
 
     ctx = calloc(1, sizeof(*ctx));
     if (!ctx) {
         return ESP_ERR_NO_MEM;
     }
+    telegram_update_stream_init(&ctx->stream, TELEGRAM_UPDATE_MAX_LEN, handle_update, ctx);
 
     esp_http_client_config_t config = {
         .url = url,
-        .event_handler = http_event_handler,
+        .event_handler = poll_event_handler,
         .user_data = ctx,
         .timeout_ms = (TELEGRAM_POLL_TIMEOUT + 10) * 1000,  // Add buffer to timeout
         .crt_bundle_attach = esp_crt_bundle_attach,
@@ -253,117 +663,211 @@ static esp_err_t telegram_poll(void)
     esp_http_client_cleanup(client);
     client = NULL;
 
-    if (err != ESP_OK || status != 200) {
-        ESP_LOGE(TAG, "getUpdates failed: err=%d status=%d", err, status);
-        free(ctx);
-        return ESP_FAIL;
+    bool complete = telegram_update_stream_finish(&ctx->stream);
+    telegram_update_stream_free(&ctx->stream);
+
+    if (ctx->accepted > 1) {
+        ESP_LOGI(TAG, "Drained %d updates in one poll", ctx->accepted);
     }
 
-    if (ctx->truncated) {
-        int64_t recovered_update_id = 0;
-        if (telegram_extract_max_update_id(ctx->buf, &recovered_update_id)) {
-            s_last_update_id = recovered_update_id;
-            ESP_LOGW(TAG, "Recovered from truncated response, skipping to update_id=%" PRId64,
-                     s_last_update_id);
-            free(ctx);
-            return ESP_OK;
+    if (err != ESP_OK || status != 200) {
+        ESP_LOGE(TAG, "getUpdates failed: err=%d status=%d", err, status);
+        if (ctx->error[0] != '\0') {
+            ESP_LOGE(TAG, "getUpdates response: %s", ctx->error);
         }
-
-        ESP_LOGE(TAG, "Truncated response without parseable update_id");
         free(ctx);
         return ESP_FAIL;
     }
-
-    // Parse response
-    cJSON *root = cJSON_Parse(ctx->buf);
-    if (!root) {
-        ESP_LOGE(TAG, "Failed to parse response");
+    if (!complete) {
+        ESP_LOGE(TAG, "Incomplete getUpdates response after %d updates", ctx->accepted);
         free(ctx);
         return ESP_FAIL;
     }
 
-    cJSON *ok = cJSON_GetObjectItem(root, "ok");
-    if (!ok || !cJSON_IsTrue(ok)) {
-        ESP_LOGE(TAG, "API returned not ok");
-        cJSON_Delete(root);
-        free(ctx);
-        return ESP_FAIL;
-    }
+    bool input_full = ctx->input_full;
+    free(ctx);
 
-    cJSON *result = cJSON_GetObjectItem(root, "result");
-    if (!result || !cJSON_IsArray(result)) {
-        cJSON_Delete(root);
-        free(ctx);
-        return ESP_OK;  // No updates, that's fine
+    // The unconfirmed updates come back on the next poll; let the agent
+    // make room first instead of fetching them over and over.
+    while (input_full && uxQueueSpacesAvailable(s_input_queue) == 0) {
+        vTaskDelay(pdMS_TO_TICKS(TELEGRAM_INPUT_WAIT_MS));
     }
+    return ESP_OK;
+}
 
-    cJSON *update;
-    cJSON_ArrayForEach(update, result) {
-        cJSON *update_id = cJSON_GetObjectItem(update, "update_id");
-        if (update_id && cJSON_IsNumber(update_id)) {
-            // Note: cJSON stores numbers as double (53-bit precision).
-            // Telegram update IDs fit safely within this range.
-            s_last_update_id = (int64_t)update_id->valuedouble;
-        }
-
-        cJSON *message = cJSON_GetObjectItem(update, "message");
-        if (!message) continue;
-
-        cJSON *chat = cJSON_GetObjectItem(message, "chat");
-        cJSON *text = cJSON_GetObjectItem(message, "text");
-
-        if (chat && text && cJSON_IsString(text)) {
-            cJSON *chat_id = cJSON_GetObjectItem(chat, "id");
-            if (chat_id && cJSON_IsNumber(chat_id)) {
-                // Note: cJSON stores numbers as double (53-bit precision)
-                // Telegram chat IDs fit within this range
-                int64_t incoming_chat_id = (int64_t)chat_id->valuedouble;
-
-                // Sanity check for precision loss (chat IDs > 2^53)
-                if (chat_id->valuedouble > 9007199254740992.0) {
-                    ESP_LOGW(TAG, "Chat ID may have precision loss");
-                }
+// Webhook receiver: one update per POST, pushed by the reverse proxy that
+// owns the public setWebhook URL. The body goes through the same streaming
+// parser as a getUpdates response, wrapped as a one-element result, so the
+// update_id, size limit and auth checks are identical. A non-2xx reply makes
+// the sender retry.
+#define WEBHOOK_ENVELOPE_HEAD   "{\"ok\":true,\"result\":["
+#define WEBHOOK_ENVELOPE_TAIL   "]}"
+#define WEBHOOK_RECV_CHUNK      512
 
-                // Authentication: reject messages from unknown chat IDs
-                if (s_chat_id != 0 && incoming_chat_id != s_chat_id) {
-                    ESP_LOGW(TAG, "Rejected message from unauthorized chat: %" PRId64, incoming_chat_id);
-                    continue;
-                }
+static bool handle_webhook_update(const telegram_update_t *update, void *arg)
+{
+    bool *input_full = (bool *)arg;
 
-                // If no chat ID configured, reject all (must be set during provisioning)
-                if (s_chat_id == 0) {
-                    ESP_LOGW(TAG, "No chat ID configured - ignoring message from %" PRId64, incoming_chat_id);
-                    continue;
-                }
+    if (!accept_update(update)) {
+        *input_full = true;
+        return false;
+    }
+    return true;
+}
 
-                // Push message to input queue
-                channel_msg_t msg;
-                strncpy(msg.text, text->valuestring, CHANNEL_RX_BUF_SIZE - 1);
-                msg.text[CHANNEL_RX_BUF_SIZE - 1] = '\0';
+static esp_err_t webhook_post_handler(httpd_req_t *req)
+{
+    char secret[TELEGRAM_WEBHOOK_SECRET_MAX_LEN + 1];
+    char chunk[WEBHOOK_RECV_CHUNK];
+    telegram_update_stream_t stream;
+    bool input_full = false;
+    size_t remaining = req->content_len;
+
+    if (httpd_req_get_hdr_value_str(req, TELEGRAM_WEBHOOK_SECRET_HEADER,
+                                    secret, sizeof(secret)) != ESP_OK ||
+        !telegram_webhook_secret_matches(s_webhook_secret, secret)) {
+        ESP_LOGW(TAG, "Rejected webhook POST with a bad secret token");
+        return httpd_resp_send_err(req, HTTPD_403_FORBIDDEN, "Forbidden");
+    }
+
+    telegram_update_stream_init(&stream, TELEGRAM_UPDATE_MAX_LEN, handle_webhook_update,
+                                &input_full);
+    telegram_update_stream_feed(&stream, WEBHOOK_ENVELOPE_HEAD, strlen(WEBHOOK_ENVELOPE_HEAD));
+    while (remaining > 0) {
+        int ret = httpd_req_recv(req, chunk, remaining < sizeof(chunk) ? remaining : sizeof(chunk));
+        if (ret == HTTPD_SOCK_ERR_TIMEOUT) {
+            continue;
+        }
+        if (ret <= 0) {
+            telegram_update_stream_free(&stream);
+            return ESP_FAIL;
+        }
+        remaining -= (size_t)ret;
+        if (!telegram_update_stream_feed(&stream, chunk, (size_t)ret)) {
+            break;
+        }
+    }
+    telegram_update_stream_feed(&stream, WEBHOOK_ENVELOPE_TAIL, strlen(WEBHOOK_ENVELOPE_TAIL));
+    bool complete = telegram_update_stream_finish(&stream);
+    telegram_update_stream_free(&stream);
 
-                ESP_LOGI(TAG, "Received: %s", msg.text);
+    if (input_full) {
+        httpd_resp_set_status(req, "503 Service Unavailable");
+        httpd_resp_set_hdr(req, "Retry-After", "1");
+        return httpd_resp_sendstr(req, "Agent busy");
+    }
+    if (!complete) {
+        ESP_LOGW(TAG, "Rejected malformed webhook body (%u bytes)", (unsigned)req->content_len);
+        return httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Malformed update");
+    }
+    return httpd_resp_sendstr(req, "");
+}
 
-                if (xQueueSend(s_input_queue, &msg, pdMS_TO_TICKS(100)) != pdTRUE) {
-                    ESP_LOGW(TAG, "Input queue full");
-                }
-            }
-        }
+static esp_err_t telegram_webhook_start(void)
+{
+    httpd_handle_t server = NULL;
+    httpd_config_t config = HTTPD_DEFAULT_CONFIG();
+    config.server_port = TELEGRAM_WEBHOOK_PORT;
+    config.ctrl_port = TELEGRAM_WEBHOOK_PORT + 1;
+    config.stack_size = CHANNEL_TASK_STACK_SIZE;
+    config.max_uri_handlers = 1;
+
+    esp_err_t err = httpd_start(&server, &config);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to start webhook server: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    const httpd_uri_t webhook_uri = {
+        .uri = TELEGRAM_WEBHOOK_PATH,
+        .method = HTTP_POST,
+        .handler = webhook_post_handler,
+        .user_ctx = NULL,
+    };
+    err = httpd_register_uri_handler(server, &webhook_uri);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to register webhook handler: %s", esp_err_to_name(err));
+        httpd_stop(server);
+        return err;
     }
 
-    cJSON_Delete(root);
-    free(ctx);
+    ESP_LOGI(TAG, "Webhook listening on port %d at %s", TELEGRAM_WEBHOOK_PORT,
+             TELEGRAM_WEBHOOK_PATH);
     return ESP_OK;
 }
 
-// Telegram response task - watches output queue, sends to Telegram
+// Reply to /actions with the pinned buttons as an inline keyboard.
+static void send_quick_actions_menu(int64_t chat_id)
+{
+    static quick_action_t actions[QUICK_ACTION_MAX];
+    int count = quick_actions_get_all(actions, QUICK_ACTION_MAX);
+    cJSON *markup = quick_action_keyboard(actions, count);
+    char *markup_json = markup ? cJSON_PrintUnformatted(markup) : NULL;
+
+    cJSON_Delete(markup);
+    if (count > 0 && !markup_json) {
+        ESP_LOGE(TAG, "Failed to build quick action keyboard");
+        return;
+    }
+    send_paced(chat_id,
+               count > 0 ? "Quick actions:"
+                         : "No quick actions pinned yet. Ask me to pin one, "
+                           "e.g. \"pin a Relay on button that sets GPIO 5 high\".",
+               markup_json);
+    cJSON_free(markup_json);
+}
+
+static int64_t reply_chat_id(const telegram_msg_t *msg)
+{
+    return msg->chat_id == CHAT_ID_LOCAL ? telegram_get_chat_id() : msg->chat_id;
+}
+
+// Telegram response task - watches output queue, sends to Telegram.
+// Consecutive replies to the same chat are merged into one sendMessage while
+// that chat's pacing slot is still closed, so bursts (cron batches, several
+// queued answers) cost one request instead of many.
 static void telegram_send_task(void *arg)
 {
     (void)arg;
     while (1) {
-        if (xQueueReceive(s_output_queue, &s_send_msg, portMAX_DELAY) == pdTRUE) {
-            if (telegram_is_configured() && s_chat_id != 0) {
-                telegram_send(s_send_msg.text);
+        if (!s_send_msg_pending &&
+            xQueueReceive(s_output_queue, &s_send_msg, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+        s_send_msg_pending = false;
+
+        int64_t chat_id = reply_chat_id(&s_send_msg);
+        if (s_send_msg.quick_actions) {
+            if (telegram_is_configured() && chat_id != 0) {
+                send_quick_actions_menu(chat_id);
+            }
+            continue;
+        }
+
+        size_t batch_len = 0;
+        int merged = 1;
+        s_send_batch[0] = '\0';
+        telegram_outbox_merge(s_send_batch, &batch_len, sizeof(s_send_batch) - 1, s_send_msg.text);
+
+        while (1) {
+            int64_t wait_ms = pacer_wait_ms(chat_id);
+            if (xQueueReceive(s_output_queue, &s_send_msg, pdMS_TO_TICKS(wait_ms)) != pdTRUE) {
+                break;
             }
+            if (s_send_msg.quick_actions || reply_chat_id(&s_send_msg) != chat_id ||
+                !telegram_outbox_merge(s_send_batch, &batch_len, sizeof(s_send_batch) - 1,
+                                       s_send_msg.text)) {
+                s_send_msg_pending = true;
+                break;
+            }
+            merged++;
+        }
+        if (merged > 1) {
+            ESP_LOGI(TAG, "Coalesced %d replies into one message", merged);
+        }
+
+        if (telegram_is_configured() && chat_id != 0) {
+            send_paced(chat_id, s_send_batch, NULL);
         }
     }
 }
@@ -428,17 +932,24 @@ esp_err_t telegram_start(QueueHandle_t input_queue, QueueHandle_t output_queue)
     s_input_queue = input_queue;
     s_output_queue = output_queue;
 
-    TaskHandle_t poll_task = NULL;
-    if (xTaskCreate(telegram_poll_task, "tg_poll", CHANNEL_TASK_STACK_SIZE, NULL,
-                    CHANNEL_TASK_PRIORITY, &poll_task) != pdPASS) {
-        ESP_LOGE(TAG, "Failed to create Telegram poll task");
+    if (xTaskCreate(telegram_send_task, "tg_send", CHANNEL_TASK_STACK_SIZE, NULL,
+                    CHANNEL_TASK_PRIORITY, NULL) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create Telegram send task");
         return ESP_ERR_NO_MEM;
     }
 
-    if (xTaskCreate(telegram_send_task, "tg_send", CHANNEL_TASK_STACK_SIZE, NULL,
+    if (s_webhook_secret[0] != '\0') {
+        esp_err_t err = telegram_webhook_start();
+        if (err == ESP_OK) {
+            ESP_LOGI(TAG, "Telegram tasks started (webhook mode)");
+            return ESP_OK;
+        }
+        ESP_LOGW(TAG, "Falling back to long polling");
+    }
+
+    if (xTaskCreate(telegram_poll_task, "tg_poll", CHANNEL_TASK_STACK_SIZE, NULL,
                     CHANNEL_TASK_PRIORITY, NULL) != pdPASS) {
-        ESP_LOGE(TAG, "Failed to create Telegram send task");
-        vTaskDelete(poll_task);
+        ESP_LOGE(TAG, "Failed to create Telegram poll task");
         return ESP_ERR_NO_MEM;
     }
 
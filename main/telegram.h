@@ -5,6 +5,7 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/queue.h"
 #include <stdbool.h>
+#include <stdint.h>
 
 // Initialize Telegram client
 esp_err_t telegram_init(void);
@@ -12,16 +13,19 @@ esp_err_t telegram_init(void);
 // Start Telegram polling task
 esp_err_t telegram_start(QueueHandle_t input_queue, QueueHandle_t output_queue);
 
-// Send a message to the configured chat
+// Send a message to the primary (first configured) chat
 esp_err_t telegram_send(const char *text);
 
+// Send a message to a specific chat
+esp_err_t telegram_send_to(int64_t chat_id, const char *text);
+
 // Send startup notification
 esp_err_t telegram_send_startup(void);
 
 // Check if Telegram is configured (token exists)
 bool telegram_is_configured(void);
 
-// Get the chat ID we're responding to
+// Get the primary chat ID (0 when none is configured)
 int64_t telegram_get_chat_id(void);
 
 #endif // TELEGRAM_H
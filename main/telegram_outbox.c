@@ -0,0 +1,164 @@
+#include "telegram_outbox.h"
+#include "cJSON.h"
+#include <string.h>
+
+#define MERGE_SEPARATOR "\n\n"
+
+bool telegram_outbox_merge(char *batch, size_t *batch_len, size_t limit, const char *text)
+{
+    size_t text_len = strlen(text);
+    size_t sep_len = *batch_len > 0 ? strlen(MERGE_SEPARATOR) : 0;
+
+    if (*batch_len + sep_len + text_len > limit) {
+        return false;
+    }
+    memcpy(batch + *batch_len, MERGE_SEPARATOR, sep_len);
+    memcpy(batch + *batch_len + sep_len, text, text_len);
+    *batch_len += sep_len + text_len;
+    batch[*batch_len] = '\0';
+    return true;
+}
+
+// Last occurrence of needle ending at or before end, starting at or after min.
+static size_t find_last(const char *text, size_t min, size_t end, const char *needle)
+{
+    size_t needle_len = strlen(needle);
+
+    for (size_t pos = end; pos >= min + needle_len && pos > 0; pos--) {
+        if (memcmp(text + pos - needle_len, needle, needle_len) == 0) {
+            return pos - needle_len;
+        }
+    }
+    return 0;
+}
+
+size_t telegram_outbox_split(const char *text, size_t len, size_t limit, size_t *next)
+{
+    static const char *const boundaries[] = { "\n\n", "\n", " " };
+    size_t cut = 0;
+
+    if (len <= limit) {
+        *next = len;
+        return len;
+    }
+
+    for (size_t i = 0; i < sizeof(boundaries) / sizeof(boundaries[0]) && cut == 0; i++) {
+        cut = find_last(text, limit / 2, limit, boundaries[i]);
+    }
+    if (cut == 0) {
+        // No boundary worth using: hard cut, backing off UTF-8 continuation bytes.
+        cut = limit;
+        while (cut > 0 && ((unsigned char)text[cut] & 0xC0) == 0x80) {
+            cut--;
+        }
+        if (cut == 0) {
+            cut = limit;
+        }
+    }
+
+    size_t skip = cut;
+    while (skip < len && (text[skip] == '\n' || text[skip] == ' ')) {
+        skip++;
+    }
+    *next = skip;
+    return cut;
+}
+
+int telegram_outbox_retry_after(const char *body)
+{
+    int retry_after = -1;
+
+    if (!body) {
+        return -1;
+    }
+    cJSON *root = cJSON_Parse(body);
+    if (!root) {
+        return -1;
+    }
+    cJSON *params = cJSON_GetObjectItem(root, "parameters");
+    cJSON *value = params ? cJSON_GetObjectItem(params, "retry_after") : NULL;
+    if (value && cJSON_IsNumber(value) && value->valuedouble >= 0) {
+        retry_after = value->valuedouble > TELEGRAM_RETRY_AFTER_MAX_S
+                          ? TELEGRAM_RETRY_AFTER_MAX_S
+                          : (int)value->valuedouble;
+    }
+    cJSON_Delete(root);
+    return retry_after;
+}
+
+void telegram_pacer_init(telegram_pacer_t *pacer)
+{
+    memset(pacer, 0, sizeof(*pacer));
+}
+
+static const telegram_pacer_chat_t *find_chat(const telegram_pacer_t *pacer, int64_t chat_id)
+{
+    for (size_t i = 0; i < TELEGRAM_MAX_CHATS; i++) {
+        if (pacer->chats[i].used && pacer->chats[i].chat_id == chat_id) {
+            return &pacer->chats[i];
+        }
+    }
+    return NULL;
+}
+
+// Entry for chat_id, reusing the one whose hold expired first when full.
+static telegram_pacer_chat_t *claim_chat(telegram_pacer_t *pacer, int64_t chat_id)
+{
+    telegram_pacer_chat_t *slot = (telegram_pacer_chat_t *)find_chat(pacer, chat_id);
+
+    if (slot) {
+        return slot;
+    }
+    for (size_t i = 0; i < TELEGRAM_MAX_CHATS; i++) {
+        telegram_pacer_chat_t *entry = &pacer->chats[i];
+        if (!entry->used) {
+            slot = entry;
+            break;
+        }
+        if (!slot || entry->next_ms < slot->next_ms) {
+            slot = entry;
+        }
+    }
+    slot->chat_id = chat_id;
+    slot->next_ms = 0;
+    slot->used = true;
+    return slot;
+}
+
+int64_t telegram_pacer_wait_ms(const telegram_pacer_t *pacer, int64_t chat_id, int64_t now_ms)
+{
+    const telegram_pacer_chat_t *chat = find_chat(pacer, chat_id);
+    int64_t next_ms = pacer->global_next_ms;
+
+    if (chat && chat->next_ms > next_ms) {
+        next_ms = chat->next_ms;
+    }
+    return next_ms > now_ms ? next_ms - now_ms : 0;
+}
+
+void telegram_pacer_sent(telegram_pacer_t *pacer, int64_t chat_id, int64_t now_ms)
+{
+    telegram_pacer_chat_t *chat = claim_chat(pacer, chat_id);
+    int64_t interval_ms = chat_id < 0 ? TELEGRAM_GROUP_INTERVAL_MS : TELEGRAM_CHAT_INTERVAL_MS;
+
+    if (chat->next_ms < now_ms + interval_ms) {
+        chat->next_ms = now_ms + interval_ms;
+    }
+    pacer->global_next_ms = now_ms + TELEGRAM_GLOBAL_INTERVAL_MS;
+}
+
+void telegram_pacer_retry_after(telegram_pacer_t *pacer, int64_t chat_id, int64_t now_ms,
+                                int retry_after_s)
+{
+    telegram_pacer_chat_t *chat = claim_chat(pacer, chat_id);
+
+    if (retry_after_s < 1) {
+        retry_after_s = 1;
+    } else if (retry_after_s > TELEGRAM_RETRY_AFTER_MAX_S) {
+        retry_after_s = TELEGRAM_RETRY_AFTER_MAX_S;
+    }
+    int64_t until_ms = now_ms + (int64_t)retry_after_s * 1000;
+    if (chat->next_ms < until_ms) {
+        chat->next_ms = until_ms;
+    }
+}
@@ -0,0 +1,49 @@
+#ifndef TELEGRAM_OUTBOX_H
+#define TELEGRAM_OUTBOX_H
+
+#include "config.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Outbound Telegram helpers: merging queued replies into fewer sendMessage
+// calls, splitting text that is over the limit, and pacing sends to stay
+// under Telegram's flood limits (and to honour 429 retry_after).
+
+// Append text to a pending batch, separated by a blank line. Returns false,
+// leaving the batch unchanged, when the result would not fit in limit chars.
+bool telegram_outbox_merge(char *batch, size_t *batch_len, size_t limit, const char *text);
+
+// Length of the first chunk of text (at most limit) to send on its own,
+// cutting at a paragraph, line or word boundary in the second half of the
+// window when there is one and never inside a UTF-8 sequence. *next receives
+// where the following chunk starts, past the separator.
+size_t telegram_outbox_split(const char *text, size_t len, size_t limit, size_t *next);
+
+// retry_after seconds from a 429 response body, or -1 when absent.
+int telegram_outbox_retry_after(const char *body);
+
+typedef struct {
+    int64_t chat_id;
+    int64_t next_ms;                // Earliest time the next send may go out
+    bool used;
+} telegram_pacer_chat_t;
+
+typedef struct {
+    telegram_pacer_chat_t chats[TELEGRAM_MAX_CHATS];
+    int64_t global_next_ms;
+} telegram_pacer_t;
+
+void telegram_pacer_init(telegram_pacer_t *pacer);
+
+// Milliseconds to wait before sending to chat_id (0 = now).
+int64_t telegram_pacer_wait_ms(const telegram_pacer_t *pacer, int64_t chat_id, int64_t now_ms);
+
+// Record a send; groups (negative IDs) get the slower per-chat interval.
+void telegram_pacer_sent(telegram_pacer_t *pacer, int64_t chat_id, int64_t now_ms);
+
+// Hold off chat_id for retry_after_s after a 429 (capped at TELEGRAM_RETRY_AFTER_MAX_S).
+void telegram_pacer_retry_after(telegram_pacer_t *pacer, int64_t chat_id, int64_t now_ms,
+                                int retry_after_s);
+
+#endif // TELEGRAM_OUTBOX_H
@@ -1,4 +1,5 @@
 #include "telegram_update.h"
+#include "config.h"
 #include <string.h>
 #include <stdlib.h>
 
@@ -44,3 +45,262 @@ bool telegram_extract_max_update_id(const char *buf, int64_t *max_id_out)
 
     return false;
 }
+
+#define STREAM_MAX_DEPTH    32
+#define STREAM_INITIAL_CAP  512
+
+void telegram_update_stream_init(telegram_update_stream_t *stream, size_t max_update_len,
+                                 telegram_update_cb_t on_update, void *ctx)
+{
+    memset(stream, 0, sizeof(*stream));
+    stream->on_update = on_update;
+    stream->ctx = ctx;
+    stream->max_update_len = max_update_len;
+    stream->update_id = -1;
+}
+
+void telegram_update_stream_free(telegram_update_stream_t *stream)
+{
+    free(stream->buf);
+    stream->buf = NULL;
+    stream->cap = 0;
+    stream->len = 0;
+}
+
+static bool key_is(const char *key, const char *name)
+{
+    return strcmp(key, name) == 0;
+}
+
+static bool tracks_keys(const telegram_update_stream_t *stream)
+{
+    return stream->depth == 1 || (stream->depth == 3 && stream->in_update);
+}
+
+static bool append(telegram_update_stream_t *stream, char c)
+{
+    if (stream->oversize) {
+        return true;
+    }
+    if (stream->len >= stream->max_update_len) {
+        // Keep lexing so the update_id is still known; only the body is lost.
+        stream->oversize = true;
+        return true;
+    }
+    if (stream->len + 2 > stream->cap) {
+        size_t cap = stream->cap ? stream->cap * 2 : STREAM_INITIAL_CAP;
+        if (cap > stream->max_update_len + 1) {
+            cap = stream->max_update_len + 1;
+        }
+        char *grown = realloc(stream->buf, cap);
+        if (!grown) {
+            return false;
+        }
+        stream->buf = grown;
+        stream->cap = cap;
+    }
+    stream->buf[stream->len++] = c;
+    return true;
+}
+
+static void begin_update(telegram_update_stream_t *stream)
+{
+    stream->in_update = true;
+    stream->len = 0;
+    stream->oversize = false;
+    stream->update_id = -1;
+}
+
+static void emit_update(telegram_update_stream_t *stream)
+{
+    telegram_update_t update = {
+        .json = NULL,
+        .len = 0,
+        .update_id = stream->update_id,
+    };
+
+    stream->in_update = false;
+    if (!stream->oversize && stream->buf) {
+        stream->buf[stream->len] = '\0';
+        update.json = stream->buf;
+        update.len = stream->len;
+    }
+    stream->count++;
+    if (stream->on_update && !stream->on_update(&update, stream->ctx)) {
+        stream->stopped = true;
+    }
+}
+
+static bool feed_char(telegram_update_stream_t *stream, char c)
+{
+    bool capturing = stream->in_update;
+
+    if (stream->in_string) {
+        if (capturing && !append(stream, c)) {
+            return false;
+        }
+        if (stream->escape) {
+            stream->escape = false;
+        } else if (c == '\\') {
+            stream->escape = true;
+        } else if (c == '"') {
+            stream->in_string = false;
+        } else if (stream->key_len < sizeof(stream->key) - 1) {
+            stream->key[stream->key_len++] = c;
+            stream->key[stream->key_len] = '\0';
+        } else {
+            // Longer than any key we track: make sure it matches nothing.
+            stream->key[0] = '\0';
+        }
+        return true;
+    }
+
+    switch (c) {
+        case ' ':
+        case '\t':
+        case '\r':
+        case '\n':
+            stream->reading_id = false;
+            return !capturing || append(stream, c);
+
+        case '"':
+            stream->reading_id = false;
+            stream->in_string = true;
+            stream->key_len = 0;
+            stream->key[0] = '\0';
+            stream->expect_value = false;
+            return !capturing || append(stream, c);
+
+        case ':':
+            stream->reading_id = false;
+            if (tracks_keys(stream)) {
+                memcpy(stream->value_key, stream->key, sizeof(stream->value_key));
+                stream->expect_value = true;
+            }
+            return !capturing || append(stream, c);
+
+        case '{':
+        case '[':
+            stream->reading_id = false;
+            if (stream->expect_value && stream->depth == 1 && c == '[' &&
+                key_is(stream->value_key, "result")) {
+                stream->in_result = true;
+            }
+            stream->expect_value = false;
+            if (stream->depth == 2 && stream->in_result && c == '{') {
+                begin_update(stream);
+                capturing = true;
+            }
+            if (++stream->depth > STREAM_MAX_DEPTH) {
+                return false;
+            }
+            return !capturing || append(stream, c);
+
+        case '}':
+        case ']':
+            stream->reading_id = false;
+            stream->expect_value = false;
+            if (capturing && !append(stream, c)) {
+                return false;
+            }
+            if (--stream->depth < 0) {
+                return false;
+            }
+            if (stream->in_update && stream->depth == 2) {
+                if (c != '}') {
+                    return false;
+                }
+                emit_update(stream);
+            } else if (stream->in_result && stream->depth == 1) {
+                stream->in_result = false;
+                stream->result_done = true;
+            }
+            return true;
+
+        case ',':
+            stream->reading_id = false;
+            stream->expect_value = false;
+            return !capturing || append(stream, c);
+
+        default:
+            // First character of a literal value (number, true, false, null).
+            if (stream->expect_value) {
+                if (stream->depth == 1 && key_is(stream->value_key, "ok")) {
+                    stream->ok = c == 't';
+                } else if (stream->depth == 3 && key_is(stream->value_key, "update_id") &&
+                           c >= '0' && c <= '9') {
+                    stream->reading_id = true;
+                    stream->update_id = 0;
+                }
+                stream->expect_value = false;
+            }
+            if (stream->reading_id) {
+                if (c >= '0' && c <= '9' && stream->update_id < (INT64_MAX - 9) / 10) {
+                    stream->update_id = stream->update_id * 10 + (c - '0');
+                } else {
+                    stream->reading_id = false;
+                }
+            }
+            return !capturing || append(stream, c);
+    }
+}
+
+bool telegram_update_stream_feed(telegram_update_stream_t *stream, const char *data, size_t len)
+{
+    if (!stream || (!data && len > 0)) {
+        return false;
+    }
+    for (size_t i = 0; i < len && !stream->stopped && !stream->failed; i++) {
+        if (!feed_char(stream, data[i])) {
+            stream->failed = true;
+        }
+    }
+    return !stream->failed;
+}
+
+bool telegram_update_stream_finish(const telegram_update_stream_t *stream)
+{
+    if (stream->stopped) {
+        return true;
+    }
+    return !stream->failed && stream->ok && stream->result_done && stream->depth == 0 &&
+           !stream->in_string;
+}
+
+bool telegram_webhook_secret_is_valid(const char *secret)
+{
+    size_t len = 0;
+
+    if (!secret) {
+        return false;
+    }
+    for (const char *p = secret; *p; p++, len++) {
+        char c = *p;
+        if (!((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') ||
+              c == '_' || c == '-')) {
+            return false;
+        }
+    }
+    return len >= 1 && len <= TELEGRAM_WEBHOOK_SECRET_MAX_LEN;
+}
+
+bool telegram_webhook_secret_matches(const char *expected, const char *provided)
+{
+    size_t expected_len;
+    size_t provided_len;
+    unsigned char diff;
+
+    if (!expected || !provided || expected[0] == '\0') {
+        return false;
+    }
+    expected_len = strlen(expected);
+    provided_len = strlen(provided);
+
+    // Always walk the whole configured secret; a length mismatch still fails.
+    diff = expected_len != provided_len;
+    for (size_t i = 0; i < expected_len; i++) {
+        unsigned char got = i < provided_len ? (unsigned char)provided[i] : 0;
+        diff |= (unsigned char)expected[i] ^ got;
+    }
+    return diff == 0;
+}
@@ -2,10 +2,77 @@
 #define TELEGRAM_UPDATE_H
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 // Best-effort parser for recovering the max update_id from partially received JSON.
 // Returns true and sets max_id_out when at least one non-negative update_id is found.
 bool telegram_extract_max_update_id(const char *buf, int64_t *max_id_out);
 
+// Incremental splitter for getUpdates responses. Feed the body in chunks as
+// it arrives; each complete element of "result" is handed to the callback
+// as soon as its closing brace is seen, so the response size is unbounded
+// and only one update is held in RAM at a time.
+
+typedef struct {
+    const char *json;       // Update object, NUL-terminated; NULL when over max_update_len
+    size_t len;
+    int64_t update_id;      // Top-level update_id, or -1 when missing
+} telegram_update_t;
+
+// Return false to stop: the rest of the response is ignored, so those
+// updates are delivered again by the next getUpdates with the same offset.
+typedef bool (*telegram_update_cb_t)(const telegram_update_t *update, void *ctx);
+
+typedef struct {
+    telegram_update_cb_t on_update;
+    void *ctx;
+    size_t max_update_len;
+
+    // Lexer
+    int depth;
+    bool in_string;
+    bool escape;
+    bool expect_value;      // After ':' at a tracked depth
+    char key[16];           // Last key at the root or update level
+    size_t key_len;
+    char value_key[16];     // Key whose value is being read
+
+    // Envelope
+    bool ok;
+    bool in_result;
+    bool in_update;
+    bool result_done;
+    bool stopped;
+    bool failed;
+
+    // Current update
+    char *buf;
+    size_t len;
+    size_t cap;
+    bool oversize;
+    bool reading_id;
+    int64_t update_id;
+    size_t count;           // Updates handed to the callback
+} telegram_update_stream_t;
+
+void telegram_update_stream_init(telegram_update_stream_t *stream, size_t max_update_len,
+                                 telegram_update_cb_t on_update, void *ctx);
+
+// Returns false once the body is malformed or the update buffer can't grow.
+bool telegram_update_stream_feed(telegram_update_stream_t *stream, const char *data, size_t len);
+
+// True when the body was a complete {"ok":true,"result":[...]} response, or
+// the callback stopped it early.
+bool telegram_update_stream_finish(const telegram_update_stream_t *stream);
+
+void telegram_update_stream_free(telegram_update_stream_t *stream);
+
+// Webhook secret_token as Telegram accepts it: 1-256 of A-Z, a-z, 0-9, '_', '-'.
+bool telegram_webhook_secret_is_valid(const char *secret);
+
+// Compare the X-Telegram-Bot-Api-Secret-Token header against the configured
+// secret in time independent of where they differ.
+bool telegram_webhook_secret_matches(const char *expected, const char *provided);
+
 #endif // TELEGRAM_UPDATE_H
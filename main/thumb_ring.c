@@ -0,0 +1,195 @@
+#include "thumb_ring.h"
+#include <string.h>
+
+#define SHEET_GUTTER_COLOR  0x2104u         // Dark gray, RGB565
+#define LABEL_FG            0xFFFFu
+#define LABEL_BG            0x0000u
+#define LABEL_SCALE         2               // 3x5 digits drawn at 6x10
+
+// 3x5 digit glyphs, one bit per pixel, top row in the high bits.
+static const uint16_t s_digits[10] = {
+    0x7B6F, 0x2C97, 0x73E7, 0x73CF, 0x5BC9, 0x79CF, 0x79EF, 0x7249, 0x7BEF, 0x7BCF,
+};
+
+void thumb_ring_init(thumb_ring_t *ring, uint8_t *arena, size_t arena_size)
+{
+    memset(ring, 0, sizeof(*ring));
+    ring->arena = arena;
+    ring->arena_size = arena_size;
+}
+
+static bool overlaps(size_t a, size_t a_len, size_t b, size_t b_len)
+{
+    return a < b + b_len && b < a + a_len;
+}
+
+bool thumb_ring_push(thumb_ring_t *ring, int64_t time_ms, const uint8_t *jpeg, size_t len)
+{
+    size_t pos = ring->write_pos;
+    bool wrap;
+
+    if (!jpeg || len == 0 || len > ring->arena_size) {
+        return false;
+    }
+
+    // Frames are stored whole; one that does not fit before the end of the
+    // arena goes to the start, and the tail it skips is given up with it.
+    wrap = pos + len > ring->arena_size;
+    if (wrap) {
+        pos = 0;
+    }
+
+    // The bytes just past write_pos always belong to the oldest frames, so
+    // freeing the region means dropping from the head until nothing overlaps.
+    while (ring->count > 0) {
+        const thumb_entry_t *oldest = &ring->entries[ring->head];
+        bool hit = overlaps(oldest->offset, oldest->len, pos, len);
+
+        if (wrap) {
+            hit = hit || oldest->offset >= ring->write_pos;
+        }
+        if (!hit && ring->count < THUMB_RING_MAX_FRAMES) {
+            break;
+        }
+        ring->head = (ring->head + 1) % THUMB_RING_MAX_FRAMES;
+        ring->count--;
+    }
+
+    thumb_entry_t *entry = &ring->entries[(ring->head + ring->count) % THUMB_RING_MAX_FRAMES];
+    entry->time_ms = time_ms;
+    entry->offset = (uint32_t)pos;
+    entry->len = (uint32_t)len;
+    memcpy(ring->arena + pos, jpeg, len);
+    ring->count++;
+    ring->write_pos = pos + len;
+    return true;
+}
+
+const thumb_entry_t *thumb_ring_get(const thumb_ring_t *ring, int i)
+{
+    if (i < 0 || i >= ring->count) {
+        return NULL;
+    }
+    return &ring->entries[(ring->head + i) % THUMB_RING_MAX_FRAMES];
+}
+
+int thumb_ring_select(const thumb_ring_t *ring, int64_t from_ms, int64_t to_ms, int max,
+                      int *out)
+{
+    int first = 0;
+    int last = ring->count - 1;
+
+    if (max <= 0) {
+        return 0;
+    }
+    while (first <= last && thumb_ring_get(ring, first)->time_ms < from_ms) {
+        first++;
+    }
+    while (last >= first && thumb_ring_get(ring, last)->time_ms > to_ms) {
+        last--;
+    }
+
+    int available = last - first + 1;
+    if (available <= 0) {
+        return 0;
+    }
+    if (available <= max) {
+        for (int i = 0; i < available; i++) {
+            out[i] = first + i;
+        }
+        return available;
+    }
+    if (max == 1) {
+        out[0] = last;
+        return 1;
+    }
+    for (int i = 0; i < max; i++) {
+        // Rounded, so the picks land on both ends and never repeat.
+        out[i] = first + (i * (available - 1) + (max - 1) / 2) / (max - 1);
+    }
+    return max;
+}
+
+void thumb_sheet_layout(int count, thumb_sheet_t *sheet)
+{
+    int cols = 1;
+
+    if (count < 1) {
+        count = 1;
+    }
+    while (cols * cols < count) {
+        cols++;
+    }
+    sheet->cols = cols;
+    sheet->rows = (count + cols - 1) / cols;
+    sheet->width = cols * THUMB_TILE_W + (cols - 1) * THUMB_SHEET_GUTTER;
+    sheet->height = sheet->rows * THUMB_TILE_H + (sheet->rows - 1) * THUMB_SHEET_GUTTER;
+}
+
+static void put_pixel(uint8_t *canvas, int width, int x, int y, uint16_t color)
+{
+    uint8_t *p = canvas + ((size_t)y * width + x) * 2;
+
+    p[0] = (uint8_t)(color >> 8);
+    p[1] = (uint8_t)color;
+}
+
+static void fill_rect(uint8_t *canvas, int width, int x0, int y0, int w, int h, uint16_t color)
+{
+    for (int y = y0; y < y0 + h; y++) {
+        for (int x = x0; x < x0 + w; x++) {
+            put_pixel(canvas, width, x, y, color);
+        }
+    }
+}
+
+void thumb_sheet_clear(const thumb_sheet_t *sheet, uint8_t *canvas)
+{
+    fill_rect(canvas, sheet->width, 0, 0, sheet->width, sheet->height, SHEET_GUTTER_COLOR);
+}
+
+// Tile number on a black label, so the model can refer to frames by number.
+static void stamp_number(uint8_t *canvas, int width, int x0, int y0, int number)
+{
+    char digits[8];
+    int n = 0;
+
+    do {
+        digits[n++] = (char)(number % 10);
+        number /= 10;
+    } while (number > 0 && n < (int)sizeof(digits));
+
+    int glyph_w = 3 * LABEL_SCALE;
+    int glyph_h = 5 * LABEL_SCALE;
+    fill_rect(canvas, width, x0, y0, n * (glyph_w + LABEL_SCALE) + LABEL_SCALE,
+              glyph_h + 2 * LABEL_SCALE, LABEL_BG);
+
+    for (int d = 0; d < n; d++) {
+        uint16_t glyph = s_digits[(int)digits[n - 1 - d]];
+        int gx = x0 + LABEL_SCALE + d * (glyph_w + LABEL_SCALE);
+        int gy = y0 + LABEL_SCALE;
+
+        for (int bit = 0; bit < 15; bit++) {
+            if (glyph & (0x4000u >> bit)) {
+                fill_rect(canvas, width, gx + (bit % 3) * LABEL_SCALE,
+                          gy + (bit / 3) * LABEL_SCALE, LABEL_SCALE, LABEL_SCALE, LABEL_FG);
+            }
+        }
+    }
+}
+
+void thumb_sheet_place(const thumb_sheet_t *sheet, uint8_t *canvas, int index,
+                       const uint8_t *tile)
+{
+    int x0 = (index % sheet->cols) * (THUMB_TILE_W + THUMB_SHEET_GUTTER);
+    int y0 = (index / sheet->cols) * (THUMB_TILE_H + THUMB_SHEET_GUTTER);
+
+    if (index < 0 || index >= sheet->cols * sheet->rows) {
+        return;
+    }
+    for (int y = 0; y < THUMB_TILE_H; y++) {
+        memcpy(canvas + ((size_t)(y0 + y) * sheet->width + x0) * 2,
+               tile + (size_t)y * THUMB_TILE_W * 2, THUMB_TILE_W * 2);
+    }
+    stamp_number(canvas, sheet->width, x0, y0, index + 1);
+}
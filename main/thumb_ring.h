@@ -0,0 +1,62 @@
+#ifndef THUMB_RING_H
+#define THUMB_RING_H
+
+#include "config.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Time-lapse thumbnails: a log of small JPEGs packed into one byte arena
+// (oldest dropped first), and helpers that lay a selection of them out as
+// a contact sheet in an RGB565 canvas.
+
+typedef struct {
+    int64_t time_ms;                // Monotonic capture time
+    uint32_t offset;                // Start in the arena
+    uint32_t len;
+} thumb_entry_t;
+
+typedef struct {
+    uint8_t *arena;
+    size_t arena_size;
+    size_t write_pos;
+    thumb_entry_t entries[THUMB_RING_MAX_FRAMES];
+    int head;                       // Oldest entry
+    int count;
+} thumb_ring_t;
+
+void thumb_ring_init(thumb_ring_t *ring, uint8_t *arena, size_t arena_size);
+
+// Append a frame, dropping the oldest ones it would overwrite. False if the
+// frame is empty or larger than the arena.
+bool thumb_ring_push(thumb_ring_t *ring, int64_t time_ms, const uint8_t *jpeg, size_t len);
+
+// Frame i, 0 = oldest. NULL when out of range.
+const thumb_entry_t *thumb_ring_get(const thumb_ring_t *ring, int i);
+
+// Up to max frames with from_ms <= time <= to_ms, spread evenly over that
+// range and always including the first and last. Writes indices for
+// thumb_ring_get() into out in time order and returns how many.
+int thumb_ring_select(const thumb_ring_t *ring, int64_t from_ms, int64_t to_ms, int max,
+                      int *out);
+
+// Contact sheet layout: tiles of THUMB_TILE_W x THUMB_TILE_H, THUMB_SHEET_GUTTER
+// pixels apart, in the most square grid that holds count tiles.
+typedef struct {
+    int cols;
+    int rows;
+    int width;
+    int height;
+} thumb_sheet_t;
+
+void thumb_sheet_layout(int count, thumb_sheet_t *sheet);
+
+// Clear the canvas (2 bytes per pixel, big-endian RGB565) to the gutter colour.
+void thumb_sheet_clear(const thumb_sheet_t *sheet, uint8_t *canvas);
+
+// Copy a decoded THUMB_TILE_W x THUMB_TILE_H RGB565 tile into slot index
+// (row-major) and stamp index + 1 in its top-left corner.
+void thumb_sheet_place(const thumb_sheet_t *sheet, uint8_t *canvas, int index,
+                       const uint8_t *tile);
+
+#endif // THUMB_RING_H
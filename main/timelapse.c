@@ -0,0 +1,181 @@
+#include "timelapse.h"
+
+#if ZCLAW_HAS_TIMELAPSE
+
+#include "camera.h"
+#include "thumb_ring.h"
+#include "tools_media.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "img_converters.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *TAG = "timelapse";
+
+// Ring and arena live in PSRAM; s_mutex guards both, since a push can
+// overwrite the bytes of a frame that is being decoded.
+static thumb_ring_t *s_ring = NULL;
+static SemaphoreHandle_t s_mutex = NULL;
+
+static int64_t now_ms(void)
+{
+    return esp_timer_get_time() / 1000;
+}
+
+// Skipped while a photo is waiting to be sent, like the motion sampler.
+static void capture_thumb(void)
+{
+    const cam_setting_t setting = { CAM_SIZE_QQVGA, THUMB_JPEG_QUALITY };
+    cam_frame_t frame;
+
+    if (!camera_lock(1000)) {
+        return;
+    }
+    if (!media_has_pending_image() && camera_apply_setting(setting) &&
+        camera_frame_get(&frame)) {
+        // Sheets decode every thumbnail into a fixed tile; keep only frames that fit.
+        if (frame.width != THUMB_TILE_W || frame.height != THUMB_TILE_H) {
+            ESP_LOGW(TAG, "Thumbnail of %ux%u skipped",
+                     (unsigned)frame.width, (unsigned)frame.height);
+        } else {
+            xSemaphoreTake(s_mutex, portMAX_DELAY);
+            if (!thumb_ring_push(s_ring, frame.captured_us / 1000, frame.buf, frame.len)) {
+                ESP_LOGW(TAG, "Thumbnail of %u bytes dropped", (unsigned)frame.len);
+            }
+            xSemaphoreGive(s_mutex);
+        }
+        camera_frame_release(&frame);
+    }
+    camera_unlock();
+}
+
+static void timelapse_task(void *arg)
+{
+    (void)arg;
+    while (1) {
+        vTaskDelay(pdMS_TO_TICKS(THUMB_INTERVAL_MS));
+        capture_thumb();
+    }
+}
+
+esp_err_t timelapse_start(void)
+{
+    uint8_t *arena = heap_caps_malloc(THUMB_RING_BYTES, MALLOC_CAP_SPIRAM);
+    thumb_ring_t *ring = heap_caps_calloc(1, sizeof(*ring), MALLOC_CAP_SPIRAM);
+
+    s_mutex = xSemaphoreCreateMutex();
+    if (!arena || !ring || !s_mutex) {
+        goto fail;
+    }
+    thumb_ring_init(ring, arena, THUMB_RING_BYTES);
+    s_ring = ring;
+
+    if (xTaskCreate(timelapse_task, "timelapse", TIMELAPSE_TASK_STACK_SIZE, NULL,
+                    TIMELAPSE_TASK_PRIORITY, NULL) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create time-lapse task");
+        s_ring = NULL;
+        goto fail;
+    }
+
+    ESP_LOGI(TAG, "Time-lapse: thumbnail every %d s, %d KB ring",
+             THUMB_INTERVAL_MS / 1000, THUMB_RING_BYTES / 1024);
+    return ESP_OK;
+
+fail:
+    if (s_mutex) {
+        vSemaphoreDelete(s_mutex);
+        s_mutex = NULL;
+    }
+    free(arena);
+    free(ring);
+    return ESP_ERR_NO_MEM;
+}
+
+static void append(char *buf, size_t buf_len, size_t *used, const char *text)
+{
+    if (*used < buf_len) {
+        *used += (size_t)snprintf(buf + *used, buf_len - *used, "%s", text);
+    }
+}
+
+bool timelapse_build_sheet(int64_t from_ago_ms, int64_t to_ago_ms, uint8_t **jpeg,
+                           size_t *jpeg_len, char *legend, size_t legend_len)
+{
+    int picks[THUMB_SHEET_MAX_TILES];
+    thumb_sheet_t sheet;
+    int64_t now = now_ms();
+    size_t used = 0;
+    char line[48];
+    bool ok = false;
+
+    *jpeg = NULL;
+    *jpeg_len = 0;
+    if (!s_ring) {
+        snprintf(legend, legend_len, "time-lapse is not running");
+        return false;
+    }
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    int count = thumb_ring_select(s_ring, now - from_ago_ms, now - to_ago_ms,
+                                  THUMB_SHEET_MAX_TILES, picks);
+    if (count == 0) {
+        const thumb_entry_t *oldest = thumb_ring_get(s_ring, 0);
+        int covered_min = oldest ? (int)((now - oldest->time_ms) / 60000) : 0;
+        xSemaphoreGive(s_mutex);
+        snprintf(legend, legend_len, "no thumbnails in that range; the time-lapse covers the last %d min",
+                 covered_min);
+        return false;
+    }
+
+    thumb_sheet_layout(count, &sheet);
+    size_t canvas_len = (size_t)sheet.width * sheet.height * 2;
+    uint8_t *canvas = heap_caps_malloc(canvas_len, MALLOC_CAP_SPIRAM);
+    uint8_t *tile = heap_caps_malloc(THUMB_TILE_W * THUMB_TILE_H * 2, MALLOC_CAP_SPIRAM);
+    if (!canvas || !tile) {
+        xSemaphoreGive(s_mutex);
+        free(canvas);
+        free(tile);
+        snprintf(legend, legend_len, "out of memory for a %dx%d sheet", sheet.width, sheet.height);
+        return false;
+    }
+
+    thumb_sheet_clear(&sheet, canvas);
+    snprintf(line, sizeof(line), "%d frames in a %dx%d grid,", count, sheet.cols, sheet.rows);
+    append(legend, legend_len, &used, line);
+    append(legend, legend_len, &used, " numbered left to right, top to bottom:");
+    for (int i = 0; i < count; i++) {
+        const thumb_entry_t *entry = thumb_ring_get(s_ring, picks[i]);
+        int age_s = (int)((now - entry->time_ms) / 1000);
+
+        if (jpg2rgb565(s_ring->arena + entry->offset, entry->len, tile, JPG_SCALE_NONE)) {
+            thumb_sheet_place(&sheet, canvas, i, tile);
+        }
+        snprintf(line, sizeof(line), " %d) %dm%02ds ago;", i + 1, age_s / 60, age_s % 60);
+        append(legend, legend_len, &used, line);
+    }
+    xSemaphoreGive(s_mutex);
+    if (used > 0 && used < legend_len && legend[used - 1] == ';') {
+        legend[used - 1] = '.';
+    }
+
+    ok = fmt2jpg(canvas, canvas_len, (uint16_t)sheet.width, (uint16_t)sheet.height,
+                 PIXFORMAT_RGB565, THUMB_SHEET_JPEG_QUALITY, jpeg, jpeg_len);
+    free(canvas);
+    free(tile);
+    if (!ok) {
+        snprintf(legend, legend_len, "contact sheet encoding failed");
+        return false;
+    }
+
+    ESP_LOGI(TAG, "Contact sheet: %d frames, %dx%d, %u bytes", count, sheet.width, sheet.height,
+             (unsigned)*jpeg_len);
+    return true;
+}
+
+#endif // ZCLAW_HAS_TIMELAPSE
@@ -0,0 +1,29 @@
+#ifndef TIMELAPSE_H
+#define TIMELAPSE_H
+
+#include "config.h"
+
+#if ZCLAW_HAS_TIMELAPSE
+
+#include "esp_err.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Time-lapse: a low-priority task keeps a QQVGA thumbnail every
+// THUMB_INTERVAL_MS in a PSRAM ring (see thumb_ring.h), so "what happened in
+// the last ten minutes" is one contact-sheet image instead of a photo per
+// moment or nothing at all.
+
+// Allocate the ring in PSRAM and start the thumbnail task.
+esp_err_t timelapse_start(void);
+
+// Compose up to THUMB_SHEET_MAX_TILES thumbnails taken between from_ago_ms
+// and to_ago_ms before now into one numbered JPEG contact sheet (caller
+// frees). legend gets one line per tile with how long ago it was taken.
+// False with legend holding the reason when there is nothing to show.
+bool timelapse_build_sheet(int64_t from_ago_ms, int64_t to_ago_ms, uint8_t **jpeg,
+                           size_t *jpeg_len, char *legend, size_t legend_len);
+
+#endif // ZCLAW_HAS_TIMELAPSE
+#endif // TIMELAPSE_H
@@ -0,0 +1,138 @@
+#include "token_bucket.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define MILLI 1000LL
+
+static int64_t full_level(const token_bucket_t *bucket)
+{
+    return (int64_t)bucket->capacity * MILLI;
+}
+
+void token_bucket_init(token_bucket_t *bucket, uint32_t capacity, uint32_t window_s,
+                       int64_t now_ms)
+{
+    bucket->capacity = capacity;
+    bucket->window_s = window_s > 0 ? window_s : 1;
+    bucket->level = full_level(bucket);
+    bucket->updated_ms = now_ms;
+}
+
+void token_bucket_credit(token_bucket_t *bucket, int64_t elapsed_ms)
+{
+    int64_t full = full_level(bucket);
+
+    if (elapsed_ms <= 0 || bucket->level >= full) {
+        return;
+    }
+    // A full window refills anything, and capping here keeps the product small.
+    int64_t window_ms = (int64_t)bucket->window_s * MILLI;
+    if (elapsed_ms >= 2 * window_ms) {
+        bucket->level = full;
+        return;
+    }
+    // capacity tokens per window_s seconds == capacity / window_s millitokens per ms.
+    bucket->level += elapsed_ms * bucket->capacity / bucket->window_s;
+    if (bucket->level > full) {
+        bucket->level = full;
+    }
+}
+
+void token_bucket_refill(token_bucket_t *bucket, int64_t now_ms)
+{
+    int64_t elapsed_ms = now_ms - bucket->updated_ms;
+
+    if (elapsed_ms <= 0 || bucket->level >= full_level(bucket) || bucket->capacity == 0) {
+        bucket->updated_ms = now_ms;
+        return;
+    }
+    token_bucket_credit(bucket, elapsed_ms);
+
+    // Carry the fraction of a millitoken forward, or frequent refills of a
+    // slow bucket would round every one of them down to nothing.
+    int64_t window_ms = (int64_t)bucket->window_s * MILLI;
+    int64_t carried_ms = 0;
+    if (bucket->level < full_level(bucket) && elapsed_ms < 2 * window_ms) {
+        carried_ms = (elapsed_ms * bucket->capacity % bucket->window_s) / bucket->capacity;
+    }
+    bucket->updated_ms = now_ms - carried_ms;
+}
+
+void token_bucket_charge(token_bucket_t *bucket, uint32_t tokens, int64_t now_ms)
+{
+    token_bucket_refill(bucket, now_ms);
+    bucket->level -= (int64_t)tokens * MILLI;
+    if (bucket->level < -full_level(bucket)) {
+        bucket->level = -full_level(bucket);
+    }
+}
+
+uint32_t token_bucket_available(const token_bucket_t *bucket)
+{
+    return bucket->level > 0 ? (uint32_t)(bucket->level / MILLI) : 0;
+}
+
+uint32_t token_bucket_retry_s(const token_bucket_t *bucket)
+{
+    if (bucket->level > 0) {
+        return 0;
+    }
+    if (bucket->capacity == 0) {
+        return bucket->window_s;
+    }
+    // Millitokens needed to get strictly above zero, at capacity / window_s per ms.
+    int64_t needed = 1 - bucket->level;
+    int64_t wait_ms = (needed * bucket->window_s + bucket->capacity - 1) / bucket->capacity;
+    return (uint32_t)((wait_ms + MILLI - 1) / MILLI);
+}
+
+size_t token_bucket_encode(const token_bucket_t *buckets, size_t count, int64_t wall_s,
+                           char *out, size_t out_len)
+{
+    if (!buckets || !out || out_len == 0) {
+        return 0;
+    }
+
+    int len = snprintf(out, out_len, "v1 %lld", (long long)wall_s);
+    for (size_t i = 0; i < count && len > 0 && (size_t)len < out_len; i++) {
+        len += snprintf(out + len, out_len - (size_t)len, " %lld",
+                        (long long)(buckets[i].level / MILLI));
+    }
+    if (len < 0 || (size_t)len >= out_len) {
+        out[0] = '\0';
+        return 0;
+    }
+    return (size_t)len;
+}
+
+bool token_bucket_decode(const char *text, int64_t *levels, size_t count, int64_t *wall_s)
+{
+    char *end;
+
+    if (!text || !levels || !wall_s || text[0] != 'v' || text[1] != '1' || text[2] != ' ') {
+        return false;
+    }
+    const char *p = text + 3;
+    long long wall = strtoll(p, &end, 10);
+    if (end == p) {
+        return false;
+    }
+    p = end;
+    for (size_t i = 0; i < count; i++) {
+        if (*p != ' ') {
+            return false;
+        }
+        p++;
+        long long level = strtoll(p, &end, 10);
+        if (end == p) {
+            return false;
+        }
+        levels[i] = level;
+        p = end;
+    }
+    if (*p != '\0') {
+        return false;
+    }
+    *wall_s = wall;
+    return true;
+}
@@ -0,0 +1,53 @@
+#ifndef TOKEN_BUCKET_H
+#define TOKEN_BUCKET_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Pure token-bucket core for ratelimit.c, driven by a caller-supplied
+// millisecond clock so it can run on the host.
+//
+// A bucket holds up to `capacity` LLM tokens and refills continuously at
+// capacity / window_s, so there is no calendar boundary where the budget
+// resets at once. Usage is charged after the fact (the cost of a request is
+// only known from its response), so the level may go negative; a request is
+// allowed while the level is positive, and the retry time is exactly how
+// long the refill takes to pay the debt back.
+
+typedef struct {
+    uint32_t capacity;      // Tokens
+    uint32_t window_s;      // Time to refill from empty
+    int64_t level;          // Millitokens; negative is debt
+    int64_t updated_ms;     // Clock of the last refill
+} token_bucket_t;
+
+// Start full at now_ms.
+void token_bucket_init(token_bucket_t *bucket, uint32_t capacity, uint32_t window_s,
+                       int64_t now_ms);
+
+// Refill for the time elapsed since the last update. A clock that goes
+// backwards only resets the reference point.
+void token_bucket_refill(token_bucket_t *bucket, int64_t now_ms);
+
+// Refill for time that passed outside the clock (e.g. while powered off).
+void token_bucket_credit(token_bucket_t *bucket, int64_t elapsed_ms);
+
+// Charge tokens. Debt is capped at one full capacity so a single oversized
+// request never locks the bucket for more than one window.
+void token_bucket_charge(token_bucket_t *bucket, uint32_t tokens, int64_t now_ms);
+
+// Whole tokens available (0 while in debt).
+uint32_t token_bucket_available(const token_bucket_t *bucket);
+
+// Seconds until a request is allowed again, rounded up; 0 when allowed now.
+uint32_t token_bucket_retry_s(const token_bucket_t *bucket);
+
+// Compact persistence: "v1 <wall seconds> <level> <level> ..." with levels
+// in whole tokens. decode fills count levels (tokens) and returns false on
+// malformed input or a count mismatch.
+size_t token_bucket_encode(const token_bucket_t *buckets, size_t count, int64_t wall_s,
+                           char *out, size_t out_len);
+bool token_bucket_decode(const char *text, int64_t *levels, size_t count, int64_t *wall_s);
+
+#endif // TOKEN_BUCKET_H
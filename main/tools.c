@@ -1,6 +1,7 @@
 #include "tools.h"
 #include "tools_handlers.h"
 #include "user_tools.h"
+#include "quick_actions.h"
 #include "config.h"
 #include "esp_log.h"
 #include <string.h>
@@ -42,7 +43,7 @@ static const tool_def_t s_tools[] = {
     {
         .name = "memory_set",
         .description = "Store a value in persistent user memory. Key must start with u_.",
-        .input_schema_json = "{\"type\":\"object\",\"properties\":{\"key\":{\"type\":\"string\",\"description\":\"User key (max 15 chars, must start with u_)\"},\"value\":{\"type\":\"string\",\"description\":\"Value to store\"}},\"required\":[\"key\",\"value\"]}",
+        .input_schema_json = "{\"type\":\"object\",\"properties\":{\"key\":{\"type\":\"string\",\"description\":\"User key (must start with u_, max 64 chars; 15 without the memory store)\"},\"value\":{\"type\":\"string\",\"description\":\"Value to store (max 4096 chars; 512 without the memory store)\"}},\"required\":[\"key\",\"value\"]}",
         .execute = tools_memory_set_handler
     },
     {
@@ -66,8 +67,8 @@ static const tool_def_t s_tools[] = {
     // Cron/Scheduler
     {
         .name = "cron_set",
-        .description = "Create a scheduled task. Type 'periodic' runs every N minutes. Type 'daily' runs at a specific local time in the device timezone (see set_timezone/get_timezone). Type 'once' runs one time after N minutes.",
-        .input_schema_json = "{\"type\":\"object\",\"properties\":{\"type\":{\"type\":\"string\",\"enum\":[\"periodic\",\"daily\",\"once\"]},\"interval_minutes\":{\"type\":\"integer\",\"description\":\"For periodic: minutes between runs\"},\"delay_minutes\":{\"type\":\"integer\",\"description\":\"For once: minutes from now before one-time run\"},\"hour\":{\"type\":\"integer\",\"description\":\"For daily: hour 0-23\"},\"minute\":{\"type\":\"integer\",\"description\":\"For daily: minute 0-59\"},\"action\":{\"type\":\"string\",\"description\":\"What to do when triggered\"}},\"required\":[\"type\",\"action\"]}",
+        .description = "Create a scheduled task. Type 'periodic' runs every N minutes. Type 'daily' runs at a specific local time in the device timezone (see set_timezone/get_timezone). Type 'once' runs one time after N minutes. Type 'cron' takes a standard five-field expression (minute hour day-of-month month day-of-week, local time). Type 'condition' evaluates an on-device predicate every few seconds and triggers only when it turns true, e.g. 'gpio(4)==1 && hour>=18' (operands: gpio(pin), mem(u_key), hour, minute, weekday, integers; operators: ! && || == != < <= > >= + -).",
+        .input_schema_json = "{\"type\":\"object\",\"properties\":{\"type\":{\"type\":\"string\",\"enum\":[\"periodic\",\"daily\",\"once\",\"cron\",\"condition\"]},\"interval_minutes\":{\"type\":\"integer\",\"description\":\"For periodic: minutes between runs\"},\"delay_minutes\":{\"type\":\"integer\",\"description\":\"For once: minutes from now before one-time run\"},\"hour\":{\"type\":\"integer\",\"description\":\"For daily: hour 0-23\"},\"minute\":{\"type\":\"integer\",\"description\":\"For daily: minute 0-59\"},\"expression\":{\"type\":\"string\",\"description\":\"For cron: five-field expression, e.g. '30 7 * * 1-5' or '*/15 9-17 * * *'\"},\"condition\":{\"type\":\"string\",\"description\":\"For condition: predicate such as 'gpio(4)==1 && hour>=18'\"},\"check_seconds\":{\"type\":\"integer\",\"description\":\"For condition: evaluation period in seconds (1-3600, default 10)\"},\"action\":{\"type\":\"string\",\"description\":\"What to do when triggered\"}},\"required\":[\"type\",\"action\"]}",
         .execute = tools_cron_set_handler
     },
     {
@@ -133,22 +134,55 @@ static const tool_def_t s_tools[] = {
         .input_schema_json = "{\"type\":\"object\",\"properties\":{\"name\":{\"type\":\"string\",\"description\":\"Tool name to delete\"}},\"required\":[\"name\"]}",
         .execute = tools_delete_user_tool_handler
     },
+    // Telegram quick actions
+    {
+        .name = "pin_quick_action",
+        .description = "Pin a Telegram button (shown by /actions) that runs a tool with fixed args, no LLM. Tools: gpio_write, gpio_read, memory_get, memory_list, cron_list, get_time, get_timezone, get_version, get_health. Same label replaces.",
+        .input_schema_json = "{\"type\":\"object\",\"properties\":{\"label\":{\"type\":\"string\",\"description\":\"Button text (max 31 chars)\"},\"tool\":{\"type\":\"string\",\"description\":\"Built-in tool to run\"},\"args\":{\"type\":\"object\",\"description\":\"Fixed tool input, e.g. {\\\"pin\\\":5,\\\"state\\\":1}\"}},\"required\":[\"label\",\"tool\"]}",
+        .execute = tools_pin_quick_action_handler
+    },
+    {
+        .name = "unpin_quick_action",
+        .description = "Remove a pinned Telegram quick action by label.",
+        .input_schema_json = "{\"type\":\"object\",\"properties\":{\"label\":{\"type\":\"string\",\"description\":\"Button label to remove\"}},\"required\":[\"label\"]}",
+        .execute = tools_unpin_quick_action_handler
+    },
     // Media capture (feature-gated)
 #if ZCLAW_HAS_CAMERA
     {
         .name = "capture_photo",
-        .description = "Take a photo with the camera. Returns a JPEG image for visual analysis. Use this to see and describe the environment.",
-        .input_schema_json = "{\"type\":\"object\",\"properties\":{}}",
+        .description = "Take a photo with the camera. Returns a JPEG image for visual analysis. Use this to see and describe the environment. Pick purpose 'glance' for a quick check, 'read_text' for labels or screens.",
+        .input_schema_json = "{\"type\":\"object\",\"properties\":{\"purpose\":{\"type\":\"string\",\"enum\":[\"glance\",\"scene\",\"read_text\"],\"description\":\"Sets resolution and quality (default scene)\"},\"budget_bytes\":{\"type\":\"integer\",\"description\":\"Max JPEG size in bytes (4096-262144), overrides the purpose's budget\"}},\"required\":[]}",
         .execute = tools_capture_photo_handler
     },
+    {
+        .name = "motion_watch",
+        .description = "Watch the camera for changes (someone entering, a door opening) without sending photos until something happens. On a change you get a [MOTION] message with one photo attached. Call with no arguments to see the current setting.",
+        .input_schema_json = "{\"type\":\"object\",\"properties\":{\"enabled\":{\"type\":\"boolean\"},\"sensitivity\":{\"type\":\"string\",\"enum\":[\"low\",\"medium\",\"high\"],\"description\":\"Default medium\"},\"note\":{\"type\":\"string\",\"description\":\"What to do when something changes, sent with each event\"}},\"required\":[]}",
+        .execute = tools_motion_watch_handler
+    },
+#if ZCLAW_HAS_TIMELAPSE
+    {
+        .name = "timelapse_sheet",
+        .description = "See what the camera saw over a past time range (up to the last hour) as one contact sheet of up to 16 numbered thumbnails. Use for 'what happened while I was away' instead of asking for many photos.",
+        .input_schema_json = "{\"type\":\"object\",\"properties\":{\"minutes\":{\"type\":\"integer\",\"description\":\"Length of the range in minutes (default 10)\"},\"end_minutes_ago\":{\"type\":\"integer\",\"description\":\"How long ago the range ends (default 0, now)\"}},\"required\":[]}",
+        .execute = tools_timelapse_sheet_handler
+    },
+#endif
 #endif
 #if ZCLAW_HAS_MICROPHONE
     {
         .name = "record_audio",
-        .description = "Record audio from the microphone. Returns base64-encoded 16kHz 16-bit mono PCM data.",
-        .input_schema_json = "{\"type\":\"object\",\"properties\":{\"duration_ms\":{\"type\":\"integer\",\"description\":\"Recording duration in milliseconds (100-10000, default 3000)\"}},\"required\":[]}",
+        .description = "Listen with the microphone and transcribe what is said. Only speech is kept; silence is trimmed. Set until_silence to listen until the speaker stops instead of for a fixed time. Returns the transcript text.",
+        .input_schema_json = "{\"type\":\"object\",\"properties\":{\"duration_ms\":{\"type\":\"integer\",\"description\":\"How long to listen in milliseconds (100-300000, default 3000; with until_silence the limit, default 60000)\"},\"until_silence\":{\"type\":\"boolean\",\"description\":\"Stop when the speaker stops talking (default false)\"},\"silence_ms\":{\"type\":\"integer\",\"description\":\"Pause in milliseconds that ends speech (200-3000, default 800)\"}},\"required\":[]}",
         .execute = tools_record_audio_handler
     },
+    {
+        .name = "analyze_audio",
+        .description = "Listen with the microphone and measure the sound instead of transcribing it: RMS and peak level in dBFS, clipping, the loudest tones with their frequencies, and how the power splits over frequency bands. Use it for questions like whether a machine is running or how loud it is.",
+        .input_schema_json = "{\"type\":\"object\",\"properties\":{\"duration_ms\":{\"type\":\"integer\",\"description\":\"How long to listen in milliseconds (100-300000, default 2000)\"}},\"required\":[]}",
+        .execute = tools_analyze_audio_handler
+    },
 #endif
 };
 
@@ -158,6 +192,7 @@ void tools_init(void)
 {
     // Initialize user-defined tools from NVS
     user_tools_init();
+    quick_actions_init();
 
     ESP_LOGI(TAG, "Registered %d built-in tools, %d user tools",
              s_tool_count, user_tools_count());
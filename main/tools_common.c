@@ -31,14 +31,19 @@ bool tools_validate_string_input(const char *str, size_t max_len, char *error, s
 }
 
 bool tools_validate_nvs_key(const char *key, char *error, size_t error_len)
+{
+    return tools_validate_key(key, NVS_MAX_KEY_LEN, error, error_len);
+}
+
+bool tools_validate_key(const char *key, size_t max_len, char *error, size_t error_len)
 {
     if (!key || strlen(key) == 0) {
         snprintf(error, error_len, "Error: empty key");
         return false;
     }
 
-    if (strlen(key) > NVS_MAX_KEY_LEN) {
-        snprintf(error, error_len, "Error: key max %d chars", NVS_MAX_KEY_LEN);
+    if (strlen(key) > max_len) {
+        snprintf(error, error_len, "Error: key max %zu chars", max_len);
         return false;
     }
 
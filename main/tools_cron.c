@@ -1,5 +1,7 @@
 #include "tools_handlers.h"
 #include "cron.h"
+#include "cron_cond.h"
+#include "cron_expr.h"
 #include "cron_utils.h"
 #include "config.h"
 #include "tools_common.h"
@@ -121,7 +123,7 @@ bool tools_cron_set_handler(const cJSON *input, char *result, size_t result_len)
     cJSON *action_json = cJSON_GetObjectItem(input, "action");
 
     if (!type_json || !cJSON_IsString(type_json)) {
-        snprintf(result, result_len, "Error: 'type' required (periodic/daily/once)");
+        snprintf(result, result_len, "Error: 'type' required (periodic/daily/once/cron/condition)");
         return false;
     }
     if (!action_json || !cJSON_IsString(action_json)) {
@@ -141,7 +143,72 @@ bool tools_cron_set_handler(const cJSON *input, char *result, size_t result_len)
     uint16_t interval_or_hour = 0;
     uint8_t minute = 0;
 
-    if (strcmp(type_str, "periodic") == 0) {
+    if (strcmp(type_str, "cron") == 0) {
+        cJSON *expr_json = cJSON_GetObjectItem(input, "expression");
+        if (!expr_json || !cJSON_IsString(expr_json)) {
+            snprintf(result, result_len, "Error: 'expression' required for cron (e.g. \"30 7 * * 1-5\")");
+            return false;
+        }
+
+        cron_expr_t expr;
+        char parse_error[64];
+        if (!cron_expr_parse(expr_json->valuestring, &expr, parse_error, sizeof(parse_error))) {
+            snprintf(result, result_len, "Error: invalid cron expression: %s", parse_error);
+            return false;
+        }
+
+        char canonical[CRON_EXPR_MAX_LEN];
+        if (!cron_expr_format(&expr, canonical, sizeof(canonical))) {
+            snprintf(canonical, sizeof(canonical), "%s", expr_json->valuestring);
+        }
+
+        uint8_t id = cron_set_expr(&expr, action);
+        if (id == 0) {
+            snprintf(result, result_len, "Error: no free schedule slots");
+            return false;
+        }
+
+        char timezone_abbrev[16];
+        cron_get_timezone_abbrev(timezone_abbrev, sizeof(timezone_abbrev));
+        snprintf(result, result_len, "Created schedule #%d: cron '%s' %s → %s",
+                 id, canonical, timezone_abbrev, action);
+        return true;
+    } else if (strcmp(type_str, "condition") == 0) {
+        cJSON *cond_json = cJSON_GetObjectItem(input, "condition");
+        cJSON *check_json = cJSON_GetObjectItem(input, "check_seconds");
+        if (!cond_json || !cJSON_IsString(cond_json)) {
+            snprintf(result, result_len, "Error: 'condition' required (e.g. \"gpio(4)==1 && hour>=18\")");
+            return false;
+        }
+        if (check_json && !cJSON_IsNumber(check_json)) {
+            snprintf(result, result_len, "Error: 'check_seconds' must be a number");
+            return false;
+        }
+        int check_seconds = check_json ? check_json->valueint : CRON_COND_DEFAULT_CHECK_S;
+        if (check_seconds < CRON_COND_MIN_CHECK_S || check_seconds > CRON_COND_MAX_CHECK_S) {
+            snprintf(result, result_len, "Error: check_seconds must be %d-%d",
+                     CRON_COND_MIN_CHECK_S, CRON_COND_MAX_CHECK_S);
+            return false;
+        }
+
+        cron_cond_t cond;
+        char compile_error[64];
+        if (!cron_cond_compile(cond_json->valuestring, (uint16_t)check_seconds,
+                               tools_gpio_pin_is_allowed, &cond,
+                               compile_error, sizeof(compile_error))) {
+            snprintf(result, result_len, "Error: invalid condition: %s", compile_error);
+            return false;
+        }
+
+        uint8_t id = cron_set_condition(&cond, action);
+        if (id == 0) {
+            snprintf(result, result_len, "Error: no free schedule slots");
+            return false;
+        }
+        snprintf(result, result_len, "Created schedule #%d: when %s (checked every %ds) → %s",
+                 id, cond.source, check_seconds, action);
+        return true;
+    } else if (strcmp(type_str, "periodic") == 0) {
         type = CRON_TYPE_PERIODIC;
         cJSON *interval = cJSON_GetObjectItem(input, "interval_minutes");
         if (!interval || !cJSON_IsNumber(interval)) {
@@ -186,7 +253,7 @@ bool tools_cron_set_handler(const cJSON *input, char *result, size_t result_len)
         }
         interval_or_hour = (uint16_t)delay->valueint;
     } else {
-        snprintf(result, result_len, "Error: type must be 'periodic', 'daily', or 'once'");
+        snprintf(result, result_len, "Error: type must be 'periodic', 'daily', 'once', 'cron', or 'condition'");
         return false;
     }
 
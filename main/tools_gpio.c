@@ -50,7 +50,7 @@ static bool gpio_pin_in_allowlist(int pin, const char *csv)
     return false;
 }
 
-static bool gpio_pin_is_allowed(int pin)
+bool tools_gpio_pin_is_allowed(int pin)
 {
     if (GPIO_ALLOWED_PINS_CSV[0] != '\0') {
         return gpio_pin_in_allowlist(pin, GPIO_ALLOWED_PINS_CSV);
@@ -75,7 +75,7 @@ bool tools_gpio_write_handler(const cJSON *input, char *result, size_t result_le
     int pin = pin_json->valueint;
     int state = state_json->valueint;
 
-    if (!gpio_pin_is_allowed(pin)) {
+    if (!tools_gpio_pin_is_allowed(pin)) {
         if (GPIO_ALLOWED_PINS_CSV[0] != '\0') {
             snprintf(result, result_len, "Error: pin %d is not in allowed list", pin);
         } else {
@@ -103,7 +103,7 @@ bool tools_gpio_read_handler(const cJSON *input, char *result, size_t result_len
 
     int pin = pin_json->valueint;
 
-    if (!gpio_pin_is_allowed(pin)) {
+    if (!tools_gpio_pin_is_allowed(pin)) {
         if (GPIO_ALLOWED_PINS_CSV[0] != '\0') {
             snprintf(result, result_len, "Error: pin %d is not in allowed list", pin);
         } else {
@@ -15,6 +15,8 @@ bool tools_gpio_write_handler(const cJSON *input, char *result, size_t result_le
 bool tools_gpio_read_handler(const cJSON *input, char *result, size_t result_len);
 bool tools_delay_handler(const cJSON *input, char *result, size_t result_len);
 bool tools_i2c_scan_handler(const cJSON *input, char *result, size_t result_len);
+// Pin policy shared with condition schedules (GPIO_ALLOWED_PINS or min/max range)
+bool tools_gpio_pin_is_allowed(int pin);
 
 // Memory
 bool tools_memory_set_handler(const cJSON *input, char *result, size_t result_len);
@@ -36,14 +38,21 @@ bool tools_get_health_handler(const cJSON *input, char *result, size_t result_le
 bool tools_create_tool_handler(const cJSON *input, char *result, size_t result_len);
 bool tools_list_user_tools_handler(const cJSON *input, char *result, size_t result_len);
 bool tools_delete_user_tool_handler(const cJSON *input, char *result, size_t result_len);
+bool tools_pin_quick_action_handler(const cJSON *input, char *result, size_t result_len);
+bool tools_unpin_quick_action_handler(const cJSON *input, char *result, size_t result_len);
 
 // Media capture (feature-gated)
 #include "config.h"
 #if ZCLAW_HAS_CAMERA
 bool tools_capture_photo_handler(const cJSON *input, char *result, size_t result_len);
+bool tools_motion_watch_handler(const cJSON *input, char *result, size_t result_len);
+#if ZCLAW_HAS_TIMELAPSE
+bool tools_timelapse_sheet_handler(const cJSON *input, char *result, size_t result_len);
+#endif
 #endif
 #if ZCLAW_HAS_MICROPHONE
 bool tools_record_audio_handler(const cJSON *input, char *result, size_t result_len);
+bool tools_analyze_audio_handler(const cJSON *input, char *result, size_t result_len);
 #endif
 
 #endif // TOOLS_HANDLERS_H
@@ -2,6 +2,7 @@
 #include "tools_handlers.h"
 #include "config.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "cJSON.h"
 #include <string.h>
 #include <stdlib.h>
@@ -9,9 +10,15 @@
 
 #if ZCLAW_HAS_CAMERA
 #include "camera.h"
+#include "motion.h"
+#endif
+#if ZCLAW_HAS_TIMELAPSE
+#include "timelapse.h"
 #endif
 #if ZCLAW_HAS_MICROPHONE
+#include "audio_stats.h"
 #include "mic.h"
+#include "transcribe.h"
 #endif
 
 static const char *TAG = "media";
@@ -20,39 +27,81 @@ static const char *TAG = "media";
 static const char s_b64_table[] =
     "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
 
-// Pending image state
-static char *s_pending_b64 = NULL;
-static size_t s_pending_b64_len = 0;
+// Two output characters for every 12-bit input group (8 KB, const so it
+// stays in flash). One lookup and one 16-bit store replace two of each.
+#define B64_CHAR(v) ((v) < 26 ? 'A' + (v) : (v) < 52 ? 'a' + (v) - 26 : \
+                     (v) < 62 ? '0' + (v) - 52 : (v) == 62 ? '+' : '/')
+#define B64_PAIR(a, b) { B64_CHAR(a), B64_CHAR(b) }
+#define B64_PAIRS_8(a, b) B64_PAIR(a, b), B64_PAIR(a, (b) + 1), B64_PAIR(a, (b) + 2), \
+    B64_PAIR(a, (b) + 3), B64_PAIR(a, (b) + 4), B64_PAIR(a, (b) + 5), \
+    B64_PAIR(a, (b) + 6), B64_PAIR(a, (b) + 7)
+#define B64_ROW(a) B64_PAIRS_8(a, 0), B64_PAIRS_8(a, 8), B64_PAIRS_8(a, 16), \
+    B64_PAIRS_8(a, 24), B64_PAIRS_8(a, 32), B64_PAIRS_8(a, 40), \
+    B64_PAIRS_8(a, 48), B64_PAIRS_8(a, 56)
+#define B64_ROWS_8(a) B64_ROW(a), B64_ROW((a) + 1), B64_ROW((a) + 2), B64_ROW((a) + 3), \
+    B64_ROW((a) + 4), B64_ROW((a) + 5), B64_ROW((a) + 6), B64_ROW((a) + 7)
+
+static const char s_b64_pairs[4096][2] = {
+    B64_ROWS_8(0), B64_ROWS_8(8), B64_ROWS_8(16), B64_ROWS_8(24),
+    B64_ROWS_8(32), B64_ROWS_8(40), B64_ROWS_8(48), B64_ROWS_8(56),
+};
+
+// Encode one full triple at in into four characters at out.
+#define B64_ENCODE_TRIPLE(in, out) do { \
+    uint32_t triple_ = ((uint32_t)(in)[0] << 16) | ((uint32_t)(in)[1] << 8) | (in)[2]; \
+    memcpy((out), s_b64_pairs[triple_ >> 12], 2); \
+    memcpy((out) + 2, s_b64_pairs[triple_ & 0xFFF], 2); \
+} while (0)
+
+// Pending image state. The JPEG is a held camera frame, or a heap copy
+// (s_pending_owned) for motion photos, contact sheets and tests. Only the
+// agent task changes it; the motion and time-lapse tasks poll
+// media_has_pending_image(), so s_pending_jpeg is stored and loaded
+// atomically (set_pending).
+static const uint8_t *s_pending_jpeg = NULL;
+static size_t s_pending_jpeg_len = 0;
+static bool s_pending_owned = false;
 static char s_pending_tool_id[64] = {0};
+#if ZCLAW_HAS_CAMERA
+static cam_frame_t s_pending_frame;
+#endif
 
-// Base64-encode binary data into a malloc'd string.
-// Returns allocated string (caller must free) or NULL on failure.
-static char *base64_encode(const uint8_t *data, size_t data_len, size_t *out_len)
-{
-    size_t encoded_len = 4 * ((data_len + 2) / 3);
+// Upload rate seen while streaming image requests (0 = not measured yet).
+static uint32_t s_uplink_bps = 0;
 
-#if ZCLAW_HAS_PSRAM
-    char *out = heap_caps_malloc(encoded_len + 1, MALLOC_CAP_SPIRAM);
-#else
-    char *out = malloc(encoded_len + 1);
-#endif
+static void set_pending(const uint8_t *jpeg, size_t jpeg_len, bool owned)
+{
+    s_pending_jpeg_len = jpeg_len;
+    s_pending_owned = owned;
+    __atomic_store_n(&s_pending_jpeg, jpeg, __ATOMIC_RELEASE);
+}
 
-    if (!out) {
-        return NULL;
-    }
+static size_t base64_encoded_len(size_t data_len)
+{
+    return 4 * ((data_len + 2) / 3);
+}
 
+// Base64-encode data_len bytes into out (base64_encoded_len(data_len) chars,
+// not terminated). Padding is only emitted for a trailing partial triple.
+static size_t base64_encode_block(const uint8_t *data, size_t data_len, char *out)
+{
     size_t i = 0;
     size_t j = 0;
 
+    // 12 input bytes per iteration, unrolled so the loads and stores of the
+    // four triples can overlap.
+    while (i + 12 <= data_len) {
+        B64_ENCODE_TRIPLE(data + i, out + j);
+        B64_ENCODE_TRIPLE(data + i + 3, out + j + 4);
+        B64_ENCODE_TRIPLE(data + i + 6, out + j + 8);
+        B64_ENCODE_TRIPLE(data + i + 9, out + j + 12);
+        i += 12;
+        j += 16;
+    }
     while (i + 2 < data_len) {
-        uint32_t triple = ((uint32_t)data[i] << 16) |
-                          ((uint32_t)data[i + 1] << 8) |
-                          (uint32_t)data[i + 2];
-        out[j++] = s_b64_table[(triple >> 18) & 0x3F];
-        out[j++] = s_b64_table[(triple >> 12) & 0x3F];
-        out[j++] = s_b64_table[(triple >> 6) & 0x3F];
-        out[j++] = s_b64_table[triple & 0x3F];
+        B64_ENCODE_TRIPLE(data + i, out + j);
         i += 3;
+        j += 4;
     }
 
     if (i < data_len) {
@@ -69,12 +118,7 @@ static char *base64_encode(const uint8_t *data, size_t data_len, size_t *out_len
         }
         out[j++] = '=';
     }
-
-    out[j] = '\0';
-    if (out_len) {
-        *out_len = j;
-    }
-    return out;
+    return j;
 }
 
 void media_init(void)
@@ -98,21 +142,21 @@ void media_init(void)
 
 bool media_has_pending_image(void)
 {
-    return s_pending_b64 != NULL;
+    return __atomic_load_n(&s_pending_jpeg, __ATOMIC_ACQUIRE) != NULL;
 }
 
-bool media_get_pending_image(const char **base64_out, size_t *base64_len_out,
+bool media_get_pending_image(const uint8_t **jpeg_out, size_t *jpeg_len_out,
                              const char **tool_id_out)
 {
-    if (!s_pending_b64) {
+    if (!s_pending_jpeg) {
         return false;
     }
 
-    if (base64_out) {
-        *base64_out = s_pending_b64;
+    if (jpeg_out) {
+        *jpeg_out = s_pending_jpeg;
     }
-    if (base64_len_out) {
-        *base64_len_out = s_pending_b64_len;
+    if (jpeg_len_out) {
+        *jpeg_len_out = s_pending_jpeg_len;
     }
     if (tool_id_out) {
         *tool_id_out = s_pending_tool_id;
@@ -120,6 +164,32 @@ bool media_get_pending_image(const char **base64_out, size_t *base64_len_out,
     return true;
 }
 
+#if ZCLAW_HAS_CAMERA
+// Make a heap JPEG the pending image; it is freed on release.
+static void adopt_pending_image(uint8_t *jpeg, size_t jpeg_len)
+{
+    media_release_pending();
+    set_pending(jpeg, jpeg_len, true);
+}
+#endif
+
+bool media_claim_event_image(void)
+{
+#if ZCLAW_HAS_CAMERA
+    uint8_t *jpeg = NULL;
+    size_t jpeg_len = 0;
+
+    if (!motion_take_event_image(&jpeg, &jpeg_len)) {
+        return false;
+    }
+    adopt_pending_image(jpeg, jpeg_len);
+    media_set_pending_tool_id(MEDIA_USER_IMAGE_ID);
+    return true;
+#else
+    return false;
+#endif
+}
+
 void media_set_pending_tool_id(const char *tool_id)
 {
     if (tool_id) {
@@ -130,16 +200,70 @@ void media_set_pending_tool_id(const char *tool_id)
 
 void media_release_pending(void)
 {
-    if (s_pending_b64) {
-        free(s_pending_b64);
-        s_pending_b64 = NULL;
-        s_pending_b64_len = 0;
+    if (s_pending_owned) {
+        free((void *)s_pending_jpeg);
     }
-    s_pending_tool_id[0] = '\0';
-
 #if ZCLAW_HAS_CAMERA
-    camera_release_frame();
+    camera_frame_release(&s_pending_frame);
 #endif
+    // Cleared last, so no other task sees the frame buffer free while held.
+    set_pending(NULL, 0, false);
+    s_pending_tool_id[0] = '\0';
+}
+
+static const char *find_image_slot(const char *request_json)
+{
+    return s_pending_jpeg ? strstr(request_json, MEDIA_IMAGE_SLOT) : NULL;
+}
+
+size_t media_request_body_len(const char *request_json)
+{
+    size_t len = strlen(request_json);
+
+    if (find_image_slot(request_json)) {
+        len = len - strlen(MEDIA_IMAGE_SLOT) + base64_encoded_len(s_pending_jpeg_len);
+    }
+    return len;
+}
+
+bool media_write_request_body(const char *request_json, media_body_write_fn write, void *ctx)
+{
+    static char chunk[MEDIA_B64_CHUNK_BYTES / 3 * 4];
+    const char *slot = find_image_slot(request_json);
+
+    if (!slot) {
+        return write(request_json, strlen(request_json), ctx);
+    }
+    if (!write(request_json, (size_t)(slot - request_json), ctx)) {
+        return false;
+    }
+
+    int64_t start_us = esp_timer_get_time();
+
+    // Whole triples per chunk, so padding only appears after the last one.
+    for (size_t offset = 0; offset < s_pending_jpeg_len; offset += MEDIA_B64_CHUNK_BYTES) {
+        size_t n = s_pending_jpeg_len - offset;
+        if (n > MEDIA_B64_CHUNK_BYTES) {
+            n = MEDIA_B64_CHUNK_BYTES;
+        }
+        if (!write(chunk, base64_encode_block(s_pending_jpeg + offset, n, chunk), ctx)) {
+            return false;
+        }
+    }
+
+    const char *tail = slot + strlen(MEDIA_IMAGE_SLOT);
+    if (!write(tail, strlen(tail), ctx)) {
+        return false;
+    }
+
+    // Small images fit in the socket buffers and would time the copy, not the link.
+    int64_t elapsed_us = esp_timer_get_time() - start_us;
+    if (s_pending_jpeg_len >= 8192 && elapsed_us > 0) {
+        uint32_t bps = (uint32_t)(base64_encoded_len(s_pending_jpeg_len) * 1000000ULL /
+                                  (uint64_t)elapsed_us);
+        s_uplink_bps = s_uplink_bps ? (s_uplink_bps + bps) / 2 : bps;
+    }
+    return true;
 }
 
 // ---------------------------------------------------------------------------
@@ -147,44 +271,159 @@ void media_release_pending(void)
 // ---------------------------------------------------------------------------
 #if ZCLAW_HAS_CAMERA
 
+static cam_scene_model_t s_scene_model;
+static bool s_scene_model_ready = false;
+
+// cam_budget_capture() callback: keeps each frame as the pending image,
+// dropping the previous attempt's frame first.
+static bool capture_with_setting(cam_setting_t setting, size_t *jpeg_len, void *ctx)
+{
+    (void)ctx;
+    if (s_pending_jpeg) {
+        media_release_pending();
+    }
+    if (!camera_apply_setting(setting) || !camera_frame_get(&s_pending_frame)) {
+        return false;
+    }
+
+    // Keep the frame buffer; it is base64-encoded straight into the next
+    // LLM request body and released after that request.
+    set_pending(s_pending_frame.buf, s_pending_frame.len, false);
+    *jpeg_len = s_pending_frame.len;
+    return true;
+}
+
 bool tools_capture_photo_handler(const cJSON *input, char *result, size_t result_len)
 {
-    (void)input;
+    cam_budget_goal_t goal;
+    cJSON *purpose = cJSON_GetObjectItem(input, "purpose");
+    cJSON *budget = cJSON_GetObjectItem(input, "budget_bytes");
+    const char *purpose_name = (purpose && cJSON_IsString(purpose)) ? purpose->valuestring : NULL;
+
+    if (!cam_budget_goal_for_purpose(purpose_name, &goal)) {
+        snprintf(result, result_len,
+                 "Error: purpose must be 'glance', 'scene' or 'read_text'");
+        return false;
+    }
+    if (budget && cJSON_IsNumber(budget)) {
+        double bytes = budget->valuedouble;
+        if (bytes < CAM_BUDGET_MIN_BYTES) {
+            bytes = CAM_BUDGET_MIN_BYTES;
+        } else if (bytes > CAM_BUDGET_MAX_BYTES) {
+            bytes = CAM_BUDGET_MAX_BYTES;
+        }
+        goal.budget = (size_t)bytes;
+    }
+    if (goal.max_size > camera_max_size()) {
+        goal.max_size = camera_max_size();
+    }
+    if (!s_scene_model_ready) {
+        cam_scene_model_init(&s_scene_model);
+        s_scene_model_ready = true;
+    }
 
     // Release any prior pending image
     media_release_pending();
 
-    const uint8_t *jpeg_buf = NULL;
-    size_t jpeg_len = 0;
-
-    if (!camera_capture_jpeg(&jpeg_buf, &jpeg_len)) {
+    if (!camera_lock(5000)) {
+        snprintf(result, result_len, "Error: camera busy");
+        return false;
+    }
+    cam_budget_result_t shot;
+    bool captured = cam_budget_capture(&s_scene_model, &goal, capture_with_setting, NULL, &shot);
+    camera_unlock();
+    if (!captured) {
+        media_release_pending();
         snprintf(result, result_len, "Error: camera capture failed");
         return false;
     }
 
-    // Base64-encode the JPEG for LLM vision
-    size_t b64_len = 0;
-    char *b64 = base64_encode(jpeg_buf, jpeg_len, &b64_len);
+    // Upload time against the old fixed VGA / CAM_JPEG_QUALITY frame of this scene.
+    cam_setting_t fixed = { CAM_SIZE_VGA, CAM_JPEG_QUALITY };
+    uint32_t bps = s_uplink_bps ? s_uplink_bps : CAM_UPLINK_DEFAULT_BPS;
+    int32_t saved_ms = (int32_t)cam_budget_upload_ms(cam_budget_predict(&s_scene_model, fixed), bps) -
+                       (int32_t)cam_budget_upload_ms(shot.jpeg_len, bps);
+    uint32_t delta_ms = (uint32_t)(saved_ms < 0 ? -saved_ms : saved_ms);
+
+    ESP_LOGI(TAG, "Photo captured: %s q%d, %u bytes JPEG (budget %u, %d capture%s), %d ms upload saved",
+             cam_size_name(shot.setting.size), shot.setting.quality, (unsigned)shot.jpeg_len,
+             (unsigned)goal.budget, shot.attempts, shot.attempts == 1 ? "" : "s", (int)saved_ms);
 
-    if (!b64) {
-        camera_release_frame();
-        snprintf(result, result_len, "Error: out of memory encoding image (%u bytes)",
-                 (unsigned)jpeg_len);
+    snprintf(result, result_len,
+             "Photo captured successfully (%ux%u, JPEG quality %d, %u bytes, %s the %u-byte budget "
+             "after %d capture%s). Upload about %d.%d s %s than a fixed VGA quality-%d frame. "
+             "The image is attached for your visual analysis.",
+             cam_size_width(shot.setting.size), cam_size_height(shot.setting.size),
+             shot.setting.quality, (unsigned)shot.jpeg_len,
+             shot.within_budget ? "within" : "over", (unsigned)goal.budget,
+             shot.attempts, shot.attempts == 1 ? "" : "s",
+             (int)(delta_ms / 1000), (int)(delta_ms % 1000 / 100),
+             saved_ms < 0 ? "longer" : "shorter", CAM_JPEG_QUALITY);
+    return true;
+}
+
+bool tools_motion_watch_handler(const cJSON *input, char *result, size_t result_len)
+{
+    cJSON *enabled = cJSON_GetObjectItem(input, "enabled");
+    cJSON *sensitivity = cJSON_GetObjectItem(input, "sensitivity");
+    cJSON *note = cJSON_GetObjectItem(input, "note");
+    motion_sensitivity_t level = MOTION_SENSITIVITY_MEDIUM;
+
+    if (!enabled || !cJSON_IsBool(enabled)) {
+        motion_watch_describe(result, result_len);
+        return true;
+    }
+    if (sensitivity && (!cJSON_IsString(sensitivity) ||
+                        !motion_sensitivity_parse(sensitivity->valuestring, &level))) {
+        snprintf(result, result_len, "Error: sensitivity must be 'low', 'medium' or 'high'");
+        return false;
+    }
+    if (note && (!cJSON_IsString(note) || strlen(note->valuestring) >= MOTION_NOTE_MAX_LEN)) {
+        snprintf(result, result_len, "Error: note must be a string under %d chars",
+                 MOTION_NOTE_MAX_LEN);
         return false;
     }
 
-    s_pending_b64 = b64;
-    s_pending_b64_len = b64_len;
+    if (!motion_watch_set(cJSON_IsTrue(enabled), level, note ? note->valuestring : NULL)) {
+        snprintf(result, result_len, "Error: failed to save motion watch");
+        return false;
+    }
+    motion_watch_describe(result, result_len);
+    return true;
+}
+
+#if ZCLAW_HAS_TIMELAPSE
+bool tools_timelapse_sheet_handler(const cJSON *input, char *result, size_t result_len)
+{
+    cJSON *minutes = cJSON_GetObjectItem(input, "minutes");
+    cJSON *end_ago = cJSON_GetObjectItem(input, "end_minutes_ago");
+    int span_min = (minutes && cJSON_IsNumber(minutes)) ? minutes->valueint : 10;
+    int end_min = (end_ago && cJSON_IsNumber(end_ago)) ? end_ago->valueint : 0;
+    int history_min = THUMB_RING_MAX_FRAMES * (THUMB_INTERVAL_MS / 1000) / 60;
+    uint8_t *jpeg = NULL;
+    size_t jpeg_len = 0;
+    char legend[512];
 
-    ESP_LOGI(TAG, "Photo captured: %u bytes JPEG, %u bytes base64",
-             (unsigned)jpeg_len, (unsigned)b64_len);
+    if (span_min < 1 || span_min > history_min || end_min < 0 || end_min >= history_min) {
+        snprintf(result, result_len, "Error: minutes must be 1-%d and end_minutes_ago 0-%d",
+                 history_min, history_min - 1);
+        return false;
+    }
+
+    media_release_pending();
+    if (!timelapse_build_sheet((int64_t)(end_min + span_min) * 60000, (int64_t)end_min * 60000,
+                               &jpeg, &jpeg_len, legend, sizeof(legend))) {
+        snprintf(result, result_len, "Error: %s", legend);
+        return false;
+    }
+    adopt_pending_image(jpeg, jpeg_len);
 
     snprintf(result, result_len,
-             "Photo captured successfully (%u bytes JPEG). "
-             "The image is attached for your visual analysis.",
-             (unsigned)jpeg_len);
+             "Contact sheet of the %d minutes ending %d minutes ago (%u bytes JPEG) is attached. %s",
+             span_min, end_min, (unsigned)jpeg_len, legend);
     return true;
 }
+#endif // ZCLAW_HAS_TIMELAPSE
 
 #endif // ZCLAW_HAS_CAMERA
 
@@ -193,51 +432,119 @@ bool tools_capture_photo_handler(const cJSON *input, char *result, size_t result
 // ---------------------------------------------------------------------------
 #if ZCLAW_HAS_MICROPHONE
 
-bool tools_record_audio_handler(const cJSON *input, char *result, size_t result_len)
+// Put prefix in front of the text already in buf, cutting the text to fit.
+static void prepend(char *buf, size_t buf_len, const char *prefix)
 {
-    // Parse optional duration_ms (default 3 seconds)
-    uint32_t duration_ms = MEDIA_AUDIO_DEFAULT_MS;
-    cJSON *dur = cJSON_GetObjectItem(input, "duration_ms");
-    if (dur && cJSON_IsNumber(dur)) {
-        duration_ms = (uint32_t)dur->valuedouble;
-    }
+    size_t prefix_len = strlen(prefix);
+    size_t text_len = strlen(buf);
 
-    if (duration_ms > (uint32_t)(MIC_RECORD_SECS_MAX * 1000)) {
-        duration_ms = MIC_RECORD_SECS_MAX * 1000;
+    if (prefix_len >= buf_len) {
+        prefix_len = buf_len - 1;
     }
-    if (duration_ms < 100) {
-        duration_ms = 100;
+    if (prefix_len + text_len >= buf_len) {
+        text_len = buf_len - prefix_len - 1;
     }
+    memmove(buf + prefix_len, buf, text_len);
+    memcpy(buf, prefix, prefix_len);
+    buf[prefix_len + text_len] = '\0';
+}
 
-    int16_t *audio_buf = NULL;
-    size_t audio_len = 0;
+static uint32_t clamp_ms(const cJSON *input, const char *key, uint32_t fallback,
+                         uint32_t min_ms, uint32_t max_ms)
+{
+    cJSON *item = cJSON_GetObjectItem(input, key);
+    double value = (item && cJSON_IsNumber(item)) ? item->valuedouble : (double)fallback;
+
+    if (value < (double)min_ms) {
+        return min_ms;
+    }
+    if (value > (double)max_ms) {
+        return max_ms;
+    }
+    return (uint32_t)value;
+}
 
-    if (!mic_record(duration_ms, &audio_buf, &audio_len)) {
-        snprintf(result, result_len, "Error: audio recording failed");
+bool tools_record_audio_handler(const cJSON *input, char *result, size_t result_len)
+{
+    transcribe_opts_t opts;
+    transcribe_stats_t stats;
+    char prefix[64];
+
+    cJSON *until = cJSON_GetObjectItem(input, "until_silence");
+    opts.until_silence = until && cJSON_IsTrue(until);
+    opts.max_ms = clamp_ms(input, "duration_ms",
+                           opts.until_silence ? MEDIA_AUDIO_UNTIL_SILENCE_MS : MEDIA_AUDIO_DEFAULT_MS,
+                           100, MIC_RECORD_SECS_MAX * 1000);
+    opts.silence_ms = clamp_ms(input, "silence_ms", VAD_HANGOVER_MS_DEFAULT,
+                               VAD_HANGOVER_MS_MIN, VAD_HANGOVER_MS_MAX);
+
+    // The transcript goes straight into the result; the prefix is put in
+    // front once the amount of speech is known.
+    if (!transcribe_record(&opts, result, result_len, &stats)) {
+        prepend(result, result_len, "Error: ");
         return false;
     }
 
-    // Base64-encode the PCM data
-    size_t b64_len = 0;
-    char *b64 = base64_encode((const uint8_t *)audio_buf, audio_len, &b64_len);
-    free(audio_buf);
+    snprintf(prefix, sizeof(prefix), "Transcript of %u.%u s of speech (listened %u.%u s): ",
+             (unsigned)(stats.speech_ms / 1000), (unsigned)(stats.speech_ms % 1000 / 100),
+             (unsigned)(stats.listened_ms / 1000), (unsigned)(stats.listened_ms % 1000 / 100));
+    prepend(result, result_len, prefix);
+    ESP_LOGI(TAG, "Audio transcribed: %u of %u ms kept, %u bytes uploaded",
+             (unsigned)stats.speech_ms, (unsigned)stats.listened_ms, (unsigned)stats.upload_len);
+    return true;
+}
 
-    if (!b64) {
-        snprintf(result, result_len,
-                 "Error: out of memory encoding audio (%u bytes)", (unsigned)audio_len);
+// ---------------------------------------------------------------------------
+// analyze_audio tool handler
+// ---------------------------------------------------------------------------
+
+#define ANALYZE_CHUNK_SAMPLES   256
+#define ANALYZE_READ_TIMEOUT_MS 1000
+
+bool tools_analyze_audio_handler(const cJSON *input, char *result, size_t result_len)
+{
+    static int16_t s_chunk[ANALYZE_CHUNK_SAMPLES];
+    uint32_t duration_ms = clamp_ms(input, "duration_ms", AUDIO_ANALYZE_DEFAULT_MS,
+                                    100, MIC_RECORD_SECS_MAX * 1000);
+    uint32_t remaining = duration_ms * (MIC_SAMPLE_RATE / 1000);
+    audio_summary_t summary;
+    mic_reader_t reader;
+
+    // Steady sounds read the same a moment ago as a moment from now, so
+    // whatever the capture ring already holds counts, and only the rest is
+    // waited for.
+    if (!mic_open(&reader, duration_ms)) {
+        snprintf(result, result_len, "Error: microphone not running");
         return false;
     }
 
-    ESP_LOGI(TAG, "Audio recorded: %u ms, %u bytes PCM, %u bytes base64",
-             (unsigned)duration_ms, (unsigned)audio_len, (unsigned)b64_len);
+    // The samples are summarised as they arrive; only one FFT window is held.
+    audio_stats_t *stats = malloc(sizeof(*stats));
+    if (!stats) {
+        snprintf(result, result_len, "Error: out of memory");
+        return false;
+    }
+    if (!audio_stats_init(stats, MIC_SAMPLE_RATE)) {
+        free(stats);
+        snprintf(result, result_len, "Error: FFT init failed");
+        return false;
+    }
 
-    snprintf(result, result_len,
-             "Audio recorded: %u ms, %u bytes (16kHz 16-bit mono PCM, base64-encoded). "
-             "data:audio/pcm;base64,%.64s%s",
-             (unsigned)duration_ms, (unsigned)audio_len,
-             b64, b64_len > 64 ? "..." : "");
+    while (remaining > 0) {
+        size_t n = remaining < ANALYZE_CHUNK_SAMPLES ? remaining : ANALYZE_CHUNK_SAMPLES;
+        if (!mic_read(&reader, s_chunk, n, ANALYZE_READ_TIMEOUT_MS)) {
+            free(stats);
+            snprintf(result, result_len, "Error: microphone read failed");
+            return false;
+        }
+        audio_stats_push(stats, s_chunk, n);
+        remaining -= (uint32_t)n;
+    }
 
-    free(b64);
+    audio_stats_finish(stats, &summary);
+    free(stats);
+    audio_stats_format(&summary, result, result_len);
+    ESP_LOGI(TAG, "Audio analyzed: %s", result);
     return true;
 }
 
@@ -248,23 +555,34 @@ bool tools_record_audio_handler(const cJSON *input, char *result, size_t result_
 // ---------------------------------------------------------------------------
 #ifdef TEST_BUILD
 
-void media_test_inject_image(const char *b64_data, size_t b64_len)
+void media_test_inject_image(const uint8_t *jpeg, size_t jpeg_len)
 {
     media_release_pending();
-    if (b64_data && b64_len > 0) {
-        s_pending_b64 = malloc(b64_len + 1);
-        if (s_pending_b64) {
-            memcpy(s_pending_b64, b64_data, b64_len);
-            s_pending_b64[b64_len] = '\0';
-            s_pending_b64_len = b64_len;
+    if (jpeg && jpeg_len > 0) {
+        uint8_t *copy = malloc(jpeg_len);
+        if (copy) {
+            memcpy(copy, jpeg, jpeg_len);
+            set_pending(copy, jpeg_len, true);
         }
     }
 }
 
-// Expose base64_encode for unit testing
+// Whole-buffer base64 through the streaming block encoder, for unit tests
+// and the encoder benchmark. Caller frees.
 char *media_test_base64_encode(const uint8_t *data, size_t data_len, size_t *out_len)
 {
-    return base64_encode(data, data_len, out_len);
+    char *out = malloc(base64_encoded_len(data_len) + 1);
+
+    if (!out) {
+        return NULL;
+    }
+
+    size_t j = base64_encode_block(data, data_len, out);
+    out[j] = '\0';
+    if (out_len) {
+        *out_len = j;
+    }
+    return out;
 }
 
 #endif // TEST_BUILD
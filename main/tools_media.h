@@ -11,17 +11,44 @@
 void media_init(void);
 
 // Pending image state for vision integration.
-// After capture_photo executes, the JPEG data is held here until the
-// next LLM request is built, then released.
+// After capture_photo executes, the JPEG stays in the camera frame buffer
+// until the next LLM request has been sent, then is released. It is never
+// base64-encoded as a whole: the request builder leaves MEDIA_IMAGE_SLOT
+// where the data goes, and media_write_request_body() encodes the frame in
+// MEDIA_B64_CHUNK_BYTES pieces while the body is written to the connection.
+
+// Placeholder for the image's base64 text inside a built request. The
+// control bytes never come out of cJSON's string printer (it escapes them),
+// so the slot cannot be spoofed by message text.
+#define MEDIA_IMAGE_SLOT "\x01" "zclaw-image" "\x01"
 
 // Check if a captured image is waiting to be sent to the LLM.
 bool media_has_pending_image(void);
 
-// Get the pending base64-encoded JPEG data and associated tool_use_id.
+// Get the pending JPEG and associated tool_use_id.
 // Returns false if no image is pending.
-bool media_get_pending_image(const char **base64_out, size_t *base64_len_out,
+bool media_get_pending_image(const uint8_t **jpeg_out, size_t *jpeg_len_out,
                              const char **tool_id_out);
 
+// Sink for request body bytes; returns false to abort.
+typedef bool (*media_body_write_fn)(const char *data, size_t len, void *ctx);
+
+// Length of request_json once the pending image is spliced into its slot
+// (plain strlen when there is no slot or no image).
+size_t media_request_body_len(const char *request_json);
+
+// Write request_json to write(), base64-encoding the pending image into
+// its slot a chunk at a time. Returns false if write() failed.
+bool media_write_request_body(const char *request_json, media_body_write_fn write, void *ctx);
+
+// Pending-image tool ID for a photo that belongs to the turn's user message
+// (a motion event) rather than to a capture_photo result.
+#define MEDIA_USER_IMAGE_ID "user"
+
+// Make the photo of the last motion event the pending image, tagged
+// MEDIA_USER_IMAGE_ID. Returns false when there is none.
+bool media_claim_event_image(void);
+
 // Set the tool_use_id for the pending image (called by agent after tool exec).
 void media_set_pending_tool_id(const char *tool_id);
 
@@ -29,8 +56,8 @@ void media_set_pending_tool_id(const char *tool_id);
 void media_release_pending(void);
 
 #ifdef TEST_BUILD
-// Inject base64 image data for testing (bypasses camera capture).
-void media_test_inject_image(const char *b64_data, size_t b64_len);
+// Inject JPEG bytes for testing (bypasses camera capture; copied).
+void media_test_inject_image(const uint8_t *jpeg, size_t jpeg_len);
 
 // Expose base64 encoder for testing.
 char *media_test_base64_encode(const uint8_t *data, size_t data_len, size_t *out_len);
@@ -4,8 +4,8 @@
 #include "memory_keys.h"
 #include "tools_common.h"
 #include "esp_err.h"
-#include "nvs.h"
 #include <stdio.h>
+#include <stdlib.h>
 
 bool tools_memory_set_handler(const cJSON *input, char *result, size_t result_len)
 {
@@ -25,7 +25,7 @@ bool tools_memory_set_handler(const cJSON *input, char *result, size_t result_le
     const char *value = value_json->valuestring;
 
     // Validate key format
-    if (!tools_validate_nvs_key(key, result, result_len)) {
+    if (!tools_validate_key(key, memory_key_max_len(key), result, result_len)) {
         return false;
     }
 
@@ -39,7 +39,7 @@ bool tools_memory_set_handler(const cJSON *input, char *result, size_t result_le
     }
 
     // Validate value
-    if (!tools_validate_string_input(value, NVS_MAX_VALUE_LEN, result, result_len)) {
+    if (!tools_validate_string_input(value, memory_value_max_len(key), result, result_len)) {
         return false;
     }
 
@@ -64,7 +64,7 @@ bool tools_memory_get_handler(const cJSON *input, char *result, size_t result_le
     const char *key = key_json->valuestring;
 
     // Validate key format
-    if (!tools_validate_nvs_key(key, result, result_len)) {
+    if (!tools_validate_key(key, memory_key_max_len(key), result, result_len)) {
         return false;
     }
 
@@ -78,13 +78,47 @@ bool tools_memory_get_handler(const cJSON *input, char *result, size_t result_le
         return false;
     }
 
-    char value[NVS_MAX_VALUE_LEN + 1];
+    // Store-backed values can be several KB; keep them off the agent stack.
+    size_t value_size = memory_value_max_len(key) + 1;
+    char *value = malloc(value_size);
+    if (!value) {
+        snprintf(result, result_len, "Error: out of memory");
+        return false;
+    }
 
-    if (memory_get(key, value, sizeof(value))) {
+    if (memory_get(key, value, value_size)) {
         snprintf(result, result_len, "%s = %s", key, value);
     } else {
         snprintf(result, result_len, "Key '%s' not found", key);
     }
+    free(value);
+    return true;
+}
+
+typedef struct {
+    char *ptr;
+    size_t remaining;
+    int count;
+} list_ctx_t;
+
+static bool append_listed_key(const char *key, void *ctx)
+{
+    list_ctx_t *list = (list_ctx_t *)ctx;
+
+    // Skip system keys and sensitive values
+    if (!memory_keys_is_user_key(key) || memory_keys_is_sensitive(key)) {
+        return true;
+    }
+    if (list->remaining <= 20) {
+        return false;
+    }
+    if (list->count > 0 && !tools_append_fmt(&list->ptr, &list->remaining, ", ")) {
+        return false;
+    }
+    if (!tools_append_fmt(&list->ptr, &list->remaining, "%s", key)) {
+        return false;
+    }
+    list->count++;
     return true;
 }
 
@@ -96,63 +130,20 @@ bool tools_memory_list_handler(const cJSON *input, char *result, size_t result_l
         return false;
     }
 
-    nvs_handle_t handle;
-    if (nvs_open(NVS_NAMESPACE, NVS_READONLY, &handle) != ESP_OK) {
-        snprintf(result, result_len, "No stored keys");
-        return true;
-    }
+    list_ctx_t list = {
+        .ptr = result,
+        .remaining = result_len,
+        .count = 0,
+    };
 
-    nvs_iterator_t it = NULL;
-    esp_err_t err = nvs_entry_find_in_handle(handle, NVS_TYPE_STR, &it);
-
-    char *ptr = result;
-    size_t remaining = result_len;
-    int count = 0;
-
-    if (!tools_append_fmt(&ptr, &remaining, "Stored keys: ")) {
-        if (it) {
-            nvs_release_iterator(it);
-        }
-        nvs_close(handle);
+    if (!tools_append_fmt(&list.ptr, &list.remaining, "Stored keys: ")) {
         result[result_len - 1] = '\0';
         return true;
     }
 
-    while (err == ESP_OK && it != NULL && remaining > 20) {
-        nvs_entry_info_t info;
-        nvs_entry_info(it, &info);
-
-        if (!memory_keys_is_user_key(info.key)) {
-            err = nvs_entry_next(&it);
-            continue;
-        }
-
-        // Skip sensitive system keys
-        if (memory_keys_is_sensitive(info.key)) {
-            err = nvs_entry_next(&it);
-            continue;
-        }
-
-        if (count > 0) {
-            if (!tools_append_fmt(&ptr, &remaining, ", ")) {
-                break;
-            }
-        }
-
-        if (!tools_append_fmt(&ptr, &remaining, "%s", info.key)) {
-            break;
-        }
-        count++;
-
-        err = nvs_entry_next(&it);
-    }
-
-    if (it) {
-        nvs_release_iterator(it);
-    }
-    nvs_close(handle);
+    memory_list_keys(append_listed_key, &list);
 
-    if (count == 0) {
+    if (list.count == 0) {
         snprintf(result, result_len, "No stored keys");
     }
     return true;
@@ -170,7 +161,7 @@ bool tools_memory_delete_handler(const cJSON *input, char *result, size_t result
     const char *key = key_json->valuestring;
 
     // Validate key format
-    if (!tools_validate_nvs_key(key, result, result_len)) {
+    if (!tools_validate_key(key, memory_key_max_len(key), result, result_len)) {
         return false;
     }
 
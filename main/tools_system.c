@@ -4,6 +4,7 @@
 #include "ratelimit.h"
 #include "cron.h"
 #include "user_tools.h"
+#include "quick_actions.h"
 #include "esp_system.h"
 #include <stdio.h>
 
@@ -23,8 +24,8 @@ bool tools_get_health_handler(const cJSON *input, char *result, size_t result_le
     uint32_t min_heap = esp_get_minimum_free_heap_size();
 
     // Get rate limit info
-    int requests_hour = ratelimit_get_requests_this_hour();
-    int requests_day = ratelimit_get_requests_today();
+    ratelimit_status_t budget;
+    ratelimit_get_status(RATELIMIT_CLASS_INTERACTIVE, &budget);
 
     // Get time sync status
     bool time_synced = cron_is_time_synced();
@@ -36,14 +37,16 @@ bool tools_get_health_handler(const cJSON *input, char *result, size_t result_le
     snprintf(result, result_len,
              "Health: OK | "
              "Heap: %lu free, %lu min | "
-             "Requests: %d/hr, %d/day | "
+             "Tokens left: %lu/%lu hr, %lu/%lu day | "
              "Time: %s | "
              "TZ: %s (%s) | "
              "Version: %s",
              (unsigned long)free_heap,
              (unsigned long)min_heap,
-             requests_hour,
-             requests_day,
+             (unsigned long)budget.hour_available,
+             (unsigned long)budget.hour_capacity,
+             (unsigned long)budget.day_available,
+             (unsigned long)budget.day_capacity,
              time_synced ? "synced" : "not synced",
              timezone_posix,
              timezone_abbrev,
@@ -118,3 +121,54 @@ bool tools_delete_user_tool_handler(const cJSON *input, char *result, size_t res
     snprintf(result, result_len, "Tool '%s' not found", name_json->valuestring);
     return true;
 }
+
+bool tools_pin_quick_action_handler(const cJSON *input, char *result, size_t result_len)
+{
+    cJSON *label_json = cJSON_GetObjectItem(input, "label");
+    cJSON *tool_json = cJSON_GetObjectItem(input, "tool");
+    quick_action_t action;
+
+    if (!label_json || !cJSON_IsString(label_json) ||
+        !tool_json || !cJSON_IsString(tool_json)) {
+        snprintf(result, result_len, "Error: 'label' and 'tool' required");
+        return false;
+    }
+    if (!quick_action_build(label_json->valuestring, tool_json->valuestring,
+                            cJSON_GetObjectItem(input, "args"), &action, result, result_len)) {
+        return false;
+    }
+
+    if (quick_actions_pin(&action)) {
+        snprintf(result, result_len, "Pinned '%s' -> %s %s. Send /actions in Telegram for the buttons.",
+                 action.label, action.tool, action.args);
+        return true;
+    }
+
+    snprintf(result, result_len, "Error: failed to pin (limit %d reached or storage error)",
+             QUICK_ACTION_MAX);
+    return false;
+}
+
+bool tools_unpin_quick_action_handler(const cJSON *input, char *result, size_t result_len)
+{
+    cJSON *label_json = cJSON_GetObjectItem(input, "label");
+
+    if (!label_json || !cJSON_IsString(label_json)) {
+        snprintf(result, result_len, "Error: 'label' required");
+        return false;
+    }
+
+    if (quick_actions_unpin(label_json->valuestring)) {
+        snprintf(result, result_len, "Unpinned '%s'", label_json->valuestring);
+        return true;
+    }
+
+    quick_action_t actions[QUICK_ACTION_MAX];
+    int count = quick_actions_get_all(actions, QUICK_ACTION_MAX);
+    int written = snprintf(result, result_len, "Quick action '%s' not found. Pinned:\n",
+                           label_json->valuestring);
+    if (written > 0 && (size_t)written < result_len) {
+        quick_action_list(actions, count, result + written, result_len - (size_t)written);
+    }
+    return true;
+}
@@ -0,0 +1,142 @@
+#include "transcribe.h"
+
+#if ZCLAW_HAS_MICROPHONE
+
+#include "llm.h"
+#include "mic.h"
+#include "transcribe_util.h"
+#include "vad.h"
+#include "esp_log.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+static const char *TAG = "transcribe";
+
+#define MIC_READ_TIMEOUT_MS 1000
+
+typedef struct {
+    const transcribe_opts_t *opts;
+    transcribe_stream_t *stream;
+    uint8_t (*held)[ADPCM_BLOCK_BYTES];
+    size_t held_max;
+    mic_reader_t reader;
+    uint32_t frames;                // Frames read from the microphone
+    bool mic_failed;
+} upload_t;
+
+// Only the agent task records, so the frame buffer can be static rather
+// than on its stack.
+static int16_t s_frame[VAD_FRAME_SAMPLES];
+
+// Runs once the request is open and the audio goes out while they are still
+// talking. The reader was opened before connecting, so what was said during
+// the handshake waits in the capture ring rather than being missed.
+static bool write_audio_body(media_body_write_fn write, void *write_ctx, void *ctx)
+{
+    upload_t *upload = (upload_t *)ctx;
+    const transcribe_opts_t *opts = upload->opts;
+    transcribe_stream_t *stream = upload->stream;
+    uint32_t max_frames = opts->max_ms / VAD_FRAME_MS;
+    vad_t vad;
+
+    transcribe_stream_init(stream, LLM_TRANSCRIBE_MODEL, MIC_SAMPLE_RATE, upload->held,
+                           upload->held_max, write, write_ctx);
+    vad_init(&vad, opts->silence_ms);
+
+    while (upload->frames < max_frames) {
+        if (!mic_read(&upload->reader, s_frame, VAD_FRAME_SAMPLES, MIC_READ_TIMEOUT_MS)) {
+            upload->mic_failed = true;
+            return false;
+        }
+        upload->frames++;
+
+        vad_event_t event = vad_push(&vad, s_frame);
+        if (!transcribe_stream_frame(stream, event, s_frame)) {
+            return false;
+        }
+        if (opts->until_silence &&
+            (event == VAD_EVENT_END ||
+             (!stream->started && upload->frames >= VAD_START_TIMEOUT_MS / VAD_FRAME_MS))) {
+            break;
+        }
+    }
+
+    // Nobody spoke: abandon the request rather than send an empty file.
+    return transcribe_stream_finish(stream) && stream->started;
+}
+
+bool transcribe_record(const transcribe_opts_t *opts, char *text, size_t text_len,
+                       transcribe_stats_t *stats)
+{
+    upload_t upload = {
+        .opts = opts,
+        .held_max = transcribe_held_blocks(opts->silence_ms),
+    };
+
+    stats->listened_ms = 0;
+    stats->speech_ms = 0;
+    stats->upload_len = 0;
+    if (!llm_has_transcription()) {
+        snprintf(text, text_len, "transcription needs the OpenAI backend or a custom "
+                                 "transcription URL");
+        return false;
+    }
+
+    // Start a little in the past: speech begun while the model was deciding
+    // to listen is still in the ring. It counts toward max_ms.
+    if (!mic_open(&upload.reader, MIC_PREROLL_MS)) {
+        snprintf(text, text_len, "microphone not running");
+        return false;
+    }
+
+    upload.stream = calloc(1, sizeof(*upload.stream));
+    upload.held = malloc(upload.held_max * ADPCM_BLOCK_BYTES);
+    char *response = malloc(TRANSCRIBE_RESPONSE_BUF_SIZE);
+    if (!upload.stream || !upload.held || !response) {
+        free(upload.stream);
+        free(upload.held);
+        free(response);
+        snprintf(text, text_len, "out of memory");
+        return false;
+    }
+    response[0] = '\0';
+
+    ESP_LOGI(TAG, "Listening for up to %u ms (%s, %u ms silence ends speech)",
+             (unsigned)opts->max_ms, opts->until_silence ? "until silence" : "fixed",
+             (unsigned)opts->silence_ms);
+    esp_err_t err = llm_transcribe_request(LLM_BODY_CHUNKED, write_audio_body, &upload,
+                                           response, TRANSCRIBE_RESPONSE_BUF_SIZE);
+
+    stats->listened_ms = upload.frames * VAD_FRAME_MS;
+    stats->speech_ms = (uint32_t)((uint64_t)upload.stream->kept_samples * 1000 / MIC_SAMPLE_RATE);
+    stats->upload_len = upload.stream->wav_len;
+    if (upload.reader.dropped > 0) {
+        ESP_LOGW(TAG, "Fell behind the microphone: %u ms of audio skipped",
+                 (unsigned)((uint64_t)upload.reader.dropped * 1000 / MIC_SAMPLE_RATE));
+    }
+    ESP_LOGI(TAG, "Kept %u of %u ms as speech: %u bytes ADPCM WAV (%u bytes as PCM)",
+             (unsigned)stats->speech_ms, (unsigned)stats->listened_ms,
+             (unsigned)stats->upload_len, (unsigned)(upload.frames * VAD_FRAME_SAMPLES * 2));
+
+    bool ok = false;
+    if (upload.mic_failed) {
+        snprintf(text, text_len, "microphone read failed");
+    } else if (upload.frames == 0) {
+        snprintf(text, text_len, "transcription request failed: %s", esp_err_to_name(err));
+    } else if (!upload.stream->started) {
+        snprintf(text, text_len, "no speech heard in %u.%u s",
+                 (unsigned)(stats->listened_ms / 1000), (unsigned)(stats->listened_ms % 1000 / 100));
+    } else {
+        // An HTTP error reply usually says why; keep that over the status.
+        ok = transcribe_parse_response(response, text, text_len) && err == ESP_OK;
+        if (!ok && text[0] == '\0') {
+            snprintf(text, text_len, "transcription request failed: %s", esp_err_to_name(err));
+        }
+    }
+    free(upload.stream);
+    free(upload.held);
+    free(response);
+    return ok;
+}
+
+#endif // ZCLAW_HAS_MICROPHONE
@@ -0,0 +1,33 @@
+#ifndef TRANSCRIBE_H
+#define TRANSCRIBE_H
+
+#include "config.h"
+
+#if ZCLAW_HAS_MICROPHONE
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct {
+    uint32_t max_ms;                // Stop listening after this long
+    uint32_t silence_ms;            // Quiet that ends an utterance (VAD hangover)
+    bool until_silence;             // Stop when the first utterance ends
+} transcribe_opts_t;
+
+typedef struct {
+    uint32_t listened_ms;           // Audio read from the microphone
+    uint32_t speech_ms;             // Audio kept as speech and uploaded
+    size_t upload_len;              // WAV bytes sent
+} transcribe_stats_t;
+
+// Listen and put the transcript of what was said in text. Frames go through
+// the VAD (vad.h) as they arrive; only speech is IMA-ADPCM encoded and
+// written to the transcription request, so memory use stays a few blocks
+// whatever the duration and silence is never uploaded. False with the
+// reason in text on failure, including when nobody spoke.
+bool transcribe_record(const transcribe_opts_t *opts, char *text, size_t text_len,
+                       transcribe_stats_t *stats);
+
+#endif // ZCLAW_HAS_MICROPHONE
+#endif // TRANSCRIBE_H
@@ -0,0 +1,218 @@
+#include "transcribe_util.h"
+#include "cJSON.h"
+#include <stdio.h>
+#include <string.h>
+
+size_t transcribe_form_head(char *buf, size_t buf_len, const char *model)
+{
+    int n = snprintf(buf, buf_len,
+                     "--" TRANSCRIBE_BOUNDARY "\r\n"
+                     "Content-Disposition: form-data; name=\"model\"\r\n\r\n"
+                     "%s\r\n"
+                     "--" TRANSCRIBE_BOUNDARY "\r\n"
+                     "Content-Disposition: form-data; name=\"response_format\"\r\n\r\n"
+                     "json\r\n"
+                     "--" TRANSCRIBE_BOUNDARY "\r\n"
+                     "Content-Disposition: form-data; name=\"file\"; filename=\"audio.wav\"\r\n"
+                     "Content-Type: audio/wav\r\n\r\n",
+                     model);
+
+    return (n < 0 || (size_t)n >= buf_len) ? 0 : (size_t)n;
+}
+
+size_t transcribe_form_tail(char *buf, size_t buf_len)
+{
+    int n = snprintf(buf, buf_len, "\r\n--" TRANSCRIBE_BOUNDARY "--\r\n");
+
+    return (n < 0 || (size_t)n >= buf_len) ? 0 : (size_t)n;
+}
+
+size_t transcribe_held_blocks(uint32_t hangover_ms)
+{
+    size_t samples = (size_t)(hangover_ms / VAD_FRAME_MS) * VAD_FRAME_SAMPLES;
+
+    // One more for the block the hangover starts partway through.
+    return samples / ADPCM_BLOCK_SAMPLES + 2;
+}
+
+void transcribe_stream_init(transcribe_stream_t *stream, const char *model, uint32_t sample_rate,
+                            uint8_t (*held)[ADPCM_BLOCK_BYTES], size_t held_max,
+                            media_body_write_fn write, void *write_ctx)
+{
+    memset(stream, 0, sizeof(*stream));
+    stream->write = write;
+    stream->write_ctx = write_ctx;
+    stream->model = model;
+    stream->sample_rate = sample_rate;
+    stream->held = held;
+    stream->held_max = held_max;
+    adpcm_init(&stream->adpcm);
+}
+
+static bool emit(transcribe_stream_t *stream, const void *data, size_t len)
+{
+    if (stream->failed || len == 0 || !stream->write((const char *)data, len, stream->write_ctx)) {
+        stream->failed = true;
+    }
+    return !stream->failed;
+}
+
+static bool write_block(transcribe_stream_t *stream, const uint8_t *block, size_t samples)
+{
+    if (!stream->started) {
+        char form[TRANSCRIBE_FORM_BUF_SIZE];
+        uint8_t header[ADPCM_WAV_HEADER_BYTES];
+
+        stream->started = true;
+        adpcm_wav_header(header, stream->sample_rate, ADPCM_WAV_UNKNOWN_SAMPLES);
+        if (!emit(stream, form, transcribe_form_head(form, sizeof(form), stream->model)) ||
+            !emit(stream, header, sizeof(header))) {
+            return false;
+        }
+        stream->wav_len = sizeof(header);
+    }
+    if (!emit(stream, block, ADPCM_BLOCK_BYTES)) {
+        return false;
+    }
+    stream->wav_len += ADPCM_BLOCK_BYTES;
+    stream->kept_samples += (uint32_t)samples;
+    return true;
+}
+
+static bool flush_held(transcribe_stream_t *stream)
+{
+    for (size_t i = 0; i < stream->held_count; i++) {
+        if (!write_block(stream, stream->held[i], ADPCM_BLOCK_SAMPLES)) {
+            return false;
+        }
+    }
+    stream->held_count = 0;
+    return true;
+}
+
+// Encode the full PCM block: out now if it holds speech, else held back.
+static bool complete_block(transcribe_stream_t *stream)
+{
+    bool ok = true;
+
+    if (stream->pcm_keep || stream->held_max == 0) {
+        adpcm_encode_block(&stream->adpcm, stream->pcm, stream->pcm_len, stream->block);
+        ok = write_block(stream, stream->block, stream->pcm_len);
+    } else {
+        // A pause longer than the hold: its start goes out after all.
+        if (stream->held_count == stream->held_max) {
+            ok = flush_held(stream);
+        }
+        adpcm_encode_block(&stream->adpcm, stream->pcm, stream->pcm_len,
+                           stream->held[stream->held_count++]);
+    }
+    stream->pcm_len = 0;
+    stream->pcm_keep = false;
+    return ok;
+}
+
+static bool append(transcribe_stream_t *stream, const int16_t *frame, size_t n, bool keep)
+{
+    // Speech after a pause: the pause was part of it after all.
+    if (keep && !flush_held(stream)) {
+        return false;
+    }
+    while (n > 0) {
+        size_t take = ADPCM_BLOCK_SAMPLES - stream->pcm_len;
+        if (take > n) {
+            take = n;
+        }
+        memcpy(stream->pcm + stream->pcm_len, frame, take * sizeof(int16_t));
+        stream->pcm_len += take;
+        stream->pcm_keep |= keep;
+        frame += take;
+        n -= take;
+        if (stream->pcm_len == ADPCM_BLOCK_SAMPLES && !complete_block(stream)) {
+            return false;
+        }
+    }
+    return !stream->failed;
+}
+
+// Send the speech left in the PCM block and drop the quiet after it.
+static bool end_utterance(transcribe_stream_t *stream)
+{
+    bool ok = true;
+
+    if (stream->pcm_keep && stream->pcm_len > 0) {
+        ok = complete_block(stream);
+    }
+    stream->pcm_len = 0;
+    stream->pcm_keep = false;
+    stream->held_count = 0;
+    return ok;
+}
+
+bool transcribe_stream_frame(transcribe_stream_t *stream, vad_event_t event, const int16_t *frame)
+{
+    switch (event) {
+        case VAD_EVENT_NONE: {
+            int slot = (stream->preroll_head + stream->preroll_count) % VAD_PREROLL_FRAMES;
+            memcpy(stream->preroll[slot], frame, sizeof(stream->preroll[slot]));
+            if (stream->preroll_count < VAD_PREROLL_FRAMES) {
+                stream->preroll_count++;
+            } else {
+                stream->preroll_head = (stream->preroll_head + 1) % VAD_PREROLL_FRAMES;
+            }
+            return !stream->failed;
+        }
+        case VAD_EVENT_START:
+            for (int i = 0; i < stream->preroll_count; i++) {
+                int slot = (stream->preroll_head + i) % VAD_PREROLL_FRAMES;
+                if (!append(stream, stream->preroll[slot], VAD_FRAME_SAMPLES, true)) {
+                    return false;
+                }
+            }
+            stream->preroll_head = 0;
+            stream->preroll_count = 0;
+            return append(stream, frame, VAD_FRAME_SAMPLES, true);
+        case VAD_EVENT_SPEECH:
+            return append(stream, frame, VAD_FRAME_SAMPLES, true);
+        case VAD_EVENT_PAUSE:
+            return append(stream, frame, VAD_FRAME_SAMPLES, false);
+        case VAD_EVENT_END:
+        default:
+            return end_utterance(stream);
+    }
+}
+
+bool transcribe_stream_finish(transcribe_stream_t *stream)
+{
+    char form[TRANSCRIBE_FORM_BUF_SIZE];
+
+    if (!end_utterance(stream)) {
+        return false;
+    }
+    if (!stream->started) {
+        return !stream->failed;
+    }
+    return emit(stream, form, transcribe_form_tail(form, sizeof(form)));
+}
+
+bool transcribe_parse_response(const char *json, char *text, size_t text_len)
+{
+    cJSON *root = cJSON_Parse(json);
+    bool ok = false;
+
+    text[0] = '\0';
+    if (!root) {
+        return false;
+    }
+
+    cJSON *value = cJSON_GetObjectItem(root, "text");
+    cJSON *error = cJSON_GetObjectItem(root, "error");
+    cJSON *message = error ? cJSON_GetObjectItem(error, "message") : NULL;
+    if (value && cJSON_IsString(value)) {
+        snprintf(text, text_len, "%s", value->valuestring);
+        ok = true;
+    } else if (message && cJSON_IsString(message)) {
+        snprintf(text, text_len, "%s", message->valuestring);
+    }
+    cJSON_Delete(root);
+    return ok;
+}
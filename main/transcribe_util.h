@@ -0,0 +1,76 @@
+#ifndef TRANSCRIBE_UTIL_H
+#define TRANSCRIBE_UTIL_H
+
+#include "config.h"
+#include "adpcm.h"
+#include "tools_media.h"
+#include "vad.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Request and response framing for a Whisper-compatible transcription
+// endpoint (OpenAI /v1/audio/transcriptions). The body is multipart/form-data:
+// the form head, then the WAV file streamed as it is recorded, then the tail.
+// Its length is not known until speech ends, so it is sent chunked.
+
+#define TRANSCRIBE_BOUNDARY     "zclaw-audio-7f3a9c"
+#define TRANSCRIBE_CONTENT_TYPE "multipart/form-data; boundary=" TRANSCRIBE_BOUNDARY
+
+// Form fields and the file part's headers, up to where the WAV bytes begin.
+// Returns the length written, or 0 if buf is too small.
+size_t transcribe_form_head(char *buf, size_t buf_len, const char *model);
+
+// Closing boundary after the WAV bytes. Returns the length, or 0 if too small.
+size_t transcribe_form_tail(char *buf, size_t buf_len);
+
+// Turns microphone frames and their VAD events into the request body,
+// keeping only speech. Frames before speech starts wait in a pre-roll ring
+// (the onset and a moment before it). Quiet frames inside speech are encoded
+// but held back, and are sent only if speech resumes within the hangover,
+// so trailing silence never goes out. Nothing at all is written until
+// speech starts.
+typedef struct {
+    media_body_write_fn write;
+    void *write_ctx;
+    const char *model;
+    uint32_t sample_rate;
+    bool started;                   // Form head and WAV header written
+    bool failed;                    // write() failed; everything after is dropped
+    adpcm_state_t adpcm;
+    int16_t pcm[ADPCM_BLOCK_SAMPLES];
+    size_t pcm_len;
+    bool pcm_keep;                  // pcm holds speech, so its block goes out
+    uint8_t block[ADPCM_BLOCK_BYTES];
+    uint8_t (*held)[ADPCM_BLOCK_BYTES]; // Quiet blocks since the last speech
+    size_t held_count;
+    size_t held_max;
+    int16_t preroll[VAD_PREROLL_FRAMES][VAD_FRAME_SAMPLES];
+    int preroll_head;
+    int preroll_count;
+    uint32_t kept_samples;          // Samples sent, padding excluded
+    size_t wav_len;                 // WAV bytes sent
+} transcribe_stream_t;
+
+// Held blocks needed to cover a hangover of hangover_ms.
+size_t transcribe_held_blocks(uint32_t hangover_ms);
+
+// held has room for held_max blocks (transcribe_held_blocks()); fewer just
+// means some trailing silence is sent.
+void transcribe_stream_init(transcribe_stream_t *stream, const char *model, uint32_t sample_rate,
+                            uint8_t (*held)[ADPCM_BLOCK_BYTES], size_t held_max,
+                            media_body_write_fn write, void *write_ctx);
+
+// Feed one VAD_FRAME_SAMPLES frame with the event vad_push() gave it.
+// Returns false once a write has failed.
+bool transcribe_stream_frame(transcribe_stream_t *stream, vad_event_t event, const int16_t *frame);
+
+// Close the last utterance and, if anything was sent, the form. Returns
+// false if a write failed.
+bool transcribe_stream_finish(transcribe_stream_t *stream);
+
+// Pull "text" out of a JSON response. On failure, text gets the endpoint's
+// error message, or is empty when there is none.
+bool transcribe_parse_response(const char *json, char *text, size_t text_len);
+
+#endif // TRANSCRIBE_UTIL_H
@@ -1,5 +1,6 @@
 #include "user_tools.h"
 #include "tools.h"
+#include "nvs_wb.h"
 #include "esp_log.h"
 #include "nvs_flash.h"
 #include "nvs.h"
@@ -36,56 +37,40 @@ static bool name_conflicts_with_builtin_tool(const char *name)
     return false;
 }
 
-static esp_err_t save_to_nvs(void)
+// Persist slots from first_changed onward plus the count, then commit. Slots
+// below first_changed are unchanged and are not rewritten.
+static esp_err_t save_to_nvs(int first_changed)
 {
-    nvs_handle_t handle;
-    esp_err_t err = nvs_open(NVS_NAMESPACE_TOOLS, NVS_READWRITE, &handle);
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to open NVS for writing");
-        return err;
-    }
-
-    // Save count
-    err = nvs_set_u8(handle, "ut_count", (uint8_t)s_tool_count);
+    esp_err_t err = nvs_wb_set_u8(NVS_NAMESPACE_TOOLS, "ut_count", (uint8_t)s_tool_count,
+                                  NVS_WB_DEFERRED);
     if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to persist tool count: %s", esp_err_to_name(err));
-        nvs_close(handle);
+        ESP_LOGE(TAG, "Failed to queue tool count: %s", esp_err_to_name(err));
         return err;
     }
 
-    // Save each tool as a blob
-    for (int i = 0; i < s_tool_count; i++) {
+    for (int i = first_changed; i < MAX_DYNAMIC_TOOLS; i++) {
         char key[16];
         snprintf(key, sizeof(key), "ut_%d", i);
-        err = nvs_set_blob(handle, key, &s_tools[i], sizeof(user_tool_t));
-        if (err != ESP_OK) {
-            ESP_LOGE(TAG, "Failed to persist tool slot %d: %s", i, esp_err_to_name(err));
-            nvs_close(handle);
-            return err;
+        if (i < s_tool_count) {
+            err = nvs_wb_set_blob(NVS_NAMESPACE_TOOLS, key, &s_tools[i], sizeof(user_tool_t),
+                                  NVS_WB_DEFERRED);
+        } else if (i == s_tool_count) {
+            // At most one slot is vacated per change; older stale slots were cleared then.
+            err = nvs_wb_erase(NVS_NAMESPACE_TOOLS, key, NVS_WB_DEFERRED);
+        } else {
+            break;
         }
-    }
-
-    // Clear any remaining old slots
-    for (int i = s_tool_count; i < MAX_DYNAMIC_TOOLS; i++) {
-        char key[16];
-        snprintf(key, sizeof(key), "ut_%d", i);
-        err = nvs_erase_key(handle, key);
-        if (err != ESP_OK && err != ESP_ERR_NVS_NOT_FOUND) {
-            ESP_LOGE(TAG, "Failed clearing stale tool slot %d: %s", i, esp_err_to_name(err));
-            nvs_close(handle);
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to queue tool slot %d: %s", i, esp_err_to_name(err));
             return err;
         }
     }
 
-    err = nvs_commit(handle);
+    err = nvs_wb_flush();
     if (err != ESP_OK) {
         ESP_LOGE(TAG, "Failed to commit user tools: %s", esp_err_to_name(err));
-        nvs_close(handle);
-        return err;
     }
-
-    nvs_close(handle);
-    return ESP_OK;
+    return err;
 }
 
 static void load_from_nvs(void)
@@ -165,10 +150,11 @@ bool user_tools_create(const char *name, const char *description, const char *ac
     tool->action[CRON_MAX_ACTION_LEN - 1] = '\0';
 
     s_tool_count++;
-    esp_err_t save_err = save_to_nvs();
+    esp_err_t save_err = save_to_nvs(s_tool_count - 1);
     if (save_err != ESP_OK) {
         s_tool_count--;
         memset(&s_tools[s_tool_count], 0, sizeof(user_tool_t));
+        save_to_nvs(s_tool_count);  // Supersede writes still queued for retry
         ESP_LOGE(TAG, "Failed to persist user tool '%s': %s", name, esp_err_to_name(save_err));
         return false;
     }
@@ -195,10 +181,11 @@ bool user_tools_delete(const char *name)
             }
             s_tool_count--;
             memset(&s_tools[s_tool_count], 0, sizeof(user_tool_t));
-            esp_err_t save_err = save_to_nvs();
+            esp_err_t save_err = save_to_nvs(i);
             if (save_err != ESP_OK) {
                 memcpy(s_tools, previous_tools, sizeof(s_tools));
                 s_tool_count = previous_count;
+                save_to_nvs(i);  // Supersede writes still queued for retry
                 ESP_LOGE(TAG, "Failed to persist deletion of '%s': %s",
                          name, esp_err_to_name(save_err));
                 return false;
@@ -0,0 +1,129 @@
+#include "vad.h"
+#include <math.h>
+
+#define SILENT_DBFS     (-100.0f)
+
+// One-pole high-pass, corner near 130 Hz at 16 kHz.
+#define HIGHPASS_POLE   0.95f
+
+void vad_features(const int16_t *frame, size_t n, vad_features_t *out)
+{
+    float power = 0.0f;
+    float y = 0.0f;
+    int32_t prev = n > 0 ? frame[0] : 0;
+    bool below = false;
+    int crossings = 0;
+
+    out->energy_dbfs = SILENT_DBFS;
+    out->zcr_pct = 0;
+    if (n == 0) {
+        return;
+    }
+
+    // Measured after a high-pass: it takes out the DC offset PDM microphones
+    // carry, and the rumble and mains hum below the voice, whose slow swings
+    // would otherwise read as loud frames.
+    for (size_t i = 0; i < n; i++) {
+        y = (float)(frame[i] - prev) + HIGHPASS_POLE * y;
+        prev = frame[i];
+        power += y * y;
+        if (i > 0 && (y < 0.0f) != below) {
+            crossings++;
+        }
+        below = y < 0.0f;
+    }
+
+    if (power > 0.0f) {
+        out->energy_dbfs = 10.0f * log10f(power / (float)n / (32768.0f * 32768.0f));
+        if (out->energy_dbfs < SILENT_DBFS) {
+            out->energy_dbfs = SILENT_DBFS;
+        }
+    }
+    out->zcr_pct = crossings * 100 / (int)n;
+}
+
+void vad_init(vad_t *vad, uint32_t hangover_ms)
+{
+    vad->spans_filled = 0;
+    vad->span_index = 0;
+    vad->current_frames = 0;
+    vad->current_min = 0.0f;
+    vad->hangover_frames = (int)(hangover_ms / VAD_FRAME_MS);
+    if (vad->hangover_frames < 1) {
+        vad->hangover_frames = 1;
+    }
+    vad->onset_run = 0;
+    vad->quiet_run = 0;
+    vad->speaking = false;
+}
+
+float vad_noise_floor(const vad_t *vad)
+{
+    float floor_dbfs = vad->current_frames > 0 ? vad->current_min : 0.0f;
+
+    for (int i = 0; i < vad->spans_filled; i++) {
+        if (vad->span_min[i] < floor_dbfs) {
+            floor_dbfs = vad->span_min[i];
+        }
+    }
+    return floor_dbfs;
+}
+
+// Minimum statistics: the quietest frame over VAD_FLOOR_SPANS spans. Speech
+// has gaps between syllables, so the floor stays put while someone talks,
+// but a new steady noise (a fan switching on) becomes the floor once the
+// quieter spans age out.
+static void track_floor(vad_t *vad, float energy_dbfs)
+{
+    if (vad->current_frames == 0 || energy_dbfs < vad->current_min) {
+        vad->current_min = energy_dbfs;
+    }
+    if (++vad->current_frames < VAD_FLOOR_SPAN_FRAMES) {
+        return;
+    }
+    vad->span_min[vad->span_index] = vad->current_min;
+    vad->span_index = (vad->span_index + 1) % VAD_FLOOR_SPANS;
+    if (vad->spans_filled < VAD_FLOOR_SPANS) {
+        vad->spans_filled++;
+    }
+    vad->current_frames = 0;
+}
+
+vad_event_t vad_push(vad_t *vad, const int16_t *frame)
+{
+    vad_features_t f;
+
+    vad_features(frame, VAD_FRAME_SAMPLES, &f);
+    float floor_dbfs = vad_noise_floor(vad);
+    bool loud = f.energy_dbfs >= (float)VAD_MIN_DBFS &&
+                f.energy_dbfs >= floor_dbfs + (float)VAD_SNR_DB;
+    bool voiced = loud && f.zcr_pct < VAD_ZCR_VOICED_PCT;
+    track_floor(vad, f.energy_dbfs);
+
+    if (!vad->speaking) {
+        // Unvoiced frames (a leading "s") neither start speech nor break
+        // the run of voiced ones that does.
+        if (voiced) {
+            vad->onset_run++;
+        } else if (!loud) {
+            vad->onset_run = 0;
+        }
+        if (vad->onset_run < VAD_ONSET_FRAMES) {
+            return VAD_EVENT_NONE;
+        }
+        vad->speaking = true;
+        vad->onset_run = 0;
+        vad->quiet_run = 0;
+        return VAD_EVENT_START;
+    }
+
+    if (loud) {
+        vad->quiet_run = 0;
+        return VAD_EVENT_SPEECH;
+    }
+    if (++vad->quiet_run < vad->hangover_frames) {
+        return VAD_EVENT_PAUSE;
+    }
+    vad->speaking = false;
+    return VAD_EVENT_END;
+}
@@ -0,0 +1,54 @@
+#ifndef VAD_H
+#define VAD_H
+
+#include "config.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Voice activity detection on VAD_FRAME_SAMPLES frames as they stream from
+// the microphone. A frame is loud when its energy is VAD_SNR_DB over the
+// noise floor, taken as the quietest frame of the last few seconds. Loud
+// frames with a low zero-crossing rate are voiced; VAD_ONSET_FRAMES of them
+// in a row start speech, so clicks (too short) and hiss (too many
+// crossings) do not. Once speaking, any loud frame continues it, and a
+// hangover of quiet frames ends it.
+
+typedef enum {
+    VAD_EVENT_NONE = 0,             // No speech; the frame is leading silence
+    VAD_EVENT_START,                // Speech starts; the onset frames before it belong to it
+    VAD_EVENT_SPEECH,               // Speech continues
+    VAD_EVENT_PAUSE,                // Quiet inside speech; kept only if speech resumes
+    VAD_EVENT_END,                  // Hangover ran out; speech ended before the quiet frames
+} vad_event_t;
+
+typedef struct {
+    float energy_dbfs;              // Mean power relative to full scale
+    int zcr_pct;                    // Zero crossings per 100 samples, DC removed
+} vad_features_t;
+
+typedef struct {
+    float span_min[VAD_FLOOR_SPANS];    // Quietest frame of each finished span
+    int spans_filled;
+    int span_index;
+    float current_min;              // Quietest frame of the span in progress
+    int current_frames;
+    int hangover_frames;
+    int onset_run;                  // Voiced frames in a row while waiting
+    int quiet_run;                  // Quiet frames in a row while speaking
+    bool speaking;
+} vad_t;
+
+void vad_features(const int16_t *frame, size_t n, vad_features_t *out);
+
+// hangover_ms of quiet ends an utterance; after VAD_EVENT_END the detector
+// waits for the next one.
+void vad_init(vad_t *vad, uint32_t hangover_ms);
+
+// Classify the next VAD_FRAME_SAMPLES samples.
+vad_event_t vad_push(vad_t *vad, const int16_t *frame);
+
+// Current noise floor in dBFS (0 before the first frame).
+float vad_noise_floor(const vad_t *vad);
+
+#endif // VAD_H
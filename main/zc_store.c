@@ -0,0 +1,950 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "zc_store.h"
+#include "config.h"
+#include "esp_log.h"
+#include <string.h>
+
+static const char *TAG = "zc_store";
+
+#define SEG_MAGIC           0x3153435AU     // "ZCS1"
+#define SEG_HEADER_SIZE     16
+#define REC_MAGIC           0x5A43
+#define REC_HEADER_SIZE     12
+#define REC_ALIGN           4
+#define REC_PUT             1
+#define REC_DEL             2
+#define SECTOR_SIZE         4096
+#define COPY_CHUNK          128
+
+typedef enum {
+    SEG_FREE,
+    SEG_ACTIVE,         // Receives appends
+    SEG_SEALED,         // Full, torn, or superseded by a newer active segment
+} seg_state_t;
+
+typedef struct {
+    uint32_t seq;
+    uint32_t write_off;     // Next append offset within the segment
+    uint32_t live;          // Bytes of records the index points at
+    uint8_t state;
+    bool clean;             // Known erased since this boot
+} seg_t;
+
+typedef struct {
+    uint32_t hash;
+    uint32_t addr;          // Record offset in the partition
+    uint16_t value_len;
+    uint8_t key_len;
+    uint8_t used;
+} index_slot_t;
+
+typedef struct {
+    uint8_t type;
+    uint8_t key_len;
+    uint16_t value_len;
+    uint32_t crc;
+} rec_header_t;
+
+static zc_store_backend_t s_backend;
+static bool s_mounted = false;
+static seg_t s_segs[ZC_STORE_MAX_SEGMENTS];
+static uint16_t s_seg_count = 0;
+static int s_active = -1;
+static uint32_t s_next_seq = 1;
+static index_slot_t s_index[ZC_STORE_INDEX_SLOTS];
+static uint32_t s_key_count = 0;
+static zc_store_stats_t s_stats;
+
+// --- Helpers ---
+
+static void store_lock(void)
+{
+    if (s_backend.lock) {
+        s_backend.lock(s_backend.ctx);
+    }
+}
+
+static void store_unlock(void)
+{
+    if (s_backend.unlock) {
+        s_backend.unlock(s_backend.ctx);
+    }
+}
+
+static uint32_t crc32_update(uint32_t crc, const void *data, size_t len)
+{
+    static const uint32_t table[16] = {
+        0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC,
+        0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+        0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+        0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+    };
+    const uint8_t *p = (const uint8_t *)data;
+
+    crc = ~crc;
+    for (size_t i = 0; i < len; i++) {
+        crc = table[(crc ^ p[i]) & 0x0F] ^ (crc >> 4);
+        crc = table[(crc ^ (p[i] >> 4)) & 0x0F] ^ (crc >> 4);
+    }
+    return ~crc;
+}
+
+static uint32_t hash_key(const char *key, size_t len)
+{
+    uint32_t hash = 2166136261U;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= (uint8_t)key[i];
+        hash *= 16777619U;
+    }
+    return hash;
+}
+
+static void put_le16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_le32(uint8_t *p, uint32_t v)
+{
+    put_le16(p, (uint16_t)v);
+    put_le16(p + 2, (uint16_t)(v >> 16));
+}
+
+static uint16_t get_le16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t get_le32(const uint8_t *p)
+{
+    return (uint32_t)get_le16(p) | ((uint32_t)get_le16(p + 2) << 16);
+}
+
+static bool all_erased(const uint8_t *p, size_t len)
+{
+    for (size_t i = 0; i < len; i++) {
+        if (p[i] != 0xFF) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static uint32_t record_size(size_t key_len, size_t value_len)
+{
+    uint32_t size = (uint32_t)(REC_HEADER_SIZE + key_len + value_len);
+    return (size + REC_ALIGN - 1) & ~(uint32_t)(REC_ALIGN - 1);
+}
+
+static uint32_t seg_base(int seg)
+{
+    return (uint32_t)seg * s_backend.segment_size;
+}
+
+static uint32_t seg_data_size(void)
+{
+    return s_backend.segment_size - SEG_HEADER_SIZE;
+}
+
+static int seg_of(uint32_t addr)
+{
+    return (int)(addr / s_backend.segment_size);
+}
+
+static uint16_t free_segment_count(void)
+{
+    uint16_t count = 0;
+    for (uint16_t i = 0; i < s_seg_count; i++) {
+        if (s_segs[i].state == SEG_FREE) {
+            count++;
+        }
+    }
+    return count;
+}
+
+static uint32_t used_bytes(void)
+{
+    uint32_t used = 0;
+    for (uint16_t i = 0; i < s_seg_count; i++) {
+        if (s_segs[i].state == SEG_ACTIVE || s_segs[i].state == SEG_SEALED) {
+            used += s_segs[i].write_off - SEG_HEADER_SIZE;
+        }
+    }
+    return used;
+}
+
+static uint32_t live_bytes(void)
+{
+    uint32_t live = 0;
+    for (uint16_t i = 0; i < s_seg_count; i++) {
+        live += s_segs[i].live;
+    }
+    return live;
+}
+
+static bool valid_key(const char *key, size_t *len)
+{
+    if (!key) {
+        return false;
+    }
+    *len = strnlen(key, ZC_STORE_MAX_KEY_LEN + 1);
+    return *len > 0 && *len <= ZC_STORE_MAX_KEY_LEN;
+}
+
+static void encode_header(uint8_t *out, const rec_header_t *hdr)
+{
+    put_le16(out, REC_MAGIC);
+    out[2] = hdr->type;
+    out[3] = hdr->key_len;
+    put_le16(out + 4, hdr->value_len);
+    put_le16(out + 6, 0xFFFF);
+    put_le32(out + 8, hdr->crc);
+}
+
+static uint32_t header_crc_seed(const uint8_t *encoded)
+{
+    return crc32_update(0, encoded, 8);
+}
+
+// Returns false for anything that is not a plausible record header.
+static bool decode_header(const uint8_t *in, rec_header_t *hdr)
+{
+    if (get_le16(in) != REC_MAGIC) {
+        return false;
+    }
+    hdr->type = in[2];
+    hdr->key_len = in[3];
+    hdr->value_len = get_le16(in + 4);
+    hdr->crc = get_le32(in + 8);
+    if (hdr->type != REC_PUT && hdr->type != REC_DEL) {
+        return false;
+    }
+    if (hdr->key_len == 0 || hdr->key_len > ZC_STORE_MAX_KEY_LEN ||
+        hdr->value_len > ZC_STORE_MAX_VALUE_LEN) {
+        return false;
+    }
+    return hdr->type == REC_PUT || hdr->value_len == 0;
+}
+
+static esp_err_t read_key(uint32_t addr, uint8_t key_len, char *key)
+{
+    esp_err_t err = s_backend.read(addr + REC_HEADER_SIZE, key, key_len, s_backend.ctx);
+    key[key_len] = '\0';
+    return err;
+}
+
+// --- Hash index ---
+
+static int index_find(const char *key, size_t key_len, uint32_t hash)
+{
+    char stored[ZC_STORE_MAX_KEY_LEN + 1];
+    uint32_t slot = hash % ZC_STORE_INDEX_SLOTS;
+
+    for (uint32_t probes = 0; probes < ZC_STORE_INDEX_SLOTS; probes++) {
+        index_slot_t *entry = &s_index[slot];
+        if (!entry->used) {
+            return -1;
+        }
+        if (entry->hash == hash && entry->key_len == key_len &&
+            read_key(entry->addr, entry->key_len, stored) == ESP_OK &&
+            memcmp(stored, key, key_len) == 0) {
+            return (int)slot;
+        }
+        slot = (slot + 1) % ZC_STORE_INDEX_SLOTS;
+    }
+    return -1;
+}
+
+static void account_remove(const index_slot_t *entry)
+{
+    seg_t *seg = &s_segs[seg_of(entry->addr)];
+    uint32_t size = record_size(entry->key_len, entry->value_len);
+    seg->live = seg->live >= size ? seg->live - size : 0;
+}
+
+static void account_add(uint32_t addr, uint8_t key_len, uint16_t value_len)
+{
+    s_segs[seg_of(addr)].live += record_size(key_len, value_len);
+}
+
+// Backward-shift deletion keeps probe chains intact without tombstones.
+static void index_remove_slot(int slot)
+{
+    uint32_t hole = (uint32_t)slot;
+    uint32_t next = (hole + 1) % ZC_STORE_INDEX_SLOTS;
+
+    account_remove(&s_index[hole]);
+    memset(&s_index[hole], 0, sizeof(s_index[hole]));
+    s_key_count--;
+
+    while (s_index[next].used) {
+        uint32_t home = s_index[next].hash % ZC_STORE_INDEX_SLOTS;
+        bool movable = (hole <= next) ? (home <= hole || home > next)
+                                      : (home <= hole && home > next);
+        if (movable) {
+            s_index[hole] = s_index[next];
+            memset(&s_index[next], 0, sizeof(s_index[next]));
+            hole = next;
+        }
+        next = (next + 1) % ZC_STORE_INDEX_SLOTS;
+    }
+}
+
+static esp_err_t index_put(const char *key, size_t key_len, uint32_t hash, uint32_t addr,
+                           uint16_t value_len)
+{
+    int slot = index_find(key, key_len, hash);
+    if (slot >= 0) {
+        account_remove(&s_index[slot]);
+    } else {
+        if (s_key_count >= ZC_STORE_MAX_KEYS) {
+            return ESP_ERR_NO_MEM;
+        }
+        uint32_t pos = hash % ZC_STORE_INDEX_SLOTS;
+        while (s_index[pos].used) {
+            pos = (pos + 1) % ZC_STORE_INDEX_SLOTS;
+        }
+        slot = (int)pos;
+        s_key_count++;
+    }
+
+    s_index[slot].hash = hash;
+    s_index[slot].addr = addr;
+    s_index[slot].value_len = value_len;
+    s_index[slot].key_len = (uint8_t)key_len;
+    s_index[slot].used = 1;
+    account_add(addr, (uint8_t)key_len, value_len);
+    return ESP_OK;
+}
+
+// --- Segments ---
+
+static esp_err_t erase_segment(int seg)
+{
+    esp_err_t err = s_backend.erase(seg_base(seg), s_backend.segment_size, s_backend.ctx);
+    if (err == ESP_OK) {
+        s_segs[seg].clean = true;
+    }
+    return err;
+}
+
+static esp_err_t open_segment(bool allow_reserve)
+{
+    uint16_t free_count = free_segment_count();
+    // One free segment stays reserved so compaction always has room to copy.
+    if (free_count == 0 || (!allow_reserve && free_count <= 1)) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    // Rotate through the partition for even wear.
+    int start = s_active >= 0 ? s_active + 1 : 0;
+    int seg = -1;
+    for (uint16_t i = 0; i < s_seg_count; i++) {
+        int candidate = (start + i) % s_seg_count;
+        if (s_segs[candidate].state == SEG_FREE) {
+            seg = candidate;
+            break;
+        }
+    }
+    if (seg < 0) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    esp_err_t err = ESP_OK;
+    if (!s_segs[seg].clean) {
+        err = erase_segment(seg);
+        if (err != ESP_OK) {
+            return err;
+        }
+    }
+
+    uint8_t header[SEG_HEADER_SIZE];
+    memset(header, 0xFF, sizeof(header));
+    put_le32(header, SEG_MAGIC);
+    put_le32(header + 4, s_next_seq);
+    put_le32(header + 12, crc32_update(0, header, 8));
+    err = s_backend.write(seg_base(seg), header, sizeof(header), s_backend.ctx);
+    s_segs[seg].clean = false;
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    if (s_active >= 0) {
+        s_segs[s_active].state = SEG_SEALED;
+    }
+    s_segs[seg].seq = s_next_seq++;
+    s_segs[seg].write_off = SEG_HEADER_SIZE;
+    s_segs[seg].live = 0;
+    s_segs[seg].state = SEG_ACTIVE;
+    s_active = seg;
+    return ESP_OK;
+}
+
+static esp_err_t reserve_append(uint32_t size, bool allow_reserve, uint32_t *addr)
+{
+    if (s_active < 0 || s_segs[s_active].write_off + size > s_backend.segment_size) {
+        esp_err_t err = open_segment(allow_reserve);
+        if (err != ESP_OK) {
+            return err;
+        }
+    }
+    *addr = seg_base(s_active) + s_segs[s_active].write_off;
+    return ESP_OK;
+}
+
+static esp_err_t append_record(uint8_t type, const char *key, size_t key_len,
+                               const char *value, size_t value_len, bool allow_reserve,
+                               uint32_t *out_addr)
+{
+    uint32_t size = record_size(key_len, value_len);
+    uint32_t addr = 0;
+    esp_err_t err = reserve_append(size, allow_reserve, &addr);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    rec_header_t hdr = {
+        .type = type,
+        .key_len = (uint8_t)key_len,
+        .value_len = (uint16_t)value_len,
+        .crc = 0,
+    };
+    uint8_t encoded[REC_HEADER_SIZE];
+    encode_header(encoded, &hdr);
+    uint32_t crc = header_crc_seed(encoded);
+    crc = crc32_update(crc, key, key_len);
+    crc = crc32_update(crc, value, value_len);
+    put_le32(encoded + 8, crc);
+
+    // Header first: a tear anywhere after it fails the CRC on mount.
+    s_segs[s_active].write_off += size;
+    err = s_backend.write(addr, encoded, sizeof(encoded), s_backend.ctx);
+    if (err == ESP_OK) {
+        err = s_backend.write(addr + REC_HEADER_SIZE, key, key_len, s_backend.ctx);
+    }
+    if (err == ESP_OK && value_len > 0) {
+        err = s_backend.write(addr + REC_HEADER_SIZE + key_len, value, value_len,
+                              s_backend.ctx);
+    }
+    if (err != ESP_OK) {
+        // The slot may hold a partial record; never append after it.
+        s_segs[s_active].state = SEG_SEALED;
+        s_active = -1;
+        return err;
+    }
+    *out_addr = addr;
+    return ESP_OK;
+}
+
+// Move one live record to the head of the log, streaming through a small buffer.
+static esp_err_t copy_record(uint32_t src, uint32_t size, uint32_t *dst_out)
+{
+    uint8_t chunk[COPY_CHUNK];
+    uint32_t dst = 0;
+    esp_err_t err = reserve_append(size, true, &dst);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    s_segs[s_active].write_off += size;
+    for (uint32_t off = 0; off < size && err == ESP_OK; off += COPY_CHUNK) {
+        size_t len = size - off < COPY_CHUNK ? size - off : COPY_CHUNK;
+        err = s_backend.read(src + off, chunk, len, s_backend.ctx);
+        if (err == ESP_OK) {
+            err = s_backend.write(dst + off, chunk, len, s_backend.ctx);
+        }
+    }
+    if (err != ESP_OK) {
+        s_segs[s_active].state = SEG_SEALED;
+        s_active = -1;
+        return err;
+    }
+    s_stats.bytes_copied += size;
+    *dst_out = dst;
+    return ESP_OK;
+}
+
+static bool compaction_can_reclaim(void)
+{
+    // Only worth it when dead records add up to at least one segment.
+    return used_bytes() - live_bytes() >= seg_data_size();
+}
+
+static int oldest_sealed_segment(void)
+{
+    int oldest = -1;
+    for (uint16_t i = 0; i < s_seg_count; i++) {
+        if (s_segs[i].state == SEG_SEALED &&
+            (oldest < 0 || s_segs[i].seq < s_segs[oldest].seq)) {
+            oldest = i;
+        }
+    }
+    return oldest;
+}
+
+// Copy the oldest segment's live records forward. The victim is the oldest
+// segment in the log, so its tombstones have nothing left to shadow.
+static esp_err_t evacuate_locked(int victim)
+{
+    uint32_t base = seg_base(victim);
+    uint32_t off = SEG_HEADER_SIZE;
+    char key[ZC_STORE_MAX_KEY_LEN + 1];
+    uint8_t encoded[REC_HEADER_SIZE];
+
+    while (off + REC_HEADER_SIZE <= s_segs[victim].write_off) {
+        rec_header_t hdr;
+        esp_err_t err = s_backend.read(base + off, encoded, sizeof(encoded), s_backend.ctx);
+        if (err != ESP_OK) {
+            return err;
+        }
+        if (!decode_header(encoded, &hdr)) {
+            break;                  // Torn tail recorded at mount
+        }
+        uint32_t size = record_size(hdr.key_len, hdr.value_len);
+
+        if (hdr.type == REC_PUT) {
+            err = read_key(base + off, hdr.key_len, key);
+            if (err != ESP_OK) {
+                return err;
+            }
+            int slot = index_find(key, hdr.key_len, hash_key(key, hdr.key_len));
+            if (slot >= 0 && s_index[slot].addr == base + off) {
+                uint32_t dst = 0;
+                err = copy_record(base + off, size, &dst);
+                if (err != ESP_OK) {
+                    return err;
+                }
+                account_remove(&s_index[slot]);
+                s_index[slot].addr = dst;
+                account_add(dst, hdr.key_len, hdr.value_len);
+            }
+        }
+        off += size;
+    }
+    return ESP_OK;
+}
+
+// Evacuate and erase one segment. The erase stays under the lock: if the
+// victim survived a power loss half-erased, its puts could resurface behind
+// tombstones that a concurrent compaction had already dropped.
+static esp_err_t compact_locked(void)
+{
+    int victim = oldest_sealed_segment();
+    if (victim < 0) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    esp_err_t err = evacuate_locked(victim);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Compaction of segment %d failed: %s", victim, esp_err_to_name(err));
+        return err;
+    }
+
+    s_segs[victim].live = 0;
+    err = erase_segment(victim);
+    if (err != ESP_OK) {
+        // Leave it free but dirty; open_segment retries the erase.
+        s_segs[victim].clean = false;
+    }
+    s_segs[victim].state = SEG_FREE;
+    s_segs[victim].write_off = 0;
+    s_stats.compactions++;
+    return ESP_OK;
+}
+
+// Make room for a record of size bytes, compacting inline if needed.
+static esp_err_t ensure_space(uint32_t size)
+{
+    if (s_active >= 0 && s_segs[s_active].write_off + size <= s_backend.segment_size) {
+        return ESP_OK;
+    }
+    for (uint16_t attempt = 0; free_segment_count() <= 1 && attempt < s_seg_count; attempt++) {
+        if (!compaction_can_reclaim() || compact_locked() != ESP_OK) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    return free_segment_count() > 1 ? ESP_OK : ESP_ERR_NO_MEM;
+}
+
+static void maybe_kick(void)
+{
+    if (s_backend.kick && free_segment_count() < ZC_STORE_COMPACT_FREE_SEGMENTS &&
+        compaction_can_reclaim()) {
+        s_backend.kick(s_backend.ctx);
+    }
+}
+
+// --- Mount ---
+
+// Replay one segment into the index. Returns the offset after the last good
+// record; *torn is set when a damaged record ends the segment early.
+static uint32_t replay_segment(int seg, bool *torn)
+{
+    uint32_t base = seg_base(seg);
+    uint32_t off = SEG_HEADER_SIZE;
+    char key[ZC_STORE_MAX_KEY_LEN + 1];
+    uint8_t encoded[REC_HEADER_SIZE];
+    uint8_t chunk[COPY_CHUNK];
+
+    *torn = false;
+    while (off + REC_HEADER_SIZE <= s_backend.segment_size) {
+        rec_header_t hdr;
+        if (s_backend.read(base + off, encoded, sizeof(encoded), s_backend.ctx) != ESP_OK) {
+            *torn = true;
+            break;
+        }
+        if (all_erased(encoded, sizeof(encoded))) {
+            break;
+        }
+        if (!decode_header(encoded, &hdr) ||
+            off + record_size(hdr.key_len, hdr.value_len) > s_backend.segment_size ||
+            read_key(base + off, hdr.key_len, key) != ESP_OK) {
+            *torn = true;
+            break;
+        }
+
+        uint32_t crc = header_crc_seed(encoded);
+        crc = crc32_update(crc, key, hdr.key_len);
+        uint32_t value_addr = base + off + REC_HEADER_SIZE + hdr.key_len;
+        bool read_ok = true;
+        for (uint32_t done = 0; done < hdr.value_len; done += COPY_CHUNK) {
+            size_t len = hdr.value_len - done < COPY_CHUNK ? hdr.value_len - done : COPY_CHUNK;
+            if (s_backend.read(value_addr + done, chunk, len, s_backend.ctx) != ESP_OK) {
+                read_ok = false;
+                break;
+            }
+            crc = crc32_update(crc, chunk, len);
+        }
+        if (!read_ok || crc != hdr.crc) {
+            *torn = true;
+            break;
+        }
+
+        uint32_t hash = hash_key(key, hdr.key_len);
+        if (hdr.type == REC_PUT) {
+            if (index_put(key, hdr.key_len, hash, base + off, hdr.value_len) != ESP_OK) {
+                ESP_LOGE(TAG, "Index full; dropping key %s", key);
+            }
+        } else {
+            int slot = index_find(key, hdr.key_len, hash);
+            if (slot >= 0) {
+                index_remove_slot(slot);
+            }
+        }
+        off += record_size(hdr.key_len, hdr.value_len);
+    }
+    return off;
+}
+
+static void reset_state(void)
+{
+    memset(s_segs, 0, sizeof(s_segs));
+    memset(s_index, 0, sizeof(s_index));
+    memset(&s_stats, 0, sizeof(s_stats));
+    s_seg_count = 0;
+    s_active = -1;
+    s_next_seq = 1;
+    s_key_count = 0;
+    s_mounted = false;
+}
+
+static bool backend_valid(const zc_store_backend_t *backend)
+{
+    if (!backend || !backend->read || !backend->write || !backend->erase) {
+        return false;
+    }
+    if (backend->segment_size == 0 || backend->segment_size % SECTOR_SIZE != 0 ||
+        backend->segment_size < record_size(ZC_STORE_MAX_KEY_LEN, ZC_STORE_MAX_VALUE_LEN) +
+                                SEG_HEADER_SIZE) {
+        return false;
+    }
+    uint32_t segments = backend->size / backend->segment_size;
+    return segments >= 3 && segments <= ZC_STORE_MAX_SEGMENTS;
+}
+
+esp_err_t zc_store_mount(const zc_store_backend_t *backend)
+{
+    int order[ZC_STORE_MAX_SEGMENTS];
+    int ordered = 0;
+
+    reset_state();
+    if (!backend_valid(backend)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    s_backend = *backend;
+    s_seg_count = (uint16_t)(backend->size / backend->segment_size);
+
+    store_lock();
+    for (uint16_t i = 0; i < s_seg_count; i++) {
+        uint8_t header[SEG_HEADER_SIZE];
+        s_segs[i].state = SEG_FREE;
+        if (s_backend.read(seg_base(i), header, sizeof(header), s_backend.ctx) != ESP_OK ||
+            get_le32(header) != SEG_MAGIC ||
+            get_le32(header + 12) != crc32_update(0, header, 8)) {
+            continue;               // Erased or interrupted; reused after an erase
+        }
+        s_segs[i].seq = get_le32(header + 4);
+        s_segs[i].state = SEG_SEALED;
+
+        // Insertion sort by sequence number; replay must run oldest first.
+        int pos = ordered++;
+        while (pos > 0 && s_segs[order[pos - 1]].seq > s_segs[i].seq) {
+            order[pos] = order[pos - 1];
+            pos--;
+        }
+        order[pos] = i;
+    }
+
+    for (int i = 0; i < ordered; i++) {
+        int seg = order[i];
+        bool torn = false;
+        s_segs[seg].write_off = replay_segment(seg, &torn);
+        if (torn) {
+            s_stats.torn_records++;
+            ESP_LOGW(TAG, "Torn record in segment %d at offset %u", seg,
+                     (unsigned)s_segs[seg].write_off);
+        }
+        if (s_segs[seg].seq >= s_next_seq) {
+            s_next_seq = s_segs[seg].seq + 1;
+        }
+        // Keep appending to the newest segment unless it ended in a tear.
+        if (i == ordered - 1 && !torn) {
+            s_segs[seg].state = SEG_ACTIVE;
+            s_active = seg;
+        }
+    }
+
+    s_mounted = true;
+    ESP_LOGI(TAG, "Mounted: %u keys, %u/%u segments in use", (unsigned)s_key_count,
+             (unsigned)(s_seg_count - free_segment_count()), (unsigned)s_seg_count);
+    store_unlock();
+    return ESP_OK;
+}
+
+void zc_store_unmount(void)
+{
+    reset_state();
+    memset(&s_backend, 0, sizeof(s_backend));
+}
+
+bool zc_store_is_mounted(void)
+{
+    return s_mounted;
+}
+
+esp_err_t zc_store_format(const zc_store_backend_t *backend)
+{
+    if (!backend_valid(backend)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    reset_state();
+    esp_err_t err = backend->erase(0, (backend->size / backend->segment_size) *
+                                      backend->segment_size, backend->ctx);
+    if (err != ESP_OK) {
+        return err;
+    }
+    return zc_store_mount(backend);
+}
+
+// --- Public API ---
+
+// True when the stored value for slot already equals value.
+static bool value_matches(const index_slot_t *entry, const char *value, size_t value_len)
+{
+    uint8_t chunk[COPY_CHUNK];
+    uint32_t addr = entry->addr + REC_HEADER_SIZE + entry->key_len;
+
+    if (entry->value_len != value_len) {
+        return false;
+    }
+    for (size_t done = 0; done < value_len; done += COPY_CHUNK) {
+        size_t len = value_len - done < COPY_CHUNK ? value_len - done : COPY_CHUNK;
+        if (s_backend.read(addr + done, chunk, len, s_backend.ctx) != ESP_OK ||
+            memcmp(chunk, value + done, len) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+esp_err_t zc_store_set(const char *key, const char *value)
+{
+    size_t key_len = 0;
+    if (!valid_key(key, &key_len) || !value) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    size_t value_len = strnlen(value, ZC_STORE_MAX_VALUE_LEN + 1);
+    if (value_len > ZC_STORE_MAX_VALUE_LEN) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    store_lock();
+    if (!s_mounted) {
+        store_unlock();
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    uint32_t hash = hash_key(key, key_len);
+    int slot = index_find(key, key_len, hash);
+    if (slot >= 0 && value_matches(&s_index[slot], value, value_len)) {
+        store_unlock();
+        return ESP_OK;              // Unchanged; skip the flash write
+    }
+    if (slot < 0 && s_key_count >= ZC_STORE_MAX_KEYS) {
+        store_unlock();
+        return ESP_ERR_NO_MEM;
+    }
+
+    uint32_t addr = 0;
+    esp_err_t err = ensure_space(record_size(key_len, value_len));
+    if (err == ESP_OK) {
+        err = append_record(REC_PUT, key, key_len, value, value_len, false, &addr);
+    }
+    if (err == ESP_OK) {
+        err = index_put(key, key_len, hash, addr, (uint16_t)value_len);
+    }
+    if (err == ESP_OK) {
+        maybe_kick();
+    }
+    store_unlock();
+    return err;
+}
+
+esp_err_t zc_store_get(const char *key, char *value, size_t *value_len)
+{
+    size_t key_len = 0;
+    if (!valid_key(key, &key_len) || !value_len) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    store_lock();
+    if (!s_mounted) {
+        store_unlock();
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    int slot = index_find(key, key_len, hash_key(key, key_len));
+    if (slot < 0) {
+        store_unlock();
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    const index_slot_t *entry = &s_index[slot];
+    size_t required = (size_t)entry->value_len + 1;
+    if (!value || *value_len < required) {
+        *value_len = required;
+        store_unlock();
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    esp_err_t err = s_backend.read(entry->addr + REC_HEADER_SIZE + entry->key_len, value,
+                                   entry->value_len, s_backend.ctx);
+    value[entry->value_len] = '\0';
+    *value_len = required;
+    store_unlock();
+    return err;
+}
+
+bool zc_store_exists(const char *key)
+{
+    size_t key_len = 0;
+    if (!valid_key(key, &key_len)) {
+        return false;
+    }
+    store_lock();
+    bool found = s_mounted && index_find(key, key_len, hash_key(key, key_len)) >= 0;
+    store_unlock();
+    return found;
+}
+
+esp_err_t zc_store_delete(const char *key)
+{
+    size_t key_len = 0;
+    if (!valid_key(key, &key_len)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    store_lock();
+    if (!s_mounted) {
+        store_unlock();
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    int slot = index_find(key, key_len, hash_key(key, key_len));
+    if (slot < 0) {
+        store_unlock();
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    // Tombstones may dip into the reserve so deletes still work on a full store.
+    uint32_t addr = 0;
+    ensure_space(record_size(key_len, 0));
+    esp_err_t err = append_record(REC_DEL, key, key_len, NULL, 0, true, &addr);
+    if (err == ESP_OK) {
+        index_remove_slot(slot);
+        maybe_kick();
+    }
+    store_unlock();
+    return err;
+}
+
+size_t zc_store_list(bool (*visit)(const char *key, void *ctx), void *ctx)
+{
+    char key[ZC_STORE_MAX_KEY_LEN + 1];
+    size_t visited = 0;
+
+    if (!visit) {
+        return 0;
+    }
+    store_lock();
+    for (uint32_t i = 0; s_mounted && i < ZC_STORE_INDEX_SLOTS; i++) {
+        if (!s_index[i].used || read_key(s_index[i].addr, s_index[i].key_len, key) != ESP_OK) {
+            continue;
+        }
+        visited++;
+        if (!visit(key, ctx)) {
+            break;
+        }
+    }
+    store_unlock();
+    return visited;
+}
+
+bool zc_store_needs_compaction(void)
+{
+    store_lock();
+    bool needed = s_mounted && free_segment_count() < ZC_STORE_COMPACT_FREE_SEGMENTS &&
+                  compaction_can_reclaim();
+    store_unlock();
+    return needed;
+}
+
+esp_err_t zc_store_compact_step(void)
+{
+    store_lock();
+    if (!s_mounted) {
+        store_unlock();
+        return ESP_ERR_INVALID_STATE;
+    }
+    esp_err_t err = compaction_can_reclaim() ? compact_locked() : ESP_OK;
+    store_unlock();
+    return err == ESP_ERR_NOT_FOUND ? ESP_OK : err;
+}
+
+void zc_store_get_stats(zc_store_stats_t *stats)
+{
+    if (!stats) {
+        return;
+    }
+    store_lock();
+    *stats = s_stats;
+    stats->keys = s_key_count;
+    stats->live_bytes = live_bytes();
+    stats->used_bytes = used_bytes();
+    stats->capacity_bytes = s_seg_count * (s_mounted ? seg_data_size() : 0);
+    stats->segments = s_seg_count;
+    stats->free_segments = free_segment_count();
+    store_unlock();
+}
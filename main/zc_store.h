@@ -0,0 +1,73 @@
+#ifndef ZC_STORE_H
+#define ZC_STORE_H
+
+#include "esp_err.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Append-only key/value store for user memory on a raw flash partition.
+//
+// The partition is split into fixed-size segments. Every set or delete
+// appends a CRC-protected record to the active segment; a RAM hash index maps
+// each live key to its newest record. Compaction reclaims the oldest segment
+// by copying its still-live records to the head of the log and erasing it, so
+// tombstones can be dropped once nothing older remains. A torn record (power
+// loss mid-append) fails its CRC on mount and seals that segment.
+//
+// The core only sees a flash backend (read/write/erase), so the same code runs
+// against esp_partition on the device and a file-backed emulation on the host.
+
+#define ZC_STORE_MAX_KEY_LEN    64      // Excluding terminator
+#define ZC_STORE_MAX_VALUE_LEN  4096    // Excluding terminator
+
+typedef struct {
+    esp_err_t (*read)(uint32_t offset, void *buf, size_t len, void *ctx);
+    esp_err_t (*write)(uint32_t offset, const void *buf, size_t len, void *ctx);
+    esp_err_t (*erase)(uint32_t offset, size_t len, void *ctx);   // Sector aligned
+    void (*lock)(void *ctx);        // Optional
+    void (*unlock)(void *ctx);      // Optional
+    void (*kick)(void *ctx);        // Optional: compaction is due; else compact inline
+    void *ctx;
+    uint32_t size;                  // Partition size
+    uint32_t segment_size;          // Multiple of the flash sector size
+} zc_store_backend_t;
+
+typedef struct {
+    uint32_t keys;
+    uint32_t live_bytes;            // Record bytes the index still points at
+    uint32_t used_bytes;            // Record bytes appended to in-use segments
+    uint32_t capacity_bytes;
+    uint16_t segments;
+    uint16_t free_segments;
+    uint32_t compactions;
+    uint32_t bytes_copied;          // Written by compaction
+    uint32_t torn_records;          // Found on mount
+} zc_store_stats_t;
+
+// Scan the partition and rebuild the index. Discards any previous mount.
+esp_err_t zc_store_mount(const zc_store_backend_t *backend);
+void zc_store_unmount(void);
+bool zc_store_is_mounted(void);
+
+// Erase the whole partition and mount it empty.
+esp_err_t zc_store_format(const zc_store_backend_t *backend);
+
+esp_err_t zc_store_set(const char *key, const char *value);
+
+// ESP_ERR_NOT_FOUND when absent; ESP_ERR_INVALID_SIZE when value_len is too
+// small (value_len then holds the required size including the terminator).
+esp_err_t zc_store_get(const char *key, char *value, size_t *value_len);
+bool zc_store_exists(const char *key);
+esp_err_t zc_store_delete(const char *key);
+
+// Visit every live key (order unspecified); stops when visit returns false.
+size_t zc_store_list(bool (*visit)(const char *key, void *ctx), void *ctx);
+
+// Background compaction: one segment per call. Returns true if more is due.
+bool zc_store_needs_compaction(void);
+esp_err_t zc_store_compact_step(void);
+
+void zc_store_get_stats(zc_store_stats_t *stats);
+
+#endif // ZC_STORE_H
@@ -1,10 +1,11 @@
 #!/usr/bin/env python3
-"""Benchmark zclaw latency through relay HTTP or direct serial."""
+"""Benchmark zclaw latency through relay HTTP, direct serial, or a provider endpoint."""
 
 from __future__ import annotations
 
 import argparse
 import glob
+import http.client
 import json
 import os
 import platform
@@ -40,9 +41,9 @@ def parse_args() -> argparse.Namespace:
     parser = argparse.ArgumentParser(description="Benchmark zclaw latency")
     parser.add_argument(
         "--mode",
-        choices=("relay", "serial", "both"),
+        choices=("relay", "serial", "both", "provider"),
         default="relay",
-        help="Benchmark mode (default: relay)",
+        help="Benchmark mode (default: relay); provider talks to an LLM endpoint directly",
     )
     parser.add_argument(
         "--count",
@@ -85,6 +86,18 @@ def parse_args() -> argparse.Namespace:
         help="HTTP request timeout in seconds (default: 120)",
     )
 
+    parser.add_argument(
+        "--provider-url",
+        default="http://127.0.0.1:8788",
+        help="Provider base URL for provider mode, e.g. scripts/mock_provider.py (default: http://127.0.0.1:8788)",
+    )
+    parser.add_argument(
+        "--provider-format",
+        choices=("anthropic", "openai"),
+        default="anthropic",
+        help="Wire format for provider mode (default: anthropic)",
+    )
+
     parser.add_argument("--serial-port", default=None, help="Serial port for serial mode")
     parser.add_argument("--baud", type=int, default=115200, help="Serial baud (default: 115200)")
     parser.add_argument(
@@ -266,6 +279,72 @@ def run_relay_request(
     )
 
 
+def build_provider_request(wire_format: str, message: str) -> tuple[str, dict[str, Any]]:
+    """Return (path, payload) shaped like the firmware's first-round request."""
+    if wire_format == "anthropic":
+        return "/v1/messages", {
+            "model": "mock-model",
+            "max_tokens": 1024,
+            "system": "You are zclaw.",
+            "messages": [{"role": "user", "content": message}],
+        }
+    return "/v1/chat/completions", {
+        "model": "mock-model",
+        "max_tokens": 1024,
+        "messages": [
+            {"role": "system", "content": "You are zclaw."},
+            {"role": "user", "content": message},
+        ],
+    }
+
+
+def run_provider_request(
+    base_url: str,
+    wire_format: str,
+    message: str,
+    timeout_s: float,
+    index: int,
+) -> RequestSample:
+    path, body = build_provider_request(wire_format, message)
+    payload = json.dumps(body).encode("utf-8")
+    headers = {
+        "Content-Type": "application/json",
+        "x-api-key": "mock-key",
+        "anthropic-version": "2023-06-01",
+        "Authorization": "Bearer mock-key",
+    }
+    req = request.Request(base_url.rstrip("/") + path, data=payload, headers=headers, method="POST")
+
+    started = time.monotonic()
+    try:
+        with request.urlopen(req, timeout=timeout_s) as resp:
+            raw = resp.read()
+    except error.HTTPError as exc:
+        retry_after = exc.headers.get("Retry-After") if exc.headers else None
+        suffix = f" (Retry-After: {retry_after})" if retry_after else ""
+        raise RuntimeError(f"HTTP {exc.code}{suffix}") from exc
+    except (error.URLError, OSError, http.client.HTTPException) as exc:
+        raise RuntimeError(f"Provider request failed: {type(exc).__name__}") from exc
+
+    host_total_ms = (time.monotonic() - started) * 1000.0
+    try:
+        json.loads(raw.decode("utf-8"))
+    except Exception as exc:
+        raise RuntimeError(f"Invalid JSON response ({len(raw)} bytes)") from exc
+
+    return RequestSample(
+        index=index,
+        host_total_ms=host_total_ms,
+        relay_elapsed_ms=None,
+        first_response_ms=None,
+        device_total_ms=None,
+        device_llm_ms=None,
+        device_tool_ms=None,
+        device_rounds=None,
+        device_outcome="ok",
+    )
+
+
 def run_serial_request(
     ser: Any,
     message: str,
@@ -374,6 +453,45 @@ def run_relay_benchmark(args: argparse.Namespace) -> list[RequestSample]:
     return samples
 
 
+def run_provider_benchmark(args: argparse.Namespace) -> list[RequestSample]:
+    total = args.warmup + args.count
+    samples: list[RequestSample] = []
+    failures: dict[str, int] = {}
+
+    print(f"Provider benchmark -> {args.provider_url} ({args.provider_format})")
+    print(f"Message: {args.message!r}")
+
+    for i in range(total):
+        measured = i >= args.warmup
+        ordinal = i - args.warmup + 1 if measured else i + 1
+        try:
+            sample = run_provider_request(
+                args.provider_url, args.provider_format, args.message, args.http_timeout, ordinal
+            )
+        except RuntimeError as exc:
+            # Injected faults are expected here; count them instead of aborting the run.
+            if measured:
+                reason = str(exc).split(" (", 1)[0]
+                failures[reason] = failures.get(reason, 0) + 1
+                print(f"  [{ordinal}/{args.count}] failed: {exc}")
+            else:
+                print(f"  [warmup {ordinal}/{args.warmup}] failed: {exc}")
+            continue
+
+        if measured:
+            samples.append(sample)
+            print(f"  [{ordinal}/{args.count}] measure host={sample.host_total_ms:.1f}ms")
+            if ordinal < args.count:
+                time.sleep(max(0.0, args.interval_ms / 1000.0))
+        else:
+            print(f"  [warmup {ordinal}/{args.warmup}] host={sample.host_total_ms:.1f}ms")
+
+    if failures:
+        failure_items = ", ".join(f"{k}={v}" for k, v in sorted(failures.items()))
+        print(f"  Failures: {failure_items}")
+    return samples
+
+
 def run_serial_benchmark(args: argparse.Namespace) -> list[RequestSample]:
     try:
         import serial  # type: ignore
@@ -535,6 +653,10 @@ def main() -> int:
         if args.mode in ("serial", "both"):
             serial_samples = run_serial_benchmark(args)
             print_benchmark_summary("serial", serial_samples)
+
+        if args.mode == "provider":
+            provider_samples = run_provider_benchmark(args)
+            print_benchmark_summary("provider", provider_samples)
     except KeyboardInterrupt:
         print("Interrupted.", file=sys.stderr)
         return 130
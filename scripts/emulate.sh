@@ -12,6 +12,7 @@ QEMU_SDKCONFIG_DEFAULTS_BASE="sdkconfig.defaults;sdkconfig.qemu.defaults"
 LIVE_API_MODE=0
 LIVE_API_PROVIDER="auto"
 LIVE_API_LOGS=0
+LIVE_API_URL="${ZCLAW_LLM_BASE_URL:-}"
 
 while [[ $# -gt 0 ]]; do
     case "$1" in
@@ -31,8 +32,17 @@ while [[ $# -gt 0 ]]; do
             LIVE_API_LOGS=1
             shift
             ;;
+        --live-api-url)
+            if [ $# -lt 2 ]; then
+                echo "Error: --live-api-url requires a base URL (e.g. http://127.0.0.1:8788)"
+                exit 1
+            fi
+            LIVE_API_MODE=1
+            LIVE_API_URL="$2"
+            shift 2
+            ;;
         *)
-            echo "Usage: $0 [--live-api] [--live-api-provider auto|anthropic|openai] [--live-api-logs]"
+            echo "Usage: $0 [--live-api] [--live-api-provider auto|anthropic|openai] [--live-api-logs] [--live-api-url URL]"
             exit 1
             ;;
     esac
@@ -71,7 +81,7 @@ echo "Building QEMU profile..."
 rm -f "$QEMU_SDKCONFIG"
 
 QEMU_SDKCONFIG_DEFAULTS="$QEMU_SDKCONFIG_DEFAULTS_BASE"
-if [ "$LIVE_API_MODE" -eq 1 ]; then
+if [ "$LIVE_API_MODE" -eq 1 ] && [ -z "$LIVE_API_URL" ]; then
     case "$LIVE_API_PROVIDER" in
         anthropic)
             if [ -z "${ANTHROPIC_API_KEY:-}" ]; then
@@ -92,7 +102,9 @@ if [ "$LIVE_API_MODE" -eq 1 ]; then
             fi
             ;;
     esac
+fi
 
+if [ "$LIVE_API_MODE" -eq 1 ]; then
     mkdir -p "$QEMU_BUILD_DIR"
     LIVE_DEFAULTS="$QEMU_BUILD_DIR/sdkconfig.qemu.live.defaults"
     cat > "$LIVE_DEFAULTS" <<'EOF'
@@ -119,7 +131,9 @@ echo "Starting QEMU emulator..."
 if [ "$LIVE_API_MODE" -eq 1 ]; then
     echo "Live API mode enabled: requests are proxied from host -> API provider."
     echo "Provider selection: $LIVE_API_PROVIDER"
-    if [ "$LIVE_API_PROVIDER" = "anthropic" ]; then
+    if [ -n "$LIVE_API_URL" ]; then
+        echo "Using local provider at $LIVE_API_URL (API keys optional)."
+    elif [ "$LIVE_API_PROVIDER" = "anthropic" ]; then
         echo "Using ANTHROPIC_API_KEY from host environment."
     elif [ "$LIVE_API_PROVIDER" = "openai" ]; then
         echo "Using OPENAI_API_KEY from host environment."
@@ -162,6 +176,9 @@ if [ "$LIVE_API_MODE" -eq 1 ]; then
     if [ "$LIVE_API_LOGS" -eq 1 ]; then
         BRIDGE_ARGS+=(--bridge-logs)
     fi
+    if [ -n "$LIVE_API_URL" ]; then
+        BRIDGE_ARGS+=(--api-base-url "$LIVE_API_URL")
+    fi
     python3 "$SCRIPT_DIR/qemu_live_llm_bridge.py" "${BRIDGE_ARGS[@]}" -- "${QEMU_CMD[@]}"
 else
     "${QEMU_CMD[@]}"
@@ -0,0 +1,868 @@
+#!/usr/bin/env python3
+"""Local Anthropic/OpenAI-compatible provider stand-in for load and fault testing.
+
+Serves the Anthropic Messages (`/v1/messages`) and OpenAI Chat Completions
+(`/v1/chat/completions`) shapes, including SSE streaming, tool calls and 429
+responses with Retry-After, plus OpenAI-style `/v1/embeddings` for memory
+recall and `/v1/audio/transcriptions` (multipart WAV, PCM or IMA-ADPCM) for
+record_audio. Responses come from recorded transcripts (or a
+built-in script mirroring the firmware stub) with configurable latency,
+stalls, truncation and error rates.
+"""
+
+from __future__ import annotations
+
+import argparse
+import base64
+import hashlib
+import itertools
+import json
+import logging
+import math
+import random
+import re
+import struct
+import threading
+import time
+from dataclasses import dataclass, field
+from http import HTTPStatus
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+from typing import Any, Iterator
+from urllib.parse import urlparse
+
+
+ANTHROPIC_PATH = "/v1/messages"
+OPENAI_PATH = "/v1/chat/completions"
+EMBEDDINGS_PATH = "/v1/embeddings"
+TRANSCRIPTIONS_PATH = "/v1/audio/transcriptions"
+DEFAULT_EMBED_DIM = 256
+MAX_BODY_BYTES = 4 * 1024 * 1024
+LATENCY_KINDS = ("fixed", "uniform", "normal", "lognormal", "exp")
+
+
+@dataclass(frozen=True)
+class LatencyModel:
+    """Time-to-first-byte distribution in milliseconds."""
+
+    kind: str = "fixed"
+    a: float = 0.0
+    b: float = 0.0
+
+    def sample_ms(self, rng: random.Random) -> float:
+        if self.kind == "fixed":
+            value = self.a
+        elif self.kind == "uniform":
+            value = rng.uniform(self.a, self.b)
+        elif self.kind == "normal":
+            value = rng.gauss(self.a, self.b)
+        elif self.kind == "lognormal":
+            # a = median ms, b = sigma of the underlying normal.
+            value = self.a * math.exp(rng.gauss(0.0, self.b)) if self.a > 0 else 0.0
+        elif self.kind == "exp":
+            value = rng.expovariate(1.0 / self.a) if self.a > 0 else 0.0
+        else:
+            value = 0.0
+        return max(0.0, value)
+
+
+def parse_latency_spec(spec: str) -> LatencyModel:
+    """Parse `kind:a[,b]`, e.g. `fixed:200`, `uniform:100,900`, `lognormal:800,0.5`."""
+    text = spec.strip()
+    if not text:
+        return LatencyModel()
+    if ":" not in text:
+        return LatencyModel("fixed", float(text))
+
+    kind, _, params = text.partition(":")
+    kind = kind.strip().lower()
+    if kind not in LATENCY_KINDS:
+        raise ValueError(f"unknown latency kind '{kind}' (expected one of {', '.join(LATENCY_KINDS)})")
+
+    values = [float(p) for p in params.split(",") if p.strip()]
+    if not values:
+        raise ValueError(f"latency '{spec}' needs at least one parameter")
+    if kind in ("uniform", "normal", "lognormal") and len(values) < 2:
+        raise ValueError(f"latency kind '{kind}' needs two parameters")
+    return LatencyModel(kind, values[0], values[1] if len(values) > 1 else 0.0)
+
+
+@dataclass(frozen=True)
+class FaultConfig:
+    error_rate: float = 0.0
+    rate_limit_rate: float = 0.0
+    retry_after_s: int = 5
+    stall_rate: float = 0.0
+    stall_ms: float = 5000.0
+    truncate_rate: float = 0.0
+
+
+@dataclass(frozen=True)
+class Turn:
+    """Provider-neutral scripted reply: either text or a single tool call."""
+
+    text: str = ""
+    tool_name: str | None = None
+    tool_input: dict[str, Any] = field(default_factory=dict)
+    match: str | None = None
+    input_tokens: int | None = None
+    output_tokens: int | None = None
+
+
+def turn_from_dict(raw: dict[str, Any]) -> Turn:
+    tool = raw.get("tool_use") or raw.get("tool")
+    usage = raw.get("usage") if isinstance(raw.get("usage"), dict) else {}
+    if isinstance(tool, dict):
+        tool_input = tool.get("input", {})
+        return Turn(
+            text=str(raw.get("text", "")),
+            tool_name=str(tool.get("name", "")),
+            tool_input=tool_input if isinstance(tool_input, dict) else {},
+            match=raw.get("match"),
+            input_tokens=usage.get("input_tokens"),
+            output_tokens=usage.get("output_tokens"),
+        )
+    return Turn(
+        text=str(raw.get("text", "")),
+        match=raw.get("match"),
+        input_tokens=usage.get("input_tokens"),
+        output_tokens=usage.get("output_tokens"),
+    )
+
+
+def load_transcript(path: str) -> list[Turn]:
+    """Load one JSON turn per line; blank lines and `#` comments are skipped."""
+    turns: list[Turn] = []
+    with open(path, "r", encoding="utf-8") as handle:
+        for line_no, line in enumerate(handle, start=1):
+            stripped = line.strip()
+            if not stripped or stripped.startswith("#"):
+                continue
+            try:
+                raw = json.loads(stripped)
+            except json.JSONDecodeError as exc:
+                raise ValueError(f"{path}:{line_no}: invalid JSON ({exc})") from exc
+            if not isinstance(raw, dict):
+                raise ValueError(f"{path}:{line_no}: each turn must be a JSON object")
+            turns.append(turn_from_dict(raw))
+    if not turns:
+        raise ValueError(f"{path}: transcript is empty")
+    return turns
+
+
+# Mirrors get_stub_response() in main/llm.c so QEMU stub runs and mock runs agree.
+DEFAULT_TURNS = [
+    Turn(match="pin", tool_name="gpio_write", tool_input={"pin": 10, "state": 1}),
+    Turn(match="gpio", tool_name="gpio_write", tool_input={"pin": 10, "state": 1}),
+    Turn(match="remember", tool_name="memory_set", tool_input={"key": "u_test", "value": "test_value"}),
+    Turn(
+        text="Hello from the zclaw mock provider. "
+        "Try asking me to set a pin high or remember something."
+    ),
+]
+TOOL_RESULT_TURN = Turn(text="Done! I executed the tool successfully.")
+
+
+def last_user_text(payload: dict[str, Any]) -> str:
+    messages = payload.get("messages")
+    if not isinstance(messages, list):
+        return ""
+    for msg in reversed(messages):
+        if not isinstance(msg, dict) or msg.get("role") != "user":
+            continue
+        content = msg.get("content")
+        if isinstance(content, str):
+            return content
+        if isinstance(content, list):
+            parts = [str(b.get("text", "")) for b in content if isinstance(b, dict) and b.get("type") == "text"]
+            return " ".join(parts)
+    return ""
+
+
+def request_ends_with_tool_result(payload: dict[str, Any]) -> bool:
+    messages = payload.get("messages")
+    if not isinstance(messages, list) or not messages:
+        return False
+    last = messages[-1]
+    if not isinstance(last, dict):
+        return False
+    if last.get("role") == "tool":
+        return True
+    content = last.get("content")
+    if isinstance(content, list):
+        return any(isinstance(b, dict) and b.get("type") == "tool_result" for b in content)
+    return False
+
+
+class TurnSource:
+    """Selects the next scripted turn for a request (thread-safe)."""
+
+    def __init__(self, turns: list[Turn] | None = None) -> None:
+        self._scripted = turns is not None
+        self._turns = turns if turns is not None else DEFAULT_TURNS
+        self._cycle = itertools.cycle(range(len(self._turns)))
+        self._lock = threading.Lock()
+
+    def next_turn(self, payload: dict[str, Any]) -> Turn:
+        if request_ends_with_tool_result(payload) and not self._scripted:
+            return TOOL_RESULT_TURN
+
+        text = last_user_text(payload).lower()
+        with self._lock:
+            for turn in self._turns:
+                if turn.match and turn.match.lower() in text:
+                    return turn
+            if self._scripted:
+                return self._turns[next(self._cycle)]
+        for turn in self._turns:
+            if not turn.match:
+                return turn
+        return self._turns[-1]
+
+
+def estimate_tokens(text: str) -> int:
+    return max(1, len(text) // 4)
+
+
+def usage_for(turn: Turn, request_bytes: int) -> tuple[int, int]:
+    input_tokens = turn.input_tokens if turn.input_tokens is not None else max(1, request_bytes // 4)
+    if turn.output_tokens is not None:
+        return input_tokens, turn.output_tokens
+    out_text = turn.text + (json.dumps(turn.tool_input) if turn.tool_name else "")
+    return input_tokens, estimate_tokens(out_text)
+
+
+def build_anthropic_message(turn: Turn, model: str, msg_id: str, request_bytes: int) -> dict[str, Any]:
+    content: list[dict[str, Any]] = []
+    if turn.text:
+        content.append({"type": "text", "text": turn.text})
+    if turn.tool_name:
+        content.append(
+            {"type": "tool_use", "id": f"toolu_{msg_id}", "name": turn.tool_name, "input": turn.tool_input}
+        )
+    input_tokens, output_tokens = usage_for(turn, request_bytes)
+    return {
+        "id": f"msg_{msg_id}",
+        "type": "message",
+        "role": "assistant",
+        "model": model,
+        "content": content,
+        "stop_reason": "tool_use" if turn.tool_name else "end_turn",
+        "stop_sequence": None,
+        "usage": {"input_tokens": input_tokens, "output_tokens": output_tokens},
+    }
+
+
+def build_openai_completion(turn: Turn, model: str, msg_id: str, request_bytes: int) -> dict[str, Any]:
+    message: dict[str, Any] = {"role": "assistant", "content": turn.text or None}
+    if turn.tool_name:
+        message["tool_calls"] = [
+            {
+                "id": f"call_{msg_id}",
+                "type": "function",
+                "function": {"name": turn.tool_name, "arguments": json.dumps(turn.tool_input)},
+            }
+        ]
+    input_tokens, output_tokens = usage_for(turn, request_bytes)
+    return {
+        "id": f"chatcmpl-{msg_id}",
+        "object": "chat.completion",
+        "created": int(time.time()),
+        "model": model,
+        "choices": [
+            {
+                "index": 0,
+                "message": message,
+                "finish_reason": "tool_calls" if turn.tool_name else "stop",
+            }
+        ],
+        "usage": {
+            "prompt_tokens": input_tokens,
+            "completion_tokens": output_tokens,
+            "total_tokens": input_tokens + output_tokens,
+        },
+    }
+
+
+def chunk_text(text: str, size: int = 16) -> list[str]:
+    return [text[i : i + size] for i in range(0, len(text), size)] or [""]
+
+
+def anthropic_sse_events(message: dict[str, Any]) -> Iterator[bytes]:
+    def event(name: str, data: dict[str, Any]) -> bytes:
+        return f"event: {name}\ndata: {json.dumps(data, separators=(',', ':'))}\n\n".encode("utf-8")
+
+    head = dict(message, content=[], stop_reason=None)
+    head["usage"] = {"input_tokens": message["usage"]["input_tokens"], "output_tokens": 0}
+    yield event("message_start", {"type": "message_start", "message": head})
+
+    for index, block in enumerate(message["content"]):
+        if block["type"] == "text":
+            yield event(
+                "content_block_start",
+                {"type": "content_block_start", "index": index, "content_block": {"type": "text", "text": ""}},
+            )
+            for piece in chunk_text(block["text"]):
+                yield event(
+                    "content_block_delta",
+                    {"type": "content_block_delta", "index": index, "delta": {"type": "text_delta", "text": piece}},
+                )
+        else:
+            start_block = {"type": "tool_use", "id": block["id"], "name": block["name"], "input": {}}
+            yield event(
+                "content_block_start",
+                {"type": "content_block_start", "index": index, "content_block": start_block},
+            )
+            for piece in chunk_text(json.dumps(block["input"], separators=(",", ":"))):
+                yield event(
+                    "content_block_delta",
+                    {
+                        "type": "content_block_delta",
+                        "index": index,
+                        "delta": {"type": "input_json_delta", "partial_json": piece},
+                    },
+                )
+        yield event("content_block_stop", {"type": "content_block_stop", "index": index})
+
+    yield event(
+        "message_delta",
+        {
+            "type": "message_delta",
+            "delta": {"stop_reason": message["stop_reason"], "stop_sequence": None},
+            "usage": {"output_tokens": message["usage"]["output_tokens"]},
+        },
+    )
+    yield event("message_stop", {"type": "message_stop"})
+
+
+def openai_sse_chunks(completion: dict[str, Any]) -> Iterator[bytes]:
+    def chunk(delta: dict[str, Any], finish_reason: str | None) -> bytes:
+        payload = {
+            "id": completion["id"],
+            "object": "chat.completion.chunk",
+            "created": completion["created"],
+            "model": completion["model"],
+            "choices": [{"index": 0, "delta": delta, "finish_reason": finish_reason}],
+        }
+        return f"data: {json.dumps(payload, separators=(',', ':'))}\n\n".encode("utf-8")
+
+    choice = completion["choices"][0]
+    message = choice["message"]
+    yield chunk({"role": "assistant", "content": ""}, None)
+    if message.get("content"):
+        for piece in chunk_text(message["content"]):
+            yield chunk({"content": piece}, None)
+    for index, call in enumerate(message.get("tool_calls", [])):
+        head = {"index": index, "id": call["id"], "type": "function", "function": {"name": call["function"]["name"], "arguments": ""}}
+        yield chunk({"tool_calls": [head]}, None)
+        for piece in chunk_text(call["function"]["arguments"]):
+            yield chunk({"tool_calls": [{"index": index, "function": {"arguments": piece}}]}, None)
+    yield chunk({}, choice["finish_reason"])
+    yield b"data: [DONE]\n\n"
+
+
+def embed_text(text: str, dims: int) -> list[float]:
+    """Deterministic hashed bag-of-words unit vector: shared words mean similar vectors."""
+    vec = [0.0] * dims
+    for word in re.findall(r"[a-z0-9]+", text.lower()):
+        digest = hashlib.sha256(word.encode("utf-8")).digest()
+        slot = int.from_bytes(digest[:4], "little") % dims
+        vec[slot] += 1.0 if digest[4] & 1 else -1.0
+    norm = math.sqrt(sum(v * v for v in vec))
+    if norm == 0.0:
+        vec[0] = 1.0
+        return vec
+    return [v / norm for v in vec]
+
+
+def build_embeddings_response(payload: dict[str, Any], model: str) -> dict[str, Any] | None:
+    inputs = payload.get("input")
+    if isinstance(inputs, str):
+        inputs = [inputs]
+    if not isinstance(inputs, list) or not inputs or not all(isinstance(i, str) for i in inputs):
+        return None
+    dims = payload.get("dimensions", DEFAULT_EMBED_DIM)
+    if not isinstance(dims, int) or not 1 <= dims <= 4096:
+        return None
+    as_base64 = payload.get("encoding_format") == "base64"
+
+    data = []
+    for index, text in enumerate(inputs):
+        vec = embed_text(text, dims)
+        embedding: Any = vec
+        if as_base64:
+            embedding = base64.b64encode(struct.pack(f"<{dims}f", *vec)).decode("ascii")
+        data.append({"object": "embedding", "index": index, "embedding": embedding})
+    tokens = sum(estimate_tokens(text) for text in inputs)
+    return {
+        "object": "list",
+        "data": data,
+        "model": model,
+        "usage": {"prompt_tokens": tokens, "total_tokens": tokens},
+    }
+
+
+def parse_multipart(body: bytes, content_type: str) -> dict[str, bytes] | None:
+    """Split a multipart/form-data body into {field name: value bytes}."""
+    match = re.search(r'boundary="?([^";]+)"?', content_type)
+    if not content_type.startswith("multipart/form-data") or not match:
+        return None
+    delimiter = b"--" + match.group(1).encode("ascii")
+    fields: dict[str, bytes] = {}
+    for part in body.split(delimiter)[1:]:
+        if part.startswith(b"--"):
+            break
+        head, sep, value = part.partition(b"\r\n\r\n")
+        name = re.search(rb'name="([^"]*)"', head)
+        if not sep or not name or not value.endswith(b"\r\n"):
+            return None
+        fields[name.group(1).decode("utf-8", "replace")] = value[:-2]
+    return fields
+
+
+IMA_STEPS = [
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+    50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190, 209, 230,
+    253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963,
+    1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024, 3327,
+    3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487,
+    12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767,
+]
+IMA_INDEX = [-1, -1, -1, -1, 2, 4, 6, 8]
+
+
+def decode_ima_block(block: bytes) -> list[int]:
+    """Decode one mono IMA-ADPCM WAV block (4-byte header, low nibble first)."""
+    predictor = struct.unpack_from("<h", block)[0]
+    index = min(block[2], 88)
+    samples = [predictor]
+    for byte in block[4:]:
+        for nibble in (byte & 0x0F, byte >> 4):
+            step = IMA_STEPS[index]
+            diff = step >> 3
+            if nibble & 4:
+                diff += step
+            if nibble & 2:
+                diff += step >> 1
+            if nibble & 1:
+                diff += step >> 2
+            predictor += -diff if nibble & 8 else diff
+            predictor = max(-32768, min(32767, predictor))
+            index = max(0, min(88, index + IMA_INDEX[nibble & 7]))
+            samples.append(predictor)
+    return samples
+
+
+def decode_wav(data: bytes) -> tuple[int, list[int]] | None:
+    """Return (sample rate, mono samples) for 16-bit PCM or IMA-ADPCM WAV data."""
+    if len(data) < 12 or data[:4] != b"RIFF" or data[8:12] != b"WAVE":
+        return None
+    fmt: tuple[int, ...] | None = None
+    frames: int | None = None
+    payload = b""
+    offset = 12
+    while offset + 8 <= len(data):
+        tag, size = data[offset:offset + 4], struct.unpack_from("<I", data, offset + 4)[0]
+        chunk = data[offset + 8:offset + 8 + size]
+        if tag == b"fmt " and size >= 16:
+            fmt = struct.unpack_from("<HHIIHH", chunk)
+        elif tag == b"fact" and size >= 4:
+            frames = struct.unpack_from("<I", chunk)[0]
+        elif tag == b"data":
+            payload = chunk
+        offset += 8 + size + (size & 1)
+    if fmt is None or fmt[1] != 1:
+        return None
+    audio_format, _, rate, _, block_align, bits = fmt
+    if audio_format == 1 and bits == 16:
+        samples = list(struct.unpack(f"<{len(payload) // 2}h", payload[: len(payload) // 2 * 2]))
+    elif audio_format == 0x11 and bits == 4 and block_align > 4:
+        samples = []
+        for start in range(0, len(payload) - block_align + 1, block_align):
+            samples.extend(decode_ima_block(payload[start:start + block_align]))
+        if frames is not None:
+            samples = samples[:frames]
+    else:
+        return None
+    return rate, samples
+
+
+def build_transcription_response(fields: dict[str, bytes]) -> dict[str, Any] | None:
+    """Describe the uploaded audio instead of recognising it, so tests can check the upload."""
+    decoded = decode_wav(fields.get("file", b""))
+    if decoded is None or decoded[0] <= 0:
+        return None
+    rate, samples = decoded
+    seconds = len(samples) / rate
+    rms = math.sqrt(sum(s * s for s in samples) / len(samples)) if samples else 0.0
+    level = 20.0 * math.log10(rms / 32768.0) if rms > 0 else -96.0
+    return {"text": f"mock transcript of {seconds:.1f} s of audio at {level:.0f} dBFS"}
+
+
+def build_error_body(wire: str, status: int, message: str) -> dict[str, Any]:
+    if wire == "anthropic":
+        error_type = "rate_limit_error" if status == 429 else "api_error"
+        return {"type": "error", "error": {"type": error_type, "message": message}}
+    error_type = "rate_limit_exceeded" if status == 429 else "server_error"
+    return {"error": {"message": message, "type": error_type, "code": error_type}}
+
+
+def wire_for_path(path: str) -> str | None:
+    if path.endswith(ANTHROPIC_PATH):
+        return "anthropic"
+    if path.endswith(OPENAI_PATH):
+        return "openai"
+    if path.endswith(EMBEDDINGS_PATH):
+        return "embeddings"
+    if path.endswith(TRANSCRIPTIONS_PATH):
+        return "transcriptions"
+    return None
+
+
+@dataclass
+class ServerStats:
+    requests: int = 0
+    ok: int = 0
+    rate_limited: int = 0
+    errors: int = 0
+    stalled: int = 0
+    truncated: int = 0
+    streamed: int = 0
+
+    def as_dict(self) -> dict[str, int]:
+        return dict(self.__dict__)
+
+
+class MockProvider:
+    """Shared state for request handlers: scripted turns, faults and counters."""
+
+    def __init__(
+        self,
+        turns: TurnSource,
+        latency: LatencyModel,
+        faults: FaultConfig,
+        seed: int | None = None,
+        chunk_delay_ms: float = 0.0,
+    ) -> None:
+        self.turns = turns
+        self.latency = latency
+        self.faults = faults
+        self.chunk_delay_ms = max(0.0, chunk_delay_ms)
+        self.stats = ServerStats()
+        self._rng = random.Random(seed)
+        self._lock = threading.Lock()
+        self._ids = itertools.count(1)
+
+    def roll(self, probability: float) -> bool:
+        if probability <= 0.0:
+            return False
+        with self._lock:
+            return self._rng.random() < probability
+
+    def sample_latency_s(self) -> float:
+        with self._lock:
+            return self.latency.sample_ms(self._rng) / 1000.0
+
+    def next_id(self) -> str:
+        with self._lock:
+            return f"mock{next(self._ids):06d}"
+
+    def count(self, name: str) -> None:
+        with self._lock:
+            setattr(self.stats, name, getattr(self.stats, name) + 1)
+
+
+def make_handler(provider: MockProvider):
+    class MockProviderHandler(BaseHTTPRequestHandler):
+        server_version = "zclaw-mock-provider/1.0"
+        protocol_version = "HTTP/1.1"
+
+        def log_message(self, fmt: str, *args) -> None:  # pragma: no cover - stdlib logging
+            logging.debug("%s - %s", self.address_string(), fmt % args)
+
+        def do_GET(self) -> None:  # noqa: N802
+            path = urlparse(self.path).path
+            if path == "/health":
+                self._send_json(HTTPStatus.OK, {"ok": True})
+                return
+            if path == "/stats":
+                with provider._lock:
+                    stats = provider.stats.as_dict()
+                self._send_json(HTTPStatus.OK, stats)
+                return
+            self._send_json(HTTPStatus.NOT_FOUND, {"error": "Not found"})
+
+        def do_POST(self) -> None:  # noqa: N802
+            wire = wire_for_path(urlparse(self.path).path)
+            if wire is None:
+                self._send_json(HTTPStatus.NOT_FOUND, {"error": "Not found"})
+                return
+
+            raw = self._read_body()
+            if raw is None:
+                return
+            if wire == "transcriptions":
+                fields = parse_multipart(raw, self.headers.get("Content-Type", ""))
+                if fields is None:
+                    self._send_json(HTTPStatus.BAD_REQUEST, build_error_body(wire, 400, "Invalid multipart body"))
+                    return
+                payload: Any = {"model": fields.get("model", b"").decode("utf-8", "replace")}
+            else:
+                try:
+                    payload = json.loads(raw.decode("utf-8"))
+                except (UnicodeDecodeError, json.JSONDecodeError):
+                    self._send_json(HTTPStatus.BAD_REQUEST, build_error_body(wire, 400, "Invalid JSON body"))
+                    return
+            if not isinstance(payload, dict):
+                self._send_json(HTTPStatus.BAD_REQUEST, build_error_body(wire, 400, "Body must be an object"))
+                return
+
+            provider.count("requests")
+            delay_s = provider.sample_latency_s()
+            if delay_s > 0:
+                time.sleep(delay_s)
+
+            faults = provider.faults
+            if provider.roll(faults.rate_limit_rate):
+                provider.count("rate_limited")
+                self._send_json(
+                    HTTPStatus.TOO_MANY_REQUESTS,
+                    build_error_body(wire, 429, "Mock rate limit exceeded"),
+                    extra_headers={"Retry-After": str(faults.retry_after_s)},
+                )
+                return
+            if provider.roll(faults.error_rate):
+                provider.count("errors")
+                self._send_json(
+                    HTTPStatus.INTERNAL_SERVER_ERROR,
+                    build_error_body(wire, 500, "Mock injected server error"),
+                )
+                return
+
+            model = str(payload.get("model") or "mock-model")
+            if wire == "embeddings":
+                body = build_embeddings_response(payload, model)
+                if body is None:
+                    self._send_json(HTTPStatus.BAD_REQUEST, build_error_body(wire, 400, "Invalid embeddings input"))
+                    return
+                self._send_json(HTTPStatus.OK, body)
+                provider.count("ok")
+                return
+            if wire == "transcriptions":
+                body = build_transcription_response(fields)
+                if body is None:
+                    self._send_json(HTTPStatus.BAD_REQUEST, build_error_body(wire, 400, "Invalid file format."))
+                    return
+                self._send_json(HTTPStatus.OK, body)
+                provider.count("ok")
+                return
+
+            turn = provider.turns.next_turn(payload)
+            msg_id = provider.next_id()
+            stall = provider.roll(faults.stall_rate)
+            truncate = provider.roll(faults.truncate_rate)
+            if stall:
+                provider.count("stalled")
+            if truncate:
+                provider.count("truncated")
+
+            if payload.get("stream") is True:
+                provider.count("streamed")
+                if wire == "anthropic":
+                    events = list(anthropic_sse_events(build_anthropic_message(turn, model, msg_id, len(raw))))
+                else:
+                    events = list(openai_sse_chunks(build_openai_completion(turn, model, msg_id, len(raw))))
+                self._send_stream(events, stall, truncate)
+            else:
+                if wire == "anthropic":
+                    body = build_anthropic_message(turn, model, msg_id, len(raw))
+                else:
+                    body = build_openai_completion(turn, model, msg_id, len(raw))
+                self._send_body(json.dumps(body, separators=(",", ":")).encode("utf-8"), stall, truncate)
+
+            if not truncate:
+                provider.count("ok")
+
+        def _read_body(self) -> bytes | None:
+            if self.headers.get("Transfer-Encoding", "").lower() == "chunked":
+                return self._read_chunked_body()
+            try:
+                length = int(self.headers.get("Content-Length", "0"))
+            except ValueError:
+                length = -1
+            if length <= 0 or length > MAX_BODY_BYTES:
+                self._send_json(HTTPStatus.BAD_REQUEST, {"error": "Invalid body size"})
+                return None
+            return self.rfile.read(length)
+
+        def _read_chunked_body(self) -> bytes | None:
+            body = bytearray()
+            while True:
+                line = self.rfile.readline(64).strip()
+                try:
+                    size = int(line.split(b";")[0], 16)
+                except ValueError:
+                    size = -1
+                if size < 0 or len(body) + size > MAX_BODY_BYTES:
+                    self._send_json(HTTPStatus.BAD_REQUEST, {"error": "Invalid chunked body"})
+                    self.close_connection = True
+                    return None
+                if size == 0:
+                    break
+                body += self.rfile.read(size)
+                self.rfile.readline(8)
+            while self.rfile.readline(1024) not in (b"\r\n", b"\n", b""):
+                pass  # Trailer fields
+            if not body:
+                self._send_json(HTTPStatus.BAD_REQUEST, {"error": "Invalid body size"})
+                return None
+            return bytes(body)
+
+        def _stall(self) -> None:
+            time.sleep(provider.faults.stall_ms / 1000.0)
+
+        def _send_body(self, encoded: bytes, stall: bool, truncate: bool) -> None:
+            self.send_response(HTTPStatus.OK.value)
+            self.send_header("Content-Type", "application/json")
+            self.send_header("Content-Length", str(len(encoded)))
+            if truncate:
+                self.send_header("Connection", "close")
+            self.end_headers()
+
+            half = len(encoded) // 2
+            self.wfile.write(encoded[:half])
+            self.wfile.flush()
+            if stall:
+                self._stall()
+            if truncate:
+                # Advertise the full length but hang up halfway through the body.
+                self.close_connection = True
+                return
+            self.wfile.write(encoded[half:])
+
+        def _send_stream(self, events: list[bytes], stall: bool, truncate: bool) -> None:
+            self.send_response(HTTPStatus.OK.value)
+            self.send_header("Content-Type", "text/event-stream")
+            self.send_header("Cache-Control", "no-cache")
+            self.send_header("Connection", "close")
+            self.end_headers()
+            self.close_connection = True
+
+            cut = len(events) // 2
+            for index, data in enumerate(events):
+                if index == cut:
+                    if stall:
+                        self._stall()
+                    if truncate:
+                        return
+                self.wfile.write(data)
+                self.wfile.flush()
+                if provider.chunk_delay_ms > 0:
+                    time.sleep(provider.chunk_delay_ms / 1000.0)
+
+        def _send_json(
+            self,
+            status: HTTPStatus,
+            payload: dict,
+            extra_headers: dict[str, str] | None = None,
+        ) -> None:
+            encoded = json.dumps(payload, separators=(",", ":")).encode("utf-8")
+            self.send_response(status.value)
+            self.send_header("Content-Type", "application/json")
+            self.send_header("Content-Length", str(len(encoded)))
+            for name, value in (extra_headers or {}).items():
+                self.send_header(name, value)
+            self.end_headers()
+            self.wfile.write(encoded)
+
+    return MockProviderHandler
+
+
+def create_server(host: str, port: int, provider: MockProvider) -> ThreadingHTTPServer:
+    server = ThreadingHTTPServer((host, port), make_handler(provider))
+    server.daemon_threads = True
+    return server
+
+
+def parse_args(argv: list[str] | None = None) -> argparse.Namespace:
+    parser = argparse.ArgumentParser(description="zclaw local mock LLM provider")
+    parser.add_argument("--host", default="127.0.0.1", help="Listen host (default: 127.0.0.1)")
+    parser.add_argument("--port", type=int, default=8788, help="Listen port (default: 8788)")
+    parser.add_argument(
+        "--transcript",
+        default=None,
+        help="JSONL transcript of turns to replay (default: built-in stub script)",
+    )
+    parser.add_argument(
+        "--latency",
+        default="fixed:0",
+        help="Time-to-first-byte distribution in ms: fixed:N, uniform:LO,HI, normal:MU,SD, "
+        "lognormal:MEDIAN,SIGMA, exp:MEAN (default: fixed:0)",
+    )
+    parser.add_argument("--chunk-delay-ms", type=float, default=0.0, help="Delay between SSE events")
+    parser.add_argument("--error-rate", type=float, default=0.0, help="Probability of HTTP 500")
+    parser.add_argument("--rate-limit-rate", type=float, default=0.0, help="Probability of HTTP 429")
+    parser.add_argument("--retry-after", type=int, default=5, help="Retry-After seconds on 429 (default: 5)")
+    parser.add_argument("--stall-rate", type=float, default=0.0, help="Probability of a mid-body stall")
+    parser.add_argument("--stall-ms", type=float, default=5000.0, help="Stall duration in ms (default: 5000)")
+    parser.add_argument("--truncate-rate", type=float, default=0.0, help="Probability of cutting the body short")
+    parser.add_argument("--seed", type=int, default=None, help="RNG seed for reproducible fault patterns")
+    parser.add_argument("--debug", action="store_true", help="Log every request")
+    args = parser.parse_args(argv)
+
+    for name in ("error_rate", "rate_limit_rate", "stall_rate", "truncate_rate"):
+        value = getattr(args, name)
+        if not 0.0 <= value <= 1.0:
+            parser.error(f"--{name.replace('_', '-')} must be between 0 and 1")
+    try:
+        args.latency_model = parse_latency_spec(args.latency)
+    except ValueError as exc:
+        parser.error(str(exc))
+    return args
+
+
+def main(argv: list[str] | None = None) -> int:
+    args = parse_args(argv)
+    logging.basicConfig(
+        level=logging.DEBUG if args.debug else logging.INFO,
+        format="%(asctime)s %(levelname)s %(message)s",
+    )
+
+    try:
+        turns = TurnSource(load_transcript(args.transcript) if args.transcript else None)
+    except (OSError, ValueError) as exc:
+        logging.error("%s", exc)
+        return 1
+
+    provider = MockProvider(
+        turns=turns,
+        latency=args.latency_model,
+        faults=FaultConfig(
+            error_rate=args.error_rate,
+            rate_limit_rate=args.rate_limit_rate,
+            retry_after_s=args.retry_after,
+            stall_rate=args.stall_rate,
+            stall_ms=args.stall_ms,
+            truncate_rate=args.truncate_rate,
+        ),
+        seed=args.seed,
+        chunk_delay_ms=args.chunk_delay_ms,
+    )
+    server = create_server(args.host, args.port, provider)
+    base = f"http://{args.host}:{server.server_address[1]}"
+    logging.info("Mock provider listening on %s", base)
+    logging.info("  Anthropic: %s%s", base, ANTHROPIC_PATH)
+    logging.info("  OpenAI:    %s%s", base, OPENAI_PATH)
+    logging.info("  Embeddings: %s%s", base, EMBEDDINGS_PATH)
+    logging.info("  Transcriptions: %s%s", base, TRANSCRIPTIONS_PATH)
+
+    try:
+        server.serve_forever()
+    except KeyboardInterrupt:
+        logging.info("Interrupted, shutting down.")
+    finally:
+        server.server_close()
+    return 0
+
+
+if __name__ == "__main__":
+    raise SystemExit(main())
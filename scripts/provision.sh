@@ -13,6 +13,8 @@ MODEL=""
 API_KEY=""
 TG_TOKEN=""
 TG_CHAT_ID=""
+TG_API_URL=""
+TG_WEBHOOK_SECRET=""
 ASSUME_YES=false
 VERIFY_API_KEY=true
 PRINT_DETECTED_SSID=false
@@ -29,7 +31,9 @@ Options:
   --model <model-id>        Model ID (defaults by backend)
   --api-key <key>           LLM API key (required unless prompted)
   --tg-token <token>        Telegram bot token (optional)
-  --tg-chat-id <id>         Telegram chat ID (optional)
+  --tg-chat-id <id[,id]>    Telegram chat ID(s) to accept; first is primary (optional)
+  --tg-api-url <url>        Telegram Bot API base URL override (e.g. local telegram_sim.py)
+  --tg-webhook-secret <s>   Receive updates by webhook from a reverse proxy instead of polling
   --yes                     Non-interactive (requires --api-key; SSID auto-detect if possible)
   --skip-api-check          Skip live API key verification step
   --print-detected-ssid     Print detected host WiFi SSID and exit (test/troubleshooting helper)
@@ -601,6 +605,22 @@ while [ $# -gt 0 ]; do
         --tg-chat-id=*)
             TG_CHAT_ID="${1#*=}"
             ;;
+        --tg-api-url)
+            shift
+            [ $# -gt 0 ] || { echo "Error: --tg-api-url requires a value"; exit 1; }
+            TG_API_URL="$1"
+            ;;
+        --tg-api-url=*)
+            TG_API_URL="${1#*=}"
+            ;;
+        --tg-webhook-secret)
+            shift
+            [ $# -gt 0 ] || { echo "Error: --tg-webhook-secret requires a value"; exit 1; }
+            TG_WEBHOOK_SECRET="$1"
+            ;;
+        --tg-webhook-secret=*)
+            TG_WEBHOOK_SECRET="${1#*=}"
+            ;;
         --yes)
             ASSUME_YES=true
             ;;
@@ -796,7 +816,29 @@ if [ "$ASSUME_YES" != true ]; then
     fi
 
     if [ -z "$TG_CHAT_ID" ]; then
-        read -r -p "Telegram chat ID (optional): " TG_CHAT_ID
+        read -r -p "Telegram chat ID(s), comma-separated (optional): " TG_CHAT_ID
+    fi
+fi
+
+if [ -n "$TG_API_URL" ]; then
+    case "$TG_API_URL" in
+        http://*|https://*) ;;
+        *)
+            echo "Error: --tg-api-url must start with http:// or https://"
+            exit 1
+            ;;
+    esac
+    if [ "${#TG_API_URL}" -gt 127 ]; then
+        echo "Error: --tg-api-url must be at most 127 characters"
+        exit 1
+    fi
+fi
+
+if [ -n "$TG_WEBHOOK_SECRET" ]; then
+    # Telegram's secret_token rules: 1-256 of A-Z, a-z, 0-9, _ and -.
+    if ! printf '%s' "$TG_WEBHOOK_SECRET" | grep -Eq '^[A-Za-z0-9_-]{1,256}$'; then
+        echo "Error: --tg-webhook-secret must be 1-256 characters of A-Z, a-z, 0-9, _ or -"
+        exit 1
     fi
 fi
 
@@ -836,6 +878,12 @@ trap 'rm -rf "$tmpdir"' EXIT
     if [ -n "$TG_CHAT_ID" ]; then
         printf "tg_chat_id,data,string,%s\n" "$(csv_escape "$TG_CHAT_ID")"
     fi
+    if [ -n "$TG_API_URL" ]; then
+        printf "tg_api_url,data,string,%s\n" "$(csv_escape "$TG_API_URL")"
+    fi
+    if [ -n "$TG_WEBHOOK_SECRET" ]; then
+        printf "tg_wh_secret,data,string,%s\n" "$(csv_escape "$TG_WEBHOOK_SECRET")"
+    fi
 } > "$csv_file"
 
 echo "Generating NVS credential image..."
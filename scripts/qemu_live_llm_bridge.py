@@ -20,6 +20,10 @@ REQ_PREFIX = "__zclaw_llm_req__:"
 RESP_PREFIX = "__zclaw_llm_resp__:"
 ANTHROPIC_API_URL = "https://api.anthropic.com/v1/messages"
 OPENAI_API_URL = "https://api.openai.com/v1/chat/completions"
+ANTHROPIC_MESSAGES_PATH = "/v1/messages"
+OPENAI_CHAT_PATH = "/v1/chat/completions"
+BASE_URL_ENV = "ZCLAW_LLM_BASE_URL"
+MOCK_API_KEY = "mock-key"
 REQ_PREFIX_B = REQ_PREFIX.encode("utf-8")
 RESP_PREFIX_B = RESP_PREFIX.encode("utf-8")
 
@@ -41,13 +45,31 @@ def compact_json_or_error(raw_json: str) -> str:
     return json.dumps(parsed, separators=(",", ":"))
 
 
-def call_anthropic(request_json: str, timeout_s: int) -> str:
-    api_key = os.environ.get("ANTHROPIC_API_KEY", "")
+def resolve_api_url(provider: str, base_url: str | None) -> str:
+    """Pick the endpoint for provider, honoring a local base URL (e.g. mock_provider.py)."""
+    if base_url:
+        path = OPENAI_CHAT_PATH if provider == "openai" else ANTHROPIC_MESSAGES_PATH
+        return base_url.rstrip("/") + path
+    if provider == "openai":
+        return os.environ.get("OPENAI_API_URL", OPENAI_API_URL)
+    return ANTHROPIC_API_URL
+
+
+def resolve_api_key(env_name: str, base_url: str | None) -> str:
+    api_key = os.environ.get(env_name, "")
+    if not api_key and base_url:
+        # Local mock servers do not check credentials.
+        return MOCK_API_KEY
+    return api_key
+
+
+def call_anthropic(request_json: str, timeout_s: int, base_url: str | None = None) -> str:
+    api_key = resolve_api_key("ANTHROPIC_API_KEY", base_url)
     if not api_key:
         return build_error_payload("ANTHROPIC_API_KEY is not set")
 
     req = urllib.request.Request(
-        ANTHROPIC_API_URL,
+        resolve_api_url("anthropic", base_url),
         data=request_json.encode("utf-8"),
         headers={
             "x-api-key": api_key,
@@ -70,14 +92,13 @@ def call_anthropic(request_json: str, timeout_s: int) -> str:
         return build_error_payload(str(exc))
 
 
-def call_openai(request_json: str, timeout_s: int) -> str:
-    api_key = os.environ.get("OPENAI_API_KEY", "")
+def call_openai(request_json: str, timeout_s: int, base_url: str | None = None) -> str:
+    api_key = resolve_api_key("OPENAI_API_KEY", base_url)
     if not api_key:
         return build_error_payload("OPENAI_API_KEY is not set")
 
-    api_url = os.environ.get("OPENAI_API_URL", OPENAI_API_URL)
     req = urllib.request.Request(
-        api_url,
+        resolve_api_url("openai", base_url),
         data=request_json.encode("utf-8"),
         headers={
             "authorization": f"Bearer {api_key}",
@@ -135,10 +156,10 @@ def resolve_provider(provider: str, request_json: str) -> str:
     return provider
 
 
-def call_provider(provider: str, request_json: str, timeout_s: int) -> str:
+def call_provider(provider: str, request_json: str, timeout_s: int, base_url: str | None = None) -> str:
     if provider == "openai":
-        return call_openai(request_json, timeout_s)
-    return call_anthropic(request_json, timeout_s)
+        return call_openai(request_json, timeout_s, base_url)
+    return call_anthropic(request_json, timeout_s, base_url)
 
 
 class RawStdin:
@@ -165,11 +186,13 @@ class QemuLiveBridge:
         provider: str,
         api_timeout_s: int,
         log_requests: bool,
+        base_url: str | None = None,
     ) -> None:
         self.qemu_cmd = qemu_cmd
         self.provider = provider
         self.api_timeout_s = api_timeout_s
         self.log_requests = log_requests
+        self.base_url = base_url
         self.proc: subprocess.Popen[bytes] | None = None
         self._lock = threading.Lock()
         self._pending_request = False
@@ -220,7 +243,7 @@ class QemuLiveBridge:
                 f"[qemu-live-llm] Forwarding request ({len(request_json)} bytes) via {provider}",
             )
         self._set_pending(True)
-        response_json = call_provider(provider, request_json, self.api_timeout_s)
+        response_json = call_provider(provider, request_json, self.api_timeout_s, self.base_url)
         self._write_qemu((RESP_PREFIX + response_json + "\n").encode("utf-8"))
         self._set_pending(False)
         if self.log_requests:
@@ -329,6 +352,12 @@ def parse_args() -> argparse.Namespace:
         action="store_true",
         help="Print per-request bridge forwarding/timing logs",
     )
+    parser.add_argument(
+        "--api-base-url",
+        default=os.environ.get(BASE_URL_ENV) or None,
+        help=f"Send requests to this base URL instead of the public API, e.g. a local "
+        f"scripts/mock_provider.py (env: {BASE_URL_ENV})",
+    )
     parser.add_argument(
         "--anthropic-timeout",
         type=int,
@@ -359,9 +388,17 @@ def main() -> int:
         provider_note = "auto-detect (anthropic/openai)"
     else:
         provider_note = args.provider
+    if args.api_base_url:
+        provider_note += f" via {args.api_base_url}"
     write_host_line(sys.stdout, f"[qemu-live-llm] Bridge active (provider: {provider_note}).")
     write_host_line(sys.stdout, "[qemu-live-llm] Press Ctrl+A then X to exit QEMU.")
-    bridge = QemuLiveBridge(args.qemu_cmd, args.provider, args.api_timeout, args.bridge_logs)
+    bridge = QemuLiveBridge(
+        args.qemu_cmd,
+        args.provider,
+        args.api_timeout,
+        args.bridge_logs,
+        args.api_base_url,
+    )
     with RawStdin():
         return bridge.run()
 
@@ -0,0 +1,718 @@
+#!/usr/bin/env python3
+"""Local Telegram Bot API stand-in for burst, multi-chat and flood-wait testing.
+
+Implements the subset zclaw uses (`getUpdates` long polling, `sendMessage`,
+`getMe`) under `/bot<token>/`, generates inbound traffic across several chats,
+records per-message delivery and reply latency, and injects failures such as
+429 `retry_after`, slow sends and failed polls. `--backlog N` queues messages
+before the first poll and reports how fast the firmware drains them. Point the firmware at it with
+`CONFIG_ZCLAW_TELEGRAM_API_URL` or the `tg_api_url` NVS key.
+
+With `--webhook-url` the simulator acts like Telegram (or the reverse proxy in
+front of the device) in webhook mode instead: each update is POSTed to the
+device with the `X-Telegram-Bot-Api-Secret-Token` header and retried until it
+is accepted with a 2xx, and `getUpdates` answers 409 like the real API does.
+"""
+
+from __future__ import annotations
+
+import argparse
+import json
+import logging
+import random
+import ssl
+import string
+import threading
+import time
+import urllib.error
+import urllib.request
+from collections import deque
+from dataclasses import dataclass
+from http import HTTPStatus
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+from typing import Any
+from urllib.parse import parse_qs, urlparse
+
+from mock_provider import LatencyModel, parse_latency_spec
+
+
+MAX_BODY_BYTES = 1024 * 1024
+MAX_POLL_TIMEOUT_S = 50
+MAX_UPDATES_LIMIT = 100
+PATTERN_KINDS = ("none", "steady", "burst", "poisson")
+WEBHOOK_SECRET_HEADER = "X-Telegram-Bot-Api-Secret-Token"
+WEBHOOK_TIMEOUT_S = 10.0
+
+
+@dataclass(frozen=True)
+class TrafficPattern:
+    """Inbound message schedule: steady:RATE, burst:N,PERIOD_S or poisson:RATE (msgs/s)."""
+
+    kind: str = "none"
+    rate: float = 0.0
+    burst_size: int = 0
+    period_s: float = 0.0
+
+    def next_batch(self, rng: random.Random) -> tuple[float, int]:
+        """Return (seconds to wait, messages to emit after waiting)."""
+        if self.kind == "steady":
+            return 1.0 / self.rate, 1
+        if self.kind == "poisson":
+            return rng.expovariate(self.rate), 1
+        if self.kind == "burst":
+            return self.period_s, self.burst_size
+        return 0.0, 0
+
+
+def parse_pattern_spec(spec: str) -> TrafficPattern:
+    text = spec.strip().lower()
+    if not text or text == "none":
+        return TrafficPattern()
+    kind, _, params = text.partition(":")
+    if kind not in PATTERN_KINDS:
+        raise ValueError(f"unknown traffic pattern '{kind}' (expected one of {', '.join(PATTERN_KINDS)})")
+    values = [float(p) for p in params.split(",") if p.strip()]
+    if kind in ("steady", "poisson"):
+        if len(values) != 1 or values[0] <= 0:
+            raise ValueError(f"pattern '{kind}' needs one positive rate")
+        return TrafficPattern(kind, rate=values[0])
+    if len(values) != 2 or values[0] < 1 or values[1] <= 0:
+        raise ValueError("pattern 'burst' needs N,PERIOD_S with N >= 1 and PERIOD_S > 0")
+    return TrafficPattern(kind, burst_size=int(values[0]), period_s=values[1])
+
+
+def percentile(values: list[float], pct: float) -> float:
+    if not values:
+        return 0.0
+    ordered = sorted(values)
+    rank = (len(ordered) - 1) * pct
+    lo = int(rank)
+    hi = min(lo + 1, len(ordered) - 1)
+    return ordered[lo] + (ordered[hi] - ordered[lo]) * (rank - lo)
+
+
+def summarize(values: list[float]) -> dict[str, float]:
+    if not values:
+        return {"n": 0}
+    return {
+        "n": len(values),
+        "min": min(values),
+        "p50": percentile(values, 0.50),
+        "p90": percentile(values, 0.90),
+        "p99": percentile(values, 0.99),
+        "max": max(values),
+    }
+
+
+@dataclass
+class InboundMessage:
+    update_id: int
+    chat_id: int
+    text: str
+    created: float
+    delivered: float | None = None
+    replied: float | None = None
+
+
+@dataclass(frozen=True)
+class SimFaults:
+    send_429_rate: float = 0.0
+    retry_after_s: int = 3
+    send_latency: LatencyModel = LatencyModel()
+    poll_error_rate: float = 0.0
+
+
+@dataclass
+class SimCounters:
+    polls: int = 0
+    poll_errors: int = 0
+    sends: int = 0
+    send_429: int = 0
+    unknown_chat_sends: int = 0
+    injected: int = 0
+    webhook_posts: int = 0
+    webhook_errors: int = 0
+
+    def as_dict(self) -> dict[str, int]:
+        return dict(self.__dict__)
+
+
+class TelegramSim:
+    """Update queue, reply matching and statistics shared by request handlers."""
+
+    def __init__(
+        self,
+        token: str,
+        chat_ids: list[int],
+        faults: SimFaults | None = None,
+        seed: int | None = None,
+        message_size: int = 0,
+    ) -> None:
+        self.token = token
+        self.chat_ids = chat_ids
+        self.faults = faults or SimFaults()
+        self.message_size = max(0, message_size)
+        self.counters = SimCounters()
+        self._rng = random.Random(seed)
+        self._cond = threading.Condition()
+        self._updates: list[InboundMessage] = []
+        self._history: list[InboundMessage] = []
+        self._next_update_id = 1000
+        self._awaiting_reply: dict[int, deque[InboundMessage]] = {}
+        self._sent: list[dict[str, Any]] = []
+        self._next_chat = 0
+        self._backlog: list[InboundMessage] = []
+        self._backlog_started: float | None = None
+        self._backlog_polls = 0
+        self.webhook_active = False
+
+    def roll(self, probability: float) -> bool:
+        if probability <= 0.0:
+            return False
+        with self._cond:
+            return self._rng.random() < probability
+
+    def sample_send_delay_s(self) -> float:
+        with self._cond:
+            return self.faults.send_latency.sample_ms(self._rng) / 1000.0
+
+    def _filler_text(self, seq: int) -> str:
+        base = f"sim message {seq}"
+        if len(base) >= self.message_size:
+            return base
+        pad = "".join(self._rng.choice(string.ascii_lowercase + " ") for _ in range(self.message_size - len(base) - 1))
+        return f"{base} {pad}"
+
+    def inject(self, text: str | None = None, chat_id: int | None = None) -> InboundMessage:
+        with self._cond:
+            if chat_id is None:
+                chat_id = self.chat_ids[self._next_chat % len(self.chat_ids)]
+                self._next_chat += 1
+            update_id = self._next_update_id
+            self._next_update_id += 1
+            msg = InboundMessage(
+                update_id=update_id,
+                chat_id=chat_id,
+                text=text if text is not None else self._filler_text(update_id),
+                created=time.monotonic(),
+            )
+            self._updates.append(msg)
+            self._history.append(msg)
+            self.counters.injected += 1
+            self._cond.notify_all()
+            return msg
+
+    def preload_backlog(self, count: int) -> None:
+        """Queue messages as if they arrived while the device was offline."""
+        messages = [self.inject() for _ in range(count)]
+        with self._cond:
+            self._backlog.extend(messages)
+
+    def _backlog_report(self) -> dict[str, Any]:
+        delivered = [m.delivered for m in self._backlog if m.delivered is not None]
+        report: dict[str, Any] = {
+            "messages": len(self._backlog),
+            "delivered": len(delivered),
+            "polls": self._backlog_polls,
+        }
+        if delivered and self._backlog_started is not None:
+            drain_s = max(delivered) - self._backlog_started
+            report["drain_ms"] = drain_s * 1000.0
+            report["msgs_per_s"] = len(delivered) / drain_s if drain_s > 0 else float("inf")
+        return report
+
+    def _note_backlog_request(self) -> None:
+        if any(m.delivered is None for m in self._backlog):
+            # Requests it takes to hand over a backlog, timed from the first one.
+            if self._backlog_started is None:
+                self._backlog_started = time.monotonic()
+            self._backlog_polls += 1
+
+    def _mark_delivered(self, msg: InboundMessage, now: float) -> None:
+        if msg.delivered is None:
+            msg.delivered = now
+            self._awaiting_reply.setdefault(msg.chat_id, deque()).append(msg)
+
+    def _pending_after(self, offset: int, limit: int) -> list[InboundMessage]:
+        return [m for m in self._updates if m.update_id >= offset][:limit]
+
+    def get_updates(self, offset: int, limit: int, timeout_s: float) -> list[dict[str, Any]]:
+        """Long-poll like Telegram: confirm updates below offset, then wait for new ones."""
+        limit = max(1, min(limit, MAX_UPDATES_LIMIT))
+        deadline = time.monotonic() + max(0.0, min(timeout_s, MAX_POLL_TIMEOUT_S))
+        with self._cond:
+            self.counters.polls += 1
+            self._note_backlog_request()
+            if offset > 0:
+                self._updates = [m for m in self._updates if m.update_id >= offset]
+
+            batch = self._pending_after(offset, limit)
+            while not batch:
+                remaining = deadline - time.monotonic()
+                if remaining <= 0:
+                    return []
+                self._cond.wait(remaining)
+                batch = self._pending_after(offset, limit)
+
+            now = time.monotonic()
+            for msg in batch:
+                self._mark_delivered(msg, now)
+            return [self._update_json(m) for m in batch]
+
+    def next_webhook_update(self, timeout_s: float) -> InboundMessage | None:
+        """Oldest update the webhook has not accepted yet, waiting up to timeout_s."""
+        deadline = time.monotonic() + max(0.0, timeout_s)
+        with self._cond:
+            while not self._updates:
+                remaining = deadline - time.monotonic()
+                if remaining <= 0:
+                    return None
+                self._cond.wait(remaining)
+            self.counters.webhook_posts += 1
+            self._note_backlog_request()
+            return self._updates[0]
+
+    def confirm_webhook(self, msg: InboundMessage) -> None:
+        with self._cond:
+            self._updates = [m for m in self._updates if m.update_id != msg.update_id]
+            self._mark_delivered(msg, time.monotonic())
+
+    def update_json(self, msg: InboundMessage) -> dict[str, Any]:
+        return self._update_json(msg)
+
+    @staticmethod
+    def _update_json(msg: InboundMessage) -> dict[str, Any]:
+        return {
+            "update_id": msg.update_id,
+            "message": {
+                "message_id": msg.update_id,
+                "date": int(time.time()),
+                "chat": {"id": msg.chat_id, "type": "private"},
+                "from": {"id": msg.chat_id, "is_bot": False, "first_name": "sim"},
+                "text": msg.text,
+            },
+        }
+
+    def record_send(self, chat_id: int, text: str) -> dict[str, Any]:
+        with self._cond:
+            self.counters.sends += 1
+            now = time.monotonic()
+            queue = self._awaiting_reply.get(chat_id)
+            if chat_id not in self.chat_ids:
+                self.counters.unknown_chat_sends += 1
+            if queue:
+                # First reply after a delivered message closes that message's round trip.
+                queue.popleft().replied = now
+            self._sent.append({"chat_id": chat_id, "text": text, "at": now})
+            return {
+                "message_id": len(self._sent),
+                "date": int(time.time()),
+                "chat": {"id": chat_id, "type": "private"},
+                "text": text,
+            }
+
+    def count(self, name: str) -> None:
+        with self._cond:
+            setattr(self.counters, name, getattr(self.counters, name) + 1)
+
+    def report(self) -> dict[str, Any]:
+        with self._cond:
+            messages = list(self._history)
+            delivery = [(m.delivered - m.created) * 1000.0 for m in messages if m.delivered is not None]
+            reply = [(m.replied - m.created) * 1000.0 for m in messages if m.replied is not None]
+            per_chat: dict[str, dict[str, Any]] = {}
+            for chat_id in self.chat_ids:
+                chat_msgs = [m for m in messages if m.chat_id == chat_id]
+                chat_reply = [(m.replied - m.created) * 1000.0 for m in chat_msgs if m.replied is not None]
+                per_chat[str(chat_id)] = {
+                    "injected": len(chat_msgs),
+                    "replied": len(chat_reply),
+                    "reply_ms": summarize(chat_reply),
+                }
+            return {
+                "counters": self.counters.as_dict(),
+                "delivery_ms": summarize(delivery),
+                "reply_ms": summarize(reply),
+                "backlog": self._backlog_report(),
+                "undelivered": sum(1 for m in messages if m.delivered is None),
+                "unanswered": sum(1 for m in messages if m.delivered is not None and m.replied is None),
+                "per_chat": per_chat,
+            }
+
+
+def telegram_error(code: int, description: str, retry_after: int | None = None) -> dict[str, Any]:
+    body: dict[str, Any] = {"ok": False, "error_code": code, "description": description}
+    if retry_after is not None:
+        body["parameters"] = {"retry_after": retry_after}
+    return body
+
+
+def split_bot_path(path: str) -> tuple[str, str] | None:
+    """Split `/bot<token>/<method>` into (token, method)."""
+    if not path.startswith("/bot"):
+        return None
+    token, sep, method = path[4:].partition("/")
+    if not sep or not token or not method:
+        return None
+    return token, method
+
+
+def make_handler(sim: TelegramSim):
+    class TelegramSimHandler(BaseHTTPRequestHandler):
+        server_version = "zclaw-telegram-sim/1.0"
+        protocol_version = "HTTP/1.1"
+
+        def log_message(self, fmt: str, *args) -> None:  # pragma: no cover - stdlib logging
+            logging.debug("%s - %s", self.address_string(), fmt % args)
+
+        def do_GET(self) -> None:  # noqa: N802
+            self._dispatch({})
+
+        def do_POST(self) -> None:  # noqa: N802
+            params = self._read_params()
+            if params is None:
+                return
+            self._dispatch(params)
+
+        def _dispatch(self, body_params: dict[str, Any]) -> None:
+            parsed = urlparse(self.path)
+            if parsed.path == "/sim/stats":
+                self._send_json(HTTPStatus.OK, sim.report())
+                return
+            if parsed.path == "/sim/inject" and self.command == "POST":
+                chat_id = body_params.get("chat_id")
+                msg = sim.inject(
+                    text=str(body_params.get("text", "")) or None,
+                    chat_id=int(chat_id) if chat_id is not None else None,
+                )
+                self._send_json(HTTPStatus.OK, {"ok": True, "update_id": msg.update_id})
+                return
+
+            route = split_bot_path(parsed.path)
+            if route is None:
+                self._send_json(HTTPStatus.NOT_FOUND, telegram_error(404, "Not Found"))
+                return
+            token, method = route
+            if token != sim.token:
+                self._send_json(HTTPStatus.UNAUTHORIZED, telegram_error(401, "Unauthorized"))
+                return
+
+            params = {k: v[-1] for k, v in parse_qs(parsed.query).items()}
+            params.update(body_params)
+
+            if method == "getMe":
+                self._send_ok({"id": 1, "is_bot": True, "first_name": "zclaw-sim", "username": "zclaw_sim_bot"})
+            elif method == "getUpdates":
+                self._get_updates(params)
+            elif method == "sendMessage":
+                self._send_message(params)
+            else:
+                self._send_json(HTTPStatus.NOT_FOUND, telegram_error(404, "Not Found: method not found"))
+
+        def _get_updates(self, params: dict[str, Any]) -> None:
+            try:
+                offset = int(params.get("offset", 0))
+                limit = int(params.get("limit", MAX_UPDATES_LIMIT))
+                timeout_s = float(params.get("timeout", 0))
+            except (TypeError, ValueError):
+                self._send_json(HTTPStatus.BAD_REQUEST, telegram_error(400, "Bad Request: invalid parameters"))
+                return
+            if sim.webhook_active:
+                self._send_json(
+                    HTTPStatus.CONFLICT,
+                    telegram_error(409, "Conflict: can't use getUpdates method while webhook is active"),
+                )
+                return
+            if sim.roll(sim.faults.poll_error_rate):
+                sim.count("poll_errors")
+                self._send_json(HTTPStatus.BAD_GATEWAY, telegram_error(502, "Bad Gateway"))
+                return
+            self._send_ok(sim.get_updates(offset, limit, timeout_s))
+
+        def _send_message(self, params: dict[str, Any]) -> None:
+            try:
+                chat_id = int(params.get("chat_id"))
+            except (TypeError, ValueError):
+                self._send_json(HTTPStatus.BAD_REQUEST, telegram_error(400, "Bad Request: chat_id is empty"))
+                return
+            text = params.get("text")
+            if not isinstance(text, str) or not text:
+                self._send_json(HTTPStatus.BAD_REQUEST, telegram_error(400, "Bad Request: message text is empty"))
+                return
+            if len(text) > 4096:
+                self._send_json(HTTPStatus.BAD_REQUEST, telegram_error(400, "Bad Request: message is too long"))
+                return
+
+            delay_s = sim.sample_send_delay_s()
+            if delay_s > 0:
+                time.sleep(delay_s)
+            if sim.roll(sim.faults.send_429_rate):
+                sim.count("send_429")
+                retry_after = sim.faults.retry_after_s
+                self._send_json(
+                    HTTPStatus.TOO_MANY_REQUESTS,
+                    telegram_error(429, f"Too Many Requests: retry after {retry_after}", retry_after),
+                    extra_headers={"Retry-After": str(retry_after)},
+                )
+                return
+            self._send_ok(sim.record_send(chat_id, text))
+
+        def _read_params(self) -> dict[str, Any] | None:
+            try:
+                length = int(self.headers.get("Content-Length", "0"))
+            except ValueError:
+                length = -1
+            if length < 0 or length > MAX_BODY_BYTES:
+                self._send_json(HTTPStatus.BAD_REQUEST, telegram_error(400, "Bad Request: invalid body size"))
+                return None
+            if length == 0:
+                return {}
+            raw = self.rfile.read(length).decode("utf-8", errors="replace")
+            content_type = self.headers.get("Content-Type", "")
+            if "application/x-www-form-urlencoded" in content_type:
+                return {k: v[-1] for k, v in parse_qs(raw).items()}
+            try:
+                parsed = json.loads(raw)
+            except json.JSONDecodeError:
+                self._send_json(HTTPStatus.BAD_REQUEST, telegram_error(400, "Bad Request: can't parse JSON"))
+                return None
+            if not isinstance(parsed, dict):
+                self._send_json(HTTPStatus.BAD_REQUEST, telegram_error(400, "Bad Request: expected object"))
+                return None
+            return parsed
+
+        def _send_ok(self, result: Any) -> None:
+            self._send_json(HTTPStatus.OK, {"ok": True, "result": result})
+
+        def _send_json(
+            self,
+            status: HTTPStatus,
+            payload: dict,
+            extra_headers: dict[str, str] | None = None,
+        ) -> None:
+            encoded = json.dumps(payload, separators=(",", ":")).encode("utf-8")
+            self.send_response(status.value)
+            self.send_header("Content-Type", "application/json")
+            self.send_header("Content-Length", str(len(encoded)))
+            for name, value in (extra_headers or {}).items():
+                self.send_header(name, value)
+            self.end_headers()
+            self.wfile.write(encoded)
+
+    return TelegramSimHandler
+
+
+def create_server(
+    host: str,
+    port: int,
+    sim: TelegramSim,
+    tls_cert: str | None = None,
+    tls_key: str | None = None,
+) -> ThreadingHTTPServer:
+    server = ThreadingHTTPServer((host, port), make_handler(sim))
+    server.daemon_threads = True
+    if tls_cert:
+        context = ssl.SSLContext(ssl.PROTOCOL_TLS_SERVER)
+        context.load_cert_chain(tls_cert, tls_key)
+        server.socket = context.wrap_socket(server.socket, server_side=True)
+    return server
+
+
+def run_traffic(sim: TelegramSim, pattern: TrafficPattern, stop: threading.Event, total: int, seed: int | None) -> None:
+    rng = random.Random(seed)
+    sent = 0
+    while not stop.is_set() and (total <= 0 or sent < total):
+        wait_s, count = pattern.next_batch(rng)
+        if count <= 0 or stop.wait(wait_s):
+            return
+        for _ in range(count):
+            if total > 0 and sent >= total:
+                return
+            sim.inject()
+            sent += 1
+
+
+def post_webhook(url: str, secret: str, update: dict[str, Any]) -> tuple[int, float]:
+    """POST one update like Telegram does. Returns (status, retry_after_s); status 0 on network errors."""
+    req = urllib.request.Request(
+        url,
+        data=json.dumps(update, separators=(",", ":")).encode("utf-8"),
+        headers={"Content-Type": "application/json", WEBHOOK_SECRET_HEADER: secret},
+        method="POST",
+    )
+    try:
+        with urllib.request.urlopen(req, timeout=WEBHOOK_TIMEOUT_S) as resp:
+            resp.read()
+            return resp.status, 0.0
+    except urllib.error.HTTPError as exc:
+        try:
+            retry_after = float(exc.headers.get("Retry-After", "0"))
+        except ValueError:
+            retry_after = 0.0
+        return exc.code, retry_after
+    except (urllib.error.URLError, OSError):
+        return 0, 0.0
+
+
+def run_webhook(sim: TelegramSim, url: str, secret: str, stop: threading.Event, retry_s: float = 1.0) -> None:
+    """Push updates in order; an update is retried until the device accepts it."""
+    while not stop.is_set():
+        msg = sim.next_webhook_update(0.5)
+        if msg is None:
+            continue
+        status, retry_after = post_webhook(url, secret, sim.update_json(msg))
+        if 200 <= status < 300:
+            sim.confirm_webhook(msg)
+            continue
+        sim.count("webhook_errors")
+        logging.debug("Webhook POST for update %d failed with status %d", msg.update_id, status)
+        stop.wait(max(retry_s, retry_after))
+
+
+def print_report(report: dict[str, Any]) -> None:
+    def line(label: str, stats: dict[str, float]) -> str:
+        if not stats.get("n"):
+            return f"  {label}: n=0"
+        return (
+            f"  {label}: n={stats['n']} min={stats['min']:.1f}ms p50={stats['p50']:.1f}ms "
+            f"p90={stats['p90']:.1f}ms p99={stats['p99']:.1f}ms max={stats['max']:.1f}ms"
+        )
+
+    counters = report["counters"]
+    print("\nTelegram simulator summary")
+    print("  " + " ".join(f"{k}={v}" for k, v in counters.items()))
+    print(line("Delivery (inject -> getUpdates/webhook)", report["delivery_ms"]))
+    print(line("Reply (inject -> sendMessage)", report["reply_ms"]))
+    backlog = report["backlog"]
+    if backlog["messages"]:
+        rate = f" in {backlog['drain_ms']:.1f}ms ({backlog['msgs_per_s']:.1f} msgs/s)" if "drain_ms" in backlog else ""
+        print(
+            f"  Backlog: {backlog['delivered']}/{backlog['messages']} delivered "
+            f"over {backlog['polls']} polls{rate}"
+        )
+    print(f"  Undelivered={report['undelivered']} unanswered={report['unanswered']}")
+    for chat_id, chat in report["per_chat"].items():
+        print(f"  chat {chat_id}: injected={chat['injected']} replied={chat['replied']}")
+
+
+def parse_args(argv: list[str] | None = None) -> argparse.Namespace:
+    parser = argparse.ArgumentParser(description="zclaw local Telegram Bot API simulator")
+    parser.add_argument("--host", default="127.0.0.1", help="Listen host (default: 127.0.0.1)")
+    parser.add_argument("--port", type=int, default=8081, help="Listen port (default: 8081)")
+    parser.add_argument("--token", default="123456:sim", help="Bot token accepted in /bot<token>/ paths")
+    parser.add_argument("--chats", type=int, default=1, help="Number of simulated chats (default: 1)")
+    parser.add_argument("--chat-id-base", type=int, default=100000001, help="First simulated chat ID")
+    parser.add_argument(
+        "--pattern",
+        default="none",
+        help="Inbound traffic: none, steady:RATE, poisson:RATE, burst:N,PERIOD_S (default: none)",
+    )
+    parser.add_argument("--messages", type=int, default=0, help="Stop generating after N messages (0 = unlimited)")
+    parser.add_argument("--message-size", type=int, default=0, help="Pad generated messages to N characters")
+    parser.add_argument(
+        "--backlog",
+        type=int,
+        default=0,
+        help="Queue N messages before the first poll and report the drain rate",
+    )
+    parser.add_argument("--send-429-rate", type=float, default=0.0, help="Probability of 429 on sendMessage")
+    parser.add_argument("--retry-after", type=int, default=3, help="retry_after seconds on 429 (default: 3)")
+    parser.add_argument(
+        "--send-latency",
+        default="fixed:0",
+        help="sendMessage latency distribution, same syntax as mock_provider.py --latency",
+    )
+    parser.add_argument("--poll-error-rate", type=float, default=0.0, help="Probability of 502 on getUpdates")
+    parser.add_argument("--webhook-url", default=None, help="Push updates to this device URL instead of serving getUpdates")
+    parser.add_argument("--webhook-secret", default=None, help="secret_token sent with every webhook POST")
+    parser.add_argument("--webhook-retry", type=float, default=1.0, help="Seconds between webhook retries (default: 1)")
+    parser.add_argument("--tls-cert", default=None, help="Serve HTTPS with this certificate (PEM)")
+    parser.add_argument("--tls-key", default=None, help="Private key for --tls-cert (PEM)")
+    parser.add_argument("--report", default=None, help="Write the final JSON report to this path")
+    parser.add_argument("--seed", type=int, default=None, help="RNG seed for reproducible runs")
+    parser.add_argument("--debug", action="store_true", help="Log every request")
+    args = parser.parse_args(argv)
+
+    if args.chats < 1:
+        parser.error("--chats must be >= 1")
+    if args.backlog < 0:
+        parser.error("--backlog must be >= 0")
+    for name in ("send_429_rate", "poll_error_rate"):
+        if not 0.0 <= getattr(args, name) <= 1.0:
+            parser.error(f"--{name.replace('_', '-')} must be between 0 and 1")
+    if bool(args.webhook_url) != bool(args.webhook_secret):
+        parser.error("--webhook-url and --webhook-secret go together")
+    if args.tls_key and not args.tls_cert:
+        parser.error("--tls-key requires --tls-cert")
+    try:
+        args.traffic = parse_pattern_spec(args.pattern)
+        args.send_latency_model = parse_latency_spec(args.send_latency)
+    except ValueError as exc:
+        parser.error(str(exc))
+    return args
+
+
+def main(argv: list[str] | None = None) -> int:
+    args = parse_args(argv)
+    logging.basicConfig(
+        level=logging.DEBUG if args.debug else logging.INFO,
+        format="%(asctime)s %(levelname)s %(message)s",
+    )
+
+    chat_ids = [args.chat_id_base + i for i in range(args.chats)]
+    sim = TelegramSim(
+        token=args.token,
+        chat_ids=chat_ids,
+        faults=SimFaults(
+            send_429_rate=args.send_429_rate,
+            retry_after_s=args.retry_after,
+            send_latency=args.send_latency_model,
+            poll_error_rate=args.poll_error_rate,
+        ),
+        seed=args.seed,
+        message_size=args.message_size,
+    )
+    try:
+        server = create_server(args.host, args.port, sim, args.tls_cert, args.tls_key)
+    except (OSError, ssl.SSLError) as exc:
+        logging.error("Failed to start server: %s", exc)
+        return 1
+
+    if args.backlog:
+        sim.preload_backlog(args.backlog)
+    sim.webhook_active = bool(args.webhook_url)
+
+    scheme = "https" if args.tls_cert else "http"
+    logging.info("Telegram simulator listening on %s://%s:%d", scheme, args.host, server.server_address[1])
+    logging.info("  Firmware base URL: %s://%s:%d/bot", scheme, args.host, server.server_address[1])
+    logging.info("  Chats: %s", ", ".join(str(c) for c in chat_ids))
+
+    stop = threading.Event()
+    traffic = threading.Thread(
+        target=run_traffic, args=(sim, args.traffic, stop, args.messages, args.seed), daemon=True
+    )
+    traffic.start()
+    if args.webhook_url:
+        logging.info("  Pushing updates to %s", args.webhook_url)
+        threading.Thread(
+            target=run_webhook, args=(sim, args.webhook_url, args.webhook_secret, stop, args.webhook_retry), daemon=True
+        ).start()
+
+    try:
+        server.serve_forever()
+    except KeyboardInterrupt:
+        logging.info("Interrupted, shutting down.")
+    finally:
+        stop.set()
+        server.server_close()
+
+    report = sim.report()
+    print_report(report)
+    if args.report:
+        with open(args.report, "w", encoding="utf-8") as handle:
+            json.dump(report, handle, indent=2)
+    return 0
+
+
+if __name__ == "__main__":
+    raise SystemExit(main())
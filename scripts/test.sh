@@ -10,16 +10,8 @@ cd "$PROJECT_DIR"
 
 TEST_TYPE="${1:-all}"
 
-run_host_tests() {
-    echo "=== Running host tests ==="
-    cd "$PROJECT_DIR/test/host"
-
-    # Compile and run host tests
-    if [ ! -d "build" ]; then
-        mkdir build
-    fi
-
-    # Find cJSON include/lib paths
+# Find cJSON include/lib paths
+find_cjson() {
     CJSON_CFLAGS=""
     CJSON_LDFLAGS="-lcjson"
 
@@ -31,6 +23,18 @@ run_host_tests() {
         CJSON_CFLAGS="-I/usr/local/include"
         CJSON_LDFLAGS="-L/usr/local/lib -lcjson"
     fi
+}
+
+run_host_tests() {
+    echo "=== Running host tests ==="
+    cd "$PROJECT_DIR/test/host"
+
+    # Compile and run host tests
+    if [ ! -d "build" ]; then
+        mkdir build
+    fi
+
+    find_cjson
 
     # AddressSanitizer flags for memory error detection (enabled by default).
     SANITIZE_FLAGS=""
@@ -55,11 +59,31 @@ run_host_tests() {
         test_json_util_integration.c \
         test_runtime_utils.c \
         test_memory_keys.c \
+        test_quick_actions.c \
+        test_telegram_outbox.c \
         test_telegram_update.c \
         test_agent.c \
         test_tools_gpio_policy.c \
         test_llm_auth.c \
         test_tools_media.c \
+        test_camera_budget.c \
+        test_motion_detect.c \
+        test_thumb_ring.c \
+        test_adpcm.c \
+        test_vad.c \
+        test_audio_stats.c \
+        test_pcm_ring.c \
+        test_cron_sched.c \
+        test_cron_expr.c \
+        test_cron_cond.c \
+        test_nvs_wb.c \
+        test_mem_cache.c \
+        test_zc_store.c \
+        test_embed_index.c \
+        test_token_bucket.c \
+        test_chat_queue.c \
+        test_chat_context.c \
+        flash_emu.c \
         test_runner.c \
         mock_esp.c \
         mock_llm.c \
@@ -67,18 +91,39 @@ run_host_tests() {
         mock_freertos.c \
         mock_tools.c \
         mock_ratelimit.c \
+        mock_recall.c \
         ../../main/json_util.c \
         ../../main/cron_utils.c \
+        ../../main/cron_sched.c \
+        ../../main/cron_expr.c \
+        ../../main/cron_cond.c \
+        ../../main/nvs_wb.c \
+        ../../main/mem_cache.c \
+        ../../main/zc_store.c \
+        ../../main/embed_index.c \
+        ../../main/token_bucket.c \
         ../../main/security.c \
         ../../main/text_buffer.c \
         ../../main/boot_guard.c \
         ../../main/memory_keys.c \
         ../../main/llm_auth.c \
+        ../../main/quick_actions_util.c \
+        ../../main/telegram_outbox.c \
         ../../main/telegram_update.c \
+        ../../main/chat_queue.c \
+        ../../main/chat_context.c \
         ../../main/agent.c \
         ../../main/tools_gpio.c \
         ../../main/tools_media.c \
-        $CJSON_LDFLAGS 2>&1 || {
+        ../../main/camera_budget.c \
+        ../../main/motion_detect.c \
+        ../../main/thumb_ring.c \
+        ../../main/adpcm.c \
+        ../../main/transcribe_util.c \
+        ../../main/vad.c \
+        ../../main/audio_stats.c \
+        ../../main/pcm_ring.c \
+        $CJSON_LDFLAGS -lm 2>&1 || {
         echo "Note: Failed to compile tests. Install cJSON:"
         echo "  macOS:  brew install cjson"
         echo "  Ubuntu: apt install libcjson-dev"
@@ -92,7 +137,72 @@ run_host_tests() {
         test_qemu_live_llm_bridge.py \
         test_web_relay.py \
         test_install_provision_scripts.py \
-        test_api_provider_harness.py
+        test_api_provider_harness.py \
+        test_mock_provider.py \
+        test_telegram_sim.py
+    echo ""
+}
+
+run_host_benchmarks() {
+    echo "=== Running host benchmarks ==="
+    cd "$PROJECT_DIR/test/host"
+
+    if [ ! -d "build" ]; then
+        mkdir build
+    fi
+
+    find_cjson
+
+    # Optimized, unsanitized builds so timings reflect the code under test.
+    gcc -o build/bench_memory -O2 \
+        -std=c99 \
+        -Wall -Wextra -Werror -Wshadow -Wformat=2 \
+        -I../../main \
+        -I. \
+        -DTEST_BUILD \
+        bench_memory.c \
+        ../../main/mem_cache.c
+
+    gcc -o build/bench_zc_store -O2 \
+        -std=c99 \
+        -Wall -Wextra -Werror -Wshadow -Wformat=2 \
+        -I../../main \
+        -I. \
+        -DTEST_BUILD \
+        bench_zc_store.c \
+        flash_emu.c \
+        ../../main/zc_store.c
+
+    gcc -o build/bench_embed_index -O2 \
+        -std=c99 \
+        -Wall -Wextra -Werror -Wshadow -Wformat=2 \
+        -I../../main \
+        -I. \
+        -DTEST_BUILD \
+        bench_embed_index.c \
+        ../../main/embed_index.c \
+        -lm
+
+    gcc -o build/bench_base64 -O2 \
+        -std=c99 \
+        -Wall -Wextra -Werror -Wshadow -Wformat=2 \
+        -I../../main \
+        -I. \
+        $CJSON_CFLAGS \
+        -DTEST_BUILD \
+        bench_base64.c \
+        mock_esp.c \
+        ../../main/tools_media.c \
+        $CJSON_LDFLAGS
+
+    ./build/bench_memory "$@"
+    echo ""
+    ./build/bench_zc_store "$@" | grep -v '^\[I\]'
+    echo ""
+    ./build/bench_embed_index "$@"
+    echo ""
+    ./build/bench_base64 "$@"
+
     echo ""
 }
 
@@ -135,6 +245,10 @@ case "$TEST_TYPE" in
     device)
         run_device_tests
         ;;
+    bench)
+        shift
+        run_host_benchmarks "$@"
+        ;;
     all)
         run_host_tests
         # Device tests require hardware, just build them
@@ -142,9 +256,10 @@ case "$TEST_TYPE" in
         run_device_tests
         ;;
     *)
-        echo "Usage: $0 [host|device|all]"
+        echo "Usage: $0 [host|device|bench|all]"
         echo "  host   - Run host-based unit tests (no hardware needed)"
         echo "  device - Build device tests (requires flashing)"
+        echo "  bench  - Run host benchmarks (extra args go to the benchmark)"
         echo "  all    - Run host tests and build device tests"
         exit 1
         ;;
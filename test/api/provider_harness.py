@@ -65,7 +65,7 @@ TOOLS = [
         "input_schema": {
             "type": "object",
             "properties": {
-                "key": {"type": "string", "description": "Key (max 15 chars)"},
+                "key": {"type": "string", "description": "Key (u_ prefix, max 64 chars)"},
                 "value": {"type": "string", "description": "Value to store"},
             },
             "required": ["key", "value"],
@@ -100,15 +100,18 @@ TOOLS = [
     },
     {
         "name": "cron_set",
-        "description": "Create a scheduled task. Type 'periodic' runs every N minutes. Type 'daily' runs at a specific time. Type 'once' runs one time after N minutes.",
+        "description": "Create a scheduled task. Type 'periodic' runs every N minutes. Type 'daily' runs at a specific time. Type 'once' runs one time after N minutes. Type 'cron' takes a standard five-field expression. Type 'condition' triggers when an on-device predicate turns true.",
         "input_schema": {
             "type": "object",
             "properties": {
-                "type": {"type": "string", "enum": ["periodic", "daily", "once"]},
+                "type": {"type": "string", "enum": ["periodic", "daily", "once", "cron", "condition"]},
                 "interval_minutes": {"type": "integer", "description": "For periodic: minutes between runs"},
                 "delay_minutes": {"type": "integer", "description": "For once: minutes from now before one-time run"},
                 "hour": {"type": "integer", "description": "For daily: hour 0-23"},
                 "minute": {"type": "integer", "description": "For daily: minute 0-59"},
+                "expression": {"type": "string", "description": "For cron: five-field expression, e.g. '30 7 * * 1-5'"},
+                "condition": {"type": "string", "description": "For condition: predicate such as 'gpio(4)==1 && hour>=18'"},
+                "check_seconds": {"type": "integer", "description": "For condition: evaluation period in seconds"},
                 "action": {"type": "string", "description": "What to do when triggered"},
             },
             "required": ["type", "action"],
@@ -190,7 +193,7 @@ MOCK_RESULTS = {
     "cron_delete": lambda inp: f"Deleted schedule #{inp.get('id')}",
     "get_time": lambda inp: "2026-02-21 14:30:00 UTC",
     "get_version": lambda inp: "zclaw v2.0.4",
-    "get_health": lambda inp: "Health: OK | Heap: 180000 free | Requests: 5/hr, 20/day | Time: synced",
+    "get_health": lambda inp: "Health: OK | Heap: 180000 free | Tokens left: 148000/150000 hr, 980000/1000000 day | Time: synced",
     "create_tool": lambda inp: f"Created tool '{inp.get('name')}': {inp.get('description')}",
     "list_user_tools": lambda inp: "No user tools defined",
     "delete_user_tool": lambda inp: f"Deleted tool '{inp.get('name')}'",
@@ -235,6 +238,15 @@ PROVIDERS = {
 }
 
 
+def resolve_api_url(provider: ProviderConfig) -> str:
+    """Honor ZCLAW_LLM_BASE_URL so the harness can target scripts/mock_provider.py."""
+    base_url = os.environ.get("ZCLAW_LLM_BASE_URL", "").strip()
+    if not base_url:
+        return provider.api_url
+    path = "/v1/messages" if provider.wire_format == "anthropic" else "/v1/chat/completions"
+    return base_url.rstrip("/") + path
+
+
 def _tool_defs_for_provider(provider: ProviderConfig, user_tools: list[dict[str, str]]) -> list[dict[str, Any]]:
     base = copy.deepcopy(TOOLS)
     for ut in user_tools:
@@ -312,7 +324,7 @@ def call_api(
             "tools": tools,
         }
 
-    response = httpx.post(provider.api_url, headers=headers, json=payload, timeout=30)
+    response = httpx.post(resolve_api_url(provider), headers=headers, json=payload, timeout=30)
     response.raise_for_status()
     return response.json()
 
@@ -0,0 +1,104 @@
+/*
+ * Host benchmark for the media base64 encoder: the 12-bit pair table used
+ * for photo and audio payloads against the byte-at-a-time table lookup it
+ * replaced, on JPEG-sized and audio-sized buffers.
+ *
+ * Usage: ./scripts/test.sh bench [--base64-rounds N]
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "tools_media.h"
+
+static long now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000L + ts.tv_nsec;
+}
+
+// The previous encoder: one table load and one byte store per character.
+static size_t encode_bytewise(const uint8_t *data, size_t data_len, char *out)
+{
+    static const char table[] =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    size_t i = 0;
+    size_t j = 0;
+
+    while (i + 2 < data_len) {
+        uint32_t triple = ((uint32_t)data[i] << 16) |
+                          ((uint32_t)data[i + 1] << 8) |
+                          (uint32_t)data[i + 2];
+        out[j++] = table[(triple >> 18) & 0x3F];
+        out[j++] = table[(triple >> 12) & 0x3F];
+        out[j++] = table[(triple >> 6) & 0x3F];
+        out[j++] = table[triple & 0x3F];
+        i += 3;
+    }
+    out[j] = '\0';
+    return j;
+}
+
+static void bench_size(const char *name, size_t size, int rounds)
+{
+    uint8_t *data = malloc(size);
+    char *out = malloc(4 * (size / 3 + 1) + 1);
+    unsigned seed = 7;
+    volatile size_t sink = 0;
+
+    if (!data || !out) {
+        printf("%s: out of memory\n", name);
+        free(data);
+        free(out);
+        return;
+    }
+    for (size_t i = 0; i < size; i++) {
+        seed = seed * 1103515245U + 12345U;
+        data[i] = (uint8_t)(seed >> 16);
+    }
+
+    long started = now_ns();
+    for (int r = 0; r < rounds; r++) {
+        sink += encode_bytewise(data, size, out);
+    }
+    double bytewise_s = (double)(now_ns() - started) / 1e9;
+
+    started = now_ns();
+    for (int r = 0; r < rounds; r++) {
+        size_t out_len = 0;
+        char *b64 = media_test_base64_encode(data, size, &out_len);
+        sink += out_len;
+        free(b64);
+    }
+    double pairs_s = (double)(now_ns() - started) / 1e9;
+
+    double mb = (double)size * rounds / (1024.0 * 1024.0);
+    printf("%-14s %7u bytes  bytewise %7.1f MB/s  pair table %7.1f MB/s  (%.2fx)\n",
+           name, (unsigned)size, mb / bytewise_s, mb / pairs_s, bytewise_s / pairs_s);
+    (void)sink;
+    free(data);
+    free(out);
+}
+
+int main(int argc, char **argv)
+{
+    int rounds = 400;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--base64-rounds") == 0 && i + 1 < argc) {
+            rounds = atoi(argv[++i]);
+        }
+        // Anything else belongs to another benchmark on the same command line.
+    }
+
+    printf("Base64 encode, %d rounds (pair table includes malloc/free):\n", rounds);
+    bench_size("jpeg (VGA)", 48 * 1024, rounds);
+    bench_size("audio (10 s)", 320 * 1024, rounds / 4 > 0 ? rounds / 4 : 1);
+    return 0;
+}
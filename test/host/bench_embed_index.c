@@ -0,0 +1,150 @@
+/*
+ * Host benchmark for memory recall retrieval: top-k search over a full
+ * int8 embedding index against the float32 brute force it replaces, plus the
+ * per-query quantization cost. The embeddings HTTP round trip is not modeled.
+ *
+ * Usage: ./scripts/test.sh bench [--queries N]
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "config.h"
+#include "embed_index.h"
+
+static unsigned s_seed = 99;
+
+static long now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000L + ts.tv_nsec;
+}
+
+static float next_float(void)
+{
+    s_seed = s_seed * 1103515245U + 12345U;
+    return (float)((s_seed >> 8) & 0xFFFF) / 32768.0f - 1.0f;
+}
+
+static void random_unit_vector(float *out)
+{
+    float norm = 0.0f;
+    for (size_t i = 0; i < EMBED_DIM; i++) {
+        out[i] = next_float();
+        norm += out[i] * out[i];
+    }
+    norm = sqrtf(norm);
+    for (size_t i = 0; i < EMBED_DIM; i++) {
+        out[i] /= norm;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    int queries = 20000;
+    static float vectors[EMBED_INDEX_MAX_ENTRIES][EMBED_DIM];
+    static float query_floats[64][EMBED_DIM];
+    embed_match_t matches[RECALL_TOP_K];
+    char key[24];
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--queries") == 0 && i + 1 < argc) {
+            queries = atoi(argv[++i]);
+        }
+        // Anything else belongs to another benchmark on the same command line.
+    }
+    if (queries <= 0) {
+        queries = 1;
+    }
+
+    if (!embed_index_init(NULL)) {
+        return 1;
+    }
+    for (int i = 0; i < EMBED_INDEX_MAX_ENTRIES; i++) {
+        int8_t q[EMBED_DIM];
+        float scale;
+        random_unit_vector(vectors[i]);
+        embed_quantize(vectors[i], q, &scale);
+        snprintf(key, sizeof(key), "u_mem_%d", i);
+        embed_index_put(key, (uint32_t)i, q, scale);
+    }
+    for (int i = 0; i < 64; i++) {
+        random_unit_vector(query_floats[i]);
+    }
+
+    // Float32 brute force: cosine over unit vectors, best match only.
+    volatile float sink = 0.0f;
+    long start = now_ns();
+    for (int n = 0; n < queries; n++) {
+        const float *query = query_floats[n % 64];
+        float best = -2.0f;
+        for (int i = 0; i < EMBED_INDEX_MAX_ENTRIES; i++) {
+            float dot = 0.0f;
+            for (size_t d = 0; d < EMBED_DIM; d++) {
+                dot += query[d] * vectors[i][d];
+            }
+            if (dot > best) {
+                best = dot;
+            }
+        }
+        sink += best;
+    }
+    double float_ns = (double)(now_ns() - start) / queries;
+
+    // Quantized path as recall runs it: quantize the query, then top-k.
+    int8_t query_q[EMBED_DIM];
+    float query_scale;
+    volatile size_t found = 0;
+    int agree = 0;
+    start = now_ns();
+    for (int n = 0; n < queries; n++) {
+        embed_quantize(query_floats[n % 64], query_q, &query_scale);
+        found += embed_index_search(query_q, query_scale, -1.0f, matches, RECALL_TOP_K);
+    }
+    double int8_ns = (double)(now_ns() - start) / queries;
+
+    start = now_ns();
+    for (int n = 0; n < queries; n++) {
+        embed_quantize(query_floats[n % 64], query_q, &query_scale);
+    }
+    double quantize_ns = (double)(now_ns() - start) / queries;
+
+    // Top-1 agreement between int8 and float32 rankings.
+    for (int n = 0; n < 64; n++) {
+        int best_i = 0;
+        float best = -2.0f;
+        for (int i = 0; i < EMBED_INDEX_MAX_ENTRIES; i++) {
+            float dot = 0.0f;
+            for (size_t d = 0; d < EMBED_DIM; d++) {
+                dot += query_floats[n][d] * vectors[i][d];
+            }
+            if (dot > best) {
+                best = dot;
+                best_i = i;
+            }
+        }
+        embed_quantize(query_floats[n], query_q, &query_scale);
+        embed_index_search(query_q, query_scale, -1.0f, matches, 1);
+        snprintf(key, sizeof(key), "u_mem_%d", best_i);
+        agree += strcmp(matches[0].key, key) == 0;
+    }
+
+    printf("Recall retrieval benchmark (%d queries, %d memories x %d dims, top %d)\n",
+           queries, EMBED_INDEX_MAX_ENTRIES, EMBED_DIM, RECALL_TOP_K);
+    printf("  float32 brute force  %10.0f ns/query (%u KB vectors)\n", float_ns,
+           (unsigned)(sizeof(vectors) / 1024));
+    printf("  int8 quantize+top-k  %10.0f ns/query (%u KB vectors, %.1fx)\n", int8_ns,
+           (unsigned)((size_t)EMBED_INDEX_MAX_ENTRIES * EMBED_DIM / 1024),
+           int8_ns > 0 ? float_ns / int8_ns : 0.0);
+    printf("  query quantize       %10.0f ns\n", quantize_ns);
+    printf("  top-1 agreement      %d/64\n", agree);
+
+    embed_index_deinit();
+    return 0;
+}
@@ -0,0 +1,301 @@
+/*
+ * Host benchmark for the memory layer's RAM cache and persistent handles.
+ *
+ * NVS itself is not available on the host, so a simulated store charges a
+ * modeled cost per open/close/read/write/iterator step (roughly what an
+ * ESP32-S3 spends per NVS call; --encrypted adds the per-read decrypt cost).
+ * Each operation runs the same workload twice: the old path (nvs_open and
+ * nvs_close around every access, iterator per list) and the cached path
+ * (one open handle, mem_cache lookups, key index for list).
+ *
+ * Usage: ./scripts/test.sh bench [--iterations N] [--encrypted] [--no-cost]
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "config.h"
+#include "mem_cache.h"
+
+#define SIM_MAX_KEYS 48
+
+typedef struct {
+    long open_ns;
+    long close_ns;
+    long read_ns;
+    long write_ns;          // set + commit
+    long iter_step_ns;
+} sim_cost_t;
+
+typedef struct {
+    char key[MEM_CACHE_KEY_LEN];
+    char value[64];
+    bool used;
+} sim_entry_t;
+
+static sim_entry_t s_store[SIM_MAX_KEYS];
+static sim_cost_t s_cost = { 30000, 5000, 20000, 2000000, 8000 };
+
+static const char *s_hot_keys[] = {
+    "llm_backend", "llm_model", "llm_api_url", "tg_api_url", "tg_chat_ids",
+    "boot_count", "rl_daily", "persona", "u_missing", "tz_missing",
+};
+#define HOT_KEY_COUNT (sizeof(s_hot_keys) / sizeof(s_hot_keys[0]))
+
+static long now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000L + ts.tv_nsec;
+}
+
+static void charge(long ns)
+{
+    if (ns <= 0) {
+        return;
+    }
+    long until = now_ns() + ns;
+    while (now_ns() < until) {
+    }
+}
+
+static sim_entry_t *sim_find(const char *key)
+{
+    for (int i = 0; i < SIM_MAX_KEYS; i++) {
+        if (s_store[i].used && strcmp(s_store[i].key, key) == 0) {
+            return &s_store[i];
+        }
+    }
+    return NULL;
+}
+
+static void sim_open(void) { charge(s_cost.open_ns); }
+static void sim_close(void) { charge(s_cost.close_ns); }
+
+static bool sim_get(const char *key, char *buf, size_t len)
+{
+    charge(s_cost.read_ns);
+    sim_entry_t *entry = sim_find(key);
+    if (!entry || strlen(entry->value) + 1 > len) {
+        return false;
+    }
+    memcpy(buf, entry->value, strlen(entry->value) + 1);
+    return true;
+}
+
+static void sim_set(const char *key, const char *value)
+{
+    charge(s_cost.write_ns);
+    sim_entry_t *entry = sim_find(key);
+    for (int i = 0; i < SIM_MAX_KEYS && !entry; i++) {
+        if (!s_store[i].used) {
+            entry = &s_store[i];
+            entry->used = true;
+            snprintf(entry->key, sizeof(entry->key), "%s", key);
+        }
+    }
+    if (entry) {
+        snprintf(entry->value, sizeof(entry->value), "%s", value);
+    }
+}
+
+static size_t sim_list(void)
+{
+    size_t count = 0;
+    for (int i = 0; i < SIM_MAX_KEYS; i++) {
+        if (s_store[i].used) {
+            charge(s_cost.iter_step_ns);
+            count++;
+        }
+    }
+    return count;
+}
+
+static void sim_reset(void)
+{
+    char key[MEM_CACHE_KEY_LEN];
+
+    memset(s_store, 0, sizeof(s_store));
+    for (size_t i = 0; i < HOT_KEY_COUNT - 2; i++) {
+        sim_set(s_hot_keys[i], "configured-value");
+    }
+    for (int i = 0; i < 20; i++) {
+        snprintf(key, sizeof(key), "u_note_%d", i);
+        sim_set(key, "user value");
+    }
+}
+
+// --- Old path: open/close around every access ---
+
+static bool get_uncached(const char *key, char *buf, size_t len)
+{
+    sim_open();
+    bool found = sim_get(key, buf, len);
+    sim_close();
+    return found;
+}
+
+static void set_uncached(const char *key, const char *value)
+{
+    sim_open();
+    sim_set(key, value);
+    sim_close();
+}
+
+static size_t list_uncached(void)
+{
+    sim_open();
+    size_t count = sim_list();
+    sim_close();
+    return count;
+}
+
+// --- Cached path: persistent handle + mem_cache ---
+
+static bool get_cached(const char *key, char *buf, size_t len)
+{
+    switch (mem_cache_get(key, buf, len)) {
+        case MEM_CACHE_HIT:
+            return true;
+        case MEM_CACHE_ABSENT:
+        case MEM_CACHE_TOO_SMALL:
+            return false;
+        case MEM_CACHE_MISS:
+        default:
+            break;
+    }
+    bool found = sim_get(key, buf, len);
+    mem_cache_put(key, found ? buf : NULL);
+    return found;
+}
+
+static void set_cached(const char *key, const char *value)
+{
+    sim_set(key, value);
+    mem_cache_put(key, value);
+    mem_cache_index_add(key);
+}
+
+static bool count_key(const char *key, void *ctx)
+{
+    (void)key;
+    (*(size_t *)ctx)++;
+    return true;
+}
+
+static size_t list_cached(void)
+{
+    size_t count = 0;
+    if (!mem_cache_index_is_complete()) {
+        mem_cache_index_begin();
+        for (int i = 0; i < SIM_MAX_KEYS; i++) {
+            if (s_store[i].used) {
+                charge(s_cost.iter_step_ns);
+                mem_cache_index_add(s_store[i].key);
+            }
+        }
+        mem_cache_index_complete();
+    }
+    mem_cache_index_visit(count_key, &count);
+    return count;
+}
+
+typedef struct {
+    const char *name;
+    double uncached_ns;
+    double cached_ns;
+} bench_row_t;
+
+static double bench_get(bool cached, int iterations)
+{
+    char buf[64];
+    volatile int found = 0;
+    long start = now_ns();
+    for (int i = 0; i < iterations; i++) {
+        const char *key = s_hot_keys[i % HOT_KEY_COUNT];
+        found += cached ? get_cached(key, buf, sizeof(buf)) : get_uncached(key, buf, sizeof(buf));
+    }
+    return (double)(now_ns() - start) / iterations;
+}
+
+static double bench_set(bool cached, int iterations)
+{
+    char value[16];
+    long start = now_ns();
+    for (int i = 0; i < iterations; i++) {
+        snprintf(value, sizeof(value), "%d", i);
+        if (cached) {
+            set_cached("rl_daily", value);
+        } else {
+            set_uncached("rl_daily", value);
+        }
+    }
+    return (double)(now_ns() - start) / iterations;
+}
+
+static double bench_list(bool cached, int iterations)
+{
+    volatile size_t total = 0;
+    long start = now_ns();
+    for (int i = 0; i < iterations; i++) {
+        total += cached ? list_cached() : list_uncached();
+    }
+    return (double)(now_ns() - start) / iterations;
+}
+
+int main(int argc, char **argv)
+{
+    int iterations = 2000;
+    bench_row_t rows[3];
+    mem_cache_stats_t stats;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) {
+            iterations = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--encrypted") == 0) {
+            s_cost.read_ns += 15000;
+            s_cost.iter_step_ns += 6000;
+        } else if (strcmp(argv[i], "--no-cost") == 0) {
+            memset(&s_cost, 0, sizeof(s_cost));
+        }
+        // Anything else belongs to another benchmark on the same command line.
+    }
+    if (iterations <= 0) {
+        iterations = 1;
+    }
+
+    sim_reset();
+    mem_cache_init(NULL, MEM_CACHE_MAX_BYTES);
+    rows[0].name = "get";
+    rows[0].uncached_ns = bench_get(false, iterations);
+    rows[0].cached_ns = bench_get(true, iterations);
+
+    // Writes dominate in flash; keep the loop short.
+    int set_iterations = iterations / 20 > 0 ? iterations / 20 : 1;
+    rows[1].name = "set";
+    rows[1].uncached_ns = bench_set(false, set_iterations);
+    rows[1].cached_ns = bench_set(true, set_iterations);
+
+    rows[2].name = "list";
+    rows[2].uncached_ns = bench_list(false, iterations / 10 > 0 ? iterations / 10 : 1);
+    rows[2].cached_ns = bench_list(true, iterations / 10 > 0 ? iterations / 10 : 1);
+
+    mem_cache_get_stats(&stats);
+
+    printf("Memory layer benchmark (%d iterations, modeled open=%ldus read=%ldus)\n",
+           iterations, s_cost.open_ns / 1000, s_cost.read_ns / 1000);
+    printf("  %-6s %14s %14s %9s\n", "op", "uncached ns", "cached ns", "speedup");
+    for (size_t i = 0; i < sizeof(rows) / sizeof(rows[0]); i++) {
+        double speedup = rows[i].cached_ns > 0 ? rows[i].uncached_ns / rows[i].cached_ns : 0.0;
+        printf("  %-6s %14.0f %14.0f %8.1fx\n", rows[i].name, rows[i].uncached_ns,
+               rows[i].cached_ns, speedup);
+    }
+    printf("  cache: %u hits, %u absent hits, %u misses, %u evictions, %u bytes\n",
+           (unsigned)stats.hits, (unsigned)stats.absent_hits, (unsigned)stats.misses,
+           (unsigned)stats.evictions, (unsigned)stats.bytes);
+    return 0;
+}
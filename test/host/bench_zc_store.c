@@ -0,0 +1,155 @@
+/*
+ * Host benchmark for the log-structured user memory store on the file-backed
+ * flash emulation. Reports per-operation latency against the emulated image
+ * plus flash-level costs: write amplification, erases and sector wear.
+ *
+ * Usage: ./scripts/test.sh bench [--ops N] [--keys N] [--value-bytes N]
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "config.h"
+#include "flash_emu.h"
+#include "zc_store.h"
+
+#define IMAGE_PATH "build/bench_zc_store.img"
+#define IMAGE_SIZE 0x40000      // Matches partitions.csv
+
+static long now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000L + ts.tv_nsec;
+}
+
+static bool count_key(const char *key, void *ctx)
+{
+    (void)key;
+    (*(size_t *)ctx)++;
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    int ops = 5000;
+    int keys = 100;
+    int value_bytes = 600;
+    flash_emu_t emu;
+    zc_store_backend_t backend;
+    zc_store_stats_t stats;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--ops") == 0 && i + 1 < argc) {
+            ops = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--keys") == 0 && i + 1 < argc) {
+            keys = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--value-bytes") == 0 && i + 1 < argc) {
+            value_bytes = atoi(argv[++i]);
+        } else {
+            // Flags for the other benchmarks share the command line.
+            continue;
+        }
+    }
+    if (ops <= 0 || keys <= 0 || keys > ZC_STORE_MAX_KEYS ||
+        value_bytes <= 0 || value_bytes > ZC_STORE_MAX_VALUE_LEN) {
+        fprintf(stderr, "Invalid --ops/--keys/--value-bytes\n");
+        return 2;
+    }
+
+    remove(IMAGE_PATH);
+    if (!flash_emu_open(&emu, IMAGE_PATH, IMAGE_SIZE)) {
+        fprintf(stderr, "Cannot create %s\n", IMAGE_PATH);
+        return 1;
+    }
+    flash_emu_backend(&emu, ZC_STORE_SEGMENT_SIZE, &backend);
+    if (zc_store_mount(&backend) != ESP_OK) {
+        flash_emu_close(&emu);
+        return 1;
+    }
+
+    char *value = malloc((size_t)value_bytes + 1);
+    char *out = malloc(ZC_STORE_MAX_VALUE_LEN + 1);
+    if (!value || !out) {
+        return 1;
+    }
+    char key[48];
+    uint64_t user_bytes = 0;
+    unsigned seed = 12345;
+    int failed = 0;
+
+    // Overwrite-heavy workload over a fixed key set with varying sizes.
+    long start = now_ns();
+    for (int i = 0; i < ops; i++) {
+        seed = seed * 1103515245U + 12345U;
+        int k = (int)((seed >> 16) % (unsigned)keys);
+        int len = value_bytes / 2 + (int)((seed >> 8) % (unsigned)(value_bytes / 2 + 1));
+        memset(value, 'a' + (i % 26), (size_t)len);
+        value[len] = '\0';
+        snprintf(key, sizeof(key), "u_benchmark_key_%03d", k);
+        if (zc_store_set(key, value) != ESP_OK) {
+            failed++;
+            continue;
+        }
+        user_bytes += (uint64_t)strlen(key) + (uint64_t)len;
+        if (zc_store_needs_compaction()) {
+            zc_store_compact_step();
+        }
+    }
+    double set_ns = (double)(now_ns() - start) / ops;
+
+    start = now_ns();
+    for (int i = 0; i < ops; i++) {
+        size_t len = ZC_STORE_MAX_VALUE_LEN + 1;
+        snprintf(key, sizeof(key), "u_benchmark_key_%03d", i % keys);
+        zc_store_get(key, out, &len);
+    }
+    double get_ns = (double)(now_ns() - start) / ops;
+
+    int list_rounds = 100;
+    size_t listed = 0;
+    start = now_ns();
+    for (int i = 0; i < list_rounds; i++) {
+        zc_store_list(count_key, &listed);
+    }
+    double list_ns = (double)(now_ns() - start) / list_rounds;
+
+    zc_store_unmount();
+    start = now_ns();
+    zc_store_mount(&backend);
+    double mount_ms = (double)(now_ns() - start) / 1e6;
+
+    zc_store_get_stats(&stats);
+    uint32_t max_wear = 0;
+    for (uint32_t s = 0; s < IMAGE_SIZE / FLASH_EMU_SECTOR_SIZE; s++) {
+        if (emu.sector_erases[s] > max_wear) {
+            max_wear = emu.sector_erases[s];
+        }
+    }
+
+    printf("zc_store benchmark (%d ops, %d keys, %d-%d byte values, %u KB image)\n",
+           ops, keys, value_bytes / 2, value_bytes, (unsigned)(IMAGE_SIZE / 1024));
+    printf("  set   %10.0f ns/op (%d rejected)\n", set_ns, failed);
+    printf("  get   %10.0f ns/op\n", get_ns);
+    printf("  list  %10.0f ns/op (%u keys)\n", list_ns, (unsigned)(listed / (size_t)list_rounds));
+    printf("  mount %10.2f ms\n", mount_ms);
+    printf("  write amplification %.2fx (%llu flash bytes for %llu user bytes)\n",
+           user_bytes ? (double)emu.bytes_written / (double)user_bytes : 0.0,
+           (unsigned long long)emu.bytes_written, (unsigned long long)user_bytes);
+    printf("  compactions %u, copied %u KB, erases %u, max sector wear %u\n",
+           (unsigned)stats.compactions, (unsigned)(stats.bytes_copied / 1024),
+           (unsigned)emu.erases, (unsigned)max_wear);
+    printf("  live %u KB / used %u KB / capacity %u KB\n", (unsigned)(stats.live_bytes / 1024),
+           (unsigned)(stats.used_bytes / 1024), (unsigned)(stats.capacity_bytes / 1024));
+
+    free(value);
+    free(out);
+    zc_store_unmount();
+    flash_emu_close(&emu);
+    remove(IMAGE_PATH);
+    return 0;
+}
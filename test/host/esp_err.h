@@ -14,6 +14,10 @@ static inline const char *esp_err_to_name(esp_err_t err)
             return "ESP_ERR_NO_MEM";
         case ESP_ERR_INVALID_ARG:
             return "ESP_ERR_INVALID_ARG";
+        case ESP_ERR_INVALID_STATE:
+            return "ESP_ERR_INVALID_STATE";
+        case ESP_ERR_INVALID_SIZE:
+            return "ESP_ERR_INVALID_SIZE";
         case ESP_ERR_NOT_FOUND:
             return "ESP_ERR_NOT_FOUND";
         default:
@@ -0,0 +1,166 @@
+/*
+ * File-backed NOR flash emulation (see flash_emu.h).
+ */
+
+#include "flash_emu.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define EMU_CHUNK 256
+
+static bool emu_seek(flash_emu_t *emu, uint32_t offset)
+{
+    return fseek(emu->file, (long)offset, SEEK_SET) == 0;
+}
+
+bool flash_emu_open(flash_emu_t *emu, const char *path, uint32_t size)
+{
+    uint8_t erased[EMU_CHUNK];
+
+    memset(emu, 0, sizeof(*emu));
+    emu->write_budget = -1;
+    if (size == 0 || size % FLASH_EMU_SECTOR_SIZE != 0) {
+        return false;
+    }
+
+    emu->file = fopen(path, "r+b");
+    if (!emu->file) {
+        emu->file = fopen(path, "w+b");
+        if (!emu->file) {
+            return false;
+        }
+        memset(erased, 0xFF, sizeof(erased));
+        for (uint32_t off = 0; off < size; off += EMU_CHUNK) {
+            if (fwrite(erased, 1, EMU_CHUNK, emu->file) != EMU_CHUNK) {
+                fclose(emu->file);
+                emu->file = NULL;
+                return false;
+            }
+        }
+        fflush(emu->file);
+    }
+
+    emu->size = size;
+    emu->sector_erases = calloc(size / FLASH_EMU_SECTOR_SIZE, sizeof(uint32_t));
+    if (!emu->sector_erases) {
+        fclose(emu->file);
+        emu->file = NULL;
+        return false;
+    }
+    return true;
+}
+
+void flash_emu_close(flash_emu_t *emu)
+{
+    if (emu->file) {
+        fclose(emu->file);
+    }
+    free(emu->sector_erases);
+    memset(emu, 0, sizeof(*emu));
+}
+
+void flash_emu_set_write_budget(flash_emu_t *emu, long budget)
+{
+    emu->write_budget = budget;
+}
+
+void flash_emu_power_cycle(flash_emu_t *emu)
+{
+    emu->powered_off = false;
+    emu->write_budget = -1;
+}
+
+static esp_err_t emu_read(uint32_t offset, void *buf, size_t len, void *ctx)
+{
+    flash_emu_t *emu = (flash_emu_t *)ctx;
+    if (emu->powered_off || offset + len > emu->size || !emu_seek(emu, offset)) {
+        return ESP_FAIL;
+    }
+    if (fread(buf, 1, len, emu->file) != len) {
+        return ESP_FAIL;
+    }
+    emu->bytes_read += len;
+    return ESP_OK;
+}
+
+static esp_err_t emu_write(uint32_t offset, const void *buf, size_t len, void *ctx)
+{
+    flash_emu_t *emu = (flash_emu_t *)ctx;
+    const uint8_t *src = (const uint8_t *)buf;
+    uint8_t cell[EMU_CHUNK];
+
+    if (emu->powered_off || offset + len > emu->size) {
+        return ESP_FAIL;
+    }
+
+    size_t allowed = len;
+    if (emu->write_budget >= 0 && (long)len > emu->write_budget) {
+        allowed = (size_t)emu->write_budget;
+    }
+
+    for (size_t done = 0; done < allowed; done += EMU_CHUNK) {
+        size_t n = allowed - done < EMU_CHUNK ? allowed - done : EMU_CHUNK;
+        if (!emu_seek(emu, offset + (uint32_t)done) || fread(cell, 1, n, emu->file) != n) {
+            return ESP_FAIL;
+        }
+        for (size_t i = 0; i < n; i++) {
+            if ((uint8_t)(~cell[i] & src[done + i]) != 0) {
+                emu->bit_set_violations++;
+            }
+            cell[i] &= src[done + i];
+        }
+        if (!emu_seek(emu, offset + (uint32_t)done) || fwrite(cell, 1, n, emu->file) != n) {
+            return ESP_FAIL;
+        }
+    }
+    fflush(emu->file);
+    emu->bytes_written += allowed;
+
+    if (emu->write_budget >= 0) {
+        emu->write_budget -= (long)allowed;
+        if (emu->write_budget == 0) {
+            emu->powered_off = true;
+        }
+    }
+    return allowed < len ? ESP_FAIL : ESP_OK;
+}
+
+static esp_err_t emu_erase(uint32_t offset, size_t len, void *ctx)
+{
+    flash_emu_t *emu = (flash_emu_t *)ctx;
+    uint8_t erased[EMU_CHUNK];
+
+    if (emu->powered_off || offset % FLASH_EMU_SECTOR_SIZE != 0 ||
+        len % FLASH_EMU_SECTOR_SIZE != 0 || offset + len > emu->size) {
+        return ESP_FAIL;
+    }
+
+    memset(erased, 0xFF, sizeof(erased));
+    if (!emu_seek(emu, offset)) {
+        return ESP_FAIL;
+    }
+    for (size_t done = 0; done < len; done += EMU_CHUNK) {
+        if (fwrite(erased, 1, EMU_CHUNK, emu->file) != EMU_CHUNK) {
+            return ESP_FAIL;
+        }
+    }
+    fflush(emu->file);
+    for (size_t s = offset / FLASH_EMU_SECTOR_SIZE;
+         s < (offset + len) / FLASH_EMU_SECTOR_SIZE; s++) {
+        emu->sector_erases[s]++;
+        emu->erases++;
+    }
+    return ESP_OK;
+}
+
+void flash_emu_backend(flash_emu_t *emu, uint32_t segment_size, zc_store_backend_t *backend)
+{
+    memset(backend, 0, sizeof(*backend));
+    backend->read = emu_read;
+    backend->write = emu_write;
+    backend->erase = emu_erase;
+    backend->ctx = emu;
+    backend->size = emu->size;
+    backend->segment_size = segment_size;
+}
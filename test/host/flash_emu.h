@@ -0,0 +1,45 @@
+/*
+ * File-backed NOR flash emulation for host tests and benchmarks.
+ *
+ * Erase sets a 4 KB sector to 0xFF; writes can only clear bits (new data is
+ * ANDed in), matching SPI NOR behavior. A write budget simulates power loss:
+ * once exhausted, the write in progress lands partially and every later
+ * operation fails until flash_emu_power_cycle().
+ */
+
+#ifndef FLASH_EMU_H
+#define FLASH_EMU_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "zc_store.h"
+
+#define FLASH_EMU_SECTOR_SIZE 4096
+
+typedef struct {
+    FILE *file;
+    uint32_t size;
+    bool powered_off;
+    long write_budget;          // Bytes left before power loss; < 0 disables
+    uint64_t bytes_read;
+    uint64_t bytes_written;
+    uint32_t erases;
+    uint32_t bit_set_violations; // Writes that tried to turn 0 bits back to 1
+    uint32_t *sector_erases;     // Per-sector wear counters
+} flash_emu_t;
+
+// Open (or create, filled with 0xFF) a flash image of size bytes at path.
+bool flash_emu_open(flash_emu_t *emu, const char *path, uint32_t size);
+void flash_emu_close(flash_emu_t *emu);
+
+// Power is cut after budget more bytes have been written.
+void flash_emu_set_write_budget(flash_emu_t *emu, long budget);
+void flash_emu_power_cycle(flash_emu_t *emu);
+
+// Fill a zc_store backend that reads and writes this image.
+void flash_emu_backend(flash_emu_t *emu, uint32_t segment_size, zc_store_backend_t *backend);
+
+#endif // FLASH_EMU_H
@@ -4,12 +4,16 @@
 
 static bool s_allow = true;
 static int s_record_count = 0;
+static ratelimit_class_t s_last_class = RATELIMIT_CLASS_INTERACTIVE;
+static uint32_t s_tokens = 0;
 static char s_reason[128] = "Rate limited";
 
 void mock_ratelimit_reset(void)
 {
     s_allow = true;
     s_record_count = 0;
+    s_last_class = RATELIMIT_CLASS_INTERACTIVE;
+    s_tokens = 0;
     strncpy(s_reason, "Rate limited", sizeof(s_reason) - 1);
     s_reason[sizeof(s_reason) - 1] = '\0';
 }
@@ -28,12 +32,23 @@ int mock_ratelimit_record_count(void)
     return s_record_count;
 }
 
+ratelimit_class_t mock_ratelimit_last_class(void)
+{
+    return s_last_class;
+}
+
+uint32_t mock_ratelimit_tokens_recorded(void)
+{
+    return s_tokens;
+}
+
 void ratelimit_init(void)
 {
 }
 
-bool ratelimit_check(char *reason, size_t reason_len)
+bool ratelimit_check(ratelimit_class_t cls, char *reason, size_t reason_len)
 {
+    s_last_class = cls;
     if (s_allow) {
         return true;
     }
@@ -44,21 +59,20 @@ bool ratelimit_check(char *reason, size_t reason_len)
     return false;
 }
 
-void ratelimit_record_request(void)
+void ratelimit_record_usage(ratelimit_class_t cls, uint32_t input_tokens,
+                            uint32_t output_tokens)
 {
     s_record_count++;
+    s_last_class = cls;
+    s_tokens += input_tokens + output_tokens;
 }
 
-int ratelimit_get_requests_today(void)
-{
-    return 0;
-}
-
-int ratelimit_get_requests_this_hour(void)
+void ratelimit_get_status(ratelimit_class_t cls, ratelimit_status_t *status)
 {
-    return 0;
+    (void)cls;
+    memset(status, 0, sizeof(*status));
 }
 
-void ratelimit_reset_daily(void)
+void ratelimit_reset(void)
 {
 }
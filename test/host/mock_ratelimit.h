@@ -1,10 +1,14 @@
 #ifndef MOCK_RATELIMIT_H
 #define MOCK_RATELIMIT_H
 
+#include "ratelimit.h"
 #include <stdbool.h>
+#include <stdint.h>
 
 void mock_ratelimit_reset(void);
 void mock_ratelimit_set_allow(bool allow, const char *reason);
 int mock_ratelimit_record_count(void);
+ratelimit_class_t mock_ratelimit_last_class(void);
+uint32_t mock_ratelimit_tokens_recorded(void);
 
 #endif // MOCK_RATELIMIT_H
@@ -0,0 +1,42 @@
+#include "recall.h"
+#include "mock_recall.h"
+#include <stdio.h>
+#include <string.h>
+
+static char s_context[512] = "";
+static char s_last_message[256] = "";
+static ratelimit_class_t s_last_class = RATELIMIT_CLASS_INTERACTIVE;
+
+void mock_recall_reset(void)
+{
+    s_context[0] = '\0';
+    s_last_message[0] = '\0';
+    s_last_class = RATELIMIT_CLASS_INTERACTIVE;
+}
+
+void mock_recall_set_context(const char *context)
+{
+    snprintf(s_context, sizeof(s_context), "%s", context ? context : "");
+}
+
+const char *mock_recall_last_message(void)
+{
+    return s_last_message;
+}
+
+ratelimit_class_t mock_recall_last_class(void)
+{
+    return s_last_class;
+}
+
+size_t recall_build_context(const char *message, ratelimit_class_t cls, char *out,
+                            size_t out_len)
+{
+    snprintf(s_last_message, sizeof(s_last_message), "%s", message ? message : "");
+    s_last_class = cls;
+    if (!out || out_len == 0) {
+        return 0;
+    }
+    snprintf(out, out_len, "%s", s_context);
+    return strlen(out);
+}
@@ -0,0 +1,11 @@
+#ifndef MOCK_RECALL_H
+#define MOCK_RECALL_H
+
+#include "ratelimit.h"
+
+void mock_recall_reset(void);
+void mock_recall_set_context(const char *context);
+const char *mock_recall_last_message(void);
+ratelimit_class_t mock_recall_last_class(void);
+
+#endif // MOCK_RECALL_H
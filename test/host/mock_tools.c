@@ -4,10 +4,24 @@
 #include <string.h>
 
 static int s_execute_calls = 0;
+static char s_last_name[64];
+static char s_last_input[256];
 
 void mock_tools_reset(void)
 {
     s_execute_calls = 0;
+    s_last_name[0] = '\0';
+    s_last_input[0] = '\0';
+}
+
+const char *mock_tools_last_name(void)
+{
+    return s_last_name;
+}
+
+const char *mock_tools_last_input(void)
+{
+    return s_last_input;
 }
 
 int mock_tools_execute_calls(void)
@@ -29,8 +43,11 @@ const tool_def_t *tools_get_all(int *count)
 
 bool tools_execute(const char *name, const cJSON *input, char *result, size_t result_len)
 {
-    (void)name;
-    (void)input;
+    char *printed = input ? cJSON_PrintUnformatted(input) : NULL;
+
+    snprintf(s_last_name, sizeof(s_last_name), "%s", name ? name : "");
+    snprintf(s_last_input, sizeof(s_last_input), "%s", printed ? printed : "");
+    cJSON_free(printed);
     s_execute_calls++;
     if (result && result_len > 0) {
         snprintf(result, result_len, "mock tool executed");
@@ -3,5 +3,8 @@
 
 void mock_tools_reset(void);
 int mock_tools_execute_calls(void);
+// Name and unformatted JSON input of the last tools_execute call ("" if none).
+const char *mock_tools_last_name(void);
+const char *mock_tools_last_input(void);
 
 #endif // MOCK_TOOLS_H
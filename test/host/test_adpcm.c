@@ -0,0 +1,204 @@
+/*
+ * Host tests for the IMA-ADPCM encoder, its WAV framing, and the multipart
+ * transcription request around it.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "adpcm.h"
+#include "transcribe_util.h"
+
+#define TEST(name) static int test_##name(void)
+#define ASSERT(cond) do { \
+    if (!(cond)) { \
+        printf("  FAIL: %s (line %d)\n", #cond, __LINE__); \
+        return 1; \
+    } \
+} while(0)
+
+static uint32_t read_u32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint16_t read_u16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+// Signal-to-noise ratio of decoded against original, in dB.
+static double snr_db(const int16_t *a, const int16_t *b, size_t n)
+{
+    double signal = 0.0;
+    double noise = 0.0;
+
+    for (size_t i = 0; i < n; i++) {
+        double d = (double)a[i] - (double)b[i];
+        signal += (double)a[i] * a[i];
+        noise += d * d;
+    }
+    return noise == 0.0 ? 200.0 : 10.0 * log10(signal / noise);
+}
+
+TEST(speech_band_round_trip)
+{
+    static int16_t pcm[ADPCM_BLOCK_SAMPLES * 8];
+    static int16_t decoded[ADPCM_BLOCK_SAMPLES * 8];
+    uint8_t block[ADPCM_BLOCK_BYTES];
+    adpcm_state_t state;
+    const size_t n = sizeof(pcm) / sizeof(pcm[0]);
+
+    // Two tones with a slow swell, like a voiced vowel at 16 kHz.
+    for (size_t i = 0; i < n; i++) {
+        double t = (double)i / 16000.0;
+        double env = 0.3 + 0.7 * sin(3.14159 * (double)i / (double)n);
+        pcm[i] = (int16_t)(env * (9000.0 * sin(2 * 3.14159 * 220.0 * t) +
+                                  4000.0 * sin(2 * 3.14159 * 1250.0 * t)));
+    }
+
+    adpcm_init(&state);
+    for (size_t off = 0; off < n; off += ADPCM_BLOCK_SAMPLES) {
+        adpcm_encode_block(&state, pcm + off, ADPCM_BLOCK_SAMPLES, block);
+        ASSERT(read_u16(block) == (uint16_t)pcm[off]);
+        adpcm_decode_block(block, decoded + off);
+        ASSERT(decoded[off] == pcm[off]);
+    }
+    ASSERT(snr_db(pcm, decoded, n) > 20.0);
+    return 0;
+}
+
+TEST(extremes_clamp_and_short_block_pads)
+{
+    int16_t pcm[ADPCM_BLOCK_SAMPLES];
+    int16_t decoded[ADPCM_BLOCK_SAMPLES];
+    uint8_t block[ADPCM_BLOCK_BYTES];
+    adpcm_state_t state;
+
+    // Full-scale square wave: the predictor must saturate, not wrap.
+    for (size_t i = 0; i < ADPCM_BLOCK_SAMPLES; i++) {
+        pcm[i] = (i / 40) % 2 ? 32767 : -32768;
+    }
+    adpcm_init(&state);
+    adpcm_encode_block(&state, pcm, ADPCM_BLOCK_SAMPLES, block);
+    ASSERT(state.index <= 88);
+    adpcm_decode_block(block, decoded);
+    for (size_t i = 39; i < ADPCM_BLOCK_SAMPLES; i += 40) {
+        ASSERT(pcm[i] > 0 ? decoded[i] > 30000 : decoded[i] < -30000);
+    }
+
+    // A 3-sample final block holds its last value to the end.
+    int16_t tail[3] = { 100, 200, 300 };
+    adpcm_init(&state);
+    adpcm_encode_block(&state, tail, 3, block);
+    adpcm_decode_block(block, decoded);
+    ASSERT(decoded[0] == 100);
+    ASSERT(abs(decoded[ADPCM_BLOCK_SAMPLES - 1] - 300) < 20);
+    return 0;
+}
+
+TEST(wav_header_describes_blocks)
+{
+    uint8_t header[ADPCM_WAV_HEADER_BYTES];
+    const uint32_t samples = 16000 * 3;     // 3 s
+
+    ASSERT(adpcm_block_count(0) == 0);
+    ASSERT(adpcm_block_count(1) == 1);
+    ASSERT(adpcm_block_count(ADPCM_BLOCK_SAMPLES) == 1);
+    ASSERT(adpcm_block_count(ADPCM_BLOCK_SAMPLES + 1) == 2);
+
+    ASSERT(adpcm_wav_header(header, 16000, samples) == ADPCM_WAV_HEADER_BYTES);
+    size_t blocks = adpcm_block_count(samples);
+    ASSERT(memcmp(header, "RIFF", 4) == 0 && memcmp(header + 8, "WAVE", 4) == 0);
+    ASSERT(read_u32(header + 4) == adpcm_wav_len(samples) - 8);
+    ASSERT(memcmp(header + 12, "fmt ", 4) == 0 && read_u32(header + 16) == 20);
+    ASSERT(read_u16(header + 20) == 0x0011);
+    ASSERT(read_u16(header + 22) == 1);
+    ASSERT(read_u32(header + 24) == 16000);
+    ASSERT(read_u16(header + 32) == ADPCM_BLOCK_BYTES);
+    ASSERT(read_u16(header + 34) == 4);
+    ASSERT(read_u16(header + 38) == ADPCM_BLOCK_SAMPLES);
+    ASSERT(memcmp(header + 40, "fact", 4) == 0 && read_u32(header + 48) == samples);
+    ASSERT(memcmp(header + 52, "data", 4) == 0);
+    ASSERT(read_u32(header + 56) == blocks * ADPCM_BLOCK_BYTES);
+
+    // A quarter of 16-bit PCM, plus block headers and padding.
+    ASSERT(adpcm_wav_len(samples) < samples * 2 / 4 + samples / 50);
+
+    // Streamed: sizes say "until end of file".
+    ASSERT(adpcm_wav_header(header, 16000, ADPCM_WAV_UNKNOWN_SAMPLES) == ADPCM_WAV_HEADER_BYTES);
+    ASSERT(read_u32(header + 4) == 0xFFFFFFFFu);
+    ASSERT(read_u32(header + 48) == 0xFFFFFFFFu);
+    ASSERT(read_u32(header + 56) == 0xFFFFFFFFu);
+    return 0;
+}
+
+TEST(multipart_form_framing)
+{
+    char head[TRANSCRIBE_FORM_BUF_SIZE];
+    char tail[64];
+    char tiny[16];
+
+    size_t head_len = transcribe_form_head(head, sizeof(head), "whisper-1");
+    size_t tail_len = transcribe_form_tail(tail, sizeof(tail));
+    ASSERT(head_len > 0 && head_len == strlen(head));
+    ASSERT(tail_len > 0 && tail_len == strlen(tail));
+    ASSERT(strncmp(head, "--" TRANSCRIBE_BOUNDARY "\r\n", strlen(TRANSCRIBE_BOUNDARY) + 4) == 0);
+    ASSERT(strstr(head, "name=\"model\"\r\n\r\nwhisper-1\r\n") != NULL);
+    ASSERT(strstr(head, "filename=\"audio.wav\"") != NULL);
+    ASSERT(strcmp(head + head_len - 4, "\r\n\r\n") == 0);
+    ASSERT(strcmp(tail, "\r\n--" TRANSCRIBE_BOUNDARY "--\r\n") == 0);
+
+    ASSERT(transcribe_form_head(tiny, sizeof(tiny), "whisper-1") == 0);
+    ASSERT(transcribe_form_tail(tiny, sizeof(tiny)) == 0);
+    return 0;
+}
+
+TEST(parse_transcription_response)
+{
+    char text[32];
+
+    ASSERT(transcribe_parse_response("{\"text\":\"turn on the lamp\"}", text, sizeof(text)));
+    ASSERT(strcmp(text, "turn on the lamp") == 0);
+
+    ASSERT(!transcribe_parse_response("{\"error\":{\"message\":\"Invalid file format.\"}}",
+                                      text, sizeof(text)));
+    ASSERT(strcmp(text, "Invalid file format.") == 0);
+
+    ASSERT(!transcribe_parse_response("<html>502</html>", text, sizeof(text)));
+    ASSERT(text[0] == '\0');
+    ASSERT(!transcribe_parse_response("", text, sizeof(text)));
+    ASSERT(text[0] == '\0');
+
+    // Long transcripts are cut to the buffer.
+    ASSERT(transcribe_parse_response("{\"text\":\"0123456789012345678901234567890123456789\"}",
+                                     text, sizeof(text)));
+    ASSERT(strlen(text) == sizeof(text) - 1);
+    return 0;
+}
+
+int test_adpcm_all(void)
+{
+    int failures = 0;
+
+    printf("\nADPCM Tests:\n");
+
+    printf("  speech_band_round_trip... ");
+    if (test_speech_band_round_trip() == 0) printf("OK\n"); else failures++;
+
+    printf("  extremes_clamp_and_short_block_pads... ");
+    if (test_extremes_clamp_and_short_block_pads() == 0) printf("OK\n"); else failures++;
+
+    printf("  wav_header_describes_blocks... ");
+    if (test_wav_header_describes_blocks() == 0) printf("OK\n"); else failures++;
+
+    printf("  multipart_form_framing... ");
+    if (test_multipart_form_framing() == 0) printf("OK\n"); else failures++;
+
+    printf("  parse_transcription_response... ");
+    if (test_parse_transcription_response() == 0) printf("OK\n"); else failures++;
+
+    return failures;
+}
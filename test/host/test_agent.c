@@ -7,11 +7,14 @@
 
 #include "agent.h"
 #include "config.h"
+#include "flash_emu.h"
 #include "messages.h"
 #include "mock_freertos.h"
 #include "mock_llm.h"
 #include "mock_ratelimit.h"
+#include "mock_recall.h"
 #include "mock_tools.h"
+#include "zc_store.h"
 #include "freertos/queue.h"
 
 #define TEST(name) static int test_##name(void)
@@ -48,11 +51,23 @@ static int recv_telegram_text(QueueHandle_t queue, char *out, size_t out_len)
     return 1;
 }
 
+static int recv_telegram_chat(QueueHandle_t queue, int64_t *chat_id, char *out, size_t out_len)
+{
+    telegram_msg_t msg;
+    if (xQueueReceive(queue, &msg, 0) != pdTRUE) {
+        return 0;
+    }
+    *chat_id = msg.chat_id;
+    snprintf(out, out_len, "%s", msg.text);
+    return 1;
+}
+
 static void reset_state(void)
 {
     mock_freertos_reset();
     mock_llm_reset();
     mock_ratelimit_reset();
+    mock_recall_reset();
     mock_tools_reset();
     mock_llm_set_backend(LLM_BACKEND_ANTHROPIC, "mock-anthropic");
     agent_test_reset();
@@ -113,6 +128,7 @@ TEST(rate_limit_short_circuit)
     ASSERT(mock_llm_request_count() == 0);
     ASSERT(mock_ratelimit_record_count() == 0);
     ASSERT(mock_freertos_delay_count() == 0);
+    ASSERT_STR_EQ(mock_recall_last_message(), "");
     ASSERT(recv_channel_text(channel_q, text, sizeof(text)) == 1);
     ASSERT_STR_EQ(text, "Rate limit hit");
 
@@ -352,6 +368,160 @@ TEST(help_and_settings_commands_bypass_llm)
     return 0;
 }
 
+TEST(recalled_memories_reach_system_prompt)
+{
+    QueueHandle_t channel_q;
+    char text[CHANNEL_TX_BUF_SIZE];
+    const char *tool_call =
+        "{\"content\":[{\"type\":\"tool_use\",\"id\":\"toolu_1\",\"name\":\"get_time\","
+        "\"input\":{}}],\"stop_reason\":\"tool_use\"}";
+    const char *done =
+        "{\"content\":[{\"type\":\"text\",\"text\":\"ok\"}],\"stop_reason\":\"end_turn\"}";
+
+    reset_state();
+    channel_q = xQueueCreate(4, sizeof(channel_output_msg_t));
+    ASSERT(channel_q != NULL);
+    agent_test_set_queues(channel_q, NULL);
+
+    mock_recall_set_context("\n\nRelevant user memories:\n- u_wifi_room: office\n");
+    ASSERT(mock_llm_push_result(ESP_OK, tool_call));
+    ASSERT(mock_llm_push_result(ESP_OK, done));
+    agent_test_process_message("which room is the router in?");
+
+    ASSERT_STR_EQ(mock_recall_last_message(), "which room is the router in?");
+    ASSERT(mock_llm_request_count() == 2);
+    // Still present on the follow-up round after the tool result.
+    ASSERT(strstr(mock_llm_last_request_json(), "- u_wifi_room: office") != NULL);
+    ASSERT(strstr(mock_llm_last_request_json(), "You are zclaw") != NULL);
+    ASSERT(recv_channel_text(channel_q, text, sizeof(text)) == 1);
+
+    // Nothing relevant: the base prompt goes out unchanged.
+    mock_recall_set_context("");
+    ASSERT(mock_llm_push_result(ESP_OK, done));
+    agent_test_process_message("hello");
+    ASSERT(strstr(mock_llm_last_request_json(), "Relevant user memories") == NULL);
+
+    vQueueDelete(channel_q);
+    return 0;
+}
+
+TEST(charges_reported_usage_per_traffic_class)
+{
+    QueueHandle_t channel_q;
+    char text[CHANNEL_TX_BUF_SIZE];
+    const char *with_usage =
+        "{\"content\":[{\"type\":\"text\",\"text\":\"watered\"}],\"stop_reason\":\"end_turn\","
+        "\"usage\":{\"input_tokens\":1200,\"output_tokens\":30,"
+        "\"cache_read_input_tokens\":800}}";
+    const char *without_usage =
+        "{\"content\":[{\"type\":\"text\",\"text\":\"hi\"}],\"stop_reason\":\"end_turn\"}";
+
+    reset_state();
+
+    channel_q = xQueueCreate(4, sizeof(channel_output_msg_t));
+    ASSERT(channel_q != NULL);
+    agent_test_set_queues(channel_q, NULL);
+
+    ASSERT(mock_llm_push_result(ESP_OK, with_usage));
+    agent_test_process_source_message(CHAT_ID_LOCAL, MSG_SOURCE_CRON,
+                                      CRON_MESSAGE_PREFIX "3] water the plants");
+    ASSERT(recv_channel_text(channel_q, text, sizeof(text)) == 1);
+    ASSERT(mock_ratelimit_last_class() == RATELIMIT_CLASS_CRON);
+    ASSERT(mock_recall_last_class() == RATELIMIT_CLASS_CRON);
+    ASSERT(mock_ratelimit_tokens_recorded() == 2030);
+
+    // Typing the scheduler's tag does not move a chat onto the cron budget.
+    ASSERT(mock_llm_push_result(ESP_OK, without_usage));
+    agent_test_process_message(CRON_MESSAGE_PREFIX "3] water the plants");
+    ASSERT(recv_channel_text(channel_q, text, sizeof(text)) == 1);
+    ASSERT(mock_ratelimit_last_class() == RATELIMIT_CLASS_INTERACTIVE);
+    ASSERT(mock_llm_push_result(ESP_OK, without_usage));
+    agent_test_process_message(MOTION_MESSAGE_PREFIX "Left side changed.");
+    ASSERT(recv_channel_text(channel_q, text, sizeof(text)) == 1);
+    ASSERT(mock_ratelimit_last_class() == RATELIMIT_CLASS_INTERACTIVE);
+
+    ASSERT(mock_llm_push_result(ESP_OK, without_usage));
+    agent_test_process_source_message(CHAT_ID_LOCAL, MSG_SOURCE_MOTION,
+                                      MOTION_MESSAGE_PREFIX "Left side changed.");
+    ASSERT(recv_channel_text(channel_q, text, sizeof(text)) == 1);
+    ASSERT(mock_ratelimit_last_class() == RATELIMIT_CLASS_CRON);
+
+    // No usage in the response: charged by a size estimate instead.
+    ASSERT(mock_llm_push_result(ESP_OK, without_usage));
+    agent_test_process_message("hello");
+    ASSERT(recv_channel_text(channel_q, text, sizeof(text)) == 1);
+    ASSERT(mock_ratelimit_last_class() == RATELIMIT_CLASS_INTERACTIVE);
+    ASSERT(mock_recall_last_class() == RATELIMIT_CLASS_INTERACTIVE);
+    ASSERT(mock_ratelimit_record_count() == 5);
+    ASSERT(mock_ratelimit_tokens_recorded() > 2030);
+
+    vQueueDelete(channel_q);
+    return 0;
+}
+
+#define CHAT_IMAGE_PATH     "build/agent_chat_test.img"
+#define CHAT_SEGMENT_SIZE   16384
+
+TEST(chats_keep_separate_histories_and_replies)
+{
+    QueueHandle_t channel_q;
+    QueueHandle_t telegram_q;
+    flash_emu_t emu;
+    zc_store_backend_t backend;
+    char text[TELEGRAM_MAX_MSG_LEN];
+    int64_t chat_id = -1;
+    const char *reply =
+        "{\"content\":[{\"type\":\"text\",\"text\":\"noted\"}],\"stop_reason\":\"end_turn\"}";
+
+    reset_state();
+    remove(CHAT_IMAGE_PATH);
+    ASSERT(flash_emu_open(&emu, CHAT_IMAGE_PATH, CHAT_SEGMENT_SIZE * 4));
+    flash_emu_backend(&emu, CHAT_SEGMENT_SIZE, &backend);
+    ASSERT(zc_store_mount(&backend) == ESP_OK);
+
+    channel_q = xQueueCreate(4, sizeof(channel_output_msg_t));
+    telegram_q = xQueueCreate(4, sizeof(telegram_msg_t));
+    ASSERT(channel_q != NULL);
+    ASSERT(telegram_q != NULL);
+    agent_test_set_queues(channel_q, telegram_q);
+
+    ASSERT(mock_llm_push_result(ESP_OK, reply));
+    agent_test_process_chat_message(1001, "my plant is a fern");
+    ASSERT(recv_telegram_chat(telegram_q, &chat_id, text, sizeof(text)) == 1);
+    ASSERT(chat_id == 1001);
+    ASSERT_STR_EQ(text, "noted");
+    // Other chats are not mirrored to the local channel.
+    ASSERT(recv_channel_text(channel_q, text, sizeof(text)) == 0);
+
+    ASSERT(mock_llm_push_result(ESP_OK, reply));
+    agent_test_process_chat_message(1002, "what is my plant");
+    ASSERT(strstr(mock_llm_last_request_json(), "fern") == NULL);
+    ASSERT(recv_telegram_chat(telegram_q, &chat_id, text, sizeof(text)) == 1);
+    ASSERT(chat_id == 1002);
+
+    // The first chat's turn is back, even if it was spilled to flash.
+    ASSERT(mock_llm_push_result(ESP_OK, reply));
+    agent_test_process_chat_message(1001, "what is my plant");
+    ASSERT(strstr(mock_llm_last_request_json(), "my plant is a fern") != NULL);
+    ASSERT(recv_telegram_chat(telegram_q, &chat_id, text, sizeof(text)) == 1);
+    ASSERT(chat_id == 1001);
+
+    // Local input still fans out to both outputs, tagged for the primary chat.
+    ASSERT(mock_llm_push_result(ESP_OK, reply));
+    agent_test_process_message("hello");
+    ASSERT(strstr(mock_llm_last_request_json(), "fern") == NULL);
+    ASSERT(recv_channel_text(channel_q, text, sizeof(text)) == 1);
+    ASSERT(recv_telegram_chat(telegram_q, &chat_id, text, sizeof(text)) == 1);
+    ASSERT(chat_id == CHAT_ID_LOCAL);
+
+    vQueueDelete(channel_q);
+    vQueueDelete(telegram_q);
+    zc_store_unmount();
+    flash_emu_close(&emu);
+    remove(CHAT_IMAGE_PATH);
+    return 0;
+}
+
 int test_agent_all(void)
 {
     int failures = 0;
@@ -414,5 +584,26 @@ int test_agent_all(void)
         failures++;
     }
 
+    printf("  recalled_memories_reach_system_prompt... ");
+    if (test_recalled_memories_reach_system_prompt() == 0) {
+        printf("OK\n");
+    } else {
+        failures++;
+    }
+
+    printf("  charges_reported_usage_per_traffic_class... ");
+    if (test_charges_reported_usage_per_traffic_class() == 0) {
+        printf("OK\n");
+    } else {
+        failures++;
+    }
+
+    printf("  chats_keep_separate_histories_and_replies... ");
+    if (test_chats_keep_separate_histories_and_replies() == 0) {
+        printf("OK\n");
+    } else {
+        failures++;
+    }
+
     return failures;
 }
@@ -0,0 +1,281 @@
+/*
+ * Host tests for analyze_audio's levels and spectrum summary, on synthetic
+ * tones, hum, noise and clipped signals.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "audio_stats.h"
+
+#define TEST(name) static int test_##name(void)
+#define ASSERT(cond) do { \
+    if (!(cond)) { \
+        printf("  FAIL: %s (line %d)\n", #cond, __LINE__); \
+        return 1; \
+    } \
+} while(0)
+
+#define RATE        16000
+#define PI          3.14159265358979
+
+static uint32_t s_rng;
+
+static double noise(void)
+{
+    s_rng = s_rng * 1664525u + 1013904223u;
+    return (double)(s_rng >> 8) / (double)(1u << 24) * 2.0 - 1.0;
+}
+
+static void add_tone(double *x, size_t n, double freq, double amp)
+{
+    for (size_t i = 0; i < n; i++) {
+        x[i] += amp * sin(2.0 * PI * freq * (double)i / RATE);
+    }
+}
+
+static int16_t *to_pcm(const double *x, size_t n)
+{
+    int16_t *pcm = malloc(n * sizeof(int16_t));
+
+    for (size_t i = 0; pcm && i < n; i++) {
+        double v = x[i] > 32767.0 ? 32767.0 : (x[i] < -32768.0 ? -32768.0 : x[i]);
+        pcm[i] = (int16_t)lrint(v);
+    }
+    return pcm;
+}
+
+static void analyze(const int16_t *pcm, size_t n, audio_summary_t *out)
+{
+    static audio_stats_t stats;
+
+    if (!audio_stats_init(&stats, RATE)) {
+        memset(out, 0, sizeof(*out));
+        return;
+    }
+    audio_stats_push(&stats, pcm, n);
+    audio_stats_finish(&stats, out);
+}
+
+static double tone_dbfs(double amp)
+{
+    return 20.0 * log10(amp / sqrt(2.0) / 32768.0);
+}
+
+TEST(levels_ignore_dc)
+{
+    size_t n = RATE;
+    double *x = calloc(n, sizeof(double));
+    audio_summary_t s;
+
+    ASSERT(x);
+    add_tone(x, n, 440.0, 16384.0);
+    for (size_t i = 0; i < n; i++) {
+        x[i] += 2000.0;
+    }
+    int16_t *pcm = to_pcm(x, n);
+    ASSERT(pcm);
+    analyze(pcm, n, &s);
+
+    ASSERT(s.duration_ms == 1000);
+    ASSERT(fabs(s.rms_dbfs - tone_dbfs(16384.0)) < 0.1);
+    ASSERT(fabs(s.peak_dbfs - 20.0 * log10(18384.0 / 32768.0)) < 0.1);
+    ASSERT(s.clip_pct == 0.0f);
+    ASSERT(s.has_spectrum);
+    ASSERT(s.peak_count == 1);
+    ASSERT(fabs(s.peaks[0].freq_hz - 440.0) < 2.0);
+
+    memset(pcm, 0, n * sizeof(int16_t));
+    analyze(pcm, n, &s);
+    ASSERT(s.rms_dbfs == -100.0f);
+    ASSERT(s.peak_count == 0);
+    free(x);
+    free(pcm);
+    return 0;
+}
+
+TEST(pump_hum_tones_in_noise)
+{
+    size_t n = 2 * RATE;
+    double *x = calloc(n, sizeof(double));
+    audio_summary_t s;
+
+    ASSERT(x);
+    s_rng = 11;
+    add_tone(x, n, 50.0, 8000.0);
+    add_tone(x, n, 100.0, 3000.0);
+    add_tone(x, n, 1234.0, 1000.0);
+    for (size_t i = 0; i < n; i++) {
+        x[i] += 300.0 * noise();
+    }
+    int16_t *pcm = to_pcm(x, n);
+    ASSERT(pcm);
+    analyze(pcm, n, &s);
+
+    ASSERT(s.peak_count == 3);
+    ASSERT(fabs(s.peaks[0].freq_hz - 50.0) < 3.0);
+    ASSERT(fabs(s.peaks[1].freq_hz - 100.0) < 3.0);
+    ASSERT(fabs(s.peaks[2].freq_hz - 1234.0) < 3.0);
+    ASSERT(fabs(s.peaks[0].level_dbfs - tone_dbfs(8000.0)) < 1.0);
+    ASSERT(fabs(s.peaks[1].level_dbfs - tone_dbfs(3000.0)) < 1.0);
+    ASSERT(fabs(s.peaks[2].level_dbfs - tone_dbfs(1000.0)) < 1.0);
+    ASSERT(s.band_pct[0] >= 85);
+    free(x);
+    free(pcm);
+    return 0;
+}
+
+TEST(white_noise_spreads_over_bands)
+{
+    size_t n = 2 * RATE;
+    double *x = calloc(n, sizeof(double));
+    audio_summary_t s;
+
+    ASSERT(x);
+    s_rng = 5;
+    for (size_t i = 0; i < n; i++) {
+        x[i] = 8000.0 * noise();
+    }
+    int16_t *pcm = to_pcm(x, n);
+    ASSERT(pcm);
+    analyze(pcm, n, &s);
+
+    // Bands in proportion to their width: 3/9/38/50 %.
+    ASSERT(s.peak_count == 0);
+    ASSERT(s.band_pct[0] <= 5);
+    ASSERT(s.band_pct[1] >= 7 && s.band_pct[1] <= 12);
+    ASSERT(s.band_pct[2] >= 34 && s.band_pct[2] <= 42);
+    ASSERT(s.band_pct[3] >= 46 && s.band_pct[3] <= 54);
+    free(x);
+    free(pcm);
+    return 0;
+}
+
+TEST(clipping_ratio)
+{
+    size_t n = RATE;
+    double *x = calloc(n, sizeof(double));
+    audio_summary_t s;
+    size_t rail = 0;
+
+    ASSERT(x);
+    add_tone(x, n, 300.0, 40000.0);
+    int16_t *pcm = to_pcm(x, n);
+    ASSERT(pcm);
+    for (size_t i = 0; i < n; i++) {
+        if (abs(pcm[i]) >= AUDIO_CLIP_LEVEL) {
+            rail++;
+        }
+    }
+    analyze(pcm, n, &s);
+
+    ASSERT(rail > n / 4);
+    ASSERT(fabs(s.clip_pct - (double)rail * 100.0 / (double)n) < 0.01);
+    ASSERT(s.peak_dbfs > -0.01f);
+    free(x);
+    free(pcm);
+    return 0;
+}
+
+TEST(chunked_push_matches_whole)
+{
+    size_t n = 3 * RATE / 2;
+    double *x = calloc(n, sizeof(double));
+    static audio_stats_t stats;
+    audio_summary_t whole;
+    audio_summary_t chunked;
+
+    ASSERT(x);
+    s_rng = 9;
+    add_tone(x, n, 2000.0, 5000.0);
+    for (size_t i = 0; i < n; i++) {
+        x[i] += 500.0 * noise();
+    }
+    int16_t *pcm = to_pcm(x, n);
+    ASSERT(pcm);
+    analyze(pcm, n, &whole);
+
+    ASSERT(audio_stats_init(&stats, RATE));
+    for (size_t off = 0, step = 1; off < n; off += step, step = step * 7 % 1001 + 1) {
+        audio_stats_push(&stats, pcm + off, off + step > n ? n - off : step);
+    }
+    audio_stats_finish(&stats, &chunked);
+
+    ASSERT(memcmp(&whole, &chunked, sizeof(whole)) == 0);
+    free(x);
+    free(pcm);
+    return 0;
+}
+
+TEST(summary_fits)
+{
+    audio_summary_t s;
+    char buf[256];
+
+    memset(&s, 0, sizeof(s));
+    s.duration_ms = 60000;
+    s.rms_dbfs = -100.0f;
+    s.peak_dbfs = -100.0f;
+    s.clip_pct = 100.0f;
+    s.has_spectrum = true;
+    s.peak_count = AUDIO_PEAKS_MAX;
+    for (int i = 0; i < AUDIO_PEAKS_MAX; i++) {
+        s.peaks[i].freq_hz = 7999.0f;
+        s.peaks[i].level_dbfs = -100.0f;
+    }
+    for (int b = 0; b < AUDIO_BANDS; b++) {
+        s.band_pct[b] = 100;
+    }
+    size_t len = audio_stats_format(&s, buf, sizeof(buf));
+    ASSERT(len == strlen(buf));
+    ASSERT(len < AUDIO_SUMMARY_MAX);
+
+    s.duration_ms = 2000;
+    s.rms_dbfs = -32.14f;
+    s.peak_dbfs = -12.0f;
+    s.clip_pct = 0.0f;
+    s.peak_count = 1;
+    s.peaks[0].freq_hz = 50.2f;
+    s.peaks[0].level_dbfs = -35.6f;
+    s.band_pct[0] = 90;
+    s.band_pct[1] = 6;
+    s.band_pct[2] = 3;
+    s.band_pct[3] = 1;
+    audio_stats_format(&s, buf, sizeof(buf));
+    ASSERT(strcmp(buf, "Audio 2.0 s: RMS -32.1 dBFS, peak -12.0 dBFS, clipped 0.00%. "
+                       "Tones: 50 Hz -36 dBFS. Bands <250/250-1k/1-4k/>4k Hz: 90/6/3/1%") == 0);
+
+    // Truncates cleanly into a small buffer.
+    len = audio_stats_format(&s, buf, 20);
+    ASSERT(len == strlen(buf) && len < 20);
+    return 0;
+}
+
+int test_audio_stats_all(void)
+{
+    int failures = 0;
+
+    printf("\nAudio Stats Tests:\n");
+
+    printf("  levels_ignore_dc... ");
+    if (test_levels_ignore_dc() == 0) printf("OK\n"); else failures++;
+
+    printf("  pump_hum_tones_in_noise... ");
+    if (test_pump_hum_tones_in_noise() == 0) printf("OK\n"); else failures++;
+
+    printf("  white_noise_spreads_over_bands... ");
+    if (test_white_noise_spreads_over_bands() == 0) printf("OK\n"); else failures++;
+
+    printf("  clipping_ratio... ");
+    if (test_clipping_ratio() == 0) printf("OK\n"); else failures++;
+
+    printf("  chunked_push_matches_whole... ");
+    if (test_chunked_push_matches_whole() == 0) printf("OK\n"); else failures++;
+
+    printf("  summary_fits... ");
+    if (test_summary_fits() == 0) printf("OK\n"); else failures++;
+
+    return failures;
+}
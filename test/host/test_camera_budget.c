@@ -0,0 +1,206 @@
+/*
+ * Host tests for capture_photo's byte budget: purpose goals, setting
+ * planning, the per-scene size model and the capture retry loop.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "camera_budget.h"
+
+#define TEST(name) static int test_##name(void)
+#define ASSERT(cond) do { \
+    if (!(cond)) { \
+        printf("  FAIL: %s (line %d)\n", #cond, __LINE__); \
+        return 1; \
+    } \
+} while(0)
+
+// Fake sensor: frames come out `complexity` times a plain scene's size.
+typedef struct {
+    float complexity;
+    int captures;
+    bool fail;
+    cam_setting_t settings[8];
+} fake_camera_t;
+
+static bool fake_capture(cam_setting_t setting, size_t *jpeg_len, void *ctx)
+{
+    fake_camera_t *cam = (fake_camera_t *)ctx;
+    cam_scene_model_t plain;
+
+    if (cam->fail) {
+        return false;
+    }
+    cam_scene_model_init(&plain);
+    plain.complexity = cam->complexity;
+    if (cam->captures < 8) {
+        cam->settings[cam->captures] = setting;
+    }
+    cam->captures++;
+    *jpeg_len = cam_budget_predict(&plain, setting);
+    return true;
+}
+
+TEST(purpose_goals)
+{
+    cam_budget_goal_t glance;
+    cam_budget_goal_t scene;
+    cam_budget_goal_t text;
+    cam_budget_goal_t fallback;
+
+    ASSERT(cam_budget_goal_for_purpose("glance", &glance));
+    ASSERT(cam_budget_goal_for_purpose("scene", &scene));
+    ASSERT(cam_budget_goal_for_purpose("read_text", &text));
+    ASSERT(cam_budget_goal_for_purpose(NULL, &fallback));
+    ASSERT(!cam_budget_goal_for_purpose("selfie", &fallback));
+
+    ASSERT(fallback.budget == scene.budget && fallback.max_size == scene.max_size);
+    ASSERT(glance.budget < scene.budget && scene.budget < text.budget);
+    ASSERT(glance.max_size < scene.max_size && scene.max_size < text.max_size);
+    ASSERT(text.worst_quality <= scene.worst_quality);
+    return 0;
+}
+
+TEST(fresh_model_keeps_old_default)
+{
+    cam_scene_model_t model;
+    cam_budget_goal_t goal;
+    cam_setting_t setting;
+
+    cam_scene_model_init(&model);
+    ASSERT(cam_budget_goal_for_purpose("scene", &goal));
+    ASSERT(cam_budget_plan(&model, &goal, NULL, &setting));
+    ASSERT(setting.size == CAM_SIZE_VGA && setting.quality == 12);
+
+    // A tight budget trades quality before resolution within a framesize.
+    goal.budget = 20 * 1024;
+    ASSERT(cam_budget_plan(&model, &goal, NULL, &setting));
+    ASSERT(cam_budget_predict(&model, setting) <= goal.budget / 100 * CAM_BUDGET_MARGIN_PCT);
+    ASSERT(setting.size == CAM_SIZE_VGA && setting.quality > 12);
+    return 0;
+}
+
+TEST(plan_after_only_goes_cheaper)
+{
+    cam_scene_model_t model;
+    cam_budget_goal_t goal;
+    cam_setting_t setting;
+
+    cam_scene_model_init(&model);
+    ASSERT(cam_budget_goal_for_purpose("glance", &goal));
+    cam_setting_t previous = { CAM_SIZE_QVGA, 20 };
+    ASSERT(cam_budget_plan(&model, &goal, &previous, &setting));
+    ASSERT(cam_budget_predict(&model, setting) < cam_budget_predict(&model, previous));
+
+    cam_setting_t floor = { CAM_SIZE_QQVGA, goal.worst_quality };
+    ASSERT(!cam_budget_plan(&model, &goal, &floor, &setting));
+    return 0;
+}
+
+TEST(busy_scene_learned_then_first_try)
+{
+    cam_scene_model_t model;
+    cam_budget_goal_t goal;
+    cam_budget_result_t shot;
+    fake_camera_t cam = { .complexity = 3.0f };
+
+    cam_scene_model_init(&model);
+    ASSERT(cam_budget_goal_for_purpose("scene", &goal));
+
+    // VGA/12 of this scene is ~75 KB; one retry corrects for it.
+    ASSERT(cam_budget_capture(&model, &goal, fake_capture, &cam, &shot));
+    ASSERT(shot.attempts == 2 && cam.captures == 2);
+    ASSERT(shot.within_budget && shot.jpeg_len <= goal.budget);
+    ASSERT(cam.settings[0].size == CAM_SIZE_VGA && cam.settings[0].quality == 12);
+    ASSERT(shot.setting.size == cam.settings[1].size);
+    ASSERT(shot.setting.quality == cam.settings[1].quality);
+
+    // Same view again: the model already knows, one capture.
+    cam.captures = 0;
+    ASSERT(cam_budget_capture(&model, &goal, fake_capture, &cam, &shot));
+    ASSERT(shot.attempts == 1 && shot.within_budget);
+    return 0;
+}
+
+TEST(model_rises_at_once_and_drops_gradually)
+{
+    cam_scene_model_t model;
+    cam_scene_model_t truth;
+    cam_setting_t vga = { CAM_SIZE_VGA, 12 };
+
+    cam_scene_model_init(&model);
+    cam_scene_model_init(&truth);
+    truth.complexity = 4.0f;
+    cam_budget_learn(&model, vga, cam_budget_predict(&truth, vga));
+    ASSERT(model.learned && model.complexity > 3.99f && model.complexity < 4.01f);
+
+    truth.complexity = 2.0f;
+    cam_budget_learn(&model, vga, cam_budget_predict(&truth, vga));
+    ASSERT(model.complexity > 2.0f && model.complexity < 4.0f);
+
+    truth.complexity = 8.0f;
+    cam_budget_learn(&model, vga, cam_budget_predict(&truth, vga));
+    ASSERT(model.complexity > 7.99f && model.complexity < 8.01f);
+    return 0;
+}
+
+TEST(unreachable_budget_keeps_last_frame)
+{
+    cam_scene_model_t model;
+    cam_budget_goal_t goal;
+    cam_budget_result_t shot;
+    fake_camera_t cam = { .complexity = 400.0f };
+
+    cam_scene_model_init(&model);
+    ASSERT(cam_budget_goal_for_purpose("glance", &goal));
+    goal.budget = CAM_BUDGET_MIN_BYTES;
+
+    ASSERT(cam_budget_capture(&model, &goal, fake_capture, &cam, &shot));
+    ASSERT(!shot.within_budget);
+    ASSERT(shot.attempts >= 1 && shot.attempts <= CAM_BUDGET_MAX_ATTEMPTS);
+    ASSERT(shot.setting.size == CAM_SIZE_QQVGA && shot.setting.quality == goal.worst_quality);
+    ASSERT(shot.jpeg_len > goal.budget);
+
+    cam.fail = true;
+    ASSERT(!cam_budget_capture(&model, &goal, fake_capture, &cam, &shot));
+    return 0;
+}
+
+TEST(upload_ms_counts_base64)
+{
+    ASSERT(cam_budget_upload_ms(30000, 40000) == 1000);
+    ASSERT(cam_budget_upload_ms(1, 4000) == 1);
+    ASSERT(cam_budget_upload_ms(30000, 0) == 0);
+    return 0;
+}
+
+int test_camera_budget_all(void)
+{
+    int failures = 0;
+
+    printf("\nCamera Budget Tests:\n");
+
+    printf("  purpose_goals... ");
+    if (test_purpose_goals() == 0) printf("OK\n"); else failures++;
+
+    printf("  fresh_model_keeps_old_default... ");
+    if (test_fresh_model_keeps_old_default() == 0) printf("OK\n"); else failures++;
+
+    printf("  plan_after_only_goes_cheaper... ");
+    if (test_plan_after_only_goes_cheaper() == 0) printf("OK\n"); else failures++;
+
+    printf("  busy_scene_learned_then_first_try... ");
+    if (test_busy_scene_learned_then_first_try() == 0) printf("OK\n"); else failures++;
+
+    printf("  model_rises_at_once_and_drops_gradually... ");
+    if (test_model_rises_at_once_and_drops_gradually() == 0) printf("OK\n"); else failures++;
+
+    printf("  unreachable_budget_keeps_last_frame... ");
+    if (test_unreachable_budget_keeps_last_frame() == 0) printf("OK\n"); else failures++;
+
+    printf("  upload_ms_counts_base64... ");
+    if (test_upload_ms_counts_base64() == 0) printf("OK\n"); else failures++;
+
+    return failures;
+}
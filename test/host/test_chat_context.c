@@ -0,0 +1,203 @@
+/*
+ * Host tests for per-chat conversation contexts: LRU eviction to a backend,
+ * restore on return, and the spilled history record.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "chat_context.h"
+
+#define TEST(name) static int test_##name(void)
+#define ASSERT(cond) do { \
+    if (!(cond)) { \
+        printf("  FAIL: %s (line %d)\n", #cond, __LINE__); \
+        return 1; \
+    } \
+} while(0)
+
+#define SPILL_SLOTS 4
+
+typedef struct {
+    int64_t chat_id;
+    char record[CHAT_CONTEXT_RECORD_MAX];
+    bool used;
+} spill_t;
+
+static spill_t s_spills[SPILL_SLOTS];
+static int s_saves;
+
+static bool spill_save(int64_t chat_id, const char *record, void *ctx)
+{
+    (void)ctx;
+    for (int i = 0; i < SPILL_SLOTS; i++) {
+        if (!s_spills[i].used || s_spills[i].chat_id == chat_id) {
+            s_spills[i].used = true;
+            s_spills[i].chat_id = chat_id;
+            snprintf(s_spills[i].record, sizeof(s_spills[i].record), "%s", record);
+            s_saves++;
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool spill_load(int64_t chat_id, char *record, size_t record_len, void *ctx)
+{
+    (void)ctx;
+    for (int i = 0; i < SPILL_SLOTS; i++) {
+        if (s_spills[i].used && s_spills[i].chat_id == chat_id) {
+            snprintf(record, record_len, "%s", s_spills[i].record);
+            return true;
+        }
+    }
+    return false;
+}
+
+static void set_msg(conversation_msg_t *msg, const char *role, const char *content,
+                    bool is_tool_use, bool is_tool_result, const char *tool_id,
+                    const char *tool_name)
+{
+    memset(msg, 0, sizeof(*msg));
+    snprintf(msg->role, sizeof(msg->role), "%s", role);
+    snprintf(msg->content, sizeof(msg->content), "%s", content);
+    msg->is_tool_use = is_tool_use;
+    msg->is_tool_result = is_tool_result;
+    snprintf(msg->tool_id, sizeof(msg->tool_id), "%s", tool_id ? tool_id : "");
+    snprintf(msg->tool_name, sizeof(msg->tool_name), "%s", tool_name ? tool_name : "");
+}
+
+static void say(chat_context_t *ctx, const char *role, const char *content)
+{
+    set_msg(&ctx->history[ctx->len++], role, content, false, false, NULL, NULL);
+}
+
+TEST(codec_roundtrip_with_tool_exchange)
+{
+    conversation_msg_t in[4];
+    conversation_msg_t out[4];
+    char record[512];
+
+    set_msg(&in[0], "user", "turn on\x1fled", false, false, NULL, NULL);
+    set_msg(&in[1], "assistant", "{\"pin\":2}", true, false, "toolu_1", "gpio_write");
+    set_msg(&in[2], "user", "ok\nline two", false, true, "toolu_1", NULL);
+    set_msg(&in[3], "assistant", "Done.", false, false, NULL, NULL);
+
+    size_t len = chat_context_encode(in, 4, record, sizeof(record));
+    ASSERT(len == strlen(record));
+    ASSERT(chat_context_decode(record, out, 4) == 4);
+
+    // Delimiters inside text are blanked; everything else survives.
+    ASSERT(strcmp(out[0].role, "user") == 0 && strcmp(out[0].content, "turn on led") == 0);
+    ASSERT(out[1].is_tool_use && strcmp(out[1].role, "assistant") == 0);
+    ASSERT(strcmp(out[1].tool_id, "toolu_1") == 0 && strcmp(out[1].tool_name, "gpio_write") == 0);
+    ASSERT(strcmp(out[1].content, "{\"pin\":2}") == 0);
+    ASSERT(out[2].is_tool_result && strcmp(out[2].content, "ok\nline two") == 0);
+    ASSERT(strcmp(out[3].role, "assistant") == 0 && strcmp(out[3].content, "Done.") == 0);
+
+    ASSERT(chat_context_decode(record, out, 3) == -1);
+    ASSERT(chat_context_decode("c2\nU\x1f\x1fhi\x1e", out, 4) == -1);
+    ASSERT(chat_context_decode("c1\nU\x1f\x1fhi", out, 4) == -1);
+    ASSERT(chat_context_decode("c1\nX\x1f\x1fhi\x1e", out, 4) == -1);
+    ASSERT(chat_context_decode("c1\n", out, 4) == 0);
+    return 0;
+}
+
+TEST(encode_keeps_newest_turns_from_a_user_message)
+{
+    conversation_msg_t in[5];
+    conversation_msg_t out[5];
+    char record[64];
+
+    set_msg(&in[0], "user", "first question", false, false, NULL, NULL);
+    set_msg(&in[1], "assistant", "first answer", false, false, NULL, NULL);
+    set_msg(&in[2], "user", "q2", false, false, NULL, NULL);
+    set_msg(&in[3], "assistant", "{}", true, false, "t", "x");
+    set_msg(&in[4], "user", "r", false, true, "t", NULL);
+
+    // Only the last three fit; the record must not open mid tool exchange.
+    size_t len = chat_context_encode(in, 5, record, 32);
+    ASSERT(len > 0 && len < 32);
+    ASSERT(chat_context_decode(record, out, 5) == 3);
+    ASSERT(strcmp(out[0].content, "q2") == 0);
+
+    // Nothing fits when the newest user turn is too large.
+    ASSERT(chat_context_encode(in, 5, record, 12) == 0);
+    ASSERT(chat_context_encode(in, 0, record, sizeof(record)) == 0);
+    return 0;
+}
+
+TEST(lru_chat_spills_and_comes_back)
+{
+    chat_context_backend_t backend = { NULL, NULL, spill_save, spill_load, NULL };
+    chat_context_t *ctx;
+
+    memset(s_spills, 0, sizeof(s_spills));
+    s_saves = 0;
+    ASSERT(chat_context_init(&backend));
+
+    // Fill every resident slot, then touch the first chat again.
+    for (int i = 0; i < CHAT_CONTEXT_SLOTS; i++) {
+        ctx = chat_context_acquire(100 + i);
+        ASSERT(ctx && ctx->len == 0);
+        say(ctx, "user", "hello");
+        say(ctx, "assistant", "hi");
+    }
+    ASSERT(chat_context_resident() == CHAT_CONTEXT_SLOTS);
+    ctx = chat_context_acquire(100);
+    ASSERT(ctx->len == 2);
+    ASSERT(s_saves == 0);
+
+    // A new chat evicts the least recently used one.
+    int64_t evicted = CHAT_CONTEXT_SLOTS > 1 ? 101 : 100;
+    ctx = chat_context_acquire(200);
+    ASSERT(ctx->chat_id == 200 && ctx->len == 0);
+    ASSERT(s_saves == 1 && s_spills[0].chat_id == evicted);
+    say(ctx, "user", "other chat");
+
+    // Returning restores the spilled history.
+    ctx = chat_context_acquire(evicted);
+    ASSERT(ctx->len == 2);
+    ASSERT(strcmp(ctx->history[0].content, "hello") == 0);
+    ASSERT(strcmp(ctx->history[1].role, "assistant") == 0);
+
+    chat_context_deinit();
+    ASSERT(chat_context_acquire(100) == NULL);
+    return 0;
+}
+
+TEST(no_backend_starts_over)
+{
+    chat_context_t *ctx;
+
+    ASSERT(chat_context_init(NULL));
+    for (int i = 0; i <= CHAT_CONTEXT_SLOTS; i++) {
+        ctx = chat_context_acquire(i + 1);
+        say(ctx, "user", "hello");
+    }
+    ctx = chat_context_acquire(1);
+    ASSERT(ctx->len == 0);
+    chat_context_deinit();
+    return 0;
+}
+
+int test_chat_context_all(void)
+{
+    int failures = 0;
+
+    printf("\nChat Context Tests:\n");
+
+    printf("  codec_roundtrip_with_tool_exchange... ");
+    if (test_codec_roundtrip_with_tool_exchange() == 0) printf("OK\n"); else failures++;
+
+    printf("  encode_keeps_newest_turns_from_a_user_message... ");
+    if (test_encode_keeps_newest_turns_from_a_user_message() == 0) printf("OK\n"); else failures++;
+
+    printf("  lru_chat_spills_and_comes_back... ");
+    if (test_lru_chat_spills_and_comes_back() == 0) printf("OK\n"); else failures++;
+
+    printf("  no_backend_starts_over... ");
+    if (test_no_backend_starts_over() == 0) printf("OK\n"); else failures++;
+
+    return failures;
+}
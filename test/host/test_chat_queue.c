@@ -0,0 +1,116 @@
+/*
+ * Host tests for the agent's per-chat pending table: round-robin across
+ * chats, arrival order within a chat, depth and queue wait.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "chat_queue.h"
+
+#define TEST(name) static int test_##name(void)
+#define ASSERT(cond) do { \
+    if (!(cond)) { \
+        printf("  FAIL: %s (line %d)\n", #cond, __LINE__); \
+        return 1; \
+    } \
+} while(0)
+
+static bool push(chat_queue_t *queue, int64_t chat_id, const char *text, int64_t now_us)
+{
+    channel_msg_t msg;
+
+    msg.chat_id = chat_id;
+    snprintf(msg.text, sizeof(msg.text), "%s", text);
+    return chat_queue_push(queue, &msg, now_us);
+}
+
+TEST(busy_chat_does_not_starve_others)
+{
+    chat_queue_t queue;
+    channel_msg_t msg;
+    const char *expected[] = { "a1", "b1", "c1", "a2", "b2", "a3", "a4" };
+
+    chat_queue_init(&queue);
+    // Chat 1 floods first; chats 2 and 3 arrive behind it.
+    ASSERT(push(&queue, 1, "a1", 0));
+    ASSERT(push(&queue, 1, "a2", 0));
+    ASSERT(push(&queue, 1, "a3", 0));
+    ASSERT(push(&queue, 2, "b1", 0));
+    ASSERT(push(&queue, 1, "a4", 0));
+    ASSERT(push(&queue, 3, "c1", 0));
+    ASSERT(push(&queue, 2, "b2", 0));
+    ASSERT(chat_queue_depth(&queue, 1) == 4);
+    ASSERT(chat_queue_depth(&queue, 2) == 2);
+
+    for (size_t i = 0; i < sizeof(expected) / sizeof(expected[0]); i++) {
+        ASSERT(chat_queue_pop(&queue, 0, &msg, NULL));
+        ASSERT(strcmp(msg.text, expected[i]) == 0);
+    }
+    ASSERT(!chat_queue_pop(&queue, 0, &msg, NULL));
+    ASSERT(chat_queue_count(&queue) == 0);
+    return 0;
+}
+
+TEST(late_chat_goes_before_served_chat)
+{
+    chat_queue_t queue;
+    channel_msg_t msg;
+
+    chat_queue_init(&queue);
+    ASSERT(push(&queue, 1, "a1", 0));
+    ASSERT(push(&queue, 1, "a2", 0));
+    ASSERT(chat_queue_pop(&queue, 0, &msg, NULL));
+    ASSERT(strcmp(msg.text, "a1") == 0);
+
+    // Chat 2 shows up while chat 1 still has a message waiting.
+    ASSERT(push(&queue, 2, "b1", 0));
+    ASSERT(chat_queue_pop(&queue, 0, &msg, NULL));
+    ASSERT(strcmp(msg.text, "b1") == 0);
+    ASSERT(chat_queue_pop(&queue, 0, &msg, NULL));
+    ASSERT(strcmp(msg.text, "a2") == 0);
+    return 0;
+}
+
+TEST(full_queue_and_wait_time)
+{
+    chat_queue_t queue;
+    channel_msg_t msg;
+    int64_t wait_us = -1;
+
+    chat_queue_init(&queue);
+    for (int i = 0; i < CHAT_QUEUE_LEN; i++) {
+        ASSERT(push(&queue, i % 2, "m", 1000 + i));
+    }
+    ASSERT(chat_queue_is_full(&queue));
+    ASSERT(!push(&queue, 7, "x", 0));
+
+    ASSERT(chat_queue_pop(&queue, 5000, &msg, &wait_us));
+    ASSERT(msg.chat_id == 0);
+    ASSERT(wait_us == 4000);
+    ASSERT(!chat_queue_is_full(&queue));
+    ASSERT(chat_queue_depth(&queue, 0) == (CHAT_QUEUE_LEN + 1) / 2 - 1);
+
+    // A clock behind the enqueue time reports no wait.
+    ASSERT(chat_queue_pop(&queue, 0, &msg, &wait_us));
+    ASSERT(wait_us == 0);
+    return 0;
+}
+
+int test_chat_queue_all(void)
+{
+    int failures = 0;
+
+    printf("\nChat Queue Tests:\n");
+
+    printf("  busy_chat_does_not_starve_others... ");
+    if (test_busy_chat_does_not_starve_others() == 0) printf("OK\n"); else failures++;
+
+    printf("  late_chat_goes_before_served_chat... ");
+    if (test_late_chat_goes_before_served_chat() == 0) printf("OK\n"); else failures++;
+
+    printf("  full_queue_and_wait_time... ");
+    if (test_full_queue_and_wait_time() == 0) printf("OK\n"); else failures++;
+
+    return failures;
+}
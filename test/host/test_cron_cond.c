@@ -0,0 +1,268 @@
+/*
+ * Host tests for on-device condition predicates: compilation, evaluation
+ * against a fake GPIO/memory/time environment, and edge detection.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "cron_cond.h"
+
+#define TEST(name) static int test_##name(void)
+#define ASSERT(cond) do { \
+    if (!(cond)) { \
+        printf("  FAIL: %s (line %d)\n", #cond, __LINE__); \
+        return 1; \
+    } \
+} while(0)
+
+typedef struct {
+    int32_t levels[40];
+    const char *mem_key;
+    int32_t mem_value;
+    bool mem_present;
+    int gpio_reads;
+} fake_env_t;
+
+static bool fake_gpio_read(int pin, int32_t *level, void *ctx)
+{
+    fake_env_t *fake = (fake_env_t *)ctx;
+    if (pin < 0 || pin >= 40) {
+        return false;
+    }
+    fake->gpio_reads++;
+    *level = fake->levels[pin];
+    return true;
+}
+
+static bool fake_mem_read(const char *key, int32_t *value, void *ctx)
+{
+    fake_env_t *fake = (fake_env_t *)ctx;
+    if (!fake->mem_present || !fake->mem_key || strcmp(fake->mem_key, key) != 0) {
+        return false;
+    }
+    *value = fake->mem_value;
+    return true;
+}
+
+static cron_cond_env_t make_env(fake_env_t *fake, int hour, int minute, int weekday)
+{
+    cron_cond_env_t env;
+    memset(&env, 0, sizeof(env));
+    env.gpio_read = fake_gpio_read;
+    env.mem_read = fake_mem_read;
+    env.ctx = fake;
+    env.time_valid = true;
+    env.hour = hour;
+    env.minute = minute;
+    env.weekday = weekday;
+    return env;
+}
+
+static bool pin_allowed_low(int pin)
+{
+    return pin >= 2 && pin <= 10;
+}
+
+static int eval_text(const char *text, const cron_cond_env_t *env, bool *out)
+{
+    cron_cond_t cond;
+    char error[64];
+    if (!cron_cond_compile(text, 10, NULL, &cond, error, sizeof(error))) {
+        printf("  compile '%s': %s\n", text, error);
+        return 0;
+    }
+    return cron_cond_eval(&cond, env, out);
+}
+
+TEST(compile_and_eval_gpio_time)
+{
+    fake_env_t fake;
+    cron_cond_t cond;
+    char error[64];
+    bool value = true;
+
+    memset(&fake, 0, sizeof(fake));
+    ASSERT(cron_cond_compile("gpio(4)==1 && hour>=18", 5, pin_allowed_low, &cond,
+                             error, sizeof(error)));
+    ASSERT(strcmp(cond.source, "gpio(4)==1 && hour>=18") == 0);
+    ASSERT(cond.check_seconds == 5);
+    ASSERT(cond.uses == (CRON_COND_USES_GPIO | CRON_COND_USES_TIME));
+    ASSERT(cron_cond_is_valid(&cond));
+
+    cron_cond_env_t env = make_env(&fake, 19, 0, 2);
+    ASSERT(cron_cond_eval(&cond, &env, &value) && !value);
+    fake.levels[4] = 1;
+    ASSERT(cron_cond_eval(&cond, &env, &value) && value);
+    env.hour = 17;
+    ASSERT(cron_cond_eval(&cond, &env, &value) && !value);
+
+    // Time operands without synced time make the sample unknown.
+    env.time_valid = false;
+    ASSERT(!cron_cond_eval(&cond, &env, &value));
+    return 0;
+}
+
+TEST(operators_and_precedence)
+{
+    fake_env_t fake;
+    bool value = false;
+
+    memset(&fake, 0, sizeof(fake));
+    cron_cond_env_t env = make_env(&fake, 8, 30, 6);
+
+    ASSERT(eval_text("1 || 0 && 0", &env, &value) && value);
+    ASSERT(eval_text("(1 || 0) && 0", &env, &value) && !value);
+    ASSERT(eval_text("!(weekday==0 || weekday==6)", &env, &value) && !value);
+    ASSERT(eval_text("hour - 10 < -1", &env, &value) && value);
+    ASSERT(eval_text("minute != 30", &env, &value) && !value);
+    ASSERT(eval_text("hour <= 8 && minute >= 30 && !false", &env, &value) && value);
+    ASSERT(eval_text("  true  ", &env, &value) && value);
+    return 0;
+}
+
+TEST(memory_operands)
+{
+    fake_env_t fake;
+    cron_cond_t cond;
+    char error[64];
+    bool value = false;
+
+    memset(&fake, 0, sizeof(fake));
+    fake.mem_key = "u_temp";
+    fake.mem_value = 31;
+    fake.mem_present = true;
+    cron_cond_env_t env = make_env(&fake, 0, 0, 0);
+
+    ASSERT(cron_cond_compile("mem(u_temp) > 30 || mem(\"u_temp\") < -5", 10, NULL, &cond,
+                             error, sizeof(error)));
+    ASSERT(cond.key_count == 1);
+    ASSERT(cond.uses == CRON_COND_USES_MEMORY);
+    ASSERT(cron_cond_eval(&cond, &env, &value) && value);
+    fake.mem_value = 20;
+    ASSERT(cron_cond_eval(&cond, &env, &value) && !value);
+    fake.mem_present = false;
+    ASSERT(!cron_cond_eval(&cond, &env, &value));
+
+    ASSERT(!cron_cond_compile("mem(wifi_pass) == 1", 10, NULL, &cond, error, sizeof(error)));
+    ASSERT(strstr(error, "u_") != NULL);
+    ASSERT(!cron_cond_compile("mem(u_a)+mem(u_b)+mem(u_c) > 0", 10, NULL, &cond,
+                              error, sizeof(error)));
+    return 0;
+}
+
+TEST(compile_errors)
+{
+    cron_cond_t cond;
+    char error[64];
+
+    ASSERT(!cron_cond_compile("", 10, NULL, &cond, error, sizeof(error)));
+    ASSERT(!cron_cond_compile("gpio(4) ==", 10, NULL, &cond, error, sizeof(error)));
+    ASSERT(!cron_cond_compile("gpio(4) = 1", 10, NULL, &cond, error, sizeof(error)));
+    ASSERT(!cron_cond_compile("hour*1", 10, NULL, &cond, error, sizeof(error)));
+    ASSERT(strstr(error, "trailing") != NULL);
+    ASSERT(!cron_cond_compile("(hour > 3", 10, NULL, &cond, error, sizeof(error)));
+    ASSERT(strstr(error, "')'") != NULL);
+    ASSERT(!cron_cond_compile("temperature > 3", 10, NULL, &cond, error, sizeof(error)));
+    ASSERT(!cron_cond_compile("hourly", 10, NULL, &cond, error, sizeof(error)));
+    ASSERT(!cron_cond_compile("gpio(40) == 1", 10, pin_allowed_low, &cond, error, sizeof(error)));
+    ASSERT(strstr(error, "not allowed") != NULL);
+    ASSERT(!cron_cond_compile("hour > 1", 0, NULL, &cond, error, sizeof(error)));
+    ASSERT(!cron_cond_compile("hour > 1", CRON_COND_MAX_CHECK_S + 1, NULL, &cond,
+                              error, sizeof(error)));
+    ASSERT(!cron_cond_compile("((((((((((1))))))))) && (1 && (1 && (1 && (1 && (1 && (1 && (1 && (1 && 1))))))))",
+                              10, NULL, &cond, error, sizeof(error)));
+    return 0;
+}
+
+TEST(rejects_corrupt_program)
+{
+    cron_cond_t cond;
+    char error[64];
+
+    ASSERT(cron_cond_compile("gpio(4) == 1", 10, NULL, &cond, error, sizeof(error)));
+    cron_cond_t broken = cond;
+    broken.op_count = 2;                        // Leaves two values on the stack
+    ASSERT(!cron_cond_is_valid(&broken));
+    broken = cond;
+    broken.ops[0].op = 0xff;
+    ASSERT(!cron_cond_is_valid(&broken));
+    broken = cond;
+    broken.check_seconds = 0;
+    ASSERT(!cron_cond_is_valid(&broken));
+    broken = cond;
+    memset(broken.source, 'x', sizeof(broken.source));
+    ASSERT(!cron_cond_is_valid(&broken));
+    return 0;
+}
+
+TEST(edge_detection)
+{
+    cron_cond_state_t state = CRON_COND_STATE_UNKNOWN;
+
+    // First sample is a baseline, even when already true.
+    ASSERT(!cron_cond_update_edge(&state, true));
+    ASSERT(!cron_cond_update_edge(&state, true));
+    ASSERT(!cron_cond_update_edge(&state, false));
+    ASSERT(cron_cond_update_edge(&state, true));
+    ASSERT(!cron_cond_update_edge(&state, true));
+    ASSERT(!cron_cond_update_edge(&state, false));
+    ASSERT(cron_cond_update_edge(&state, true));
+    return 0;
+}
+
+TEST(polling_fires_only_on_edges)
+{
+    fake_env_t fake;
+    cron_cond_t cond;
+    char error[64];
+    cron_cond_state_t state = CRON_COND_STATE_UNKNOWN;
+    const int32_t door[] = {0, 0, 1, 1, 1, 0, 0, 1, 1, 0};
+    int fires = 0;
+
+    memset(&fake, 0, sizeof(fake));
+    ASSERT(cron_cond_compile("gpio(5)", 1, NULL, &cond, error, sizeof(error)));
+    cron_cond_env_t env = make_env(&fake, 12, 0, 1);
+
+    for (size_t i = 0; i < sizeof(door) / sizeof(door[0]); i++) {
+        bool value = false;
+        fake.levels[5] = door[i];
+        ASSERT(cron_cond_eval(&cond, &env, &value));
+        if (cron_cond_update_edge(&state, value)) {
+            fires++;
+        }
+    }
+    ASSERT(fake.gpio_reads == 10);
+    ASSERT(fires == 2);
+    return 0;
+}
+
+int test_cron_cond_all(void)
+{
+    int failures = 0;
+
+    printf("\nCron Condition Tests:\n");
+
+    printf("  compile_and_eval_gpio_time... ");
+    if (test_compile_and_eval_gpio_time() == 0) printf("OK\n"); else failures++;
+
+    printf("  operators_and_precedence... ");
+    if (test_operators_and_precedence() == 0) printf("OK\n"); else failures++;
+
+    printf("  memory_operands... ");
+    if (test_memory_operands() == 0) printf("OK\n"); else failures++;
+
+    printf("  compile_errors... ");
+    if (test_compile_errors() == 0) printf("OK\n"); else failures++;
+
+    printf("  rejects_corrupt_program... ");
+    if (test_rejects_corrupt_program() == 0) printf("OK\n"); else failures++;
+
+    printf("  edge_detection... ");
+    if (test_edge_detection() == 0) printf("OK\n"); else failures++;
+
+    printf("  polling_fires_only_on_edges... ");
+    if (test_polling_fires_only_on_edges() == 0) printf("OK\n"); else failures++;
+
+    return failures;
+}
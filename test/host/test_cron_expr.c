@@ -0,0 +1,232 @@
+/*
+ * Host tests for five-field cron expressions: parsing into bitmasks,
+ * canonical formatting, and next-occurrence search in the active TZ.
+ */
+
+#define _POSIX_C_SOURCE 200809L  // setenv/tzset
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "cron_expr.h"
+#include "cron_sched.h"
+
+#define TEST(name) static int test_##name(void)
+#define ASSERT(cond) do { \
+    if (!(cond)) { \
+        printf("  FAIL: %s (line %d)\n", #cond, __LINE__); \
+        return 1; \
+    } \
+} while(0)
+
+#define T_2024_01_01        1704067200LL   // Monday 2024-01-01 00:00:00 UTC
+#define T_2024_03_09        1709942400LL   // 2024-03-09 00:00:00 UTC (US DST starts 03-10)
+#define T_2025_03_01        1740787200LL   // 2025-03-01 00:00:00 UTC
+#define T_2028_02_29        1835395200LL   // 2028-02-29 00:00:00 UTC
+#define DAY                 86400LL
+
+static void set_tz(const char *tz)
+{
+    setenv("TZ", tz, 1);
+    tzset();
+}
+
+static int parse_ok(const char *text, cron_expr_t *expr)
+{
+    char error[64];
+    return cron_expr_parse(text, expr, error, sizeof(error));
+}
+
+static int round_trip(const char *text, const char *expected)
+{
+    cron_expr_t expr;
+    char buf[CRON_EXPR_MAX_LEN];
+
+    if (!parse_ok(text, &expr) || !cron_expr_format(&expr, buf, sizeof(buf))) {
+        return 0;
+    }
+    if (strcmp(buf, expected) != 0) {
+        printf("  round trip '%s' -> '%s' (expected '%s')\n", text, buf, expected);
+        return 0;
+    }
+    return 1;
+}
+
+TEST(parse_masks)
+{
+    cron_expr_t expr;
+
+    ASSERT(parse_ok("30 7 * * 1-5", &expr));
+    ASSERT(expr.minutes == ((uint64_t)1 << 30));
+    ASSERT(expr.hours == (1u << 7));
+    ASSERT(expr.weekdays == 0x3e);
+    ASSERT(expr.months == 0x1ffe);
+    ASSERT(expr.flags == (CRON_EXPR_FLAG_DOM_STAR));
+
+    ASSERT(parse_ok("*/15 9-17/4 1,15 JAN-mar sun,7", &expr));
+    ASSERT(expr.minutes == (((uint64_t)1 << 0) | ((uint64_t)1 << 15) |
+                            ((uint64_t)1 << 30) | ((uint64_t)1 << 45)));
+    ASSERT(expr.hours == ((1u << 9) | (1u << 13) | (1u << 17)));
+    ASSERT(expr.days == ((1u << 1) | (1u << 15)));
+    ASSERT(expr.months == 0x0e);
+    ASSERT(expr.weekdays == 0x01);
+    ASSERT(expr.flags == 0);
+
+    ASSERT(parse_ok("@weekly", &expr));
+    ASSERT(expr.minutes == 1 && expr.hours == 1 && expr.weekdays == 0x01);
+    return 0;
+}
+
+TEST(parse_errors)
+{
+    cron_expr_t expr;
+    char error[64];
+
+    ASSERT(!cron_expr_parse("* * * *", &expr, error, sizeof(error)));
+    ASSERT(strstr(error, "5 fields") != NULL);
+    ASSERT(!cron_expr_parse("* * * * * *", &expr, error, sizeof(error)));
+    ASSERT(!cron_expr_parse("60 * * * *", &expr, error, sizeof(error)));
+    ASSERT(strstr(error, "minute") != NULL);
+    ASSERT(!cron_expr_parse("* 24 * * *", &expr, error, sizeof(error)));
+    ASSERT(!cron_expr_parse("* * 0 * *", &expr, error, sizeof(error)));
+    ASSERT(!cron_expr_parse("* * * 13 *", &expr, error, sizeof(error)));
+    ASSERT(!cron_expr_parse("* * * * 8", &expr, error, sizeof(error)));
+    ASSERT(!cron_expr_parse("5-1 * * * *", &expr, error, sizeof(error)));
+    ASSERT(!cron_expr_parse("*/0 * * * *", &expr, error, sizeof(error)));
+    ASSERT(!cron_expr_parse("1,,2 * * * *", &expr, error, sizeof(error)));
+    ASSERT(!cron_expr_parse("* * * FOO *", &expr, error, sizeof(error)));
+    ASSERT(!cron_expr_parse("@reboot", &expr, error, sizeof(error)));
+    ASSERT(!cron_expr_parse(NULL, &expr, error, sizeof(error)));
+    return 0;
+}
+
+TEST(format_round_trip)
+{
+    ASSERT(round_trip("30 7 * * 1-5", "30 7 * * 1-5"));
+    ASSERT(round_trip("*/15 9-17 * * *", "*/15 9-17 * * *"));
+    ASSERT(round_trip("0,15,30,45 * * * *", "*/15 * * * *"));
+    ASSERT(round_trip("0 0 1,15 JAN-MAR SUN", "0 0 1,15 1-3 0"));
+    ASSERT(round_trip("5 4 * * 7", "5 4 * * 0"));
+    ASSERT(round_trip("0-59 0-23 1-31 1-12 0-6", "* * 1-31 * 0-6"));
+    ASSERT(round_trip("@monthly", "0 0 1 * *"));
+
+    cron_expr_t empty;
+    char buf[CRON_EXPR_MAX_LEN];
+    memset(&empty, 0, sizeof(empty));
+    ASSERT(!cron_expr_is_valid(&empty));
+    ASSERT(!cron_expr_format(&empty, buf, sizeof(buf)));
+    return 0;
+}
+
+TEST(next_weekdays)
+{
+    cron_expr_t expr;
+
+    set_tz("UTC0");
+    ASSERT(parse_ok("30 7 * * 1-5", &expr));
+    // Monday 00:00 -> Monday 07:30.
+    ASSERT(cron_expr_next(&expr, T_2024_01_01) == T_2024_01_01 + 7 * 3600 + 30 * 60);
+    // Exactly at a match: strictly after, so Tuesday.
+    ASSERT(cron_expr_next(&expr, T_2024_01_01 + 7 * 3600 + 30 * 60) ==
+           T_2024_01_01 + DAY + 7 * 3600 + 30 * 60);
+    // Friday 08:00 -> next Monday.
+    ASSERT(cron_expr_next(&expr, T_2024_01_01 + 4 * DAY + 8 * 3600) ==
+           T_2024_01_01 + 7 * DAY + 7 * 3600 + 30 * 60);
+
+    ASSERT(parse_ok("*/15 9-17 * * *", &expr));
+    ASSERT(cron_expr_next(&expr, T_2024_01_01 + 17 * 3600 + 45 * 60) ==
+           T_2024_01_01 + DAY + 9 * 3600);
+    ASSERT(cron_expr_next(&expr, T_2024_01_01 + 9 * 3600 + 1) ==
+           T_2024_01_01 + 9 * 3600 + 15 * 60);
+    return 0;
+}
+
+TEST(next_leap_day_and_dom_dow_or)
+{
+    cron_expr_t expr;
+
+    set_tz("UTC0");
+    ASSERT(parse_ok("0 12 29 2 *", &expr));
+    ASSERT(cron_expr_next(&expr, T_2025_03_01) == T_2028_02_29 + 12 * 3600);
+
+    // Both restricted: the 13th OR any Friday. 2024-01-05 is the first Friday.
+    ASSERT(parse_ok("0 0 13 * 5", &expr));
+    ASSERT(cron_expr_next(&expr, T_2024_01_01) == T_2024_01_01 + 4 * DAY);
+    ASSERT(cron_expr_next(&expr, T_2024_01_01 + 11 * DAY) == T_2024_01_01 + 12 * DAY);
+
+    // Day-of-month 31 only in months that have it.
+    ASSERT(parse_ok("0 0 31 * *", &expr));
+    ASSERT(cron_expr_next(&expr, T_2024_01_01 + 31 * DAY) ==
+           T_2024_01_01 + (31 + 29 + 30) * DAY);
+    return 0;
+}
+
+TEST(next_across_dst)
+{
+    cron_expr_t expr;
+
+    set_tz("PST8PDT,M3.2.0,M11.1.0");
+    ASSERT(parse_ok("0 9 * * *", &expr));
+    int64_t first = cron_expr_next(&expr, T_2024_03_09);
+    int64_t second = cron_expr_next(&expr, first);
+    ASSERT(first == T_2024_03_09 + 17 * 3600);          // 09:00 PST
+    ASSERT(second == T_2024_03_09 + DAY + 16 * 3600);   // 09:00 PDT
+    set_tz("UTC0");
+    return 0;
+}
+
+TEST(sched_uses_expression)
+{
+    cron_entry_t entry;
+    cron_expr_t expr;
+    const int64_t seven_thirty = T_2024_01_01 + 7 * 3600 + 30 * 60;
+
+    set_tz("UTC0");
+    ASSERT(parse_ok("30 7 * * 1-5", &expr));
+    memset(&entry, 0, sizeof(entry));
+    entry.id = 1;
+    entry.type = CRON_TYPE_EXPR;
+    entry.enabled = true;
+
+    ASSERT(cron_sched_next_fire(&entry, &expr, T_2024_01_01, false) == CRON_SCHED_NEVER);
+    ASSERT(cron_sched_next_fire(&entry, NULL, T_2024_01_01, true) == CRON_SCHED_NEVER);
+    ASSERT(cron_sched_next_fire(&entry, &expr, T_2024_01_01, true) == seven_thirty);
+    // Woken late inside the matching minute: fire now.
+    ASSERT(cron_sched_next_fire(&entry, &expr, seven_thirty + 5, true) == seven_thirty + 5);
+    // Already ran this minute: next weekday.
+    entry.last_run = (uint32_t)(seven_thirty + 5);
+    ASSERT(cron_sched_next_fire(&entry, &expr, seven_thirty + 6, true) == seven_thirty + DAY);
+    return 0;
+}
+
+int test_cron_expr_all(void)
+{
+    int failures = 0;
+
+    printf("\nCron Expression Tests:\n");
+
+    printf("  parse_masks... ");
+    if (test_parse_masks() == 0) printf("OK\n"); else failures++;
+
+    printf("  parse_errors... ");
+    if (test_parse_errors() == 0) printf("OK\n"); else failures++;
+
+    printf("  format_round_trip... ");
+    if (test_format_round_trip() == 0) printf("OK\n"); else failures++;
+
+    printf("  next_weekdays... ");
+    if (test_next_weekdays() == 0) printf("OK\n"); else failures++;
+
+    printf("  next_leap_day_and_dom_dow_or... ");
+    if (test_next_leap_day_and_dom_dow_or() == 0) printf("OK\n"); else failures++;
+
+    printf("  next_across_dst... ");
+    if (test_next_across_dst() == 0) printf("OK\n"); else failures++;
+
+    printf("  sched_uses_expression... ");
+    if (test_sched_uses_expression() == 0) printf("OK\n"); else failures++;
+
+    return failures;
+}
@@ -0,0 +1,250 @@
+/*
+ * Host tests for the cron scheduling core (next-fire times + min-heap),
+ * driven by a virtual clock instead of the FreeRTOS tick.
+ */
+
+#define _POSIX_C_SOURCE 200809L  // setenv/tzset
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "cron_sched.h"
+
+#define TEST(name) static int test_##name(void)
+#define ASSERT(cond) do { \
+    if (!(cond)) { \
+        printf("  FAIL: %s (line %d)\n", #cond, __LINE__); \
+        return 1; \
+    } \
+} while(0)
+
+#define T_2024_01_01        1704067200LL   // 2024-01-01 00:00:00 UTC
+#define T_2024_03_09        1709942400LL   // 2024-03-09 00:00:00 UTC (US DST starts 03-10)
+
+typedef struct {
+    uint8_t slot;
+    int64_t at;
+} fire_record_t;
+
+static void set_tz(const char *tz)
+{
+    setenv("TZ", tz, 1);
+    tzset();
+}
+
+static cron_entry_t make_entry(uint8_t id, cron_type_t type, uint16_t interval_or_hour,
+                               uint8_t minute, uint32_t last_run)
+{
+    cron_entry_t entry;
+    memset(&entry, 0, sizeof(entry));
+    entry.id = id;
+    entry.type = type;
+    entry.enabled = true;
+    entry.last_run = last_run;
+    if (type == CRON_TYPE_DAILY) {
+        entry.hour = (uint8_t)interval_or_hour;
+        entry.minute = minute;
+    } else {
+        entry.interval_minutes = interval_or_hour;
+    }
+    return entry;
+}
+
+// Mirror of cron.c's task loop on a virtual clock: sleep exactly as long as the
+// scheduler asks, fire what is due, reschedule. Returns the number of fires.
+static size_t run_virtual(cron_entry_t *entries, size_t entry_count, int64_t start, int64_t end,
+                          fire_record_t *fires, size_t max_fires, size_t *wakeups_out)
+{
+    cron_sched_t sched;
+    int64_t now = start;
+    size_t fire_count = 0;
+    size_t wakeups = 0;
+
+    cron_sched_rebuild(&sched, entries, NULL, entry_count, now, true);
+
+    while (now <= end) {
+        cron_sched_node_t node;
+        while (cron_sched_peek(&sched, &node) && node.due <= now) {
+            cron_sched_pop(&sched, NULL);
+            cron_entry_t *entry = &entries[node.slot];
+            if (fire_count < max_fires) {
+                fires[fire_count].slot = node.slot;
+                fires[fire_count].at = now;
+            }
+            fire_count++;
+            if (entry->type == CRON_TYPE_ONCE) {
+                entry->id = 0;
+                continue;
+            }
+            entry->last_run = (uint32_t)now;
+            cron_sched_push(&sched, node.slot, cron_sched_next_fire(entry, NULL, now, true));
+        }
+
+        uint32_t wait_ms = cron_sched_wait_ms(&sched, now, CRON_MAX_SLEEP_MS);
+        now += wait_ms / 1000;
+        wakeups++;
+    }
+
+    if (wakeups_out) {
+        *wakeups_out = wakeups;
+    }
+    return fire_count;
+}
+
+TEST(heap_orders_and_removes)
+{
+    cron_sched_t sched;
+    cron_sched_node_t node;
+    const int64_t dues[] = {500, 100, 400, 100, 300, 200};
+
+    cron_sched_clear(&sched);
+    for (uint8_t i = 0; i < 6; i++) {
+        ASSERT(cron_sched_push(&sched, i, dues[i]));
+    }
+    ASSERT(!cron_sched_push(&sched, 7, CRON_SCHED_NEVER));
+    ASSERT(cron_sched_remove(&sched, 4));
+    ASSERT(!cron_sched_remove(&sched, 4));
+
+    ASSERT(cron_sched_pop(&sched, &node) && node.due == 100 && node.slot == 1);
+    ASSERT(cron_sched_pop(&sched, &node) && node.due == 100 && node.slot == 3);
+    ASSERT(cron_sched_pop(&sched, &node) && node.due == 200);
+    ASSERT(cron_sched_pop(&sched, &node) && node.due == 400);
+    ASSERT(cron_sched_pop(&sched, &node) && node.due == 500);
+    ASSERT(!cron_sched_pop(&sched, &node));
+    return 0;
+}
+
+TEST(heap_capacity)
+{
+    cron_sched_t sched;
+    cron_sched_clear(&sched);
+    for (int i = 0; i < CRON_MAX_ENTRIES; i++) {
+        ASSERT(cron_sched_push(&sched, (uint8_t)i, 1000 - i));
+    }
+    ASSERT(!cron_sched_push(&sched, 99, 1));
+    return 0;
+}
+
+TEST(next_fire_periodic_and_once)
+{
+    cron_entry_t fresh = make_entry(1, CRON_TYPE_PERIODIC, 5, 0, 0);
+    cron_entry_t ran = make_entry(2, CRON_TYPE_PERIODIC, 5, 0, 1000);
+    cron_entry_t once = make_entry(3, CRON_TYPE_ONCE, 1, 0, 1000);
+    cron_entry_t disabled = make_entry(4, CRON_TYPE_PERIODIC, 5, 0, 1000);
+    cron_entry_t condition = make_entry(5, CRON_TYPE_CONDITION, 5, 0, 0);
+    disabled.enabled = false;
+
+    ASSERT(cron_sched_next_fire(&fresh, NULL, 2000, false) == 2000);
+    ASSERT(cron_sched_next_fire(&ran, NULL, 1100, false) == 1300);
+    ASSERT(cron_sched_next_fire(&ran, NULL, 5000, false) == 5000);
+    ASSERT(cron_sched_next_fire(&once, NULL, 1001, false) == 1060);
+    ASSERT(cron_sched_next_fire(&disabled, NULL, 1100, false) == CRON_SCHED_NEVER);
+    ASSERT(cron_sched_next_fire(&condition, NULL, 1100, false) == CRON_SCHED_NEVER);
+    return 0;
+}
+
+TEST(next_fire_daily_utc)
+{
+    const int64_t nine_am = T_2024_01_01 + 9 * 3600;
+    cron_entry_t daily = make_entry(1, CRON_TYPE_DAILY, 9, 0, 0);
+
+    set_tz("UTC0");
+    ASSERT(cron_sched_next_fire(&daily, NULL, nine_am - 30, false) == CRON_SCHED_NEVER);
+    ASSERT(cron_sched_next_fire(&daily, NULL, nine_am - 30, true) == nine_am);
+    // Still inside the scheduled minute and not yet run: fire immediately.
+    ASSERT(cron_sched_next_fire(&daily, NULL, nine_am + 20, true) == nine_am + 20);
+    // Minute already over: tomorrow.
+    ASSERT(cron_sched_next_fire(&daily, NULL, nine_am + 61, true) == nine_am + 86400);
+    // Already ran today: tomorrow.
+    daily.last_run = (uint32_t)(nine_am + 1);
+    ASSERT(cron_sched_next_fire(&daily, NULL, nine_am + 2, true) == nine_am + 86400);
+    return 0;
+}
+
+TEST(virtual_clock_fires_to_the_second)
+{
+    const int64_t t0 = T_2024_01_01 + 17;
+    cron_entry_t entries[3];
+    fire_record_t fires[16];
+    size_t wakeups = 0;
+
+    entries[0] = make_entry(1, CRON_TYPE_PERIODIC, 1, 0, 0);
+    entries[1] = make_entry(2, CRON_TYPE_ONCE, 1, 0, (uint32_t)(t0 + 10));
+    memset(&entries[2], 0, sizeof(entries[2]));
+
+    set_tz("UTC0");
+    size_t count = run_virtual(entries, 3, t0, t0 + 150, fires, 16, &wakeups);
+
+    ASSERT(count == 4);
+    ASSERT(fires[0].slot == 0 && fires[0].at == t0);
+    ASSERT(fires[1].slot == 0 && fires[1].at == t0 + 60);
+    ASSERT(fires[2].slot == 1 && fires[2].at == t0 + 70);
+    ASSERT(fires[3].slot == 0 && fires[3].at == t0 + 120);
+    // One wakeup per deadline plus the final sleep past the window; no polling.
+    ASSERT(wakeups == 4);
+    ASSERT(entries[1].id == 0);
+    return 0;
+}
+
+TEST(virtual_clock_daily_across_dst)
+{
+    cron_entry_t entries[1];
+    fire_record_t fires[4];
+
+    entries[0] = make_entry(1, CRON_TYPE_DAILY, 9, 0, 0);
+
+    set_tz("PST8PDT,M3.2.0,M11.1.0");
+    size_t count = run_virtual(entries, 1, T_2024_03_09, T_2024_03_09 + 2 * 86400, fires, 4, NULL);
+    set_tz("UTC0");
+
+    ASSERT(count == 2);
+    ASSERT(fires[0].at == T_2024_03_09 + 17 * 3600);            // 09:00 PST = 17:00 UTC
+    ASSERT(fires[1].at == T_2024_03_09 + 86400 + 16 * 3600);    // 09:00 PDT = 16:00 UTC
+    ASSERT(fires[1].at - fires[0].at == 23 * 3600);
+    return 0;
+}
+
+TEST(wait_ms_clamps)
+{
+    cron_sched_t sched;
+    cron_sched_clear(&sched);
+    ASSERT(cron_sched_wait_ms(&sched, 0, 5000) == 5000);
+
+    cron_sched_push(&sched, 0, 100);
+    ASSERT(cron_sched_wait_ms(&sched, 100, 5000) == 0);
+    ASSERT(cron_sched_wait_ms(&sched, 98, 5000) == 2000);
+    ASSERT(cron_sched_wait_ms(&sched, 0, 5000) == 5000);
+    return 0;
+}
+
+int test_cron_sched_all(void)
+{
+    int failures = 0;
+
+    printf("\nCron Scheduler Tests:\n");
+
+    printf("  heap_orders_and_removes... ");
+    if (test_heap_orders_and_removes() == 0) printf("OK\n"); else failures++;
+
+    printf("  heap_capacity... ");
+    if (test_heap_capacity() == 0) printf("OK\n"); else failures++;
+
+    printf("  next_fire_periodic_and_once... ");
+    if (test_next_fire_periodic_and_once() == 0) printf("OK\n"); else failures++;
+
+    printf("  next_fire_daily_utc... ");
+    if (test_next_fire_daily_utc() == 0) printf("OK\n"); else failures++;
+
+    printf("  virtual_clock_fires_to_the_second... ");
+    if (test_virtual_clock_fires_to_the_second() == 0) printf("OK\n"); else failures++;
+
+    printf("  virtual_clock_daily_across_dst... ");
+    if (test_virtual_clock_daily_across_dst() == 0) printf("OK\n"); else failures++;
+
+    printf("  wait_ms_clamps... ");
+    if (test_wait_ms_clamps() == 0) printf("OK\n"); else failures++;
+
+    return failures;
+}
@@ -0,0 +1,277 @@
+/*
+ * Host tests for the int8 embedding index used by memory recall:
+ * quantization accuracy, dot product, top-k search, sweeps and the flash
+ * record codec.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "config.h"
+#include "embed_index.h"
+
+#define TEST(name) static int test_##name(void)
+#define ASSERT(cond) do { \
+    if (!(cond)) { \
+        printf("  FAIL: %s (line %d)\n", #cond, __LINE__); \
+        return 1; \
+    } \
+} while(0)
+
+static unsigned s_seed = 1;
+
+static float next_float(void)
+{
+    s_seed = s_seed * 1103515245U + 12345U;
+    return (float)((s_seed >> 8) & 0xFFFF) / 32768.0f - 1.0f;
+}
+
+static void random_vector(float *out)
+{
+    for (size_t i = 0; i < EMBED_DIM; i++) {
+        out[i] = next_float();
+    }
+}
+
+static float float_cosine(const float *a, const float *b)
+{
+    double dot = 0.0;
+    double na = 0.0;
+    double nb = 0.0;
+    for (size_t i = 0; i < EMBED_DIM; i++) {
+        dot += (double)a[i] * b[i];
+        na += (double)a[i] * a[i];
+        nb += (double)b[i] * b[i];
+    }
+    return (float)(dot / sqrt(na * nb));
+}
+
+// Vector pointing mostly along axis, with a little noise.
+static void axis_vector(float *out, size_t axis, float noise)
+{
+    for (size_t i = 0; i < EMBED_DIM; i++) {
+        out[i] = noise * next_float();
+    }
+    out[axis] += 1.0f;
+}
+
+static bool put_float(const char *key, const float *vec)
+{
+    int8_t q[EMBED_DIM];
+    float scale;
+    embed_quantize(vec, q, &scale);
+    return embed_index_put(key, embed_hash(key), q, scale);
+}
+
+static int s_removed = 0;
+
+static void count_removed(const char *key, void *ctx)
+{
+    (void)key;
+    (void)ctx;
+    s_removed++;
+}
+
+TEST(quantized_cosine_tracks_float)
+{
+    float a[EMBED_DIM];
+    float b[EMBED_DIM];
+    int8_t qa[EMBED_DIM];
+    int8_t qb[EMBED_DIM];
+    float sa;
+    float sb;
+
+    s_seed = 7;
+    for (int round = 0; round < 50; round++) {
+        random_vector(a);
+        // Mix of related and unrelated pairs.
+        for (size_t i = 0; i < EMBED_DIM; i++) {
+            b[i] = (round % 2 ? 0.8f * a[i] : 0.0f) + next_float();
+        }
+        embed_quantize(a, qa, &sa);
+        embed_quantize(b, qb, &sb);
+        float approx = (float)embed_dot_s8(qa, qb, EMBED_DIM) * sa * sb;
+        ASSERT(fabsf(approx - float_cosine(a, b)) < 0.02f);
+    }
+
+    // Self-similarity is ~1 regardless of input magnitude.
+    for (size_t i = 0; i < EMBED_DIM; i++) {
+        a[i] *= 1000.0f;
+    }
+    embed_quantize(a, qa, &sa);
+    ASSERT(fabsf((float)embed_dot_s8(qa, qa, EMBED_DIM) * sa * sa - 1.0f) < 0.01f);
+
+    memset(a, 0, sizeof(a));
+    embed_quantize(a, qa, &sa);
+    ASSERT(sa == 0.0f);
+    return 0;
+}
+
+TEST(dot_matches_reference)
+{
+    int8_t a[EMBED_DIM];
+    int8_t b[EMBED_DIM];
+
+    s_seed = 3;
+    for (size_t i = 0; i < EMBED_DIM; i++) {
+        a[i] = (int8_t)(next_float() * 127.0f);
+        b[i] = (int8_t)(next_float() * 127.0f);
+    }
+    // Short, odd and full-length inputs.
+    for (size_t len = 0; len <= 37; len++) {
+        int32_t expected = 0;
+        for (size_t i = 0; i < len; i++) {
+            expected += (int32_t)a[i] * b[i];
+        }
+        ASSERT(embed_dot_s8(a, b, len) == expected);
+    }
+
+    memset(a, -127, sizeof(a));
+    memset(b, -127, sizeof(b));
+    ASSERT(embed_dot_s8(a, b, EMBED_DIM) == 127 * 127 * EMBED_DIM);
+    return 0;
+}
+
+TEST(search_returns_best_matches_first)
+{
+    float vec[EMBED_DIM];
+    int8_t query[EMBED_DIM];
+    float query_scale;
+    embed_match_t matches[3];
+
+    ASSERT(embed_index_init(NULL));
+    s_seed = 11;
+    axis_vector(vec, 0, 0.01f);
+    ASSERT(put_float("u_wifi", vec));
+    axis_vector(vec, 1, 0.01f);
+    ASSERT(put_float("u_birthday", vec));
+    // Partly along the wifi axis.
+    axis_vector(vec, 0, 0.01f);
+    vec[2] += 1.0f;
+    ASSERT(put_float("u_router", vec));
+    axis_vector(vec, 3, 0.01f);
+    ASSERT(put_float("u_plants", vec));
+
+    axis_vector(vec, 0, 0.01f);
+    embed_quantize(vec, query, &query_scale);
+    size_t found = embed_index_search(query, query_scale, 0.3f, matches, 3);
+    ASSERT(found == 2);
+    ASSERT(strcmp(matches[0].key, "u_wifi") == 0 && matches[0].score > 0.9f);
+    ASSERT(strcmp(matches[1].key, "u_router") == 0);
+    ASSERT(matches[1].score > 0.5f && matches[1].score < 0.8f);
+
+    // k caps the list; no floor returns the rest in order.
+    found = embed_index_search(query, query_scale, -1.0f, matches, 3);
+    ASSERT(found == 3);
+    ASSERT(matches[0].score >= matches[1].score && matches[1].score >= matches[2].score);
+    ASSERT(embed_index_search(query, 0.0f, -1.0f, matches, 3) == 0);
+
+    embed_index_deinit();
+    return 0;
+}
+
+TEST(put_replace_remove_and_sweep)
+{
+    float vec[EMBED_DIM];
+    char key[24];
+    uint32_t hash;
+
+    ASSERT(embed_index_init(NULL));
+    s_seed = 5;
+    for (int i = 0; i < EMBED_INDEX_MAX_ENTRIES; i++) {
+        snprintf(key, sizeof(key), "u_k%d", i);
+        random_vector(vec);
+        ASSERT(put_float(key, vec));
+    }
+    ASSERT(embed_index_count() == EMBED_INDEX_MAX_ENTRIES);
+    random_vector(vec);
+    ASSERT(!put_float("u_overflow", vec));
+
+    // Replacing keeps the count and updates the hash.
+    int8_t q[EMBED_DIM] = {0};
+    ASSERT(embed_index_put("u_k0", 42, q, 1.0f));
+    ASSERT(embed_index_count() == EMBED_INDEX_MAX_ENTRIES);
+    ASSERT(embed_index_lookup("u_k0", &hash) && hash == 42);
+
+    ASSERT(embed_index_remove("u_k1"));
+    ASSERT(!embed_index_remove("u_k1"));
+    ASSERT(!embed_index_lookup("u_k1", NULL));
+
+    // Only touched keys survive a sweep.
+    embed_index_mark_all();
+    embed_index_touch("u_k0");
+    embed_index_touch("u_k2");
+    ASSERT(embed_index_put("u_new", 7, q, 1.0f));
+    s_removed = 0;
+    ASSERT(embed_index_sweep(count_removed, NULL) == (size_t)EMBED_INDEX_MAX_ENTRIES - 3);
+    ASSERT(s_removed == EMBED_INDEX_MAX_ENTRIES - 3);
+    ASSERT(embed_index_count() == 3);
+    ASSERT(embed_index_lookup("u_k0", NULL) && embed_index_lookup("u_k2", NULL) &&
+           embed_index_lookup("u_new", NULL));
+
+    embed_index_deinit();
+    ASSERT(!embed_index_lookup("u_k0", NULL));
+    return 0;
+}
+
+TEST(record_roundtrip_and_rejects_garbage)
+{
+    static char record[EMBED_RECORD_MAX_LEN];
+    float vec[EMBED_DIM];
+    int8_t q[EMBED_DIM];
+    int8_t decoded[EMBED_DIM];
+    char key[EMBED_KEY_LEN];
+    const char *long_key = "u_the_name_of_the_neighbours_dog_and_the_vet_appointment_time";
+    uint32_t hash;
+    float scale;
+    float decoded_scale;
+
+    s_seed = 9;
+    random_vector(vec);
+    embed_quantize(vec, q, &scale);
+    size_t len = embed_record_encode(long_key, 0xDEADBEEF, q, scale, record, sizeof(record));
+    ASSERT(len > 0 && len == strlen(record));
+    ASSERT(embed_record_decode(record, key, sizeof(key), &hash, decoded, &decoded_scale));
+    ASSERT(strcmp(key, long_key) == 0);
+    ASSERT(hash == 0xDEADBEEF);
+    ASSERT(decoded_scale == scale);
+    ASSERT(memcmp(decoded, q, sizeof(q)) == 0);
+
+    ASSERT(embed_record_encode(long_key, 1, q, scale, record, sizeof(record) - 1) == 0);
+    ASSERT(!embed_record_decode("v1 zz", key, sizeof(key), &hash, decoded, &decoded_scale));
+    ASSERT(!embed_record_decode("v2 00000000 00000000 ", key, sizeof(key), &hash, decoded,
+                                &decoded_scale));
+    embed_record_encode("u_a", 1, q, scale, record, sizeof(record));
+    record[40] = 'x';
+    ASSERT(!embed_record_decode(record, key, sizeof(key), &hash, decoded, &decoded_scale));
+    embed_record_encode("u_a", 1, q, scale, record, sizeof(record));
+    record[strlen(record) - 4] = '\0';
+    ASSERT(!embed_record_decode(record, key, sizeof(key), &hash, decoded, &decoded_scale));
+    return 0;
+}
+
+int test_embed_index_all(void)
+{
+    int failures = 0;
+
+    printf("\nEmbed Index Tests:\n");
+
+    printf("  quantized_cosine_tracks_float... ");
+    if (test_quantized_cosine_tracks_float() == 0) printf("OK\n"); else failures++;
+
+    printf("  dot_matches_reference... ");
+    if (test_dot_matches_reference() == 0) printf("OK\n"); else failures++;
+
+    printf("  search_returns_best_matches_first... ");
+    if (test_search_returns_best_matches_first() == 0) printf("OK\n"); else failures++;
+
+    printf("  put_replace_remove_and_sweep... ");
+    if (test_put_replace_remove_and_sweep() == 0) printf("OK\n"); else failures++;
+
+    printf("  record_roundtrip_and_rejects_garbage... ");
+    if (test_record_roundtrip_and_rejects_garbage() == 0) printf("OK\n"); else failures++;
+
+    return failures;
+}
@@ -9,6 +9,7 @@
 
 #include "json_util.h"
 #include "tools.h"
+#include "tools_media.h"
 #include "mock_llm.h"
 #include "mock_esp.h"
 
@@ -283,6 +284,126 @@ TEST(parse_api_error)
     return 0;
 }
 
+TEST(parsed_usage_for_both_formats)
+{
+    char text[64] = {0};
+    char tool_name[32] = {0};
+    char tool_id[64] = {0};
+    cJSON *tool_input = NULL;
+    uint32_t input_tokens = 0;
+    uint32_t output_tokens = 0;
+
+    mock_llm_set_backend(LLM_BACKEND_OPENAI, "gpt-test-model");
+    ASSERT(json_parse_response("{\"choices\":[{\"message\":{\"content\":\"hi\"}}],"
+                               "\"usage\":{\"prompt_tokens\":900,\"completion_tokens\":12}}",
+                               text, sizeof(text), tool_name, sizeof(tool_name),
+                               tool_id, sizeof(tool_id), &tool_input));
+    ASSERT(json_get_parsed_usage(&input_tokens, &output_tokens));
+    ASSERT(input_tokens == 900 && output_tokens == 12);
+
+    // Anthropic prompt-cache reads and writes count as input.
+    mock_llm_set_backend(LLM_BACKEND_ANTHROPIC, "claude-test-model");
+    ASSERT(json_parse_response("{\"content\":[{\"type\":\"text\",\"text\":\"hi\"}],"
+                               "\"usage\":{\"input_tokens\":40,\"output_tokens\":7,"
+                               "\"cache_creation_input_tokens\":500,"
+                               "\"cache_read_input_tokens\":1000}}",
+                               text, sizeof(text), tool_name, sizeof(tool_name),
+                               tool_id, sizeof(tool_id), &tool_input));
+    ASSERT(json_get_parsed_usage(&input_tokens, &output_tokens));
+    ASSERT(input_tokens == 1540 && output_tokens == 7);
+
+    ASSERT(json_parse_response("{\"content\":[{\"type\":\"text\",\"text\":\"hi\"}]}",
+                               text, sizeof(text), tool_name, sizeof(tool_name),
+                               tool_id, sizeof(tool_id), &tool_input));
+    ASSERT(!json_get_parsed_usage(&input_tokens, &output_tokens));
+    json_free_parsed_response();
+    ASSERT(!json_get_parsed_usage(&input_tokens, &output_tokens));
+    return 0;
+}
+
+TEST(build_embeddings_request)
+{
+    const char *inputs[] = { "where is the router?", "wifi_room: office" };
+
+    ASSERT(json_build_embeddings_request("embed-model", inputs, 0) == NULL);
+    char *request = json_build_embeddings_request("embed-model", inputs, 2);
+    ASSERT(request != NULL);
+
+    cJSON *root = cJSON_Parse(request);
+    ASSERT(root != NULL);
+    ASSERT_STR_EQ(cJSON_GetObjectItem(root, "model")->valuestring, "embed-model");
+    ASSERT(cJSON_GetObjectItem(root, "dimensions")->valueint == EMBED_DIM);
+    ASSERT_STR_EQ(cJSON_GetObjectItem(root, "encoding_format")->valuestring, "base64");
+    cJSON *input = cJSON_GetObjectItem(root, "input");
+    ASSERT(cJSON_GetArraySize(input) == 2);
+    ASSERT_STR_EQ(cJSON_GetArrayItem(input, 1)->valuestring, "wifi_room: office");
+
+    cJSON_Delete(root);
+    free(request);
+    return 0;
+}
+
+TEST(parse_embeddings_base64_and_arrays)
+{
+    static float expected[EMBED_DIM];
+    static float out[2 * EMBED_DIM];
+    uint8_t bytes[EMBED_DIM * 4];
+    size_t b64_len = 0;
+    uint32_t prompt_tokens = 0;
+
+    for (size_t i = 0; i < EMBED_DIM; i++) {
+        expected[i] = (float)i / 64.0f - 2.0f;
+        uint32_t word;
+        memcpy(&word, &expected[i], sizeof(word));
+        bytes[i * 4] = (uint8_t)word;
+        bytes[i * 4 + 1] = (uint8_t)(word >> 8);
+        bytes[i * 4 + 2] = (uint8_t)(word >> 16);
+        bytes[i * 4 + 3] = (uint8_t)(word >> 24);
+    }
+    char *b64 = media_test_base64_encode(bytes, sizeof(bytes), &b64_len);
+    ASSERT(b64 != NULL);
+
+    // Entries out of order: one base64, one numeric array.
+    cJSON *root = cJSON_CreateObject();
+    cJSON *data = cJSON_AddArrayToObject(root, "data");
+    cJSON *second = cJSON_CreateObject();
+    cJSON_AddNumberToObject(second, "index", 1);
+    cJSON_AddStringToObject(second, "embedding", b64);
+    cJSON_AddItemToArray(data, second);
+    cJSON *first = cJSON_CreateObject();
+    cJSON_AddNumberToObject(first, "index", 0);
+    cJSON *numbers = cJSON_AddArrayToObject(first, "embedding");
+    for (size_t i = 0; i < EMBED_DIM; i++) {
+        cJSON_AddItemToArray(numbers, cJSON_CreateNumber(expected[i]));
+    }
+    cJSON_AddItemToArray(data, first);
+    cJSON *usage = cJSON_AddObjectToObject(root, "usage");
+    cJSON_AddNumberToObject(usage, "prompt_tokens", 17);
+    cJSON_AddNumberToObject(usage, "total_tokens", 17);
+    char *json = cJSON_PrintUnformatted(root);
+    cJSON_Delete(root);
+    free(b64);
+    ASSERT(json != NULL);
+
+    ASSERT(json_parse_embeddings(json, out, 2, &prompt_tokens) == 2);
+    ASSERT(prompt_tokens == 17);
+    ASSERT(memcmp(&out[EMBED_DIM], expected, sizeof(expected)) == 0);
+    for (size_t i = 0; i < EMBED_DIM; i++) {
+        ASSERT(out[i] == expected[i]);
+    }
+    // More entries than the caller asked for is malformed.
+    ASSERT(json_parse_embeddings(json, out, 1, NULL) == -1);
+    free(json);
+
+    ASSERT(json_parse_embeddings("{\"error\":{\"message\":\"bad key\"}}", out, 2, NULL) == -1);
+    ASSERT(json_parse_embeddings("{\"data\":[{\"index\":0,\"embedding\":\"AAAA\"}]}", out, 2, NULL) == -1);
+    ASSERT(json_parse_embeddings("{\"data\":[{\"index\":0,\"embedding\":[1,2]}]}", out, 2, NULL) == -1);
+    ASSERT(json_parse_embeddings("not json", out, 2, NULL) == -1);
+    ASSERT(json_parse_embeddings("{\"data\":[]}", out, 2, &prompt_tokens) == 0);
+    ASSERT(prompt_tokens == 0);
+    return 0;
+}
+
 int test_json_util_integration_all(void)
 {
     int failures = 0;
@@ -338,5 +459,26 @@ int test_json_util_integration_all(void)
         failures++;
     }
 
+    printf("  build_embeddings_request... ");
+    if (test_build_embeddings_request() == 0) {
+        printf("OK\n");
+    } else {
+        failures++;
+    }
+
+    printf("  parsed_usage_for_both_formats... ");
+    if (test_parsed_usage_for_both_formats() == 0) {
+        printf("OK\n");
+    } else {
+        failures++;
+    }
+
+    printf("  parse_embeddings_base64_and_arrays... ");
+    if (test_parse_embeddings_base64_and_arrays() == 0) {
+        printf("OK\n");
+    } else {
+        failures++;
+    }
+
     return failures;
 }
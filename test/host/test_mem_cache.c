@@ -0,0 +1,248 @@
+/*
+ * Host tests for the memory layer's RAM cache: hits, absent entries, LRU and
+ * byte-budget eviction, and the key index used by memory_list.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "config.h"
+#include "mem_cache.h"
+
+#define TEST(name) static int test_##name(void)
+#define ASSERT(cond) do { \
+    if (!(cond)) { \
+        printf("  FAIL: %s (line %d)\n", #cond, __LINE__); \
+        return 1; \
+    } \
+} while(0)
+
+static int s_allocs = 0;
+static int s_frees = 0;
+
+static void *counting_alloc(size_t size)
+{
+    s_allocs++;
+    return malloc(size);
+}
+
+static void counting_free(void *ptr)
+{
+    s_frees++;
+    free(ptr);
+}
+
+static void setup(size_t max_bytes)
+{
+    static const mem_cache_alloc_t alloc = { counting_alloc, counting_free };
+    mem_cache_init(&alloc, max_bytes);
+    s_allocs = 0;
+    s_frees = 0;
+}
+
+typedef struct {
+    char joined[256];
+    int stop_after;
+    int seen;
+} visit_ctx_t;
+
+static bool collect_key(const char *key, void *ctx)
+{
+    visit_ctx_t *visit = (visit_ctx_t *)ctx;
+    size_t used = strlen(visit->joined);
+    snprintf(visit->joined + used, sizeof(visit->joined) - used, "%s%s",
+             used > 0 ? "," : "", key);
+    visit->seen++;
+    return visit->stop_after == 0 || visit->seen < visit->stop_after;
+}
+
+TEST(hit_miss_and_absent)
+{
+    char buf[32];
+    mem_cache_stats_t stats;
+
+    setup(1024);
+    ASSERT(mem_cache_get("llm_model", buf, sizeof(buf)) == MEM_CACHE_MISS);
+
+    mem_cache_put("llm_model", "gpt-5-mini");
+    ASSERT(mem_cache_get("llm_model", buf, sizeof(buf)) == MEM_CACHE_HIT);
+    ASSERT(strcmp(buf, "gpt-5-mini") == 0);
+    ASSERT(mem_cache_get("llm_model", buf, 4) == MEM_CACHE_TOO_SMALL);
+
+    mem_cache_put("tg_chat_ids", NULL);
+    ASSERT(mem_cache_get("tg_chat_ids", buf, sizeof(buf)) == MEM_CACHE_ABSENT);
+
+    // Overwrite replaces the stored copy.
+    mem_cache_put("llm_model", "claude");
+    ASSERT(mem_cache_get("llm_model", buf, sizeof(buf)) == MEM_CACHE_HIT);
+    ASSERT(strcmp(buf, "claude") == 0);
+
+    mem_cache_invalidate("llm_model");
+    ASSERT(mem_cache_get("llm_model", buf, sizeof(buf)) == MEM_CACHE_MISS);
+
+    mem_cache_get_stats(&stats);
+    ASSERT(stats.hits == 2 && stats.absent_hits == 1 && stats.misses == 2);
+    ASSERT(stats.entries == 1 && stats.bytes == 0);
+    ASSERT(s_allocs == 2 && s_frees == 2);
+    return 0;
+}
+
+TEST(rejects_bad_keys)
+{
+    char buf[8];
+
+    setup(1024);
+    mem_cache_put("this_key_is_too_long", "v");
+    mem_cache_put("", "v");
+    mem_cache_put(NULL, "v");
+    ASSERT(mem_cache_get("this_key_is_too_long", buf, sizeof(buf)) == MEM_CACHE_MISS);
+    ASSERT(s_allocs == 0);
+    return 0;
+}
+
+TEST(lru_eviction_by_count)
+{
+    char key[16];
+    char buf[16];
+    mem_cache_stats_t stats;
+
+    setup(MEM_CACHE_MAX_ENTRIES * 8);
+    for (int i = 0; i < MEM_CACHE_MAX_ENTRIES; i++) {
+        snprintf(key, sizeof(key), "k%d", i);
+        mem_cache_put(key, "v");
+    }
+    // Touch k0 so k1 becomes the least recently used.
+    ASSERT(mem_cache_get("k0", buf, sizeof(buf)) == MEM_CACHE_HIT);
+    mem_cache_put("extra", "v");
+
+    ASSERT(mem_cache_get("k0", buf, sizeof(buf)) == MEM_CACHE_HIT);
+    ASSERT(mem_cache_get("k1", buf, sizeof(buf)) == MEM_CACHE_MISS);
+    ASSERT(mem_cache_get("extra", buf, sizeof(buf)) == MEM_CACHE_HIT);
+
+    mem_cache_get_stats(&stats);
+    ASSERT(stats.evictions == 1 && stats.entries == MEM_CACHE_MAX_ENTRIES);
+    return 0;
+}
+
+TEST(byte_budget_eviction)
+{
+    char buf[64];
+    char big[40];
+    mem_cache_stats_t stats;
+
+    setup(64);
+    memset(big, 'x', sizeof(big) - 1);
+    big[sizeof(big) - 1] = '\0';
+
+    mem_cache_put("a", "0123456789");      // 11 bytes
+    mem_cache_put("b", "0123456789");      // 22 bytes total
+    mem_cache_put("c", big);               // 62 bytes total
+    mem_cache_get_stats(&stats);
+    ASSERT(stats.bytes == 62);
+
+    mem_cache_put("d", "0123456789");      // Evicts a (oldest)
+    ASSERT(mem_cache_get("a", buf, sizeof(buf)) == MEM_CACHE_MISS);
+    ASSERT(mem_cache_get("c", buf, sizeof(buf)) == MEM_CACHE_HIT);
+    mem_cache_get_stats(&stats);
+    ASSERT(stats.bytes <= 64);
+
+    // Values larger than the whole budget are never cached.
+    char huge[80];
+    memset(huge, 'y', sizeof(huge) - 1);
+    huge[sizeof(huge) - 1] = '\0';
+    mem_cache_put("c", huge);
+    ASSERT(mem_cache_get("c", buf, sizeof(buf)) == MEM_CACHE_MISS);
+
+    mem_cache_clear();
+    mem_cache_get_stats(&stats);
+    ASSERT(stats.entries == 0 && stats.bytes == 0);
+    ASSERT(s_allocs == s_frees);
+    return 0;
+}
+
+TEST(key_index_tracks_writes)
+{
+    visit_ctx_t visit;
+
+    setup(1024);
+    ASSERT(!mem_cache_index_is_complete());
+    mem_cache_index_add("ignored");         // Unknown index stays unknown
+
+    mem_cache_index_begin();
+    mem_cache_index_add("u_a");
+    mem_cache_index_add("u_b");
+    mem_cache_index_add("u_a");
+    ASSERT(!mem_cache_index_is_complete());
+    mem_cache_index_complete();
+    ASSERT(mem_cache_index_is_complete());
+
+    mem_cache_index_add("u_c");
+    mem_cache_index_remove("u_a");
+    mem_cache_index_remove("missing");
+
+    memset(&visit, 0, sizeof(visit));
+    ASSERT(mem_cache_index_visit(collect_key, &visit) == 2);
+    ASSERT(strcmp(visit.joined, "u_b,u_c") == 0);
+
+    memset(&visit, 0, sizeof(visit));
+    visit.stop_after = 1;
+    ASSERT(mem_cache_index_visit(collect_key, &visit) == 1);
+    ASSERT(strcmp(visit.joined, "u_b") == 0);
+    return 0;
+}
+
+TEST(key_index_overflow_falls_back)
+{
+    char key[16];
+
+    setup(1024);
+    mem_cache_index_begin();
+    for (int i = 0; i < MEM_CACHE_INDEX_MAX; i++) {
+        snprintf(key, sizeof(key), "u_%d", i);
+        mem_cache_index_add(key);
+    }
+    mem_cache_index_complete();
+    ASSERT(mem_cache_index_is_complete());
+
+    mem_cache_index_add("u_overflow");
+    ASSERT(!mem_cache_index_is_complete());
+
+    // Overflow during a rebuild keeps it from being marked complete.
+    mem_cache_index_begin();
+    for (int i = 0; i <= MEM_CACHE_INDEX_MAX; i++) {
+        snprintf(key, sizeof(key), "u_%d", i);
+        mem_cache_index_add(key);
+    }
+    mem_cache_index_complete();
+    ASSERT(!mem_cache_index_is_complete());
+    return 0;
+}
+
+int test_mem_cache_all(void)
+{
+    int failures = 0;
+
+    printf("\nMemory Cache Tests:\n");
+
+    printf("  hit_miss_and_absent... ");
+    if (test_hit_miss_and_absent() == 0) printf("OK\n"); else failures++;
+
+    printf("  rejects_bad_keys... ");
+    if (test_rejects_bad_keys() == 0) printf("OK\n"); else failures++;
+
+    printf("  lru_eviction_by_count... ");
+    if (test_lru_eviction_by_count() == 0) printf("OK\n"); else failures++;
+
+    printf("  byte_budget_eviction... ");
+    if (test_byte_budget_eviction() == 0) printf("OK\n"); else failures++;
+
+    printf("  key_index_tracks_writes... ");
+    if (test_key_index_tracks_writes() == 0) printf("OK\n"); else failures++;
+
+    printf("  key_index_overflow_falls_back... ");
+    if (test_key_index_overflow_falls_back() == 0) printf("OK\n"); else failures++;
+
+    mem_cache_init(NULL, MEM_CACHE_MAX_BYTES);
+    return failures;
+}
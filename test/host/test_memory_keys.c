@@ -31,6 +31,8 @@ TEST(sensitive_exact_keys)
     ASSERT(memory_keys_is_sensitive(NVS_KEY_API_KEY));
     ASSERT(memory_keys_is_sensitive(NVS_KEY_TG_TOKEN));
     ASSERT(memory_keys_is_sensitive(NVS_KEY_TG_CHAT_ID));
+    ASSERT(memory_keys_is_sensitive(NVS_KEY_TG_API_URL));
+    ASSERT(memory_keys_is_sensitive(NVS_KEY_TG_WH_SECRET));
     ASSERT(memory_keys_is_sensitive(NVS_KEY_WIFI_PASS));
     ASSERT(memory_keys_is_sensitive(NVS_KEY_LLM_BACKEND));
     ASSERT(memory_keys_is_sensitive(NVS_KEY_LLM_MODEL));
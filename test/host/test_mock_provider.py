@@ -0,0 +1,285 @@
+#!/usr/bin/env python3
+"""Unit tests for the local mock LLM provider."""
+
+from __future__ import annotations
+
+import base64
+import json
+import math
+import random
+import struct
+import sys
+import tempfile
+import threading
+import unittest
+import urllib.error
+import urllib.request
+from pathlib import Path
+
+
+TEST_DIR = Path(__file__).resolve().parent
+PROJECT_ROOT = TEST_DIR.parent.parent
+sys.path.insert(0, str(PROJECT_ROOT / "scripts"))
+
+from mock_provider import (  # noqa: E402
+    FaultConfig,
+    LatencyModel,
+    MockProvider,
+    TurnSource,
+    build_anthropic_message,
+    build_embeddings_response,
+    build_openai_completion,
+    create_server,
+    decode_wav,
+    load_transcript,
+    parse_latency_spec,
+)
+from qemu_live_llm_bridge import resolve_api_url  # noqa: E402
+
+
+def adpcm_wav(predictor: int, blocks: int, frames: int, streamed: bool = False) -> bytes:
+    """Mono IMA-ADPCM WAV laid out like the firmware's, with constant-value blocks.
+
+    A streamed file has 0xFFFFFFFF sizes, as written before the length is known.
+    """
+    block = struct.pack("<hBB", predictor, 0, 0) + bytes(252)
+    data = block * blocks
+    unknown = 0xFFFFFFFF
+    fmt = struct.pack("<HHIIHHHH", 0x11, 1, 16000, 8110, 256, 4, 2, 505)
+    body = (b"WAVE" + b"fmt " + struct.pack("<I", len(fmt)) + fmt
+            + b"fact" + struct.pack("<II", 4, unknown if streamed else frames)
+            + b"data" + struct.pack("<I", unknown if streamed else len(data)) + data)
+    return b"RIFF" + struct.pack("<I", unknown if streamed else len(body)) + body
+
+
+def multipart(boundary: str, fields: list[tuple[str, bytes]]) -> bytes:
+    out = b""
+    for name, value in fields:
+        filename = '; filename="audio.wav"' if name == "file" else ""
+        out += f'--{boundary}\r\nContent-Disposition: form-data; name="{name}"{filename}\r\n\r\n'.encode()
+        out += value + b"\r\n"
+    return out + f"--{boundary}--\r\n".encode()
+
+
+def anthropic_request(text: str, stream: bool = False) -> dict:
+    return {
+        "model": "mock-model",
+        "max_tokens": 64,
+        "system": "You are zclaw.",
+        "stream": stream,
+        "messages": [{"role": "user", "content": text}],
+    }
+
+
+class MockProviderHelperTests(unittest.TestCase):
+    def test_parse_latency_spec(self) -> None:
+        self.assertEqual(parse_latency_spec("250"), LatencyModel("fixed", 250.0))
+        self.assertEqual(parse_latency_spec("uniform:10,20"), LatencyModel("uniform", 10.0, 20.0))
+        with self.assertRaises(ValueError):
+            parse_latency_spec("gamma:1,2")
+        with self.assertRaises(ValueError):
+            parse_latency_spec("uniform:10")
+
+    def test_latency_samples_are_seeded_and_non_negative(self) -> None:
+        model = LatencyModel("normal", 5.0, 50.0)
+        first = [model.sample_ms(random.Random(7)) for _ in range(3)]
+        second = [model.sample_ms(random.Random(7)) for _ in range(3)]
+        self.assertEqual(first, second)
+        rng = random.Random(1)
+        self.assertTrue(all(model.sample_ms(rng) >= 0.0 for _ in range(200)))
+
+    def test_default_turns_match_firmware_stub(self) -> None:
+        source = TurnSource()
+        turn = source.next_turn(anthropic_request("turn on gpio 10"))
+        self.assertEqual(turn.tool_name, "gpio_write")
+
+        follow_up = {
+            "messages": [
+                {"role": "user", "content": "turn on gpio 10"},
+                {"role": "user", "content": [{"type": "tool_result", "tool_use_id": "x", "content": "ok"}]},
+            ]
+        }
+        self.assertIsNone(source.next_turn(follow_up).tool_name)
+
+    def test_transcript_replays_in_order(self) -> None:
+        with tempfile.NamedTemporaryFile("w", suffix=".jsonl", delete=False) as handle:
+            handle.write("# comment\n")
+            handle.write(json.dumps({"text": "first"}) + "\n")
+            handle.write(json.dumps({"tool_use": {"name": "get_time", "input": {}}}) + "\n")
+            path = handle.name
+        source = TurnSource(load_transcript(path))
+        Path(path).unlink()
+
+        self.assertEqual(source.next_turn(anthropic_request("a")).text, "first")
+        self.assertEqual(source.next_turn(anthropic_request("b")).tool_name, "get_time")
+        self.assertEqual(source.next_turn(anthropic_request("c")).text, "first")
+
+    def test_wire_shapes(self) -> None:
+        turn = TurnSource().next_turn(anthropic_request("remember this"))
+        msg = build_anthropic_message(turn, "m", "id1", 100)
+        self.assertEqual(msg["stop_reason"], "tool_use")
+        self.assertEqual(msg["content"][-1]["name"], "memory_set")
+
+        completion = build_openai_completion(turn, "m", "id1", 100)
+        call = completion["choices"][0]["message"]["tool_calls"][0]
+        self.assertEqual(completion["choices"][0]["finish_reason"], "tool_calls")
+        self.assertEqual(json.loads(call["function"]["arguments"])["key"], "u_test")
+
+    def test_embeddings_are_deterministic_and_related(self) -> None:
+        body = build_embeddings_response(
+            {"input": ["where is the wifi router", "wifi router: office shelf", "dog birthday"], "dimensions": 64},
+            "m",
+        )
+        assert body is not None
+        vectors = [item["embedding"] for item in body["data"]]
+        self.assertEqual([item["index"] for item in body["data"]], [0, 1, 2])
+        self.assertTrue(all(len(v) == 64 for v in vectors))
+        self.assertAlmostEqual(math.sqrt(sum(x * x for x in vectors[0])), 1.0, places=6)
+
+        def cosine(a: list[float], b: list[float]) -> float:
+            return sum(x * y for x, y in zip(a, b))
+
+        self.assertGreater(cosine(vectors[0], vectors[1]), cosine(vectors[0], vectors[2]))
+        again = build_embeddings_response({"input": "where is the wifi router", "dimensions": 64}, "m")
+        assert again is not None
+        self.assertEqual(again["data"][0]["embedding"], vectors[0])
+
+        self.assertIsNone(build_embeddings_response({"input": []}, "m"))
+        self.assertIsNone(build_embeddings_response({"input": ["x"], "dimensions": 0}, "m"))
+
+    def test_decode_wav_pcm_and_adpcm(self) -> None:
+        rate, samples = decode_wav(adpcm_wav(1000, 2, 800))
+        self.assertEqual(rate, 16000)
+        self.assertEqual(len(samples), 800)
+        self.assertEqual(set(samples), {1000})
+        self.assertEqual(len(decode_wav(adpcm_wav(1000, 2, 0, streamed=True))[1]), 1010)
+
+        pcm = struct.pack("<4h", 0, 100, -100, 32767)
+        fmt = struct.pack("<HHIIHH", 1, 1, 8000, 16000, 2, 16)
+        body = b"WAVE" + b"fmt " + struct.pack("<I", 16) + fmt + b"data" + struct.pack("<I", len(pcm)) + pcm
+        self.assertEqual(decode_wav(b"RIFF" + struct.pack("<I", len(body)) + body), (8000, [0, 100, -100, 32767]))
+        self.assertIsNone(decode_wav(b"not a wav file"))
+
+    def test_bridge_base_url_override(self) -> None:
+        self.assertEqual(resolve_api_url("anthropic", "http://127.0.0.1:8788/"), "http://127.0.0.1:8788/v1/messages")
+        self.assertEqual(
+            resolve_api_url("openai", "http://127.0.0.1:8788"), "http://127.0.0.1:8788/v1/chat/completions"
+        )
+
+
+class MockProviderServerTests(unittest.TestCase):
+    def start(self, faults: FaultConfig | None = None) -> str:
+        provider = MockProvider(TurnSource(), LatencyModel(), faults or FaultConfig(), seed=1)
+        server = create_server("127.0.0.1", 0, provider)
+        thread = threading.Thread(target=server.serve_forever, daemon=True)
+        thread.start()
+        self.addCleanup(thread.join, 1)
+        self.addCleanup(server.server_close)
+        self.addCleanup(server.shutdown)
+        return f"http://127.0.0.1:{server.server_address[1]}"
+
+    def post(self, url: str, payload: dict) -> tuple[int, dict[str, str], bytes]:
+        req = urllib.request.Request(
+            url,
+            data=json.dumps(payload).encode("utf-8"),
+            headers={"content-type": "application/json"},
+            method="POST",
+        )
+        try:
+            with urllib.request.urlopen(req, timeout=5) as resp:
+                return resp.status, dict(resp.headers), resp.read()
+        except urllib.error.HTTPError as exc:
+            return exc.code, dict(exc.headers), exc.read()
+
+    def test_anthropic_json_response(self) -> None:
+        base = self.start()
+        status, _, body = self.post(base + "/v1/messages", anthropic_request("hello"))
+        self.assertEqual(status, 200)
+        parsed = json.loads(body)
+        self.assertEqual(parsed["type"], "message")
+        self.assertEqual(parsed["stop_reason"], "end_turn")
+
+    def test_anthropic_sse_stream(self) -> None:
+        base = self.start()
+        status, headers, body = self.post(base + "/v1/messages", anthropic_request("set pin 10", stream=True))
+        self.assertEqual(status, 200)
+        self.assertIn("text/event-stream", headers.get("Content-Type", ""))
+        text = body.decode("utf-8")
+        self.assertIn("event: message_start", text)
+        self.assertIn("input_json_delta", text)
+        self.assertTrue(text.rstrip().endswith('data: {"type":"message_stop"}'))
+
+    def test_openai_sse_stream_ends_with_done(self) -> None:
+        base = self.start()
+        payload = {"model": "m", "stream": True, "messages": [{"role": "user", "content": "hi"}]}
+        status, _, body = self.post(base + "/v1/chat/completions", payload)
+        self.assertEqual(status, 200)
+        self.assertTrue(body.decode("utf-8").rstrip().endswith("data: [DONE]"))
+
+    def test_embeddings_endpoint_serves_base64_floats(self) -> None:
+        base = self.start()
+        payload = {"model": "text-embedding-3-small", "input": ["hello", "world"], "dimensions": 256,
+                   "encoding_format": "base64"}
+        status, _, body = self.post(base + "/v1/embeddings", payload)
+        self.assertEqual(status, 200)
+        parsed = json.loads(body)
+        self.assertEqual(len(parsed["data"]), 2)
+        floats = struct.unpack("<256f", base64.b64decode(parsed["data"][1]["embedding"]))
+        self.assertAlmostEqual(sum(x * x for x in floats), 1.0, places=4)
+
+        status, _, _ = self.post(base + "/v1/embeddings", {"model": "m", "input": 5})
+        self.assertEqual(status, 400)
+
+    def test_transcriptions_endpoint_describes_upload(self) -> None:
+        base = self.start()
+        boundary = "zclaw-audio-7f3a9c"
+        body = multipart(boundary, [("model", b"whisper-1"), ("response_format", b"json"),
+                                    ("file", adpcm_wav(3277, 32, 16000))])
+        req = urllib.request.Request(
+            base + "/v1/audio/transcriptions",
+            data=body,
+            headers={"content-type": f"multipart/form-data; boundary={boundary}"},
+            method="POST",
+        )
+        with urllib.request.urlopen(req, timeout=5) as resp:
+            parsed = json.loads(resp.read())
+        self.assertEqual(parsed["text"], "mock transcript of 1.0 s of audio at -20 dBFS")
+
+        # Voice-activated uploads are chunked, with a streamed WAV.
+        body = multipart(boundary, [("model", b"whisper-1"), ("file", adpcm_wav(3277, 16, 0, streamed=True))])
+        req = urllib.request.Request(
+            base + "/v1/audio/transcriptions",
+            data=iter([body[:100], body[100:]]),
+            headers={"content-type": f"multipart/form-data; boundary={boundary}"},
+            method="POST",
+        )
+        with urllib.request.urlopen(req, timeout=5) as resp:
+            parsed = json.loads(resp.read())
+        self.assertEqual(parsed["text"], "mock transcript of 0.5 s of audio at -20 dBFS")
+
+        req = urllib.request.Request(
+            base + "/v1/audio/transcriptions",
+            data=multipart(boundary, [("file", b"garbage")]),
+            headers={"content-type": f"multipart/form-data; boundary={boundary}"},
+            method="POST",
+        )
+        with self.assertRaises(urllib.error.HTTPError) as ctx:
+            urllib.request.urlopen(req, timeout=5)
+        self.assertEqual(ctx.exception.code, 400)
+        self.assertEqual(json.loads(ctx.exception.read())["error"]["message"], "Invalid file format.")
+
+    def test_rate_limit_sets_retry_after(self) -> None:
+        base = self.start(FaultConfig(rate_limit_rate=1.0, retry_after_s=7))
+        status, headers, body = self.post(base + "/v1/messages", anthropic_request("hello"))
+        self.assertEqual(status, 429)
+        self.assertEqual(headers.get("Retry-After"), "7")
+        self.assertEqual(json.loads(body)["error"]["type"], "rate_limit_error")
+
+        with urllib.request.urlopen(base + "/stats", timeout=5) as resp:
+            stats = json.loads(resp.read())
+        self.assertEqual(stats["requests"], 1)
+        self.assertEqual(stats["rate_limited"], 1)
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,269 @@
+/*
+ * Host tests for the motion watch kernel and detector, run on synthetic
+ * frame sequences: sensor noise, slow light drift and an object walking in.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "motion_detect.h"
+
+#define TEST(name) static int test_##name(void)
+#define ASSERT(cond) do { \
+    if (!(cond)) { \
+        printf("  FAIL: %s (line %d)\n", #cond, __LINE__); \
+        return 1; \
+    } \
+} while(0)
+
+#define FRAME_PIXELS (MOTION_FRAME_W * MOTION_FRAME_H)
+
+static uint32_t s_seed = 1;
+
+static uint32_t next_rand(void)
+{
+    s_seed = s_seed * 1103515245u + 12345u;
+    return (s_seed >> 16) & 0x7FFF;
+}
+
+static uint32_t reference_sad(const uint8_t *a, const uint8_t *b, size_t n)
+{
+    uint32_t total = 0;
+    for (size_t i = 0; i < n; i++) {
+        total += (uint32_t)abs((int)a[i] - (int)b[i]);
+    }
+    return total;
+}
+
+// Textured background at a given brightness offset, plus +-noise per pixel.
+static void render_scene(uint8_t *frame, int brightness, int noise)
+{
+    for (int y = 0; y < MOTION_FRAME_H; y++) {
+        for (int x = 0; x < MOTION_FRAME_W; x++) {
+            int v = 80 + ((x * 7 + y * 3) % 40) + brightness;
+            if (noise > 0) {
+                v += (int)(next_rand() % (uint32_t)(2 * noise + 1)) - noise;
+            }
+            frame[y * MOTION_FRAME_W + x] = (uint8_t)(v < 0 ? 0 : v > 255 ? 255 : v);
+        }
+    }
+}
+
+static void draw_box(uint8_t *frame, int x0, int y0, int w, int h, uint8_t value)
+{
+    for (int y = y0; y < y0 + h && y < MOTION_FRAME_H; y++) {
+        for (int x = x0; x < x0 + w && x < MOTION_FRAME_W; x++) {
+            if (x >= 0 && y >= 0) {
+                frame[y * MOTION_FRAME_W + x] = value;
+            }
+        }
+    }
+}
+
+TEST(sad_matches_reference)
+{
+    static uint8_t a[3000];
+    static uint8_t b[3000];
+    static const size_t lengths[] = { 0, 1, 3, 4, 5, 10, 31, 512, 513, 2047, 2999 };
+
+    for (size_t i = 0; i < sizeof(a); i++) {
+        a[i] = (uint8_t)next_rand();
+        b[i] = (uint8_t)next_rand();
+    }
+    for (size_t i = 0; i < sizeof(lengths) / sizeof(lengths[0]); i++) {
+        // Odd offset: loads are unaligned.
+        ASSERT(motion_sad(a + 1, b + 1, lengths[i]) == reference_sad(a + 1, b + 1, lengths[i]));
+    }
+
+    // Worst case per lane: every byte differs by 255, across several flushes.
+    memset(a, 0, sizeof(a));
+    memset(b, 255, sizeof(b));
+    ASSERT(motion_sad(a, b, sizeof(a)) == 255u * sizeof(a));
+    ASSERT(motion_sad(b, a, sizeof(a)) == 255u * sizeof(a));
+    ASSERT(motion_sad(a, a, sizeof(a)) == 0);
+    return 0;
+}
+
+TEST(block_sad_localizes_change)
+{
+    static uint8_t a[FRAME_PIXELS];
+    static uint8_t b[FRAME_PIXELS];
+    uint32_t sads[MOTION_BLOCK_COUNT];
+
+    render_scene(a, 0, 0);
+    memcpy(b, a, sizeof(b));
+    // Block (col 2, row 1) brightened by 10 throughout.
+    for (int y = MOTION_BLOCK_SIZE; y < 2 * MOTION_BLOCK_SIZE; y++) {
+        for (int x = 2 * MOTION_BLOCK_SIZE; x < 3 * MOTION_BLOCK_SIZE; x++) {
+            b[y * MOTION_FRAME_W + x] += 10;
+        }
+    }
+
+    motion_block_sad(a, b, sads);
+    for (int i = 0; i < MOTION_BLOCK_COUNT; i++) {
+        uint32_t expected = (i == 1 * MOTION_BLOCK_COLS + 2)
+                                ? 10u * MOTION_BLOCK_SIZE * MOTION_BLOCK_SIZE
+                                : 0u;
+        ASSERT(sads[i] == expected);
+    }
+    return 0;
+}
+
+TEST(rgb565_to_gray)
+{
+    const uint8_t pixels[] = { 0xFF, 0xFF, 0x00, 0x00, 0x07, 0xE0, 0xF8, 0x00 };
+    uint8_t gray[4];
+
+    motion_rgb565_to_gray(pixels, 4, gray);
+    ASSERT(gray[0] == 255);
+    ASSERT(gray[1] == 0);
+    ASSERT(gray[2] > 140 && gray[2] < 155);     // Green carries most luma
+    ASSERT(gray[3] > 70 && gray[3] < 80);
+    return 0;
+}
+
+TEST(still_scene_with_noise_and_drift_is_quiet)
+{
+    static uint8_t frame[FRAME_PIXELS];
+    motion_detector_t det;
+    motion_result_t result;
+
+    motion_detector_init(&det, MOTION_SENSITIVITY_HIGH);
+    for (int i = 0; i < 120; i++) {
+        // Light creeps up by a level every other second; sensor noise +-4.
+        render_scene(frame, i / 2, 4);
+        motion_detector_feed(&det, frame, (int64_t)i * MOTION_SAMPLE_MS, &result);
+        ASSERT(!result.event);
+    }
+    return 0;
+}
+
+TEST(person_walking_in_fires_once_then_cools_down)
+{
+    static uint8_t frame[FRAME_PIXELS];
+    motion_detector_t det;
+    motion_result_t result;
+    char text[96];
+    int events = 0;
+    int first_event = -1;
+
+    motion_detector_init(&det, MOTION_SENSITIVITY_MEDIUM);
+    for (int i = 0; i < 40; i++) {
+        render_scene(frame, 0, 3);
+        if (i >= 10) {
+            // Dark figure enters on the left and walks right, 3 px per sample.
+            draw_box(frame, -20 + (i - 10) * 3, 15, 20, 40, 20);
+        }
+        motion_detector_feed(&det, frame, (int64_t)i * MOTION_SAMPLE_MS, &result);
+        if (result.event) {
+            events++;
+            if (first_event < 0) {
+                first_event = i;
+                motion_describe(&result, text, sizeof(text));
+                ASSERT(strstr(text, "left") != NULL);
+            }
+        }
+    }
+    ASSERT(events == 1);
+    ASSERT(first_event >= 10 && first_event <= 12);
+
+    // The figure leaves; the background settles within the cooldown.
+    for (int i = 40; i < 50; i++) {
+        render_scene(frame, 0, 3);
+        motion_detector_feed(&det, frame, (int64_t)i * MOTION_SAMPLE_MS, &result);
+        ASSERT(!result.event);
+    }
+
+    // Past the cooldown, the next change is an event again.
+    render_scene(frame, 0, 3);
+    draw_box(frame, 60, 0, 20, 20, 250);
+    motion_detector_feed(&det, frame, (int64_t)first_event * MOTION_SAMPLE_MS + MOTION_COOLDOWN_MS,
+                         &result);
+    ASSERT(result.event);
+    motion_describe(&result, text, sizeof(text));
+    ASSERT(strstr(text, "upper right") != NULL);
+    return 0;
+}
+
+TEST(sensitivity_sets_smallest_change)
+{
+    static uint8_t frame[FRAME_PIXELS];
+    motion_detector_t low;
+    motion_detector_t high;
+    motion_result_t result;
+    motion_sensitivity_t parsed;
+
+    ASSERT(motion_sensitivity_parse("high", &parsed) && parsed == MOTION_SENSITIVITY_HIGH);
+    ASSERT(!motion_sensitivity_parse("max", &parsed));
+    ASSERT(!motion_sensitivity_parse(NULL, &parsed));
+
+    motion_detector_init(&low, MOTION_SENSITIVITY_LOW);
+    motion_detector_init(&high, MOTION_SENSITIVITY_HIGH);
+    render_scene(frame, 0, 0);
+    motion_detector_feed(&low, frame, 0, &result);
+    motion_detector_feed(&high, frame, 0, &result);
+
+    // A cat-sized change: one block, modest contrast.
+    draw_box(frame, 40, 30, MOTION_BLOCK_SIZE, MOTION_BLOCK_SIZE, 140);
+    motion_detector_feed(&low, frame, 1000, &result);
+    ASSERT(!result.event && result.changed_blocks <= 1);
+    motion_detector_feed(&high, frame, 1000, &result);
+    ASSERT(result.event && result.changed_blocks == 1);
+    return 0;
+}
+
+TEST(describe_summaries)
+{
+    motion_result_t result;
+    char text[96];
+
+    memset(&result, 0, sizeof(result));
+    motion_describe(&result, text, sizeof(text));
+    ASSERT(strcmp(text, "no change") == 0);
+
+    result.changed_blocks = MOTION_BLOCK_COUNT;
+    result.max_col = MOTION_BLOCK_COLS - 1;
+    result.max_row = MOTION_BLOCK_ROWS - 1;
+    motion_describe(&result, text, sizeof(text));
+    ASSERT(strstr(text, "across the frame") != NULL);
+
+    result.changed_blocks = 2;
+    result.min_col = result.max_col = MOTION_BLOCK_COLS / 2;
+    result.min_row = MOTION_BLOCK_ROWS - 1;
+    result.max_row = MOTION_BLOCK_ROWS - 1;
+    motion_describe(&result, text, sizeof(text));
+    ASSERT(strstr(text, "2 of") == text);
+    ASSERT(strstr(text, "lower center") != NULL);
+    return 0;
+}
+
+int test_motion_detect_all(void)
+{
+    int failures = 0;
+
+    printf("\nMotion Detect Tests:\n");
+
+    printf("  sad_matches_reference... ");
+    if (test_sad_matches_reference() == 0) printf("OK\n"); else failures++;
+
+    printf("  block_sad_localizes_change... ");
+    if (test_block_sad_localizes_change() == 0) printf("OK\n"); else failures++;
+
+    printf("  rgb565_to_gray... ");
+    if (test_rgb565_to_gray() == 0) printf("OK\n"); else failures++;
+
+    printf("  still_scene_with_noise_and_drift_is_quiet... ");
+    if (test_still_scene_with_noise_and_drift_is_quiet() == 0) printf("OK\n"); else failures++;
+
+    printf("  person_walking_in_fires_once_then_cools_down... ");
+    if (test_person_walking_in_fires_once_then_cools_down() == 0) printf("OK\n"); else failures++;
+
+    printf("  sensitivity_sets_smallest_change... ");
+    if (test_sensitivity_sets_smallest_change() == 0) printf("OK\n"); else failures++;
+
+    printf("  describe_summaries... ");
+    if (test_describe_summaries() == 0) printf("OK\n"); else failures++;
+
+    return failures;
+}
@@ -0,0 +1,360 @@
+/*
+ * Host tests for the NVS write-behind cache: coalescing, flush triggers,
+ * read-your-writes lookups, and failure handling against a fake flash.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "config.h"
+#include "nvs_wb.h"
+
+#define TEST(name) static int test_##name(void)
+#define ASSERT(cond) do { \
+    if (!(cond)) { \
+        printf("  FAIL: %s (line %d)\n", #cond, __LINE__); \
+        return 1; \
+    } \
+} while(0)
+
+#define FAKE_MAX_KEYS 32
+
+typedef struct {
+    char ns[16];
+    char key[NVS_WB_KEY_LEN];
+    uint8_t data[64];
+    size_t len;
+    bool used;
+} fake_slot_t;
+
+typedef struct {
+    fake_slot_t slots[FAKE_MAX_KEYS];
+    uint32_t now_ms;
+    int opens;
+    int writes;
+    int commits;
+    int kicks;
+    const char *open_ns;
+    bool fail_open;
+    bool fail_commit;
+    const char *fail_key;
+} fake_flash_t;
+
+static fake_flash_t s_flash;
+
+static fake_slot_t *fake_find(const char *ns, const char *key)
+{
+    for (int i = 0; i < FAKE_MAX_KEYS; i++) {
+        if (s_flash.slots[i].used && strcmp(s_flash.slots[i].ns, ns) == 0 &&
+            strcmp(s_flash.slots[i].key, key) == 0) {
+            return &s_flash.slots[i];
+        }
+    }
+    return NULL;
+}
+
+static esp_err_t fake_open(const char *ns, uint32_t *handle, void *ctx)
+{
+    (void)ctx;
+    if (s_flash.fail_open) {
+        return ESP_FAIL;
+    }
+    s_flash.opens++;
+    s_flash.open_ns = ns;
+    *handle = (uint32_t)s_flash.opens;
+    return ESP_OK;
+}
+
+static esp_err_t fake_write(uint32_t handle, const nvs_wb_item_t *item, void *ctx)
+{
+    (void)handle;
+    (void)ctx;
+    if (s_flash.fail_key && strcmp(s_flash.fail_key, item->key) == 0) {
+        return ESP_FAIL;
+    }
+    s_flash.writes++;
+
+    fake_slot_t *slot = fake_find(s_flash.open_ns, item->key);
+    if (item->kind == NVS_WB_KIND_ERASE) {
+        if (slot) {
+            memset(slot, 0, sizeof(*slot));
+        }
+        return ESP_OK;
+    }
+    if (!slot) {
+        for (int i = 0; i < FAKE_MAX_KEYS && !slot; i++) {
+            if (!s_flash.slots[i].used) {
+                slot = &s_flash.slots[i];
+            }
+        }
+        if (!slot || item->len > sizeof(slot->data)) {
+            return ESP_ERR_NO_MEM;
+        }
+        slot->used = true;
+        snprintf(slot->ns, sizeof(slot->ns), "%s", s_flash.open_ns);
+        snprintf(slot->key, sizeof(slot->key), "%s", item->key);
+    }
+    memcpy(slot->data, item->data, item->len);
+    slot->len = item->len;
+    return ESP_OK;
+}
+
+static esp_err_t fake_commit(uint32_t handle, void *ctx)
+{
+    (void)handle;
+    (void)ctx;
+    if (s_flash.fail_commit) {
+        return ESP_FAIL;
+    }
+    s_flash.commits++;
+    return ESP_OK;
+}
+
+static uint32_t fake_now_ms(void *ctx)
+{
+    (void)ctx;
+    return s_flash.now_ms;
+}
+
+static void fake_kick(void *ctx)
+{
+    (void)ctx;
+    s_flash.kicks++;
+}
+
+static void setup(bool with_kick, size_t threshold)
+{
+    nvs_wb_backend_t backend = {
+        .open = fake_open,
+        .write = fake_write,
+        .commit = fake_commit,
+        .now_ms = fake_now_ms,
+        .kick = with_kick ? fake_kick : NULL,
+    };
+    memset(&s_flash, 0, sizeof(s_flash));
+    s_flash.now_ms = 1000;
+    nvs_wb_init(&backend, 30000, threshold);
+}
+
+static const char *flash_str(const char *ns, const char *key)
+{
+    fake_slot_t *slot = fake_find(ns, key);
+    return slot ? (const char *)slot->data : NULL;
+}
+
+TEST(coalesces_repeated_writes)
+{
+    nvs_wb_stats_t stats;
+    char buf[16];
+
+    setup(true, 8);
+    for (int i = 1; i <= 50; i++) {
+        snprintf(buf, sizeof(buf), "%d", i);
+        ASSERT(nvs_wb_set_str("zclaw", "rl_daily", buf, NVS_WB_DEFERRED) == ESP_OK);
+    }
+    ASSERT(s_flash.writes == 0);
+    ASSERT(nvs_wb_dirty_count() == 1);
+
+    ASSERT(nvs_wb_flush() == ESP_OK);
+    ASSERT(s_flash.writes == 1 && s_flash.commits == 1);
+    ASSERT(strcmp(flash_str("zclaw", "rl_daily"), "50") == 0);
+
+    nvs_wb_get_stats(&stats);
+    ASSERT(stats.queued == 50 && stats.coalesced == 49 && stats.items_written == 1);
+    ASSERT(nvs_wb_dirty_count() == 0);
+    return 0;
+}
+
+TEST(lookup_sees_pending_values)
+{
+    char buf[16];
+    size_t len = sizeof(buf);
+    nvs_wb_kind_t kind;
+
+    setup(true, 8);
+    ASSERT(nvs_wb_lookup("zclaw", "u_a", &kind, buf, &len) == NVS_WB_LOOKUP_MISS);
+
+    nvs_wb_set_str("zclaw", "u_a", "hello", NVS_WB_DEFERRED);
+    len = sizeof(buf);
+    ASSERT(nvs_wb_lookup("zclaw", "u_a", &kind, buf, &len) == NVS_WB_LOOKUP_HIT);
+    ASSERT(kind == NVS_WB_KIND_STR && len == 6 && strcmp(buf, "hello") == 0);
+    // Namespaces are separate.
+    len = sizeof(buf);
+    ASSERT(nvs_wb_lookup("zc_cron", "u_a", &kind, buf, &len) == NVS_WB_LOOKUP_MISS);
+
+    len = 3;
+    ASSERT(nvs_wb_lookup("zclaw", "u_a", &kind, buf, &len) == NVS_WB_LOOKUP_TOO_SMALL);
+    ASSERT(len == 6);
+
+    nvs_wb_erase("zclaw", "u_a", NVS_WB_DEFERRED);
+    len = sizeof(buf);
+    ASSERT(nvs_wb_lookup("zclaw", "u_a", &kind, buf, &len) == NVS_WB_LOOKUP_ERASED);
+    ASSERT(nvs_wb_dirty_count() == 1);
+    return 0;
+}
+
+TEST(durable_write_flushes_everything)
+{
+    setup(true, 8);
+    nvs_wb_set_str("zclaw", "rl_daily", "3", NVS_WB_DEFERRED);
+    nvs_wb_set_blob("zc_cron", "cron_0", "abcd", 4, NVS_WB_DEFERRED);
+    nvs_wb_set_u8("zc_tools", "ut_count", 2, NVS_WB_DEFERRED);
+    ASSERT(s_flash.writes == 0);
+
+    ASSERT(nvs_wb_set_str("zclaw", "boot_cnt", "1", NVS_WB_DURABLE) == ESP_OK);
+    ASSERT(s_flash.writes == 4);
+    // One open/commit per namespace, not per key.
+    ASSERT(s_flash.opens == 3 && s_flash.commits == 3);
+    ASSERT(strcmp(flash_str("zclaw", "boot_cnt"), "1") == 0);
+    ASSERT(fake_find("zc_tools", "ut_count")->data[0] == 2);
+    ASSERT(nvs_wb_dirty_count() == 0);
+    return 0;
+}
+
+TEST(timer_flush_after_interval)
+{
+    setup(true, 8);
+    ASSERT(nvs_wb_tick() == UINT32_MAX);
+
+    nvs_wb_set_str("zclaw", "rl_daily", "1", NVS_WB_DEFERRED);
+    s_flash.now_ms += 10000;
+    nvs_wb_set_str("zclaw", "rl_day", "42", NVS_WB_DEFERRED);
+    ASSERT(nvs_wb_tick() == 20000);
+    ASSERT(s_flash.writes == 0);
+
+    // Rewriting a dirty key does not push its deadline out.
+    s_flash.now_ms += 19999;
+    nvs_wb_set_str("zclaw", "rl_daily", "2", NVS_WB_DEFERRED);
+    ASSERT(nvs_wb_tick() == 1);
+
+    s_flash.now_ms += 1;
+    ASSERT(nvs_wb_tick() == UINT32_MAX);
+    ASSERT(s_flash.writes == 2 && s_flash.commits == 1);
+    ASSERT(strcmp(flash_str("zclaw", "rl_daily"), "2") == 0);
+    return 0;
+}
+
+TEST(threshold_kicks_or_flushes_inline)
+{
+    char key[16];
+
+    setup(true, 3);
+    for (int i = 0; i < 3; i++) {
+        snprintf(key, sizeof(key), "k%d", i);
+        nvs_wb_set_str("zclaw", key, "v", NVS_WB_DEFERRED);
+    }
+    ASSERT(s_flash.kicks == 1);
+    ASSERT(s_flash.writes == 0);
+
+    setup(false, 3);
+    for (int i = 0; i < 3; i++) {
+        snprintf(key, sizeof(key), "k%d", i);
+        nvs_wb_set_str("zclaw", key, "v", NVS_WB_DEFERRED);
+    }
+    ASSERT(s_flash.writes == 3 && s_flash.commits == 1);
+    ASSERT(nvs_wb_dirty_count() == 0);
+    return 0;
+}
+
+TEST(full_table_flushes_to_make_room)
+{
+    char key[16];
+
+    setup(true, NVS_WB_MAX_ITEMS + 1);
+    for (int i = 0; i < NVS_WB_MAX_ITEMS; i++) {
+        snprintf(key, sizeof(key), "k%d", i);
+        ASSERT(nvs_wb_set_str("zclaw", key, "v", NVS_WB_DEFERRED) == ESP_OK);
+    }
+    ASSERT(s_flash.writes == 0);
+    ASSERT(nvs_wb_set_str("zclaw", "overflow", "v", NVS_WB_DEFERRED) == ESP_OK);
+    ASSERT(s_flash.writes == NVS_WB_MAX_ITEMS);
+    ASSERT(nvs_wb_dirty_count() == 1);
+
+    nvs_wb_discard();
+    ASSERT(nvs_wb_dirty_count() == 0);
+    ASSERT(nvs_wb_flush() == ESP_OK);
+    ASSERT(fake_find("zclaw", "overflow") == NULL);
+    return 0;
+}
+
+TEST(failures_retry_then_drop)
+{
+    nvs_wb_stats_t stats;
+
+    setup(true, 8);
+    nvs_wb_set_str("zclaw", "good", "1", NVS_WB_DEFERRED);
+    nvs_wb_set_str("zclaw", "bad", "1", NVS_WB_DEFERRED);
+    s_flash.fail_key = "bad";
+
+    ASSERT(nvs_wb_flush() != ESP_OK);
+    ASSERT(flash_str("zclaw", "good") != NULL);
+    ASSERT(nvs_wb_dirty_count() == 1);
+    // Retry is scheduled a full interval after the failure.
+    ASSERT(nvs_wb_tick() == 30000);
+
+    for (int i = 1; i < NVS_WB_MAX_FAILURES; i++) {
+        nvs_wb_flush();
+    }
+    ASSERT(nvs_wb_dirty_count() == 0);
+    nvs_wb_get_stats(&stats);
+    ASSERT(stats.dropped == 1);
+
+    // A failed commit keeps every item of that namespace queued.
+    setup(true, 8);
+    nvs_wb_set_str("zclaw", "a", "1", NVS_WB_DEFERRED);
+    s_flash.fail_commit = true;
+    ASSERT(nvs_wb_set_str("zclaw", "b", "2", NVS_WB_DURABLE) != ESP_OK);
+    ASSERT(nvs_wb_dirty_count() == 2);
+    s_flash.fail_commit = false;
+    ASSERT(nvs_wb_flush() == ESP_OK);
+    ASSERT(nvs_wb_dirty_count() == 0);
+    return 0;
+}
+
+TEST(rejects_bad_arguments)
+{
+    setup(true, 8);
+    ASSERT(nvs_wb_set_str("zclaw", "this_key_is_too_long", "v", NVS_WB_DEFERRED) == ESP_ERR_INVALID_ARG);
+    ASSERT(nvs_wb_set_str("zclaw", "", "v", NVS_WB_DEFERRED) == ESP_ERR_INVALID_ARG);
+    ASSERT(nvs_wb_set_str("zclaw", "k", NULL, NVS_WB_DEFERRED) == ESP_ERR_INVALID_ARG);
+    ASSERT(nvs_wb_set_blob(NULL, "k", "x", 1, NVS_WB_DEFERRED) == ESP_ERR_INVALID_ARG);
+
+    nvs_wb_init(NULL, 30000, 8);
+    ASSERT(nvs_wb_set_str("zclaw", "k", "v", NVS_WB_DEFERRED) == ESP_ERR_INVALID_STATE);
+    return 0;
+}
+
+int test_nvs_wb_all(void)
+{
+    int failures = 0;
+
+    printf("\nNVS Write-Behind Tests:\n");
+
+    printf("  coalesces_repeated_writes... ");
+    if (test_coalesces_repeated_writes() == 0) printf("OK\n"); else failures++;
+
+    printf("  lookup_sees_pending_values... ");
+    if (test_lookup_sees_pending_values() == 0) printf("OK\n"); else failures++;
+
+    printf("  durable_write_flushes_everything... ");
+    if (test_durable_write_flushes_everything() == 0) printf("OK\n"); else failures++;
+
+    printf("  timer_flush_after_interval... ");
+    if (test_timer_flush_after_interval() == 0) printf("OK\n"); else failures++;
+
+    printf("  threshold_kicks_or_flushes_inline... ");
+    if (test_threshold_kicks_or_flushes_inline() == 0) printf("OK\n"); else failures++;
+
+    printf("  full_table_flushes_to_make_room... ");
+    if (test_full_table_flushes_to_make_room() == 0) printf("OK\n"); else failures++;
+
+    printf("  failures_retry_then_drop... ");
+    if (test_failures_retry_then_drop() == 0) printf("OK\n"); else failures++;
+
+    printf("  rejects_bad_arguments... ");
+    if (test_rejects_bad_arguments() == 0) printf("OK\n"); else failures++;
+
+    nvs_wb_init(NULL, NVS_WB_FLUSH_INTERVAL_MS, NVS_WB_FLUSH_THRESHOLD);
+    return failures;
+}
@@ -0,0 +1,243 @@
+/*
+ * Host tests for the microphone's lock-free sample ring: ordering across
+ * the wrap, independent readers, pre-roll, overrun and position wrap.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pcm_ring.h"
+
+#define TEST(name) static int test_##name(void)
+#define ASSERT(cond) do { \
+    if (!(cond)) { \
+        printf("  FAIL: %s (line %d)\n", #cond, __LINE__); \
+        return 1; \
+    } \
+} while(0)
+
+#define CAPACITY    64
+#define GUARD       16
+#define REACH       (CAPACITY - GUARD)
+
+static int16_t s_buf[CAPACITY];
+static uint32_t s_next;             // Next sample value the writer produces
+
+static int16_t sample(uint32_t i)
+{
+    return (int16_t)(i & 0x7fff);
+}
+
+static void produce(pcm_ring_t *ring, size_t n, size_t chunk)
+{
+    int16_t tmp[64];
+
+    while (n > 0) {
+        size_t take = n < chunk ? n : chunk;
+        for (size_t i = 0; i < take; i++) {
+            tmp[i] = sample(s_next++);
+        }
+        pcm_ring_write(ring, tmp, take);
+        n -= take;
+    }
+}
+
+// Read up to max samples and check they continue from *expect.
+static int consume(const pcm_ring_t *ring, pcm_ring_reader_t *reader, size_t max,
+                   uint32_t *expect, size_t *got)
+{
+    int16_t out[256];
+    size_t n = pcm_ring_read(ring, reader, out, max);
+
+    for (size_t i = 0; i < n; i++) {
+        if (out[i] != sample(*expect + (uint32_t)i)) {
+            return 1;
+        }
+    }
+    *expect += (uint32_t)n;
+    *got = n;
+    return 0;
+}
+
+TEST(order_across_wrap_in_odd_chunks)
+{
+    pcm_ring_t ring;
+    pcm_ring_reader_t reader;
+    uint32_t expect = 0;
+    size_t got;
+
+    s_next = 0;
+    pcm_ring_init(&ring, s_buf, CAPACITY, GUARD);
+    pcm_ring_open(&ring, &reader, 0);
+    for (int step = 0; step < 200; step++) {
+        produce(&ring, 7, 7);
+        do {
+            ASSERT(consume(&ring, &reader, 5, &expect, &got) == 0);
+        } while (got > 0);
+    }
+    ASSERT(expect == 1400);
+    ASSERT(reader.dropped == 0);
+    ASSERT(pcm_ring_available(&ring, &reader) == 0);
+    return 0;
+}
+
+TEST(readers_keep_their_own_pace)
+{
+    pcm_ring_t ring;
+    pcm_ring_reader_t fast;
+    pcm_ring_reader_t slow;
+    uint32_t fast_expect = 0;
+    uint32_t slow_expect = 0;
+    size_t got;
+
+    s_next = 0;
+    pcm_ring_init(&ring, s_buf, CAPACITY, GUARD);
+    pcm_ring_open(&ring, &fast, 0);
+    pcm_ring_open(&ring, &slow, 0);
+    for (int step = 0; step < 90; step++) {
+        produce(&ring, 10, 10);
+        ASSERT(consume(&ring, &fast, 256, &fast_expect, &got) == 0);
+        ASSERT(got == 10);
+        if (step % 4 == 3) {
+            ASSERT(pcm_ring_available(&ring, &slow) == 40);
+            ASSERT(consume(&ring, &slow, 256, &slow_expect, &got) == 0);
+            ASSERT(got == 40);
+        }
+    }
+    ASSERT(fast_expect == 900);
+    ASSERT(slow_expect == 880);
+    ASSERT(fast.dropped == 0 && slow.dropped == 0);
+    return 0;
+}
+
+TEST(preroll_reaches_back_as_far_as_held)
+{
+    pcm_ring_t ring;
+    pcm_ring_reader_t reader;
+    uint32_t expect;
+    size_t got;
+
+    s_next = 0;
+    pcm_ring_init(&ring, s_buf, CAPACITY, GUARD);
+    pcm_ring_open(&ring, &reader, 10);
+    ASSERT(pcm_ring_available(&ring, &reader) == 0);
+
+    produce(&ring, 20, 20);
+    pcm_ring_open(&ring, &reader, 10);
+    ASSERT(pcm_ring_available(&ring, &reader) == 10);
+    expect = 10;
+    ASSERT(consume(&ring, &reader, 256, &expect, &got) == 0 && got == 10);
+
+    pcm_ring_open(&ring, &reader, 100);
+    ASSERT(pcm_ring_available(&ring, &reader) == 20);
+
+    produce(&ring, 1000, 13);
+    pcm_ring_open(&ring, &reader, 1000);
+    ASSERT(pcm_ring_available(&ring, &reader) == REACH);
+    expect = 1020 - REACH;
+    ASSERT(consume(&ring, &reader, 256, &expect, &got) == 0 && got == REACH);
+    ASSERT(reader.dropped == 0);
+    return 0;
+}
+
+TEST(lapped_reader_skips_and_counts)
+{
+    pcm_ring_t ring;
+    pcm_ring_reader_t reader;
+    uint32_t expect;
+    size_t got;
+
+    s_next = 0;
+    pcm_ring_init(&ring, s_buf, CAPACITY, GUARD);
+    pcm_ring_open(&ring, &reader, 0);
+    produce(&ring, 200, 9);
+
+    ASSERT(pcm_ring_available(&ring, &reader) == REACH);
+    expect = 200 - REACH;
+    ASSERT(consume(&ring, &reader, 256, &expect, &got) == 0);
+    ASSERT(got == REACH);
+    ASSERT(reader.dropped == 200 - REACH);
+
+    // Back in step, nothing more is lost.
+    produce(&ring, 30, 30);
+    ASSERT(consume(&ring, &reader, 256, &expect, &got) == 0 && got == 30);
+    ASSERT(reader.dropped == 200 - REACH);
+    return 0;
+}
+
+TEST(position_wraps_at_uint32)
+{
+    pcm_ring_t ring;
+    pcm_ring_reader_t reader;
+    uint32_t expect;
+    size_t got;
+    size_t total = 0;
+
+    pcm_ring_init(&ring, s_buf, CAPACITY, GUARD);
+    ring.written = UINT32_MAX - 20;
+    ring.full = true;
+    s_next = ring.written;
+    pcm_ring_open(&ring, &reader, 0);
+    expect = s_next;
+    for (int step = 0; step < 10; step++) {
+        produce(&ring, 11, 11);
+        ASSERT(consume(&ring, &reader, 256, &expect, &got) == 0);
+        total += got;
+    }
+    ASSERT(total == 110);
+    ASSERT(ring.written == 89);
+    ASSERT(reader.dropped == 0);
+
+    // Still full after the wrap: a pre-roll reaches back the whole ring.
+    pcm_ring_open(&ring, &reader, 1000);
+    ASSERT(pcm_ring_available(&ring, &reader) == REACH);
+    return 0;
+}
+
+TEST(write_ptr_stays_within_guard)
+{
+    pcm_ring_t ring;
+    size_t room;
+
+    pcm_ring_init(&ring, s_buf, CAPACITY, GUARD);
+    int16_t *ptr = pcm_ring_write_ptr(&ring, &room);
+    ASSERT(ptr == s_buf && room == GUARD);
+
+    pcm_ring_commit(&ring, 56);
+    ptr = pcm_ring_write_ptr(&ring, &room);
+    ASSERT(ptr == s_buf + 56 && room == 8);
+    ASSERT(ring.full);
+
+    pcm_ring_commit(&ring, room);
+    ptr = pcm_ring_write_ptr(&ring, &room);
+    ASSERT(ptr == s_buf && room == GUARD);
+    return 0;
+}
+
+int test_pcm_ring_all(void)
+{
+    int failures = 0;
+
+    printf("\nPCM Ring Tests:\n");
+
+    printf("  order_across_wrap_in_odd_chunks... ");
+    if (test_order_across_wrap_in_odd_chunks() == 0) printf("OK\n"); else failures++;
+
+    printf("  readers_keep_their_own_pace... ");
+    if (test_readers_keep_their_own_pace() == 0) printf("OK\n"); else failures++;
+
+    printf("  preroll_reaches_back_as_far_as_held... ");
+    if (test_preroll_reaches_back_as_far_as_held() == 0) printf("OK\n"); else failures++;
+
+    printf("  lapped_reader_skips_and_counts... ");
+    if (test_lapped_reader_skips_and_counts() == 0) printf("OK\n"); else failures++;
+
+    printf("  position_wraps_at_uint32... ");
+    if (test_position_wraps_at_uint32() == 0) printf("OK\n"); else failures++;
+
+    printf("  write_ptr_stays_within_guard... ");
+    if (test_write_ptr_stays_within_guard() == 0) printf("OK\n"); else failures++;
+
+    return failures;
+}
@@ -0,0 +1,183 @@
+/*
+ * Host tests for Telegram quick actions: what may be pinned, the inline
+ * keyboard and callback data, the /actions command and direct tool dispatch.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "quick_actions_util.h"
+#include "mock_tools.h"
+
+#define TEST(name) static int test_##name(void)
+#define ASSERT(cond) do { \
+    if (!(cond)) { \
+        printf("  FAIL: %s (line %d)\n", #cond, __LINE__); \
+        return 1; \
+    } \
+} while(0)
+
+TEST(build_validates_label_tool_and_args)
+{
+    quick_action_t action;
+    char err[128];
+    cJSON *args = cJSON_Parse("{\"pin\":5,\"state\":1}");
+    cJSON *list = cJSON_Parse("[1,2]");
+
+    ASSERT(args && list);
+    ASSERT(quick_action_build("Relay on", "gpio_write", args, &action, err, sizeof(err)));
+    ASSERT(strcmp(action.label, "Relay on") == 0);
+    ASSERT(strcmp(action.tool, "gpio_write") == 0);
+    ASSERT(strcmp(action.args, "{\"pin\":5,\"state\":1}") == 0);
+
+    ASSERT(quick_action_build("Schedules", "cron_list", NULL, &action, err, sizeof(err)));
+    ASSERT(strcmp(action.args, "{}") == 0);
+
+    // Slow, side-effect heavy or LLM-facing tools stay out.
+    ASSERT(!quick_action_build("Wait", "delay", NULL, &action, err, sizeof(err)));
+    ASSERT(strstr(err, "delay") != NULL);
+    ASSERT(!quick_action_build("New", "create_tool", NULL, &action, err, sizeof(err)));
+    ASSERT(!quick_action_build("Pin", "pin_quick_action", NULL, &action, err, sizeof(err)));
+
+    ASSERT(!quick_action_build("", "get_time", NULL, &action, err, sizeof(err)));
+    ASSERT(!quick_action_build("two\nlines", "get_time", NULL, &action, err, sizeof(err)));
+    ASSERT(!quick_action_build("0123456789012345678901234567890123", "get_time", NULL,
+                               &action, err, sizeof(err)));
+    ASSERT(!quick_action_build("List", "gpio_read", list, &action, err, sizeof(err)));
+
+    cJSON_Delete(args);
+    cJSON_Delete(list);
+    return 0;
+}
+
+TEST(build_rejects_oversized_args)
+{
+    quick_action_t action;
+    char err[128];
+    char big[QUICK_ACTION_ARGS_MAX_LEN + 32];
+    cJSON *args = cJSON_CreateObject();
+
+    memset(big, 'x', sizeof(big) - 1);
+    big[sizeof(big) - 1] = '\0';
+    ASSERT(args && cJSON_AddStringToObject(args, "key", big));
+    ASSERT(!quick_action_build("Big", "memory_get", args, &action, err, sizeof(err)));
+    ASSERT(strstr(err, "too long") != NULL);
+    cJSON_Delete(args);
+    return 0;
+}
+
+TEST(keyboard_rows_and_callback_roundtrip)
+{
+    quick_action_t actions[3];
+    char err[64];
+    char label[QUICK_ACTION_LABEL_MAX_LEN];
+
+    ASSERT(quick_action_build("Relay on", "gpio_write", NULL, &actions[0], err, sizeof(err)));
+    ASSERT(quick_action_build("Sensor", "gpio_read", NULL, &actions[1], err, sizeof(err)));
+    ASSERT(quick_action_build("Schedules", "cron_list", NULL, &actions[2], err, sizeof(err)));
+
+    ASSERT(quick_action_keyboard(actions, 0) == NULL);
+    cJSON *markup = quick_action_keyboard(actions, 3);
+    ASSERT(markup);
+    cJSON *rows = cJSON_GetObjectItem(markup, "inline_keyboard");
+    ASSERT(cJSON_GetArraySize(rows) == (3 + QUICK_ACTION_COLUMNS - 1) / QUICK_ACTION_COLUMNS);
+    cJSON *first = cJSON_GetArrayItem(cJSON_GetArrayItem(rows, 0), 0);
+    ASSERT(strcmp(cJSON_GetObjectItem(first, "text")->valuestring, "Relay on") == 0);
+
+    const char *data = cJSON_GetObjectItem(first, "callback_data")->valuestring;
+    ASSERT(strlen(data) <= 64);
+    ASSERT(quick_action_callback_label(data, label, sizeof(label)));
+    ASSERT(strcmp(label, "Relay on") == 0);
+    cJSON_Delete(markup);
+
+    ASSERT(!quick_action_callback_label("other:Relay on", label, sizeof(label)));
+    ASSERT(!quick_action_callback_label(QUICK_ACTION_CALLBACK_PREFIX, label, sizeof(label)));
+    ASSERT(!quick_action_callback_label(NULL, label, sizeof(label)));
+    return 0;
+}
+
+TEST(menu_command_matching)
+{
+    ASSERT(quick_action_is_menu_command("/actions"));
+    ASSERT(quick_action_is_menu_command("  /actions \n"));
+    ASSERT(quick_action_is_menu_command("/actions@zclaw_bot"));
+    ASSERT(!quick_action_is_menu_command("/actionsx"));
+    ASSERT(!quick_action_is_menu_command("/actions pin relay"));
+    ASSERT(!quick_action_is_menu_command("show /actions"));
+    ASSERT(!quick_action_is_menu_command(NULL));
+    return 0;
+}
+
+TEST(run_dispatches_fixed_args)
+{
+    quick_action_t action;
+    char err[64];
+    char result[128];
+    cJSON *args = cJSON_Parse("{\"pin\":4}");
+
+    ASSERT(args);
+    ASSERT(quick_action_build("Door", "gpio_read", args, &action, err, sizeof(err)));
+    cJSON_Delete(args);
+
+    mock_tools_reset();
+    ASSERT(quick_action_run(&action, result, sizeof(result)));
+    ASSERT(mock_tools_execute_calls() == 1);
+    ASSERT(strcmp(mock_tools_last_name(), "gpio_read") == 0);
+    ASSERT(strcmp(mock_tools_last_input(), "{\"pin\":4}") == 0);
+
+    // A stored record that no longer passes the allowlist never runs.
+    snprintf(action.tool, sizeof(action.tool), "delay");
+    ASSERT(!quick_action_run(&action, result, sizeof(result)));
+    snprintf(action.tool, sizeof(action.tool), "gpio_read");
+    snprintf(action.args, sizeof(action.args), "{broken");
+    ASSERT(!quick_action_run(&action, result, sizeof(result)));
+    ASSERT(mock_tools_execute_calls() == 1);
+    return 0;
+}
+
+TEST(list_formats_actions)
+{
+    quick_action_t actions[2];
+    char err[64];
+    char buf[128];
+
+    quick_action_list(NULL, 0, buf, sizeof(buf));
+    ASSERT(strcmp(buf, "No quick actions pinned") == 0);
+
+    ASSERT(quick_action_build("Time", "get_time", NULL, &actions[0], err, sizeof(err)));
+    ASSERT(quick_action_build("Health", "get_health", NULL, &actions[1], err, sizeof(err)));
+    quick_action_list(actions, 2, buf, sizeof(buf));
+    ASSERT(strcmp(buf, "Time -> get_time {}\nHealth -> get_health {}") == 0);
+
+    // Truncates instead of overrunning.
+    quick_action_list(actions, 2, buf, 16);
+    ASSERT(strlen(buf) == 15);
+    return 0;
+}
+
+int test_quick_actions_all(void)
+{
+    int failures = 0;
+
+    printf("\nQuick Action Tests:\n");
+
+    printf("  build_validates_label_tool_and_args... ");
+    if (test_build_validates_label_tool_and_args() == 0) printf("OK\n"); else failures++;
+
+    printf("  build_rejects_oversized_args... ");
+    if (test_build_rejects_oversized_args() == 0) printf("OK\n"); else failures++;
+
+    printf("  keyboard_rows_and_callback_roundtrip... ");
+    if (test_keyboard_rows_and_callback_roundtrip() == 0) printf("OK\n"); else failures++;
+
+    printf("  menu_command_matching... ");
+    if (test_menu_command_matching() == 0) printf("OK\n"); else failures++;
+
+    printf("  run_dispatches_fixed_args... ");
+    if (test_run_dispatches_fixed_args() == 0) printf("OK\n"); else failures++;
+
+    printf("  list_formats_actions... ");
+    if (test_list_formats_actions() == 0) printf("OK\n"); else failures++;
+
+    return failures;
+}
@@ -12,11 +12,30 @@ extern int test_tools_parse_all(void);
 extern int test_json_util_integration_all(void);
 extern int test_runtime_utils_all(void);
 extern int test_memory_keys_all(void);
+extern int test_quick_actions_all(void);
+extern int test_telegram_outbox_all(void);
 extern int test_telegram_update_all(void);
 extern int test_agent_all(void);
 extern int test_tools_gpio_policy_all(void);
 extern int test_llm_auth_all(void);
 extern int test_tools_media_all(void);
+extern int test_camera_budget_all(void);
+extern int test_motion_detect_all(void);
+extern int test_thumb_ring_all(void);
+extern int test_adpcm_all(void);
+extern int test_vad_all(void);
+extern int test_audio_stats_all(void);
+extern int test_pcm_ring_all(void);
+extern int test_cron_sched_all(void);
+extern int test_cron_expr_all(void);
+extern int test_cron_cond_all(void);
+extern int test_nvs_wb_all(void);
+extern int test_mem_cache_all(void);
+extern int test_zc_store_all(void);
+extern int test_embed_index_all(void);
+extern int test_token_bucket_all(void);
+extern int test_chat_queue_all(void);
+extern int test_chat_context_all(void);
 
 int main(int argc, char *argv[])
 {
@@ -32,11 +51,30 @@ int main(int argc, char *argv[])
     failures += test_json_util_integration_all();
     failures += test_runtime_utils_all();
     failures += test_memory_keys_all();
+    failures += test_quick_actions_all();
+    failures += test_telegram_outbox_all();
     failures += test_telegram_update_all();
     failures += test_agent_all();
     failures += test_tools_gpio_policy_all();
     failures += test_llm_auth_all();
     failures += test_tools_media_all();
+    failures += test_camera_budget_all();
+    failures += test_motion_detect_all();
+    failures += test_thumb_ring_all();
+    failures += test_adpcm_all();
+    failures += test_vad_all();
+    failures += test_audio_stats_all();
+    failures += test_pcm_ring_all();
+    failures += test_cron_sched_all();
+    failures += test_cron_expr_all();
+    failures += test_cron_cond_all();
+    failures += test_nvs_wb_all();
+    failures += test_mem_cache_all();
+    failures += test_zc_store_all();
+    failures += test_embed_index_all();
+    failures += test_token_bucket_all();
+    failures += test_chat_queue_all();
+    failures += test_chat_context_all();
 
     printf("\n===================\n");
     if (failures == 0) {
@@ -0,0 +1,174 @@
+/*
+ * Host tests for outbound Telegram helpers: reply merging, splitting long
+ * text at readable boundaries, 429 retry_after parsing and send pacing.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "telegram_outbox.h"
+
+#define TEST(name) static int test_##name(void)
+#define ASSERT(cond) do { \
+    if (!(cond)) { \
+        printf("  FAIL: %s (line %d)\n", #cond, __LINE__); \
+        return 1; \
+    } \
+} while(0)
+
+TEST(merge_joins_until_limit)
+{
+    char batch[32];
+    size_t len = 0;
+
+    batch[0] = '\0';
+    ASSERT(telegram_outbox_merge(batch, &len, 20, "first"));
+    ASSERT(strcmp(batch, "first") == 0 && len == 5);
+    ASSERT(telegram_outbox_merge(batch, &len, 20, "second"));
+    ASSERT(strcmp(batch, "first\n\nsecond") == 0 && len == 13);
+
+    // Exactly at the limit fits; one byte more leaves the batch untouched.
+    ASSERT(!telegram_outbox_merge(batch, &len, 20, "third!"));
+    ASSERT(strcmp(batch, "first\n\nsecond") == 0 && len == 13);
+    ASSERT(telegram_outbox_merge(batch, &len, 20, "three"));
+    ASSERT(len == 20 && strlen(batch) == 20);
+    return 0;
+}
+
+TEST(split_prefers_paragraph_then_line_then_word)
+{
+    size_t next = 0;
+    const char *para = "aaaa bbbb\ncccc\n\ndddd eeee";
+    const char *line = "aaaa bbbb cc\ndddd eeee ffff";
+    const char *word = "aaaa bbbb cccc dddd eeee";
+
+    ASSERT(telegram_outbox_split(para, strlen(para), 20, &next) == 14);
+    ASSERT(next == 16 && strcmp(para + next, "dddd eeee") == 0);
+
+    ASSERT(telegram_outbox_split(line, strlen(line), 20, &next) == 12);
+    ASSERT(strcmp(line + next, "dddd eeee ffff") == 0);
+
+    ASSERT(telegram_outbox_split(word, strlen(word), 20, &next) == 19);
+    ASSERT(strcmp(word + next, "eeee") == 0);
+
+    // Short text is a single chunk.
+    ASSERT(telegram_outbox_split(word, 4, 20, &next) == 4 && next == 4);
+    return 0;
+}
+
+TEST(split_hard_cut_keeps_utf8_whole)
+{
+    // "aaaaaaa" then three 2-byte sequences, no boundary anywhere.
+    const char *text = "aaaaaaa\xc3\xa9\xc3\xa9\xc3\xa9";
+    size_t next = 0;
+
+    ASSERT(telegram_outbox_split(text, strlen(text), 10, &next) == 9);
+    ASSERT(next == 9);
+    ASSERT(((unsigned char)text[next] & 0xC0) != 0x80);
+
+    // A boundary in the first half of the window is ignored.
+    const char *early = "ab cdefghijklmnop";
+    ASSERT(telegram_outbox_split(early, strlen(early), 10, &next) == 10);
+    return 0;
+}
+
+TEST(retry_after_parsed_and_capped)
+{
+    ASSERT(telegram_outbox_retry_after(
+        "{\"ok\":false,\"error_code\":429,\"description\":\"Too Many Requests\","
+        "\"parameters\":{\"retry_after\":7}}") == 7);
+    ASSERT(telegram_outbox_retry_after(
+        "{\"ok\":false,\"parameters\":{\"retry_after\":99999}}") == TELEGRAM_RETRY_AFTER_MAX_S);
+    ASSERT(telegram_outbox_retry_after("{\"ok\":false,\"error_code\":429}") == -1);
+    ASSERT(telegram_outbox_retry_after("{\"parameters\":{\"retry_after\":\"5\"}}") == -1);
+    ASSERT(telegram_outbox_retry_after("not json") == -1);
+    ASSERT(telegram_outbox_retry_after(NULL) == -1);
+    return 0;
+}
+
+TEST(pacer_spaces_chats_groups_and_global)
+{
+    telegram_pacer_t pacer;
+
+    telegram_pacer_init(&pacer);
+    ASSERT(telegram_pacer_wait_ms(&pacer, 42, 1000) == 0);
+
+    telegram_pacer_sent(&pacer, 42, 1000);
+    ASSERT(telegram_pacer_wait_ms(&pacer, 42, 1000) == TELEGRAM_CHAT_INTERVAL_MS);
+    ASSERT(telegram_pacer_wait_ms(&pacer, 42, 1000 + TELEGRAM_CHAT_INTERVAL_MS) == 0);
+
+    // Another chat only waits for the global spacing.
+    ASSERT(telegram_pacer_wait_ms(&pacer, 43, 1000) == TELEGRAM_GLOBAL_INTERVAL_MS);
+    ASSERT(telegram_pacer_wait_ms(&pacer, 43, 1000 + TELEGRAM_GLOBAL_INTERVAL_MS) == 0);
+
+    // Groups get the slower interval.
+    telegram_pacer_sent(&pacer, -100, 5000);
+    ASSERT(telegram_pacer_wait_ms(&pacer, -100, 5000) == TELEGRAM_GROUP_INTERVAL_MS);
+    return 0;
+}
+
+TEST(pacer_honours_retry_after)
+{
+    telegram_pacer_t pacer;
+
+    telegram_pacer_init(&pacer);
+    telegram_pacer_sent(&pacer, 42, 0);
+    telegram_pacer_retry_after(&pacer, 42, 0, 5);
+    ASSERT(telegram_pacer_wait_ms(&pacer, 42, 0) == 5000);
+
+    // A later normal send does not shorten the hold.
+    telegram_pacer_sent(&pacer, 42, 100);
+    ASSERT(telegram_pacer_wait_ms(&pacer, 42, 100) == 4900);
+
+    telegram_pacer_retry_after(&pacer, 7, 0, 0);
+    ASSERT(telegram_pacer_wait_ms(&pacer, 7, 0) == 1000);
+    telegram_pacer_retry_after(&pacer, 8, 0, 100000);
+    ASSERT(telegram_pacer_wait_ms(&pacer, 8, 0) == (int64_t)TELEGRAM_RETRY_AFTER_MAX_S * 1000);
+    return 0;
+}
+
+TEST(pacer_reuses_expired_chat_entries)
+{
+    telegram_pacer_t pacer;
+
+    telegram_pacer_init(&pacer);
+    for (int i = 0; i < TELEGRAM_MAX_CHATS; i++) {
+        telegram_pacer_sent(&pacer, 100 + i, i * 10);
+    }
+    // Table full: the entry whose hold ends first (chat 100) gives way.
+    telegram_pacer_sent(&pacer, 999, 100);
+    ASSERT(telegram_pacer_wait_ms(&pacer, 999, 100) == TELEGRAM_CHAT_INTERVAL_MS);
+    ASSERT(telegram_pacer_wait_ms(&pacer, 100, 100) == TELEGRAM_GLOBAL_INTERVAL_MS);
+    ASSERT(telegram_pacer_wait_ms(&pacer, 101, 100) == 10 + TELEGRAM_CHAT_INTERVAL_MS - 100);
+    return 0;
+}
+
+int test_telegram_outbox_all(void)
+{
+    int failures = 0;
+
+    printf("\nTelegram Outbox Tests:\n");
+
+    printf("  merge_joins_until_limit... ");
+    if (test_merge_joins_until_limit() == 0) printf("OK\n"); else failures++;
+
+    printf("  split_prefers_paragraph_then_line_then_word... ");
+    if (test_split_prefers_paragraph_then_line_then_word() == 0) printf("OK\n"); else failures++;
+
+    printf("  split_hard_cut_keeps_utf8_whole... ");
+    if (test_split_hard_cut_keeps_utf8_whole() == 0) printf("OK\n"); else failures++;
+
+    printf("  retry_after_parsed_and_capped... ");
+    if (test_retry_after_parsed_and_capped() == 0) printf("OK\n"); else failures++;
+
+    printf("  pacer_spaces_chats_groups_and_global... ");
+    if (test_pacer_spaces_chats_groups_and_global() == 0) printf("OK\n"); else failures++;
+
+    printf("  pacer_honours_retry_after... ");
+    if (test_pacer_honours_retry_after() == 0) printf("OK\n"); else failures++;
+
+    printf("  pacer_reuses_expired_chat_entries... ");
+    if (test_pacer_reuses_expired_chat_entries() == 0) printf("OK\n"); else failures++;
+
+    return failures;
+}
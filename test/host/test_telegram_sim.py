@@ -0,0 +1,261 @@
+#!/usr/bin/env python3
+"""Unit tests for the local Telegram Bot API simulator."""
+
+from __future__ import annotations
+
+import json
+import random
+import sys
+import threading
+import time
+import unittest
+import urllib.error
+import urllib.request
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+from pathlib import Path
+
+
+TEST_DIR = Path(__file__).resolve().parent
+PROJECT_ROOT = TEST_DIR.parent.parent
+sys.path.insert(0, str(PROJECT_ROOT / "scripts"))
+
+from telegram_sim import (  # noqa: E402
+    WEBHOOK_SECRET_HEADER,
+    SimFaults,
+    TelegramSim,
+    TrafficPattern,
+    create_server,
+    parse_pattern_spec,
+    run_webhook,
+    split_bot_path,
+)
+
+
+TOKEN = "123456:test"
+
+
+class TelegramSimHelperTests(unittest.TestCase):
+    def test_parse_pattern_spec(self) -> None:
+        self.assertEqual(parse_pattern_spec("none"), TrafficPattern())
+        self.assertEqual(parse_pattern_spec("steady:2"), TrafficPattern("steady", rate=2.0))
+        self.assertEqual(parse_pattern_spec("burst:20,5"), TrafficPattern("burst", burst_size=20, period_s=5.0))
+        with self.assertRaises(ValueError):
+            parse_pattern_spec("burst:0,5")
+        with self.assertRaises(ValueError):
+            parse_pattern_spec("wave:1")
+
+    def test_burst_pattern_batches(self) -> None:
+        wait_s, count = TrafficPattern("burst", burst_size=5, period_s=2.0).next_batch(random.Random(0))
+        self.assertEqual((wait_s, count), (2.0, 5))
+
+    def test_split_bot_path(self) -> None:
+        self.assertEqual(split_bot_path(f"/bot{TOKEN}/getUpdates"), (TOKEN, "getUpdates"))
+        self.assertIsNone(split_bot_path("/bot/getUpdates"))
+        self.assertIsNone(split_bot_path("/api/getUpdates"))
+
+    def test_offset_confirms_and_limit_caps(self) -> None:
+        sim = TelegramSim(TOKEN, [1, 2])
+        first = sim.inject("a")
+        sim.inject("b")
+        sim.inject("c")
+
+        batch = sim.get_updates(offset=0, limit=2, timeout_s=0)
+        self.assertEqual([u["message"]["text"] for u in batch], ["a", "b"])
+        self.assertEqual([u["message"]["chat"]["id"] for u in batch], [1, 2])
+
+        batch = sim.get_updates(offset=first.update_id + 2, limit=10, timeout_s=0)
+        self.assertEqual([u["message"]["text"] for u in batch], ["c"])
+
+    def test_reply_latency_is_matched_per_chat(self) -> None:
+        sim = TelegramSim(TOKEN, [1, 2])
+        sim.inject("to chat 1", chat_id=1)
+        sim.inject("to chat 2", chat_id=2)
+        sim.get_updates(offset=0, limit=10, timeout_s=0)
+        sim.record_send(2, "reply")
+
+        report = sim.report()
+        self.assertEqual(report["reply_ms"]["n"], 1)
+        self.assertEqual(report["per_chat"]["2"]["replied"], 1)
+        self.assertEqual(report["per_chat"]["1"]["replied"], 0)
+        self.assertEqual(report["unanswered"], 1)
+
+
+class TelegramSimServerTests(unittest.TestCase):
+    def start(self, faults: SimFaults | None = None) -> tuple[str, TelegramSim]:
+        sim = TelegramSim(TOKEN, [42], faults=faults, seed=1)
+        server = create_server("127.0.0.1", 0, sim)
+        thread = threading.Thread(target=server.serve_forever, daemon=True)
+        thread.start()
+        self.addCleanup(thread.join, 1)
+        self.addCleanup(server.server_close)
+        self.addCleanup(server.shutdown)
+        return f"http://127.0.0.1:{server.server_address[1]}", sim
+
+    def request(self, url: str, payload: dict | None = None) -> tuple[int, dict, dict]:
+        data = json.dumps(payload).encode("utf-8") if payload is not None else None
+        req = urllib.request.Request(
+            url,
+            data=data,
+            headers={"Content-Type": "application/json"},
+            method="POST" if data is not None else "GET",
+        )
+        try:
+            with urllib.request.urlopen(req, timeout=5) as resp:
+                return resp.status, dict(resp.headers), json.loads(resp.read())
+        except urllib.error.HTTPError as exc:
+            return exc.code, dict(exc.headers), json.loads(exc.read())
+
+    def test_long_poll_returns_injected_message(self) -> None:
+        base, sim = self.start()
+        timer = threading.Timer(0.1, sim.inject, kwargs={"text": "hello"})
+        timer.start()
+        self.addCleanup(timer.cancel)
+
+        status, _, body = self.request(f"{base}/bot{TOKEN}/getUpdates?timeout=2&limit=1&offset=0")
+        self.assertEqual(status, 200)
+        self.assertTrue(body["ok"])
+        self.assertEqual(body["result"][0]["message"]["text"], "hello")
+
+    def test_bad_token_is_unauthorized(self) -> None:
+        base, _ = self.start()
+        status, _, body = self.request(f"{base}/botwrong/getMe")
+        self.assertEqual(status, 401)
+        self.assertEqual(body["error_code"], 401)
+
+    def test_send_message_flood_wait(self) -> None:
+        base, _ = self.start(SimFaults(send_429_rate=1.0, retry_after_s=9))
+        status, headers, body = self.request(f"{base}/bot{TOKEN}/sendMessage", {"chat_id": 42, "text": "hi"})
+        self.assertEqual(status, 429)
+        self.assertEqual(body["parameters"]["retry_after"], 9)
+        self.assertEqual(headers.get("Retry-After"), "9")
+
+    def drain(self, base: str, limit: int) -> int:
+        """Poll like the firmware until the backlog is confirmed; returns update count."""
+        offset = 0
+        received = 0
+        while True:
+            _, _, body = self.request(f"{base}/bot{TOKEN}/getUpdates?timeout=0&limit={limit}&offset={offset}")
+            if not body["result"]:
+                return received
+            received += len(body["result"])
+            offset = body["result"][-1]["update_id"] + 1
+
+    def test_backlog_drain_needs_fewer_polls_with_batching(self) -> None:
+        for limit, expected_polls in ((1, 24), (8, 3)):
+            base, sim = self.start()
+            sim.preload_backlog(24)
+            self.assertEqual(self.drain(base, limit), 24)
+
+            backlog = sim.report()["backlog"]
+            self.assertEqual(backlog["delivered"], 24)
+            self.assertEqual(backlog["polls"], expected_polls)
+            self.assertGreater(backlog["msgs_per_s"], 0)
+
+    def test_send_message_records_reply(self) -> None:
+        base, sim = self.start()
+        sim.inject("ping", chat_id=42)
+        self.request(f"{base}/bot{TOKEN}/getUpdates?timeout=0&offset=0")
+        status, _, body = self.request(f"{base}/bot{TOKEN}/sendMessage", {"chat_id": 42, "text": "pong"})
+        self.assertEqual(status, 200)
+        self.assertEqual(body["result"]["chat"]["id"], 42)
+
+        _, _, stats = self.request(f"{base}/sim/stats")
+        self.assertEqual(stats["counters"]["sends"], 1)
+        self.assertEqual(stats["reply_ms"]["n"], 1)
+
+
+class FakeWebhookDevice:
+    """Stands in for the firmware's webhook endpoint: checks the secret, answers 503 when busy."""
+
+    def __init__(self, secret: str, busy_first: int = 0) -> None:
+        self.secret = secret
+        self.busy_left = busy_first
+        self.accepted: list[dict] = []
+        self.rejected = 0
+        self.lock = threading.Lock()
+        device = self
+
+        class Handler(BaseHTTPRequestHandler):
+            def log_message(self, fmt: str, *args) -> None:
+                pass
+
+            def do_POST(self) -> None:  # noqa: N802
+                body = self.rfile.read(int(self.headers.get("Content-Length", "0")))
+                with device.lock:
+                    if self.headers.get(WEBHOOK_SECRET_HEADER) != device.secret:
+                        device.rejected += 1
+                        status = 403
+                    elif device.busy_left > 0:
+                        device.busy_left -= 1
+                        status = 503
+                    else:
+                        device.accepted.append(json.loads(body))
+                        status = 200
+                self.send_response(status)
+                self.send_header("Content-Length", "0")
+                self.end_headers()
+
+        self.server = ThreadingHTTPServer(("127.0.0.1", 0), Handler)
+        self.url = f"http://127.0.0.1:{self.server.server_address[1]}/telegram/webhook"
+
+
+class TelegramSimWebhookTests(unittest.TestCase):
+    def push(self, device: FakeWebhookDevice, sim: TelegramSim, secret: str, count: int) -> None:
+        server_thread = threading.Thread(target=device.server.serve_forever, daemon=True)
+        server_thread.start()
+        self.addCleanup(device.server.server_close)
+        self.addCleanup(device.server.shutdown)
+
+        stop = threading.Event()
+        pusher = threading.Thread(target=run_webhook, args=(sim, device.url, secret, stop, 0.01), daemon=True)
+        pusher.start()
+        self.addCleanup(pusher.join, 2)
+        self.addCleanup(stop.set)
+
+        deadline = time.monotonic() + 2.0
+        while time.monotonic() < deadline:
+            with device.lock:
+                if len(device.accepted) >= count or device.rejected:
+                    return
+            time.sleep(0.01)
+
+    def test_updates_are_pushed_in_order_and_retried_while_busy(self) -> None:
+        sim = TelegramSim(TOKEN, [7])
+        sim.webhook_active = True
+        device = FakeWebhookDevice("s3cret", busy_first=2)
+        for text in ("one", "two", "three"):
+            sim.inject(text)
+
+        self.push(device, sim, "s3cret", 3)
+        self.assertEqual([u["message"]["text"] for u in device.accepted], ["one", "two", "three"])
+        report = sim.report()
+        self.assertEqual(report["counters"]["webhook_errors"], 2)
+        self.assertEqual(report["undelivered"], 0)
+        self.assertEqual(report["delivery_ms"]["n"], 3)
+
+        # Telegram refuses getUpdates while a webhook is set.
+        base_server = create_server("127.0.0.1", 0, sim)
+        thread = threading.Thread(target=base_server.serve_forever, daemon=True)
+        thread.start()
+        try:
+            url = f"http://127.0.0.1:{base_server.server_address[1]}/bot{TOKEN}/getUpdates"
+            with self.assertRaises(urllib.error.HTTPError) as ctx:
+                urllib.request.urlopen(url, timeout=5)
+            self.assertEqual(ctx.exception.code, 409)
+        finally:
+            base_server.shutdown()
+            base_server.server_close()
+
+    def test_wrong_secret_is_never_accepted(self) -> None:
+        sim = TelegramSim(TOKEN, [7])
+        device = FakeWebhookDevice("s3cret")
+        sim.inject("hello")
+
+        self.push(device, sim, "guess", 1)
+        self.assertEqual(device.accepted, [])
+        self.assertGreater(device.rejected, 0)
+        self.assertEqual(sim.report()["undelivered"], 1)
+
+
+if __name__ == "__main__":
+    unittest.main()
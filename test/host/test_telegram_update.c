@@ -1,10 +1,13 @@
 /*
- * Host tests for Telegram update_id parsing helpers.
+ * Host tests for Telegram update_id parsing helpers, the streaming
+ * getUpdates splitter and webhook secret checks.
  */
 
 #include <stdio.h>
 #include <stdint.h>
+#include <string.h>
 
+#include "config.h"
 #include "telegram_update.h"
 
 #define TEST(name) static int test_##name(void)
@@ -60,6 +63,179 @@ TEST(parse_invalid_input)
     return 0;
 }
 
+#define MAX_SEEN 8
+
+typedef struct {
+    char json[MAX_SEEN][256];
+    int64_t ids[MAX_SEEN];
+    bool truncated[MAX_SEEN];
+    int count;
+    int stop_after;             // Return false from this update on (0 = never)
+} seen_updates_t;
+
+static bool record_update(const telegram_update_t *update, void *ctx)
+{
+    seen_updates_t *seen = ctx;
+
+    if (seen->count < MAX_SEEN) {
+        seen->ids[seen->count] = update->update_id;
+        seen->truncated[seen->count] = update->json == NULL;
+        snprintf(seen->json[seen->count], sizeof(seen->json[0]), "%s",
+                 update->json ? update->json : "");
+    }
+    seen->count++;
+    return seen->stop_after == 0 || seen->count < seen->stop_after;
+}
+
+static bool feed_in_chunks(telegram_update_stream_t *stream, const char *body, size_t chunk)
+{
+    size_t len = strlen(body);
+    for (size_t off = 0; off < len; off += chunk) {
+        size_t n = len - off < chunk ? len - off : chunk;
+        if (!telegram_update_stream_feed(stream, body + off, n)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static const char *UPDATE_A =
+    "{\"update_id\":9876543210,\"message\":{\"chat\":{\"id\":5},"
+    "\"text\":\"brace } bracket ] quote \\\" \\\"update_id\\\":1\"}}";
+static const char *UPDATE_B =
+    "{ \"message\" : {\"entities\":[{\"offset\":0}],\"text\":\"hi\"}, \"update_id\" : 11 }";
+static const char *UPDATE_C = "{\"update_id\":12,\"edited_message\":{\"text\":\"\\\\\"}}";
+
+TEST(stream_splits_updates_at_any_chunking)
+{
+    char body[768];
+    snprintf(body, sizeof(body), "{\"ok\":true,\"result\":[%s,\n  %s,%s]}", UPDATE_A, UPDATE_B,
+             UPDATE_C);
+
+    for (size_t chunk = 1; chunk <= strlen(body); chunk++) {
+        seen_updates_t seen = {0};
+        telegram_update_stream_t stream;
+
+        telegram_update_stream_init(&stream, 1024, record_update, &seen);
+        ASSERT(feed_in_chunks(&stream, body, chunk));
+        ASSERT(telegram_update_stream_finish(&stream));
+        ASSERT(seen.count == 3);
+        ASSERT(strcmp(seen.json[0], UPDATE_A) == 0);
+        ASSERT(strcmp(seen.json[1], UPDATE_B) == 0);
+        ASSERT(strcmp(seen.json[2], UPDATE_C) == 0);
+        ASSERT(seen.ids[0] == 9876543210LL && seen.ids[1] == 11 && seen.ids[2] == 12);
+        telegram_update_stream_free(&stream);
+    }
+    return 0;
+}
+
+TEST(stream_stops_and_survives_oversize_updates)
+{
+    char body[768];
+    seen_updates_t seen = {0};
+    telegram_update_stream_t stream;
+
+    snprintf(body, sizeof(body), "{\"ok\":true,\"result\":[%s,%s,%s]}", UPDATE_A, UPDATE_B,
+             UPDATE_C);
+
+    // Too big to buffer: the id still comes through so the offset can advance.
+    telegram_update_stream_init(&stream, 64, record_update, &seen);
+    ASSERT(telegram_update_stream_feed(&stream, body, strlen(body)));
+    ASSERT(telegram_update_stream_finish(&stream));
+    ASSERT(seen.count == 3);
+    ASSERT(seen.truncated[0] && seen.ids[0] == 9876543210LL);
+    ASSERT(!seen.truncated[2] && strcmp(seen.json[2], UPDATE_C) == 0);
+    telegram_update_stream_free(&stream);
+
+    // The consumer can stop mid-response; the rest is left for the next poll.
+    memset(&seen, 0, sizeof(seen));
+    seen.stop_after = 2;
+    telegram_update_stream_init(&stream, 1024, record_update, &seen);
+    ASSERT(telegram_update_stream_feed(&stream, body, strlen(body)));
+    ASSERT(telegram_update_stream_finish(&stream));
+    ASSERT(seen.count == 2);
+    telegram_update_stream_free(&stream);
+    return 0;
+}
+
+TEST(stream_reports_incomplete_or_failed_responses)
+{
+    seen_updates_t seen = {0};
+    telegram_update_stream_t stream;
+    char body[768];
+
+    telegram_update_stream_init(&stream, 1024, record_update, &seen);
+    ASSERT(telegram_update_stream_feed(&stream, "{\"ok\":true,\"result\":[]}", 23));
+    ASSERT(telegram_update_stream_finish(&stream));
+    ASSERT(seen.count == 0);
+
+    // A dropped connection keeps what was complete and reports the rest missing.
+    snprintf(body, sizeof(body), "{\"ok\":true,\"result\":[%s,{\"update_id\":11,\"mess", UPDATE_A);
+    telegram_update_stream_init(&stream, 1024, record_update, &seen);
+    ASSERT(telegram_update_stream_feed(&stream, body, strlen(body)));
+    ASSERT(!telegram_update_stream_finish(&stream));
+    ASSERT(seen.count == 1 && seen.ids[0] == 9876543210LL);
+    telegram_update_stream_free(&stream);
+
+    const char *not_ok = "{\"ok\":false,\"error_code\":409,\"description\":\"Conflict\"}";
+    telegram_update_stream_init(&stream, 1024, record_update, &seen);
+    ASSERT(telegram_update_stream_feed(&stream, not_ok, strlen(not_ok)));
+    ASSERT(!telegram_update_stream_finish(&stream));
+
+    telegram_update_stream_init(&stream, 1024, record_update, &seen);
+    ASSERT(!telegram_update_stream_feed(&stream, "{\"ok\":true}}}", 13));
+    ASSERT(!telegram_update_stream_finish(&stream));
+    ASSERT(seen.count == 1);
+    telegram_update_stream_free(&stream);
+    return 0;
+}
+
+TEST(webhook_body_uses_top_level_update_id)
+{
+    seen_updates_t seen = {0};
+    telegram_update_stream_t stream;
+    const char *head = "{\"ok\":true,\"result\":[";
+    const char *body =
+        "{\"update_id\":41,\"message\":{\"text\":\"\\\"update_id\\\":99999999\"}}";
+
+    // The webhook wraps one pushed update the way getUpdates would return it;
+    // an update_id inside message text must not move the confirmed offset.
+    telegram_update_stream_init(&stream, 1024, record_update, &seen);
+    ASSERT(telegram_update_stream_feed(&stream, head, strlen(head)));
+    ASSERT(telegram_update_stream_feed(&stream, body, strlen(body)));
+    ASSERT(telegram_update_stream_feed(&stream, "]}", 2));
+    ASSERT(telegram_update_stream_finish(&stream));
+    ASSERT(seen.count == 1 && seen.ids[0] == 41);
+    telegram_update_stream_free(&stream);
+    return 0;
+}
+
+TEST(webhook_secret_rules_and_match)
+{
+    char longest[TELEGRAM_WEBHOOK_SECRET_MAX_LEN + 2];
+
+    ASSERT(telegram_webhook_secret_is_valid("s3cret_token-A"));
+    ASSERT(!telegram_webhook_secret_is_valid(""));
+    ASSERT(!telegram_webhook_secret_is_valid("has space"));
+    ASSERT(!telegram_webhook_secret_is_valid("semi;colon"));
+    ASSERT(!telegram_webhook_secret_is_valid(NULL));
+    memset(longest, 'a', TELEGRAM_WEBHOOK_SECRET_MAX_LEN);
+    longest[TELEGRAM_WEBHOOK_SECRET_MAX_LEN] = '\0';
+    ASSERT(telegram_webhook_secret_is_valid(longest));
+    longest[TELEGRAM_WEBHOOK_SECRET_MAX_LEN] = 'a';
+    longest[TELEGRAM_WEBHOOK_SECRET_MAX_LEN + 1] = '\0';
+    ASSERT(!telegram_webhook_secret_is_valid(longest));
+
+    ASSERT(telegram_webhook_secret_matches("abc-123", "abc-123"));
+    ASSERT(!telegram_webhook_secret_matches("abc-123", "abc-124"));
+    ASSERT(!telegram_webhook_secret_matches("abc-123", "abc-12"));
+    ASSERT(!telegram_webhook_secret_matches("abc-123", "abc-1234"));
+    ASSERT(!telegram_webhook_secret_matches("abc-123", ""));
+    ASSERT(!telegram_webhook_secret_matches("", ""));
+    ASSERT(!telegram_webhook_secret_matches("abc-123", NULL));
+    return 0;
+}
+
 int test_telegram_update_all(void)
 {
     int failures = 0;
@@ -101,5 +277,40 @@ int test_telegram_update_all(void)
         failures++;
     }
 
+    printf("  stream_splits_updates_at_any_chunking... ");
+    if (test_stream_splits_updates_at_any_chunking() == 0) {
+        printf("OK\n");
+    } else {
+        failures++;
+    }
+
+    printf("  stream_stops_and_survives_oversize_updates... ");
+    if (test_stream_stops_and_survives_oversize_updates() == 0) {
+        printf("OK\n");
+    } else {
+        failures++;
+    }
+
+    printf("  stream_reports_incomplete_or_failed_responses... ");
+    if (test_stream_reports_incomplete_or_failed_responses() == 0) {
+        printf("OK\n");
+    } else {
+        failures++;
+    }
+
+    printf("  webhook_body_uses_top_level_update_id... ");
+    if (test_webhook_body_uses_top_level_update_id() == 0) {
+        printf("OK\n");
+    } else {
+        failures++;
+    }
+
+    printf("  webhook_secret_rules_and_match... ");
+    if (test_webhook_secret_rules_and_match() == 0) {
+        printf("OK\n");
+    } else {
+        failures++;
+    }
+
     return failures;
 }
@@ -0,0 +1,221 @@
+/*
+ * Host tests for the time-lapse thumbnail ring and contact sheet layout.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "thumb_ring.h"
+
+#define TEST(name) static int test_##name(void)
+#define ASSERT(cond) do { \
+    if (!(cond)) { \
+        printf("  FAIL: %s (line %d)\n", #cond, __LINE__); \
+        return 1; \
+    } \
+} while(0)
+
+// Frame n is len bytes of the value n, so a clobbered frame shows.
+static bool push_frame(thumb_ring_t *ring, int n, size_t len)
+{
+    uint8_t data[512];
+
+    memset(data, n & 0xFF, len);
+    return thumb_ring_push(ring, (int64_t)n * 1000, data, len);
+}
+
+static bool frame_intact(const thumb_ring_t *ring, const thumb_entry_t *entry)
+{
+    uint8_t expected = (uint8_t)((entry->time_ms / 1000) & 0xFF);
+
+    for (uint32_t i = 0; i < entry->len; i++) {
+        if (ring->arena[entry->offset + i] != expected) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static uint16_t pixel_at(const thumb_sheet_t *sheet, const uint8_t *canvas, int x, int y)
+{
+    const uint8_t *p = canvas + ((size_t)y * sheet->width + x) * 2;
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+TEST(push_keeps_newest_frames_intact)
+{
+    static uint8_t arena[1000];
+    thumb_ring_t ring;
+
+    thumb_ring_init(&ring, arena, sizeof(arena));
+    ASSERT(!push_frame(&ring, 0, 0));
+    ASSERT(thumb_ring_get(&ring, 0) == NULL);
+
+    // Uneven sizes force wraps that waste a different tail each lap.
+    for (int n = 1; n <= 200; n++) {
+        ASSERT(push_frame(&ring, n, (size_t)(60 + (n * 37) % 180)));
+        ASSERT(ring.count >= 1);
+        ASSERT(thumb_ring_get(&ring, ring.count - 1)->time_ms == (int64_t)n * 1000);
+
+        size_t total = 0;
+        for (int i = 0; i < ring.count; i++) {
+            const thumb_entry_t *entry = thumb_ring_get(&ring, i);
+            ASSERT(frame_intact(&ring, entry));
+            ASSERT(entry->offset + entry->len <= sizeof(arena));
+            if (i > 0) {
+                ASSERT(entry->time_ms == thumb_ring_get(&ring, i - 1)->time_ms + 1000);
+            }
+            total += entry->len;
+        }
+        ASSERT(total <= sizeof(arena));
+        // Only a wasted tail and the frame that did not fit are lost.
+        ASSERT(n == 1 || ring.count >= 2);
+    }
+    return 0;
+}
+
+TEST(push_rejects_oversized_and_caps_frame_count)
+{
+    static uint8_t arena[THUMB_RING_MAX_FRAMES * 4];
+    static uint8_t big[sizeof(arena) + 1];
+    thumb_ring_t ring;
+
+    thumb_ring_init(&ring, arena, sizeof(arena));
+    ASSERT(!thumb_ring_push(&ring, 0, big, sizeof(big)));
+    ASSERT(ring.count == 0);
+
+    for (int n = 0; n < THUMB_RING_MAX_FRAMES + 10; n++) {
+        ASSERT(push_frame(&ring, n, 1));
+    }
+    ASSERT(ring.count == THUMB_RING_MAX_FRAMES);
+    ASSERT(thumb_ring_get(&ring, 0)->time_ms == 10 * 1000);
+
+    // A frame the size of the whole arena replaces everything.
+    ASSERT(thumb_ring_push(&ring, 999000, big, sizeof(arena)));
+    ASSERT(ring.count == 1);
+    return 0;
+}
+
+TEST(select_spreads_over_range)
+{
+    static uint8_t arena[4096];
+    thumb_ring_t ring;
+    int picks[THUMB_SHEET_MAX_TILES];
+
+    thumb_ring_init(&ring, arena, sizeof(arena));
+    for (int n = 0; n < 60; n++) {
+        ASSERT(push_frame(&ring, n, 16));
+    }
+
+    // Frames 10..40 (31 of them) into 4 picks: both ends, evenly between.
+    ASSERT(thumb_ring_select(&ring, 10000, 40000, 4, picks) == 4);
+    ASSERT(picks[0] == 10 && picks[1] == 20 && picks[2] == 30 && picks[3] == 40);
+
+    // Fewer frames than slots: all of them.
+    ASSERT(thumb_ring_select(&ring, 55500, 100000, 16, picks) == 4);
+    ASSERT(picks[0] == 56 && picks[3] == 59);
+
+    ASSERT(thumb_ring_select(&ring, 0, 59000, 1, picks) == 1 && picks[0] == 59);
+    ASSERT(thumb_ring_select(&ring, 70000, 80000, 4, picks) == 0);
+    ASSERT(thumb_ring_select(&ring, 0, 59000, 0, picks) == 0);
+
+    int count = thumb_ring_select(&ring, 0, 59000, THUMB_SHEET_MAX_TILES, picks);
+    ASSERT(count == THUMB_SHEET_MAX_TILES);
+    ASSERT(picks[0] == 0 && picks[count - 1] == 59);
+    for (int i = 1; i < count; i++) {
+        ASSERT(picks[i] > picks[i - 1]);
+    }
+    return 0;
+}
+
+TEST(sheet_layout_grids)
+{
+    static const int expected[][3] = {
+        { 1, 1, 1 }, { 2, 2, 1 }, { 3, 2, 2 }, { 4, 2, 2 }, { 5, 3, 2 },
+        { 6, 3, 2 }, { 7, 3, 3 }, { 9, 3, 3 }, { 10, 4, 3 }, { 13, 4, 4 }, { 16, 4, 4 },
+    };
+    thumb_sheet_t sheet;
+
+    for (size_t i = 0; i < sizeof(expected) / sizeof(expected[0]); i++) {
+        thumb_sheet_layout(expected[i][0], &sheet);
+        ASSERT(sheet.cols == expected[i][1]);
+        ASSERT(sheet.rows == expected[i][2]);
+    }
+    thumb_sheet_layout(0, &sheet);
+    ASSERT(sheet.cols == 1 && sheet.rows == 1);
+
+    thumb_sheet_layout(THUMB_SHEET_MAX_TILES, &sheet);
+    ASSERT(sheet.width == 4 * THUMB_TILE_W + 3 * THUMB_SHEET_GUTTER);
+    ASSERT(sheet.height == 4 * THUMB_TILE_H + 3 * THUMB_SHEET_GUTTER);
+    return 0;
+}
+
+TEST(sheet_place_copies_tile_and_numbers_it)
+{
+    static uint8_t tile[THUMB_TILE_W * THUMB_TILE_H * 2];
+    thumb_sheet_t sheet;
+
+    thumb_sheet_layout(12, &sheet);
+    uint8_t *canvas = malloc((size_t)sheet.width * sheet.height * 2);
+    ASSERT(canvas != NULL);
+    thumb_sheet_clear(&sheet, canvas);
+    uint16_t gutter = pixel_at(&sheet, canvas, 0, 0);
+
+    // Solid green tile into slot 10 (row 2, col 2 of 4x3), labelled "11".
+    for (size_t i = 0; i < sizeof(tile); i += 2) {
+        tile[i] = 0x07;
+        tile[i + 1] = 0xE0;
+    }
+    thumb_sheet_place(&sheet, canvas, 10, tile);
+
+    int x0 = 2 * (THUMB_TILE_W + THUMB_SHEET_GUTTER);
+    int y0 = 2 * (THUMB_TILE_H + THUMB_SHEET_GUTTER);
+    int ok = pixel_at(&sheet, canvas, x0 + THUMB_TILE_W - 1, y0 + THUMB_TILE_H - 1) == 0x07E0 &&
+             pixel_at(&sheet, canvas, x0 + THUMB_TILE_W / 2, y0 + THUMB_TILE_H / 2) == 0x07E0 &&
+             pixel_at(&sheet, canvas, x0 - 1, y0) == gutter &&
+             pixel_at(&sheet, canvas, x0 + THUMB_TILE_W, y0) == gutter &&
+             pixel_at(&sheet, canvas, x0, y0 - 1) == gutter &&
+             pixel_at(&sheet, canvas, 0, y0) == gutter;
+
+    // Label corner is black, with white digit strokes inside it.
+    int white = 0;
+    for (int y = y0; y < y0 + 14; y++) {
+        for (int x = x0; x < x0 + 20; x++) {
+            white += pixel_at(&sheet, canvas, x, y) == 0xFFFF;
+        }
+    }
+    ok = ok && pixel_at(&sheet, canvas, x0, y0) == 0x0000 && white > 0;
+
+    // Out-of-range slots are ignored.
+    thumb_sheet_place(&sheet, canvas, 12, tile);
+    ok = ok && pixel_at(&sheet, canvas, sheet.width - 1, sheet.height - 1) == gutter;
+
+    free(canvas);
+    ASSERT(ok);
+    return 0;
+}
+
+int test_thumb_ring_all(void)
+{
+    int failures = 0;
+
+    printf("\nThumb Ring Tests:\n");
+
+    printf("  push_keeps_newest_frames_intact... ");
+    if (test_push_keeps_newest_frames_intact() == 0) printf("OK\n"); else failures++;
+
+    printf("  push_rejects_oversized_and_caps_frame_count... ");
+    if (test_push_rejects_oversized_and_caps_frame_count() == 0) printf("OK\n"); else failures++;
+
+    printf("  select_spreads_over_range... ");
+    if (test_select_spreads_over_range() == 0) printf("OK\n"); else failures++;
+
+    printf("  sheet_layout_grids... ");
+    if (test_sheet_layout_grids() == 0) printf("OK\n"); else failures++;
+
+    printf("  sheet_place_copies_tile_and_numbers_it... ");
+    if (test_sheet_place_copies_tile_and_numbers_it() == 0) printf("OK\n"); else failures++;
+
+    return failures;
+}
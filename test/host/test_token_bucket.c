@@ -0,0 +1,153 @@
+/*
+ * Host tests for the token-bucket rate limiter core: continuous refill,
+ * debt and retry times, fractional refills, and the persisted record.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "token_bucket.h"
+
+#define TEST(name) static int test_##name(void)
+#define ASSERT(cond) do { \
+    if (!(cond)) { \
+        printf("  FAIL: %s (line %d)\n", #cond, __LINE__); \
+        return 1; \
+    } \
+} while(0)
+
+#define HOUR_MS (3600LL * 1000)
+
+TEST(refill_is_continuous)
+{
+    token_bucket_t bucket;
+
+    // 3600 tokens per hour == 1 token per second.
+    token_bucket_init(&bucket, 3600, 3600, 0);
+    ASSERT(token_bucket_available(&bucket) == 3600);
+    ASSERT(token_bucket_retry_s(&bucket) == 0);
+
+    token_bucket_charge(&bucket, 3600, 10 * 1000);
+    ASSERT(token_bucket_available(&bucket) == 0);
+    ASSERT(token_bucket_retry_s(&bucket) == 1);
+
+    // No calendar boundary: half an hour later exactly half is back.
+    token_bucket_refill(&bucket, 10 * 1000 + HOUR_MS / 2);
+    ASSERT(token_bucket_available(&bucket) == 1800);
+    token_bucket_refill(&bucket, 10 * 1000 + 5 * HOUR_MS);
+    ASSERT(token_bucket_available(&bucket) == 3600);
+    return 0;
+}
+
+TEST(debt_sets_exact_retry_time)
+{
+    token_bucket_t bucket;
+
+    token_bucket_init(&bucket, 3600, 3600, 0);
+    // Usage is only known after the response, so one request can overdraw.
+    token_bucket_charge(&bucket, 5400, 0);
+    ASSERT(token_bucket_available(&bucket) == 0);
+    ASSERT(token_bucket_retry_s(&bucket) == 1801);
+
+    token_bucket_refill(&bucket, 1800 * 1000);
+    ASSERT(token_bucket_retry_s(&bucket) == 1);
+    token_bucket_refill(&bucket, 1801 * 1000);
+    ASSERT(token_bucket_retry_s(&bucket) == 0);
+
+    // Debt never exceeds one full window.
+    token_bucket_init(&bucket, 3600, 3600, 0);
+    token_bucket_charge(&bucket, 1000000, 0);
+    ASSERT(token_bucket_retry_s(&bucket) == 3601);
+
+    token_bucket_init(&bucket, 0, 60, 0);
+    ASSERT(token_bucket_retry_s(&bucket) == 60);
+    return 0;
+}
+
+TEST(frequent_refills_keep_fractions)
+{
+    token_bucket_t bucket;
+    int64_t now = 0;
+
+    // 100 tokens per day: well under one millitoken per 100 ms tick.
+    token_bucket_init(&bucket, 100, 86400, now);
+    token_bucket_charge(&bucket, 100, now);
+    for (int i = 0; i < 8640; i++) {
+        now += 100;
+        token_bucket_refill(&bucket, now);
+    }
+    ASSERT(bucket.level >= 990 && bucket.level <= 1000);
+
+    // A clock that steps backwards refills nothing.
+    int64_t level = bucket.level;
+    token_bucket_refill(&bucket, now - 5000);
+    ASSERT(bucket.level == level);
+    return 0;
+}
+
+TEST(credit_covers_downtime)
+{
+    token_bucket_t bucket;
+
+    token_bucket_init(&bucket, 3600, 3600, 0);
+    token_bucket_charge(&bucket, 3600, 0);
+    token_bucket_credit(&bucket, 600 * 1000);
+    ASSERT(token_bucket_available(&bucket) == 600);
+    token_bucket_credit(&bucket, -5000);
+    ASSERT(token_bucket_available(&bucket) == 600);
+    token_bucket_credit(&bucket, 365LL * 24 * HOUR_MS);
+    ASSERT(token_bucket_available(&bucket) == 3600);
+    return 0;
+}
+
+TEST(record_roundtrip_and_rejects_garbage)
+{
+    token_bucket_t buckets[3];
+    int64_t levels[3];
+    int64_t wall_s;
+    char text[96];
+
+    token_bucket_init(&buckets[0], 1000, 3600, 0);
+    token_bucket_init(&buckets[1], 5000, 86400, 0);
+    token_bucket_init(&buckets[2], 2000, 3600, 0);
+    token_bucket_charge(&buckets[1], 1200, 0);
+    token_bucket_charge(&buckets[2], 2500, 0);
+
+    size_t len = token_bucket_encode(buckets, 3, 1700000000, text, sizeof(text));
+    ASSERT(len == strlen(text));
+    ASSERT(strcmp(text, "v1 1700000000 1000 3800 -500") == 0);
+    ASSERT(token_bucket_decode(text, levels, 3, &wall_s));
+    ASSERT(wall_s == 1700000000 && levels[0] == 1000 && levels[1] == 3800 && levels[2] == -500);
+
+    ASSERT(token_bucket_encode(buckets, 3, 1700000000, text, 12) == 0);
+    ASSERT(!token_bucket_decode("v1 1700000000 1000 3800", levels, 3, &wall_s));
+    ASSERT(!token_bucket_decode("v1 1700000000 1000 3800 -500 7", levels, 3, &wall_s));
+    ASSERT(!token_bucket_decode("v2 1700000000 1000 3800 -500", levels, 3, &wall_s));
+    ASSERT(!token_bucket_decode("v1 x 1 2 3", levels, 3, &wall_s));
+    ASSERT(!token_bucket_decode("", levels, 3, &wall_s));
+    return 0;
+}
+
+int test_token_bucket_all(void)
+{
+    int failures = 0;
+
+    printf("\nToken Bucket Tests:\n");
+
+    printf("  refill_is_continuous... ");
+    if (test_refill_is_continuous() == 0) printf("OK\n"); else failures++;
+
+    printf("  debt_sets_exact_retry_time... ");
+    if (test_debt_sets_exact_retry_time() == 0) printf("OK\n"); else failures++;
+
+    printf("  frequent_refills_keep_fractions... ");
+    if (test_frequent_refills_keep_fractions() == 0) printf("OK\n"); else failures++;
+
+    printf("  credit_covers_downtime... ");
+    if (test_credit_covers_downtime() == 0) printf("OK\n"); else failures++;
+
+    printf("  record_roundtrip_and_rejects_garbage... ");
+    if (test_record_roundtrip_and_rejects_garbage() == 0) printf("OK\n"); else failures++;
+
+    return failures;
+}
@@ -87,6 +87,84 @@ TEST(base64_hello)
     return 0;
 }
 
+// Byte-at-a-time RFC 4648 reference for the table-driven encoder.
+static void reference_base64(const uint8_t *data, size_t len, char *out)
+{
+    static const char table[] =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    size_t j = 0;
+
+    for (size_t i = 0; i < len; i += 3) {
+        uint32_t b0 = data[i];
+        uint32_t b1 = i + 1 < len ? data[i + 1] : 0;
+        uint32_t b2 = i + 2 < len ? data[i + 2] : 0;
+        uint32_t triple = (b0 << 16) | (b1 << 8) | b2;
+        out[j++] = table[(triple >> 18) & 0x3F];
+        out[j++] = table[(triple >> 12) & 0x3F];
+        out[j++] = i + 1 < len ? table[(triple >> 6) & 0x3F] : '=';
+        out[j++] = i + 2 < len ? table[triple & 0x3F] : '=';
+    }
+    out[j] = '\0';
+}
+
+TEST(base64_matches_reference_all_lengths)
+{
+    uint8_t data[300];
+    char expected[4 * (sizeof(data) / 3 + 1) + 1];
+
+    // Every byte value, at every length through the 12-byte blocks and tails.
+    for (size_t i = 0; i < sizeof(data); i++) {
+        data[i] = (uint8_t)(i * 151 + 7);
+    }
+    for (size_t len = 0; len <= sizeof(data); len++) {
+        size_t out_len = 0;
+        char *b64 = media_test_base64_encode(data, len, &out_len);
+        ASSERT(b64 != NULL);
+        reference_base64(data, len, expected);
+        ASSERT(out_len == strlen(expected));
+        ASSERT_STR_EQ(b64, expected);
+        free(b64);
+    }
+    return 0;
+}
+
+// Collects a streamed request body.
+typedef struct {
+    char *buf;
+    size_t len;
+    size_t cap;
+    int writes;
+} body_sink_t;
+
+static bool sink_write(const char *data, size_t len, void *ctx)
+{
+    body_sink_t *sink = (body_sink_t *)ctx;
+    if (sink->len + len >= sink->cap) {
+        return false;
+    }
+    memcpy(sink->buf + sink->len, data, len);
+    sink->len += len;
+    sink->buf[sink->len] = '\0';
+    sink->writes++;
+    return true;
+}
+
+// Build the full request body the way llm.c sends it. Caller frees.
+static char *expand_request(const char *request_json, int *writes_out)
+{
+    body_sink_t sink = { NULL, 0, media_request_body_len(request_json) + 1, 0 };
+    sink.buf = malloc(sink.cap);
+    if (!sink.buf || !media_write_request_body(request_json, sink_write, &sink) ||
+        sink.len != sink.cap - 1) {
+        free(sink.buf);
+        return NULL;
+    }
+    if (writes_out) {
+        *writes_out = sink.writes;
+    }
+    return sink.buf;
+}
+
 // --- Pending image state tests ---
 
 TEST(pending_initially_empty)
@@ -94,10 +172,10 @@ TEST(pending_initially_empty)
     media_release_pending();
     ASSERT(!media_has_pending_image());
 
-    const char *b64 = NULL;
+    const uint8_t *jpeg = NULL;
     size_t len = 0;
     const char *tool_id = NULL;
-    ASSERT(!media_get_pending_image(&b64, &len, &tool_id));
+    ASSERT(!media_get_pending_image(&jpeg, &len, &tool_id));
     return 0;
 }
 
@@ -105,19 +183,19 @@ TEST(pending_inject_and_retrieve)
 {
     media_release_pending();
 
-    const char *test_b64 = "dGVzdA==";
-    media_test_inject_image(test_b64, strlen(test_b64));
+    const uint8_t test_jpeg[] = {0xFF, 0xD8, 0xFF, 0xE0};
+    media_test_inject_image(test_jpeg, sizeof(test_jpeg));
     media_set_pending_tool_id("toolu_123");
 
     ASSERT(media_has_pending_image());
 
-    const char *b64 = NULL;
+    const uint8_t *jpeg = NULL;
     size_t len = 0;
     const char *tool_id = NULL;
-    ASSERT(media_get_pending_image(&b64, &len, &tool_id));
-    ASSERT(b64 != NULL);
-    ASSERT_STR_EQ(b64, "dGVzdA==");
-    ASSERT(len == strlen("dGVzdA=="));
+    ASSERT(media_get_pending_image(&jpeg, &len, &tool_id));
+    ASSERT(jpeg != NULL);
+    ASSERT(len == sizeof(test_jpeg));
+    ASSERT(memcmp(jpeg, test_jpeg, len) == 0);
     ASSERT_STR_EQ(tool_id, "toolu_123");
 
     media_release_pending();
@@ -127,16 +205,16 @@ TEST(pending_inject_and_retrieve)
 
 TEST(pending_release_clears_state)
 {
-    const char *test_b64 = "AAAA";
-    media_test_inject_image(test_b64, 4);
+    const uint8_t test_jpeg[] = {0, 0, 0};
+    media_test_inject_image(test_jpeg, sizeof(test_jpeg));
     media_set_pending_tool_id("tool_456");
     ASSERT(media_has_pending_image());
 
     media_release_pending();
     ASSERT(!media_has_pending_image());
 
-    const char *b64 = NULL;
-    ASSERT(!media_get_pending_image(&b64, NULL, NULL));
+    const uint8_t *jpeg = NULL;
+    ASSERT(!media_get_pending_image(&jpeg, NULL, NULL));
     return 0;
 }
 
@@ -154,9 +232,9 @@ TEST(json_anthropic_image_in_tool_result)
 {
     mock_llm_set_backend(LLM_BACKEND_ANTHROPIC, "claude-test");
 
-    // Set up pending image
-    const char *test_b64 = "/9j/fake_jpeg_data";
-    media_test_inject_image(test_b64, strlen(test_b64));
+    // Set up pending image ("/9j/4AAQ" in base64)
+    const uint8_t test_jpeg[] = {0xFF, 0xD8, 0xFF, 0xE0, 0x00, 0x10};
+    media_test_inject_image(test_jpeg, sizeof(test_jpeg));
     media_set_pending_tool_id("toolu_photo_001");
 
     // Build history: assistant tool_use + user tool_result
@@ -176,7 +254,11 @@ TEST(json_anthropic_image_in_tool_result)
     history[1].is_tool_result = true;
     strncpy(history[1].tool_id, "toolu_photo_001", sizeof(history[1].tool_id));
 
-    char *json = json_build_request("test prompt", history, 2, NULL, NULL, 0);
+    char *request = json_build_request("test prompt", history, 2, NULL, NULL, 0);
+    ASSERT(request != NULL);
+    ASSERT(strstr(request, MEDIA_IMAGE_SLOT) != NULL);
+    char *json = expand_request(request, NULL);
+    free(request);
     ASSERT(json != NULL);
 
     // Verify the JSON contains image block
@@ -214,7 +296,7 @@ TEST(json_anthropic_image_in_tool_result)
     ASSERT_STR_EQ(media_type->valuestring, "image/jpeg");
     cJSON *data = cJSON_GetObjectItem(source, "data");
     ASSERT(data != NULL && cJSON_IsString(data));
-    ASSERT_STR_EQ(data->valuestring, "/9j/fake_jpeg_data");
+    ASSERT_STR_EQ(data->valuestring, "/9j/4AAQ");
 
     // Second content item: text
     cJSON *text_item = cJSON_GetArrayItem(tr_content, 1);
@@ -231,9 +313,9 @@ TEST(json_openai_image_as_user_message)
 {
     mock_llm_set_backend(LLM_BACKEND_OPENAI, "gpt-test");
 
-    // Set up pending image
-    const char *test_b64 = "/9j/fake_jpeg";
-    media_test_inject_image(test_b64, strlen(test_b64));
+    // Set up pending image ("/9j/" in base64)
+    const uint8_t test_jpeg[] = {0xFF, 0xD8, 0xFF};
+    media_test_inject_image(test_jpeg, sizeof(test_jpeg));
     media_set_pending_tool_id("call_photo_002");
 
     // Build history: assistant tool_use + user tool_result
@@ -251,7 +333,10 @@ TEST(json_openai_image_as_user_message)
     history[1].is_tool_result = true;
     strncpy(history[1].tool_id, "call_photo_002", sizeof(history[1].tool_id));
 
-    char *json = json_build_request("test prompt", history, 2, NULL, NULL, 0);
+    char *request = json_build_request("test prompt", history, 2, NULL, NULL, 0);
+    ASSERT(request != NULL);
+    char *json = expand_request(request, NULL);
+    free(request);
     ASSERT(json != NULL);
 
     cJSON *root = cJSON_Parse(json);
@@ -282,7 +367,7 @@ TEST(json_openai_image_as_user_message)
     cJSON *url = cJSON_GetObjectItem(img_url_obj, "url");
     ASSERT(url != NULL && cJSON_IsString(url));
     // Should start with data:image/jpeg;base64,
-    ASSERT(strstr(url->valuestring, "data:image/jpeg;base64,/9j/fake_jpeg") != NULL);
+    ASSERT_STR_EQ(url->valuestring, "data:image/jpeg;base64,/9j/");
 
     cJSON_Delete(root);
     free(json);
@@ -320,6 +405,123 @@ TEST(json_no_image_when_no_pending)
     return 0;
 }
 
+TEST(json_user_message_carries_event_image)
+{
+    const uint8_t test_jpeg[] = {0xFF, 0xD8, 0xFF};
+    conversation_msg_t history[3];
+    memset(history, 0, sizeof(history));
+
+    strncpy(history[0].role, "user", sizeof(history[0].role));
+    strncpy(history[0].content, "watch the door", sizeof(history[0].content));
+    strncpy(history[1].role, "assistant", sizeof(history[1].role));
+    strncpy(history[1].content, "Watching.", sizeof(history[1].content));
+    strncpy(history[2].role, "user", sizeof(history[2].role));
+    strncpy(history[2].content, "[MOTION] 3 of 48 areas changed, left.", sizeof(history[2].content));
+
+    for (int openai = 0; openai < 2; openai++) {
+        mock_llm_set_backend(openai ? LLM_BACKEND_OPENAI : LLM_BACKEND_ANTHROPIC, "test");
+        media_test_inject_image(test_jpeg, sizeof(test_jpeg));
+        media_set_pending_tool_id(MEDIA_USER_IMAGE_ID);
+
+        char *request = json_build_request("test prompt", history, 3, NULL, NULL, 0);
+        ASSERT(request != NULL);
+        char *json = expand_request(request, NULL);
+        free(request);
+        ASSERT(json != NULL);
+        cJSON *root = cJSON_Parse(json);
+        free(json);
+        ASSERT(root != NULL);
+
+        cJSON *messages = cJSON_GetObjectItem(root, "messages");
+        int count = cJSON_GetArraySize(messages);
+        ASSERT(count == (openai ? 4 : 3));
+
+        // Earlier user text stays a plain string.
+        cJSON *first = cJSON_GetArrayItem(messages, openai ? 1 : 0);
+        ASSERT(cJSON_IsString(cJSON_GetObjectItem(first, "content")));
+
+        cJSON *last = cJSON_GetArrayItem(messages, count - 1);
+        ASSERT_STR_EQ(cJSON_GetObjectItem(last, "role")->valuestring, "user");
+        cJSON *content = cJSON_GetObjectItem(last, "content");
+        ASSERT(content != NULL && cJSON_IsArray(content) && cJSON_GetArraySize(content) == 2);
+        cJSON *img = cJSON_GetArrayItem(content, 0);
+        cJSON *text = cJSON_GetArrayItem(content, 1);
+        if (openai) {
+            ASSERT_STR_EQ(cJSON_GetObjectItem(img, "type")->valuestring, "image_url");
+            ASSERT_STR_EQ(cJSON_GetObjectItem(cJSON_GetObjectItem(img, "image_url"), "url")->valuestring,
+                          "data:image/jpeg;base64,/9j/");
+        } else {
+            ASSERT_STR_EQ(cJSON_GetObjectItem(img, "type")->valuestring, "image");
+            ASSERT_STR_EQ(cJSON_GetObjectItem(cJSON_GetObjectItem(img, "source"), "data")->valuestring,
+                          "/9j/");
+        }
+        ASSERT_STR_EQ(cJSON_GetObjectItem(text, "text")->valuestring,
+                      "[MOTION] 3 of 48 areas changed, left.");
+        cJSON_Delete(root);
+
+        // Once the turn moves on, the photo no longer attaches to anything.
+        char *later = json_build_request("test prompt", history, 2, NULL, NULL, 0);
+        ASSERT(later != NULL);
+        ASSERT(strstr(later, MEDIA_IMAGE_SLOT) == NULL);
+        free(later);
+        media_release_pending();
+    }
+    return 0;
+}
+
+TEST(stream_body_matches_whole_encode)
+{
+    // Several chunks with a partial triple at the end.
+    uint8_t jpeg[MEDIA_B64_CHUNK_BYTES * 3 + 2];
+    for (size_t i = 0; i < sizeof(jpeg); i++) {
+        jpeg[i] = (uint8_t)(i * 7 + 3);
+    }
+    size_t b64_len = 0;
+    char *b64 = media_test_base64_encode(jpeg, sizeof(jpeg), &b64_len);
+    ASSERT(b64 != NULL);
+
+    const char *request = "{\"a\":\"" MEDIA_IMAGE_SLOT "\",\"b\":1}";
+    media_test_inject_image(jpeg, sizeof(jpeg));
+    ASSERT(media_request_body_len(request) == strlen(request) - strlen(MEDIA_IMAGE_SLOT) + b64_len);
+
+    int writes = 0;
+    char *body = expand_request(request, &writes);
+    ASSERT(body != NULL);
+    ASSERT(writes == 2 + 4);
+    ASSERT(strncmp(body, "{\"a\":\"", 6) == 0);
+    ASSERT(strncmp(body + 6, b64, b64_len) == 0);
+    ASSERT_STR_EQ(body + 6 + b64_len, "\",\"b\":1}");
+
+    free(body);
+    free(b64);
+    media_release_pending();
+
+    // Without an image the slot is left alone and the body is one write.
+    body = expand_request(request, &writes);
+    ASSERT(body != NULL && writes == 1);
+    ASSERT_STR_EQ(body, request);
+    free(body);
+    return 0;
+}
+
+TEST(message_text_cannot_fake_image_slot)
+{
+    mock_llm_set_backend(LLM_BACKEND_ANTHROPIC, "claude-test");
+    const uint8_t test_jpeg[] = {0xFF, 0xD8, 0xFF};
+    media_test_inject_image(test_jpeg, sizeof(test_jpeg));
+    media_set_pending_tool_id("toolu_other");
+
+    char *request = json_build_request("test prompt", NULL, 0,
+                                       "say " MEDIA_IMAGE_SLOT " please", NULL, 0);
+    ASSERT(request != NULL);
+    ASSERT(strstr(request, MEDIA_IMAGE_SLOT) == NULL);
+    ASSERT(media_request_body_len(request) == strlen(request));
+
+    free(request);
+    media_release_pending();
+    return 0;
+}
+
 // --- Test runner ---
 
 int test_tools_media_all(void)
@@ -343,6 +545,9 @@ int test_tools_media_all(void)
     printf("  base64_hello... ");
     if (test_base64_hello() == 0) printf("OK\n"); else failures++;
 
+    printf("  base64_matches_reference_all_lengths... ");
+    if (test_base64_matches_reference_all_lengths() == 0) printf("OK\n"); else failures++;
+
     printf("  pending_initially_empty... ");
     if (test_pending_initially_empty() == 0) printf("OK\n"); else failures++;
 
@@ -364,5 +569,14 @@ int test_tools_media_all(void)
     printf("  json_no_image_when_no_pending... ");
     if (test_json_no_image_when_no_pending() == 0) printf("OK\n"); else failures++;
 
+    printf("  json_user_message_carries_event_image... ");
+    if (test_json_user_message_carries_event_image() == 0) printf("OK\n"); else failures++;
+
+    printf("  stream_body_matches_whole_encode... ");
+    if (test_stream_body_matches_whole_encode() == 0) printf("OK\n"); else failures++;
+
+    printf("  message_text_cannot_fake_image_slot... ");
+    if (test_message_text_cannot_fake_image_slot() == 0) printf("OK\n"); else failures++;
+
     return failures;
 }
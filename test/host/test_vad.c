@@ -0,0 +1,449 @@
+/*
+ * Host tests for voice activity detection and the speech-only upload
+ * stream, run over a synthetic labelled corpus: syllable-like voiced
+ * bursts with fricatives, over silence, hiss, mains hum and rumble.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "vad.h"
+#include "transcribe_util.h"
+
+#define TEST(name) static int test_##name(void)
+#define ASSERT(cond) do { \
+    if (!(cond)) { \
+        printf("  FAIL: %s (line %d)\n", #cond, __LINE__); \
+        return 1; \
+    } \
+} while(0)
+
+#define RATE        16000
+#define MS(ms)      ((size_t)(ms) * RATE / 1000)
+#define PI          3.14159265358979
+
+typedef enum {
+    BG_SILENCE,
+    BG_HISS,
+    BG_HUM,
+    BG_RUMBLE,
+} background_t;
+
+typedef struct {
+    const char *name;
+    background_t background;
+    double bg_dbfs;
+    double speech_dbfs;
+    int lead_ms;
+    int speech_ms;
+    int trail_ms;
+} clip_t;
+
+static uint32_t s_rng;
+
+static double noise(void)
+{
+    s_rng = s_rng * 1664525u + 1013904223u;
+    return (double)(s_rng >> 8) / (double)(1u << 24) * 2.0 - 1.0;
+}
+
+static double db_to_amp(double dbfs)
+{
+    return 32768.0 * pow(10.0, dbfs / 20.0);
+}
+
+static void add_background(double *x, size_t n, background_t kind, double dbfs)
+{
+    double amp = db_to_amp(dbfs);
+    double brown = 0.0;
+
+    for (size_t i = 0; i < n; i++) {
+        double t = (double)i / RATE;
+        switch (kind) {
+            case BG_SILENCE:
+                x[i] += noise();                // Dither
+                break;
+            case BG_HISS:
+                x[i] += amp * 1.73 * noise();   // Uniform noise has RMS 1/sqrt(3)
+                break;
+            case BG_HUM:
+                x[i] += amp * 1.2 * (sin(2 * PI * 50 * t) + 0.4 * sin(2 * PI * 150 * t));
+                break;
+            case BG_RUMBLE:
+                brown = 0.995 * brown + noise();
+                x[i] += amp * 0.1 * brown;
+                break;
+        }
+    }
+}
+
+// Words of two or three syllables; each syllable may open with a
+// fricative and is a voiced vowel with a swelling and fading envelope.
+// Speaks for up to len samples at roughly dbfs; returns where speech ends.
+static size_t add_speech(double *x, size_t len, double dbfs)
+{
+    double amp = db_to_amp(dbfs) * 0.9;
+    size_t pos = 0;
+    int syllable = 0;
+
+    while (pos < len) {
+        size_t fric = (syllable % 3 == 1) ? MS(60) : 0;
+        size_t vowel = MS(140 + (syllable * 37) % 120);
+        size_t gap = (syllable % 3 == 2) ? MS(220 + (syllable * 53) % 150) : MS(40 + (syllable * 29) % 60);
+        double f0 = 110.0 + (syllable * 23) % 90;
+
+        for (size_t i = 0; i < fric && pos < len; i++, pos++) {
+            x[pos] += amp * 0.5 * noise();
+        }
+        for (size_t i = 0; i < vowel && pos < len; i++, pos++) {
+            double t = (double)i / RATE;
+            double env = sin(PI * (double)i / (double)vowel);
+            double v = 0.0;
+            for (int k = 1; k <= 12; k++) {
+                double f = f0 * k;
+                // Formant-ish peaks near 500 Hz and 1500 Hz.
+                double w = 1.0 / (1.0 + pow((f - 500.0) / 300.0, 2)) +
+                           0.5 / (1.0 + pow((f - 1500.0) / 400.0, 2));
+                v += w * sin(2 * PI * f * t + k);
+            }
+            x[pos] += amp * sqrt(env) * v * 0.8;
+        }
+        if (pos + gap >= len) {
+            break;
+        }
+        pos += gap;
+        syllable++;
+    }
+    return pos;
+}
+
+// The clip's samples; *spoken_ms gets how long the speech in it lasts.
+static int16_t *render(const clip_t *clip, size_t *n_out, int *spoken_ms)
+{
+    size_t lead = MS(clip->lead_ms);
+    size_t speech = MS(clip->speech_ms);
+    size_t n = lead + speech + MS(clip->trail_ms);
+    double *x = calloc(n, sizeof(double));
+    int16_t *pcm = malloc(n * sizeof(int16_t));
+
+    s_rng = 12345;
+    add_background(x, n, clip->background, clip->bg_dbfs);
+    *spoken_ms = speech > 0 ? (int)(add_speech(x + lead, speech, clip->speech_dbfs) * 1000 / RATE) : 0;
+    for (size_t i = 0; i < n; i++) {
+        double v = x[i] > 32767.0 ? 32767.0 : x[i] < -32768.0 ? -32768.0 : x[i];
+        pcm[i] = (int16_t)v;
+    }
+    free(x);
+    *n_out = n;
+    return pcm;
+}
+
+typedef struct {
+    uint8_t data[256 * 1024];
+    size_t len;
+    int fail_after;                 // Writes before failing, or -1
+} sink_t;
+
+static bool sink_write(const char *data, size_t len, void *ctx)
+{
+    sink_t *sink = (sink_t *)ctx;
+
+    if (sink->fail_after == 0 || sink->len + len > sizeof(sink->data)) {
+        return false;
+    }
+    if (sink->fail_after > 0) {
+        sink->fail_after--;
+    }
+    memcpy(sink->data + sink->len, data, len);
+    sink->len += len;
+    return true;
+}
+
+typedef struct {
+    int start_frame;                // First VAD_EVENT_START, or -1
+    int end_frame;                  // First VAD_EVENT_END, or -1
+    int starts;
+    uint32_t kept_ms;
+    size_t wav_blocks;
+} run_t;
+
+static transcribe_stream_t s_stream;
+static uint8_t s_held[64][ADPCM_BLOCK_BYTES];
+static sink_t s_sink;
+
+// Feed every frame of pcm through the VAD and the upload stream.
+static bool run(const int16_t *pcm, size_t n, uint32_t hangover_ms, run_t *out)
+{
+    vad_t vad;
+    size_t held_max = transcribe_held_blocks(hangover_ms);
+
+    memset(&s_sink, 0, sizeof(s_sink));
+    s_sink.fail_after = -1;
+    vad_init(&vad, hangover_ms);
+    transcribe_stream_init(&s_stream, "whisper-1", RATE, s_held, held_max, sink_write, &s_sink);
+    out->start_frame = -1;
+    out->end_frame = -1;
+    out->starts = 0;
+
+    for (size_t f = 0; (f + 1) * VAD_FRAME_SAMPLES <= n; f++) {
+        vad_event_t event = vad_push(&vad, pcm + f * VAD_FRAME_SAMPLES);
+        if (event == VAD_EVENT_START) {
+            out->starts++;
+            if (out->start_frame < 0) {
+                out->start_frame = (int)f;
+            }
+        }
+        if (event == VAD_EVENT_END && out->end_frame < 0) {
+            out->end_frame = (int)f;
+        }
+        if (!transcribe_stream_frame(&s_stream, event, pcm + f * VAD_FRAME_SAMPLES)) {
+            return false;
+        }
+    }
+    if (!transcribe_stream_finish(&s_stream)) {
+        return false;
+    }
+    out->kept_ms = (uint32_t)(s_stream.kept_samples * 1000ull / RATE);
+    out->wav_blocks = s_stream.wav_len > ADPCM_WAV_HEADER_BYTES
+                      ? (s_stream.wav_len - ADPCM_WAV_HEADER_BYTES) / ADPCM_BLOCK_BYTES : 0;
+    return true;
+}
+
+TEST(features_separate_voiced_hiss_and_silence)
+{
+    int16_t frame[VAD_FRAME_SAMPLES];
+    vad_features_t f;
+
+    memset(frame, 0, sizeof(frame));
+    vad_features(frame, VAD_FRAME_SAMPLES, &f);
+    ASSERT(f.energy_dbfs <= -99.0f);
+    ASSERT(f.zcr_pct == 0);
+
+    // A 1 kHz tone at -20 dBFS riding on a DC offset: the offset is
+    // filtered out and the tone passes.
+    for (int i = 0; i < VAD_FRAME_SAMPLES; i++) {
+        frame[i] = (int16_t)(800 + 4634.0 * sin(2 * PI * 1000.0 * i / RATE));
+    }
+    vad_features(frame, VAD_FRAME_SAMPLES, &f);
+    ASSERT(fabsf(f.energy_dbfs - -20.0f) < 0.5f);
+    ASSERT(f.zcr_pct >= 11 && f.zcr_pct <= 13);
+
+    // 50 Hz hum at the same level is mostly filtered out.
+    for (int i = 0; i < VAD_FRAME_SAMPLES; i++) {
+        frame[i] = (int16_t)(4634.0 * sin(2 * PI * 50.0 * i / RATE));
+    }
+    vad_features(frame, VAD_FRAME_SAMPLES, &f);
+    ASSERT(f.energy_dbfs < -25.0f);
+
+    s_rng = 1;
+    for (int i = 0; i < VAD_FRAME_SAMPLES; i++) {
+        frame[i] = (int16_t)(3000.0 * noise());
+    }
+    vad_features(frame, VAD_FRAME_SAMPLES, &f);
+    ASSERT(f.zcr_pct > 40);
+    return 0;
+}
+
+TEST(corpus_finds_speech_and_trims_silence)
+{
+    static const clip_t corpus[] = {
+        { "quiet room",         BG_SILENCE, -90, -20, 1500, 2400, 2000 },
+        { "hiss -60 dBFS",      BG_HISS,    -60, -20, 1000, 1800, 2000 },
+        { "hiss -45 dBFS",      BG_HISS,    -45, -20, 2000, 3000, 2000 },
+        { "quiet talker",       BG_HISS,    -65, -38,  800, 2000, 2000 },
+        { "mains hum",          BG_HUM,     -40, -20, 1200, 2500, 2000 },
+        { "rumble",             BG_RUMBLE,  -45, -22, 1600, 2200, 2000 },
+        { "talks at once",      BG_HISS,    -60, -20,  100, 2000, 2000 },
+    };
+    const uint32_t hangover_ms = 800;
+
+    for (size_t c = 0; c < sizeof(corpus) / sizeof(corpus[0]); c++) {
+        const clip_t *clip = &corpus[c];
+        size_t n;
+        int spoken_ms;
+        int16_t *pcm = render(clip, &n, &spoken_ms);
+        run_t r;
+        bool ok = run(pcm, n, hangover_ms, &r);
+        int start_ms = r.start_frame * VAD_FRAME_MS;
+        int end_ms = r.end_frame * VAD_FRAME_MS;
+        int speech_end_ms = clip->lead_ms + spoken_ms;
+
+        free(pcm);
+        if (!ok || r.starts != 1 ||
+            start_ms < clip->lead_ms || start_ms > clip->lead_ms + 200 ||
+            end_ms < speech_end_ms + (int)hangover_ms - 150 ||
+            end_ms > speech_end_ms + (int)hangover_ms + 100 ||
+            // Everything said is sent, plus at most the pre-roll and block padding...
+            (int)r.kept_ms < spoken_ms - 100 ||
+            (int)r.kept_ms > spoken_ms + VAD_PREROLL_FRAMES * VAD_FRAME_MS + 100) {
+            printf("  FAIL: %s: starts %d at %d ms, end at %d ms, kept %u ms\n", clip->name,
+                   r.starts, start_ms, end_ms, (unsigned)r.kept_ms);
+            return 1;
+        }
+        // ...and what is sent is a whole multipart WAV.
+        ASSERT(memcmp(s_sink.data, "--" TRANSCRIBE_BOUNDARY, strlen(TRANSCRIBE_BOUNDARY) + 2) == 0);
+        ASSERT(s_sink.len == s_stream.wav_len + (size_t)(strstr((char *)s_sink.data, "RIFF") -
+                                                         (char *)s_sink.data) +
+                             strlen("\r\n--" TRANSCRIBE_BOUNDARY "--\r\n"));
+        ASSERT(r.wav_blocks * ADPCM_BLOCK_SAMPLES >= s_stream.kept_samples);
+    }
+    return 0;
+}
+
+TEST(noise_alone_never_starts)
+{
+    static const clip_t corpus[] = {
+        { "silence",            BG_SILENCE, -90, 0, 0, 0, 6000 },
+        { "hiss -40 dBFS",      BG_HISS,    -40, 0, 0, 0, 6000 },
+        { "mains hum",          BG_HUM,     -35, 0, 0, 0, 6000 },
+        { "rumble",             BG_RUMBLE,  -40, 0, 0, 0, 6000 },
+    };
+
+    for (size_t c = 0; c < sizeof(corpus) / sizeof(corpus[0]); c++) {
+        size_t n;
+        int spoken_ms;
+        int16_t *pcm = render(&corpus[c], &n, &spoken_ms);
+        run_t r;
+        bool ok = run(pcm, n, 800, &r);
+
+        free(pcm);
+        if (!ok || r.starts != 0 || s_sink.len != 0) {
+            printf("  FAIL: %s: %d starts, %u bytes\n", corpus[c].name, r.starts,
+                   (unsigned)s_sink.len);
+            return 1;
+        }
+    }
+
+    // Clicks: loud but single frames, so never an onset.
+    size_t n = MS(5000);
+    int16_t *pcm = calloc(n, sizeof(int16_t));
+    run_t r;
+    for (size_t i = 0; i < n; i += MS(500)) {
+        for (size_t k = 0; k < MS(4); k++) {
+            pcm[i + k] = (int16_t)(k % 2 ? 20000 : -20000);
+        }
+    }
+    bool ok = run(pcm, n, 800, &r);
+    free(pcm);
+    ASSERT(ok && r.starts == 0);
+    return 0;
+}
+
+TEST(new_steady_noise_ends_speech)
+{
+    // Hum switching on looks like a vowel at first; the floor catches up
+    // with it within the floor window and the "utterance" ends.
+    size_t n = MS(10000);
+    double *x = calloc(n, sizeof(double));
+    int16_t *pcm = malloc(n * sizeof(int16_t));
+    run_t r;
+
+    s_rng = 7;
+    add_background(x, n, BG_HISS, -65);
+    add_background(x + MS(1000), n - MS(1000), BG_HUM, -30);
+    for (size_t i = 0; i < n; i++) {
+        pcm[i] = (int16_t)x[i];
+    }
+    bool ok = run(pcm, n, 800, &r);
+    free(x);
+    free(pcm);
+    ASSERT(ok);
+    ASSERT(r.end_frame >= 0);
+    // Onset, a full floor window plus the span in progress, then the hangover.
+    ASSERT(r.end_frame * VAD_FRAME_MS <=
+           1000 + (VAD_FLOOR_SPANS + 1) * VAD_FLOOR_SPAN_FRAMES * VAD_FRAME_MS + 800);
+    return 0;
+}
+
+TEST(short_pause_is_kept_long_pause_is_cut)
+{
+    // Two phrases with a pause shorter than the hangover stay one utterance
+    // with the pause in it; 2 s apart they are two, and the silence between
+    // is not sent.
+    static const int gaps[] = { 300, 2000 };
+
+    for (int g = 0; g < 2; g++) {
+        size_t n = MS(1000 + 1500 + gaps[g] + 1500 + 1500);
+        double *x = calloc(n, sizeof(double));
+        int16_t *pcm = malloc(n * sizeof(int16_t));
+        run_t r;
+
+        s_rng = 99;
+        add_background(x, n, BG_HISS, -60);
+        int first_ms = (int)(add_speech(x + MS(1000), MS(1500), -20) * 1000 / RATE);
+        int second_ms = (int)(add_speech(x + MS(2500 + gaps[g]), MS(1500), -20) * 1000 / RATE);
+        int pause_ms = 1500 - first_ms + gaps[g];
+        for (size_t i = 0; i < n; i++) {
+            pcm[i] = (int16_t)x[i];
+        }
+        bool ok = run(pcm, n, 800, &r);
+        free(x);
+        free(pcm);
+        ASSERT(ok);
+        if (g == 0) {
+            int spoken = first_ms + pause_ms + second_ms;
+            ASSERT(pause_ms < 800);
+            ASSERT(r.starts == 1);
+            ASSERT((int)r.kept_ms >= spoken - 100 && (int)r.kept_ms <= spoken + 300);
+        } else {
+            int spoken = first_ms + second_ms;
+            ASSERT(r.starts == 2);
+            ASSERT((int)r.kept_ms >= spoken - 200 && (int)r.kept_ms <= spoken + 600);
+        }
+    }
+    return 0;
+}
+
+TEST(failed_write_stops_stream)
+{
+    clip_t clip = { "fail", BG_HISS, -60, -20, 500, 2000, 1000 };
+    size_t n;
+    int spoken_ms;
+    int16_t *pcm = render(&clip, &n, &spoken_ms);
+    vad_t vad;
+    bool ok = true;
+
+    memset(&s_sink, 0, sizeof(s_sink));
+    s_sink.fail_after = 5;          // Form head, WAV header, three blocks
+    vad_init(&vad, 800);
+    transcribe_stream_init(&s_stream, "whisper-1", RATE, s_held, 64, sink_write, &s_sink);
+    for (size_t f = 0; ok && (f + 1) * VAD_FRAME_SAMPLES <= n; f++) {
+        ok = transcribe_stream_frame(&s_stream, vad_push(&vad, pcm + f * VAD_FRAME_SAMPLES),
+                                     pcm + f * VAD_FRAME_SAMPLES);
+    }
+    free(pcm);
+    ASSERT(!ok);
+    ASSERT(s_stream.failed);
+    ASSERT(s_stream.wav_len == ADPCM_WAV_HEADER_BYTES + 3 * ADPCM_BLOCK_BYTES);
+    ASSERT(!transcribe_stream_finish(&s_stream));
+    return 0;
+}
+
+int test_vad_all(void)
+{
+    int failures = 0;
+
+    printf("\nVAD Tests:\n");
+
+    printf("  features_separate_voiced_hiss_and_silence... ");
+    if (test_features_separate_voiced_hiss_and_silence() == 0) printf("OK\n"); else failures++;
+
+    printf("  corpus_finds_speech_and_trims_silence... ");
+    if (test_corpus_finds_speech_and_trims_silence() == 0) printf("OK\n"); else failures++;
+
+    printf("  noise_alone_never_starts... ");
+    if (test_noise_alone_never_starts() == 0) printf("OK\n"); else failures++;
+
+    printf("  new_steady_noise_ends_speech... ");
+    if (test_new_steady_noise_ends_speech() == 0) printf("OK\n"); else failures++;
+
+    printf("  short_pause_is_kept_long_pause_is_cut... ");
+    if (test_short_pause_is_kept_long_pause_is_cut() == 0) printf("OK\n"); else failures++;
+
+    printf("  failed_write_stops_stream... ");
+    if (test_failed_write_stops_stream() == 0) printf("OK\n"); else failures++;
+
+    return failures;
+}
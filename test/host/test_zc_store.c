@@ -0,0 +1,316 @@
+/*
+ * Host tests for the log-structured user memory store, run against the
+ * file-backed flash emulation: persistence, compaction, torn writes.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "flash_emu.h"
+#include "zc_store.h"
+
+#define TEST(name) static int test_##name(void)
+#define ASSERT(cond) do { \
+    if (!(cond)) { \
+        printf("  FAIL: %s (line %d)\n", #cond, __LINE__); \
+        return 1; \
+    } \
+} while(0)
+
+#define IMAGE_PATH   "build/zc_store_test.img"
+#define SEGMENT_SIZE 16384
+#define IMAGE_SIZE   (SEGMENT_SIZE * 4)
+
+static flash_emu_t s_emu;
+static zc_store_backend_t s_backend;
+static int s_kicks = 0;
+
+static void count_kick(void *ctx)
+{
+    (void)ctx;
+    s_kicks++;
+}
+
+static int setup(void)
+{
+    remove(IMAGE_PATH);
+    if (!flash_emu_open(&s_emu, IMAGE_PATH, IMAGE_SIZE)) {
+        return 1;
+    }
+    flash_emu_backend(&s_emu, SEGMENT_SIZE, &s_backend);
+    s_backend.kick = count_kick;
+    s_kicks = 0;
+    return zc_store_mount(&s_backend) == ESP_OK ? 0 : 1;
+}
+
+static void teardown(void)
+{
+    zc_store_unmount();
+    flash_emu_close(&s_emu);
+    remove(IMAGE_PATH);
+}
+
+static int remount(void)
+{
+    zc_store_unmount();
+    return zc_store_mount(&s_backend) == ESP_OK ? 0 : 1;
+}
+
+static bool value_is(const char *key, const char *expected)
+{
+    static char buf[ZC_STORE_MAX_VALUE_LEN + 1];
+    size_t len = sizeof(buf);
+    return zc_store_get(key, buf, &len) == ESP_OK && strcmp(buf, expected) == 0 &&
+           len == strlen(expected) + 1;
+}
+
+static void fill_value(char *buf, size_t len, char c)
+{
+    memset(buf, c, len);
+    buf[len] = '\0';
+}
+
+static bool count_visit(const char *key, void *ctx)
+{
+    (void)key;
+    (*(int *)ctx)++;
+    return true;
+}
+
+TEST(set_get_delete)
+{
+    static char big[ZC_STORE_MAX_VALUE_LEN + 2];
+    char small[4];
+    size_t len;
+
+    ASSERT(setup() == 0);
+    ASSERT(zc_store_set("u_note", "buy milk") == ESP_OK);
+    ASSERT(value_is("u_note", "buy milk"));
+
+    ASSERT(zc_store_set("u_note", "buy oat milk") == ESP_OK);
+    ASSERT(value_is("u_note", "buy oat milk"));
+
+    const char *long_key = "u_kitchen_shopping_list_for_the_weekend_and_holiday_plans";
+    fill_value(big, ZC_STORE_MAX_VALUE_LEN, 'q');
+    ASSERT(zc_store_set(long_key, big) == ESP_OK);
+    ASSERT(value_is(long_key, big));
+
+    len = sizeof(small);
+    ASSERT(zc_store_get("u_note", small, &len) == ESP_ERR_INVALID_SIZE);
+    ASSERT(len == strlen("buy oat milk") + 1);
+
+    ASSERT(zc_store_delete("u_note") == ESP_OK);
+    ASSERT(!zc_store_exists("u_note"));
+    len = sizeof(small);
+    ASSERT(zc_store_get("u_note", small, &len) == ESP_ERR_NOT_FOUND);
+    ASSERT(zc_store_delete("u_note") == ESP_ERR_NOT_FOUND);
+    ASSERT(zc_store_exists(long_key));
+
+    // Argument limits
+    fill_value(big, ZC_STORE_MAX_VALUE_LEN + 1, 'x');
+    ASSERT(zc_store_set("u_big", big) == ESP_ERR_INVALID_SIZE);
+    ASSERT(zc_store_set("", "v") == ESP_ERR_INVALID_ARG);
+    ASSERT(zc_store_set("u_aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa", "v") ==
+           ESP_ERR_INVALID_ARG);
+    ASSERT(s_emu.bit_set_violations == 0);
+    teardown();
+    return 0;
+}
+
+TEST(persists_across_remount)
+{
+    int count = 0;
+
+    ASSERT(setup() == 0);
+    ASSERT(zc_store_set("u_a", "1") == ESP_OK);
+    ASSERT(zc_store_set("u_b", "2") == ESP_OK);
+    ASSERT(zc_store_set("u_a", "3") == ESP_OK);
+    ASSERT(zc_store_set("u_c", "4") == ESP_OK);
+    ASSERT(zc_store_delete("u_b") == ESP_OK);
+
+    ASSERT(remount() == 0);
+    ASSERT(value_is("u_a", "3"));
+    ASSERT(!zc_store_exists("u_b"));
+    ASSERT(value_is("u_c", "4"));
+    ASSERT(zc_store_list(count_visit, &count) == 2);
+    ASSERT(count == 2);
+
+    // Appends continue in the same segment after a clean mount.
+    ASSERT(zc_store_set("u_d", "5") == ESP_OK);
+    ASSERT(remount() == 0);
+    ASSERT(value_is("u_d", "5"));
+
+    zc_store_stats_t stats;
+    zc_store_get_stats(&stats);
+    ASSERT(stats.keys == 3 && stats.free_segments == 3 && stats.torn_records == 0);
+    teardown();
+    return 0;
+}
+
+TEST(unchanged_value_skips_write)
+{
+    ASSERT(setup() == 0);
+    ASSERT(zc_store_set("u_mode", "eco") == ESP_OK);
+    uint64_t written = s_emu.bytes_written;
+    ASSERT(zc_store_set("u_mode", "eco") == ESP_OK);
+    ASSERT(s_emu.bytes_written == written);
+    ASSERT(zc_store_set("u_mode", "eco+") == ESP_OK);
+    ASSERT(s_emu.bytes_written > written);
+    teardown();
+    return 0;
+}
+
+TEST(compaction_reclaims_overwrites)
+{
+    static char value[1025];
+    char key[16];
+    zc_store_stats_t stats;
+
+    ASSERT(setup() == 0);
+    // 200 KB of overwrites through a 64 KB partition.
+    for (int round = 0; round < 40; round++) {
+        for (int k = 0; k < 5; k++) {
+            snprintf(key, sizeof(key), "u_k%d", k);
+            fill_value(value, 1000, (char)('a' + (round + k) % 26));
+            ASSERT(zc_store_set(key, value) == ESP_OK);
+        }
+        if (zc_store_needs_compaction()) {
+            ASSERT(zc_store_compact_step() == ESP_OK);
+        }
+    }
+    zc_store_get_stats(&stats);
+    ASSERT(stats.compactions > 0);
+    ASSERT(stats.keys == 5);
+    ASSERT(s_kicks > 0);
+
+    ASSERT(remount() == 0);
+    for (int k = 0; k < 5; k++) {
+        snprintf(key, sizeof(key), "u_k%d", k);
+        fill_value(value, 1000, (char)('a' + (39 + k) % 26));
+        ASSERT(value_is(key, value));
+    }
+    ASSERT(s_emu.bit_set_violations == 0);
+    teardown();
+    return 0;
+}
+
+TEST(deleted_keys_stay_deleted_after_compaction)
+{
+    static char value[2049];
+    zc_store_stats_t stats;
+
+    ASSERT(setup() == 0);
+    ASSERT(zc_store_set("u_gone", "secret plans") == ESP_OK);
+    ASSERT(zc_store_delete("u_gone") == ESP_OK);
+
+    // Churn enough to compact the segment holding the put and tombstone.
+    fill_value(value, 2048, 'z');
+    for (int i = 0; i < 81; i++) {
+        ASSERT(zc_store_set("u_churn", i % 2 ? "short" : value) == ESP_OK);
+    }
+    zc_store_get_stats(&stats);
+    ASSERT(stats.compactions > 0);
+
+    ASSERT(remount() == 0);
+    ASSERT(!zc_store_exists("u_gone"));
+    ASSERT(value_is("u_churn", value));
+    teardown();
+    return 0;
+}
+
+TEST(torn_write_recovers)
+{
+    static char value[1025];
+    zc_store_stats_t stats;
+
+    ASSERT(setup() == 0);
+    ASSERT(zc_store_set("u_keep", "safe") == ESP_OK);
+    ASSERT(zc_store_set("u_torn", "old") == ESP_OK);
+
+    // Power fails halfway through the next record.
+    fill_value(value, 1000, 'n');
+    flash_emu_set_write_budget(&s_emu, 300);
+    ASSERT(zc_store_set("u_torn", value) != ESP_OK);
+    flash_emu_power_cycle(&s_emu);
+
+    ASSERT(remount() == 0);
+    zc_store_get_stats(&stats);
+    ASSERT(stats.torn_records == 1);
+    ASSERT(value_is("u_keep", "safe"));
+    ASSERT(value_is("u_torn", "old"));
+
+    // New writes go to a fresh segment and survive another mount.
+    ASSERT(zc_store_set("u_torn", "new") == ESP_OK);
+    ASSERT(remount() == 0);
+    ASSERT(value_is("u_torn", "new"));
+    ASSERT(value_is("u_keep", "safe"));
+    teardown();
+    return 0;
+}
+
+TEST(full_store_rejects_then_recovers)
+{
+    static char value[4001];
+    char key[16];
+    int stored = 0;
+    esp_err_t err = ESP_OK;
+
+    ASSERT(setup() == 0);
+    fill_value(value, 4000, 'f');
+    for (int i = 0; i < 64 && err == ESP_OK; i++) {
+        snprintf(key, sizeof(key), "u_f%d", i);
+        err = zc_store_set(key, value);
+        if (err == ESP_OK) {
+            stored++;
+        }
+    }
+    ASSERT(err == ESP_ERR_NO_MEM);
+    // Three of four segments usable (one is reserved), four records each.
+    ASSERT(stored >= 9 && stored <= 12);
+
+    // Deletes work on a full store and make room again.
+    ASSERT(zc_store_delete("u_f0") == ESP_OK);
+    ASSERT(zc_store_delete("u_f1") == ESP_OK);
+    ASSERT(zc_store_delete("u_f2") == ESP_OK);
+    ASSERT(zc_store_delete("u_f3") == ESP_OK);
+    ASSERT(zc_store_delete("u_f4") == ESP_OK);
+    ASSERT(zc_store_set("u_again", value) == ESP_OK);
+
+    ASSERT(remount() == 0);
+    ASSERT(value_is("u_again", value));
+    ASSERT(!zc_store_exists("u_f0"));
+    ASSERT(zc_store_exists("u_f5"));
+    teardown();
+    return 0;
+}
+
+int test_zc_store_all(void)
+{
+    int failures = 0;
+
+    printf("\nZC Store Tests:\n");
+
+    printf("  set_get_delete... ");
+    if (test_set_get_delete() == 0) printf("OK\n"); else failures++;
+
+    printf("  persists_across_remount... ");
+    if (test_persists_across_remount() == 0) printf("OK\n"); else failures++;
+
+    printf("  unchanged_value_skips_write... ");
+    if (test_unchanged_value_skips_write() == 0) printf("OK\n"); else failures++;
+
+    printf("  compaction_reclaims_overwrites... ");
+    if (test_compaction_reclaims_overwrites() == 0) printf("OK\n"); else failures++;
+
+    printf("  deleted_keys_stay_deleted_after_compaction... ");
+    if (test_deleted_keys_stay_deleted_after_compaction() == 0) printf("OK\n"); else failures++;
+
+    printf("  torn_write_recovers... ");
+    if (test_torn_write_recovers() == 0) printf("OK\n"); else failures++;
+
+    printf("  full_store_rejects_then_recovers... ");
+    if (test_full_store_rejects_then_recovers() == 0) printf("OK\n"); else failures++;
+
+    return failures;
+}